@@ -0,0 +1,153 @@
+/**
+ * @file bench_analytics.c
+ * @brief Compare the analytics column store with the equivalent SQL reports.
+ * 
+ * Usage: bench_analytics [loans] [threads]
+ * 
+ * Builds an in-memory database with the given number of synthetic loans
+ * (default 2,000,000), then times the initial load, an incremental refresh
+ * and each aggregate against the SQL query it replaces.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+#include <sqlite3.h>
+#include "database.h"
+#include "analytics.h"
+#include "date_utils.h"
+
+#define BENCH_BOOKS 50000
+#define BENCH_MEMBERS 200000
+
+static double now_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000.0 + ts.tv_nsec / 1e6;
+}
+
+static int exec(sqlite3 *db, const char *sql) {
+    char *err_msg = NULL;
+    if (sqlite3_exec(db, sql, NULL, NULL, &err_msg) != SQLITE_OK) {
+        fprintf(stderr, "SQL error: %s\n", err_msg);
+        sqlite3_free(err_msg);
+        return -1;
+    }
+    return 0;
+}
+
+/**
+ * @brief Run a query to completion and return the time it took.
+ */
+static double time_query(sqlite3 *db, const char *sql) {
+    sqlite3_stmt *stmt;
+    if (sqlite3_prepare_v2(db, sql, -1, &stmt, NULL) != SQLITE_OK) {
+        fprintf(stderr, "Failed to prepare statement: %s\n", sqlite3_errmsg(db));
+        return -1;
+    }
+    double start = now_ms();
+    while (sqlite3_step(stmt) == SQLITE_ROW) {
+    }
+    double elapsed = now_ms() - start;
+    sqlite3_finalize(stmt);
+    return elapsed;
+}
+
+static int populate(sqlite3 *db, long loans) {
+    char sql[1024];
+
+    if (exec(db, "BEGIN;") != 0) {
+        return -1;
+    }
+    snprintf(sql, sizeof(sql),
+             "WITH RECURSIVE n(i) AS (SELECT 1 UNION ALL SELECT i + 1 FROM n WHERE i < %d) "
+             "INSERT INTO Books (title, author, isbn, genre, quantity, available) "
+             "SELECT 'Book ' || i, 'Author ' || (i %% 5000), 'B' || i, 'Genre ' || (i %% 20), 5, 5 FROM n;",
+             BENCH_BOOKS);
+    if (exec(db, sql) != 0) {
+        return -1;
+    }
+    snprintf(sql, sizeof(sql),
+             "WITH RECURSIVE n(i) AS (SELECT 1 UNION ALL SELECT i + 1 FROM n WHERE i < %ld) "
+             "INSERT INTO Loans (book_id, member_id, loan_date, due_date, is_returned) "
+             "SELECT 1 + abs(random()) %% %d, 1 + abs(random()) %% %d, "
+             "date('2020-01-01', '+' || (i %% 1800) || ' days'), "
+             "date('2020-01-15', '+' || (i %% 1800) || ' days'), "
+             "(i %% 1800) < 1750 FROM n;",
+             loans, BENCH_BOOKS, BENCH_MEMBERS);
+    if (exec(db, sql) != 0) {
+        return -1;
+    }
+    return exec(db, "COMMIT;");
+}
+
+int main(int argc, char **argv) {
+    long loans = argc > 1 ? atol(argv[1]) : 2000000;
+    int threads = argc > 2 ? atoi(argv[2]) : (int)sysconf(_SC_NPROCESSORS_ONLN);
+
+    sqlite3 *db;
+    if (sqlite3_open(":memory:", &db) != SQLITE_OK) {
+        fprintf(stderr, "Cannot open database\n");
+        return EXIT_FAILURE;
+    }
+    set_db_connection(db);
+    if (create_tables() != 0 || migrate_schema() != 0) {
+        return EXIT_FAILURE;
+    }
+
+    printf("Generating %ld loans...\n", loans);
+    double start = now_ms();
+    if (populate(db, loans) != 0 || create_indexes() != 0) {
+        return EXIT_FAILURE;
+    }
+    printf("  generated in %.0f ms\n\n", now_ms() - start);
+
+    start = now_ms();
+    if (refresh_analytics(db, threads) < 0) {
+        return EXIT_FAILURE;
+    }
+    printf("Initial load (%d threads):    %10.1f ms\n", threads, now_ms() - start);
+
+    if (exec(db, "INSERT INTO Loans (book_id, member_id, loan_date, due_date) "
+                 "VALUES (1, 1, '2025-01-01', '2025-01-15');") != 0) {
+        return EXIT_FAILURE;
+    }
+    start = now_ms();
+    int added = refresh_analytics(db, threads);
+    printf("Incremental refresh (%d new):  %10.3f ms\n\n", added, now_ms() - start);
+
+    int today;
+    date_to_day("2025-01-01", &today);
+    AnalyticsCount top[10];
+    AnalyticsCount genres[20];
+    LoanSummary summary;
+
+    printf("%-22s %14s %14s\n", "Report", "Column store", "SQL");
+    start = now_ms();
+    analytics_top_books(top, 10);
+    double column_ms = now_ms() - start;
+    printf("%-22s %11.1f ms %11.1f ms\n", "Top 10 books", column_ms,
+           time_query(db, "SELECT book_id, COUNT(*) AS c FROM Loans GROUP BY book_id ORDER BY c DESC LIMIT 10;"));
+
+    start = now_ms();
+    analytics_genre_counts(genres, 20);
+    column_ms = now_ms() - start;
+    printf("%-22s %11.1f ms %11.1f ms\n", "Loans by genre", column_ms,
+           time_query(db, "SELECT b.genre, COUNT(*) AS c FROM Loans l JOIN Books b ON l.book_id = b.book_id "
+                          "GROUP BY b.genre ORDER BY c DESC;"));
+
+    start = now_ms();
+    analytics_loan_summary(today, &summary);
+    column_ms = now_ms() - start;
+    printf("%-22s %11.1f ms %11.1f ms\n", "Overdue summary", column_ms,
+           time_query(db, "SELECT COUNT(*), COUNT(DISTINCT member_id), "
+                          "SUM(julianday('2025-01-01') - julianday(due_date)) "
+                          "FROM Loans WHERE is_returned = 0 AND due_date < '2025-01-01';"));
+
+    printf("\nTop book: %d (%d loans), overdue loans: %d\n", top[0].id, top[0].count, summary.overdue_loans);
+
+    free_analytics();
+    sqlite3_close(db);
+    return EXIT_SUCCESS;
+}
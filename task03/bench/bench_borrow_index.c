@@ -0,0 +1,186 @@
+/**
+ * @file bench_borrow_index.c
+ * @brief Compare borrow history lookups on the Roaring index against SQL.
+ * 
+ * Usage: bench_borrow_index [loans] [directory]
+ * 
+ * Fills an in-memory database with loans (default 2,000,000) of 20,000
+ * books by 50,000 members, popular books and heavy readers favoured,
+ * writes the index to directory (default ".") and reports the build
+ * time, the file size and the time per query of:
+ *   - "has member M borrowed book B" (the recommendation filter),
+ *   - the members who borrowed any of 10 books,
+ *   - the members who borrowed both of 2 popular books,
+ * each against the indexed SQL query giving the same answer.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <sys/stat.h>
+#include <sqlite3.h>
+#include "database.h"
+#include "borrow_index.h"
+
+#define BENCH_BOOKS 20000
+#define BENCH_MEMBERS 50000
+
+static int exec(sqlite3 *db, const char *sql) {
+    char *err_msg = NULL;
+    if (sqlite3_exec(db, sql, NULL, NULL, &err_msg) != SQLITE_OK) {
+        fprintf(stderr, "SQL error: %s\n", err_msg);
+        sqlite3_free(err_msg);
+        return -1;
+    }
+    return 0;
+}
+
+static double now_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000.0 + ts.tv_nsec / 1e6;
+}
+
+/* Skewed ID in 1..n: squaring a uniform draw favours low IDs */
+static int skewed(int n) {
+    double u = (double)rand() / RAND_MAX;
+    return 1 + (int)(u * u * (n - 1));
+}
+
+static void report(const char *name, int queries, double index_ms, double sql_ms, long index_hits, long sql_hits) {
+    printf("%-24s %10.2f %10.2f %9.1fx %s\n", name, index_ms * 1000.0 / queries, sql_ms * 1000.0 / queries,
+           sql_ms / index_ms, index_hits == sql_hits ? "yes" : "NO");
+}
+
+int main(int argc, char **argv) {
+    int loans = argc > 1 ? atoi(argv[1]) : 2000000;
+    const char *directory = argc > 2 ? argv[2] : ".";
+    char path[512];
+    snprintf(path, sizeof(path), "%s/bench_borrow_index.bin", directory);
+
+    sqlite3 *db;
+    if (sqlite3_open(":memory:", &db) != SQLITE_OK) {
+        fprintf(stderr, "Cannot open database\n");
+        return EXIT_FAILURE;
+    }
+    set_db_connection(db);
+    set_quiet_mode(1);
+    if (create_tables() != 0 || migrate_schema() != 0 || create_indexes() != 0) {
+        return EXIT_FAILURE;
+    }
+
+    srand(42);
+    sqlite3_stmt *insert;
+    exec(db, "BEGIN");
+    sqlite3_prepare_v2(db, "INSERT INTO Loans (book_id, member_id, loan_date, due_date, is_returned) "
+                           "VALUES (?, ?, '2024-01-01', '2024-01-15', 1)", -1, &insert, NULL);
+    for (int i = 0; i < loans; i++) {
+        sqlite3_bind_int(insert, 1, skewed(BENCH_BOOKS));
+        sqlite3_bind_int(insert, 2, skewed(BENCH_MEMBERS));
+        sqlite3_step(insert);
+        sqlite3_reset(insert);
+    }
+    sqlite3_finalize(insert);
+    if (exec(db, "COMMIT") != 0) {
+        return EXIT_FAILURE;
+    }
+
+    double start = now_ms();
+    int pairs = build_borrow_index(db, path);
+    double build_ms = now_ms() - start;
+    if (pairs < 0 || open_borrow_index(path) != 0) {
+        return EXIT_FAILURE;
+    }
+    struct stat st;
+    stat(path, &st);
+    printf("Loans: %d  Distinct pairs: %d  Build: %.1f ms  File: %.1f MB\n\n", loans, pairs, build_ms,
+           st.st_size / 1048576.0);
+    printf("%-24s %10s %10s %10s %s\n", "Query", "Index (us)", "SQL (us)", "Speedup", "Same");
+
+    /* Has borrowed */
+    int queries = 100000;
+    int *member_ids = malloc(queries * sizeof(int));
+    int *book_ids = malloc(queries * sizeof(int));
+    for (int i = 0; i < queries; i++) {
+        member_ids[i] = skewed(BENCH_MEMBERS);
+        book_ids[i] = skewed(BENCH_BOOKS);
+    }
+    long index_hits = 0, sql_hits = 0;
+    start = now_ms();
+    for (int i = 0; i < queries; i++) {
+        index_hits += borrow_index_has_borrowed(member_ids[i], book_ids[i]);
+    }
+    double index_ms = now_ms() - start;
+
+    sqlite3_stmt *stmt;
+    sqlite3_prepare_v2(db, "SELECT 1 FROM Loans WHERE member_id = ? AND book_id = ? LIMIT 1", -1, &stmt, NULL);
+    start = now_ms();
+    for (int i = 0; i < queries; i++) {
+        sqlite3_bind_int(stmt, 1, member_ids[i]);
+        sqlite3_bind_int(stmt, 2, book_ids[i]);
+        sql_hits += sqlite3_step(stmt) == SQLITE_ROW;
+        sqlite3_reset(stmt);
+    }
+    double sql_ms = now_ms() - start;
+    sqlite3_finalize(stmt);
+    report("has_borrowed", queries, index_ms, sql_ms, index_hits, sql_hits);
+
+    /* Members of any of 10 books */
+    queries = 200;
+    RoaringBitmap members;
+    roaring_init(&members);
+    index_hits = sql_hits = 0;
+    start = now_ms();
+    for (int q = 0; q < queries; q++) {
+        index_hits += borrow_index_members_of_any(&book_ids[q * 10], 10, &members);
+    }
+    index_ms = now_ms() - start;
+
+    sqlite3_prepare_v2(db, "SELECT COUNT(DISTINCT member_id) FROM Loans "
+                           "WHERE book_id IN (?, ?, ?, ?, ?, ?, ?, ?, ?, ?)", -1, &stmt, NULL);
+    start = now_ms();
+    for (int q = 0; q < queries; q++) {
+        for (int i = 0; i < 10; i++) {
+            sqlite3_bind_int(stmt, i + 1, book_ids[q * 10 + i]);
+        }
+        if (sqlite3_step(stmt) == SQLITE_ROW) {
+            sql_hits += sqlite3_column_int(stmt, 0);
+        }
+        sqlite3_reset(stmt);
+    }
+    sql_ms = now_ms() - start;
+    sqlite3_finalize(stmt);
+    report("members_of_any (10)", queries, index_ms, sql_ms, index_hits, sql_hits);
+
+    /* Members of both of 2 popular books */
+    index_hits = sql_hits = 0;
+    start = now_ms();
+    for (int q = 0; q < queries; q++) {
+        int both[2] = {1 + q % 50, 51 + q % 50};
+        index_hits += borrow_index_members_of_all(both, 2, &members);
+    }
+    index_ms = now_ms() - start;
+
+    sqlite3_prepare_v2(db, "SELECT COUNT(*) FROM (SELECT member_id FROM Loans WHERE book_id = ? "
+                           "INTERSECT SELECT member_id FROM Loans WHERE book_id = ?)", -1, &stmt, NULL);
+    start = now_ms();
+    for (int q = 0; q < queries; q++) {
+        sqlite3_bind_int(stmt, 1, 1 + q % 50);
+        sqlite3_bind_int(stmt, 2, 51 + q % 50);
+        if (sqlite3_step(stmt) == SQLITE_ROW) {
+            sql_hits += sqlite3_column_int(stmt, 0);
+        }
+        sqlite3_reset(stmt);
+    }
+    sql_ms = now_ms() - start;
+    sqlite3_finalize(stmt);
+    report("members_of_all (2)", queries, index_ms, sql_ms, index_hits, sql_hits);
+
+    roaring_free(&members);
+    free(member_ids);
+    free(book_ids);
+    close_borrow_index();
+    remove(path);
+    sqlite3_close(db);
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,223 @@
+/**
+ * @file bench_busy_retry.c
+ * @brief Several writer processes borrowing and returning books on one database file.
+ * 
+ * Usage: bench_busy_retry [writers] [transactions] [directory]
+ * 
+ * Creates a WAL database in directory (default "/tmp") with 1,000 books,
+ * then forks writers (default 4) that each run transactions (default
+ * 2,000) loans and returns through process_loan() and process_return().
+ * Runs three times, with a fresh database each time:
+ *   - fail fast: no busy handler and a 1 ms retry deadline,
+ *   - sqlite3_busy_timeout(): SQLite's own fixed sleep schedule,
+ *   - backoff: install_busy_handler()'s jittered exponential backoff.
+ * Reports committed transactions per second, failures, the retry
+ * counters summed over the writers and latency percentiles.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <sqlite3.h>
+#include "database.h"
+#include "loan.h"
+
+#define BENCH_BOOKS 1000
+#define MODES 3
+
+enum { MODE_FAIL_FAST, MODE_SQLITE_TIMEOUT, MODE_BACKOFF };
+
+static const char *mode_names[MODES] = {"fail fast", "sqlite3_busy_timeout", "backoff"};
+
+typedef struct {
+    long committed;
+    long failed;
+    DbRetryStats stats;
+} WriterResult;
+
+static int exec(sqlite3 *db, const char *sql) {
+    char *err_msg = NULL;
+    if (sqlite3_exec(db, sql, NULL, NULL, &err_msg) != SQLITE_OK) {
+        fprintf(stderr, "SQL error: %s\n", err_msg);
+        sqlite3_free(err_msg);
+        return -1;
+    }
+    return 0;
+}
+
+static double now_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000.0 + ts.tv_nsec / 1e6;
+}
+
+static int compare_floats(const void *a, const void *b) {
+    float x = *(const float *)a, y = *(const float *)b;
+    return (x > y) - (x < y);
+}
+
+static void remove_database(const char *path) {
+    char side[600];
+    unlink(path);
+    snprintf(side, sizeof(side), "%s-wal", path);
+    unlink(side);
+    snprintf(side, sizeof(side), "%s-shm", path);
+    unlink(side);
+}
+
+static int create_database(const char *path, int writers) {
+    remove_database(path);
+    sqlite3 *db;
+    if (sqlite3_open(path, &db) != SQLITE_OK) {
+        fprintf(stderr, "Cannot open database: %s\n", sqlite3_errmsg(db));
+        sqlite3_close(db);
+        return -1;
+    }
+    set_db_connection(db);
+    if (create_tables() != 0 || migrate_schema() != 0 || create_indexes() != 0) {
+        sqlite3_close(db);
+        return -1;
+    }
+
+    char sql[768];
+    snprintf(sql, sizeof(sql),
+             "PRAGMA journal_mode = WAL;"
+             "WITH RECURSIVE n(i) AS (SELECT 1 UNION ALL SELECT i + 1 FROM n WHERE i < %d) "
+             "INSERT INTO Books (title, author, publisher, publication_year, isbn, genre, quantity, available) "
+             "SELECT printf('Book %%d', i), 'Author', 'Publisher', 2000, printf('%%010d', i), 'Fiction', "
+             "1000000, 1000000 FROM n;"
+             "WITH RECURSIVE n(i) AS (SELECT 1 UNION ALL SELECT i + 1 FROM n WHERE i < %d) "
+             "INSERT INTO Members (name, phone, address) SELECT printf('Writer %%d', i), '', '' FROM n;",
+             BENCH_BOOKS, writers);
+    int rc = exec(db, sql);
+    set_db_connection(NULL);
+    sqlite3_close(db);
+    return rc;
+}
+
+/* One writer process: alternate loans and returns, timing each transaction */
+static void run_writer(const char *path, int mode, int writer, int transactions, float *latencies,
+                       WriterResult *result) {
+    if (freopen("/dev/null", "w", stderr) == NULL) {    // failed loans report on stderr
+        return;
+    }
+    sqlite3 *db;
+    if (sqlite3_open(path, &db) != SQLITE_OK) {
+        result->failed = transactions;
+        return;
+    }
+    set_db_connection(db);    // installs the backoff handler
+    set_quiet_mode(1);
+    if (mode == MODE_FAIL_FAST) {
+        sqlite3_busy_handler(db, NULL, NULL);
+        set_busy_timeout(1);
+    } else if (mode == MODE_SQLITE_TIMEOUT) {
+        sqlite3_busy_timeout(db, DB_BUSY_TIMEOUT_MS);
+    }
+    reset_retry_stats();
+    srand((unsigned)getpid());
+
+    int loan_id = 0;
+    for (int i = 0; i < transactions; i++) {
+        double start = now_ms();
+        int ok;
+        if (loan_id > 0) {
+            ok = process_return(db, loan_id) > 0;
+            loan_id = 0;
+        } else {
+            loan_id = process_loan(db, 1 + rand() % BENCH_BOOKS, writer + 1, 14);
+            ok = loan_id > 0;
+        }
+        latencies[i] = (float)(now_ms() - start);
+        if (ok) {
+            result->committed++;
+        } else {
+            result->failed++;
+        }
+    }
+    get_retry_stats(&result->stats);
+    sqlite3_close(db);
+}
+
+static int run_mode(const char *path, int mode, int writers, int transactions, float *latencies,
+                    WriterResult *results) {
+    if (create_database(path, writers) != 0) {
+        return -1;
+    }
+    memset(results, 0, sizeof(WriterResult) * writers);
+
+    double start = now_ms();
+    for (int w = 0; w < writers; w++) {
+        pid_t pid = fork();
+        if (pid < 0) {
+            perror("fork");
+            return -1;
+        }
+        if (pid == 0) {
+            run_writer(path, mode, w, transactions, latencies + (size_t)w * transactions, &results[w]);
+            _exit(0);
+        }
+    }
+    for (int w = 0; w < writers; w++) {
+        wait(NULL);
+    }
+    double elapsed = now_ms() - start;
+
+    WriterResult total = {0, 0, {0, 0, 0, 0}};
+    for (int w = 0; w < writers; w++) {
+        total.committed += results[w].committed;
+        total.failed += results[w].failed;
+        total.stats.waits += results[w].stats.waits;
+        total.stats.retries += results[w].stats.retries;
+        total.stats.timeouts += results[w].stats.timeouts;
+        total.stats.wait_us += results[w].stats.wait_us;
+    }
+    size_t count = (size_t)writers * transactions;
+    qsort(latencies, count, sizeof(float), compare_floats);
+    printf("%-22s %9.0f %8ld %8ld %8ld %8ld %10.1f %8.2f %8.2f %8.2f\n", mode_names[mode],
+           total.committed * 1000.0 / elapsed, total.failed, total.stats.waits, total.stats.retries,
+           total.stats.timeouts, total.stats.wait_us / 1000.0, latencies[count / 2],
+           latencies[count * 99 / 100], latencies[count - 1]);
+    remove_database(path);
+    return 0;
+}
+
+int main(int argc, char **argv) {
+    int writers = argc > 1 ? atoi(argv[1]) : 4;
+    int transactions = argc > 2 ? atoi(argv[2]) : 2000;
+    const char *directory = argc > 3 ? argv[3] : "/tmp";
+    if (writers < 1 || transactions < 1) {
+        fprintf(stderr, "Usage: %s [writers] [transactions] [directory]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+    char path[512];
+    snprintf(path, sizeof(path), "%s/bench_busy_retry.db", directory);
+
+    /* Shared with the writers: their latencies and counters */
+    size_t latency_bytes = sizeof(float) * (size_t)writers * transactions;
+    float *latencies = mmap(NULL, latency_bytes, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    WriterResult *results = mmap(NULL, sizeof(WriterResult) * writers, PROT_READ | PROT_WRITE,
+                                 MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if (latencies == MAP_FAILED || results == MAP_FAILED) {
+        perror("mmap");
+        return EXIT_FAILURE;
+    }
+
+    set_quiet_mode(1);
+    printf("Writers: %d  Transactions per writer: %d\n\n", writers, transactions);
+    printf("%-22s %9s %8s %8s %8s %8s %10s %8s %8s %8s\n", "Mode", "commit/s", "failed", "waits", "retries",
+           "timeouts", "wait ms", "p50 ms", "p99 ms", "max ms");
+    for (int mode = 0; mode < MODES; mode++) {
+        if (run_mode(path, mode, writers, transactions, latencies, results) != 0) {
+            return EXIT_FAILURE;
+        }
+    }
+
+    munmap(latencies, latency_bytes);
+    munmap(results, sizeof(WriterResult) * writers);
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,95 @@
+/**
+ * @file bench_export.c
+ * @brief Measure export throughput and memory on a large Loans table.
+ * 
+ * Usage: bench_export [loans] [directory]
+ * 
+ * Builds a database file with the given number of loans (default
+ * 2,000,000) in directory (default /tmp), then exports the Loans table
+ * as CSV and JSON Lines, plain and gzip-compressed, and reports rows/sec, output
+ * size and the peak resident memory of the process after each export.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <sys/resource.h>
+#include <sqlite3.h>
+#include "database.h"
+#include "export.h"
+
+static int exec(sqlite3 *db, const char *sql) {
+    char *err_msg = NULL;
+    if (sqlite3_exec(db, sql, NULL, NULL, &err_msg) != SQLITE_OK) {
+        fprintf(stderr, "SQL error: %s\n", err_msg);
+        sqlite3_free(err_msg);
+        return -1;
+    }
+    return 0;
+}
+
+static long peak_rss_kib(void) {
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_maxrss;
+}
+
+int main(int argc, char **argv) {
+    int loans = argc > 1 ? atoi(argv[1]) : 2000000;
+    const char *directory = argc > 2 ? argv[2] : "/tmp";
+    char db_path[512], out_path[512], sql[1024];
+
+    snprintf(db_path, sizeof(db_path), "%s/bench_export.db", directory);
+    unlink(db_path);
+    sqlite3 *db;
+    if (sqlite3_open(db_path, &db) != SQLITE_OK) {
+        fprintf(stderr, "Cannot open database\n");
+        return EXIT_FAILURE;
+    }
+    set_db_connection(db);
+    set_quiet_mode(1);
+    if (create_tables() != 0 || migrate_schema() != 0 || create_indexes() != 0) {
+        return EXIT_FAILURE;
+    }
+
+    snprintf(sql, sizeof(sql),
+             "WITH RECURSIVE n(i) AS (SELECT 1 UNION ALL SELECT i + 1 FROM n WHERE i < %d) "
+             "INSERT INTO Loans (book_id, member_id, loan_date, due_date, is_returned, copy_id) "
+             "SELECT 1 + i %% 50000, 1 + i %% 5000, date('2020-01-01', '+' || (i %% 1500) || ' days'), "
+             "date('2020-01-15', '+' || (i %% 1500) || ' days'), i %% 20 != 0, "
+             "CASE WHEN i %% 3 = 0 THEN i END FROM n;", loans);
+    if (exec(db, sql) != 0) {
+        return EXIT_FAILURE;
+    }
+    printf("%d loans, peak RSS after building %ld KiB\n\n", loans, peak_rss_kib());
+    printf("%-10s %12s %14s %12s %14s\n", "Format", "Time (ms)", "Rows/sec", "Size (MiB)", "Peak RSS (KiB)");
+
+    struct {
+        const char *name;
+        ExportFormat format;
+        int gzip;
+        const char *suffix;
+    } runs[] = {
+        {"csv", EXPORT_FORMAT_CSV, 0, "csv"},
+        {"jsonl", EXPORT_FORMAT_JSONL, 0, "jsonl"},
+        {"csv.gz", EXPORT_FORMAT_CSV, 1, "csv.gz"},
+        {"jsonl.gz", EXPORT_FORMAT_JSONL, 1, "jsonl.gz"},
+    };
+    for (int i = 0; i < (int)(sizeof(runs) / sizeof(runs[0])); i++) {
+        if (runs[i].gzip && !export_gzip_available()) {
+            continue;
+        }
+        snprintf(out_path, sizeof(out_path), "%s/bench_export.%s", directory, runs[i].suffix);
+        ExportStats stats;
+        if (export_table_to_path(db, "loans", runs[i].format, runs[i].gzip, out_path, &stats) < 0) {
+            return EXIT_FAILURE;
+        }
+        printf("%-10s %12.1f %14.0f %12.1f %14ld\n", runs[i].name, stats.seconds * 1000.0,
+               stats.rows_per_second, stats.written / (1024.0 * 1024.0), peak_rss_kib());
+        unlink(out_path);
+    }
+
+    sqlite3_close(db);
+    unlink(db_path);
+    return EXIT_SUCCESS;
+}
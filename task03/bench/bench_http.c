@@ -0,0 +1,334 @@
+/**
+ * @file bench_http.c
+ * @brief Load test for the embedded HTTP server.
+ * 
+ * Usage: bench_http [connections] [requests] [workers] [cache_kib] [port]
+ * 
+ * Without a port, starts the server (default 4 workers) on a temporary
+ * database with 10,000 books and 1,000 members. Each client thread then
+ * keeps one connection alive (default 8 connections) and sends its
+ * requests (default 5,000) back to back: 70% title/author searches, 25%
+ * lookups by ID and 5% loans, each followed by its return. Each worker
+ * has a result cache of cache_kib KiB (default 8 MiB, 0 turns it off).
+ * With a port, targets a server already running on 127.0.0.1 and sends
+ * only the read requests.
+ * Reports requests per second and latency percentiles per request kind.
+ */
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <time.h>
+#include <unistd.h>
+#include <sqlite3.h>
+#include "database.h"
+#include "http_server.h"
+#include "result_cache.h"
+
+#define BOOKS 10000
+#define MEMBERS 1000
+#define KINDS 4
+
+static const char *kind_names[KINDS] = {"search", "lookup", "loan", "return"};
+static const char *words[] = {"river", "night", "garden", "stone", "winter", "light", "city", "sea"};
+
+typedef struct {
+    int port;
+    int requests;
+    int writes;              // 1 to send loans and returns
+    unsigned int seed;
+    double *latencies[KINDS];
+    int counts[KINDS];
+    int failures;
+} Client;
+
+static double now_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000.0 + ts.tv_nsec / 1e6;
+}
+
+static int exec(sqlite3 *db, const char *sql) {
+    char *err_msg = NULL;
+    if (sqlite3_exec(db, sql, NULL, NULL, &err_msg) != SQLITE_OK) {
+        fprintf(stderr, "SQL error: %s\n", err_msg);
+        sqlite3_free(err_msg);
+        return -1;
+    }
+    return 0;
+}
+
+/**
+ * @brief Create the schema and the catalog in a new database file.
+ */
+static int seed_database(const char *path) {
+    sqlite3 *db;
+    if (sqlite3_open(path, &db) != SQLITE_OK) {
+        return -1;
+    }
+    set_db_connection(db);
+    int rc = -1;
+    if (create_tables() == 0 && migrate_schema() == 0 && create_indexes() == 0 &&
+        exec(db, "BEGIN;") == 0 &&
+        exec(db, "WITH RECURSIVE n(i) AS (SELECT 1 UNION ALL SELECT i + 1 FROM n WHERE i < 10000) "
+                 "INSERT INTO Books (title, author, publisher, publication_year, isbn, genre, quantity, available) "
+                 "SELECT 'Book ' || i || ' of the ' || "
+                 "CASE i % 8 WHEN 0 THEN 'river' WHEN 1 THEN 'night' WHEN 2 THEN 'garden' "
+                 "WHEN 3 THEN 'stone' WHEN 4 THEN 'winter' WHEN 5 THEN 'light' WHEN 6 THEN 'city' "
+                 "ELSE 'sea' END, 'Author ' || (i % 500), 'Publisher', 1950 + i % 70, "
+                 "'B' || i, 'Genre ' || (i % 20), 5, 5 FROM n;") == 0 &&
+        exec(db, "WITH RECURSIVE n(i) AS (SELECT 1 UNION ALL SELECT i + 1 FROM n WHERE i < 1000) "
+                 "INSERT INTO Members (name, phone, address) "
+                 "SELECT 'Member ' || i, '010-0000-' || i, 'Seoul' FROM n;") == 0 &&
+        exec(db, "COMMIT;") == 0) {
+        rc = 0;
+    }
+    set_db_connection(NULL);
+    sqlite3_close(db);
+    return rc;
+}
+
+static int connect_to(int port) {
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    struct sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons((uint16_t)port);
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    if (fd < 0 || connect(fd, (struct sockaddr *)&addr, sizeof(addr)) != 0) {
+        perror("connect");
+        if (fd >= 0) close(fd);
+        return -1;
+    }
+    int one = 1;
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    return fd;
+}
+
+/**
+ * @brief Send one request and read its response into body.
+ * 
+ * @return int Returns the HTTP status, -1 if the connection failed.
+ */
+static int round_trip(int fd, const char *request, char *body, size_t size) {
+    size_t length = strlen(request);
+    for (size_t sent = 0; sent < length; ) {
+        ssize_t n = send(fd, request + sent, length - sent, MSG_NOSIGNAL);
+        if (n <= 0) return -1;
+        sent += (size_t)n;
+    }
+
+    static _Thread_local char buffer[HTTP_MAX_REQUEST * 4];
+    size_t received = 0;
+    char *header_end = NULL;
+    long content_length = 0;
+    while (1) {
+        ssize_t n = recv(fd, buffer + received, sizeof(buffer) - 1 - received, 0);
+        if (n <= 0) return -1;
+        received += (size_t)n;
+        buffer[received] = '\0';
+        if (header_end == NULL && (header_end = strstr(buffer, "\r\n\r\n")) != NULL) {
+            char *field = strstr(buffer, "Content-Length: ");
+            content_length = field != NULL ? strtol(field + 16, NULL, 10) : 0;
+        }
+        if (header_end != NULL && received >= (size_t)(header_end + 4 - buffer) + (size_t)content_length) {
+            break;
+        }
+        if (received == sizeof(buffer) - 1) return -1;
+    }
+    snprintf(body, size, "%s", header_end + 4);
+    return atoi(buffer + 9);
+}
+
+static void record(Client *client, int kind, double start) {
+    client->latencies[kind][client->counts[kind]++] = now_ms() - start;
+}
+
+static void *client_main(void *arg) {
+    Client *client = arg;
+    int fd = connect_to(client->port);
+    if (fd < 0) {
+        client->failures = client->requests;
+        return NULL;
+    }
+
+    char request[256];
+    char body[4096];
+    for (int i = 0; i < client->requests; i++) {
+        int dice = rand_r(&client->seed) % 100;
+        int book_id = 1 + rand_r(&client->seed) % BOOKS;
+        int kind = dice < 70 ? 0 : (dice < 95 || !client->writes) ? 1 : 2;
+        if (kind == 0) {
+            if (dice % 2 == 0) {
+                snprintf(request, sizeof(request), "GET /books?q=%s&limit=10 HTTP/1.1\r\nHost: bench\r\n\r\n",
+                         words[rand_r(&client->seed) % 8]);
+            } else {
+                snprintf(request, sizeof(request), "GET /books?q=Author+%d&limit=10 HTTP/1.1\r\nHost: bench\r\n\r\n",
+                         rand_r(&client->seed) % 500);
+            }
+        } else if (kind == 1) {
+            snprintf(request, sizeof(request), "GET /books/%d HTTP/1.1\r\nHost: bench\r\n\r\n", book_id);
+        } else {
+            snprintf(request, sizeof(request),
+                     "POST /loans?book_id=%d&member_id=%d HTTP/1.1\r\nHost: bench\r\nContent-Length: 0\r\n\r\n",
+                     book_id, 1 + rand_r(&client->seed) % MEMBERS);
+        }
+
+        double start = now_ms();
+        int status = round_trip(fd, request, body, sizeof(body));
+        if (status < 0) {
+            client->failures += client->requests - i;
+            break;
+        }
+        record(client, kind, start);
+        if (status >= 400) {
+            client->failures++;
+            continue;
+        }
+
+        if (kind == 2) {
+            snprintf(request, sizeof(request),
+                     "POST /returns?loan_id=%d HTTP/1.1\r\nHost: bench\r\nContent-Length: 0\r\n\r\n",
+                     atoi(body + strlen("{\"loan_id\":")));
+            start = now_ms();
+            status = round_trip(fd, request, body, sizeof(body));
+            if (status < 0) {
+                break;
+            }
+            record(client, 3, start);
+            if (status >= 400) {
+                client->failures++;
+            }
+        }
+    }
+    close(fd);
+    return NULL;
+}
+
+static int compare_double(const void *a, const void *b) {
+    double x = *(const double *)a, y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+static double percentile(const double *sorted, int count, double p) {
+    int index = (int)(p * (count - 1) + 0.5);
+    return sorted[index];
+}
+
+static void print_latencies(const char *name, double *values, int count) {
+    if (count == 0) {
+        return;
+    }
+    qsort(values, (size_t)count, sizeof(double), compare_double);
+    printf("  %-8s %8d  p50 %6.3f  p90 %6.3f  p99 %6.3f  max %7.3f ms\n", name, count,
+           percentile(values, count, 0.50), percentile(values, count, 0.90),
+           percentile(values, count, 0.99), values[count - 1]);
+}
+
+int main(int argc, char *argv[]) {
+    int connections = argc > 1 ? atoi(argv[1]) : 8;
+    int requests = argc > 2 ? atoi(argv[2]) : 5000;
+    int workers = argc > 3 ? atoi(argv[3]) : HTTP_DEFAULT_WORKERS;
+    long cache_kib = argc > 4 ? atol(argv[4]) : RESULT_CACHE_DEFAULT_BUDGET / 1024;
+    int port = argc > 5 ? atoi(argv[5]) : 0;
+    if (connections <= 0 || requests <= 0 || workers <= 0 || cache_kib < 0) {
+        fprintf(stderr, "Usage: %s [connections] [requests] [workers] [cache_kib] [port]\n", argv[0]);
+        return 1;
+    }
+
+    char path[] = "/tmp/bench_httpXXXXXX";
+    int own_server = port == 0;
+    if (own_server) {
+        int fd = mkstemp(path);
+        if (fd < 0) {
+            perror("mkstemp");
+            return 1;
+        }
+        close(fd);
+        set_quiet_mode(1);
+        HttpServerConfig config = {path, NULL, 0, workers, (size_t)cache_kib * 1024};
+        if (seed_database(path) != 0 || http_server_start(&config) != 0) {
+            unlink(path);
+            return 1;
+        }
+        port = http_server_port();
+        printf("Server: %d workers, %ld KiB result cache each, %d books, %d members\n",
+               workers, cache_kib, BOOKS, MEMBERS);
+    }
+    printf("Clients: %d keep-alive connections x %d requests\n", connections, requests);
+
+    Client *clients = calloc((size_t)connections, sizeof(Client));
+    pthread_t *threads = calloc((size_t)connections, sizeof(pthread_t));
+    for (int c = 0; c < connections; c++) {
+        clients[c].port = port;
+        clients[c].requests = requests;
+        clients[c].writes = own_server;
+        clients[c].seed = 12345u + (unsigned int)c;
+        for (int k = 0; k < KINDS; k++) {
+            clients[c].latencies[k] = malloc((size_t)requests * sizeof(double));
+        }
+    }
+
+    double start = now_ms();
+    for (int c = 0; c < connections; c++) {
+        pthread_create(&threads[c], NULL, client_main, &clients[c]);
+    }
+    for (int c = 0; c < connections; c++) {
+        pthread_join(threads[c], NULL);
+    }
+    double elapsed = now_ms() - start;
+
+    long total = 0;
+    int failures = 0;
+    double *all = malloc((size_t)connections * requests * 2 * sizeof(double));
+    printf("\n");
+    for (int k = 0; k < KINDS; k++) {
+        int count = 0;
+        double *values = malloc((size_t)connections * requests * sizeof(double));
+        for (int c = 0; c < connections; c++) {
+            memcpy(values + count, clients[c].latencies[k], (size_t)clients[c].counts[k] * sizeof(double));
+            memcpy(all + total, clients[c].latencies[k], (size_t)clients[c].counts[k] * sizeof(double));
+            count += clients[c].counts[k];
+            total += clients[c].counts[k];
+        }
+        print_latencies(kind_names[k], values, count);
+        free(values);
+    }
+    print_latencies("all", all, (int)total);
+    for (int c = 0; c < connections; c++) {
+        failures += clients[c].failures;
+    }
+    printf("\n%ld requests in %.1f ms: %.0f requests/sec, %d failed\n",
+           total, elapsed, total * 1000.0 / elapsed, failures);
+
+    if (own_server) {
+        HttpServerStats stats;
+        http_server_stats(&stats);
+        printf("Server: %ld connections, %ld requests, %ld errors\n",
+               stats.connections, stats.requests, stats.errors);
+        printf("Result cache: %ld hits, %ld misses, %ld evictions\n",
+               stats.cache_hits, stats.cache_misses, stats.cache_evictions);
+        http_server_stop();
+        unlink(path);
+        char side_file[sizeof(path) + 4];
+        snprintf(side_file, sizeof(side_file), "%s-wal", path);
+        unlink(side_file);
+        snprintf(side_file, sizeof(side_file), "%s-shm", path);
+        unlink(side_file);
+    }
+
+    for (int c = 0; c < connections; c++) {
+        for (int k = 0; k < KINDS; k++) {
+            free(clients[c].latencies[k]);
+        }
+    }
+    free(all);
+    free(clients);
+    free(threads);
+    return 0;
+}
@@ -0,0 +1,221 @@
+/**
+ * @file bench_query.cpp
+ * @brief Compare the C++ query wrapper with the C query path.
+ * 
+ * Usage: bench_query [books] [lookups]
+ * 
+ * Fills an in-memory catalogue (default 100,000 books) and reports, per
+ * row, the time, the SQLite heap allocations, the C++ heap allocations
+ * and the text bytes copied out of SQLite for:
+ *   - lookups by ID (default 200,000): get_book_by_id(), which prepares
+ *     a statement per call and strncpy()s every text column into a Book,
+ *     against a cached wrapper statement returning string_views;
+ *   - a full scan: the C loop of book.c copying each row into a Book,
+ *     against the wrapper's row iterator.
+ */
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <string_view>
+#include <sqlite3.h>
+
+#include "query.hpp"
+
+extern "C" {
+    #include "database.h"
+    #include "book.h"
+}
+
+/* Heap allocations, counted by wrapping SQLite's allocator and operator new */
+static std::atomic<long> sqlite_allocs{0};
+static std::atomic<long> cxx_allocs{0};
+static sqlite3_mem_methods default_mem;
+
+static void *count_malloc(int size) {
+    sqlite_allocs++;
+    return default_mem.xMalloc(size);
+}
+
+static void *count_realloc(void *p, int size) {
+    sqlite_allocs++;
+    return default_mem.xRealloc(p, size);
+}
+
+void *operator new(size_t size) {
+    cxx_allocs++;
+    if (void *p = std::malloc(size ? size : 1)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void *p) noexcept {
+    std::free(p);
+}
+
+void operator delete(void *p, size_t) noexcept {
+    std::free(p);
+}
+
+static int exec(sqlite3 *db, const char *sql) {
+    char *err_msg = NULL;
+    if (sqlite3_exec(db, sql, NULL, NULL, &err_msg) != SQLITE_OK) {
+        fprintf(stderr, "SQL error: %s\n", err_msg);
+        sqlite3_free(err_msg);
+        return -1;
+    }
+    return 0;
+}
+
+static double now_ms(void) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+struct Sample {
+    double start_ms;
+    long sqlite_start;
+    long cxx_start;
+};
+
+static Sample begin_sample(void) {
+    return {now_ms(), sqlite_allocs.load(), cxx_allocs.load()};
+}
+
+static void report(const char *name, const Sample &sample, long rows, long text_bytes) {
+    double elapsed = now_ms() - sample.start_ms;
+    printf("%-26s %10.3f %12.2f %12.2f %12.1f\n", name, elapsed * 1000.0 / rows,
+           (double)(sqlite_allocs - sample.sqlite_start) / rows, (double)(cxx_allocs - sample.cxx_start) / rows,
+           (double)text_bytes / rows);
+}
+
+/* Text columns of a Book, as strncpy() fills them (padded to the field size) */
+static const long BOOK_TEXT_BYTES = sizeof(Book::title) + sizeof(Book::author) + sizeof(Book::publisher) +
+                                    sizeof(Book::isbn) + sizeof(Book::genre);
+
+struct BookView {
+    int book_id;
+    std::string_view title;
+    std::string_view author;
+    std::string_view publisher;
+    int publication_year;
+    std::string_view isbn;
+    std::string_view genre;
+    int quantity;
+    int available;
+};
+
+static const char *BOOK_COLUMNS_SQL =
+    "SELECT book_id, title, author, publisher, publication_year, isbn, genre, quantity, available FROM Books";
+
+static void copy_text(char *dst, size_t size, const unsigned char *src) {
+    strncpy(dst, src ? (const char *)src : "", size - 1);
+    dst[size - 1] = '\0';
+}
+
+int main(int argc, char **argv) {
+    int books = argc > 1 ? atoi(argv[1]) : 100000;
+    int lookups = argc > 2 ? atoi(argv[2]) : 200000;
+
+    sqlite3_config(SQLITE_CONFIG_GETMALLOC, &default_mem);
+    sqlite3_mem_methods counted = default_mem;
+    counted.xMalloc = count_malloc;
+    counted.xRealloc = count_realloc;
+    sqlite3_config(SQLITE_CONFIG_MALLOC, &counted);
+
+    sqlite3 *db;
+    if (sqlite3_open(":memory:", &db) != SQLITE_OK) {
+        fprintf(stderr, "Cannot open database\n");
+        return EXIT_FAILURE;
+    }
+    set_db_connection(db);
+    set_quiet_mode(1);
+    if (create_tables() != 0 || migrate_schema() != 0) {
+        return EXIT_FAILURE;
+    }
+
+    char sql[512];
+    snprintf(sql, sizeof(sql),
+             "WITH RECURSIVE n(i) AS (SELECT 1 UNION ALL SELECT i + 1 FROM n WHERE i < %d) "
+             "INSERT INTO Books (title, author, publisher, publication_year, isbn, genre, quantity, available) "
+             "SELECT printf('Book title number %%d', i), printf('Author %%d', i %% 5000), 'Publisher', "
+             "1950 + i %% 70, printf('%%010d', i), 'Fiction', 3, 3 FROM n;", books);
+    if (exec(db, sql) != 0) {
+        return EXIT_FAILURE;
+    }
+
+    printf("Books: %d  Lookups: %d\n\n", books, lookups);
+    printf("%-26s %10s %12s %12s %12s\n", "Path", "us/row", "SQLite mallocs", "C++ news", "Text bytes");
+
+    /* Lookups by ID */
+    long checksum_c = 0, checksum_cxx = 0;
+    Sample sample = begin_sample();
+    Book book;
+    for (int i = 0; i < lookups; i++) {
+        if (get_book_by_id(1 + (int)((i * 2654435761u) % (unsigned)books), &book) == 0) {
+            checksum_c += book.publication_year + (long)strlen(book.title);
+        }
+    }
+    report("lookup: get_book_by_id", sample, lookups, BOOK_TEXT_BYTES * lookups);
+
+    {
+        library::StatementCache cache(db);
+        std::string lookup_sql = std::string(BOOK_COLUMNS_SQL) + " WHERE book_id = ?";
+        cache.prepare(lookup_sql);    // the first prepare is not part of the steady state
+        sample = begin_sample();
+        for (int i = 0; i < lookups; i++) {
+            auto stmt = cache.prepare(lookup_sql);
+            auto row = stmt.bind(1 + (int)((i * 2654435761u) % (unsigned)books))
+                           .first_as<BookView, int, std::string_view, std::string_view, std::string_view, int,
+                                     std::string_view, std::string_view, int, int>();
+            if (row) {
+                checksum_cxx += row->publication_year + (long)row->title.size();
+            }
+        }
+        report("lookup: query.hpp", sample, lookups, 0);
+    }
+
+    /* Full scan */
+    long rows_c = 0, rows_cxx = 0;
+    sample = begin_sample();
+    sqlite3_stmt *stmt;
+    if (sqlite3_prepare_v2(db, BOOK_COLUMNS_SQL, -1, &stmt, NULL) != SQLITE_OK) {
+        fprintf(stderr, "Failed to prepare statement: %s\n", sqlite3_errmsg(db));
+        return EXIT_FAILURE;
+    }
+    while (sqlite3_step(stmt) == SQLITE_ROW) {
+        book.book_id = sqlite3_column_int(stmt, 0);
+        copy_text(book.title, sizeof(book.title), sqlite3_column_text(stmt, 1));
+        copy_text(book.author, sizeof(book.author), sqlite3_column_text(stmt, 2));
+        copy_text(book.publisher, sizeof(book.publisher), sqlite3_column_text(stmt, 3));
+        book.publication_year = sqlite3_column_int(stmt, 4);
+        copy_text(book.isbn, sizeof(book.isbn), sqlite3_column_text(stmt, 5));
+        copy_text(book.genre, sizeof(book.genre), sqlite3_column_text(stmt, 6));
+        book.quantity = sqlite3_column_int(stmt, 7);
+        book.available = sqlite3_column_int(stmt, 8);
+        checksum_c += book.publication_year + (long)strlen(book.title);
+        rows_c++;
+    }
+    sqlite3_finalize(stmt);
+    report("scan: C loop into Book", sample, rows_c, BOOK_TEXT_BYTES * rows_c);
+
+    {
+        library::StatementCache cache(db);
+        sample = begin_sample();
+        auto scan = cache.prepare(BOOK_COLUMNS_SQL);
+        for (const BookView &row : scan.rows_as<BookView, int, std::string_view, std::string_view,
+                                                std::string_view, int, std::string_view, std::string_view,
+                                                int, int>()) {
+            checksum_cxx += row.publication_year + (long)row.title.size();
+            rows_cxx++;
+        }
+        report("scan: query.hpp", sample, rows_cxx, 0);
+    }
+
+    printf("\nSame results: %s\n", checksum_c == checksum_cxx && rows_c == rows_cxx ? "yes" : "NO");
+    sqlite3_close(db);
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,159 @@
+/**
+ * @file bench_result_cache.c
+ * @brief Measure the query result cache on repeated reports and searches.
+ * 
+ * Usage: bench_result_cache [books] [reads] [reads_per_write]
+ * 
+ * Builds an in-memory library (default 20,000 books, 2,000 members and
+ * 60,000 loans, some overdue) and runs a mix of the popular books report,
+ * the overdue report and ten common searches (default 2,000 reads) with
+ * listings written as CSV to /dev/null. Every reads_per_write reads
+ * (default 50) a loan is made and returned, which invalidates the cache.
+ * The same sequence runs without and with the cache.
+ */
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+#include <sqlite3.h>
+#include "database.h"
+#include "book.h"
+#include "loan.h"
+#include "table.h"
+#include "result_cache.h"
+
+static const char *searches[] = {
+    "Author 1", "Author 22", "소설", "Collected", "Stories 12", "제1", "Author 7", "Publisher", "Author 300", "선집"
+};
+
+static double now_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000.0 + ts.tv_nsec / 1e6;
+}
+
+static int exec(sqlite3 *db, const char *sql) {
+    char *err_msg = NULL;
+    if (sqlite3_exec(db, sql, NULL, NULL, &err_msg) != SQLITE_OK) {
+        fprintf(stderr, "SQL error: %s\n", err_msg);
+        sqlite3_free(err_msg);
+        return -1;
+    }
+    return 0;
+}
+
+/**
+ * @brief Run the read/write sequence with stdout sent to /dev/null.
+ * 
+ * @return double Returns the elapsed time in milliseconds, or -1 on failure.
+ */
+static double run_workload(sqlite3 *db, int reads, int reads_per_write, int books, int members) {
+    fflush(stdout);
+    int saved_stdout = dup(STDOUT_FILENO);
+    int null_fd = open("/dev/null", O_WRONLY);
+    if (saved_stdout < 0 || null_fd < 0) {
+        return -1;
+    }
+    dup2(null_fd, STDOUT_FILENO);
+
+    unsigned int seed = 42;
+    double start = now_ms();
+    for (int i = 0; i < reads; i++) {
+        int kind = i % 4;
+        if (kind == 0) {
+            get_popular_books(db, 10);
+        } else if (kind == 1) {
+            display_overdue_report(db);
+        } else {
+            search_book(searches[rand_r(&seed) % 10]);
+        }
+
+        if (reads_per_write > 0 && (i + 1) % reads_per_write == 0) {
+            int loan_id = process_loan(db, 1 + rand_r(&seed) % books, 1 + rand_r(&seed) % members, 14);
+            if (loan_id > 0) {
+                process_return(db, loan_id);
+            }
+        }
+    }
+    fflush(stdout);
+    double elapsed = now_ms() - start;
+
+    dup2(saved_stdout, STDOUT_FILENO);
+    close(saved_stdout);
+    close(null_fd);
+    return elapsed;
+}
+
+int main(int argc, char **argv) {
+    int books = argc > 1 ? atoi(argv[1]) : 20000;
+    int reads = argc > 2 ? atoi(argv[2]) : 2000;
+    int reads_per_write = argc > 3 ? atoi(argv[3]) : 50;
+    int members = books / 10 > 0 ? books / 10 : 1;
+    char sql[1024];
+
+    sqlite3 *db;
+    if (sqlite3_open(":memory:", &db) != SQLITE_OK) {
+        fprintf(stderr, "Cannot open database\n");
+        return EXIT_FAILURE;
+    }
+    set_db_connection(db);
+    set_quiet_mode(1);
+    if (create_tables() != 0 || migrate_schema() != 0 || create_indexes() != 0 ||
+        init_loan_tables(db) != 0) {
+        return EXIT_FAILURE;
+    }
+
+    snprintf(sql, sizeof(sql),
+             "WITH RECURSIVE n(i) AS (SELECT 1 UNION ALL SELECT i + 1 FROM n WHERE i < %d) "
+             "INSERT INTO Books (title, author, publisher, publication_year, isbn, genre, quantity, available) "
+             "SELECT CASE WHEN i %% 2 THEN '한국 현대 소설 선집 제' || i || '권' ELSE 'Collected Stories ' || i END, "
+             "'Author ' || (i %% 1000), 'Publisher', 1990 + i %% 30, 'B' || i, '소설', 50, 47 FROM n;", books);
+    if (exec(db, sql) != 0) {
+        return EXIT_FAILURE;
+    }
+    snprintf(sql, sizeof(sql),
+             "WITH RECURSIVE n(i) AS (SELECT 1 UNION ALL SELECT i + 1 FROM n WHERE i < %d) "
+             "INSERT INTO Members (name, phone, address) SELECT 'Member ' || i, '', '' FROM n;", members);
+    if (exec(db, sql) != 0) {
+        return EXIT_FAILURE;
+    }
+    /* Three loans per book on average, the still open ones overdue */
+    snprintf(sql, sizeof(sql),
+             "WITH RECURSIVE n(i) AS (SELECT 1 UNION ALL SELECT i + 1 FROM n WHERE i < %d) "
+             "INSERT INTO Loans (book_id, member_id, loan_date, due_date, is_returned) "
+             "SELECT 1 + (i * 7919) %% %d, 1 + i %% %d, date('2024-01-01', '+' || (i %% 300) || ' days'), "
+             "date('2024-01-15', '+' || (i %% 300) || ' days'), i %% 20 != 0 FROM n;",
+             books * 3, books, members);
+    if (exec(db, sql) != 0) {
+        return EXIT_FAILURE;
+    }
+
+    table_set_pager(0);
+    table_set_format(TABLE_FORMAT_CSV);
+
+    double uncached = run_workload(db, reads, reads_per_write, books, members);
+    if (load_result_cache(RESULT_CACHE_DEFAULT_BUDGET) != 0) {
+        return EXIT_FAILURE;
+    }
+    double cached = run_workload(db, reads, reads_per_write, books, members);
+    ResultCacheStats stats;
+    get_result_cache_stats(&stats);
+    if (uncached < 0 || cached < 0) {
+        return EXIT_FAILURE;
+    }
+
+    printf("%d books, %d members, %d loans; %d reads, a write every %d\n\n",
+           books, members, books * 3, reads, reads_per_write);
+    printf("%-14s %10s %12s\n", "Cache", "Time (ms)", "Per read (ms)");
+    printf("%-14s %10.1f %12.3f\n", "off", uncached, uncached / reads);
+    printf("%-14s %10.1f %12.3f  (%.2fx)\n", "on", cached, cached / reads, uncached / cached);
+    printf("\nHits %ld, misses %ld, evictions %ld, invalidations %ld, not cached %ld\n",
+           stats.hits, stats.misses, stats.evictions, stats.invalidations, stats.uncached);
+    printf("Results %zu, memory %zu KiB of %zu KiB\n", stats.entries, stats.bytes / 1024, stats.budget / 1024);
+
+    free_result_cache();
+    sqlite3_close(db);
+    return EXIT_SUCCESS;
+}
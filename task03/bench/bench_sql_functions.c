@@ -0,0 +1,154 @@
+/**
+ * @file bench_sql_functions.c
+ * @brief Compare the integer date SQL functions with julianday() arithmetic.
+ * 
+ * Usage: bench_sql_functions [loans] [runs]
+ * 
+ * Builds an in-memory database with the given number of synthetic loans
+ * (default 1,000,000) and times each overdue query both ways, keeping the
+ * best of the given number of runs (default 3).
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <sqlite3.h>
+#include "database.h"
+
+#define BENCH_BOOKS 50000
+#define BENCH_MEMBERS 200000
+
+static double now_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000.0 + ts.tv_nsec / 1e6;
+}
+
+static int exec(sqlite3 *db, const char *sql) {
+    char *err_msg = NULL;
+    if (sqlite3_exec(db, sql, NULL, NULL, &err_msg) != SQLITE_OK) {
+        fprintf(stderr, "SQL error: %s\n", err_msg);
+        sqlite3_free(err_msg);
+        return -1;
+    }
+    return 0;
+}
+
+/**
+ * @brief Run a query to completion several times and return the best time.
+ */
+static double time_query(sqlite3 *db, const char *sql, int runs, long *rows) {
+    sqlite3_stmt *stmt;
+    if (sqlite3_prepare_v2(db, sql, -1, &stmt, NULL) != SQLITE_OK) {
+        fprintf(stderr, "Failed to prepare statement: %s\n", sqlite3_errmsg(db));
+        return -1;
+    }
+    double best = -1;
+    for (int run = 0; run < runs; run++) {
+        *rows = 0;
+        double start = now_ms();
+        while (sqlite3_step(stmt) == SQLITE_ROW) {
+            (*rows)++;
+        }
+        double elapsed = now_ms() - start;
+        if (best < 0 || elapsed < best) {
+            best = elapsed;
+        }
+        sqlite3_reset(stmt);
+    }
+    sqlite3_finalize(stmt);
+    return best;
+}
+
+static int populate(sqlite3 *db, long loans) {
+    char sql[1024];
+
+    if (exec(db, "BEGIN;") != 0) {
+        return -1;
+    }
+    snprintf(sql, sizeof(sql),
+             "WITH RECURSIVE n(i) AS (SELECT 1 UNION ALL SELECT i + 1 FROM n WHERE i < %d) "
+             "INSERT INTO Books (title, author, isbn, genre, quantity, available) "
+             "SELECT 'Book ' || i, 'Author ' || (i %% 5000), 'B' || i, 'Genre ' || (i %% 20), 5, 5 FROM n;",
+             BENCH_BOOKS);
+    if (exec(db, sql) != 0) {
+        return -1;
+    }
+    snprintf(sql, sizeof(sql),
+             "WITH RECURSIVE n(i) AS (SELECT 1 UNION ALL SELECT i + 1 FROM n WHERE i < %ld) "
+             "INSERT INTO Loans (book_id, member_id, loan_date, due_date, is_returned) "
+             "SELECT 1 + abs(random()) %% %d, 1 + abs(random()) %% %d, "
+             "date('2020-01-01', '+' || (i %% 1800) || ' days'), "
+             "date('2020-01-15', '+' || (i %% 1800) || ' days'), "
+             "(i %% 10) != 0 FROM n;",
+             loans, BENCH_BOOKS, BENCH_MEMBERS);
+    if (exec(db, sql) != 0) {
+        return -1;
+    }
+    return exec(db, "COMMIT;");
+}
+
+int main(int argc, char **argv) {
+    static const struct {
+        const char *name;
+        const char *julianday_sql;
+        const char *function_sql;
+    } queries[] = {
+        {"Days per loan (scan)",
+         "SELECT SUM(julianday('2025-01-01') - julianday(due_date)) FROM Loans;",
+         "SELECT SUM(overdue_days(due_date, '2025-01-01')) FROM Loans;"},
+        {"Overdue report (sorted)",
+         "SELECT loan_id, julianday('2025-01-01') - julianday(due_date) AS d FROM Loans "
+         "WHERE is_returned = 0 AND due_date < '2025-01-01' ORDER BY d DESC;",
+         "SELECT loan_id, overdue_days(due_date, '2025-01-01'), "
+         "suspension_days(overdue_days(due_date, '2025-01-01')) FROM Loans "
+         "WHERE is_returned = 0 AND due_date < '2025-01-01' ORDER BY due_date ASC, loan_id ASC;"},
+        {"Overdue > 30 days",
+         "SELECT loan_id FROM Loans WHERE is_returned = 0 "
+         "AND julianday('2025-01-01') - julianday(due_date) > 30;",
+         "SELECT loan_id FROM Loans WHERE is_returned = 0 "
+         "AND overdue_days(due_date, '2025-01-01') > 30;"},
+        {"Worst overdue per member",
+         "SELECT member_id, MAX(julianday('2025-01-01') - julianday(due_date)) FROM Loans "
+         "WHERE is_returned = 0 GROUP BY member_id;",
+         "SELECT member_id, MAX(overdue_days(due_date, '2025-01-01')) FROM Loans "
+         "WHERE is_returned = 0 GROUP BY member_id;"}
+    };
+
+    long loans = argc > 1 ? atol(argv[1]) : 1000000;
+    int runs = argc > 2 ? atoi(argv[2]) : 3;
+
+    sqlite3 *db;
+    if (sqlite3_open(":memory:", &db) != SQLITE_OK) {
+        fprintf(stderr, "Cannot open database\n");
+        return EXIT_FAILURE;
+    }
+    set_db_connection(db);
+    if (create_tables() != 0 || migrate_schema() != 0) {
+        return EXIT_FAILURE;
+    }
+
+    printf("Generating %ld loans...\n", loans);
+    double start = now_ms();
+    if (populate(db, loans) != 0 || create_indexes() != 0) {
+        return EXIT_FAILURE;
+    }
+    printf("  generated in %.0f ms\n\n", now_ms() - start);
+
+    printf("%-26s %10s %14s %14s %8s\n", "Query", "Rows", "julianday", "C function", "Speedup");
+    for (size_t i = 0; i < sizeof(queries) / sizeof(queries[0]); i++) {
+        long julianday_rows, function_rows;
+        double julianday_ms = time_query(db, queries[i].julianday_sql, runs, &julianday_rows);
+        double function_ms = time_query(db, queries[i].function_sql, runs, &function_rows);
+        if (julianday_ms < 0 || function_ms < 0 || julianday_rows != function_rows) {
+            fprintf(stderr, "%s: queries disagree\n", queries[i].name);
+            return EXIT_FAILURE;
+        }
+        printf("%-26s %10ld %11.1f ms %11.1f ms %7.2fx\n", queries[i].name, function_rows,
+               julianday_ms, function_ms, julianday_ms / function_ms);
+    }
+
+    set_db_connection(NULL);
+    sqlite3_close(db);
+    return EXIT_SUCCESS;
+}
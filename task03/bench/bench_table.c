@@ -0,0 +1,131 @@
+/**
+ * @file bench_table.c
+ * @brief Compare the buffered table renderer with printf-per-row listings.
+ * 
+ * Usage: bench_table [books]
+ * 
+ * Lists an in-memory catalog (default 100,000 books, half with Korean
+ * titles) into a pipe drained by cat, with stdout line buffered as it is
+ * on a terminal.
+ * The baseline prints each row with one printf, as display_all_books()
+ * used to; the renderer is timed through display_all_books() in each
+ * output format.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+#include <sqlite3.h>
+#include "database.h"
+#include "book.h"
+#include "table.h"
+
+static double now_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000.0 + ts.tv_nsec / 1e6;
+}
+
+static int exec(sqlite3 *db, const char *sql) {
+    char *err_msg = NULL;
+    if (sqlite3_exec(db, sql, NULL, NULL, &err_msg) != SQLITE_OK) {
+        fprintf(stderr, "SQL error: %s\n", err_msg);
+        sqlite3_free(err_msg);
+        return -1;
+    }
+    return 0;
+}
+
+/**
+ * @brief The previous display_all_books(): one printf per row.
+ */
+static int display_all_books_printf(sqlite3 *db) {
+    const char *sql = "SELECT book_id, title, author, publisher, publication_year, isbn, genre, quantity, available "
+                      "FROM Books ORDER BY book_id;";
+    sqlite3_stmt *stmt;
+    if (sqlite3_prepare_v2(db, sql, -1, &stmt, NULL) != SQLITE_OK) {
+        return -1;
+    }
+
+    printf("\n=== All Books ===\n");
+    printf("%-5s %-30s %-20s %-20s %-6s %-15s %-15s %-8s %-8s\n",
+           "ID", "Title", "Author", "Publisher", "Year", "ISBN", "Genre", "Quantity", "Available");
+    int count = 0;
+    while (sqlite3_step(stmt) == SQLITE_ROW) {
+        printf("%-5d %-30s %-20s %-20s %-6d %-15s %-15s %-8d %-8d\n",
+               sqlite3_column_int(stmt, 0), sqlite3_column_text(stmt, 1), sqlite3_column_text(stmt, 2),
+               sqlite3_column_text(stmt, 3), sqlite3_column_int(stmt, 4), sqlite3_column_text(stmt, 5),
+               sqlite3_column_text(stmt, 6), sqlite3_column_int(stmt, 7), sqlite3_column_int(stmt, 8));
+        count++;
+    }
+    sqlite3_finalize(stmt);
+    printf("\nTotal books: %d\n", count);
+    return count;
+}
+
+int main(int argc, char **argv) {
+    int books = argc > 1 ? atoi(argv[1]) : 100000;
+    char sql[640];
+
+    sqlite3 *db;
+    if (sqlite3_open(":memory:", &db) != SQLITE_OK) {
+        fprintf(stderr, "Cannot open database\n");
+        return EXIT_FAILURE;
+    }
+    set_db_connection(db);
+    set_quiet_mode(1);
+    if (create_tables() != 0 || migrate_schema() != 0 || create_indexes() != 0) {
+        return EXIT_FAILURE;
+    }
+
+    snprintf(sql, sizeof(sql),
+             "WITH RECURSIVE n(i) AS (SELECT 1 UNION ALL SELECT i + 1 FROM n WHERE i < %d) "
+             "INSERT INTO Books (title, author, publisher, publication_year, isbn, genre, quantity, available) "
+             "SELECT CASE WHEN i %% 2 THEN '한국 현대 소설 선집 제' || i || '권' ELSE 'Collected Stories ' || i END, "
+             "'Author ' || i, 'Publisher', 1990 + i %% 30, 'B' || i, '소설', 3, 2 FROM n;", books);
+    if (exec(db, sql) != 0) {
+        return EXIT_FAILURE;
+    }
+
+    /* Terminal-like stdout: line buffered, redirected into a pipe */
+    fflush(stdout);
+    int saved_stdout = dup(STDOUT_FILENO);
+    FILE *sink = popen("cat > /dev/null", "w");
+    if (saved_stdout < 0 || sink == NULL) {
+        return EXIT_FAILURE;
+    }
+    setvbuf(stdout, NULL, _IOLBF, BUFSIZ);
+    table_set_pager(0);
+
+    const char *names[] = {"printf per row", "table", "csv", "tsv", "json"};
+    double results[5];
+    for (int run = 0; run < 5; run++) {
+        dup2(fileno(sink), STDOUT_FILENO);
+        double start = now_ms();
+        int count;
+        if (run == 0) {
+            count = display_all_books_printf(db);
+        } else {
+            table_set_format((TableFormat)(run - 1));
+            count = display_all_books();
+        }
+        fflush(stdout);
+        results[run] = now_ms() - start;
+        dup2(saved_stdout, STDOUT_FILENO);
+        if (count != books) {
+            fprintf(stderr, "Listed %d of %d books\n", count, books);
+            return EXIT_FAILURE;
+        }
+    }
+    pclose(sink);
+
+    printf("%d books, line-buffered stdout into a pipe\n\n", books);
+    printf("%-16s %10s %10s\n", "Output", "Time (ms)", "Speedup");
+    for (int run = 0; run < 5; run++) {
+        printf("%-16s %10.1f %9.2fx\n", names[run], results[run], results[0] / results[run]);
+    }
+
+    sqlite3_close(db);
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,261 @@
+/**
+ * @file bench_update_statements.c
+ * @brief Compare cached update_book()/update_member() statements with prepare-per-call SQL.
+ * 
+ * Usage: bench_update_statements [updates]
+ * 
+ * Applies the given number of metadata corrections (default 200,000) to an
+ * in-memory catalog inside one transaction, cycling through every field
+ * combination. The baseline builds and prepares the UPDATE on each call,
+ * as update_book() and update_member() used to.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sqlite3.h>
+#include "database.h"
+#include "book.h"
+#include "member.h"
+#include "hangul.h"
+
+#define BENCH_BOOKS 20000
+#define BENCH_MEMBERS 20000
+
+static double now_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000.0 + ts.tv_nsec / 1e6;
+}
+
+static int exec(sqlite3 *db, const char *sql) {
+    char *err_msg = NULL;
+    if (sqlite3_exec(db, sql, NULL, NULL, &err_msg) != SQLITE_OK) {
+        fprintf(stderr, "SQL error: %s\n", err_msg);
+        sqlite3_free(err_msg);
+        return -1;
+    }
+    return 0;
+}
+
+/**
+ * @brief The previous update_book(): build the SQL, prepare, step, finalize.
+ */
+static int update_book_uncached(sqlite3 *db, int book_id, const char *title, const char *author,
+                                const char *publisher, int publication_year, const char *genre) {
+    char sql[1024] = "UPDATE Books SET ";
+    const char *separator = "";
+    if (title != NULL) {
+        strcat(sql, "title = ?, title_chosung = ?, title_jamo = ?");
+        separator = ", ";
+    }
+    if (author != NULL) {
+        strcat(sql, separator);
+        strcat(sql, "author = ?, author_chosung = ?, author_jamo = ?");
+        separator = ", ";
+    }
+    if (publisher != NULL) {
+        strcat(sql, separator);
+        strcat(sql, "publisher = ?");
+        separator = ", ";
+    }
+    if (publication_year > 0) {
+        strcat(sql, separator);
+        strcat(sql, "publication_year = ?");
+        separator = ", ";
+    }
+    if (genre != NULL) {
+        strcat(sql, separator);
+        strcat(sql, "genre = ?");
+    }
+    strcat(sql, " WHERE book_id = ?;");
+
+    sqlite3_stmt *stmt;
+    if (sqlite3_prepare_v2(db, sql, -1, &stmt, NULL) != SQLITE_OK) {
+        return -1;
+    }
+
+    char title_chosung[HANGUL_KEY_LEN], title_jamo[HANGUL_KEY_LEN];
+    char author_chosung[HANGUL_KEY_LEN], author_jamo[HANGUL_KEY_LEN];
+    int param = 1;
+    if (title != NULL) {
+        hangul_chosung_key(title, title_chosung, sizeof(title_chosung));
+        hangul_jamo_key(title, title_jamo, sizeof(title_jamo));
+        sqlite3_bind_text(stmt, param++, title, -1, SQLITE_STATIC);
+        sqlite3_bind_text(stmt, param++, title_chosung, -1, SQLITE_STATIC);
+        sqlite3_bind_text(stmt, param++, title_jamo, -1, SQLITE_STATIC);
+    }
+    if (author != NULL) {
+        hangul_chosung_key(author, author_chosung, sizeof(author_chosung));
+        hangul_jamo_key(author, author_jamo, sizeof(author_jamo));
+        sqlite3_bind_text(stmt, param++, author, -1, SQLITE_STATIC);
+        sqlite3_bind_text(stmt, param++, author_chosung, -1, SQLITE_STATIC);
+        sqlite3_bind_text(stmt, param++, author_jamo, -1, SQLITE_STATIC);
+    }
+    if (publisher != NULL) sqlite3_bind_text(stmt, param++, publisher, -1, SQLITE_STATIC);
+    if (publication_year > 0) sqlite3_bind_int(stmt, param++, publication_year);
+    if (genre != NULL) sqlite3_bind_text(stmt, param++, genre, -1, SQLITE_STATIC);
+    sqlite3_bind_int(stmt, param, book_id);
+
+    int rc = sqlite3_step(stmt);
+    sqlite3_finalize(stmt);
+    return rc == SQLITE_DONE ? 0 : -1;
+}
+
+/**
+ * @brief The previous update_member(): build the SQL, prepare, step, finalize.
+ */
+static int update_member_uncached(sqlite3 *db, int member_id, const char *name,
+                                  const char *phone, const char *address) {
+    char sql[512] = "UPDATE Members SET ";
+    const char *separator = "";
+    if (name) {
+        strcat(sql, "name = ?, name_chosung = ?, name_jamo = ?");
+        separator = ", ";
+    }
+    if (phone) {
+        strcat(sql, separator);
+        strcat(sql, "phone = ?");
+        separator = ", ";
+    }
+    if (address) {
+        strcat(sql, separator);
+        strcat(sql, "address = ?");
+    }
+    strcat(sql, " WHERE member_id = ?;");
+
+    sqlite3_stmt *stmt;
+    if (sqlite3_prepare_v2(db, sql, -1, &stmt, NULL) != SQLITE_OK) {
+        return -1;
+    }
+
+    char name_chosung[HANGUL_KEY_LEN], name_jamo[HANGUL_KEY_LEN];
+    int param = 1;
+    if (name) {
+        hangul_chosung_key(name, name_chosung, sizeof(name_chosung));
+        hangul_jamo_key(name, name_jamo, sizeof(name_jamo));
+        sqlite3_bind_text(stmt, param++, name, -1, SQLITE_STATIC);
+        sqlite3_bind_text(stmt, param++, name_chosung, -1, SQLITE_STATIC);
+        sqlite3_bind_text(stmt, param++, name_jamo, -1, SQLITE_STATIC);
+    }
+    if (phone) sqlite3_bind_text(stmt, param++, phone, -1, SQLITE_STATIC);
+    if (address) sqlite3_bind_text(stmt, param++, address, -1, SQLITE_STATIC);
+    sqlite3_bind_int(stmt, param, member_id);
+
+    int rc = sqlite3_step(stmt);
+    sqlite3_finalize(stmt);
+    return rc == SQLITE_DONE ? 0 : -1;
+}
+
+/**
+ * @brief Apply the book corrections; mask i % 31 + 1 selects the fields.
+ */
+static double run_book_updates(sqlite3 *db, long updates, int cached) {
+    double start = now_ms();
+    for (long i = 0; i < updates; i++) {
+        int mask = (int)(i % 31) + 1;
+        int book_id = (int)(i % BENCH_BOOKS) + 1;
+        const char *title = (mask & 1) ? "개정판 제목" : NULL;
+        const char *author = (mask & 2) ? "Corrected Author" : NULL;
+        const char *publisher = (mask & 4) ? "Corrected Publisher" : NULL;
+        int year = (mask & 8) ? 2000 + (int)(i % 25) : 0;
+        const char *genre = (mask & 16) ? "Corrected Genre" : NULL;
+        int rc = cached ? update_book(book_id, title, author, publisher, year, genre)
+                        : update_book_uncached(db, book_id, title, author, publisher, year, genre);
+        if (rc != 0) {
+            return -1;
+        }
+    }
+    return now_ms() - start;
+}
+
+/**
+ * @brief Apply the member corrections; mask i % 7 + 1 selects the fields.
+ */
+static double run_member_updates(sqlite3 *db, long updates, int cached) {
+    double start = now_ms();
+    for (long i = 0; i < updates; i++) {
+        int mask = (int)(i % 7) + 1;
+        int member_id = (int)(i % BENCH_MEMBERS) + 1;
+        const char *name = (mask & 1) ? "김정정" : NULL;
+        const char *phone = (mask & 2) ? "010-0000-0000" : NULL;
+        const char *address = (mask & 4) ? "Corrected Address" : NULL;
+        int rc = cached ? update_member(db, member_id, name, phone, address)
+                        : update_member_uncached(db, member_id, name, phone, address);
+        if (rc != 0) {
+            return -1;
+        }
+    }
+    return now_ms() - start;
+}
+
+int main(int argc, char **argv) {
+    long updates = argc > 1 ? atol(argv[1]) : 200000;
+    char sql[512];
+
+    sqlite3 *db;
+    if (sqlite3_open(":memory:", &db) != SQLITE_OK) {
+        fprintf(stderr, "Cannot open database\n");
+        return EXIT_FAILURE;
+    }
+    set_db_connection(db);
+    if (create_tables() != 0 || migrate_schema() != 0 || create_indexes() != 0) {
+        return EXIT_FAILURE;
+    }
+
+    snprintf(sql, sizeof(sql),
+             "WITH RECURSIVE n(i) AS (SELECT 1 UNION ALL SELECT i + 1 FROM n WHERE i < %d) "
+             "INSERT INTO Books (title, author, isbn, genre, quantity, available) "
+             "SELECT 'Book ' || i, 'Author ' || i, 'B' || i, 'Genre', 1, 1 FROM n;", BENCH_BOOKS);
+    if (exec(db, sql) != 0) {
+        return EXIT_FAILURE;
+    }
+    snprintf(sql, sizeof(sql),
+             "WITH RECURSIVE n(i) AS (SELECT 1 UNION ALL SELECT i + 1 FROM n WHERE i < %d) "
+             "INSERT INTO Members (name, phone, address) SELECT 'Member ' || i, '', '' FROM n;", BENCH_MEMBERS);
+    if (exec(db, sql) != 0) {
+        return EXIT_FAILURE;
+    }
+
+    /* update_book() reports every success on stdout; keep it out of the timings */
+    fflush(stdout);
+    int saved_stdout = dup(STDOUT_FILENO);
+    int devnull = open("/dev/null", O_WRONLY);
+    if (saved_stdout < 0 || devnull < 0) {
+        return EXIT_FAILURE;
+    }
+
+    double results[2][2];
+    for (int cached = 0; cached < 2; cached++) {
+        dup2(devnull, STDOUT_FILENO);
+        exec(db, "BEGIN;");
+        results[0][cached] = run_book_updates(db, updates, cached);
+        results[1][cached] = run_member_updates(db, updates, cached);
+        exec(db, "COMMIT;");
+        fflush(stdout);
+        dup2(saved_stdout, STDOUT_FILENO);
+    }
+    close(devnull);
+
+    if (results[0][0] < 0 || results[0][1] < 0 || results[1][0] < 0 || results[1][1] < 0) {
+        fprintf(stderr, "Update failed\n");
+        return EXIT_FAILURE;
+    }
+
+    printf("%ld updates per table, one transaction\n\n", updates);
+    printf("%-16s %16s %16s %8s\n", "Table", "Prepare per call", "Cached", "Speedup");
+    const char *names[] = {"Books (32 masks)", "Members (8)"};
+    for (int t = 0; t < 2; t++) {
+        printf("%-16s %13.1f ms %13.1f ms %7.2fx\n", names[t], results[t][0], results[t][1],
+               results[t][0] / results[t][1]);
+        printf("%-16s %13.2f us %13.2f us\n", "  per update",
+               results[t][0] * 1000.0 / updates, results[t][1] * 1000.0 / updates);
+    }
+
+    set_db_connection(NULL);
+    sqlite3_close(db);
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,140 @@
+#ifndef ANALYTICS_H
+#define ANALYTICS_H
+
+#include <sqlite3.h>
+#include <stdint.h>
+
+#define ANALYTICS_NEW_MEMBER_DAYS 30   // registration window counted as new members
+
+/**
+ * @brief One row of a group-by count (a book or a genre).
+ */
+typedef struct {
+    int id;      // book ID or genre ID
+    int count;   // number of loans
+} AnalyticsCount;
+
+/**
+ * @brief Loan status totals as of one day.
+ */
+typedef struct {
+    int total_loans;
+    int active_loans;
+    int overdue_loans;
+    int active_members;      // members with at least one active loan
+    int overdue_members;     // members with at least one overdue loan
+    int max_overdue_days;
+    int64_t overdue_days;    // sum over overdue loans
+} LoanSummary;
+
+/**
+ * @brief Member totals as of one day.
+ */
+typedef struct {
+    int total_members;
+    int new_members;         // registered in the last ANALYTICS_NEW_MEMBER_DAYS days
+    int suspended_members;   // suspended past the reference day
+    int active_members;      // members with at least one active loan
+    int overdue_members;     // members with at least one overdue loan
+} MemberSummary;
+
+/**
+ * @brief Stock totals over the books in the column store.
+ */
+typedef struct {
+    int titles;
+    int copies;              // sum of quantity
+    int on_loan;             // active loans of these books
+    int out_of_stock;        // titles with every copy on loan
+} InventorySummary;
+
+/**
+ * @brief Load Loans, Books and Members into the in-memory column store, or fold in new rows.
+ * 
+ * The first call loads every row. Later calls reload Books and Members in
+ * full, so edits and deletions show up, and only read loans and returns
+ * whose rowid is above the last one seen.
+ * 
+ * @param db SQLite database connection.
+ * @param num_threads Number of worker threads for the aggregates (1 or more).
+ * @return int Returns number of new loans, -1 on failure.
+ */
+int refresh_analytics(sqlite3 *db, int num_threads);
+
+/**
+ * @brief Free the column store.
+ */
+void free_analytics(void);
+
+/**
+ * @brief Count loans per book and return the most borrowed books.
+ * 
+ * @param results Array to store the books, most loans first (ties by lower ID).
+ * @param limit Maximum number of books to return.
+ * @return int Returns number of books found, -1 if the store is not loaded.
+ */
+int analytics_top_books(AnalyticsCount *results, int limit);
+
+/**
+ * @brief Count loans per genre.
+ * 
+ * @param results Array to store the genres, most loans first.
+ * @param max_count Maximum number of genres to return.
+ * @return int Returns number of genres found, -1 if the store is not loaded.
+ */
+int analytics_genre_counts(AnalyticsCount *results, int max_count);
+
+/**
+ * @brief Summarize active and overdue loans.
+ * 
+ * @param today Day number of the reference date (see date_to_day()).
+ * @param summary Pointer to store the totals.
+ * @return int Returns 0 on success, -1 on failure.
+ */
+int analytics_loan_summary(int today, LoanSummary *summary);
+
+/**
+ * @brief Summarize members: registrations, suspensions and borrowing.
+ * 
+ * @param today Day number of the reference date (see date_to_day()).
+ * @param summary Pointer to store the totals.
+ * @return int Returns 0 on success, -1 on failure.
+ */
+int analytics_member_summary(int today, MemberSummary *summary);
+
+/**
+ * @brief Summarize stock: copies per title against their active loans.
+ * 
+ * Books and their quantities are as of the last refresh_analytics().
+ * 
+ * @param summary Pointer to store the totals.
+ * @return int Returns 0 on success, -1 on failure.
+ */
+int analytics_inventory_summary(InventorySummary *summary);
+
+/**
+ * @brief Get the name of a genre ID returned by analytics_genre_counts().
+ * 
+ * @param genre_id The genre ID.
+ * @return const char* Returns the genre name, or NULL if unknown.
+ */
+const char *analytics_genre_name(int genre_id);
+
+/**
+ * @brief Get the title of a book known to the column store.
+ * 
+ * @param book_id The book ID.
+ * @return const char* Returns the title, or NULL if unknown.
+ */
+const char *analytics_book_title(int book_id);
+
+/**
+ * @brief Print the popular books, genre and loan status reports.
+ * 
+ * @param today Day number of the reference date.
+ * @param limit Number of popular books to list.
+ * @return int Returns 0 on success, -1 if the store is not loaded.
+ */
+int display_analytics_report(int today, int limit);
+
+#endif // ANALYTICS_H
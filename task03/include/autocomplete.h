@@ -0,0 +1,99 @@
+#ifndef AUTOCOMPLETE_H
+#define AUTOCOMPLETE_H
+
+#include <sqlite3.h>
+
+#define AUTOCOMPLETE_TEXT_LEN 100
+
+/**
+ * @brief Which column completions are drawn from.
+ */
+typedef enum {
+    AUTOCOMPLETE_TITLE = 0,    // Books.title
+    AUTOCOMPLETE_AUTHOR = 1,   // Books.author (one completion per distinct author)
+    AUTOCOMPLETE_MEMBER = 2    // Members.name
+} AutocompleteField;
+
+/**
+ * @brief One suggested completion.
+ */
+typedef struct {
+    int id;                            // book_id or member_id; 0 for authors
+    int loans;                         // popularity used for ranking
+    char text[AUTOCOMPLETE_TEXT_LEN];
+} Completion;
+
+/**
+ * @brief Build the prefix tries from Books and Members, weighted by loan counts.
+ * 
+ * Keys are the jamo keys of hangul.h, so a half-typed Hangul syllable or a
+ * prefix without spaces still completes. Any previously loaded tries are replaced.
+ * 
+ * @param db SQLite database connection.
+ * @return int Returns number of keys loaded, -1 on failure.
+ */
+int load_autocomplete(sqlite3 *db);
+
+/**
+ * @brief Release the prefix tries.
+ */
+void free_autocomplete(void);
+
+/**
+ * @brief Get the most borrowed completions of a prefix.
+ * 
+ * The tries are loaded from the global connection on first use.
+ * 
+ * @param field An AutocompleteField.
+ * @param prefix The text typed so far.
+ * @param results Array to store completions, most borrowed first.
+ * @param max_count Maximum number of completions to return.
+ * @return int Returns number of completions found, -1 on failure.
+ */
+int autocomplete(int field, const char *prefix, Completion *results, int max_count);
+
+/**
+ * @brief Re-read a book's title and author after it was added or updated.
+ * 
+ * Does nothing if the tries are not loaded. A book that no longer exists is removed.
+ * 
+ * @param db SQLite database connection.
+ * @param book_id The ID of the book.
+ * @return int Returns 0 on success, -1 on failure.
+ */
+int autocomplete_refresh_book(sqlite3 *db, int book_id);
+
+/**
+ * @brief Drop a deleted book. Does nothing if the tries are not loaded.
+ * 
+ * @param book_id The ID of the book.
+ */
+void autocomplete_remove_book(int book_id);
+
+/**
+ * @brief Re-read a member's name after it was added or updated.
+ * 
+ * Does nothing if the tries are not loaded. A member that no longer exists is removed.
+ * 
+ * @param db SQLite database connection.
+ * @param member_id The ID of the member.
+ * @return int Returns 0 on success, -1 on failure.
+ */
+int autocomplete_refresh_member(sqlite3 *db, int member_id);
+
+/**
+ * @brief Drop a deleted member. Does nothing if the tries are not loaded.
+ * 
+ * @param member_id The ID of the member.
+ */
+void autocomplete_remove_member(int member_id);
+
+/**
+ * @brief Count a new loan towards the popularity of its title, author and member.
+ * 
+ * @param book_id The ID of the borrowed book.
+ * @param member_id The ID of the borrowing member.
+ */
+void autocomplete_record_loan(int book_id, int member_id);
+
+#endif // AUTOCOMPLETE_H
@@ -50,6 +50,14 @@ int search_book(const char *keyword);
  */
 int get_book_by_id(int book_id, Book *book);
 
+/**
+ * @brief Find a book by ISBN, accepting any ISBN-10 or ISBN-13 spelling.
+ * 
+ * @param isbn The ISBN text (hyphens and spaces are ignored).
+ * @return int Returns the book ID, 0 if no book has this ISBN, -1 if the ISBN is invalid or on failure.
+ */
+int find_book_by_isbn(const char *isbn);
+
 /**
  * @brief Update book information.
  * 
@@ -92,7 +100,8 @@ int check_book_availability(int book_id);
  * 
  * @param book_id The ID of the book.
  * @param change The change in available quantity (positive or negative).
- * @return int Returns 0 on success, -1 on failure.
+ * @return int Returns 0 on success, -1 on failure (including a change that
+ *             would take the available quantity below zero).
  */
 int update_book_availability(int book_id, int change);
 
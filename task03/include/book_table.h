@@ -0,0 +1,194 @@
+#ifndef BOOK_TABLE_H
+#define BOOK_TABLE_H
+
+#include <sqlite3.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "book.h"
+
+#define BOOK_TABLE_NO_STRING 0   // string ID of NULL/empty text in every pool
+
+/* Column list expected by book_table_append_row(), in this order */
+#define BOOK_TABLE_COLUMNS "book_id, title, author, publisher, publication_year, isbn13, genre, quantity, available"
+
+/**
+ * @brief Growable byte buffer holding NUL-terminated strings back to back.
+ */
+typedef struct {
+    char *data;
+    uint32_t size;
+    uint32_t capacity;
+} StringArena;
+
+/**
+ * @brief Set of distinct strings, each identified by a small dense ID.
+ * 
+ * ID 0 is always the empty string.
+ */
+typedef struct {
+    StringArena arena;
+    uint32_t *offsets;      // by ID: offset of the string in arena
+    uint32_t count;
+    uint32_t capacity;
+    uint32_t *slots;        // open addressing, ID + 1 (0 = empty slot)
+    uint32_t slot_mask;
+} StringPool;
+
+/**
+ * @brief Column-oriented, read-mostly copy of the Books table.
+ * 
+ * Row i of every column describes the same book. Rows are kept in
+ * ascending book_id order so book_table_find() can binary search.
+ */
+typedef struct {
+    int count;
+    int capacity;
+    int32_t *book_ids;
+    uint32_t *title_offsets;    // into titles
+    uint32_t *author_ids;       // into authors
+    uint32_t *publisher_ids;    // into publishers
+    uint16_t *genre_ids;        // into genres
+    int16_t *years;
+    uint16_t *quantities;
+    uint16_t *available;
+    int64_t *isbn13;            // canonical ISBN key, 0 if invalid
+    StringArena titles;
+    StringPool authors;
+    StringPool publishers;
+    StringPool genres;
+} BookTable;
+
+/**
+ * @brief Initialize an empty string pool.
+ * 
+ * @param pool Pool to initialize.
+ * @return int Returns 0 on success, -1 on failure.
+ */
+int string_pool_init(StringPool *pool);
+
+/**
+ * @brief Free the memory held by a string pool.
+ * 
+ * @param pool Pool to free.
+ */
+void string_pool_free(StringPool *pool);
+
+/**
+ * @brief Get the ID of a string, adding it to the pool if needed.
+ * 
+ * @param pool The string pool.
+ * @param text NUL-terminated text (NULL is treated as empty).
+ * @return int64_t Returns the string ID, -1 on failure.
+ */
+int64_t string_pool_intern(StringPool *pool, const char *text);
+
+/**
+ * @brief Get the ID of a string already in the pool.
+ * 
+ * @param pool The string pool.
+ * @param text NUL-terminated text (NULL is treated as empty).
+ * @return int64_t Returns the string ID, -1 if the string is not in the pool.
+ */
+int64_t string_pool_find(const StringPool *pool, const char *text);
+
+/**
+ * @brief Get a string by ID.
+ * 
+ * @param pool The string pool.
+ * @param id String ID returned by string_pool_intern().
+ * @return const char* Returns the string, or NULL if the ID is out of range.
+ */
+const char *string_pool_get(const StringPool *pool, uint32_t id);
+
+/**
+ * @brief Initialize an empty book table.
+ * 
+ * @param table Table to initialize.
+ * @return int Returns 0 on success, -1 on failure.
+ */
+int book_table_init(BookTable *table);
+
+/**
+ * @brief Free the memory held by a book table.
+ * 
+ * @param table Table to free.
+ */
+void book_table_free(BookTable *table);
+
+/**
+ * @brief Append one book to the table.
+ * 
+ * @param table The book table.
+ * @param book_id Book ID, greater than the last appended ID.
+ * @param title Title (not truncated).
+ * @param author Author (interned).
+ * @param publisher Publisher (interned).
+ * @param publication_year Publication year.
+ * @param isbn13 Canonical ISBN key (see isbn_parse()).
+ * @param genre Genre (interned).
+ * @param quantity Total quantity (0 to 65535).
+ * @param available Available quantity (0 to 65535).
+ * @return int Returns the row index, -1 on failure.
+ */
+int book_table_append(BookTable *table, int book_id, const char *title, const char *author,
+                      const char *publisher, int publication_year, int64_t isbn13,
+                      const char *genre, int quantity, int available);
+
+/**
+ * @brief Append the current row of a statement selecting BOOK_TABLE_COLUMNS.
+ * 
+ * @param table The book table.
+ * @param stmt Statement positioned on a row.
+ * @return int Returns the row index, -1 on failure.
+ */
+int book_table_append_row(BookTable *table, sqlite3_stmt *stmt);
+
+/**
+ * @brief Load every book into an empty table.
+ * 
+ * @param db SQLite database connection.
+ * @param table Table initialized with book_table_init().
+ * @return int Returns number of books loaded, -1 on failure.
+ */
+int load_book_table(sqlite3 *db, BookTable *table);
+
+/**
+ * @brief Find the row of a book.
+ * 
+ * @param table The book table.
+ * @param book_id The book ID.
+ * @return int Returns the row index, -1 if the book is not in the table.
+ */
+int book_table_find(const BookTable *table, int book_id);
+
+/**
+ * @brief Get the title of a row.
+ * 
+ * @param table The book table.
+ * @param row Row index.
+ * @return const char* Returns the title.
+ */
+const char *book_table_title(const BookTable *table, int row);
+
+/**
+ * @brief Copy a row into a Book structure (strings are truncated to fit).
+ * 
+ * The ISBN is written as the canonical 13-digit ISBN, or left empty if the
+ * book has no valid ISBN.
+ * 
+ * @param table The book table.
+ * @param row Row index.
+ * @param book Pointer to Book structure to store the result.
+ * @return int Returns 0 on success, -1 if the row is out of range.
+ */
+int book_table_get(const BookTable *table, int row, Book *book);
+
+/**
+ * @brief Count the bytes held by the table, including strings and pools.
+ * 
+ * @param table The book table.
+ * @return size_t Returns the number of bytes in use.
+ */
+size_t book_table_memory(const BookTable *table);
+
+#endif // BOOK_TABLE_H
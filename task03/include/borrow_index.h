@@ -0,0 +1,134 @@
+#ifndef BORROW_INDEX_H
+#define BORROW_INDEX_H
+
+#include <sqlite3.h>
+#include "roaring.h"
+
+#define BORROW_INDEX_PATH "database/borrow_index.bin"
+#define BORROW_INDEX_SAVE_LOANS 10000    // pending loans that are written back to the file
+
+/**
+ * @brief Build the borrow history index from Loans and write it to a file.
+ * 
+ * For every member the file holds a Roaring bitmap of the books they have
+ * ever borrowed, and for every book a bitmap of its borrowers.
+ * 
+ * @param db SQLite database connection.
+ * @param path Output file path.
+ * @return int Returns number of distinct (member, book) pairs, -1 on failure.
+ */
+int build_borrow_index(sqlite3 *db, const char *path);
+
+/**
+ * @brief Memory-map an index file written by build_borrow_index().
+ * 
+ * Any previously opened index and pending updates are discarded.
+ * 
+ * @param path Index file path.
+ * @return int Returns 0 on success, -1 on failure.
+ */
+int open_borrow_index(const char *path);
+
+/**
+ * @brief Unmap the index and drop pending updates.
+ */
+void close_borrow_index(void);
+
+/**
+ * @brief Rebuild the open index from Loans into the file it was mapped from.
+ * 
+ * For changes that catch_up_borrow_index() cannot see, such as loans moved
+ * between books by merge_duplicate_books(). If no index is open, the file
+ * at BORROW_INDEX_PATH is rebuilt when it exists, so another process does
+ * not map stale rows from it later.
+ * 
+ * @param db SQLite database connection.
+ * @return int Returns number of distinct (member, book) pairs, -1 on failure.
+ */
+int rebuild_borrow_index(sqlite3 *db);
+
+/**
+ * @brief Fold loans newer than the index file into in-memory bitmaps.
+ * 
+ * Called after every loan; does nothing if no index is open, or inside a
+ * transaction: its loans may roll back and their IDs be reused, so they
+ * are picked up by the first call after it commits. Once
+ * BORROW_INDEX_SAVE_LOANS loans are pending, they are written back with
+ * flush_borrow_index(). Loans moved between books need rebuild_borrow_index().
+ * 
+ * @param db SQLite database connection.
+ * @return int Returns number of loans processed, -1 on failure.
+ */
+int catch_up_borrow_index(sqlite3 *db);
+
+/**
+ * @brief Check whether a member has ever borrowed a book.
+ * 
+ * @param member_id The member ID.
+ * @param book_id The book ID.
+ * @return int Returns 1 if so, 0 if not, -1 if no index is open.
+ */
+int borrow_index_has_borrowed(int member_id, int book_id);
+
+/**
+ * @brief Get every book a member has borrowed.
+ * 
+ * @param member_id The member ID.
+ * @param books Initialized bitmap; its contents are replaced.
+ * @return int Returns number of books, -1 if no index is open or memory ran out.
+ */
+int borrow_index_member_books(int member_id, RoaringBitmap *books);
+
+/**
+ * @brief Get every member who has borrowed a book.
+ * 
+ * @param book_id The book ID.
+ * @param members Initialized bitmap; its contents are replaced.
+ * @return int Returns number of members, -1 if no index is open or memory ran out.
+ */
+int borrow_index_book_members(int book_id, RoaringBitmap *members);
+
+/**
+ * @brief Get the members who have borrowed any of the given books.
+ * 
+ * The borrower bitmaps are unioned straight from the mapped file.
+ * 
+ * @param book_ids The book IDs.
+ * @param count Number of book IDs.
+ * @param members Initialized bitmap; its contents are replaced.
+ * @return int Returns number of members, -1 if no index is open or memory ran out.
+ */
+int borrow_index_members_of_any(const int *book_ids, int count, RoaringBitmap *members);
+
+/**
+ * @brief Get the members who have borrowed all of the given books.
+ * 
+ * The borrower bitmaps are intersected straight from the mapped file.
+ * 
+ * @param book_ids The book IDs (at least one).
+ * @param count Number of book IDs.
+ * @param members Initialized bitmap; its contents are replaced.
+ * @return int Returns number of members, -1 if no index is open or memory ran out.
+ */
+int borrow_index_members_of_all(const int *book_ids, int count, RoaringBitmap *members);
+
+/**
+ * @brief Write the open index merged with pending updates to a new file.
+ * 
+ * The new file is opened in place of the current one.
+ * 
+ * @param path Output file path (may be the currently opened path).
+ * @return int Returns 0 on success, -1 on failure.
+ */
+int save_borrow_index(const char *path);
+
+/**
+ * @brief Write pending updates back to the file the index was mapped from.
+ * 
+ * Called on exit, so the next start does not fold the same loans in again.
+ * 
+ * @return int Returns 1 if the file was written, 0 if nothing was pending, -1 on failure.
+ */
+int flush_borrow_index(void);
+
+#endif // BORROW_INDEX_H
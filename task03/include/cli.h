@@ -0,0 +1,91 @@
+#ifndef CLI_H
+#define CLI_H
+
+#include <sqlite3.h>
+#include <stdio.h>
+
+#define CLI_MAX_ARGS 32                  // arguments per command, including its name
+#define CLI_MAX_LINE 1024                // characters per script line
+#define CLI_OUTPUT_BUFFER (64 * 1024)    // stdout buffer in command mode
+
+/* Exit codes of the command mode */
+#define CLI_EXIT_OK 0          // every command succeeded
+#define CLI_EXIT_FAILED 1      // at least one command failed
+#define CLI_EXIT_USAGE 2       // bad command line
+
+/**
+ * @brief Totals of a script run.
+ */
+typedef struct {
+    int commands;
+    int succeeded;
+    int failed;
+    int rolled_back;    // 1 if a shared transaction was rolled back
+} CliStats;
+
+/**
+ * @brief Run one command and write its result as a JSON line.
+ * 
+ * Commands take "--name value" options, for example
+ * "loan --book 12 --member 7" or "return --barcode B-001". See
+ * cli_main() for the list. The result line looks like
+ * {"line":3,"command":"loan","status":"ok","loan_id":42} or
+ * {"line":3,"command":"loan","status":"error","error":"..."}; details of
+ * a failure inside the library are printed to stderr.
+ * 
+ * @param db SQLite database connection (the library's current connection).
+ * @param argc Number of arguments, the command name included.
+ * @param argv Arguments; argv[0] is the command name.
+ * @param line Script line number, or 0 to leave it out of the result.
+ * @param out Stream for the result line.
+ * @return int Returns 0 on success, -1 on failure.
+ */
+int cli_run_command(sqlite3 *db, int argc, char **argv, int line, FILE *out);
+
+/**
+ * @brief Split a script line into arguments, in place.
+ * 
+ * Arguments are separated by spaces or tabs. Double quotes group an
+ * argument containing spaces, and a '#' outside quotes starts a comment.
+ * 
+ * @param line The line; modified to hold the NUL-terminated arguments.
+ * @param argv Array to store the arguments.
+ * @param max_args Size of argv.
+ * @return int Returns number of arguments (0 for a blank line), -1 on an
+ *         unterminated quote or too many arguments.
+ */
+int cli_split_line(char *line, char **argv, int max_args);
+
+/**
+ * @brief Run every command of a script, one per line.
+ * 
+ * Without a shared transaction each command commits on its own and a
+ * failed command does not stop the script. With one, the whole script
+ * runs in a single transaction that is rolled back at the first failure.
+ * A summary line {"status":"done",...} follows the results.
+ * 
+ * @param db SQLite database connection (the library's current connection).
+ * @param in Script stream.
+ * @param shared_transaction 1 to run the script in one transaction.
+ * @param out Stream for the result lines.
+ * @param stats Pointer to store the totals, or NULL.
+ * @return int Returns 0 if every command succeeded, -1 otherwise.
+ */
+int cli_run_script(sqlite3 *db, FILE *in, int shared_transaction, FILE *out, CliStats *stats);
+
+/**
+ * @brief Entry point of the non-interactive command mode.
+ * 
+ * Opens the library database, runs "run [--transaction] FILE" ('-' reads
+ * stdin) or a single command, and writes the results to a fully
+ * buffered stdout with the library's progress messages turned off.
+ * "serve [--port N] [--workers N] [--address A]" runs the HTTP server
+ * (see http_server_start()) until SIGINT or SIGTERM.
+ * 
+ * @param argc Argument count from main().
+ * @param argv Arguments from main(); argv[1] is the command.
+ * @return int Returns CLI_EXIT_OK, CLI_EXIT_FAILED or CLI_EXIT_USAGE.
+ */
+int cli_main(int argc, char **argv);
+
+#endif // CLI_H
@@ -0,0 +1,133 @@
+#ifndef COPY_H
+#define COPY_H
+
+#include <sqlite3.h>
+
+#define MAX_BARCODE_LEN 32
+
+/**
+ * @brief Shelf status of a physical copy (stored in Copies.status).
+ */
+typedef enum {
+    COPY_AVAILABLE = 0,
+    COPY_ON_LOAN = 1
+} CopyStatus;
+
+/**
+ * @brief Structure representing one physical copy of a book.
+ */
+typedef struct {
+    int copy_id;
+    int book_id;
+    char barcode[MAX_BARCODE_LEN];
+    int status;          // CopyStatus
+    int active_loan_id;  // 0 if the copy is on the shelf
+} Copy;
+
+/**
+ * @brief Register a physical copy of a book under a barcode.
+ * 
+ * When the title already has as many registered copies as its quantity,
+ * Books.quantity and Books.available are increased by one.
+ * 
+ * @param db SQLite database connection.
+ * @param book_id The ID of the book the copy belongs to.
+ * @param barcode The barcode printed on the copy.
+ * @return int Returns copy_id on success, -1 on failure.
+ */
+int add_copy(sqlite3 *db, int book_id, const char *barcode);
+
+/**
+ * @brief Load all copies into the in-memory barcode index.
+ * 
+ * The index holds a barcode hash table and a bitset of copies on the shelf,
+ * grouped per title. Any previously loaded index is replaced. The loans
+ * and returns below reload it when another connection (e.g. another
+ * process on the same file) has committed since, per PRAGMA data_version.
+ * 
+ * @param db SQLite database connection.
+ * @return int Returns number of copies loaded, -1 on failure.
+ */
+int load_copy_index(sqlite3 *db);
+
+/**
+ * @brief Release the in-memory barcode index.
+ */
+void free_copy_index(void);
+
+/**
+ * @brief Look up a copy by barcode in the in-memory index.
+ * 
+ * @param barcode The barcode to look up.
+ * @param copy Pointer to Copy structure to store the result.
+ * @return int Returns 0 on success, -1 if not found or the index is not loaded.
+ */
+int find_copy_by_barcode(const char *barcode, Copy *copy);
+
+/**
+ * @brief Count copies of a title that are on the shelf, using the index bitset.
+ * 
+ * @param book_id The ID of the book.
+ * @return int Returns number of available copies, -1 if the index is not loaded.
+ */
+int count_available_copies(int book_id);
+
+/**
+ * @brief Pick a copy of a title that is on the shelf.
+ * 
+ * Uses the in-memory index when it is loaded (reloaded first if another
+ * connection committed since), the Copies table otherwise.
+ * 
+ * @param db SQLite database connection.
+ * @param book_id The ID of the book.
+ * @return int Returns copy_id, 0 if no copy of the title is on the shelf, -1 on failure.
+ */
+int find_available_copy(sqlite3 *db, int book_id);
+
+/**
+ * @brief Change the status of a copy in the database if it has the expected status.
+ * 
+ * @param db SQLite database connection.
+ * @param copy_id The ID of the copy.
+ * @param from_status The status the copy must currently have.
+ * @param to_status The new status.
+ * @return int Returns 0 on success, -1 on failure.
+ */
+int set_copy_status(sqlite3 *db, int copy_id, int from_status, int to_status);
+
+/**
+ * @brief Reflect a committed loan or return in the in-memory index.
+ * 
+ * Does nothing if the index is not loaded.
+ * 
+ * @param book_id The ID of the book the copy belongs to.
+ * @param copy_id The ID of the copy.
+ * @param status The new CopyStatus of the copy.
+ * @param loan_id The active loan ID (0 when the copy is returned).
+ */
+void update_copy_index(int book_id, int copy_id, int status, int loan_id);
+
+/**
+ * @brief Loan the copy with the given barcode to a member.
+ * 
+ * Loads the index if needed. If the loan fails because another connection
+ * changed the copies meanwhile, the lookup is tried once more.
+ * 
+ * @param db SQLite database connection.
+ * @param barcode The barcode of the copy.
+ * @param member_id The ID of the member borrowing the copy.
+ * @param loan_period The loan period in days (default 14 days).
+ * @return int Returns loan_id on success, -1 on failure.
+ */
+int loan_by_barcode(sqlite3 *db, const char *barcode, int member_id, int loan_period);
+
+/**
+ * @brief Return the copy with the given barcode.
+ * 
+ * @param db SQLite database connection.
+ * @param barcode The barcode of the copy.
+ * @return int Returns return_id on success, -1 on failure.
+ */
+int return_by_barcode(sqlite3 *db, const char *barcode);
+
+#endif // COPY_H
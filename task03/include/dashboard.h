@@ -0,0 +1,60 @@
+#ifndef DASHBOARD_H
+#define DASHBOARD_H
+
+#include <sqlite3.h>
+#include <stddef.h>
+#include "member.h"
+#include "loan.h"
+
+#define DASHBOARD_ARENA_SIZE 16384   // enough for a few dozen loans with long titles
+#define DASHBOARD_HISTORY_LIMIT 20   // default number of recent loans
+
+/**
+ * @brief One loan on the member dashboard.
+ */
+typedef struct {
+    int loan_id;
+    int book_id;
+    const char *title;                 // stored in the dashboard arena
+    char loan_date[MAX_DATE_LEN];
+    char due_date[MAX_DATE_LEN];
+    char return_date[MAX_DATE_LEN];    // empty while on loan
+    int is_returned;
+    int overdue_days;                  // days past due today, or as recorded at return
+} DashboardLoan;
+
+/**
+ * @brief Everything the member screen shows, fetched in one query.
+ * 
+ * The loan arrays and titles live in the arena passed to
+ * get_member_dashboard() and stay valid as long as the arena does.
+ */
+typedef struct {
+    Member member;                     // overdue_days/suspension_days of the worst active loan
+    int overdue_loans;                 // active loans past due
+    int total_loans;                   // all loans ever made by the member
+    DashboardLoan *active_loans;       // earliest due date first
+    int active_count;
+    DashboardLoan *history;            // most recent loan first
+    int history_count;
+    int truncated;                     // 1 if the arena ran out before every row was stored
+} MemberDashboard;
+
+/**
+ * @brief Fetch a member, the overdue summary, active loans and recent history.
+ * 
+ * All parts are read by a single statement, so they come from one
+ * consistent snapshot of the database.
+ * 
+ * @param db SQLite database connection.
+ * @param member_id Member ID.
+ * @param history_limit Maximum number of recent loans to return.
+ * @param arena Caller-provided buffer for the loans and titles.
+ * @param arena_size Size of the buffer in bytes (DASHBOARD_ARENA_SIZE is typical).
+ * @param dashboard Pointer to store the result.
+ * @return int Returns 0 on success, -1 if the member does not exist or on failure.
+ */
+int get_member_dashboard(sqlite3 *db, int member_id, int history_limit,
+                         void *arena, size_t arena_size, MemberDashboard *dashboard);
+
+#endif // DASHBOARD_H
@@ -6,6 +6,34 @@
 #define DB_PATH "database/library.db"
 #define MAX_QUERY_LENGTH 1024
 
+/* Statement cache slots (see prepare_cached_statement()) */
+#define STMT_SLOT_UPDATE_BOOK 0       // 32 slots, one per update_book() field mask
+#define STMT_SLOT_UPDATE_MEMBER 32    // 8 slots, one per update_member() field mask
+#define STMT_SLOT_LEDGER_READ 40      // can_member_borrow()
+#define STMT_SLOT_LEDGER_LOAN 41      // record_penalty_loan()
+#define STMT_SLOT_LEDGER_RETURN 42    // record_penalty_return()
+#define STMT_SLOT_HTTP 43             // 8 slots for the HTTP endpoints
+#define STMT_SLOT_RECOMMEND 51        // 3 slots for catch_up_recommendations()
+#define STMT_SLOT_BORROW_INDEX 54     // catch_up_borrow_index()
+#define STMT_SLOT_ROLLUP 55           // 8 slots for update_circulation_rollups()
+#define STMT_SLOT_DASHBOARD 63        // get_member_dashboard()
+#define STMT_CACHE_SLOTS 64
+
+/* Waiting for another connection's lock (see install_busy_handler()) */
+#define DB_BUSY_TIMEOUT_MS 5000       // default deadline of one lock wait or retried call
+#define DB_BACKOFF_MIN_US 500         // first backoff step
+#define DB_BACKOFF_MAX_US 10000       // backoff cap, keeps the longest waits short
+
+/**
+ * @brief Counters of the busy retry layer, for every connection of the process.
+ */
+typedef struct {
+    long waits;          // lock waits begun (busy handler or retried call)
+    long retries;        // sleeps before trying again
+    long timeouts;       // waits that reached their deadline
+    long long wait_us;   // time spent sleeping
+} DbRetryStats;
+
 /**
  * @brief Initialize the database connection and create tables if they don't exist.
  * 
@@ -23,6 +51,9 @@ int close_database(void);
 /**
  * @brief Get the database connection pointer.
  * 
+ * The connection and the statement cache are per thread; a thread other
+ * than the one that called init_database() starts with none.
+ * 
  * @return sqlite3* Returns the database connection pointer, or NULL if not initialized.
  */
 sqlite3* get_db_connection(void);
@@ -30,10 +61,145 @@ sqlite3* get_db_connection(void);
 /**
  * @brief Set the database connection pointer (for testing purposes only).
  * 
+ * The library's SQL functions are registered on the new connection.
+ * 
  * @param new_db The new database connection pointer.
  */
 void set_db_connection(sqlite3* new_db);
 
+/**
+ * @brief Turn the library's progress messages on stdout on or off.
+ * 
+ * Errors still go to stderr. Used by the batch command mode, whose
+ * stdout carries only machine-readable results.
+ * 
+ * @param quiet 1 to suppress progress messages, 0 to print them.
+ */
+void set_quiet_mode(int quiet);
+
+/**
+ * @brief Check whether progress messages are suppressed.
+ * 
+ * @return int Returns 1 in quiet mode, 0 otherwise.
+ */
+int is_quiet_mode(void);
+
+/**
+ * @brief Look up a cached prepared statement.
+ * 
+ * The cache belongs to one connection at a time; asking for a different
+ * connection finalizes every cached statement first.
+ * 
+ * @param conn SQLite database connection the statement must belong to.
+ * @param slot Cache slot (STMT_SLOT_* plus a variant index).
+ * @return sqlite3_stmt* Returns the statement, or NULL if the slot is empty.
+ */
+sqlite3_stmt* find_cached_statement(sqlite3 *conn, int slot);
+
+/**
+ * @brief Prepare a statement once and keep it in the cache.
+ * 
+ * Callers must not finalize the statement. They reset it and clear its
+ * bindings after each use.
+ * 
+ * @param conn SQLite database connection.
+ * @param slot Cache slot (STMT_SLOT_* plus a variant index).
+ * @param sql SQL text, used only if the slot is empty.
+ * @return sqlite3_stmt* Returns the statement, or NULL on failure.
+ */
+sqlite3_stmt* prepare_cached_statement(sqlite3 *conn, int slot, const char *sql);
+
+/**
+ * @brief Finalize every cached statement (done before closing or switching connections).
+ */
+void finalize_cached_statements(void);
+
+/**
+ * @brief Set the deadline of one lock wait or retried call.
+ * 
+ * @param timeout_ms Milliseconds (DB_BUSY_TIMEOUT_MS if <= 0).
+ */
+void set_busy_timeout(int timeout_ms);
+
+/**
+ * @brief Make a connection wait for other connections' locks.
+ * 
+ * While another process or connection holds the lock, SQLite calls the
+ * handler, which sleeps with jittered exponential backoff (starting at
+ * DB_BACKOFF_MIN_US, capped at DB_BACKOFF_MAX_US) until the busy timeout
+ * has passed since the first attempt. init_database() and
+ * set_db_connection() install it.
+ * 
+ * @param conn SQLite database connection.
+ * @return int Returns 0 on success, -1 on failure.
+ */
+int install_busy_handler(sqlite3 *conn);
+
+/**
+ * @brief Run SQL with sqlite3_exec(), retrying while it reports SQLITE_BUSY or SQLITE_LOCKED.
+ * 
+ * Covers the busy results SQLite returns without calling the busy
+ * handler. Retries back off like the handler and stop at the busy
+ * timeout. Prints nothing; sqlite3_errmsg() describes a failure.
+ * 
+ * @param conn SQLite database connection.
+ * @param sql SQL text (statements that may safely run again after a busy failure).
+ * @return int Returns the SQLite result code of the last attempt.
+ */
+int exec_with_retry(sqlite3 *conn, const char *sql);
+
+/**
+ * @brief Open a savepoint, starting a write transaction if none is open.
+ * 
+ * Outside a transaction the write lock is taken up front (BEGIN
+ * IMMEDIATE), so a busy database is waited for here rather than failing
+ * half way through. Inside the caller's transaction only the savepoint
+ * is opened.
+ * 
+ * @param conn SQLite database connection.
+ * @param name Savepoint name (an SQL identifier).
+ * @return int Returns 1 if a transaction was started, 0 if nested, -1 on failure.
+ */
+int begin_savepoint(sqlite3 *conn, const char *name);
+
+/**
+ * @brief Release a savepoint and commit the transaction begin_savepoint() started.
+ * 
+ * On failure everything since begin_savepoint() is rolled back.
+ * 
+ * @param conn SQLite database connection.
+ * @param name Savepoint name.
+ * @param began The result of begin_savepoint().
+ * @return int Returns 0 on success, -1 on failure.
+ */
+int release_savepoint(sqlite3 *conn, const char *name, int began);
+
+/**
+ * @brief Undo and close a savepoint, and the transaction begin_savepoint() started.
+ * 
+ * @param conn SQLite database connection.
+ * @param name Savepoint name.
+ * @param began The result of begin_savepoint().
+ */
+void rollback_savepoint(sqlite3 *conn, const char *name, int began);
+
+/**
+ * @brief Copy the busy retry counters.
+ * 
+ * @param stats Pointer to store the counters.
+ */
+void get_retry_stats(DbRetryStats *stats);
+
+/**
+ * @brief Zero the busy retry counters.
+ */
+void reset_retry_stats(void);
+
+/**
+ * @brief Print the busy retry counters.
+ */
+void display_retry_stats(void);
+
 /**
  * @brief Execute a SQL query without returning results.
  * 
@@ -45,12 +211,15 @@ int execute_query(const char *sql);
 /**
  * @brief Begin a database transaction.
  * 
+ * Takes the write lock up front (BEGIN IMMEDIATE), waiting for other
+ * writers up to the busy timeout.
+ * 
  * @return int Returns 0 on success, -1 on failure.
  */
 int begin_transaction(void);
 
 /**
- * @brief Commit a database transaction.
+ * @brief Commit a database transaction, retrying while readers block it.
  * 
  * @return int Returns 0 on success, -1 on failure.
  */
@@ -70,6 +239,13 @@ int rollback_transaction(void);
  */
 int create_tables(void);
 
+/**
+ * @brief Add columns introduced after the initial schema to existing tables.
+ * 
+ * @return int Returns 0 on success, -1 on failure.
+ */
+int migrate_schema(void);
+
 /**
  * @brief Create indexes on database tables for better performance.
  * 
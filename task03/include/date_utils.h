@@ -0,0 +1,36 @@
+#ifndef DATE_UTILS_H
+#define DATE_UTILS_H
+
+#include <stddef.h>
+
+/**
+ * @brief Convert a YYYY-MM-DD date to a day number.
+ * 
+ * Day numbers count days since 1970-01-01 in the proleptic Gregorian
+ * calendar, so the difference of two day numbers is the number of days
+ * between the dates. A time part after the date ("YYYY-MM-DD HH:MM:SS")
+ * is ignored.
+ * 
+ * @param date Date string.
+ * @param day Pointer to store the day number.
+ * @return int Returns 0 on success, -1 if the date is malformed or invalid.
+ */
+int date_to_day(const char *date, int *day);
+
+/**
+ * @brief Convert a day number back to a YYYY-MM-DD date.
+ * 
+ * @param day Day number (days since 1970-01-01).
+ * @param date_str Buffer to store the date string.
+ * @param size Size of the buffer (at least 11 bytes).
+ */
+void day_to_date(int day, char *date_str, size_t size);
+
+/**
+ * @brief Get today's day number in local time.
+ * 
+ * @return int Returns the day number of the current date.
+ */
+int get_today_day(void);
+
+#endif // DATE_UTILS_H
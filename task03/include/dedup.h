@@ -0,0 +1,79 @@
+#ifndef DEDUP_H
+#define DEDUP_H
+
+#include <sqlite3.h>
+
+#define DEDUP_MAX_TEXT 160            // code points compared per title or author
+#define DEDUP_SIGNATURE_SIZE 64       // MinHash values per book
+#define DEDUP_BANDS 16                // LSH bands of DEDUP_SIGNATURE_SIZE / DEDUP_BANDS values
+#define DEDUP_BUCKET_PEERS 8          // earlier bucket members each book is compared with
+#define DEDUP_DEFAULT_THRESHOLD 80    // estimated similarity in percent
+
+/**
+ * @brief Clusters of near-duplicate books.
+ * 
+ * Cluster i holds book_ids[cluster_start[i]] .. book_ids[cluster_start[i + 1] - 1],
+ * in ascending order. Clusters are ordered by their first (lowest) book ID.
+ */
+typedef struct {
+    int cluster_count;
+    int *cluster_start;      // cluster_count + 1 offsets into book_ids
+    int *book_ids;
+    int book_count;          // books compared
+} DedupResult;
+
+/**
+ * @brief Find groups of books whose titles and authors are near-duplicates.
+ * 
+ * Titles and authors are normalized (lower-case, punctuation, spacing and
+ * bracketed notes such as "(2nd ed.)" removed) and cut into code-point
+ * 3-gram shingles. Each book gets a MinHash signature whose values agree
+ * with another book's in proportion to the Jaccard similarity of their
+ * shingle sets. Signatures are split into DEDUP_BANDS bands and books
+ * sharing a band land in the same bucket; only books within a bucket are
+ * compared, each with at most DEDUP_BUCKET_PEERS earlier members, so the
+ * whole catalogue is processed in O(n log n). Pairs whose estimated
+ * similarity reaches the threshold are joined into clusters.
+ * 
+ * @param db SQLite database connection.
+ * @param threshold Minimum estimated similarity in percent (1-100).
+ * @param result Pointer to store the clusters; release with free_dedup_result().
+ * @return int Returns number of clusters found, -1 on failure.
+ */
+int find_duplicate_books(sqlite3 *db, int threshold, DedupResult *result);
+
+/**
+ * @brief Release the arrays of a DedupResult.
+ * 
+ * @param result The result.
+ */
+void free_dedup_result(DedupResult *result);
+
+/**
+ * @brief Print the clusters with each book's title, author, ISBN and counts.
+ * 
+ * @param db SQLite database connection.
+ * @param result Clusters from find_duplicate_books().
+ * @return int Returns number of books listed, -1 on failure.
+ */
+int display_duplicate_books(sqlite3 *db, const DedupResult *result);
+
+/**
+ * @brief Merge every cluster into its lowest book ID.
+ * 
+ * The quantity and available counts of the other books are added to the
+ * kept book, their loans, copies and reminders are moved to it, and the
+ * other rows are deleted. All clusters are merged in one transaction (or
+ * inside the caller's transaction, if one is open). Afterwards the barcode
+ * index and the analytics store are dropped to reload on next use, the
+ * reminder wheel follows the moved loans, and the borrow history index and
+ * recommendation matrix are rebuilt, whether open or left at their default
+ * paths by another process.
+ * 
+ * @param db SQLite database connection.
+ * @param result Clusters from find_duplicate_books().
+ * @return int Returns number of books removed, -1 on failure.
+ */
+int merge_duplicate_books(sqlite3 *db, const DedupResult *result);
+
+#endif // DEDUP_H
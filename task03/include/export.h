@@ -0,0 +1,78 @@
+#ifndef EXPORT_H
+#define EXPORT_H
+
+#include <sqlite3.h>
+#include <stdio.h>
+
+#define EXPORT_BUFFER_SIZE (1024 * 1024)   // rows are formatted into a buffer of this size
+#define EXPORT_GZIP_LEVEL 1                // fast compression; exports are large and written once
+
+/**
+ * @brief Output format of an export.
+ */
+typedef enum {
+    EXPORT_FORMAT_CSV = 0,       // RFC 4180 quoting, header row, NULL as an empty field
+    EXPORT_FORMAT_JSONL = 1      // one JSON object per line, NULL as null
+} ExportFormat;
+
+/**
+ * @brief Totals of an export.
+ */
+typedef struct {
+    long long rows;
+    long long bytes;             // formatted bytes, before compression
+    long long written;           // bytes written to the output
+    double seconds;
+    double rows_per_second;
+} ExportStats;
+
+/**
+ * @brief Parse a format name ("csv" or "jsonl").
+ * 
+ * @param name The format name.
+ * @return int Returns the ExportFormat, -1 if the name is unknown.
+ */
+int export_parse_format(const char *name);
+
+/**
+ * @brief Check whether gzip output is available (the library was built with zlib).
+ * 
+ * @return int Returns 1 if available, 0 otherwise.
+ */
+int export_gzip_available(void);
+
+/**
+ * @brief Stream one table to a file.
+ * 
+ * The rows are read by a single statement in rowid order and formatted
+ * into one EXPORT_BUFFER_SIZE buffer that is written out (through zlib
+ * when gzip is set) each time it fills, so memory use does not depend
+ * on the size of the table. The statement sees one snapshot even while
+ * other connections write.
+ * 
+ * @param db SQLite database connection.
+ * @param table "books", "members", "loans" or "returns".
+ * @param format The output format.
+ * @param gzip 1 to write a gzip stream.
+ * @param out Destination stream, opened in binary mode.
+ * @param stats Pointer to store the totals, or NULL.
+ * @return long long Returns number of rows exported, -1 on failure.
+ */
+long long export_table(sqlite3 *db, const char *table, ExportFormat format, int gzip, FILE *out,
+                       ExportStats *stats);
+
+/**
+ * @brief Stream one table to a file path.
+ * 
+ * @param db SQLite database connection.
+ * @param table "books", "members", "loans" or "returns".
+ * @param format The output format.
+ * @param gzip 1 to write a gzip stream.
+ * @param path Output file, replaced if it exists.
+ * @param stats Pointer to store the totals, or NULL.
+ * @return long long Returns number of rows exported, -1 on failure.
+ */
+long long export_table_to_path(sqlite3 *db, const char *table, ExportFormat format, int gzip,
+                               const char *path, ExportStats *stats);
+
+#endif // EXPORT_H
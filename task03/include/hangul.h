@@ -0,0 +1,64 @@
+#ifndef HANGUL_H
+#define HANGUL_H
+
+#include <stddef.h>
+
+#define HANGUL_KEY_LEN 512   // buffer size for a chosung or jamo key
+
+/**
+ * @brief How a search string should be matched.
+ */
+typedef enum {
+    HANGUL_QUERY_PLAIN = 0,     // ordinary text, matched with LIKE
+    HANGUL_QUERY_CHOSUNG = 1,   // only initial consonants, e.g. "ㅎㄱㅅ"
+    HANGUL_QUERY_JAMO = 2       // syllables mixed with loose jamo, e.g. "한ㄱ"
+} HangulQueryKind;
+
+/**
+ * @brief Build the initial-consonant (chosung) key of a text.
+ * 
+ * Each Hangul syllable becomes its initial consonant ("한국사" -> "ㅎㄱㅅ").
+ * ASCII letters are lower-cased, spaces and punctuation are dropped and other
+ * characters are kept, so keys can be compared by prefix.
+ * 
+ * @param text NUL-terminated UTF-8 text (NULL is treated as empty).
+ * @param out Buffer to store the key.
+ * @param out_size Size of out; the key is truncated at a character boundary.
+ * @return int Returns length of the key in bytes.
+ */
+int hangul_chosung_key(const char *text, char *out, size_t out_size);
+
+/**
+ * @brief Build the jamo key of a text.
+ * 
+ * Each Hangul syllable is decomposed into its jamo and compound vowels and
+ * final consonants are split ("닭" -> "ㄷㅏㄹㄱ"), so a partly typed syllable
+ * is a prefix of the full one. Other characters are normalized as in
+ * hangul_chosung_key().
+ * 
+ * @param text NUL-terminated UTF-8 text (NULL is treated as empty).
+ * @param out Buffer to store the key.
+ * @param out_size Size of out; the key is truncated at a character boundary.
+ * @return int Returns length of the key in bytes.
+ */
+int hangul_jamo_key(const char *text, char *out, size_t out_size);
+
+/**
+ * @brief Decide which key a search string should be matched against.
+ * 
+ * @param query The search string.
+ * @return int Returns a HangulQueryKind.
+ */
+int hangul_query_kind(const char *query);
+
+/**
+ * @brief Build the exclusive upper bound for a prefix range scan.
+ * 
+ * Every key starting with prefix sorts in [prefix, end) under BINARY collation.
+ * 
+ * @param prefix The key prefix.
+ * @param end Buffer of at least strlen(prefix) + 2 bytes.
+ */
+void hangul_prefix_end(const char *prefix, char *end);
+
+#endif // HANGUL_H
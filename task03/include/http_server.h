@@ -0,0 +1,79 @@
+#ifndef HTTP_SERVER_H
+#define HTTP_SERVER_H
+
+#include <stddef.h>
+
+#define HTTP_DEFAULT_PORT 8080
+#define HTTP_DEFAULT_WORKERS 4
+#define HTTP_MAX_WORKERS 64
+#define HTTP_MAX_REQUEST 16384         // request line, headers and body
+#define HTTP_SEARCH_LIMIT 20           // books per search unless ?limit= is given
+#define HTTP_MAX_RESULTS 500           // upper bound for ?limit=
+
+/**
+ * @brief Settings of the HTTP server.
+ */
+typedef struct {
+    const char *db_path;    // database file; each worker opens its own connection
+    const char *address;    // IPv4 address to bind, 127.0.0.1 if NULL
+    int port;               // 0 picks a free port (see http_server_port())
+    int workers;            // worker threads, HTTP_DEFAULT_WORKERS if 0 or less
+    size_t cache_bytes;     // result cache budget of each worker, 0 for no cache
+} HttpServerConfig;
+
+/**
+ * @brief Request counters of a running server.
+ */
+typedef struct {
+    long connections;       // accepted connections
+    long requests;          // requests answered
+    long errors;            // responses with status 400 or above
+    long cache_hits;        // result cache totals over the workers
+    long cache_misses;
+    long cache_evictions;
+} HttpServerStats;
+
+/**
+ * @brief Start the HTTP/JSON server in background worker threads.
+ * 
+ * The workers share one epoll set (listening socket plus one-shot client
+ * sockets), keep connections alive between requests and each use their
+ * own SQLite connection in WAL mode, with a result cache of
+ * config->cache_bytes for the read endpoints. The schema must already exist.
+ * 
+ * Endpoints (JSON responses, POST parameters in the query string or a
+ * flat JSON body):
+ *   GET  /health
+ *   GET  /books?q=TEXT[&limit=N]     title/author/ISBN search
+ *   GET  /books/{id}
+ *   POST /loans   book_id, member_id[, days]
+ *   POST /returns loan_id
+ *   GET  /reports/overdue
+ *   GET  /reports/popular[?limit=N]
+ * 
+ * @param config Server settings.
+ * @return int Returns 0 on success, -1 on failure (or if already running).
+ */
+int http_server_start(const HttpServerConfig *config);
+
+/**
+ * @brief Get the port the server listens on.
+ * 
+ * @return int Returns the port, -1 if the server is not running.
+ */
+int http_server_port(void);
+
+/**
+ * @brief Copy the request counters of the running server.
+ * 
+ * @param stats Pointer to store the counters.
+ * @return int Returns 0 on success, -1 if the server is not running.
+ */
+int http_server_stats(HttpServerStats *stats);
+
+/**
+ * @brief Stop the workers, close every connection and free the server.
+ */
+void http_server_stop(void);
+
+#endif // HTTP_SERVER_H
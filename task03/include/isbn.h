@@ -0,0 +1,32 @@
+#ifndef ISBN_H
+#define ISBN_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define ISBN_INVALID 0   // key stored for ISBNs that do not parse
+
+/**
+ * @brief Convert an ISBN-10 or ISBN-13 to its canonical integer key.
+ * 
+ * Hyphens and spaces are ignored, as is a leading "ISBN", "ISBN-10:" or
+ * "ISBN-13:" label. ISBN-10s are converted to their 978-prefixed ISBN-13,
+ * so every spelling of the same book gets the same key.
+ * 
+ * @param text NUL-terminated ISBN text (NULL is treated as empty).
+ * @return int64_t Returns the 13-digit ISBN as an integer, or ISBN_INVALID
+ *         if the text is not an ISBN or its check digit is wrong.
+ */
+int64_t isbn_parse(const char *text);
+
+/**
+ * @brief Format a canonical key as a 13-digit ISBN without hyphens.
+ * 
+ * @param key Key returned by isbn_parse().
+ * @param out Buffer to store the ISBN (at least 14 bytes).
+ * @param out_size Size of out.
+ * @return int Returns 0 on success, -1 if the key is not a valid ISBN-13.
+ */
+int isbn_format(int64_t key, char *out, size_t out_size);
+
+#endif // ISBN_H
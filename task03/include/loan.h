@@ -15,6 +15,7 @@ typedef struct {
     char loan_date[MAX_DATE_LEN];
     char due_date[MAX_DATE_LEN];
     int is_returned;  // 0: not returned, 1: returned
+    int copy_id;      // 0 if the loan is not tied to a physical copy
 } Loan;
 
 /**
@@ -38,6 +39,9 @@ int init_loan_tables(sqlite3 *db);
 /**
  * @brief Process a book loan.
  * 
+ * If the title has registered copies on the shelf, one of them is lent out
+ * as by process_copy_loan().
+ * 
  * @param db SQLite database connection.
  * @param book_id The ID of the book to loan.
  * @param member_id The ID of the member borrowing the book.
@@ -46,6 +50,22 @@ int init_loan_tables(sqlite3 *db);
  */
 int process_loan(sqlite3 *db, int book_id, int member_id, int loan_period);
 
+/**
+ * @brief Process a loan of a specific physical copy.
+ * 
+ * The copy status, the loan record and Books.available are updated in one
+ * transaction. The loan fails if the copy is not on the shelf or the title
+ * has no available quantity left.
+ * 
+ * @param db SQLite database connection.
+ * @param copy_id The ID of the copy to loan.
+ * @param book_id The ID of the book the copy belongs to.
+ * @param member_id The ID of the member borrowing the book.
+ * @param loan_period The loan period in days (default 14 days).
+ * @return int Returns loan_id on success, -1 on failure.
+ */
+int process_copy_loan(sqlite3 *db, int copy_id, int book_id, int member_id, int loan_period);
+
 /**
  * @brief Process a book return.
  * 
@@ -0,0 +1,82 @@
+#ifndef MARC_H
+#define MARC_H
+
+#include <sqlite3.h>
+#include <stddef.h>
+
+#define MARC_LEADER_LEN 24
+#define MARC_FIELD_TERMINATOR 0x1E
+#define MARC_RECORD_TERMINATOR 0x1D
+#define MARC_SUBFIELD_DELIMITER 0x1F
+#define MARC_CHUNK_BYTES (1024 * 1024)   // parsed as one batch
+#define MARC_COMMIT_CHUNKS 8             // batches inserted per transaction
+#define MARC_QUEUE_DEPTH 4               // parsed batches waiting per parser thread
+
+/**
+ * @brief A piece of a MARC record, pointing into the record itself.
+ */
+typedef struct {
+    const char *text;    // not NUL-terminated; NULL if the field is absent
+    int length;
+} MarcSlice;
+
+/**
+ * @brief The book fields of one MARC21 bibliographic record.
+ * 
+ * Every slice points into the parsed buffer, with ISBD punctuation
+ * (" /", " :", trailing periods and commas) trimmed off the end.
+ */
+typedef struct {
+    MarcSlice title;         // 245 $a
+    MarcSlice author;        // 100 $a, else 110 $a, else 700 $a
+    MarcSlice publisher;     // 264 $b, else 260 $b
+    MarcSlice isbn;          // first 020 $a, up to the first space or qualifier
+    MarcSlice genre;         // 655 $a, else 650 $a
+    int year;                // 008/07-10, else the first four digits of 264/260 $c; 0 if unknown
+    int utf8;                // leader/09 is 'a' (UTF-8); otherwise MARC-8
+} MarcRecord;
+
+/**
+ * @brief Totals of a MARC load.
+ */
+typedef struct {
+    long records;            // records found in the file
+    long inserted;
+    long duplicates;         // ISBN already in the catalogue (or earlier in the file)
+    long rejected;           // malformed, without a title, or MARC-8 with non-ASCII text
+    double seconds;
+    double records_per_minute;
+} MarcLoadStats;
+
+/**
+ * @brief Parse one MARC21 record without copying or allocating.
+ * 
+ * @param data Start of the record (its leader).
+ * @param length Bytes available from data; the record may be shorter.
+ * @param record Pointer to store the fields.
+ * @return int Returns the record length in bytes, -1 if the record is malformed.
+ */
+int marc_parse_record(const char *data, size_t length, MarcRecord *record);
+
+/**
+ * @brief Load the books of a MARC21 file into the Books table.
+ * 
+ * The file is memory-mapped and cut into MARC_CHUNK_BYTES chunks at
+ * record boundaries. Parser threads turn chunks into batches of ready-to-bind
+ * rows (text copied once into a per-batch arena, Hangul search keys and
+ * ISBN keys computed), while the calling thread inserts the batches in
+ * file order with one prepared statement, committing every
+ * MARC_COMMIT_CHUNKS batches (or inside the caller's transaction, if one
+ * is open). Each record
+ * becomes a book with a quantity of 1; records whose ISBN is already in
+ * the catalogue are skipped.
+ * 
+ * @param db SQLite database connection.
+ * @param path MARC21 (ISO 2709) file.
+ * @param num_threads Parser threads (1 or more).
+ * @param stats Pointer to store the totals, or NULL.
+ * @return int Returns number of books inserted, -1 on failure.
+ */
+int load_marc_file(sqlite3 *db, const char *path, int num_threads, MarcLoadStats *stats);
+
+#endif // MARC_H
@@ -91,12 +91,51 @@ int check_member_overdue(sqlite3 *db, int member_id, int *overdue_days);
 /**
  * @brief Check if a member can borrow books (not suspended).
  * 
+ * Reads the member's penalty ledger only: the member is suspended while
+ * today is before suspended_until, or while an active loan is past due.
+ * 
  * @param db SQLite database connection.
  * @param member_id Member ID to check.
  * @return int Returns 1 if can borrow, 0 if suspended, -1 on failure.
  */
 int can_member_borrow(sqlite3 *db, int member_id);
 
+/**
+ * @brief Record a new loan in the penalty ledger.
+ * 
+ * @param db SQLite database connection.
+ * @param member_id Member ID.
+ * @param due_day Day number of the loan's due date.
+ * @return int Returns 0 on success, -1 on failure.
+ */
+int record_penalty_loan(sqlite3 *db, int member_id, int due_day);
+
+/**
+ * @brief Record a return in the penalty ledger.
+ * 
+ * Call after the loan is marked returned. An overdue return extends
+ * suspended_until to return_day plus the suspension period.
+ * 
+ * @param db SQLite database connection.
+ * @param member_id Member ID.
+ * @param return_day Day number of the return date.
+ * @param overdue_days Days the loan was overdue (0 if on time).
+ * @return int Returns 0 on success, -1 on failure.
+ */
+int record_penalty_return(sqlite3 *db, int member_id, int return_day, int overdue_days);
+
+/**
+ * @brief Recompute the penalty ledger from Loans and Returns.
+ * 
+ * Needed after loans or returns are written without process_loan() and
+ * process_return(), e.g. by bulk imports.
+ * 
+ * @param db SQLite database connection.
+ * @param member_id Member ID, or 0 for every member.
+ * @return int Returns number of members updated, -1 on failure.
+ */
+int rebuild_penalty_ledger(sqlite3 *db, int member_id);
+
 /**
  * @brief List all members.
  * 
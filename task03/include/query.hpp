@@ -0,0 +1,408 @@
+#ifndef QUERY_HPP
+#define QUERY_HPP
+
+/**
+ * @file query.hpp
+ * @brief Typed, zero-copy C++17 wrapper over SQLite statements (header only).
+ * 
+ * For the C++ side of library_core (tests, servers). A StatementCache
+ * prepares each SQL text once per connection and hands out Statement
+ * leases that reset themselves when they go out of scope. Parameters are
+ * bound and columns read by their C++ types, chosen at compile time:
+ * 
+ *     library::StatementCache cache(db);
+ *     auto stmt = cache.prepare("SELECT book_id, title FROM Books WHERE genre = ?");
+ *     for (auto [id, title] : stmt.bind(genre).rows<int, std::string_view>()) {
+ *         ...
+ *     }
+ * 
+ * std::string_view columns (TEXT, up to the first NUL) point into SQLite's
+ * own row buffer and are valid only until the next step, bind or the end
+ * of the lease. Text parameters are bound without copying too (except
+ * std::string temporaries), so they must outlive the query.
+ * 
+ * Errors throw library::QueryError.
+ */
+
+#include <sqlite3.h>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+namespace library {
+
+/**
+ * @brief A failed prepare, bind or step, with SQLite's message and code.
+ */
+class QueryError : public std::runtime_error {
+public:
+    QueryError(sqlite3 *db, const char *action)
+        : std::runtime_error(std::string(action) + ": " + sqlite3_errmsg(db)),
+          code_(sqlite3_extended_errcode(db)) {}
+
+    QueryError(const char *message, int code) : std::runtime_error(message), code_(code) {}
+
+    int code() const noexcept { return code_; }
+
+private:
+    int code_;
+};
+
+namespace detail {
+
+template <typename T> struct is_optional : std::false_type {};
+template <typename T> struct is_optional<std::optional<T>> : std::true_type {};
+
+template <typename T> inline constexpr bool unsupported_type = false;
+
+/**
+ * @brief Bind one parameter by its type (1-based index).
+ */
+template <typename Arg>
+int bind_value(sqlite3_stmt *stmt, int index, Arg &&arg) {
+    using T = std::decay_t<Arg>;
+    if constexpr (std::is_same_v<T, std::nullptr_t>) {
+        return sqlite3_bind_null(stmt, index);
+    } else if constexpr (is_optional<T>::value) {
+        return arg ? bind_value(stmt, index, *std::forward<Arg>(arg)) : sqlite3_bind_null(stmt, index);
+    } else if constexpr (std::is_integral_v<T> && sizeof(T) <= sizeof(int)) {
+        return sqlite3_bind_int(stmt, index, static_cast<int>(arg));
+    } else if constexpr (std::is_integral_v<T>) {
+        return sqlite3_bind_int64(stmt, index, static_cast<sqlite3_int64>(arg));
+    } else if constexpr (std::is_floating_point_v<T>) {
+        return sqlite3_bind_double(stmt, index, static_cast<double>(arg));
+    } else if constexpr (std::is_same_v<T, std::string> && !std::is_lvalue_reference_v<Arg>) {
+        // A temporary string is gone before the statement steps: let SQLite copy it
+        return sqlite3_bind_text(stmt, index, arg.data(), static_cast<int>(arg.size()), SQLITE_TRANSIENT);
+    } else if constexpr ((std::is_same_v<T, const char *> || std::is_same_v<T, char *>) &&
+                         !std::is_array_v<std::remove_reference_t<Arg>>) {
+        // A null C string means "absent", as in the C API; string_view would strlen() it
+        if (arg == nullptr) {
+            return sqlite3_bind_null(stmt, index);
+        }
+        return sqlite3_bind_text(stmt, index, arg, -1, SQLITE_STATIC);
+    } else if constexpr (std::is_convertible_v<const T &, std::string_view>) {
+        std::string_view text = arg;
+        if (text.data() == nullptr) {
+            return sqlite3_bind_null(stmt, index);
+        }
+        return sqlite3_bind_text(stmt, index, text.data(), static_cast<int>(text.size()), SQLITE_STATIC);
+    } else {
+        static_assert(unsupported_type<T>, "unsupported parameter type");
+        return SQLITE_MISUSE;
+    }
+}
+
+/**
+ * @brief Read one column of the current row by its type (0-based index).
+ */
+template <typename T>
+T column_value(sqlite3_stmt *stmt, int index) {
+    if constexpr (is_optional<T>::value) {
+        if (sqlite3_column_type(stmt, index) == SQLITE_NULL) {
+            return std::nullopt;
+        }
+        return column_value<typename T::value_type>(stmt, index);
+    } else if constexpr (std::is_integral_v<T> && sizeof(T) <= sizeof(int)) {
+        return static_cast<T>(sqlite3_column_int(stmt, index));
+    } else if constexpr (std::is_integral_v<T>) {
+        return static_cast<T>(sqlite3_column_int64(stmt, index));
+    } else if constexpr (std::is_floating_point_v<T>) {
+        return static_cast<T>(sqlite3_column_double(stmt, index));
+    } else if constexpr (std::is_same_v<T, std::string_view>) {
+        // TEXT columns are NUL-terminated; sqlite3_column_bytes() would cost a second mutex round trip
+        const char *text = reinterpret_cast<const char *>(sqlite3_column_text(stmt, index));
+        return text ? std::string_view(text) : std::string_view();
+    } else if constexpr (std::is_same_v<T, std::string>) {
+        return std::string(column_value<std::string_view>(stmt, index));
+    } else {
+        static_assert(unsupported_type<T>, "unsupported column type");
+        return T();
+    }
+}
+
+/**
+ * @brief Build a Row (a tuple or an aggregate) from the leading columns.
+ */
+template <typename Row, typename... Columns, size_t... I>
+Row read_row(sqlite3_stmt *stmt, std::index_sequence<I...>) {
+    return Row{column_value<Columns>(stmt, static_cast<int>(I))...};
+}
+
+} // namespace detail
+
+/**
+ * @brief The rows of a stepped statement as an input range.
+ * 
+ * Each step builds a Row from columns of the types Columns. The range is
+ * single-pass: begin() runs the statement from the top.
+ */
+template <typename Row, typename... Columns>
+class RowRange {
+public:
+    class iterator {
+    public:
+        using iterator_category = std::input_iterator_tag;
+        using value_type = Row;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const Row *;
+        using reference = const Row &;
+
+        iterator() = default;
+        explicit iterator(sqlite3_stmt *stmt) : stmt_(stmt) { step(); }
+
+        reference operator*() const { return *row_; }
+        pointer operator->() const { return &*row_; }
+
+        iterator &operator++() {
+            step();
+            return *this;
+        }
+
+        bool operator==(const iterator &other) const { return stmt_ == other.stmt_; }
+        bool operator!=(const iterator &other) const { return stmt_ != other.stmt_; }
+
+    private:
+        void step() {
+            int rc = sqlite3_step(stmt_);
+            if (rc == SQLITE_ROW) {
+                row_.emplace(detail::read_row<Row, Columns...>(stmt_, std::index_sequence_for<Columns...>{}));
+                return;
+            }
+            sqlite3 *db = sqlite3_db_handle(stmt_);
+            stmt_ = nullptr;    // now equal to end()
+            row_.reset();
+            if (rc != SQLITE_DONE) {
+                throw QueryError(db, "Failed to step statement");
+            }
+        }
+
+        sqlite3_stmt *stmt_ = nullptr;
+        std::optional<Row> row_;
+    };
+
+    explicit RowRange(sqlite3_stmt *stmt) : stmt_(stmt) {}
+
+    iterator begin() const {
+        sqlite3_reset(stmt_);
+        return iterator(stmt_);
+    }
+    iterator end() const { return iterator(); }
+
+private:
+    sqlite3_stmt *stmt_;
+};
+
+/**
+ * @brief A prepared statement leased from a StatementCache (or owned outright).
+ * 
+ * Move-only. When the lease ends the statement is reset, its bindings are
+ * cleared and it goes back to the cache.
+ */
+class Statement {
+public:
+    Statement(sqlite3_stmt *stmt, bool *in_use) noexcept : stmt_(stmt), in_use_(in_use) {}
+
+    Statement(Statement &&other) noexcept : stmt_(other.stmt_), in_use_(other.in_use_) {
+        other.stmt_ = nullptr;
+    }
+
+    Statement &operator=(Statement &&other) noexcept {
+        if (this != &other) {
+            release();
+            stmt_ = std::exchange(other.stmt_, nullptr);
+            in_use_ = other.in_use_;
+        }
+        return *this;
+    }
+
+    Statement(const Statement &) = delete;
+    Statement &operator=(const Statement &) = delete;
+
+    ~Statement() { release(); }
+
+    /**
+     * @brief Reset the statement and bind every parameter, in order.
+     *
+     * @param args One value per '?' in the SQL text.
+     * @return Statement& Returns this statement, for chaining.
+     */
+    template <typename... Args>
+    Statement &bind(Args &&...args) {
+        sqlite3_reset(stmt_);
+        if (sqlite3_bind_parameter_count(stmt_) != static_cast<int>(sizeof...(Args))) {
+            throw QueryError("Wrong number of parameters", SQLITE_RANGE);
+        }
+        int index = 0;
+        int rc = SQLITE_OK;
+        (void)index;    // unused without parameters
+        ((rc = rc == SQLITE_OK ? detail::bind_value(stmt_, ++index, std::forward<Args>(args)) : rc), ...);
+        if (rc != SQLITE_OK) {
+            throw QueryError(sqlite3_db_handle(stmt_), "Failed to bind parameter");
+        }
+        return *this;
+    }
+
+    /**
+     * @brief Run a statement that returns no rows.
+     *
+     * @return int Returns the number of rows changed.
+     */
+    int exec() {
+        sqlite3_reset(stmt_);
+        int rc = sqlite3_step(stmt_);
+        while (rc == SQLITE_ROW) {
+            rc = sqlite3_step(stmt_);
+        }
+        if (rc != SQLITE_DONE) {
+            throw QueryError(sqlite3_db_handle(stmt_), "Failed to execute statement");
+        }
+        return sqlite3_changes(sqlite3_db_handle(stmt_));
+    }
+
+    /**
+     * @brief Iterate over the rows as tuples, for structured bindings.
+     */
+    template <typename... Columns>
+    RowRange<std::tuple<Columns...>, Columns...> rows() {
+        return RowRange<std::tuple<Columns...>, Columns...>(stmt_);
+    }
+
+    /**
+     * @brief Iterate over the rows as a struct built from the columns in order.
+     */
+    template <typename Row, typename... Columns>
+    RowRange<Row, Columns...> rows_as() {
+        return RowRange<Row, Columns...>(stmt_);
+    }
+
+    /**
+     * @brief Get the first row as a tuple, if there is one.
+     *
+     * The statement stays on that row, so string_view columns remain valid
+     * until the next bind or the end of the lease.
+     */
+    template <typename... Columns>
+    std::optional<std::tuple<Columns...>> first() {
+        return first_as<std::tuple<Columns...>, Columns...>();
+    }
+
+    /**
+     * @brief Get the first row as a struct built from the columns in order.
+     */
+    template <typename Row, typename... Columns>
+    std::optional<Row> first_as() {
+        sqlite3_reset(stmt_);
+        int rc = sqlite3_step(stmt_);
+        if (rc == SQLITE_ROW) {
+            return detail::read_row<Row, Columns...>(stmt_, std::index_sequence_for<Columns...>{});
+        }
+        if (rc != SQLITE_DONE) {
+            throw QueryError(sqlite3_db_handle(stmt_), "Failed to step statement");
+        }
+        return std::nullopt;
+    }
+
+    /**
+     * @brief The underlying statement, for calls the wrapper does not cover.
+     */
+    sqlite3_stmt *get() const noexcept { return stmt_; }
+
+private:
+    void release() noexcept {
+        if (stmt_ == nullptr) {
+            return;
+        }
+        if (in_use_ != nullptr) {
+            sqlite3_reset(stmt_);
+            sqlite3_clear_bindings(stmt_);
+            *in_use_ = false;
+        } else {
+            sqlite3_finalize(stmt_);    // overflow statement, not cached
+        }
+        stmt_ = nullptr;
+    }
+
+    sqlite3_stmt *stmt_;
+    bool *in_use_;    // cache entry flag, or nullptr if this lease owns the statement
+};
+
+/**
+ * @brief Prepared statements of one connection, keyed by SQL text.
+ * 
+ * Not thread-safe: like the connection, use one cache per thread.
+ */
+class StatementCache {
+public:
+    explicit StatementCache(sqlite3 *db) : db_(db) {}
+
+    StatementCache(const StatementCache &) = delete;
+    StatementCache &operator=(const StatementCache &) = delete;
+
+    /**
+     * @brief Finalizes every cached statement; no lease may outlive the cache.
+     */
+    ~StatementCache() {
+        for (auto &entry : entries_) {
+            sqlite3_finalize(entry.second.stmt);
+        }
+    }
+
+    /**
+     * @brief Lease the statement for an SQL text, preparing it on first use.
+     *
+     * Looking up a cached statement does not allocate. If the statement is
+     * already leased (e.g. the same query nested in its own loop), a
+     * separate statement is prepared for this lease and finalized after it.
+     *
+     * @param sql SQL text of a single statement.
+     * @return Statement Returns the lease.
+     */
+    Statement prepare(std::string_view sql) {
+        auto found = entries_.find(sql);
+        if (found != entries_.end() && !found->second.in_use) {
+            found->second.in_use = true;
+            return Statement(found->second.stmt, &found->second.in_use);
+        }
+
+        sqlite3_stmt *stmt = nullptr;
+        unsigned int flags = found == entries_.end() ? SQLITE_PREPARE_PERSISTENT : 0;
+        if (sqlite3_prepare_v3(db_, sql.data(), static_cast<int>(sql.size()), flags, &stmt, nullptr) != SQLITE_OK ||
+            stmt == nullptr) {
+            sqlite3_finalize(stmt);
+            throw QueryError(db_, "Failed to prepare statement");
+        }
+        if (found != entries_.end()) {
+            return Statement(stmt, nullptr);
+        }
+        Entry &entry = entries_.emplace(std::string(sql), Entry{stmt, true}).first->second;
+        return Statement(stmt, &entry.in_use);
+    }
+
+    /**
+     * @brief Number of distinct SQL texts prepared so far.
+     */
+    size_t size() const noexcept { return entries_.size(); }
+
+    sqlite3 *db() const noexcept { return db_; }
+
+private:
+    struct Entry {
+        sqlite3_stmt *stmt;
+        bool in_use;
+    };
+
+    sqlite3 *db_;
+    std::map<std::string, Entry, std::less<>> entries_;    // std::less<> finds by string_view
+};
+
+} // namespace library
+
+#endif // QUERY_HPP
@@ -0,0 +1,104 @@
+#ifndef RECOMMEND_H
+#define RECOMMEND_H
+
+#include <sqlite3.h>
+
+#define RECOMMEND_PATH "database/recommend.bin"
+#define RECOMMEND_MAX_NEIGHBORS 64   // neighbours kept per book in the file
+#define RECOMMEND_MAX_HISTORY 256    // books per member used for co-occurrence
+#define RECOMMEND_SAVE_LOANS 10000   // pending loans that are written back to the file
+
+/**
+ * @brief One "borrowed together" recommendation.
+ */
+typedef struct {
+    int book_id;
+    int score;   // number of members who borrowed both books
+} Recommendation;
+
+/**
+ * @brief Build the co-borrowing matrix from Loans and write it to a file.
+ * 
+ * Member histories are split into partitions that are counted in parallel,
+ * then merged into a CSR matrix whose rows keep the strongest
+ * RECOMMEND_MAX_NEIGHBORS neighbours of each book.
+ * 
+ * @param db SQLite database connection.
+ * @param path Output file path.
+ * @param num_threads Number of worker threads (1 or more).
+ * @return int Returns number of books in the matrix, -1 on failure.
+ */
+int build_recommendations(sqlite3 *db, const char *path, int num_threads);
+
+/**
+ * @brief Memory-map a matrix file written by build_recommendations().
+ * 
+ * Any previously opened matrix and pending updates are discarded.
+ * 
+ * @param path Matrix file path.
+ * @return int Returns 0 on success, -1 on failure.
+ */
+int open_recommendations(const char *path);
+
+/**
+ * @brief Unmap the matrix and drop pending updates.
+ */
+void close_recommendations(void);
+
+/**
+ * @brief Rebuild the open matrix from Loans into the file it was mapped from.
+ * 
+ * For changes that catch_up_recommendations() cannot see, such as loans
+ * moved between books by merge_duplicate_books(). If no matrix is open,
+ * the file at RECOMMEND_PATH is rebuilt when it exists, so another
+ * process does not map stale rows from it later.
+ * 
+ * @param db SQLite database connection.
+ * @param num_threads Number of worker threads (1 or more).
+ * @return int Returns number of books in the matrix, -1 on failure.
+ */
+int rebuild_recommendations(sqlite3 *db, int num_threads);
+
+/**
+ * @brief Fold loans newer than the matrix into the in-memory update table.
+ * 
+ * Does nothing if no matrix is open, or inside a transaction: its loans
+ * may roll back and their IDs be reused, so they are picked up by the
+ * first call after it commits. Once RECOMMEND_SAVE_LOANS loans are
+ * pending, they are written back with flush_recommendations().
+ * 
+ * @param db SQLite database connection.
+ * @return int Returns number of loans processed, -1 on failure.
+ */
+int catch_up_recommendations(sqlite3 *db);
+
+/**
+ * @brief Get the books most often borrowed together with a book.
+ * 
+ * @param book_id The book ID.
+ * @param results Array to store recommendations, strongest first.
+ * @param max_count Maximum number of recommendations to return.
+ * @return int Returns number of recommendations found, -1 if no matrix is open.
+ */
+int get_similar_books(int book_id, Recommendation *results, int max_count);
+
+/**
+ * @brief Write the open matrix merged with pending updates to a new file.
+ * 
+ * The new file is opened in place of the current one.
+ * 
+ * @param path Output file path (may be the currently opened path).
+ * @return int Returns 0 on success, -1 on failure.
+ */
+int save_recommendations(const char *path);
+
+/**
+ * @brief Write pending updates back to the file the matrix was mapped from.
+ * 
+ * Called on exit, so the next start does not fold the same loans in again.
+ * 
+ * @return int Returns 1 if the file was written, 0 if nothing was pending, -1 on failure.
+ */
+int flush_recommendations(void);
+
+#endif // RECOMMEND_H
@@ -0,0 +1,103 @@
+#ifndef REMINDER_H
+#define REMINDER_H
+
+#include <sqlite3.h>
+
+#define REMINDER_BATCH_SIZE 256   // outbox rows written per transaction
+
+/**
+ * @brief Kind of a due-date notification.
+ */
+typedef enum {
+    REMINDER_DUE_TOMORROW = 0,    // the day before the due date
+    REMINDER_OVERDUE = 1          // on each overdue milestone (1, 7, 14 and 30 days)
+} ReminderKind;
+
+/**
+ * @brief One fired notification.
+ */
+typedef struct {
+    int loan_id;
+    int member_id;
+    int book_id;
+    int due_day;          // day number of the due date
+    int fire_day;         // day number the notification is for
+    ReminderKind kind;
+    int overdue_days;     // 0 for REMINDER_DUE_TOMORROW
+} Reminder;
+
+/**
+ * @brief Called for every notification fired by advance_reminders().
+ */
+typedef void (*ReminderCallback)(const Reminder *reminder, void *user_data);
+
+/**
+ * @brief Load every active loan into the timing wheel.
+ * 
+ * Each loan is armed for its next notification on or after today;
+ * notifications for earlier days are not replayed.
+ * 
+ * @param db SQLite database connection.
+ * @param today Day number the wheel starts at (see get_today_day()).
+ * @return int Returns number of loans scheduled, -1 on failure.
+ */
+int load_reminder_scheduler(sqlite3 *db, int today);
+
+/**
+ * @brief Free the timing wheel.
+ */
+void free_reminder_scheduler(void);
+
+/**
+ * @brief Schedule the notifications of a new loan (no-op if the wheel is not loaded).
+ * 
+ * @param loan_id Loan ID.
+ * @param member_id Member ID.
+ * @param book_id Book ID.
+ * @param due_day Day number of the due date.
+ * @return int Returns 0 on success, -1 on failure.
+ */
+int reminder_schedule_loan(int loan_id, int member_id, int book_id, int due_day);
+
+/**
+ * @brief Cancel the pending notifications of a returned loan (no-op if not scheduled).
+ * 
+ * @param loan_id Loan ID.
+ */
+void reminder_cancel_loan(int loan_id);
+
+/**
+ * @brief Point the scheduled loans of a book at another book (no-op if not loaded).
+ * 
+ * For loans moved by merge_duplicate_books().
+ * 
+ * @param from_book_id Book ID the loans had.
+ * @param to_book_id Book ID the loans have now.
+ */
+void reminder_move_book(int from_book_id, int to_book_id);
+
+/**
+ * @brief Advance the wheel to a day, firing every notification due by then.
+ * 
+ * Fired notifications are written to the ReminderOutbox table in batches
+ * of REMINDER_BATCH_SIZE and passed to the callback once their batch is
+ * written. A notification already in the outbox is not written twice.
+ * If a batch fails to write, its loans and the day it was for stay
+ * pending, so the next call fires them again.
+ * 
+ * @param db SQLite database connection.
+ * @param today Day number to advance to.
+ * @param callback Function called per notification, or NULL.
+ * @param user_data Passed to the callback.
+ * @return int Returns number of notifications fired, -1 on failure.
+ */
+int advance_reminders(sqlite3 *db, int today, ReminderCallback callback, void *user_data);
+
+/**
+ * @brief Count the loans with a pending notification.
+ * 
+ * @return int Returns the number of scheduled loans, -1 if the wheel is not loaded.
+ */
+int reminder_pending_count(void);
+
+#endif // REMINDER_H
@@ -0,0 +1,126 @@
+#ifndef RESULT_CACHE_H
+#define RESULT_CACHE_H
+
+#include <sqlite3.h>
+#include <stddef.h>
+
+#define RESULT_CACHE_DEFAULT_BUDGET (8 * 1024 * 1024)   // bytes
+#define RESULT_CACHE_ENTRY_SHARE 4     // one result may use at most budget / 4
+
+/**
+ * @brief Counters of the result cache.
+ */
+typedef struct {
+    long hits;
+    long misses;
+    long evictions;          // results dropped to stay within the budget
+    long invalidations;      // times every result was dropped after a write
+    long uncached;           // results too large to store, or read in a transaction
+    size_t entries;
+    size_t bytes;
+    size_t budget;
+} ResultCacheStats;
+
+struct CachedResult;
+
+/**
+ * @brief Reads the rows of a statement, from the cache or from SQLite.
+ * 
+ * Use it like the statement itself: result_cursor_step() instead of
+ * sqlite3_step() and result_cursor_int()/result_cursor_text() instead
+ * of sqlite3_column_*(). The statement stays owned by the caller.
+ */
+typedef struct {
+    sqlite3_stmt *stmt;
+    struct CachedResult *result;     // set when replaying a cached result
+    int row;                         // current row of result, -1 before the first step
+    struct CachedResult *recording;  // rows read so far on a miss, NULL if not stored
+    char number[24];                 // text of a numeric value
+} ResultCursor;
+
+/**
+ * @brief Start caching the results of the current thread's connection.
+ * 
+ * The cache belongs to the calling thread and to the connection returned
+ * by get_db_connection() at the time of the call. Cursors on other
+ * connections read straight from SQLite.
+ * 
+ * @param budget Memory budget in bytes (RESULT_CACHE_DEFAULT_BUDGET if 0).
+ * @return int Returns 0 on success, -1 on failure.
+ */
+int load_result_cache(size_t budget);
+
+/**
+ * @brief Drop every result and stop caching on the current thread.
+ */
+void free_result_cache(void);
+
+/**
+ * @brief Drop every cached result (the next reads go to SQLite).
+ */
+void invalidate_result_cache(void);
+
+/**
+ * @brief Copy the counters of the current thread's cache.
+ * 
+ * @param stats Pointer to store the counters.
+ * @return int Returns 0 on success, -1 if the cache is not loaded.
+ */
+int get_result_cache_stats(ResultCacheStats *stats);
+
+/**
+ * @brief Print the cache counters and hit rate.
+ * 
+ * @return int Returns 0 on success, -1 if the cache is not loaded.
+ */
+int display_result_cache_stats(void);
+
+/**
+ * @brief Open a cursor on a prepared and bound read-only statement.
+ * 
+ * The cache key is the statement's SQL with the bound values expanded.
+ * Cached results are dropped whenever PRAGMA data_version (commits by
+ * other connections) or the connection's total change count (its own
+ * writes) moves. Nothing is cached or served inside an open transaction.
+ * 
+ * @param cursor Cursor to open.
+ * @param stmt The prepared and bound statement.
+ */
+void result_cursor_open(ResultCursor *cursor, sqlite3_stmt *stmt);
+
+/**
+ * @brief Move to the next row.
+ * 
+ * When the last row has been read from SQLite, the result is stored.
+ * 
+ * @param cursor The cursor.
+ * @return int Returns SQLITE_ROW, SQLITE_DONE or the SQLite error code.
+ */
+int result_cursor_step(ResultCursor *cursor);
+
+/**
+ * @brief Get a column of the current row as an integer.
+ * 
+ * @param cursor The cursor.
+ * @param column Column index.
+ * @return long long Returns the value (0 for NULL).
+ */
+long long result_cursor_int(ResultCursor *cursor, int column);
+
+/**
+ * @brief Get a column of the current row as text.
+ * 
+ * @param cursor The cursor.
+ * @param column Column index.
+ * @return const char* Returns the text, valid until the next step, or NULL for NULL.
+ */
+const char *result_cursor_text(ResultCursor *cursor, int column);
+
+/**
+ * @brief Close a cursor; a result not read to the end is not stored.
+ * 
+ * @param cursor The cursor.
+ */
+void result_cursor_close(ResultCursor *cursor);
+
+#endif // RESULT_CACHE_H
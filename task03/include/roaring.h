@@ -0,0 +1,158 @@
+#ifndef ROARING_H
+#define ROARING_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#define ROARING_ARRAY 0                // sorted uint16_t values
+#define ROARING_BITMAP 1               // ROARING_BITMAP_WORDS 64-bit words
+#define ROARING_ARRAY_MAX 4096         // larger containers become bitmaps
+#define ROARING_BITMAP_WORDS 1024
+
+/**
+ * @brief The values of a bitmap that share their upper 16 bits.
+ */
+typedef struct {
+    uint16_t key;            // upper 16 bits
+    uint16_t kind;           // ROARING_ARRAY or ROARING_BITMAP
+    uint32_t cardinality;    // 1..65536
+    void *data;              // uint16_t[capacity] or uint64_t[ROARING_BITMAP_WORDS]
+    uint32_t capacity;       // values the array can hold (arrays only)
+} RoaringContainer;
+
+/**
+ * @brief A compressed set of 32-bit values (Roaring layout, in memory).
+ */
+typedef struct {
+    RoaringContainer *containers;    // sorted by key
+    int count;
+    int capacity;
+} RoaringBitmap;
+
+/**
+ * @brief A container as stored in a file; data is at offset from the data section.
+ */
+typedef struct {
+    uint16_t key;
+    uint16_t kind;
+    uint32_t cardinality;
+    uint64_t offset;         // 8-byte aligned
+} RoaringFileContainer;
+
+/**
+ * @brief A read-only bitmap inside a file or memory map.
+ */
+typedef struct {
+    const RoaringFileContainer *containers;    // sorted by key
+    int count;
+    const char *data;                          // start of the data section
+} RoaringView;
+
+/**
+ * @brief Initialize an empty bitmap.
+ * 
+ * @param bitmap The bitmap.
+ */
+void roaring_init(RoaringBitmap *bitmap);
+
+/**
+ * @brief Release the containers of a bitmap and leave it empty.
+ * 
+ * @param bitmap The bitmap.
+ */
+void roaring_free(RoaringBitmap *bitmap);
+
+/**
+ * @brief Add a value; appending in ascending order is the fast path.
+ * 
+ * @param bitmap The bitmap.
+ * @param value The value.
+ * @return int Returns 0 on success, -1 if memory ran out.
+ */
+int roaring_add(RoaringBitmap *bitmap, uint32_t value);
+
+/**
+ * @brief Remove a value; a no-op if the bitmap does not contain it.
+ * 
+ * @param bitmap The bitmap.
+ * @param value The value.
+ */
+void roaring_remove(RoaringBitmap *bitmap, uint32_t value);
+
+/**
+ * @brief Check whether a bitmap contains a value.
+ * 
+ * @return int Returns 1 if it does, 0 otherwise.
+ */
+int roaring_contains(const RoaringBitmap *bitmap, uint32_t value);
+
+/**
+ * @brief Check whether a mapped bitmap contains a value.
+ * 
+ * @return int Returns 1 if it does, 0 otherwise.
+ */
+int roaring_view_contains(const RoaringView *view, uint32_t value);
+
+/**
+ * @brief Count the values of a bitmap.
+ * 
+ * @return long Returns the number of values.
+ */
+long roaring_cardinality(const RoaringBitmap *bitmap);
+
+/**
+ * @brief Union: add every value of src to dst.
+ * 
+ * @param dst The bitmap to update.
+ * @param src The other bitmap.
+ * @return int Returns 0 on success, -1 if memory ran out (dst is then partially updated).
+ */
+int roaring_or(RoaringBitmap *dst, const RoaringBitmap *src);
+
+/**
+ * @brief Union with a mapped bitmap, container by container without decoding it.
+ * 
+ * @param dst The bitmap to update.
+ * @param src The mapped bitmap.
+ * @return int Returns 0 on success, -1 if memory ran out.
+ */
+int roaring_or_view(RoaringBitmap *dst, const RoaringView *src);
+
+/**
+ * @brief Intersection: keep only the values of dst that are also in src.
+ * 
+ * @param dst The bitmap to update.
+ * @param src The other bitmap.
+ * @return int Returns 0 on success, -1 if memory ran out.
+ */
+int roaring_and(RoaringBitmap *dst, const RoaringBitmap *src);
+
+/**
+ * @brief Intersection with a mapped bitmap, container by container without decoding it.
+ * 
+ * @param dst The bitmap to update.
+ * @param src The mapped bitmap.
+ * @return int Returns 0 on success, -1 if memory ran out.
+ */
+int roaring_and_view(RoaringBitmap *dst, const RoaringView *src);
+
+/**
+ * @brief Copy the values of a bitmap in ascending order.
+ * 
+ * @param bitmap The bitmap.
+ * @param out Array to store the values.
+ * @param max_count Size of out.
+ * @return long Returns number of values copied.
+ */
+long roaring_to_array(const RoaringBitmap *bitmap, uint32_t *out, long max_count);
+
+/**
+ * @brief Bytes a container occupies in the data section of a file (multiple of 8).
+ * 
+ * @param kind ROARING_ARRAY or ROARING_BITMAP.
+ * @param cardinality Number of values.
+ * @return size_t Returns the size in bytes.
+ */
+size_t roaring_container_bytes(int kind, uint32_t cardinality);
+
+#endif // ROARING_H
@@ -0,0 +1,66 @@
+#ifndef ROLLUP_H
+#define ROLLUP_H
+
+#include <sqlite3.h>
+#include "loan.h"
+
+/**
+ * @brief Bucket size of a circulation time series.
+ */
+typedef enum {
+    ROLLUP_DAILY = 0,
+    ROLLUP_MONTHLY = 1
+} RollupGranularity;
+
+/**
+ * @brief Loans and returns in one day or month.
+ */
+typedef struct {
+    char period[MAX_DATE_LEN];   // YYYY-MM-DD (daily) or YYYY-MM (monthly)
+    int loans;
+    int returns;
+} CirculationPoint;
+
+/**
+ * @brief Fold loans and returns not yet counted into the rollup tables.
+ * 
+ * Progress is keyed on the last loan_id and return_id processed, so the
+ * function can run after every loan or as a catch-up job. It joins the
+ * caller's transaction if one is open and uses its own otherwise.
+ * 
+ * @param db SQLite database connection.
+ * @return int Returns number of loans and returns folded in, -1 on failure.
+ */
+int update_circulation_rollups(sqlite3 *db);
+
+/**
+ * @brief Read a time series of loans and returns from the rollup tables.
+ * 
+ * Only periods with activity are returned.
+ * 
+ * @param db SQLite database connection.
+ * @param granularity ROLLUP_DAILY or ROLLUP_MONTHLY.
+ * @param from_date First date of the range (YYYY-MM-DD).
+ * @param to_date Last date of the range (YYYY-MM-DD).
+ * @param genre Genre to count, or NULL for all genres.
+ * @param points Array to store the periods in date order.
+ * @param max_count Maximum number of periods to return.
+ * @return int Returns number of periods found, -1 on failure.
+ */
+int get_circulation_series(sqlite3 *db, RollupGranularity granularity, const char *from_date,
+                           const char *to_date, const char *genre, CirculationPoint *points, int max_count);
+
+/**
+ * @brief Print the circulation time series and per-genre totals of a range.
+ * 
+ * @param db SQLite database connection.
+ * @param granularity ROLLUP_DAILY or ROLLUP_MONTHLY.
+ * @param from_date First date of the range (YYYY-MM-DD).
+ * @param to_date Last date of the range (YYYY-MM-DD).
+ * @param genre Genre to count, or NULL for all genres.
+ * @return int Returns number of periods printed, -1 on failure.
+ */
+int display_circulation_report(sqlite3 *db, RollupGranularity granularity, const char *from_date,
+                               const char *to_date, const char *genre);
+
+#endif // ROLLUP_H
@@ -0,0 +1,23 @@
+#ifndef SQL_FUNCTIONS_H
+#define SQL_FUNCTIONS_H
+
+#include <sqlite3.h>
+
+/**
+ * @brief Register the library's scalar SQL functions on a connection.
+ * 
+ * All functions are deterministic and use integer civil-date arithmetic
+ * (see date_to_day()), so they can be used in WHERE and ORDER BY clauses:
+ * 
+ * - date_to_day(date): day number of a YYYY-MM-DD date.
+ * - overdue_days(due_date, as_of): days past due as of a date, 0 if not overdue.
+ * - suspension_days(overdue_days): loan suspension for an overdue period.
+ * 
+ * Each returns NULL when an argument is NULL or not a valid date.
+ * 
+ * @param db SQLite database connection.
+ * @return int Returns 0 on success, -1 on failure.
+ */
+int register_sql_functions(sqlite3 *db);
+
+#endif // SQL_FUNCTIONS_H
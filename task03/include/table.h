@@ -0,0 +1,116 @@
+#ifndef TABLE_H
+#define TABLE_H
+
+#include <stdio.h>
+#include <stddef.h>
+
+#define TABLE_BUFFER_SIZE (256 * 1024)   // output is written in blocks of this size
+#define TABLE_PAGE_LINES 24              // terminal height when LINES is not set
+#define TABLE_DEFAULT_PAGER "less -R"    // used when PAGER is not set
+
+/**
+ * @brief Output format of a table.
+ */
+typedef enum {
+    TABLE_FORMAT_ALIGNED = 0,    // fixed-width columns with a title and footer
+    TABLE_FORMAT_CSV = 1,        // RFC 4180 quoting, header row
+    TABLE_FORMAT_TSV = 2,        // tabs and newlines inside cells become spaces
+    TABLE_FORMAT_JSON = 3        // array of objects keyed by column name
+} TableFormat;
+
+/**
+ * @brief One column of a table.
+ */
+typedef struct {
+    const char *name;
+    int width;     // display columns in the aligned format, 0 for no padding (last column)
+} TableColumn;
+
+/**
+ * @brief A table being written; rows are streamed through a large buffer.
+ */
+typedef struct {
+    FILE *out;
+    FILE *pager;             // open pager pipe, or NULL
+    TableFormat format;
+    const TableColumn *columns;
+    int column_count;
+    int column;              // index of the next cell in the current row
+    int rows;
+    int lines;               // lines written in the aligned format
+    int page_lines;          // page height, 0 if the output is never paged
+    int destination_chosen;  // set once output has been written out
+    char *buffer;            // NULL if allocation failed (output is then unbuffered)
+    size_t size;
+} Table;
+
+/**
+ * @brief Set the format used by the listing functions (display_all_books() etc.).
+ * 
+ * @param format The output format.
+ */
+void table_set_format(TableFormat format);
+
+/**
+ * @brief Get the format used by the listing functions.
+ * 
+ * @return TableFormat Returns the current format.
+ */
+TableFormat table_get_format(void);
+
+/**
+ * @brief Parse a format name ("table", "csv", "tsv" or "json").
+ * 
+ * @param name The format name.
+ * @return int Returns the TableFormat, -1 if the name is unknown.
+ */
+int table_parse_format(const char *name);
+
+/**
+ * @brief Allow or forbid handing long listings on a terminal to a pager.
+ * 
+ * @param enabled 1 to use $PAGER (default "less -R") when the output is
+ *        longer than one screen, 0 to always write directly.
+ */
+void table_set_pager(int enabled);
+
+/**
+ * @brief Start a table in the current format and write its title and header.
+ * 
+ * @param table Table to initialize.
+ * @param out Destination stream; only stdout on a terminal is ever paged.
+ * @param title Title printed above an aligned table, or NULL.
+ * @param columns Column definitions (must outlive the table).
+ * @param column_count Number of columns.
+ */
+void table_begin(Table *table, FILE *out, const char *title, const TableColumn *columns, int column_count);
+
+/**
+ * @brief Append a text cell; the row ends after its last column.
+ * 
+ * In the aligned format the text is padded to the column width by display
+ * width and cut with ".." when it does not fit.
+ * 
+ * @param table The table.
+ * @param text UTF-8 text, or NULL (empty, or null in JSON).
+ */
+void table_text(Table *table, const char *text);
+
+/**
+ * @brief Append an integer cell; the row ends after its last column.
+ * 
+ * @param table The table.
+ * @param value The value.
+ */
+void table_int(Table *table, long long value);
+
+/**
+ * @brief Finish a table, print the footer and write out everything buffered.
+ * 
+ * @param table The table.
+ * @param footer printf-style footer printed below an aligned table, or NULL.
+ * @return int Returns number of rows written.
+ */
+int table_end(Table *table, const char *footer, ...);
+
+#endif // TABLE_H
@@ -0,0 +1,64 @@
+#ifndef TRIGRAM_H
+#define TRIGRAM_H
+
+#include <sqlite3.h>
+
+#define TRIGRAM_MAX_TEXT 160   // code points indexed per title or author
+
+/**
+ * @brief One fuzzy search hit.
+ */
+typedef struct {
+    int book_id;
+    int overlap;    // trigrams shared with the query
+    int distance;   // edit distance to the closer of title and author
+} FuzzyMatch;
+
+/**
+ * @brief Build the in-memory trigram index over Books.title and Books.author.
+ * 
+ * Text is lower-cased and split into code-point trigrams, so Hangul
+ * syllables count as one character each. Any previously loaded index is replaced.
+ * 
+ * @param db SQLite database connection.
+ * @return int Returns number of books indexed, -1 on failure.
+ */
+int load_trigram_index(sqlite3 *db);
+
+/**
+ * @brief Release the in-memory trigram index.
+ */
+void free_trigram_index(void);
+
+/**
+ * @brief Re-read one book from the database and update its postings.
+ * 
+ * Does nothing if the index is not loaded. A book that no longer exists is removed.
+ * 
+ * @param db SQLite database connection.
+ * @param book_id The ID of the book.
+ * @return int Returns 0 on success, -1 on failure.
+ */
+int trigram_refresh_book(sqlite3 *db, int book_id);
+
+/**
+ * @brief Drop one book from the index. Does nothing if the index is not loaded.
+ * 
+ * @param book_id The ID of the book.
+ */
+void trigram_remove_book(int book_id);
+
+/**
+ * @brief Typo-tolerant search over titles and authors.
+ * 
+ * Candidates are ranked by trigram overlap with the query, then by edit
+ * distance. The index is loaded from the global connection on first use.
+ * 
+ * @param query The search text.
+ * @param results Array to store matches, best first.
+ * @param max_count Maximum number of matches to return.
+ * @return int Returns number of matches found, -1 on failure.
+ */
+int fuzzy_search_books(const char *query, FuzzyMatch *results, int max_count);
+
+#endif // TRIGRAM_H
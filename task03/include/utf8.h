@@ -0,0 +1,60 @@
+#ifndef UTF8_H
+#define UTF8_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#define UTF8_REPLACEMENT 0xFFFD   // substituted for malformed input
+
+/**
+ * @brief Decode one code point from a UTF-8 string.
+ * 
+ * Malformed or truncated sequences decode to UTF8_REPLACEMENT and consume
+ * a single byte, so decoding always makes progress.
+ * 
+ * @param s Pointer to the next byte (must not point at the terminating NUL).
+ * @param cp Pointer to store the decoded code point.
+ * @return int Returns number of bytes consumed (1 to 4).
+ */
+int utf8_decode(const char *s, uint32_t *cp);
+
+/**
+ * @brief Encode one code point as UTF-8.
+ * 
+ * @param cp The code point.
+ * @param out Buffer with room for at least 4 bytes (not NUL-terminated).
+ * @return int Returns number of bytes written (1 to 4).
+ */
+int utf8_encode(uint32_t cp, char *out);
+
+/**
+ * @brief Decode a UTF-8 string into code points.
+ * 
+ * @param s NUL-terminated UTF-8 string.
+ * @param out Array to store code points.
+ * @param max_count Capacity of out; longer input is truncated.
+ * @return size_t Returns number of code points stored.
+ */
+size_t utf8_to_codepoints(const char *s, uint32_t *out, size_t max_count);
+
+/**
+ * @brief Get the number of terminal columns a code point occupies.
+ * 
+ * East Asian wide and fullwidth characters (Hangul syllables, CJK
+ * ideographs, fullwidth forms, most emoji) take two columns; combining
+ * marks and Hangul medial/final jamo take none.
+ * 
+ * @param cp The code point.
+ * @return int Returns 0, 1 or 2.
+ */
+int utf8_char_width(uint32_t cp);
+
+/**
+ * @brief Get the number of terminal columns a UTF-8 string occupies.
+ * 
+ * @param s NUL-terminated UTF-8 string.
+ * @return size_t Returns the display width.
+ */
+size_t utf8_display_width(const char *s);
+
+#endif // UTF8_H
@@ -0,0 +1,798 @@
+#include "analytics.h"
+#include "book_table.h"
+#include "date_utils.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+
+#define PARALLEL_MIN_ROWS 65536   // loans per thread below which aggregates stay on one thread
+#define UNKNOWN_DUE_DAY INT32_MAX  // loans with a malformed due date are never overdue
+#define UNKNOWN_REGISTRATION_DAY INT32_MIN  // members with a malformed registration date are never new
+
+/**
+ * @brief Column store of Members.
+ */
+typedef struct {
+    int count;
+    int capacity;
+    int32_t *ids;                   // ascending
+    int32_t *registration_days;
+    int32_t *suspended_until;       // day number, 0 if never suspended
+} MemberColumns;
+
+/**
+ * @brief Column store of Loans plus the books they refer to.
+ */
+typedef struct {
+    int count;
+    int capacity;
+    int32_t *loan_ids;          // ascending
+    int32_t *book_ids;
+    int32_t *member_ids;
+    int32_t *loan_days;
+    int32_t *due_days;
+    uint8_t *returned;
+    int max_book_id;            // over loans and books
+    int max_member_id;
+    int64_t last_loan_id;
+    int64_t last_return_id;
+    BookTable books;
+    MemberColumns members;
+    uint16_t *genre_by_book;    // by book_id, index into books.genres
+    int genre_capacity;
+    int num_threads;
+} AnalyticsStore;
+
+typedef enum {
+    KERNEL_BOOK_COUNTS,
+    KERNEL_GENRE_COUNTS,
+    KERNEL_ACTIVE_COUNTS,
+    KERNEL_SUMMARY
+} KernelKind;
+
+/**
+ * @brief One thread's slice of an aggregate and its private accumulators.
+ */
+typedef struct {
+    const AnalyticsStore *store;
+    KernelKind kind;
+    int begin;
+    int end;
+    int today;
+    uint32_t *counts;           // KERNEL_BOOK_COUNTS / KERNEL_GENRE_COUNTS / KERNEL_ACTIVE_COUNTS
+    uint64_t *active_bits;      // KERNEL_SUMMARY, by member_id
+    uint64_t *overdue_bits;
+    LoanSummary summary;
+} KernelTask;
+
+static AnalyticsStore *store = NULL;
+
+/**
+ * @brief Resize one column, keeping its contents.
+ */
+static int grow_column(void **column, size_t element_size, int capacity) {
+    void *grown = realloc(*column, (size_t)capacity * element_size);
+    if (grown == NULL) {
+        fprintf(stderr, "Out of memory\n");
+        return -1;
+    }
+    *column = grown;
+    return 0;
+}
+
+/**
+ * @brief Make room for at least one more loan.
+ */
+static int reserve_loan(AnalyticsStore *s) {
+    if (s->count < s->capacity) {
+        return 0;
+    }
+
+    int capacity = s->capacity ? s->capacity * 2 : 1024;
+    if (grow_column((void **)&s->loan_ids, sizeof(int32_t), capacity) != 0 ||
+        grow_column((void **)&s->book_ids, sizeof(int32_t), capacity) != 0 ||
+        grow_column((void **)&s->member_ids, sizeof(int32_t), capacity) != 0 ||
+        grow_column((void **)&s->loan_days, sizeof(int32_t), capacity) != 0 ||
+        grow_column((void **)&s->due_days, sizeof(int32_t), capacity) != 0 ||
+        grow_column((void **)&s->returned, sizeof(uint8_t), capacity) != 0) {
+        return -1;
+    }
+    s->capacity = capacity;
+    return 0;
+}
+
+/**
+ * @brief Make genre_by_book cover book IDs up to max_book_id (new entries are genre 0).
+ */
+static int reserve_genres(AnalyticsStore *s) {
+    if (s->max_book_id < s->genre_capacity) {
+        return 0;
+    }
+
+    int capacity = s->genre_capacity ? s->genre_capacity : 1024;
+    while (capacity <= s->max_book_id) {
+        capacity *= 2;
+    }
+    uint16_t *genres = realloc(s->genre_by_book, capacity * sizeof(uint16_t));
+    if (genres == NULL) {
+        fprintf(stderr, "Out of memory\n");
+        return -1;
+    }
+    memset(genres + s->genre_capacity, 0, (capacity - s->genre_capacity) * sizeof(uint16_t));
+    s->genre_by_book = genres;
+    s->genre_capacity = capacity;
+    return 0;
+}
+
+/**
+ * @brief Reload every book and rebuild the book -> genre map.
+ * 
+ * Books are few next to loans, so a full reload is cheap and picks up
+ * deleted books and edited genres or quantities.
+ */
+static int load_books(sqlite3 *db, AnalyticsStore *s) {
+    book_table_free(&s->books);
+    if (book_table_init(&s->books) != 0) {
+        fprintf(stderr, "Out of memory\n");
+        return -1;
+    }
+    if (load_book_table(db, &s->books) < 0) {
+        return -1;
+    }
+
+    BookTable *books = &s->books;
+    if (books->count > 0 && books->book_ids[books->count - 1] > s->max_book_id) {
+        s->max_book_id = books->book_ids[books->count - 1];
+    }
+    if (reserve_genres(s) != 0) {
+        return -1;
+    }
+    memset(s->genre_by_book, 0, s->genre_capacity * sizeof(uint16_t));
+    for (int row = 0; row < books->count; row++) {
+        s->genre_by_book[books->book_ids[row]] = books->genre_ids[row];
+    }
+    return 0;
+}
+
+/**
+ * @brief Make room for at least one more member.
+ */
+static int reserve_member(MemberColumns *m) {
+    if (m->count < m->capacity) {
+        return 0;
+    }
+
+    int capacity = m->capacity ? m->capacity * 2 : 256;
+    if (grow_column((void **)&m->ids, sizeof(int32_t), capacity) != 0 ||
+        grow_column((void **)&m->registration_days, sizeof(int32_t), capacity) != 0 ||
+        grow_column((void **)&m->suspended_until, sizeof(int32_t), capacity) != 0) {
+        return -1;
+    }
+    m->capacity = capacity;
+    return 0;
+}
+
+/**
+ * @brief Reload every member; suspended_until is kept current by the penalty ledger.
+ */
+static int load_members(sqlite3 *db, AnalyticsStore *s) {
+    const char *sql = "SELECT member_id, registration_date, COALESCE(suspended_until, 0) "
+                      "FROM Members ORDER BY member_id;";
+
+    sqlite3_stmt *stmt;
+    if (sqlite3_prepare_v2(db, sql, -1, &stmt, NULL) != SQLITE_OK) {
+        fprintf(stderr, "Failed to prepare statement: %s\n", sqlite3_errmsg(db));
+        return -1;
+    }
+
+    MemberColumns *m = &s->members;
+    m->count = 0;
+
+    int rc;
+    while ((rc = sqlite3_step(stmt)) == SQLITE_ROW) {
+        if (reserve_member(m) != 0) {
+            rc = SQLITE_ERROR;
+            break;
+        }
+
+        int i = m->count;
+        m->ids[i] = sqlite3_column_int(stmt, 0);
+        if (date_to_day((const char *)sqlite3_column_text(stmt, 1), &m->registration_days[i]) != 0) {
+            m->registration_days[i] = UNKNOWN_REGISTRATION_DAY;
+        }
+        m->suspended_until[i] = sqlite3_column_int(stmt, 2);
+        m->count++;
+    }
+
+    if (rc != SQLITE_DONE && rc != SQLITE_ERROR) {
+        fprintf(stderr, "Error during query execution: %s\n", sqlite3_errmsg(db));
+    }
+    sqlite3_finalize(stmt);
+    return rc == SQLITE_DONE ? 0 : -1;
+}
+
+/**
+ * @brief Append loans added since the last refresh.
+ * 
+ * @return int Returns number of loans appended, -1 on failure.
+ */
+static int load_new_loans(sqlite3 *db, AnalyticsStore *s) {
+    const char *sql = "SELECT loan_id, book_id, member_id, loan_date, due_date, is_returned "
+                      "FROM Loans WHERE loan_id > ? ORDER BY loan_id;";
+
+    sqlite3_stmt *stmt;
+    if (sqlite3_prepare_v2(db, sql, -1, &stmt, NULL) != SQLITE_OK) {
+        fprintf(stderr, "Failed to prepare statement: %s\n", sqlite3_errmsg(db));
+        return -1;
+    }
+
+    sqlite3_bind_int64(stmt, 1, s->last_loan_id);
+
+    int added = 0;
+    int rc;
+    while ((rc = sqlite3_step(stmt)) == SQLITE_ROW) {
+        if (reserve_loan(s) != 0) {
+            rc = SQLITE_ERROR;
+            break;
+        }
+
+        int i = s->count;
+        s->loan_ids[i] = sqlite3_column_int(stmt, 0);
+        s->book_ids[i] = sqlite3_column_int(stmt, 1);
+        s->member_ids[i] = sqlite3_column_int(stmt, 2);
+        if (date_to_day((const char *)sqlite3_column_text(stmt, 3), &s->loan_days[i]) != 0) {
+            s->loan_days[i] = 0;
+        }
+        if (date_to_day((const char *)sqlite3_column_text(stmt, 4), &s->due_days[i]) != 0) {
+            s->due_days[i] = UNKNOWN_DUE_DAY;
+        }
+        s->returned[i] = sqlite3_column_int(stmt, 5) != 0;
+
+        if (s->book_ids[i] < 0 || s->member_ids[i] < 0) {
+            fprintf(stderr, "Invalid IDs in loan %d\n", s->loan_ids[i]);
+            rc = SQLITE_ERROR;
+            break;
+        }
+        if (s->book_ids[i] > s->max_book_id) {
+            s->max_book_id = s->book_ids[i];
+        }
+        if (s->member_ids[i] > s->max_member_id) {
+            s->max_member_id = s->member_ids[i];
+        }
+        s->last_loan_id = s->loan_ids[i];
+        s->count++;
+        added++;
+    }
+
+    if (rc != SQLITE_DONE && rc != SQLITE_ERROR) {
+        fprintf(stderr, "Error during query execution: %s\n", sqlite3_errmsg(db));
+    }
+    sqlite3_finalize(stmt);
+    if (rc != SQLITE_DONE) {
+        return -1;
+    }
+    return reserve_genres(s) == 0 ? added : -1;
+}
+
+/**
+ * @brief Find a loan by ID in the ascending loan_ids column.
+ * 
+ * @return int Returns the row, -1 if the loan is not loaded.
+ */
+static int find_loan(const AnalyticsStore *s, int loan_id) {
+    int low = 0;
+    int high = s->count - 1;
+    while (low <= high) {
+        int mid = low + (high - low) / 2;
+        if (s->loan_ids[mid] < loan_id) {
+            low = mid + 1;
+        } else if (s->loan_ids[mid] > loan_id) {
+            high = mid - 1;
+        } else {
+            return mid;
+        }
+    }
+    return -1;
+}
+
+/**
+ * @brief Read one integer from a query without parameters.
+ */
+static int query_int64(sqlite3 *db, const char *sql, int64_t *value) {
+    sqlite3_stmt *stmt;
+    if (sqlite3_prepare_v2(db, sql, -1, &stmt, NULL) != SQLITE_OK) {
+        fprintf(stderr, "Failed to prepare statement: %s\n", sqlite3_errmsg(db));
+        return -1;
+    }
+
+    int rc = sqlite3_step(stmt);
+    if (rc == SQLITE_ROW) {
+        *value = sqlite3_column_int64(stmt, 0);
+    } else {
+        fprintf(stderr, "Error during query execution: %s\n", sqlite3_errmsg(db));
+    }
+    sqlite3_finalize(stmt);
+    return rc == SQLITE_ROW ? 0 : -1;
+}
+
+/**
+ * @brief Mark loans returned since the last refresh.
+ */
+static int load_new_returns(sqlite3 *db, AnalyticsStore *s) {
+    const char *sql = "SELECT return_id, loan_id "
+                      "FROM Returns WHERE return_id > ? ORDER BY return_id;";
+
+    sqlite3_stmt *stmt;
+    if (sqlite3_prepare_v2(db, sql, -1, &stmt, NULL) != SQLITE_OK) {
+        fprintf(stderr, "Failed to prepare statement: %s\n", sqlite3_errmsg(db));
+        return -1;
+    }
+
+    sqlite3_bind_int64(stmt, 1, s->last_return_id);
+
+    int rc;
+    while ((rc = sqlite3_step(stmt)) == SQLITE_ROW) {
+        int row = find_loan(s, sqlite3_column_int(stmt, 1));
+        if (row >= 0) {
+            s->returned[row] = 1;
+        }
+        s->last_return_id = sqlite3_column_int64(stmt, 0);
+    }
+
+    if (rc != SQLITE_DONE) {
+        fprintf(stderr, "Error during query execution: %s\n", sqlite3_errmsg(db));
+    }
+    sqlite3_finalize(stmt);
+    return rc == SQLITE_DONE ? 0 : -1;
+}
+
+int refresh_analytics(sqlite3 *db, int num_threads) {
+    if (db == NULL) {
+        fprintf(stderr, "Database connection is NULL\n");
+        return -1;
+    }
+
+    if (store == NULL) {
+        store = calloc(1, sizeof(AnalyticsStore));
+        if (store == NULL) {
+            fprintf(stderr, "Out of memory\n");
+            return -1;
+        }
+
+        /* is_returned already reflects every existing return */
+        if (query_int64(db, "SELECT COALESCE(MAX(return_id), 0) FROM Returns;", &store->last_return_id) != 0) {
+            free_analytics();
+            return -1;
+        }
+    }
+    store->num_threads = num_threads > 0 ? num_threads : 1;
+
+    int added = -1;
+    if (load_books(db, store) == 0 && load_members(db, store) == 0) {
+        added = load_new_loans(db, store);
+    }
+    if (added < 0 || load_new_returns(db, store) != 0) {
+        free_analytics();   // rebuilt from scratch next time
+        return -1;
+    }
+    return added;
+}
+
+void free_analytics(void) {
+    if (store == NULL) {
+        return;
+    }
+
+    free(store->loan_ids);
+    free(store->book_ids);
+    free(store->member_ids);
+    free(store->loan_days);
+    free(store->due_days);
+    free(store->returned);
+    free(store->genre_by_book);
+    free(store->members.ids);
+    free(store->members.registration_days);
+    free(store->members.suspended_until);
+    book_table_free(&store->books);
+    free(store);
+    store = NULL;
+}
+
+/**
+ * @brief Run one aggregate over the task's slice of loans.
+ */
+static void *run_kernel(void *arg) {
+    KernelTask *task = arg;
+    const AnalyticsStore *s = task->store;
+    const int32_t *book_ids = s->book_ids;
+
+    switch (task->kind) {
+        case KERNEL_BOOK_COUNTS:
+            for (int i = task->begin; i < task->end; i++) {
+                task->counts[book_ids[i]]++;
+            }
+            break;
+
+        case KERNEL_GENRE_COUNTS:
+            for (int i = task->begin; i < task->end; i++) {
+                task->counts[s->genre_by_book[book_ids[i]]]++;
+            }
+            break;
+
+        case KERNEL_ACTIVE_COUNTS:
+            for (int i = task->begin; i < task->end; i++) {
+                task->counts[book_ids[i]] += s->returned[i] == 0;
+            }
+            break;
+
+        case KERNEL_SUMMARY: {
+            /* Branch-free totals first so the compiler can vectorize them */
+            const int32_t *due_days = s->due_days;
+            const uint8_t *returned = s->returned;
+            int today = task->today;
+            int active = 0;
+            int overdue = 0;
+            int max_days = 0;
+            int64_t days = 0;
+            for (int i = task->begin; i < task->end; i++) {
+                int is_active = returned[i] == 0;
+                int late = is_active & (due_days[i] < today);
+                int late_days = late ? today - due_days[i] : 0;
+                active += is_active;
+                overdue += late;
+                days += late_days;
+                max_days = late_days > max_days ? late_days : max_days;
+            }
+
+            for (int i = task->begin; i < task->end; i++) {
+                if (returned[i] == 0) {
+                    int member_id = s->member_ids[i];
+                    task->active_bits[member_id >> 6] |= 1ULL << (member_id & 63);
+                    if (due_days[i] < today) {
+                        task->overdue_bits[member_id >> 6] |= 1ULL << (member_id & 63);
+                    }
+                }
+            }
+
+            task->summary.active_loans = active;
+            task->summary.overdue_loans = overdue;
+            task->summary.overdue_days = days;
+            task->summary.max_overdue_days = max_days;
+            break;
+        }
+    }
+    return NULL;
+}
+
+/**
+ * @brief Split the loans across threads, run a kernel and merge the results.
+ * 
+ * @param kind Aggregate to run.
+ * @param today Reference day (KERNEL_SUMMARY only).
+ * @param counts Zeroed histogram of counts_size entries (count kernels only).
+ * @param counts_size Number of histogram entries.
+ * @param summary Totals (KERNEL_SUMMARY only).
+ * @return int Returns 0 on success, -1 on failure.
+ */
+static int aggregate(KernelKind kind, int today, uint32_t *counts, int counts_size, LoanSummary *summary) {
+    int num_threads = store->num_threads;
+    if (num_threads > store->count / PARALLEL_MIN_ROWS) {
+        num_threads = store->count / PARALLEL_MIN_ROWS;
+    }
+    if (num_threads < 1) {
+        num_threads = 1;
+    }
+
+    size_t bit_words = (size_t)(store->max_member_id >> 6) + 1;
+    KernelTask *tasks = calloc(num_threads, sizeof(KernelTask));
+    pthread_t *threads = calloc(num_threads, sizeof(pthread_t));
+    int result = -1;
+    if (tasks == NULL || threads == NULL) {
+        fprintf(stderr, "Out of memory\n");
+        goto cleanup;
+    }
+
+    for (int t = 0; t < num_threads; t++) {
+        KernelTask *task = &tasks[t];
+        task->store = store;
+        task->kind = kind;
+        task->today = today;
+        task->begin = (int)((int64_t)store->count * t / num_threads);
+        task->end = (int)((int64_t)store->count * (t + 1) / num_threads);
+
+        /* Thread 0 accumulates straight into the caller's histogram */
+        if (kind == KERNEL_SUMMARY) {
+            task->active_bits = calloc(bit_words, sizeof(uint64_t));
+            task->overdue_bits = calloc(bit_words, sizeof(uint64_t));
+            if (task->active_bits == NULL || task->overdue_bits == NULL) {
+                fprintf(stderr, "Out of memory\n");
+                goto cleanup;
+            }
+        } else {
+            task->counts = t == 0 ? counts : calloc(counts_size, sizeof(uint32_t));
+            if (task->counts == NULL) {
+                fprintf(stderr, "Out of memory\n");
+                goto cleanup;
+            }
+        }
+    }
+
+    int started = 1;
+    for (; started < num_threads; started++) {
+        if (pthread_create(&threads[started], NULL, run_kernel, &tasks[started]) != 0) {
+            break;
+        }
+    }
+    run_kernel(&tasks[0]);
+    for (int t = 1; t < started; t++) {
+        pthread_join(threads[t], NULL);
+    }
+    for (int t = started; t < num_threads; t++) {
+        run_kernel(&tasks[t]);   // thread creation failed: finish inline
+    }
+
+    /* Merge partitions into the first task */
+    for (int t = 1; t < num_threads; t++) {
+        if (kind == KERNEL_SUMMARY) {
+            for (size_t w = 0; w < bit_words; w++) {
+                tasks[0].active_bits[w] |= tasks[t].active_bits[w];
+                tasks[0].overdue_bits[w] |= tasks[t].overdue_bits[w];
+            }
+            tasks[0].summary.active_loans += tasks[t].summary.active_loans;
+            tasks[0].summary.overdue_loans += tasks[t].summary.overdue_loans;
+            tasks[0].summary.overdue_days += tasks[t].summary.overdue_days;
+            if (tasks[t].summary.max_overdue_days > tasks[0].summary.max_overdue_days) {
+                tasks[0].summary.max_overdue_days = tasks[t].summary.max_overdue_days;
+            }
+        } else {
+            for (int i = 0; i < counts_size; i++) {
+                counts[i] += tasks[t].counts[i];
+            }
+        }
+    }
+
+    if (kind == KERNEL_SUMMARY) {
+        *summary = tasks[0].summary;
+        summary->total_loans = store->count;
+        summary->active_members = 0;
+        summary->overdue_members = 0;
+        for (size_t w = 0; w < bit_words; w++) {
+            summary->active_members += __builtin_popcountll(tasks[0].active_bits[w]);
+            summary->overdue_members += __builtin_popcountll(tasks[0].overdue_bits[w]);
+        }
+    }
+    result = 0;
+
+cleanup:
+    if (tasks != NULL) {
+        for (int t = 0; t < num_threads; t++) {
+            if (t > 0) {
+                free(tasks[t].counts);
+            }
+            free(tasks[t].active_bits);
+            free(tasks[t].overdue_bits);
+        }
+    }
+    free(tasks);
+    free(threads);
+    return result;
+}
+
+/**
+ * @brief Order counts by count descending, then ID ascending.
+ */
+static int compare_counts(const void *lhs, const void *rhs) {
+    const AnalyticsCount *a = lhs;
+    const AnalyticsCount *b = rhs;
+    if (a->count != b->count) {
+        return a->count > b->count ? -1 : 1;
+    }
+    return (a->id > b->id) - (a->id < b->id);
+}
+
+int analytics_top_books(AnalyticsCount *results, int limit) {
+    if (store == NULL || results == NULL || limit <= 0) {
+        return -1;
+    }
+
+    int size = store->max_book_id + 1;
+    uint32_t *counts = calloc(size, sizeof(uint32_t));
+    if (counts == NULL) {
+        fprintf(stderr, "Out of memory\n");
+        return -1;
+    }
+    if (aggregate(KERNEL_BOOK_COUNTS, 0, counts, size, NULL) != 0) {
+        free(counts);
+        return -1;
+    }
+
+    /* Keep the best `limit` books in order; most books fail the first comparison */
+    int found = 0;
+    for (int book_id = 1; book_id < size; book_id++) {
+        int count = (int)counts[book_id];
+        if (count == 0 || (found == limit && count <= results[found - 1].count)) {
+            continue;
+        }
+
+        int pos = found < limit ? found++ : limit - 1;
+        while (pos > 0 && results[pos - 1].count < count) {
+            results[pos] = results[pos - 1];
+            pos--;
+        }
+        results[pos].id = book_id;
+        results[pos].count = count;
+    }
+
+    free(counts);
+    return found;
+}
+
+int analytics_genre_counts(AnalyticsCount *results, int max_count) {
+    if (store == NULL || results == NULL || max_count <= 0) {
+        return -1;
+    }
+
+    int size = (int)store->books.genres.count;
+    uint32_t *counts = calloc(size, sizeof(uint32_t));
+    AnalyticsCount *all = malloc(size * sizeof(AnalyticsCount));
+    if (counts == NULL || all == NULL) {
+        fprintf(stderr, "Out of memory\n");
+        free(counts);
+        free(all);
+        return -1;
+    }
+    if (aggregate(KERNEL_GENRE_COUNTS, 0, counts, size, NULL) != 0) {
+        free(counts);
+        free(all);
+        return -1;
+    }
+
+    int found = 0;
+    for (int genre_id = 0; genre_id < size; genre_id++) {
+        if (counts[genre_id] > 0) {
+            all[found].id = genre_id;
+            all[found].count = (int)counts[genre_id];
+            found++;
+        }
+    }
+    qsort(all, found, sizeof(AnalyticsCount), compare_counts);
+    if (found > max_count) {
+        found = max_count;
+    }
+    memcpy(results, all, found * sizeof(AnalyticsCount));
+
+    free(counts);
+    free(all);
+    return found;
+}
+
+int analytics_loan_summary(int today, LoanSummary *summary) {
+    if (store == NULL || summary == NULL) {
+        return -1;
+    }
+    return aggregate(KERNEL_SUMMARY, today, NULL, 0, summary);
+}
+
+int analytics_member_summary(int today, MemberSummary *summary) {
+    if (store == NULL || summary == NULL) {
+        return -1;
+    }
+
+    LoanSummary loans;
+    if (aggregate(KERNEL_SUMMARY, today, NULL, 0, &loans) != 0) {
+        return -1;
+    }
+
+    /* Members are few next to loans: one branch-free pass on this thread */
+    const MemberColumns *m = &store->members;
+    int new_since = today - ANALYTICS_NEW_MEMBER_DAYS;
+    int new_members = 0;
+    int suspended = 0;
+    for (int i = 0; i < m->count; i++) {
+        new_members += m->registration_days[i] > new_since && m->registration_days[i] <= today;
+        suspended += m->suspended_until[i] > today;
+    }
+
+    summary->total_members = m->count;
+    summary->new_members = new_members;
+    summary->suspended_members = suspended;
+    summary->active_members = loans.active_members;
+    summary->overdue_members = loans.overdue_members;
+    return 0;
+}
+
+int analytics_inventory_summary(InventorySummary *summary) {
+    if (store == NULL || summary == NULL) {
+        return -1;
+    }
+
+    int size = store->max_book_id + 1;
+    uint32_t *active = calloc(size, sizeof(uint32_t));
+    if (active == NULL) {
+        fprintf(stderr, "Out of memory\n");
+        return -1;
+    }
+    if (aggregate(KERNEL_ACTIVE_COUNTS, 0, active, size, NULL) != 0) {
+        free(active);
+        return -1;
+    }
+
+    const BookTable *books = &store->books;
+    int copies = 0;
+    int on_loan = 0;
+    int out_of_stock = 0;
+    for (int row = 0; row < books->count; row++) {
+        int loans = (int)active[books->book_ids[row]];
+        copies += books->quantities[row];
+        on_loan += loans;
+        out_of_stock += loans >= books->quantities[row];
+    }
+    free(active);
+
+    summary->titles = books->count;
+    summary->copies = copies;
+    summary->on_loan = on_loan;
+    summary->out_of_stock = out_of_stock;
+    return 0;
+}
+
+const char *analytics_genre_name(int genre_id) {
+    if (store == NULL || genre_id < 0) {
+        return NULL;
+    }
+    return string_pool_get(&store->books.genres, (uint32_t)genre_id);
+}
+
+const char *analytics_book_title(int book_id) {
+    if (store == NULL) {
+        return NULL;
+    }
+    int row = book_table_find(&store->books, book_id);
+    return row >= 0 ? book_table_title(&store->books, row) : NULL;
+}
+
+int display_analytics_report(int today, int limit) {
+    if (store == NULL) {
+        fprintf(stderr, "Analytics not loaded\n");
+        return -1;
+    }
+
+    AnalyticsCount *top = malloc((limit > 0 ? limit : 1) * sizeof(AnalyticsCount));
+    AnalyticsCount genres[20];
+    LoanSummary summary;
+    int top_count = top ? analytics_top_books(top, limit) : -1;
+    int genre_count = analytics_genre_counts(genres, 20);
+    if (top_count < 0 || genre_count < 0 || analytics_loan_summary(today, &summary) != 0) {
+        free(top);
+        return -1;
+    }
+
+    printf("\n========== Popular Books ==========\n");
+    printf("%-8s %-40s %s\n", "Book ID", "Title", "Loan Count");
+    printf("-----------------------------------------------------------\n");
+    for (int i = 0; i < top_count; i++) {
+        const char *title = analytics_book_title(top[i].id);
+        printf("%-8d %-40s %d\n", top[i].id, title ? title : "(deleted)", top[i].count);
+    }
+
+    printf("\n========== Loans by Genre ==========\n");
+    for (int i = 0; i < genre_count; i++) {
+        const char *name = analytics_genre_name(genres[i].id);
+        printf("%-20s %8d (%5.1f%%)\n", name && *name ? name : "(none)", genres[i].count,
+               100.0 * genres[i].count / summary.total_loans);
+    }
+
+    printf("\n========== Loan Status ==========\n");
+    printf("Total loans:     %d\n", summary.total_loans);
+    printf("Active loans:    %d (%d members)\n", summary.active_loans, summary.active_members);
+    printf("Overdue loans:   %d (%d members)\n", summary.overdue_loans, summary.overdue_members);
+    if (summary.overdue_loans > 0) {
+        printf("Overdue days:    avg %.1f, max %d\n",
+               (double)summary.overdue_days / summary.overdue_loans, summary.max_overdue_days);
+    }
+    printf("\n");
+
+    free(top);
+    return 0;
+}
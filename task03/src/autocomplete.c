@@ -0,0 +1,691 @@
+#include "autocomplete.h"
+#include "database.h"
+#include "hangul.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define FIELD_COUNT 3
+
+/**
+ * @brief One value stored under a key (several rows may share a key).
+ */
+typedef struct {
+    int id;        // book_id / member_id, 0 for authors
+    int weight;    // loan count
+    int refs;      // rows holding this value (books by an author)
+    char *text;    // original text, returned as the completion
+} TrieEntry;
+
+/**
+ * @brief Radix trie node; edge labels are runs of key bytes.
+ */
+typedef struct TrieNode {
+    char *label;
+    int label_len;
+    struct TrieNode **children;   // sorted by first label byte
+    int child_count;
+    int child_capacity;
+    TrieEntry *entries;
+    int entry_count;
+    int entry_capacity;
+    int best;                     // highest weight in the subtree, -1 if empty
+} TrieNode;
+
+typedef struct {
+    char *title;
+    char *author;
+    int loans;
+} BookRecord;
+
+typedef struct {
+    char *name;
+    int loans;
+} MemberRecord;
+
+typedef struct {
+    TrieNode *roots[FIELD_COUNT];
+    BookRecord *books;            // by book_id
+    int book_capacity;
+    MemberRecord *members;        // by member_id
+    int member_capacity;
+    int key_count;
+} Autocomplete;
+
+static Autocomplete *ac = NULL;
+
+static TrieNode *new_node(const char *label, int label_len) {
+    TrieNode *node = calloc(1, sizeof(TrieNode));
+    if (node == NULL) {
+        return NULL;
+    }
+    node->label = malloc(label_len + 1);
+    if (node->label == NULL) {
+        free(node);
+        return NULL;
+    }
+    memcpy(node->label, label, label_len);
+    node->label_len = label_len;
+    node->best = -1;
+    return node;
+}
+
+static void free_node(TrieNode *node) {
+    if (node == NULL) {
+        return;
+    }
+    for (int i = 0; i < node->child_count; i++) {
+        free_node(node->children[i]);
+    }
+    for (int i = 0; i < node->entry_count; i++) {
+        free(node->entries[i].text);
+    }
+    free(node->children);
+    free(node->entries);
+    free(node->label);
+    free(node);
+}
+
+/**
+ * @brief Binary search for the child whose label starts with byte c.
+ * 
+ * @return int Returns the child index, or the insert position if absent (with *found = 0).
+ */
+static int find_child(const TrieNode *node, unsigned char c, int *found) {
+    int lo = 0, hi = node->child_count;
+    while (lo < hi) {
+        int mid = lo + (hi - lo) / 2;
+        if ((unsigned char)node->children[mid]->label[0] < c) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    *found = lo < node->child_count && (unsigned char)node->children[lo]->label[0] == c;
+    return lo;
+}
+
+static int insert_child(TrieNode *node, int pos, TrieNode *child) {
+    if (node->child_count == node->child_capacity) {
+        int capacity = node->child_capacity ? node->child_capacity * 2 : 2;
+        TrieNode **children = realloc(node->children, capacity * sizeof(TrieNode *));
+        if (children == NULL) {
+            return -1;
+        }
+        node->children = children;
+        node->child_capacity = capacity;
+    }
+    memmove(&node->children[pos + 1], &node->children[pos],
+            (node->child_count - pos) * sizeof(TrieNode *));
+    node->children[pos] = child;
+    node->child_count++;
+    return 0;
+}
+
+/**
+ * @brief Walk (and optionally build) the path to a key.
+ * 
+ * @param path Receives root..target; must hold len + 1 nodes.
+ * @return int Returns path length, -1 if the key is absent (or on allocation failure).
+ */
+static int find_path(TrieNode *root, const char *key, int len, TrieNode **path, int create) {
+    int depth = 0;
+    TrieNode *node = root;
+    path[depth++] = node;
+
+    while (len > 0) {
+        int found;
+        int pos = find_child(node, (unsigned char)key[0], &found);
+
+        if (!found) {
+            if (!create) {
+                return -1;
+            }
+            TrieNode *child = new_node(key, len);
+            if (child == NULL || insert_child(node, pos, child) != 0) {
+                free_node(child);
+                return -1;
+            }
+            path[depth++] = child;
+            return depth;
+        }
+
+        TrieNode *child = node->children[pos];
+        int common = 0;
+        while (common < child->label_len && common < len && child->label[common] == key[common]) {
+            common++;
+        }
+
+        if (common < child->label_len) {
+            if (!create) {
+                return -1;
+            }
+            /* Split the edge: a new node takes the shared part of the label */
+            TrieNode *mid = new_node(child->label, common);
+            if (mid == NULL || insert_child(mid, 0, child) != 0) {
+                free_node(mid);
+                return -1;
+            }
+            memmove(child->label, child->label + common, child->label_len - common);
+            child->label_len -= common;
+            mid->best = child->best;
+            node->children[pos] = mid;
+            child = mid;
+        }
+
+        node = child;
+        path[depth++] = node;
+        key += common;
+        len -= common;
+    }
+
+    return depth;
+}
+
+static void recompute_best(TrieNode *node) {
+    int best = -1;
+    for (int i = 0; i < node->entry_count; i++) {
+        if (node->entries[i].weight > best) {
+            best = node->entries[i].weight;
+        }
+    }
+    for (int i = 0; i < node->child_count; i++) {
+        if (node->children[i]->best > best) {
+            best = node->children[i]->best;
+        }
+    }
+    node->best = best;
+}
+
+/**
+ * @brief Refresh subtree maxima along a path and prune nodes left empty.
+ */
+static void fix_path(TrieNode **path, int depth) {
+    for (int i = depth - 1; i >= 0; i--) {
+        TrieNode *node = path[i];
+        if (i > 0 && node->entry_count == 0 && node->child_count == 0) {
+            TrieNode *parent = path[i - 1];
+            int found;
+            int pos = find_child(parent, (unsigned char)node->label[0], &found);
+            memmove(&parent->children[pos], &parent->children[pos + 1],
+                    (parent->child_count - pos - 1) * sizeof(TrieNode *));
+            parent->child_count--;
+            free_node(node);
+            continue;
+        }
+        recompute_best(node);
+    }
+}
+
+/**
+ * @brief Change the weight and reference count of one value in a trie.
+ * 
+ * A value is created when ref_delta is positive and dropped when its
+ * reference count reaches zero. Authors (id 0) are matched by text.
+ */
+static int trie_adjust(TrieNode *root, const char *text, int id, int weight_delta, int ref_delta) {
+    char key[HANGUL_KEY_LEN];
+    int len = hangul_jamo_key(text, key, sizeof(key));
+    if (len == 0) {
+        return 0;
+    }
+
+    TrieNode *path[HANGUL_KEY_LEN + 1];
+    int depth = find_path(root, key, len, path, ref_delta > 0);
+    if (depth < 0) {
+        return ref_delta > 0 ? -1 : 0;
+    }
+    TrieNode *node = path[depth - 1];
+
+    int i = 0;
+    while (i < node->entry_count &&
+           !(node->entries[i].id == id && (id != 0 || strcmp(node->entries[i].text, text) == 0))) {
+        i++;
+    }
+
+    if (i == node->entry_count) {
+        if (ref_delta <= 0) {
+            fix_path(path, depth);
+            return 0;
+        }
+        if (node->entry_count == node->entry_capacity) {
+            int capacity = node->entry_capacity ? node->entry_capacity * 2 : 1;
+            TrieEntry *entries = realloc(node->entries, capacity * sizeof(TrieEntry));
+            if (entries == NULL) {
+                fix_path(path, depth);
+                return -1;
+            }
+            node->entries = entries;
+            node->entry_capacity = capacity;
+        }
+        TrieEntry *entry = &node->entries[node->entry_count];
+        entry->text = strdup(text);
+        if (entry->text == NULL) {
+            fix_path(path, depth);
+            return -1;
+        }
+        entry->id = id;
+        entry->weight = 0;
+        entry->refs = 0;
+        node->entry_count++;
+        ac->key_count++;
+    }
+
+    TrieEntry *entry = &node->entries[i];
+    entry->weight += weight_delta;
+    entry->refs += ref_delta;
+    if (entry->refs <= 0) {
+        free(entry->text);
+        node->entries[i] = node->entries[--node->entry_count];
+        ac->key_count--;
+    }
+
+    fix_path(path, depth);
+    return 0;
+}
+
+static int grow_records(void **records, int *capacity, size_t record_size, int id) {
+    int new_capacity = *capacity ? *capacity : 1024;
+    while (new_capacity <= id) {
+        new_capacity *= 2;
+    }
+    char *grown = realloc(*records, new_capacity * record_size);
+    if (grown == NULL) {
+        return -1;
+    }
+    memset(grown + *capacity * record_size, 0, (new_capacity - *capacity) * record_size);
+    *records = grown;
+    *capacity = new_capacity;
+    return 0;
+}
+
+static void unset_book(int book_id) {
+    if (book_id <= 0 || book_id >= ac->book_capacity || ac->books[book_id].title == NULL) {
+        return;
+    }
+    BookRecord *book = &ac->books[book_id];
+    trie_adjust(ac->roots[AUTOCOMPLETE_TITLE], book->title, book_id, -book->loans, -1);
+    trie_adjust(ac->roots[AUTOCOMPLETE_AUTHOR], book->author, 0, -book->loans, -1);
+    free(book->title);
+    free(book->author);
+    book->title = NULL;
+    book->author = NULL;
+}
+
+static int set_book(int book_id, const char *title, const char *author, int loans) {
+    if (book_id <= 0) {
+        return -1;
+    }
+    if (book_id >= ac->book_capacity &&
+        grow_records((void **)&ac->books, &ac->book_capacity, sizeof(BookRecord), book_id) != 0) {
+        return -1;
+    }
+
+    unset_book(book_id);
+
+    BookRecord *book = &ac->books[book_id];
+    book->title = strdup(title ? title : "");
+    book->author = strdup(author ? author : "");
+    book->loans = loans;
+    if (book->title == NULL || book->author == NULL) {
+        free(book->title);
+        free(book->author);
+        book->title = NULL;
+        book->author = NULL;
+        return -1;
+    }
+
+    if (trie_adjust(ac->roots[AUTOCOMPLETE_TITLE], book->title, book_id, loans, 1) != 0 ||
+        trie_adjust(ac->roots[AUTOCOMPLETE_AUTHOR], book->author, 0, loans, 1) != 0) {
+        return -1;
+    }
+    return 0;
+}
+
+static void unset_member(int member_id) {
+    if (member_id <= 0 || member_id >= ac->member_capacity || ac->members[member_id].name == NULL) {
+        return;
+    }
+    MemberRecord *member = &ac->members[member_id];
+    trie_adjust(ac->roots[AUTOCOMPLETE_MEMBER], member->name, member_id, -member->loans, -1);
+    free(member->name);
+    member->name = NULL;
+}
+
+static int set_member(int member_id, const char *name, int loans) {
+    if (member_id <= 0) {
+        return -1;
+    }
+    if (member_id >= ac->member_capacity &&
+        grow_records((void **)&ac->members, &ac->member_capacity, sizeof(MemberRecord), member_id) != 0) {
+        return -1;
+    }
+
+    unset_member(member_id);
+
+    MemberRecord *member = &ac->members[member_id];
+    member->name = strdup(name ? name : "");
+    member->loans = loans;
+    if (member->name == NULL) {
+        return -1;
+    }
+    return trie_adjust(ac->roots[AUTOCOMPLETE_MEMBER], member->name, member_id, loans, 1);
+}
+
+static void destroy_autocomplete(Autocomplete *index) {
+    if (index == NULL) {
+        return;
+    }
+    for (int i = 0; i < FIELD_COUNT; i++) {
+        free_node(index->roots[i]);
+    }
+    for (int i = 0; i < index->book_capacity; i++) {
+        free(index->books[i].title);
+        free(index->books[i].author);
+    }
+    for (int i = 0; i < index->member_capacity; i++) {
+        free(index->members[i].name);
+    }
+    free(index->books);
+    free(index->members);
+    free(index);
+}
+
+int load_autocomplete(sqlite3 *db) {
+    if (db == NULL) {
+        fprintf(stderr, "Database connection is NULL\n");
+        return -1;
+    }
+
+    Autocomplete *previous = ac;
+    ac = calloc(1, sizeof(Autocomplete));
+    if (ac == NULL) {
+        ac = previous;
+        return -1;
+    }
+    for (int i = 0; i < FIELD_COUNT; i++) {
+        ac->roots[i] = new_node("", 0);
+    }
+
+    const char *book_sql = "SELECT b.book_id, b.title, b.author, COUNT(l.loan_id) "
+                           "FROM Books b LEFT JOIN Loans l ON l.book_id = b.book_id "
+                           "GROUP BY b.book_id;";
+    const char *member_sql = "SELECT m.member_id, m.name, COUNT(l.loan_id) "
+                             "FROM Members m LEFT JOIN Loans l ON l.member_id = m.member_id "
+                             "GROUP BY m.member_id;";
+
+    int failed = ac->roots[0] == NULL || ac->roots[1] == NULL || ac->roots[2] == NULL;
+    sqlite3_stmt *stmt;
+
+    if (!failed && sqlite3_prepare_v2(db, book_sql, -1, &stmt, NULL) == SQLITE_OK) {
+        int rc;
+        while (!failed && (rc = sqlite3_step(stmt)) == SQLITE_ROW) {
+            failed = set_book(sqlite3_column_int(stmt, 0),
+                              (const char *)sqlite3_column_text(stmt, 1),
+                              (const char *)sqlite3_column_text(stmt, 2),
+                              sqlite3_column_int(stmt, 3)) != 0;
+        }
+        failed = failed || rc != SQLITE_DONE;
+        sqlite3_finalize(stmt);
+    } else {
+        fprintf(stderr, "Failed to prepare statement: %s\n", sqlite3_errmsg(db));
+        failed = 1;
+    }
+
+    if (!failed && sqlite3_prepare_v2(db, member_sql, -1, &stmt, NULL) == SQLITE_OK) {
+        int rc;
+        while (!failed && (rc = sqlite3_step(stmt)) == SQLITE_ROW) {
+            failed = set_member(sqlite3_column_int(stmt, 0),
+                                (const char *)sqlite3_column_text(stmt, 1),
+                                sqlite3_column_int(stmt, 2)) != 0;
+        }
+        failed = failed || rc != SQLITE_DONE;
+        sqlite3_finalize(stmt);
+    } else if (!failed) {
+        fprintf(stderr, "Failed to prepare statement: %s\n", sqlite3_errmsg(db));
+        failed = 1;
+    }
+
+    if (failed) {
+        fprintf(stderr, "Failed to build autocomplete index\n");
+        destroy_autocomplete(ac);
+        ac = previous;
+        return -1;
+    }
+
+    destroy_autocomplete(previous);
+    return ac->key_count;
+}
+
+void free_autocomplete(void) {
+    destroy_autocomplete(ac);
+    ac = NULL;
+}
+
+/**
+ * @brief Best-first search item: a subtree (entry == NULL) or a single value.
+ */
+typedef struct {
+    int priority;
+    const TrieNode *node;
+    const TrieEntry *entry;
+} HeapItem;
+
+typedef struct {
+    HeapItem *items;
+    int count;
+    int capacity;
+} Heap;
+
+/* Values outrank subtrees of equal weight so they are emitted first */
+static int heap_before(const HeapItem *a, const HeapItem *b) {
+    if (a->priority != b->priority) {
+        return a->priority > b->priority;
+    }
+    return a->entry != NULL && b->entry == NULL;
+}
+
+static int heap_push(Heap *heap, HeapItem item) {
+    if (heap->count == heap->capacity) {
+        int capacity = heap->capacity ? heap->capacity * 2 : 64;
+        HeapItem *items = realloc(heap->items, capacity * sizeof(HeapItem));
+        if (items == NULL) {
+            return -1;
+        }
+        heap->items = items;
+        heap->capacity = capacity;
+    }
+    int i = heap->count++;
+    while (i > 0 && heap_before(&item, &heap->items[(i - 1) / 2])) {
+        heap->items[i] = heap->items[(i - 1) / 2];
+        i = (i - 1) / 2;
+    }
+    heap->items[i] = item;
+    return 0;
+}
+
+static HeapItem heap_pop(Heap *heap) {
+    HeapItem top = heap->items[0];
+    HeapItem last = heap->items[--heap->count];
+    int i = 0;
+    for (;;) {
+        int child = 2 * i + 1;
+        if (child >= heap->count) {
+            break;
+        }
+        if (child + 1 < heap->count && heap_before(&heap->items[child + 1], &heap->items[child])) {
+            child++;
+        }
+        if (!heap_before(&heap->items[child], &last)) {
+            break;
+        }
+        heap->items[i] = heap->items[child];
+        i = child;
+    }
+    if (heap->count > 0) {
+        heap->items[i] = last;
+    }
+    return top;
+}
+
+int autocomplete(int field, const char *prefix, Completion *results, int max_count) {
+    if (field < 0 || field >= FIELD_COUNT || prefix == NULL || results == NULL || max_count <= 0) {
+        fprintf(stderr, "Invalid parameters\n");
+        return -1;
+    }
+    if (ac == NULL && load_autocomplete(get_db_connection()) < 0) {
+        return -1;
+    }
+
+    char key[HANGUL_KEY_LEN];
+    int len = hangul_jamo_key(prefix, key, sizeof(key));
+
+    /* Descend to the subtree holding every key that starts with the prefix */
+    const TrieNode *node = ac->roots[field];
+    const char *rest = key;
+    while (len > 0) {
+        int found;
+        int pos = find_child(node, (unsigned char)rest[0], &found);
+        if (!found) {
+            return 0;
+        }
+        const TrieNode *child = node->children[pos];
+        int n = child->label_len < len ? child->label_len : len;
+        if (memcmp(child->label, rest, n) != 0) {
+            return 0;
+        }
+        node = child;
+        rest += n;
+        len -= n;
+    }
+
+    if (node->best < 0) {
+        return 0;
+    }
+
+    /* Best-first: expand subtrees in order of their highest weight */
+    Heap heap = {NULL, 0, 0};
+    int count = 0;
+    HeapItem start = {node->best, node, NULL};
+    int failed = heap_push(&heap, start) != 0;
+
+    while (!failed && heap.count > 0 && count < max_count) {
+        HeapItem item = heap_pop(&heap);
+
+        if (item.entry != NULL) {
+            results[count].id = item.entry->id;
+            results[count].loans = item.entry->weight;
+            strncpy(results[count].text, item.entry->text, AUTOCOMPLETE_TEXT_LEN - 1);
+            results[count].text[AUTOCOMPLETE_TEXT_LEN - 1] = '\0';
+            count++;
+            continue;
+        }
+
+        for (int i = 0; i < item.node->entry_count && !failed; i++) {
+            HeapItem value = {item.node->entries[i].weight, NULL, &item.node->entries[i]};
+            failed = heap_push(&heap, value) != 0;
+        }
+        for (int i = 0; i < item.node->child_count && !failed; i++) {
+            const TrieNode *child = item.node->children[i];
+            if (child->best >= 0) {
+                HeapItem subtree = {child->best, child, NULL};
+                failed = heap_push(&heap, subtree) != 0;
+            }
+        }
+    }
+
+    free(heap.items);
+    return failed ? -1 : count;
+}
+
+int autocomplete_refresh_book(sqlite3 *db, int book_id) {
+    if (ac == NULL) {
+        return 0;
+    }
+
+    sqlite3_stmt *stmt;
+    if (sqlite3_prepare_v2(db, "SELECT title, author FROM Books WHERE book_id = ?;", -1, &stmt, NULL) != SQLITE_OK) {
+        fprintf(stderr, "Failed to prepare statement: %s\n", sqlite3_errmsg(db));
+        return -1;
+    }
+    sqlite3_bind_int(stmt, 1, book_id);
+
+    int result = 0;
+    int rc = sqlite3_step(stmt);
+    if (rc == SQLITE_ROW) {
+        int loans = book_id < ac->book_capacity ? ac->books[book_id].loans : 0;
+        result = set_book(book_id, (const char *)sqlite3_column_text(stmt, 0),
+                          (const char *)sqlite3_column_text(stmt, 1), loans);
+    } else if (rc == SQLITE_DONE) {
+        unset_book(book_id);
+    } else {
+        result = -1;
+    }
+    sqlite3_finalize(stmt);
+
+    if (result != 0) {
+        free_autocomplete();   // rebuilt on next use
+    }
+    return result;
+}
+
+void autocomplete_remove_book(int book_id) {
+    if (ac != NULL) {
+        unset_book(book_id);
+    }
+}
+
+int autocomplete_refresh_member(sqlite3 *db, int member_id) {
+    if (ac == NULL) {
+        return 0;
+    }
+
+    sqlite3_stmt *stmt;
+    if (sqlite3_prepare_v2(db, "SELECT name FROM Members WHERE member_id = ?;", -1, &stmt, NULL) != SQLITE_OK) {
+        fprintf(stderr, "Failed to prepare statement: %s\n", sqlite3_errmsg(db));
+        return -1;
+    }
+    sqlite3_bind_int(stmt, 1, member_id);
+
+    int result = 0;
+    int rc = sqlite3_step(stmt);
+    if (rc == SQLITE_ROW) {
+        int loans = member_id < ac->member_capacity ? ac->members[member_id].loans : 0;
+        result = set_member(member_id, (const char *)sqlite3_column_text(stmt, 0), loans);
+    } else if (rc == SQLITE_DONE) {
+        unset_member(member_id);
+    } else {
+        result = -1;
+    }
+    sqlite3_finalize(stmt);
+
+    if (result != 0) {
+        free_autocomplete();
+    }
+    return result;
+}
+
+void autocomplete_remove_member(int member_id) {
+    if (ac != NULL) {
+        unset_member(member_id);
+    }
+}
+
+void autocomplete_record_loan(int book_id, int member_id) {
+    if (ac == NULL) {
+        return;
+    }
+
+    if (book_id > 0 && book_id < ac->book_capacity && ac->books[book_id].title != NULL) {
+        BookRecord *book = &ac->books[book_id];
+        book->loans++;
+        trie_adjust(ac->roots[AUTOCOMPLETE_TITLE], book->title, book_id, 1, 0);
+        trie_adjust(ac->roots[AUTOCOMPLETE_AUTHOR], book->author, 0, 1, 0);
+    }
+
+    if (member_id > 0 && member_id < ac->member_capacity && ac->members[member_id].name != NULL) {
+        MemberRecord *member = &ac->members[member_id];
+        member->loans++;
+        trie_adjust(ac->roots[AUTOCOMPLETE_MEMBER], member->name, member_id, 1, 0);
+    }
+}
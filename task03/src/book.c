@@ -1,5 +1,11 @@
 #include "book.h"
 #include "database.h"
+#include "trigram.h"
+#include "hangul.h"
+#include "autocomplete.h"
+#include "isbn.h"
+#include "table.h"
+#include "result_cache.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -29,8 +35,21 @@ int add_book(const char *title, const char *author, const char *publisher,
         return -1;
     }
     
-    const char *sql = "INSERT INTO Books (title, author, publisher, publication_year, isbn, genre, quantity, available) "
-                      "VALUES (?, ?, ?, ?, ?, ?, ?, ?);";
+    /* Different spellings of one ISBN (hyphens, ISBN-10/13) share a key */
+    int64_t isbn_key = isbn_parse(isbn);
+    if (isbn_key != ISBN_INVALID) {
+        int existing = find_book_by_isbn(isbn);
+        if (existing != 0) {
+            if (existing > 0) {
+                fprintf(stderr, "Book with the same ISBN already exists (ID: %d)\n", existing);
+            }
+            return -1;
+        }
+    }
+    
+    const char *sql = "INSERT INTO Books (title, author, publisher, publication_year, isbn, genre, quantity, available, "
+                      "title_chosung, title_jamo, author_chosung, author_jamo, isbn13) "
+                      "VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?);";
     
     sqlite3_stmt *stmt;
     int rc = sqlite3_prepare_v2(db, sql, -1, &stmt, NULL);
@@ -50,6 +69,19 @@ int add_book(const char *title, const char *author, const char *publisher,
     sqlite3_bind_int(stmt, 7, quantity);
     sqlite3_bind_int(stmt, 8, quantity);
     
+    /* Hangul search keys */
+    char title_chosung[HANGUL_KEY_LEN], title_jamo[HANGUL_KEY_LEN];
+    char author_chosung[HANGUL_KEY_LEN], author_jamo[HANGUL_KEY_LEN];
+    hangul_chosung_key(title, title_chosung, sizeof(title_chosung));
+    hangul_jamo_key(title, title_jamo, sizeof(title_jamo));
+    hangul_chosung_key(author, author_chosung, sizeof(author_chosung));
+    hangul_jamo_key(author, author_jamo, sizeof(author_jamo));
+    sqlite3_bind_text(stmt, 9, title_chosung, -1, SQLITE_STATIC);
+    sqlite3_bind_text(stmt, 10, title_jamo, -1, SQLITE_STATIC);
+    sqlite3_bind_text(stmt, 11, author_chosung, -1, SQLITE_STATIC);
+    sqlite3_bind_text(stmt, 12, author_jamo, -1, SQLITE_STATIC);
+    sqlite3_bind_int64(stmt, 13, isbn_key);
+    
     rc = sqlite3_step(stmt);
     sqlite3_finalize(stmt);
     
@@ -58,10 +90,66 @@ int add_book(const char *title, const char *author, const char *publisher,
         return -1;
     }
     
-    printf("Book added successfully (ID: %lld)\n", sqlite3_last_insert_rowid(db));
+    trigram_refresh_book(db, (int)sqlite3_last_insert_rowid(db));
+    autocomplete_refresh_book(db, (int)sqlite3_last_insert_rowid(db));
+    
+    if (!is_quiet_mode()) {
+        printf("Book added successfully (ID: %lld)\n", sqlite3_last_insert_rowid(db));
+    }
     return 0;
 }
 
+/* Columns of the book listings, in the order they are selected */
+static const TableColumn book_list_columns[] = {
+    {"ID", 5}, {"Title", 30}, {"Author", 20}, {"Publisher", 20}, {"Year", 6},
+    {"ISBN", 15}, {"Genre", 15}, {"Quantity", 8}, {"Available", 0}
+};
+
+/**
+ * @brief Write the books selected by a statement as a table in the current format.
+ * 
+ * The statement selects book_id, title, author, publisher, publication_year,
+ * isbn, genre, quantity and available, and is finalized here.
+ * 
+ * @param db SQLite database connection.
+ * @param stmt The prepared and bound statement.
+ * @param title Title printed above an aligned table.
+ * @param footer Footer printed below an aligned table, with %d for the count.
+ * @return int Returns number of books written, -1 on failure.
+ */
+static int write_book_list(sqlite3 *db, sqlite3_stmt *stmt, const char *title, const char *footer) {
+    Table table;
+    table_begin(&table, stdout, title, book_list_columns,
+                (int)(sizeof(book_list_columns) / sizeof(book_list_columns[0])));
+    
+    // Repeated listings between writes are replayed from the result cache, if loaded
+    ResultCursor cursor;
+    result_cursor_open(&cursor, stmt);
+    int rc;
+    while ((rc = result_cursor_step(&cursor)) == SQLITE_ROW) {
+        table_int(&table, result_cursor_int(&cursor, 0));
+        table_text(&table, result_cursor_text(&cursor, 1));
+        table_text(&table, result_cursor_text(&cursor, 2));
+        table_text(&table, result_cursor_text(&cursor, 3));
+        table_int(&table, result_cursor_int(&cursor, 4));
+        table_text(&table, result_cursor_text(&cursor, 5));
+        table_text(&table, result_cursor_text(&cursor, 6));
+        table_int(&table, result_cursor_int(&cursor, 7));
+        table_int(&table, result_cursor_int(&cursor, 8));
+    }
+    
+    result_cursor_close(&cursor);
+    sqlite3_finalize(stmt);
+    
+    if (rc != SQLITE_DONE) {
+        table_end(&table, NULL);
+        fprintf(stderr, "Error during query execution: %s\n", sqlite3_errmsg(db));
+        return -1;
+    }
+    
+    return table_end(&table, footer, table.rows);
+}
+
 /**
  * @brief Search for books by keyword (title, author, or ISBN).
  * 
@@ -80,9 +168,31 @@ int search_book(const char *keyword) {
         return -1;
     }
     
-    const char *sql = "SELECT book_id, title, author, publisher, publication_year, isbn, genre, quantity, available "
-                      "FROM Books "
-                      "WHERE title LIKE ? OR author LIKE ? OR isbn LIKE ?;";
+    /* A valid ISBN in any spelling is an exact lookup on the ISBN key index */
+    int64_t isbn_key = isbn_parse(keyword);
+    
+    /* Chosung ("ㅎㄱㅅ") and partly typed ("한ㄱ") queries use a prefix range on the key indexes */
+    int kind = hangul_query_kind(keyword);
+    const char *sql;
+    if (isbn_key != ISBN_INVALID) {
+        sql = "SELECT book_id, title, author, publisher, publication_year, isbn, genre, quantity, available "
+              "FROM Books "
+              "WHERE isbn13 = ?;";
+    } else if (kind == HANGUL_QUERY_CHOSUNG) {
+        sql = "SELECT book_id, title, author, publisher, publication_year, isbn, genre, quantity, available "
+              "FROM Books "
+              "WHERE (title_chosung >= ?1 AND title_chosung < ?2) "
+              "OR (author_chosung >= ?1 AND author_chosung < ?2);";
+    } else if (kind == HANGUL_QUERY_JAMO) {
+        sql = "SELECT book_id, title, author, publisher, publication_year, isbn, genre, quantity, available "
+              "FROM Books "
+              "WHERE (title_jamo >= ?1 AND title_jamo < ?2) "
+              "OR (author_jamo >= ?1 AND author_jamo < ?2);";
+    } else {
+        sql = "SELECT book_id, title, author, publisher, publication_year, isbn, genre, quantity, available "
+              "FROM Books "
+              "WHERE title LIKE ? OR author LIKE ? OR isbn LIKE ?;";
+    }
     
     sqlite3_stmt *stmt;
     int rc = sqlite3_prepare_v2(db, sql, -1, &stmt, NULL);
@@ -92,45 +202,31 @@ int search_book(const char *keyword) {
         return -1;
     }
     
-    /* Create search pattern */
-    char pattern[256];
-    snprintf(pattern, sizeof(pattern), "%%%s%%", keyword);
-    
-    sqlite3_bind_text(stmt, 1, pattern, -1, SQLITE_TRANSIENT);
-    sqlite3_bind_text(stmt, 2, pattern, -1, SQLITE_TRANSIENT);
-    sqlite3_bind_text(stmt, 3, pattern, -1, SQLITE_TRANSIENT);
-    
-    printf("\n=== Search Results ===\n");
-    printf("%-5s %-30s %-20s %-20s %-6s %-15s %-15s %-8s %-8s\n",
-           "ID", "Title", "Author", "Publisher", "Year", "ISBN", "Genre", "Quantity", "Available");
-    printf("---------------------------------------------------------------------------------------------------------------------------\n");
-    
-    int count = 0;
-    while ((rc = sqlite3_step(stmt)) == SQLITE_ROW) {
-        int book_id = sqlite3_column_int(stmt, 0);
-        const unsigned char *title = sqlite3_column_text(stmt, 1);
-        const unsigned char *author = sqlite3_column_text(stmt, 2);
-        const unsigned char *publisher = sqlite3_column_text(stmt, 3);
-        int year = sqlite3_column_int(stmt, 4);
-        const unsigned char *isbn = sqlite3_column_text(stmt, 5);
-        const unsigned char *genre = sqlite3_column_text(stmt, 6);
-        int quantity = sqlite3_column_int(stmt, 7);
-        int available = sqlite3_column_int(stmt, 8);
+    if (isbn_key != ISBN_INVALID) {
+        sqlite3_bind_int64(stmt, 1, isbn_key);
+    } else if (kind == HANGUL_QUERY_PLAIN) {
+        /* Create search pattern */
+        char pattern[256];
+        snprintf(pattern, sizeof(pattern), "%%%s%%", keyword);
         
-        printf("%-5d %-30s %-20s %-20s %-6d %-15s %-15s %-8d %-8d\n",
-               book_id, title, author, publisher, year, isbn, genre, quantity, available);
-        count++;
-    }
-    
-    sqlite3_finalize(stmt);
-    
-    if (rc != SQLITE_DONE) {
-        fprintf(stderr, "Error during query execution: %s\n", sqlite3_errmsg(db));
-        return -1;
+        sqlite3_bind_text(stmt, 1, pattern, -1, SQLITE_TRANSIENT);
+        sqlite3_bind_text(stmt, 2, pattern, -1, SQLITE_TRANSIENT);
+        sqlite3_bind_text(stmt, 3, pattern, -1, SQLITE_TRANSIENT);
+    } else {
+        char key[HANGUL_KEY_LEN];
+        char key_end[HANGUL_KEY_LEN + 1];
+        if (kind == HANGUL_QUERY_CHOSUNG) {
+            hangul_chosung_key(keyword, key, sizeof(key));
+        } else {
+            hangul_jamo_key(keyword, key, sizeof(key));
+        }
+        hangul_prefix_end(key, key_end);
+        
+        sqlite3_bind_text(stmt, 1, key, -1, SQLITE_TRANSIENT);
+        sqlite3_bind_text(stmt, 2, key_end, -1, SQLITE_TRANSIENT);
     }
     
-    printf("\nTotal books found: %d\n", count);
-    return count;
+    return write_book_list(db, stmt, "\n=== Search Results ===\n", "\nTotal books found: %d\n");
 }
 
 /**
@@ -196,9 +292,102 @@ int get_book_by_id(int book_id, Book *book) {
     }
 }
 
+/**
+ * @brief Find a book by ISBN, accepting any ISBN-10 or ISBN-13 spelling.
+ * 
+ * @param isbn The ISBN text (hyphens and spaces are ignored).
+ * @return int Returns the book ID, 0 if no book has this ISBN, -1 if the ISBN is invalid or on failure.
+ */
+int find_book_by_isbn(const char *isbn) {
+    sqlite3 *db = get_db_connection();
+    if (db == NULL) {
+        fprintf(stderr, "Database not initialized\n");
+        return -1;
+    }
+    
+    int64_t isbn_key = isbn_parse(isbn);
+    if (isbn_key == ISBN_INVALID) {
+        fprintf(stderr, "Invalid ISBN: %s\n", isbn ? isbn : "(null)");
+        return -1;
+    }
+    
+    const char *sql = "SELECT book_id FROM Books WHERE isbn13 = ?;";
+    
+    sqlite3_stmt *stmt;
+    int rc = sqlite3_prepare_v2(db, sql, -1, &stmt, NULL);
+    
+    if (rc != SQLITE_OK) {
+        fprintf(stderr, "Failed to prepare statement: %s\n", sqlite3_errmsg(db));
+        return -1;
+    }
+    
+    sqlite3_bind_int64(stmt, 1, isbn_key);
+    
+    int book_id = 0;
+    rc = sqlite3_step(stmt);
+    if (rc == SQLITE_ROW) {
+        book_id = sqlite3_column_int(stmt, 0);
+    } else if (rc != SQLITE_DONE) {
+        fprintf(stderr, "Error during query execution: %s\n", sqlite3_errmsg(db));
+        book_id = -1;
+    }
+    
+    sqlite3_finalize(stmt);
+    return book_id;
+}
+
+/* update_book() field mask bits, in SET clause order */
+enum {
+    BOOK_FIELD_TITLE = 1 << 0,
+    BOOK_FIELD_AUTHOR = 1 << 1,
+    BOOK_FIELD_PUBLISHER = 1 << 2,
+    BOOK_FIELD_YEAR = 1 << 3,
+    BOOK_FIELD_GENRE = 1 << 4
+};
+
+#define BOOK_FIELD_COUNT 5   // 2^5 = 32 cached UPDATE variants
+
+static const char *book_field_assignments[BOOK_FIELD_COUNT] = {
+    "title = ?, title_chosung = ?, title_jamo = ?",
+    "author = ?, author_chosung = ?, author_jamo = ?",
+    "publisher = ?",
+    "publication_year = ?",
+    "genre = ?"
+};
+
+/**
+ * @brief Get the UPDATE statement for a field mask, preparing it on first use.
+ * 
+ * @param db SQLite database connection.
+ * @param mask Non-zero combination of BOOK_FIELD_* bits.
+ * @return sqlite3_stmt* Returns the cached statement, or NULL on failure.
+ */
+static sqlite3_stmt *get_update_book_statement(sqlite3 *db, int mask) {
+    sqlite3_stmt *stmt = find_cached_statement(db, STMT_SLOT_UPDATE_BOOK + mask);
+    if (stmt != NULL) {
+        return stmt;
+    }
+    
+    char sql[MAX_QUERY_LENGTH];
+    size_t len = (size_t)snprintf(sql, sizeof(sql), "UPDATE Books SET ");
+    const char *separator = "";
+    for (int i = 0; i < BOOK_FIELD_COUNT; i++) {
+        if (mask & (1 << i)) {
+            len += (size_t)snprintf(sql + len, sizeof(sql) - len, "%s%s", separator, book_field_assignments[i]);
+            separator = ", ";
+        }
+    }
+    snprintf(sql + len, sizeof(sql) - len, " WHERE book_id = ?;");
+    
+    return prepare_cached_statement(db, STMT_SLOT_UPDATE_BOOK + mask, sql);
+}
+
 /**
  * @brief Update book information.
  * 
+ * Each combination of changed fields has its own cached statement, so
+ * repeated updates do not re-prepare SQL.
+ * 
  * @param book_id The ID of the book to update.
  * @param title The new title (NULL to keep unchanged).
  * @param author The new author (NULL to keep unchanged).
@@ -215,69 +404,70 @@ int update_book(int book_id, const char *title, const char *author,
         return -1;
     }
     
-    char sql[1024] = "UPDATE Books SET ";
-    char updates[512] = "";
-    int first = 1;
-    
-    if (title != NULL) {
-        strcat(updates, first ? "title = ?" : ", title = ?");
-        first = 0;
-    }
-    if (author != NULL) {
-        strcat(updates, first ? "author = ?" : ", author = ?");
-        first = 0;
-    }
-    if (publisher != NULL) {
-        strcat(updates, first ? "publisher = ?" : ", publisher = ?");
-        first = 0;
-    }
-    if (publication_year > 0) {
-        strcat(updates, first ? "publication_year = ?" : ", publication_year = ?");
-        first = 0;
-    }
-    if (genre != NULL) {
-        strcat(updates, first ? "genre = ?" : ", genre = ?");
-        first = 0;
-    }
+    int mask = (title != NULL ? BOOK_FIELD_TITLE : 0)
+             | (author != NULL ? BOOK_FIELD_AUTHOR : 0)
+             | (publisher != NULL ? BOOK_FIELD_PUBLISHER : 0)
+             | (publication_year > 0 ? BOOK_FIELD_YEAR : 0)
+             | (genre != NULL ? BOOK_FIELD_GENRE : 0);
     
-    if (first) {
+    if (mask == 0) {
         fprintf(stderr, "No fields to update\n");
         return -1;
     }
     
-    strcat(sql, updates);
-    strcat(sql, " WHERE book_id = ?;");
-    
-    sqlite3_stmt *stmt;
-    int rc = sqlite3_prepare_v2(db, sql, -1, &stmt, NULL);
-    
-    if (rc != SQLITE_OK) {
-        fprintf(stderr, "Failed to prepare statement: %s\n", sqlite3_errmsg(db));
+    sqlite3_stmt *stmt = get_update_book_statement(db, mask);
+    if (stmt == NULL) {
         return -1;
     }
     
+    char title_chosung[HANGUL_KEY_LEN], title_jamo[HANGUL_KEY_LEN];
+    char author_chosung[HANGUL_KEY_LEN], author_jamo[HANGUL_KEY_LEN];
+    
     int param_index = 1;
-    if (title != NULL) sqlite3_bind_text(stmt, param_index++, title, -1, SQLITE_STATIC);
-    if (author != NULL) sqlite3_bind_text(stmt, param_index++, author, -1, SQLITE_STATIC);
+    if (title != NULL) {
+        hangul_chosung_key(title, title_chosung, sizeof(title_chosung));
+        hangul_jamo_key(title, title_jamo, sizeof(title_jamo));
+        sqlite3_bind_text(stmt, param_index++, title, -1, SQLITE_STATIC);
+        sqlite3_bind_text(stmt, param_index++, title_chosung, -1, SQLITE_STATIC);
+        sqlite3_bind_text(stmt, param_index++, title_jamo, -1, SQLITE_STATIC);
+    }
+    if (author != NULL) {
+        hangul_chosung_key(author, author_chosung, sizeof(author_chosung));
+        hangul_jamo_key(author, author_jamo, sizeof(author_jamo));
+        sqlite3_bind_text(stmt, param_index++, author, -1, SQLITE_STATIC);
+        sqlite3_bind_text(stmt, param_index++, author_chosung, -1, SQLITE_STATIC);
+        sqlite3_bind_text(stmt, param_index++, author_jamo, -1, SQLITE_STATIC);
+    }
     if (publisher != NULL) sqlite3_bind_text(stmt, param_index++, publisher, -1, SQLITE_STATIC);
     if (publication_year > 0) sqlite3_bind_int(stmt, param_index++, publication_year);
     if (genre != NULL) sqlite3_bind_text(stmt, param_index++, genre, -1, SQLITE_STATIC);
     sqlite3_bind_int(stmt, param_index, book_id);
     
-    rc = sqlite3_step(stmt);
-    sqlite3_finalize(stmt);
-    
+    int rc = sqlite3_step(stmt);
     if (rc != SQLITE_DONE) {
         fprintf(stderr, "Failed to update book: %s\n", sqlite3_errmsg(db));
+    }
+    int changes = sqlite3_changes(db);
+    sqlite3_reset(stmt);
+    sqlite3_clear_bindings(stmt);
+    
+    if (rc != SQLITE_DONE) {
         return -1;
     }
     
-    if (sqlite3_changes(db) == 0) {
+    if (changes == 0) {
         fprintf(stderr, "Book not found (ID: %d)\n", book_id);
         return -1;
     }
     
-    printf("Book updated successfully\n");
+    if (title != NULL || author != NULL) {
+        trigram_refresh_book(db, book_id);
+        autocomplete_refresh_book(db, book_id);
+    }
+    
+    if (!is_quiet_mode()) {
+        printf("Book updated successfully\n");
+    }
     return 0;
 }
 
@@ -319,7 +509,12 @@ int delete_book(int book_id) {
         return -1;
     }
     
-    printf("Book deleted successfully\n");
+    trigram_remove_book(book_id);
+    autocomplete_remove_book(book_id);
+    
+    if (!is_quiet_mode()) {
+        printf("Book deleted successfully\n");
+    }
     return 0;
 }
 
@@ -346,37 +541,7 @@ int display_all_books(void) {
         return -1;
     }
     
-    printf("\n=== All Books ===\n");
-    printf("%-5s %-30s %-20s %-20s %-6s %-15s %-15s %-8s %-8s\n",
-           "ID", "Title", "Author", "Publisher", "Year", "ISBN", "Genre", "Quantity", "Available");
-    printf("---------------------------------------------------------------------------------------------------------------------------\n");
-    
-    int count = 0;
-    while ((rc = sqlite3_step(stmt)) == SQLITE_ROW) {
-        int book_id = sqlite3_column_int(stmt, 0);
-        const unsigned char *title = sqlite3_column_text(stmt, 1);
-        const unsigned char *author = sqlite3_column_text(stmt, 2);
-        const unsigned char *publisher = sqlite3_column_text(stmt, 3);
-        int year = sqlite3_column_int(stmt, 4);
-        const unsigned char *isbn = sqlite3_column_text(stmt, 5);
-        const unsigned char *genre = sqlite3_column_text(stmt, 6);
-        int quantity = sqlite3_column_int(stmt, 7);
-        int available = sqlite3_column_int(stmt, 8);
-        
-        printf("%-5d %-30s %-20s %-20s %-6d %-15s %-15s %-8d %-8d\n",
-               book_id, title, author, publisher, year, isbn, genre, quantity, available);
-        count++;
-    }
-    
-    sqlite3_finalize(stmt);
-    
-    if (rc != SQLITE_DONE) {
-        fprintf(stderr, "Error during query execution: %s\n", sqlite3_errmsg(db));
-        return -1;
-    }
-    
-    printf("\nTotal books: %d\n", count);
-    return count;
+    return write_book_list(db, stmt, "\n=== All Books ===\n", "\nTotal books: %d\n");
 }
 
 /**
@@ -431,7 +596,8 @@ int update_book_availability(int book_id, int change) {
         return -1;
     }
     
-    const char *sql = "UPDATE Books SET available = available + ? WHERE book_id = ?;";
+    // Never take available below zero, so a title cannot be lent more often than it is on the shelf
+    const char *sql = "UPDATE Books SET available = available + ?1 WHERE book_id = ?2 AND available + ?1 >= 0;";
     
     sqlite3_stmt *stmt;
     int rc = sqlite3_prepare_v2(db, sql, -1, &stmt, NULL);
@@ -453,7 +619,7 @@ int update_book_availability(int book_id, int change) {
     }
     
     if (sqlite3_changes(db) == 0) {
-        fprintf(stderr, "Book not found (ID: %d)\n", book_id);
+        fprintf(stderr, "Book not found or not available (ID: %d)\n", book_id);
         return -1;
     }
     
@@ -493,36 +659,9 @@ int search_books_by_genre(const char *genre) {
     snprintf(pattern, sizeof(pattern), "%%%s%%", genre);
     sqlite3_bind_text(stmt, 1, pattern, -1, SQLITE_TRANSIENT);
     
-    printf("\n=== Books by Genre: %s ===\n", genre);
-    printf("%-5s %-30s %-20s %-20s %-6s %-15s %-8s %-8s\n",
-           "ID", "Title", "Author", "Publisher", "Year", "ISBN", "Quantity", "Available");
-    printf("---------------------------------------------------------------------------------------------------------------\n");
-    
-    int count = 0;
-    while ((rc = sqlite3_step(stmt)) == SQLITE_ROW) {
-        int book_id = sqlite3_column_int(stmt, 0);
-        const unsigned char *title = sqlite3_column_text(stmt, 1);
-        const unsigned char *author = sqlite3_column_text(stmt, 2);
-        const unsigned char *publisher = sqlite3_column_text(stmt, 3);
-        int year = sqlite3_column_int(stmt, 4);
-        const unsigned char *isbn = sqlite3_column_text(stmt, 5);
-        int quantity = sqlite3_column_int(stmt, 7);
-        int available = sqlite3_column_int(stmt, 8);
-        
-        printf("%-5d %-30s %-20s %-20s %-6d %-15s %-8d %-8d\n",
-               book_id, title, author, publisher, year, isbn, quantity, available);
-        count++;
-    }
-    
-    sqlite3_finalize(stmt);
-    
-    if (rc != SQLITE_DONE) {
-        fprintf(stderr, "Error during query execution: %s\n", sqlite3_errmsg(db));
-        return -1;
-    }
-    
-    printf("\nTotal books found: %d\n", count);
-    return count;
+    char title[128];
+    snprintf(title, sizeof(title), "\n=== Books by Genre: %s ===\n", genre);
+    return write_book_list(db, stmt, title, "\nTotal books found: %d\n");
 }
 
 /**
@@ -558,34 +697,7 @@ int search_books_by_author(const char *author) {
     snprintf(pattern, sizeof(pattern), "%%%s%%", author);
     sqlite3_bind_text(stmt, 1, pattern, -1, SQLITE_TRANSIENT);
     
-    printf("\n=== Books by Author: %s ===\n", author);
-    printf("%-5s %-30s %-20s %-6s %-15s %-15s %-8s %-8s\n",
-           "ID", "Title", "Publisher", "Year", "ISBN", "Genre", "Quantity", "Available");
-    printf("---------------------------------------------------------------------------------------------------------------\n");
-    
-    int count = 0;
-    while ((rc = sqlite3_step(stmt)) == SQLITE_ROW) {
-        int book_id = sqlite3_column_int(stmt, 0);
-        const unsigned char *title = sqlite3_column_text(stmt, 1);
-        const unsigned char *publisher = sqlite3_column_text(stmt, 3);
-        int year = sqlite3_column_int(stmt, 4);
-        const unsigned char *isbn = sqlite3_column_text(stmt, 5);
-        const unsigned char *genre = sqlite3_column_text(stmt, 6);
-        int quantity = sqlite3_column_int(stmt, 7);
-        int available = sqlite3_column_int(stmt, 8);
-        
-        printf("%-5d %-30s %-20s %-6d %-15s %-15s %-8d %-8d\n",
-               book_id, title, publisher, year, isbn, genre, quantity, available);
-        count++;
-    }
-    
-    sqlite3_finalize(stmt);
-    
-    if (rc != SQLITE_DONE) {
-        fprintf(stderr, "Error during query execution: %s\n", sqlite3_errmsg(db));
-        return -1;
-    }
-    
-    printf("\nTotal books found: %d\n", count);
-    return count;
+    char title[128];
+    snprintf(title, sizeof(title), "\n=== Books by Author: %s ===\n", author);
+    return write_book_list(db, stmt, title, "\nTotal books found: %d\n");
 }
\ No newline at end of file
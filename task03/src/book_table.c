@@ -0,0 +1,360 @@
+#include "book_table.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define POOL_INITIAL_SLOTS 64
+#define TABLE_INITIAL_ROWS 64
+
+/**
+ * @brief Copy a string to the end of an arena.
+ * 
+ * @return int64_t Returns offset of the copy, -1 on failure.
+ */
+static int64_t arena_add(StringArena *arena, const char *text) {
+    size_t length = strlen(text) + 1;
+    if ((uint64_t)arena->size + length > UINT32_MAX) {
+        fprintf(stderr, "String arena is full\n");
+        return -1;
+    }
+
+    if (arena->size + length > arena->capacity) {
+        uint64_t capacity = arena->capacity ? arena->capacity : 1024;
+        while (capacity < arena->size + length) {
+            capacity *= 2;
+        }
+        if (capacity > UINT32_MAX) {
+            capacity = UINT32_MAX;
+        }
+        char *data = realloc(arena->data, capacity);
+        if (data == NULL) {
+            fprintf(stderr, "Out of memory\n");
+            return -1;
+        }
+        arena->data = data;
+        arena->capacity = (uint32_t)capacity;
+    }
+
+    uint32_t offset = arena->size;
+    memcpy(arena->data + offset, text, length);
+    arena->size += (uint32_t)length;
+    return offset;
+}
+
+/**
+ * @brief FNV-1a hash of a NUL-terminated string.
+ */
+static uint32_t hash_string(const char *text) {
+    uint32_t hash = 2166136261u;
+    for (const unsigned char *p = (const unsigned char *)text; *p; p++) {
+        hash = (hash ^ *p) * 16777619u;
+    }
+    return hash;
+}
+
+/**
+ * @brief Find the slot holding a string, or the empty slot where it belongs.
+ */
+static uint32_t pool_slot(const StringPool *pool, const char *text) {
+    uint32_t slot = hash_string(text) & pool->slot_mask;
+    while (pool->slots[slot] != 0 &&
+           strcmp(pool->arena.data + pool->offsets[pool->slots[slot] - 1], text) != 0) {
+        slot = (slot + 1) & pool->slot_mask;
+    }
+    return slot;
+}
+
+/**
+ * @brief Double the slot table and re-insert every string.
+ */
+static int pool_grow_slots(StringPool *pool) {
+    uint32_t slot_count = (pool->slot_mask + 1) * 2;
+    uint32_t *slots = calloc(slot_count, sizeof(uint32_t));
+    if (slots == NULL) {
+        fprintf(stderr, "Out of memory\n");
+        return -1;
+    }
+
+    free(pool->slots);
+    pool->slots = slots;
+    pool->slot_mask = slot_count - 1;
+    for (uint32_t id = 0; id < pool->count; id++) {
+        pool->slots[pool_slot(pool, pool->arena.data + pool->offsets[id])] = id + 1;
+    }
+    return 0;
+}
+
+int string_pool_init(StringPool *pool) {
+    memset(pool, 0, sizeof(*pool));
+    pool->slots = calloc(POOL_INITIAL_SLOTS, sizeof(uint32_t));
+    if (pool->slots == NULL) {
+        fprintf(stderr, "Out of memory\n");
+        return -1;
+    }
+    pool->slot_mask = POOL_INITIAL_SLOTS - 1;
+
+    /* ID 0 (BOOK_TABLE_NO_STRING) is the empty string */
+    if (string_pool_intern(pool, "") != BOOK_TABLE_NO_STRING) {
+        string_pool_free(pool);
+        return -1;
+    }
+    return 0;
+}
+
+void string_pool_free(StringPool *pool) {
+    free(pool->arena.data);
+    free(pool->offsets);
+    free(pool->slots);
+    memset(pool, 0, sizeof(*pool));
+}
+
+int64_t string_pool_intern(StringPool *pool, const char *text) {
+    if (text == NULL) {
+        text = "";
+    }
+
+    uint32_t slot = pool_slot(pool, text);
+    if (pool->slots[slot] != 0) {
+        return pool->slots[slot] - 1;
+    }
+
+    if (pool->count == pool->capacity) {
+        uint32_t capacity = pool->capacity ? pool->capacity * 2 : 16;
+        uint32_t *offsets = realloc(pool->offsets, capacity * sizeof(uint32_t));
+        if (offsets == NULL) {
+            fprintf(stderr, "Out of memory\n");
+            return -1;
+        }
+        pool->offsets = offsets;
+        pool->capacity = capacity;
+    }
+
+    int64_t offset = arena_add(&pool->arena, text);
+    if (offset < 0) {
+        return -1;
+    }
+
+    uint32_t id = pool->count++;
+    pool->offsets[id] = (uint32_t)offset;
+    pool->slots[slot] = id + 1;
+
+    /* Keep the load factor under 3/4 */
+    if (pool->count * 4 > (pool->slot_mask + 1) * 3 && pool_grow_slots(pool) != 0) {
+        return -1;
+    }
+    return id;
+}
+
+int64_t string_pool_find(const StringPool *pool, const char *text) {
+    uint32_t slot = pool_slot(pool, text ? text : "");
+    return pool->slots[slot] != 0 ? (int64_t)pool->slots[slot] - 1 : -1;
+}
+
+const char *string_pool_get(const StringPool *pool, uint32_t id) {
+    return id < pool->count ? pool->arena.data + pool->offsets[id] : NULL;
+}
+
+int book_table_init(BookTable *table) {
+    memset(table, 0, sizeof(*table));
+    if (string_pool_init(&table->authors) != 0 ||
+        string_pool_init(&table->publishers) != 0 ||
+        string_pool_init(&table->genres) != 0) {
+        book_table_free(table);
+        return -1;
+    }
+    return 0;
+}
+
+void book_table_free(BookTable *table) {
+    free(table->book_ids);
+    free(table->title_offsets);
+    free(table->author_ids);
+    free(table->publisher_ids);
+    free(table->genre_ids);
+    free(table->years);
+    free(table->quantities);
+    free(table->available);
+    free(table->isbn13);
+    free(table->titles.data);
+    string_pool_free(&table->authors);
+    string_pool_free(&table->publishers);
+    string_pool_free(&table->genres);
+    memset(table, 0, sizeof(*table));
+}
+
+/**
+ * @brief Resize one column, keeping its contents.
+ */
+static int grow_column(void **column, size_t element_size, int capacity) {
+    void *grown = realloc(*column, (size_t)capacity * element_size);
+    if (grown == NULL) {
+        fprintf(stderr, "Out of memory\n");
+        return -1;
+    }
+    *column = grown;
+    return 0;
+}
+
+/**
+ * @brief Make room for at least one more row in every column.
+ */
+static int reserve_row(BookTable *table) {
+    if (table->count < table->capacity) {
+        return 0;
+    }
+
+    int capacity = table->capacity ? table->capacity * 2 : TABLE_INITIAL_ROWS;
+    if (grow_column((void **)&table->book_ids, sizeof(int32_t), capacity) != 0 ||
+        grow_column((void **)&table->title_offsets, sizeof(uint32_t), capacity) != 0 ||
+        grow_column((void **)&table->author_ids, sizeof(uint32_t), capacity) != 0 ||
+        grow_column((void **)&table->publisher_ids, sizeof(uint32_t), capacity) != 0 ||
+        grow_column((void **)&table->genre_ids, sizeof(uint16_t), capacity) != 0 ||
+        grow_column((void **)&table->years, sizeof(int16_t), capacity) != 0 ||
+        grow_column((void **)&table->quantities, sizeof(uint16_t), capacity) != 0 ||
+        grow_column((void **)&table->available, sizeof(uint16_t), capacity) != 0 ||
+        grow_column((void **)&table->isbn13, sizeof(int64_t), capacity) != 0) {
+        return -1;
+    }
+    table->capacity = capacity;
+    return 0;
+}
+
+int book_table_append(BookTable *table, int book_id, const char *title, const char *author,
+                      const char *publisher, int publication_year, int64_t isbn13,
+                      const char *genre, int quantity, int available) {
+    if (table->count > 0 && book_id <= table->book_ids[table->count - 1]) {
+        fprintf(stderr, "Books must be appended in ascending ID order (ID: %d)\n", book_id);
+        return -1;
+    }
+    if (quantity < 0 || quantity > UINT16_MAX || available < 0 || available > UINT16_MAX) {
+        fprintf(stderr, "Quantity out of range (ID: %d)\n", book_id);
+        return -1;
+    }
+    if (reserve_row(table) != 0) {
+        return -1;
+    }
+
+    int64_t title_offset = arena_add(&table->titles, title ? title : "");
+    int64_t author_id = string_pool_intern(&table->authors, author);
+    int64_t publisher_id = string_pool_intern(&table->publishers, publisher);
+    int64_t genre_id = string_pool_intern(&table->genres, genre);
+    if (title_offset < 0 || author_id < 0 || publisher_id < 0 || genre_id < 0) {
+        return -1;
+    }
+    if (genre_id > UINT16_MAX) {
+        fprintf(stderr, "Too many distinct genres\n");
+        return -1;
+    }
+
+    int row = table->count++;
+    table->book_ids[row] = book_id;
+    table->title_offsets[row] = (uint32_t)title_offset;
+    table->author_ids[row] = (uint32_t)author_id;
+    table->publisher_ids[row] = (uint32_t)publisher_id;
+    table->genre_ids[row] = (uint16_t)genre_id;
+    table->years[row] = (int16_t)publication_year;
+    table->quantities[row] = (uint16_t)quantity;
+    table->available[row] = (uint16_t)available;
+    table->isbn13[row] = isbn13;
+    return row;
+}
+
+int book_table_append_row(BookTable *table, sqlite3_stmt *stmt) {
+    return book_table_append(table,
+                             sqlite3_column_int(stmt, 0),
+                             (const char *)sqlite3_column_text(stmt, 1),
+                             (const char *)sqlite3_column_text(stmt, 2),
+                             (const char *)sqlite3_column_text(stmt, 3),
+                             sqlite3_column_int(stmt, 4),
+                             sqlite3_column_int64(stmt, 5),
+                             (const char *)sqlite3_column_text(stmt, 6),
+                             sqlite3_column_int(stmt, 7),
+                             sqlite3_column_int(stmt, 8));
+}
+
+int load_book_table(sqlite3 *db, BookTable *table) {
+    const char *sql = "SELECT " BOOK_TABLE_COLUMNS " FROM Books ORDER BY book_id;";
+
+    sqlite3_stmt *stmt;
+    if (sqlite3_prepare_v2(db, sql, -1, &stmt, NULL) != SQLITE_OK) {
+        fprintf(stderr, "Failed to prepare statement: %s\n", sqlite3_errmsg(db));
+        return -1;
+    }
+
+    int rc;
+    while ((rc = sqlite3_step(stmt)) == SQLITE_ROW) {
+        if (book_table_append_row(table, stmt) < 0) {
+            rc = SQLITE_ERROR;
+            break;
+        }
+    }
+
+    if (rc != SQLITE_DONE && rc != SQLITE_ERROR) {
+        fprintf(stderr, "Error during query execution: %s\n", sqlite3_errmsg(db));
+    }
+    sqlite3_finalize(stmt);
+    return rc == SQLITE_DONE ? table->count : -1;
+}
+
+int book_table_find(const BookTable *table, int book_id) {
+    int low = 0;
+    int high = table->count - 1;
+    while (low <= high) {
+        int mid = low + (high - low) / 2;
+        if (table->book_ids[mid] < book_id) {
+            low = mid + 1;
+        } else if (table->book_ids[mid] > book_id) {
+            high = mid - 1;
+        } else {
+            return mid;
+        }
+    }
+    return -1;
+}
+
+const char *book_table_title(const BookTable *table, int row) {
+    return table->titles.data + table->title_offsets[row];
+}
+
+/**
+ * @brief strncpy that always terminates the destination.
+ */
+static void copy_text(char *dest, size_t size, const char *src) {
+    strncpy(dest, src, size - 1);
+    dest[size - 1] = '\0';
+}
+
+int book_table_get(const BookTable *table, int row, Book *book) {
+    if (row < 0 || row >= table->count || book == NULL) {
+        return -1;
+    }
+
+    book->book_id = table->book_ids[row];
+    copy_text(book->title, sizeof(book->title), book_table_title(table, row));
+    copy_text(book->author, sizeof(book->author), string_pool_get(&table->authors, table->author_ids[row]));
+    copy_text(book->publisher, sizeof(book->publisher),
+              string_pool_get(&table->publishers, table->publisher_ids[row]));
+    copy_text(book->genre, sizeof(book->genre), string_pool_get(&table->genres, table->genre_ids[row]));
+    book->isbn[0] = '\0';
+    if (table->isbn13[row] != 0) {
+        snprintf(book->isbn, sizeof(book->isbn), "%013lld", (long long)table->isbn13[row]);
+    }
+    book->publication_year = table->years[row];
+    book->quantity = table->quantities[row];
+    book->available = table->available[row];
+    return 0;
+}
+
+/**
+ * @brief Bytes held by the strings and index of a pool.
+ */
+static size_t pool_memory(const StringPool *pool) {
+    return pool->arena.size + pool->count * sizeof(uint32_t) + (pool->slot_mask + 1) * sizeof(uint32_t);
+}
+
+size_t book_table_memory(const BookTable *table) {
+    size_t row_size = sizeof(int32_t) + 3 * sizeof(uint32_t) + 3 * sizeof(uint16_t) + sizeof(int16_t) +
+                      sizeof(int64_t);
+    return (size_t)table->count * row_size + table->titles.size +
+           pool_memory(&table->authors) + pool_memory(&table->publishers) + pool_memory(&table->genres);
+}
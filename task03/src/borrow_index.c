@@ -0,0 +1,743 @@
+#include "borrow_index.h"
+#include "database.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#define BORROW_INDEX_MAGIC "LIBBIDX1"
+
+/*
+ * File layout (all fields native-endian):
+ *   BorrowIndexHeader
+ *   int32_t  row_ids[member_rows + book_rows]          member IDs, then book IDs, each sorted ascending
+ *   uint32_t row_offsets[member_rows + book_rows + 1]  into containers
+ *   zero padding to 8 bytes
+ *   RoaringFileContainer containers[container_count]  per row, sorted by key
+ *   data[data_size]                                    container values, each 8-byte aligned
+ */
+typedef struct {
+    char magic[8];
+    uint32_t member_rows;
+    uint32_t book_rows;
+    uint64_t container_count;
+    uint64_t data_size;
+    int64_t last_loan_id;    // newest loan reflected in the file
+} BorrowIndexHeader;
+
+/**
+ * @brief The bitmap of one member (books borrowed) or one book (borrowers).
+ */
+typedef struct {
+    int id;
+    RoaringBitmap bits;
+} IndexRow;
+
+typedef struct {
+    IndexRow *rows;    // sorted by id
+    int count;
+    int capacity;
+} IndexSide;
+
+static struct {
+    void *map;
+    size_t map_size;
+    const int32_t *row_ids;
+    const uint32_t *row_offsets;
+    const RoaringFileContainer *containers;
+    const char *data;
+    uint32_t member_rows;
+    uint32_t book_rows;
+    int64_t last_loan_id;
+    IndexSide member_delta;    // loans newer than the file
+    IndexSide book_delta;
+    int pending_loans;         // loans in the delta
+    char path[512];            // file the index was mapped from
+} borrow_index = {0};
+
+static void free_side(IndexSide *side) {
+    for (int i = 0; i < side->count; i++) {
+        roaring_free(&side->rows[i].bits);
+    }
+    free(side->rows);
+    memset(side, 0, sizeof(*side));
+}
+
+/**
+ * @brief Find the row of an ID, or the position to insert it.
+ */
+static int find_side_row(const IndexSide *side, int id, int *found) {
+    int lo = 0, hi = side->count;
+    while (lo < hi) {
+        int mid = lo + (hi - lo) / 2;
+        if (side->rows[mid].id < id) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    *found = lo < side->count && side->rows[lo].id == id;
+    return lo;
+}
+
+/**
+ * @brief Add a value to the row of an ID, creating the row if needed.
+ */
+static int side_add(IndexSide *side, int id, int value) {
+    int found, pos;
+    if (side->count > 0 && side->rows[side->count - 1].id <= id) {
+        pos = side->count - (side->rows[side->count - 1].id == id);    // rows arrive in order while building
+        found = pos < side->count;
+    } else {
+        pos = find_side_row(side, id, &found);
+    }
+
+    if (!found) {
+        if (side->count == side->capacity) {
+            int capacity = side->capacity ? side->capacity * 2 : 256;
+            IndexRow *rows = realloc(side->rows, capacity * sizeof(IndexRow));
+            if (rows == NULL) {
+                return -1;
+            }
+            side->rows = rows;
+            side->capacity = capacity;
+        }
+        memmove(&side->rows[pos + 1], &side->rows[pos], (side->count - pos) * sizeof(IndexRow));
+        side->rows[pos].id = id;
+        roaring_init(&side->rows[pos].bits);
+        side->count++;
+    }
+    return roaring_add(&side->rows[pos].bits, (uint32_t)value);
+}
+
+/**
+ * @brief Remove a value from the row of an ID (the row itself stays).
+ */
+static void side_remove(IndexSide *side, int id, int value) {
+    int found;
+    int pos = find_side_row(side, id, &found);
+    if (found) {
+        roaring_remove(&side->rows[pos].bits, (uint32_t)value);
+    }
+}
+
+static const RoaringBitmap *side_bits(const IndexSide *side, int id) {
+    int found;
+    int pos = find_side_row(side, id, &found);
+    return found ? &side->rows[pos].bits : NULL;
+}
+
+/**
+ * @brief Find the mapped bitmap of a member (books) or a book (members).
+ * 
+ * @return int Returns 1 if the file has a row for the ID, 0 otherwise.
+ */
+static int mapped_row(int books, int id, RoaringView *view) {
+    int lo = books ? (int)borrow_index.member_rows : 0;
+    int hi = lo + (int)(books ? borrow_index.book_rows : borrow_index.member_rows) - 1;
+    while (lo <= hi) {
+        int mid = lo + (hi - lo) / 2;
+        if (borrow_index.row_ids[mid] == id) {
+            view->containers = &borrow_index.containers[borrow_index.row_offsets[mid]];
+            view->count = (int)(borrow_index.row_offsets[mid + 1] - borrow_index.row_offsets[mid]);
+            view->data = borrow_index.data;
+            return 1;
+        }
+        if (borrow_index.row_ids[mid] < id) {
+            lo = mid + 1;
+        } else {
+            hi = mid - 1;
+        }
+    }
+    return 0;
+}
+
+/**
+ * @brief Write both sides atomically (temporary file, then rename).
+ */
+static int write_index(const char *path, const IndexSide *members, const IndexSide *books, int64_t last_loan_id) {
+    char tmp_path[512];
+    snprintf(tmp_path, sizeof(tmp_path), "%s.tmp", path);
+
+    FILE *fp = fopen(tmp_path, "wb");
+    if (fp == NULL) {
+        fprintf(stderr, "Cannot open %s for writing\n", tmp_path);
+        return -1;
+    }
+
+    const IndexSide *sides[2] = {members, books};
+    BorrowIndexHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, BORROW_INDEX_MAGIC, sizeof(header.magic));
+    header.member_rows = (uint32_t)members->count;
+    header.book_rows = (uint32_t)books->count;
+    header.last_loan_id = last_loan_id;
+    for (int s = 0; s < 2; s++) {
+        for (int r = 0; r < sides[s]->count; r++) {
+            const RoaringBitmap *bits = &sides[s]->rows[r].bits;
+            header.container_count += (uint64_t)bits->count;
+            for (int c = 0; c < bits->count; c++) {
+                header.data_size += roaring_container_bytes(bits->containers[c].kind,
+                                                            bits->containers[c].cardinality);
+            }
+        }
+    }
+    int ok = fwrite(&header, sizeof(header), 1, fp) == 1;
+
+    /* Row IDs and offsets */
+    uint32_t offset = 0;
+    for (int s = 0; s < 2 && ok; s++) {
+        for (int r = 0; r < sides[s]->count && ok; r++) {
+            int32_t id = sides[s]->rows[r].id;
+            ok = fwrite(&id, sizeof(id), 1, fp) == 1;
+        }
+    }
+    for (int s = 0; s < 2 && ok; s++) {
+        for (int r = 0; r < sides[s]->count && ok; r++) {
+            ok = fwrite(&offset, sizeof(offset), 1, fp) == 1;
+            offset += (uint32_t)sides[s]->rows[r].bits.count;
+        }
+    }
+    static const char zeros[8] = {0};
+    long position = ok ? ftell(fp) : 0;
+    ok = ok && fwrite(&offset, sizeof(offset), 1, fp) == 1 &&
+         fwrite(zeros, 1, (size_t)((8 - (position + 4) % 8) % 8), fp) == (size_t)((8 - (position + 4) % 8) % 8);
+
+    /* Container directory, then the values */
+    uint64_t data_offset = 0;
+    for (int s = 0; s < 2 && ok; s++) {
+        for (int r = 0; r < sides[s]->count && ok; r++) {
+            const RoaringBitmap *bits = &sides[s]->rows[r].bits;
+            for (int c = 0; c < bits->count && ok; c++) {
+                RoaringFileContainer entry = {bits->containers[c].key, bits->containers[c].kind,
+                                              bits->containers[c].cardinality, data_offset};
+                ok = fwrite(&entry, sizeof(entry), 1, fp) == 1;
+                data_offset += roaring_container_bytes(entry.kind, entry.cardinality);
+            }
+        }
+    }
+    for (int s = 0; s < 2 && ok; s++) {
+        for (int r = 0; r < sides[s]->count && ok; r++) {
+            const RoaringBitmap *bits = &sides[s]->rows[r].bits;
+            for (int c = 0; c < bits->count && ok; c++) {
+                const RoaringContainer *container = &bits->containers[c];
+                size_t used = container->kind == ROARING_BITMAP ? ROARING_BITMAP_WORDS * sizeof(uint64_t)
+                                                                : container->cardinality * sizeof(uint16_t);
+                size_t padding = roaring_container_bytes(container->kind, container->cardinality) - used;
+                ok = fwrite(container->data, 1, used, fp) == used && fwrite(zeros, 1, padding, fp) == padding;
+            }
+        }
+    }
+
+    if (fclose(fp) != 0 || !ok) {
+        fprintf(stderr, "Failed to write %s\n", tmp_path);
+        remove(tmp_path);
+        return -1;
+    }
+
+    if (rename(tmp_path, path) != 0) {
+        fprintf(stderr, "Failed to replace %s\n", path);
+        remove(tmp_path);
+        return -1;
+    }
+
+    return 0;
+}
+
+static int compare_pairs(const void *lhs, const void *rhs) {
+    uint64_t a = *(const uint64_t *)lhs, b = *(const uint64_t *)rhs;
+    return (a > b) - (a < b);
+}
+
+/**
+ * @brief Fill one side from (id << 32 | value) pairs, sorting them first.
+ * 
+ * Duplicates fall out in roaring_add(); sorted input keeps every add on
+ * the append fast path.
+ */
+static int fill_side(IndexSide *side, uint64_t *pairs, long count) {
+    qsort(pairs, (size_t)count, sizeof(uint64_t), compare_pairs);
+    for (long i = 0; i < count; i++) {
+        if ((i == 0 || pairs[i] != pairs[i - 1]) &&
+            side_add(side, (int)(pairs[i] >> 32), (int)(uint32_t)pairs[i]) != 0) {
+            fprintf(stderr, "Out of memory while building the borrow index\n");
+            return -1;
+        }
+    }
+    return 0;
+}
+
+/**
+ * @brief Read every (member, book) pair up to a loan ID in a single scan.
+ * 
+ * @return long Returns number of loans read, -1 on failure.
+ */
+static long load_pairs(sqlite3 *db, int64_t last_loan_id, uint64_t **pairs) {
+    sqlite3_stmt *stmt;
+    if (sqlite3_prepare_v2(db, "SELECT member_id, book_id FROM Loans WHERE loan_id <= ?;",
+                           -1, &stmt, NULL) != SQLITE_OK) {
+        fprintf(stderr, "Failed to prepare statement: %s\n", sqlite3_errmsg(db));
+        return -1;
+    }
+    sqlite3_bind_int64(stmt, 1, last_loan_id);
+
+    long count = 0, capacity = 0;
+    *pairs = NULL;
+    int rc;
+    while ((rc = sqlite3_step(stmt)) == SQLITE_ROW) {
+        if (count == capacity) {
+            long grown = capacity ? capacity * 2 : 4096;
+            uint64_t *more = realloc(*pairs, (size_t)grown * sizeof(uint64_t));
+            if (more == NULL) {
+                fprintf(stderr, "Out of memory while building the borrow index\n");
+                break;
+            }
+            *pairs = more;
+            capacity = grown;
+        }
+        (*pairs)[count++] = (uint64_t)(uint32_t)sqlite3_column_int(stmt, 0) << 32 |
+                            (uint32_t)sqlite3_column_int(stmt, 1);
+    }
+    sqlite3_finalize(stmt);
+
+    if (rc != SQLITE_DONE) {
+        if (rc != SQLITE_ROW) {
+            fprintf(stderr, "Failed to read loans: %s\n", sqlite3_errmsg(db));
+        }
+        free(*pairs);
+        *pairs = NULL;
+        return -1;
+    }
+    return count;
+}
+
+/**
+ * @brief Build the borrow history index from Loans and write it to a file.
+ * 
+ * @param db SQLite database connection.
+ * @param path Output file path.
+ * @return int Returns number of distinct (member, book) pairs, -1 on failure.
+ */
+int build_borrow_index(sqlite3 *db, const char *path) {
+    if (db == NULL || path == NULL) {
+        fprintf(stderr, "Database connection is NULL\n");
+        return -1;
+    }
+
+    int64_t last_loan_id = 0;
+    sqlite3_stmt *stmt;
+    if (sqlite3_prepare_v2(db, "SELECT COALESCE(MAX(loan_id), 0) FROM Loans;", -1, &stmt, NULL) != SQLITE_OK) {
+        fprintf(stderr, "Failed to prepare statement: %s\n", sqlite3_errmsg(db));
+        return -1;
+    }
+    if (sqlite3_step(stmt) == SQLITE_ROW) {
+        last_loan_id = sqlite3_column_int64(stmt, 0);
+    }
+    sqlite3_finalize(stmt);
+
+    /* One scan of Loans, then member-major and book-major sorts in memory */
+    uint64_t *pairs;
+    long loans = load_pairs(db, last_loan_id, &pairs);
+    if (loans < 0) {
+        return -1;
+    }
+    IndexSide members = {0}, books = {0};
+    int distinct = -1;
+    if (fill_side(&members, pairs, loans) == 0) {
+        for (long i = 0; i < loans; i++) {
+            pairs[i] = pairs[i] << 32 | pairs[i] >> 32;
+        }
+        if (fill_side(&books, pairs, loans) == 0 &&
+            write_index(path, &members, &books, last_loan_id) == 0) {
+            distinct = 0;
+            for (int r = 0; r < members.count; r++) {
+                distinct += (int)roaring_cardinality(&members.rows[r].bits);
+            }
+        }
+    }
+    free(pairs);
+
+    free_side(&members);
+    free_side(&books);
+    return distinct;
+}
+
+/**
+ * @brief Unmap the index and drop pending updates.
+ */
+void close_borrow_index(void) {
+    if (borrow_index.map != NULL) {
+        munmap(borrow_index.map, borrow_index.map_size);
+    }
+    free_side(&borrow_index.member_delta);
+    free_side(&borrow_index.book_delta);
+    memset(&borrow_index, 0, sizeof(borrow_index));
+}
+
+/**
+ * @brief Memory-map an index file written by build_borrow_index().
+ * 
+ * @param path Index file path.
+ * @return int Returns 0 on success, -1 on failure.
+ */
+int open_borrow_index(const char *path) {
+    if (path == NULL) {
+        return -1;
+    }
+
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        fprintf(stderr, "Cannot open borrow index file: %s\n", path);
+        return -1;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(BorrowIndexHeader)) {
+        fprintf(stderr, "Invalid borrow index file: %s\n", path);
+        close(fd);
+        return -1;
+    }
+
+    void *map = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED) {
+        fprintf(stderr, "Cannot map borrow index file: %s\n", path);
+        return -1;
+    }
+
+    const BorrowIndexHeader *header = map;
+    size_t rows = (size_t)header->member_rows + header->book_rows;
+    size_t directory = (sizeof(BorrowIndexHeader) + rows * sizeof(int32_t) + (rows + 1) * sizeof(uint32_t) + 7) & ~(size_t)7;
+    size_t expected = directory + header->container_count * sizeof(RoaringFileContainer) + header->data_size;
+    const uint32_t *offsets = (const uint32_t *)((const char *)map + sizeof(BorrowIndexHeader) + rows * sizeof(int32_t));
+    if (memcmp(header->magic, BORROW_INDEX_MAGIC, sizeof(header->magic)) != 0 ||
+        (size_t)st.st_size != expected || offsets[rows] != header->container_count) {
+        fprintf(stderr, "Invalid borrow index file: %s\n", path);
+        munmap(map, (size_t)st.st_size);
+        return -1;
+    }
+
+    close_borrow_index();
+
+    borrow_index.map = map;
+    borrow_index.map_size = (size_t)st.st_size;
+    borrow_index.member_rows = header->member_rows;
+    borrow_index.book_rows = header->book_rows;
+    borrow_index.last_loan_id = header->last_loan_id;
+    borrow_index.row_ids = (const int32_t *)((const char *)map + sizeof(BorrowIndexHeader));
+    borrow_index.row_offsets = offsets;
+    borrow_index.containers = (const RoaringFileContainer *)((const char *)map + directory);
+    borrow_index.data = (const char *)(borrow_index.containers + header->container_count);
+    snprintf(borrow_index.path, sizeof(borrow_index.path), "%s", path);
+    return 0;
+}
+
+/**
+ * @brief Rebuild the open index, or the file at BORROW_INDEX_PATH, from Loans.
+ * 
+ * @param db SQLite database connection.
+ * @return int Returns number of distinct (member, book) pairs, -1 on failure.
+ */
+int rebuild_borrow_index(sqlite3 *db) {
+    if (borrow_index.map == NULL) {
+        // Not open here (e.g. the CLI): the desk app would map a stale file next time
+        return access(BORROW_INDEX_PATH, F_OK) == 0 ? build_borrow_index(db, BORROW_INDEX_PATH) : 0;
+    }
+
+    char path[sizeof(borrow_index.path)];
+    snprintf(path, sizeof(path), "%s", borrow_index.path);
+    int pairs = build_borrow_index(db, path);
+    if (pairs < 0 || open_borrow_index(path) != 0) {
+        return -1;
+    }
+    return pairs;
+}
+
+/**
+ * @brief Fold loans newer than the index file into in-memory bitmaps.
+ * 
+ * @param db SQLite database connection.
+ * @return int Returns number of loans processed, -1 on failure.
+ */
+int catch_up_borrow_index(sqlite3 *db) {
+    if (borrow_index.map == NULL) {
+        return 0;
+    }
+    if (db == NULL) {
+        fprintf(stderr, "Database connection is NULL\n");
+        return -1;
+    }
+
+    /* Wait for the commit: a rolled back loan's ID goes to the next loan */
+    if (!sqlite3_get_autocommit(db)) {
+        return 0;
+    }
+
+    /* Runs after every loan, so the statement stays prepared between calls */
+    sqlite3_stmt *stmt = prepare_cached_statement(db, STMT_SLOT_BORROW_INDEX,
+                                                  "SELECT loan_id, member_id, book_id FROM Loans "
+                                                  "WHERE loan_id > ? ORDER BY loan_id;");
+    if (stmt == NULL) {
+        return -1;
+    }
+    sqlite3_bind_int64(stmt, 1, borrow_index.last_loan_id);
+
+    int processed = 0;
+    int rc;
+    while ((rc = sqlite3_step(stmt)) == SQLITE_ROW) {
+        int member_id = sqlite3_column_int(stmt, 1);
+        int book_id = sqlite3_column_int(stmt, 2);
+        const RoaringBitmap *books = side_bits(&borrow_index.member_delta, member_id);
+        int had_pair = books != NULL && roaring_contains(books, (uint32_t)book_id);
+        if (side_add(&borrow_index.member_delta, member_id, book_id) != 0) {
+            rc = SQLITE_NOMEM;
+            break;
+        }
+        if (side_add(&borrow_index.book_delta, book_id, member_id) != 0) {
+            /* Keep both directions in agreement; the loan is retried next call */
+            if (!had_pair) {
+                side_remove(&borrow_index.member_delta, member_id, book_id);
+            }
+            rc = SQLITE_NOMEM;
+            break;
+        }
+        borrow_index.last_loan_id = sqlite3_column_int64(stmt, 0);
+        processed++;
+    }
+
+    if (rc != SQLITE_DONE) {
+        if (rc == SQLITE_NOMEM) {
+            fprintf(stderr, "Out of memory while updating the borrow index\n");
+        } else {
+            fprintf(stderr, "Error during query execution: %s\n", sqlite3_errmsg(db));
+        }
+    }
+    sqlite3_reset(stmt);
+    sqlite3_clear_bindings(stmt);
+
+    /* Loans before a failure stay folded in */
+    borrow_index.pending_loans += processed;
+    if (rc != SQLITE_DONE) {
+        return -1;
+    }
+
+    /* Keep the delta bounded */
+    if (borrow_index.pending_loans >= BORROW_INDEX_SAVE_LOANS) {
+        flush_borrow_index();
+    }
+    return processed;
+}
+
+/**
+ * @brief Check whether a member has ever borrowed a book.
+ * 
+ * @param member_id The member ID.
+ * @param book_id The book ID.
+ * @return int Returns 1 if so, 0 if not, -1 if no index is open.
+ */
+int borrow_index_has_borrowed(int member_id, int book_id) {
+    if (borrow_index.map == NULL) {
+        return -1;
+    }
+    RoaringView view;
+    if (mapped_row(0, member_id, &view) && roaring_view_contains(&view, (uint32_t)book_id)) {
+        return 1;
+    }
+    const RoaringBitmap *delta = side_bits(&borrow_index.member_delta, member_id);
+    return delta != NULL && roaring_contains(delta, (uint32_t)book_id);
+}
+
+/**
+ * @brief Union the mapped and pending bitmaps of one row into out.
+ */
+static int add_row(int books, int id, RoaringBitmap *out) {
+    RoaringView view;
+    if (mapped_row(books, id, &view) && roaring_or_view(out, &view) != 0) {
+        return -1;
+    }
+    const RoaringBitmap *delta = side_bits(books ? &borrow_index.book_delta : &borrow_index.member_delta, id);
+    return delta != NULL ? roaring_or(out, delta) : 0;
+}
+
+static int row_bitmap(int books, int id, RoaringBitmap *out) {
+    if (borrow_index.map == NULL) {
+        return -1;
+    }
+    roaring_free(out);
+    return add_row(books, id, out) != 0 ? -1 : (int)roaring_cardinality(out);
+}
+
+/**
+ * @brief Get every book a member has borrowed.
+ * 
+ * @param member_id The member ID.
+ * @param books Initialized bitmap; its contents are replaced.
+ * @return int Returns number of books, -1 if no index is open or memory ran out.
+ */
+int borrow_index_member_books(int member_id, RoaringBitmap *books) {
+    return row_bitmap(0, member_id, books);
+}
+
+/**
+ * @brief Get every member who has borrowed a book.
+ * 
+ * @param book_id The book ID.
+ * @param members Initialized bitmap; its contents are replaced.
+ * @return int Returns number of members, -1 if no index is open or memory ran out.
+ */
+int borrow_index_book_members(int book_id, RoaringBitmap *members) {
+    return row_bitmap(1, book_id, members);
+}
+
+/**
+ * @brief Get the members who have borrowed any of the given books.
+ * 
+ * @param book_ids The book IDs.
+ * @param count Number of book IDs.
+ * @param members Initialized bitmap; its contents are replaced.
+ * @return int Returns number of members, -1 if no index is open or memory ran out.
+ */
+int borrow_index_members_of_any(const int *book_ids, int count, RoaringBitmap *members) {
+    if (borrow_index.map == NULL) {
+        return -1;
+    }
+    roaring_free(members);
+    for (int i = 0; i < count; i++) {
+        if (add_row(1, book_ids[i], members) != 0) {
+            return -1;
+        }
+    }
+    return (int)roaring_cardinality(members);
+}
+
+/**
+ * @brief Get the members who have borrowed all of the given books.
+ * 
+ * @param book_ids The book IDs (at least one).
+ * @param count Number of book IDs.
+ * @param members Initialized bitmap; its contents are replaced.
+ * @return int Returns number of members, -1 if no index is open or memory ran out.
+ */
+int borrow_index_members_of_all(const int *book_ids, int count, RoaringBitmap *members) {
+    if (borrow_index.map == NULL) {
+        return -1;
+    }
+    roaring_free(members);
+    if (count <= 0 || add_row(1, book_ids[0], members) != 0) {
+        return count <= 0 ? 0 : -1;
+    }
+
+    for (int i = 1; i < count && members->count > 0; i++) {
+        RoaringView view;
+        int mapped = mapped_row(1, book_ids[i], &view);
+        if (side_bits(&borrow_index.book_delta, book_ids[i]) == NULL) {
+            /* Only the file knows this book: intersect with the mapped containers directly */
+            if (!mapped) {
+                roaring_free(members);
+            } else if (roaring_and_view(members, &view) != 0) {
+                return -1;
+            }
+            continue;
+        }
+        RoaringBitmap borrowers;
+        roaring_init(&borrowers);
+        int failed = add_row(1, book_ids[i], &borrowers) != 0 || roaring_and(members, &borrowers) != 0;
+        roaring_free(&borrowers);
+        if (failed) {
+            return -1;
+        }
+    }
+    return (int)roaring_cardinality(members);
+}
+
+/**
+ * @brief Merge the mapped rows and pending rows of one side, in ID order.
+ */
+static int merge_side(int books, IndexSide *out) {
+    const IndexSide *delta = books ? &borrow_index.book_delta : &borrow_index.member_delta;
+    uint32_t first = books ? borrow_index.member_rows : 0;
+    uint32_t last = first + (books ? borrow_index.book_rows : borrow_index.member_rows);
+    uint32_t r = first;
+    int d = 0;
+
+    while (r < last || d < delta->count) {
+        int id;
+        if (d >= delta->count || (r < last && borrow_index.row_ids[r] <= delta->rows[d].id)) {
+            id = borrow_index.row_ids[r];
+        } else {
+            id = delta->rows[d].id;
+        }
+
+        if (out->count == out->capacity) {
+            int capacity = out->capacity ? out->capacity * 2 : 256;
+            IndexRow *rows = realloc(out->rows, capacity * sizeof(IndexRow));
+            if (rows == NULL) {
+                return -1;
+            }
+            out->rows = rows;
+            out->capacity = capacity;
+        }
+        IndexRow *row = &out->rows[out->count++];
+        row->id = id;
+        roaring_init(&row->bits);
+        if (add_row(books, id, &row->bits) != 0) {
+            return -1;
+        }
+
+        if (r < last && borrow_index.row_ids[r] == id) {
+            r++;
+        }
+        if (d < delta->count && delta->rows[d].id == id) {
+            d++;
+        }
+    }
+    return 0;
+}
+
+/**
+ * @brief Write the open index merged with pending updates to a new file.
+ * 
+ * @param path Output file path (may be the currently opened path).
+ * @return int Returns 0 on success, -1 on failure.
+ */
+int save_borrow_index(const char *path) {
+    if (borrow_index.map == NULL || path == NULL) {
+        return -1;
+    }
+
+    IndexSide members = {0}, books = {0};
+    int result = 0;
+    if (merge_side(0, &members) != 0 || merge_side(1, &books) != 0) {
+        fprintf(stderr, "Out of memory while saving the borrow index\n");
+        result = -1;
+    }
+    if (result == 0) {
+        result = write_index(path, &members, &books, borrow_index.last_loan_id);
+    }
+    free_side(&members);
+    free_side(&books);
+
+    if (result == 0) {
+        result = open_borrow_index(path);
+    }
+    return result;
+}
+
+/**
+ * @brief Write pending updates back to the file the index was mapped from.
+ * 
+ * @return int Returns 1 if the file was written, 0 if nothing was pending, -1 on failure.
+ */
+int flush_borrow_index(void) {
+    if (borrow_index.map == NULL || borrow_index.pending_loans == 0) {
+        return 0;
+    }
+
+    char path[sizeof(borrow_index.path)];
+    snprintf(path, sizeof(path), "%s", borrow_index.path);
+    return save_borrow_index(path) == 0 ? 1 : -1;
+}
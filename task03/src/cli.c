@@ -0,0 +1,690 @@
+#include "cli.h"
+#include "database.h"
+#include "book.h"
+#include "member.h"
+#include "loan.h"
+#include "copy.h"
+#include "rollup.h"
+#include "reminder.h"
+#include "date_utils.h"
+#include "http_server.h"
+#include "result_cache.h"
+#include "export.h"
+#include "marc.h"
+#include "dedup.h"
+#include "recommend.h"
+#include "borrow_index.h"
+#include <signal.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#define CLI_MAX_OPTIONS (CLI_MAX_ARGS / 2)
+#define CLI_ERROR_LEN 128
+
+/**
+ * @brief "--name value" pairs of one command, names without the dashes.
+ */
+typedef struct {
+    int count;
+    const char *names[CLI_MAX_OPTIONS];
+    const char *values[CLI_MAX_OPTIONS];
+} CliOptions;
+
+/**
+ * @brief Outcome of one command.
+ */
+typedef struct {
+    const char *key;               // result field, e.g. "loan_id"
+    long long value;
+    const char *detail_key;        // optional second field, e.g. "rows_per_sec"
+    long long detail;
+    char error[CLI_ERROR_LEN];     // set on failure
+} CliResult;
+
+typedef int (*CliHandler)(sqlite3 *db, const CliOptions *options, CliResult *result);
+
+/**
+ * @brief A command of the command mode.
+ */
+typedef struct {
+    const char *name;
+    const char *options;     // accepted options, space separated
+    const char *usage;
+    CliHandler handler;
+} CliCommand;
+
+/**
+ * @brief Get the value of an option.
+ * 
+ * @return const char* Returns the value, or NULL if the option was not given.
+ */
+static const char *get_option(const CliOptions *options, const char *name) {
+    for (int i = 0; i < options->count; i++) {
+        if (strcmp(options->names[i], name) == 0) {
+            return options->values[i];
+        }
+    }
+    return NULL;
+}
+
+/**
+ * @brief Get an integer option.
+ * 
+ * @param fallback Value used when the option is not given; -1 makes it required.
+ * @return int Returns 0 on success, -1 (with result->error set) if missing or not an integer.
+ */
+static int get_int_option(const CliOptions *options, const char *name, int fallback,
+                          int *value, CliResult *result) {
+    const char *text = get_option(options, name);
+    if (text == NULL) {
+        if (fallback < 0) {
+            snprintf(result->error, sizeof(result->error), "missing --%s", name);
+            return -1;
+        }
+        *value = fallback;
+        return 0;
+    }
+    
+    char *end;
+    long number = strtol(text, &end, 10);
+    if (end == text || *end != '\0' || number < 0 || number > 0x7fffffffL) {
+        snprintf(result->error, sizeof(result->error), "--%s must be a non-negative integer", name);
+        return -1;
+    }
+    *value = (int)number;
+    return 0;
+}
+
+/**
+ * @brief Get a text option that must be given.
+ * 
+ * @return const char* Returns the value, or NULL (with result->error set) if missing.
+ */
+static const char *require_option(const CliOptions *options, const char *name, CliResult *result) {
+    const char *text = get_option(options, name);
+    if (text == NULL) {
+        snprintf(result->error, sizeof(result->error), "missing --%s", name);
+    }
+    return text;
+}
+
+/**
+ * @brief Store an ID returned by the library, or a failure message for -1.
+ */
+static int set_result(CliResult *result, const char *key, int value, const char *failure) {
+    if (value < 0) {
+        snprintf(result->error, sizeof(result->error), "%s", failure);
+        return -1;
+    }
+    result->key = key;
+    result->value = value;
+    return 0;
+}
+
+static int cmd_loan(sqlite3 *db, const CliOptions *options, CliResult *result) {
+    int member_id, book_id, days;
+    if (get_int_option(options, "member", -1, &member_id, result) != 0 ||
+        get_int_option(options, "days", 0, &days, result) != 0) {
+        return -1;
+    }
+    
+    const char *barcode = get_option(options, "barcode");
+    if (barcode != NULL) {
+        return set_result(result, "loan_id", loan_by_barcode(db, barcode, member_id, days), "loan failed");
+    }
+    if (get_int_option(options, "book", -1, &book_id, result) != 0) {
+        return -1;
+    }
+    return set_result(result, "loan_id", process_loan(db, book_id, member_id, days), "loan failed");
+}
+
+static int cmd_return(sqlite3 *db, const CliOptions *options, CliResult *result) {
+    const char *barcode = get_option(options, "barcode");
+    if (barcode != NULL) {
+        return set_result(result, "return_id", return_by_barcode(db, barcode), "return failed");
+    }
+    
+    int loan_id;
+    if (get_int_option(options, "loan", -1, &loan_id, result) != 0) {
+        return -1;
+    }
+    return set_result(result, "return_id", process_return(db, loan_id), "return failed");
+}
+
+static int cmd_add_book(sqlite3 *db, const CliOptions *options, CliResult *result) {
+    int year, quantity;
+    const char *title = require_option(options, "title", result);
+    if (title == NULL ||
+        get_int_option(options, "year", 0, &year, result) != 0 ||
+        get_int_option(options, "quantity", 1, &quantity, result) != 0) {
+        return -1;
+    }
+    
+    const char *author = get_option(options, "author");
+    const char *publisher = get_option(options, "publisher");
+    const char *isbn = get_option(options, "isbn");
+    const char *genre = get_option(options, "genre");
+    
+    if (add_book(title, author ? author : "", publisher ? publisher : "", year,
+                 isbn ? isbn : "", genre ? genre : "", quantity) != 0) {
+        return set_result(result, "book_id", -1, "add-book failed");
+    }
+    return set_result(result, "book_id", (int)sqlite3_last_insert_rowid(db), "add-book failed");
+}
+
+static int cmd_add_member(sqlite3 *db, const CliOptions *options, CliResult *result) {
+    const char *name = require_option(options, "name", result);
+    if (name == NULL) {
+        return -1;
+    }
+    
+    const char *phone = get_option(options, "phone");
+    const char *address = get_option(options, "address");
+    return set_result(result, "member_id", add_member(db, name, phone ? phone : "", address ? address : ""),
+                      "add-member failed");
+}
+
+static int cmd_add_copy(sqlite3 *db, const CliOptions *options, CliResult *result) {
+    int book_id;
+    const char *barcode = require_option(options, "barcode", result);
+    if (barcode == NULL || get_int_option(options, "book", -1, &book_id, result) != 0) {
+        return -1;
+    }
+    return set_result(result, "copy_id", add_copy(db, book_id, barcode), "add-copy failed");
+}
+
+static int cmd_can_borrow(sqlite3 *db, const CliOptions *options, CliResult *result) {
+    int member_id;
+    if (get_int_option(options, "member", -1, &member_id, result) != 0) {
+        return -1;
+    }
+    return set_result(result, "can_borrow", can_member_borrow(db, member_id), "member not found");
+}
+
+static int cmd_rollups(sqlite3 *db, const CliOptions *options, CliResult *result) {
+    (void)options;
+    return set_result(result, "rows", update_circulation_rollups(db), "rollup update failed");
+}
+
+static int cmd_reminders(sqlite3 *db, const CliOptions *options, CliResult *result) {
+    int today = get_today_day();
+    int since = today;
+    
+    // Catch up on days a previous run missed; the outbox drops repeats
+    const char *since_date = get_option(options, "since");
+    if (since_date != NULL && (date_to_day(since_date, &since) != 0 || since > today)) {
+        snprintf(result->error, sizeof(result->error), "--since must be a past YYYY-MM-DD date");
+        return -1;
+    }
+    
+    int fired = -1;
+    if (load_reminder_scheduler(db, since) >= 0) {
+        fired = advance_reminders(db, today, NULL, NULL);
+    }
+    free_reminder_scheduler();
+    return set_result(result, "fired", fired, "reminder scheduling failed");
+}
+
+static int cmd_export(sqlite3 *db, const CliOptions *options, CliResult *result) {
+    const char *table = require_option(options, "table", result);
+    const char *path = table != NULL ? require_option(options, "output", result) : NULL;
+    if (path == NULL) {
+        return -1;
+    }
+    int format = export_parse_format(get_option(options, "format") != NULL ? get_option(options, "format") : "csv");
+    if (format < 0) {
+        snprintf(result->error, sizeof(result->error), "--format must be csv or jsonl");
+        return -1;
+    }
+    
+    // A ".gz" output file is compressed
+    size_t length = strlen(path);
+    int gzip = length > 3 && strcmp(path + length - 3, ".gz") == 0;
+    if (gzip && !export_gzip_available()) {
+        snprintf(result->error, sizeof(result->error), "gzip output needs a build with zlib");
+        return -1;
+    }
+    
+    ExportStats stats;
+    long long rows = export_table_to_path(db, table, (ExportFormat)format, gzip, path, &stats);
+    if (rows < 0) {
+        snprintf(result->error, sizeof(result->error), "export of %.32s failed", table);
+        return -1;
+    }
+    result->key = "rows";
+    result->value = rows;
+    result->detail_key = "rows_per_sec";
+    result->detail = (long long)stats.rows_per_second;
+    return 0;
+}
+
+static int cmd_import_marc(sqlite3 *db, const CliOptions *options, CliResult *result) {
+    int threads;
+    const char *path = require_option(options, "file", result);
+    if (path == NULL || get_int_option(options, "threads", 0, &threads, result) != 0) {
+        return -1;
+    }
+    if (threads == 0) {
+        threads = (int)sysconf(_SC_NPROCESSORS_ONLN);    // one parser per core
+    }
+    
+    MarcLoadStats stats;
+    if (load_marc_file(db, path, threads, &stats) < 0) {
+        snprintf(result->error, sizeof(result->error), "MARC import failed");
+        return -1;
+    }
+    result->key = "books";
+    result->value = stats.inserted;
+    result->detail_key = "records_per_min";
+    result->detail = (long long)stats.records_per_minute;
+    return 0;
+}
+
+static int cmd_dedup(sqlite3 *db, const CliOptions *options, CliResult *result) {
+    int threshold, merge;
+    if (get_int_option(options, "threshold", DEDUP_DEFAULT_THRESHOLD, &threshold, result) != 0 ||
+        get_int_option(options, "merge", 0, &merge, result) != 0) {
+        return -1;
+    }
+    
+    DedupResult clusters;
+    int found = find_duplicate_books(db, threshold, &clusters);
+    if (found < 0) {
+        snprintf(result->error, sizeof(result->error), "duplicate search failed");
+        return -1;
+    }
+    int removed = merge ? merge_duplicate_books(db, &clusters) : 0;
+    free_dedup_result(&clusters);
+    if (removed < 0) {
+        snprintf(result->error, sizeof(result->error), "merge of duplicates failed");
+        return -1;
+    }
+    result->key = "clusters";
+    result->value = found;
+    result->detail_key = "merged";
+    result->detail = removed;
+    return 0;
+}
+
+static const CliCommand commands[] = {
+    {"loan", "book member days barcode", "loan (--book ID | --barcode CODE) --member ID [--days N]", cmd_loan},
+    {"return", "loan barcode", "return (--loan ID | --barcode CODE)", cmd_return},
+    {"add-book", "title author publisher year isbn genre quantity",
+     "add-book --title T [--author A] [--publisher P] [--year Y] [--isbn I] [--genre G] [--quantity N]",
+     cmd_add_book},
+    {"add-member", "name phone address", "add-member --name N [--phone P] [--address A]", cmd_add_member},
+    {"add-copy", "book barcode", "add-copy --book ID --barcode CODE", cmd_add_copy},
+    {"can-borrow", "member", "can-borrow --member ID", cmd_can_borrow},
+    {"rollups", "", "rollups", cmd_rollups},
+    {"reminders", "since", "reminders [--since YYYY-MM-DD]", cmd_reminders},
+    {"export", "table format output",
+     "export --table books|members|loans|returns --output FILE[.gz] [--format csv|jsonl]", cmd_export},
+    {"import-marc", "file threads", "import-marc --file FILE.mrc [--threads N]", cmd_import_marc},
+    {"dedup", "threshold merge", "dedup [--threshold PERCENT] [--merge 0|1]", cmd_dedup},
+};
+
+#define COMMAND_COUNT ((int)(sizeof(commands) / sizeof(commands[0])))
+
+static const CliCommand *find_command(const char *name) {
+    for (int i = 0; i < COMMAND_COUNT; i++) {
+        if (strcmp(commands[i].name, name) == 0) {
+            return &commands[i];
+        }
+    }
+    return NULL;
+}
+
+/**
+ * @brief Check whether a word appears in a space separated list.
+ */
+static int option_accepted(const char *list, const char *name) {
+    size_t length = strlen(name);
+    const char *p = list;
+    while ((p = strstr(p, name)) != NULL) {
+        if ((p == list || p[-1] == ' ') && (p[length] == ' ' || p[length] == '\0')) {
+            return 1;
+        }
+        p += length;
+    }
+    return 0;
+}
+
+/**
+ * @brief Write text as a JSON string literal.
+ */
+static void write_json_string(FILE *out, const char *text) {
+    fputc('"', out);
+    for (const unsigned char *p = (const unsigned char *)text; *p != '\0'; p++) {
+        switch (*p) {
+            case '"':  fputs("\\\"", out); break;
+            case '\\': fputs("\\\\", out); break;
+            case '\n': fputs("\\n", out); break;
+            case '\r': fputs("\\r", out); break;
+            case '\t': fputs("\\t", out); break;
+            default:
+                if (*p < 0x20) {
+                    fprintf(out, "\\u%04x", *p);
+                } else {
+                    fputc(*p, out);
+                }
+        }
+    }
+    fputc('"', out);
+}
+
+/**
+ * @brief Write the result line of one command.
+ */
+static void write_result(FILE *out, int line, const char *command, const CliResult *result, int ok) {
+    fputc('{', out);
+    if (line > 0) {
+        fprintf(out, "\"line\":%d,", line);
+    }
+    fputs("\"command\":", out);
+    write_json_string(out, command);
+    if (ok) {
+        fputs(",\"status\":\"ok\"", out);
+        if (result->key != NULL) {
+            fprintf(out, ",\"%s\":%lld", result->key, result->value);
+        }
+        if (result->detail_key != NULL) {
+            fprintf(out, ",\"%s\":%lld", result->detail_key, result->detail);
+        }
+    } else {
+        fputs(",\"status\":\"error\",\"error\":", out);
+        write_json_string(out, result->error);
+    }
+    fputs("}\n", out);
+}
+
+int cli_run_command(sqlite3 *db, int argc, char **argv, int line, FILE *out) {
+    CliResult result = {NULL, 0, NULL, 0, ""};
+    
+    if (argc < 1) {
+        snprintf(result.error, sizeof(result.error), "missing command");
+        write_result(out, line, "", &result, 0);
+        return -1;
+    }
+    
+    const CliCommand *command = find_command(argv[0]);
+    if (command == NULL) {
+        snprintf(result.error, sizeof(result.error), "unknown command");
+        write_result(out, line, argv[0], &result, 0);
+        return -1;
+    }
+    
+    // Collect "--name value" pairs
+    CliOptions options;
+    options.count = 0;
+    for (int i = 1; i < argc; i += 2) {
+        const char *name = argv[i];
+        if (strncmp(name, "--", 2) != 0 || !option_accepted(command->options, name + 2)) {
+            snprintf(result.error, sizeof(result.error), "unknown option %.64s, usage: %s", name, command->usage);
+            write_result(out, line, command->name, &result, 0);
+            return -1;
+        }
+        if (i + 1 >= argc || options.count == CLI_MAX_OPTIONS) {
+            snprintf(result.error, sizeof(result.error), "missing value for %.64s", name);
+            write_result(out, line, command->name, &result, 0);
+            return -1;
+        }
+        options.names[options.count] = name + 2;
+        options.values[options.count] = argv[i + 1];
+        options.count++;
+    }
+    
+    int ok = command->handler(db, &options, &result) == 0;
+    write_result(out, line, command->name, &result, ok);
+    return ok ? 0 : -1;
+}
+
+int cli_split_line(char *line, char **argv, int max_args) {
+    int argc = 0;
+    char *src = line;
+    
+    while (1) {
+        while (*src == ' ' || *src == '\t' || *src == '\r' || *src == '\n') {
+            src++;
+        }
+        if (*src == '\0' || *src == '#') {
+            return argc;
+        }
+        if (argc == max_args) {
+            return -1;
+        }
+        
+        // Copy the argument over itself, dropping the quotes
+        char *dst = src;
+        argv[argc++] = dst;
+        int quoted = 0;
+        while (*src != '\0' && (quoted || (*src != ' ' && *src != '\t' && *src != '\r' && *src != '\n'))) {
+            if (*src == '"') {
+                quoted = !quoted;
+                src++;
+            } else {
+                *dst++ = *src++;
+            }
+        }
+        if (quoted) {
+            return -1;
+        }
+        
+        int at_end = *src == '\0';
+        *dst = '\0';
+        if (at_end) {
+            return argc;
+        }
+        src++;
+    }
+}
+
+int cli_run_script(sqlite3 *db, FILE *in, int shared_transaction, FILE *out, CliStats *stats) {
+    CliStats totals = {0, 0, 0, 0};
+    char buffer[CLI_MAX_LINE];
+    char *argv[CLI_MAX_ARGS];
+    int line = 0;
+    DbRetryStats waits_before, waits_after;
+    get_retry_stats(&waits_before);
+    
+    if (shared_transaction && exec_with_retry(db, "BEGIN IMMEDIATE;") != SQLITE_OK) {
+        fprintf(stderr, "Failed to begin transaction: %s\n", sqlite3_errmsg(db));
+        return -1;
+    }
+    
+    while (fgets(buffer, sizeof(buffer), in) != NULL) {
+        line++;
+        
+        int rc;
+        size_t length = strlen(buffer);
+        if (length == sizeof(buffer) - 1 && buffer[length - 1] != '\n' && !feof(in)) {
+            // Skip the rest of an over-long line
+            int c;
+            while ((c = fgetc(in)) != '\n' && c != EOF);
+            CliResult result = {NULL, 0, NULL, 0, "line too long"};
+            write_result(out, line, "", &result, 0);
+            rc = -1;
+        } else {
+            int argc = cli_split_line(buffer, argv, CLI_MAX_ARGS);
+            if (argc == 0) {
+                continue;
+            }
+            if (argc < 0) {
+                CliResult result = {NULL, 0, NULL, 0, "unterminated quote or too many arguments"};
+                write_result(out, line, "", &result, 0);
+                rc = -1;
+            } else {
+                rc = cli_run_command(db, argc, argv, line, out);
+            }
+        }
+        
+        totals.commands++;
+        if (rc == 0) {
+            totals.succeeded++;
+        } else {
+            totals.failed++;
+            if (shared_transaction) {
+                break;
+            }
+        }
+    }
+    
+    if (shared_transaction) {
+        if (totals.failed == 0 && exec_with_retry(db, "COMMIT;") != SQLITE_OK) {
+            fprintf(stderr, "Failed to commit transaction: %s\n", sqlite3_errmsg(db));
+            totals.failed++;
+        }
+        if (totals.failed > 0) {
+            sqlite3_exec(db, "ROLLBACK;", NULL, NULL, NULL);
+            totals.rolled_back = 1;
+            // The barcode index saw the rolled back loans
+            free_copy_index();
+        } else {
+            // Fold the committed loans into the open borrow history, if any
+            catch_up_recommendations(db);
+            catch_up_borrow_index(db);
+        }
+    }
+    
+    fprintf(out, "{\"status\":\"done\",\"commands\":%d,\"succeeded\":%d,\"failed\":%d",
+            totals.commands, totals.succeeded, totals.failed);
+    if (shared_transaction) {
+        fprintf(out, ",\"transaction\":\"%s\"", totals.rolled_back ? "rolled_back" : "committed");
+    }
+    // Time spent waiting for other processes' locks, when there was any
+    get_retry_stats(&waits_after);
+    if (waits_after.waits > waits_before.waits) {
+        fprintf(out, ",\"busy_waits\":%ld,\"busy_wait_ms\":%.1f", waits_after.waits - waits_before.waits,
+                (waits_after.wait_us - waits_before.wait_us) / 1000.0);
+    }
+    fputs("}\n", out);
+    
+    if (stats != NULL) {
+        *stats = totals;
+    }
+    return totals.failed == 0 ? 0 : -1;
+}
+
+/**
+ * @brief Print the command mode usage to stderr.
+ */
+static void print_usage(const char *program) {
+    fprintf(stderr, "Usage: %s run [--transaction] SCRIPT|-\n", program);
+    fprintf(stderr, "       %s serve [--port N] [--workers N] [--address A]\n", program);
+    for (int i = 0; i < COMMAND_COUNT; i++) {
+        fprintf(stderr, "       %s %s\n", program, commands[i].usage);
+    }
+}
+
+/**
+ * @brief Run the HTTP server until SIGINT or SIGTERM.
+ */
+static int serve(const char *program, int argc, char **argv) {
+    CliResult result = {NULL, 0, NULL, 0, ""};
+    CliOptions options;
+    options.count = 0;
+    for (int i = 2; i < argc; i += 2) {
+        if (strncmp(argv[i], "--", 2) != 0 || !option_accepted("port workers address", argv[i] + 2) ||
+            i + 1 >= argc || options.count == CLI_MAX_OPTIONS) {
+            print_usage(program);
+            return CLI_EXIT_USAGE;
+        }
+        options.names[options.count] = argv[i] + 2;
+        options.values[options.count] = argv[i + 1];
+        options.count++;
+    }
+    
+    HttpServerConfig config = {DB_PATH, get_option(&options, "address"), 0, 0, RESULT_CACHE_DEFAULT_BUDGET};
+    if (get_int_option(&options, "port", HTTP_DEFAULT_PORT, &config.port, &result) != 0 ||
+        get_int_option(&options, "workers", HTTP_DEFAULT_WORKERS, &config.workers, &result) != 0) {
+        fprintf(stderr, "%s\n", result.error);
+        return CLI_EXIT_USAGE;
+    }
+    
+    // Create or migrate the schema; the workers open their own connections
+    int rc = init_database();
+    if (rc == 0) {
+        sqlite3 *db = get_db_connection();
+        rc = init_loan_tables(db) == 0 && init_member_table(db) == 0 ? 0 : -1;
+        close_database();
+    }
+    if (rc != 0) {
+        return CLI_EXIT_FAILED;
+    }
+    
+    // Block the stop signals before the workers start so only sigwait() sees them
+    sigset_t signals;
+    sigemptyset(&signals);
+    sigaddset(&signals, SIGINT);
+    sigaddset(&signals, SIGTERM);
+    pthread_sigmask(SIG_BLOCK, &signals, NULL);
+    
+    if (http_server_start(&config) != 0) {
+        fprintf(stderr, "Cannot start the HTTP server\n");
+        return CLI_EXIT_FAILED;
+    }
+    printf("{\"status\":\"listening\",\"port\":%d}\n", http_server_port());
+    fflush(stdout);
+    
+    int signal_number;
+    sigwait(&signals, &signal_number);
+    
+    HttpServerStats stats;
+    http_server_stats(&stats);
+    http_server_stop();
+    printf("{\"status\":\"stopped\",\"connections\":%ld,\"requests\":%ld,\"errors\":%ld,"
+           "\"cache_hits\":%ld,\"cache_misses\":%ld}\n",
+           stats.connections, stats.requests, stats.errors, stats.cache_hits, stats.cache_misses);
+    return CLI_EXIT_OK;
+}
+
+int cli_main(int argc, char **argv) {
+    const char *program = argc > 0 ? argv[0] : "library";
+    if (argc >= 2 && strcmp(argv[1], "serve") == 0) {
+        set_quiet_mode(1);
+        return serve(program, argc, argv);
+    }
+    
+    int run_script = argc >= 2 && strcmp(argv[1], "run") == 0;
+    int shared_transaction = run_script && argc == 4 && strcmp(argv[2], "--transaction") == 0;
+    
+    if (argc < 2 || (run_script && argc != 3 + shared_transaction) ||
+        (!run_script && find_command(argv[1]) == NULL)) {
+        print_usage(program);
+        return CLI_EXIT_USAGE;
+    }
+    
+    FILE *script = NULL;
+    if (run_script) {
+        const char *path = argv[argc - 1];
+        script = strcmp(path, "-") == 0 ? stdin : fopen(path, "r");
+        if (script == NULL) {
+            fprintf(stderr, "Cannot open script: %s\n", path);
+            return CLI_EXIT_USAGE;
+        }
+    }
+    
+    // Results only on stdout, written in large blocks
+    setvbuf(stdout, NULL, _IOFBF, CLI_OUTPUT_BUFFER);
+    set_quiet_mode(1);
+    
+    int rc = -1;
+    if (init_database() == 0) {
+        sqlite3 *db = get_db_connection();
+        if (init_loan_tables(db) == 0 && init_member_table(db) == 0) {
+            if (run_script) {
+                rc = cli_run_script(db, script, shared_transaction, stdout, NULL);
+            } else {
+                rc = cli_run_command(db, argc - 1, argv + 1, 0, stdout);
+            }
+        }
+        free_copy_index();
+        close_database();
+    }
+    
+    if (script != NULL && script != stdin) {
+        fclose(script);
+    }
+    fflush(stdout);
+    return rc == 0 ? CLI_EXIT_OK : CLI_EXIT_FAILED;
+}
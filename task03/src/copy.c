@@ -0,0 +1,619 @@
+#include "copy.h"
+#include "database.h"
+#include "loan.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+#define INITIAL_SLOT_CAPACITY 256
+
+/**
+ * @brief One copy in the in-memory index (barcode text lives in the arena).
+ */
+typedef struct {
+    int copy_id;
+    int book_id;
+    int active_loan_id;
+    uint32_t barcode_offset;
+} CopySlot;
+
+/**
+ * @brief Contiguous run of slots holding the copies of one title.
+ */
+typedef struct {
+    int book_id;
+    int first_slot;
+    int slot_count;
+} TitleRange;
+
+typedef struct {
+    CopySlot *slots;
+    int slot_count;
+    int slot_capacity;
+    uint64_t *available_bits;   // bit i set = slot i is on the shelf
+    char *barcodes;             // NUL-terminated barcodes, back to back
+    size_t barcode_used;
+    size_t barcode_capacity;
+    int32_t *buckets;           // open addressing, slot index or -1
+    uint32_t bucket_mask;
+    TitleRange *titles;         // sorted by book_id
+    int title_count;
+    int title_capacity;
+    sqlite3 *db;                // connection the index was loaded through
+    sqlite3_stmt *version_stmt; // PRAGMA data_version on db
+    long long data_version;     // as of the load
+} CopyIndex;
+
+static CopyIndex *copy_index = NULL;
+
+/**
+ * @brief FNV-1a hash of a barcode.
+ */
+static uint32_t hash_barcode(const char *barcode) {
+    uint32_t hash = 2166136261u;
+    while (*barcode) {
+        hash ^= (unsigned char)*barcode++;
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+static const char *slot_barcode(const CopyIndex *index, int slot) {
+    return index->barcodes + index->slots[slot].barcode_offset;
+}
+
+static int is_available(const CopyIndex *index, int slot) {
+    return (int)((index->available_bits[slot / 64] >> (slot % 64)) & 1u);
+}
+
+static void set_available(CopyIndex *index, int slot, int available) {
+    uint64_t mask = (uint64_t)1 << (slot % 64);
+    if (available) {
+        index->available_bits[slot / 64] |= mask;
+    } else {
+        index->available_bits[slot / 64] &= ~mask;
+    }
+}
+
+/**
+ * @brief Find the slot of a barcode.
+ * 
+ * @return int Returns slot index, -1 if not found.
+ */
+static int lookup_slot(const CopyIndex *index, const char *barcode) {
+    uint32_t pos = hash_barcode(barcode) & index->bucket_mask;
+    while (index->buckets[pos] >= 0) {
+        int slot = index->buckets[pos];
+        if (strcmp(slot_barcode(index, slot), barcode) == 0) {
+            return slot;
+        }
+        pos = (pos + 1) & index->bucket_mask;
+    }
+    return -1;
+}
+
+/**
+ * @brief Resize the bucket table to hold at least twice the slot capacity.
+ */
+static int rehash(CopyIndex *index) {
+    uint32_t size = 16;
+    while (size < (uint32_t)index->slot_capacity * 2) {
+        size <<= 1;
+    }
+
+    int32_t *buckets = malloc(size * sizeof(int32_t));
+    if (buckets == NULL) {
+        return -1;
+    }
+    memset(buckets, 0xff, size * sizeof(int32_t));
+
+    for (int slot = 0; slot < index->slot_count; slot++) {
+        uint32_t pos = hash_barcode(slot_barcode(index, slot)) & (size - 1);
+        while (buckets[pos] >= 0) {
+            pos = (pos + 1) & (size - 1);
+        }
+        buckets[pos] = slot;
+    }
+
+    free(index->buckets);
+    index->buckets = buckets;
+    index->bucket_mask = size - 1;
+    return 0;
+}
+
+static int grow_slots(CopyIndex *index) {
+    int capacity = index->slot_capacity ? index->slot_capacity * 2 : INITIAL_SLOT_CAPACITY;
+
+    CopySlot *slots = realloc(index->slots, (size_t)capacity * sizeof(CopySlot));
+    if (slots == NULL) {
+        return -1;
+    }
+    index->slots = slots;
+
+    size_t old_words = (size_t)index->slot_capacity / 64;
+    size_t new_words = (size_t)capacity / 64;
+    uint64_t *bits = realloc(index->available_bits, new_words * sizeof(uint64_t));
+    if (bits == NULL) {
+        return -1;
+    }
+    memset(bits + old_words, 0, (new_words - old_words) * sizeof(uint64_t));
+    index->available_bits = bits;
+
+    index->slot_capacity = capacity;
+    return rehash(index);
+}
+
+/**
+ * @brief Append a copy to the index.
+ * 
+ * Copies must arrive in book_id order so that every title stays a contiguous
+ * run of slots.
+ * 
+ * @return int Returns 0 on success, 1 if the copy is out of order, -1 on failure.
+ */
+static int append_copy(CopyIndex *index, int copy_id, int book_id, const char *barcode,
+                       int status, int active_loan_id) {
+    TitleRange *last = index->title_count > 0 ? &index->titles[index->title_count - 1] : NULL;
+    if (last != NULL && book_id < last->book_id) {
+        return 1;
+    }
+
+    if (index->slot_count == index->slot_capacity && grow_slots(index) != 0) {
+        return -1;
+    }
+
+    size_t len = strlen(barcode) + 1;
+    if (index->barcode_used + len > index->barcode_capacity) {
+        size_t capacity = index->barcode_capacity ? index->barcode_capacity * 2 : 4096;
+        while (capacity < index->barcode_used + len) {
+            capacity *= 2;
+        }
+        char *barcodes = realloc(index->barcodes, capacity);
+        if (barcodes == NULL) {
+            return -1;
+        }
+        index->barcodes = barcodes;
+        index->barcode_capacity = capacity;
+    }
+
+    if (last == NULL || last->book_id != book_id) {
+        if (index->title_count == index->title_capacity) {
+            int capacity = index->title_capacity ? index->title_capacity * 2 : 64;
+            TitleRange *titles = realloc(index->titles, (size_t)capacity * sizeof(TitleRange));
+            if (titles == NULL) {
+                return -1;
+            }
+            index->titles = titles;
+            index->title_capacity = capacity;
+        }
+        last = &index->titles[index->title_count++];
+        last->book_id = book_id;
+        last->first_slot = index->slot_count;
+        last->slot_count = 0;
+    }
+
+    int slot = index->slot_count++;
+    CopySlot *entry = &index->slots[slot];
+    entry->copy_id = copy_id;
+    entry->book_id = book_id;
+    entry->active_loan_id = active_loan_id;
+    entry->barcode_offset = (uint32_t)index->barcode_used;
+    memcpy(index->barcodes + index->barcode_used, barcode, len);
+    index->barcode_used += len;
+    last->slot_count++;
+    set_available(index, slot, status == COPY_AVAILABLE);
+
+    uint32_t pos = hash_barcode(barcode) & index->bucket_mask;
+    while (index->buckets[pos] >= 0) {
+        pos = (pos + 1) & index->bucket_mask;
+    }
+    index->buckets[pos] = slot;
+
+    return 0;
+}
+
+static const TitleRange *find_title(const CopyIndex *index, int book_id) {
+    int lo = 0, hi = index->title_count - 1;
+    while (lo <= hi) {
+        int mid = lo + (hi - lo) / 2;
+        if (index->titles[mid].book_id == book_id) {
+            return &index->titles[mid];
+        }
+        if (index->titles[mid].book_id < book_id) {
+            lo = mid + 1;
+        } else {
+            hi = mid - 1;
+        }
+    }
+    return NULL;
+}
+
+static void destroy_index(CopyIndex *index) {
+    if (index == NULL) {
+        return;
+    }
+    free(index->slots);
+    free(index->available_bits);
+    free(index->barcodes);
+    free(index->buckets);
+    free(index->titles);
+    sqlite3_finalize(index->version_stmt);
+    free(index);
+}
+
+/**
+ * @brief Read PRAGMA data_version, which changes when another connection commits.
+ */
+static int read_data_version(sqlite3 *db, sqlite3_stmt **stmt, long long *version) {
+    if (*stmt == NULL && sqlite3_prepare_v2(db, "PRAGMA data_version;", -1, stmt, NULL) != SQLITE_OK) {
+        fprintf(stderr, "Failed to prepare statement: %s\n", sqlite3_errmsg(db));
+        return -1;
+    }
+    int rc = sqlite3_step(*stmt);
+    *version = sqlite3_column_int64(*stmt, 0);
+    sqlite3_reset(*stmt);
+    if (rc != SQLITE_ROW) {
+        fprintf(stderr, "Failed to read data version: %s\n", sqlite3_errmsg(db));
+        return -1;
+    }
+    return 0;
+}
+
+int load_copy_index(sqlite3 *db) {
+    if (db == NULL) {
+        fprintf(stderr, "Database connection is NULL\n");
+        return -1;
+    }
+
+    const char *sql = "SELECT c.copy_id, c.barcode, c.book_id, c.status, "
+                      "(SELECT l.loan_id FROM Loans l WHERE l.copy_id = c.copy_id AND l.is_returned = 0) "
+                      "FROM Copies c ORDER BY c.book_id, c.copy_id;";
+
+    sqlite3_stmt *stmt;
+    if (sqlite3_prepare_v2(db, sql, -1, &stmt, NULL) != SQLITE_OK) {
+        fprintf(stderr, "Failed to prepare statement: %s\n", sqlite3_errmsg(db));
+        return -1;
+    }
+
+    CopyIndex *index = calloc(1, sizeof(CopyIndex));
+    if (index == NULL || grow_slots(index) != 0) {
+        fprintf(stderr, "Out of memory while loading copy index\n");
+        destroy_index(index);
+        sqlite3_finalize(stmt);
+        return -1;
+    }
+
+    /* Read before the rows: a commit in between only causes one more reload */
+    index->db = db;
+    if (read_data_version(db, &index->version_stmt, &index->data_version) != 0) {
+        destroy_index(index);
+        sqlite3_finalize(stmt);
+        return -1;
+    }
+
+    int rc;
+    while ((rc = sqlite3_step(stmt)) == SQLITE_ROW) {
+        const char *barcode = (const char *)sqlite3_column_text(stmt, 1);
+        if (append_copy(index,
+                        sqlite3_column_int(stmt, 0),
+                        sqlite3_column_int(stmt, 2),
+                        barcode ? barcode : "",
+                        sqlite3_column_int(stmt, 3),
+                        sqlite3_column_int(stmt, 4)) != 0) {
+            fprintf(stderr, "Out of memory while loading copy index\n");
+            destroy_index(index);
+            sqlite3_finalize(stmt);
+            return -1;
+        }
+    }
+
+    sqlite3_finalize(stmt);
+
+    if (rc != SQLITE_DONE) {
+        fprintf(stderr, "Error during query execution: %s\n", sqlite3_errmsg(db));
+        destroy_index(index);
+        return -1;
+    }
+
+    destroy_index(copy_index);
+    copy_index = index;
+    return index->slot_count;
+}
+
+void free_copy_index(void) {
+    destroy_index(copy_index);
+    copy_index = NULL;
+}
+
+/**
+ * @brief Load the index, or reload it if another connection committed since the load.
+ * 
+ * Other processes (the CLI, the HTTP server) add and lend copies in the
+ * same database file; their commits change PRAGMA data_version.
+ * 
+ * @return int Returns 0 if the index was current, 1 if it was (re)loaded, -1 on failure.
+ */
+static int sync_copy_index(sqlite3 *db) {
+    if (copy_index != NULL && copy_index->db == db) {
+        long long version;
+        if (read_data_version(db, &copy_index->version_stmt, &version) != 0) {
+            return -1;
+        }
+        if (version == copy_index->data_version) {
+            return 0;
+        }
+    }
+    if (load_copy_index(db) < 0) {
+        free_copy_index();
+        return -1;
+    }
+    return 1;
+}
+
+int find_copy_by_barcode(const char *barcode, Copy *copy) {
+    if (copy_index == NULL || barcode == NULL || copy == NULL) {
+        return -1;
+    }
+
+    int slot = lookup_slot(copy_index, barcode);
+    if (slot < 0) {
+        return -1;
+    }
+
+    const CopySlot *entry = &copy_index->slots[slot];
+    copy->copy_id = entry->copy_id;
+    copy->book_id = entry->book_id;
+    strncpy(copy->barcode, slot_barcode(copy_index, slot), MAX_BARCODE_LEN - 1);
+    copy->barcode[MAX_BARCODE_LEN - 1] = '\0';
+    copy->status = is_available(copy_index, slot) ? COPY_AVAILABLE : COPY_ON_LOAN;
+    copy->active_loan_id = entry->active_loan_id;
+    return 0;
+}
+
+int count_available_copies(int book_id) {
+    if (copy_index == NULL) {
+        return -1;
+    }
+
+    const TitleRange *title = find_title(copy_index, book_id);
+    if (title == NULL) {
+        return 0;
+    }
+
+    int count = 0;
+    int slot = title->first_slot;
+    int end = title->first_slot + title->slot_count;
+
+    // Count bit by bit up to a word boundary, then a whole word at a time
+    while (slot < end && slot % 64 != 0) {
+        count += is_available(copy_index, slot++);
+    }
+    while (slot + 64 <= end) {
+        count += __builtin_popcountll(copy_index->available_bits[slot / 64]);
+        slot += 64;
+    }
+    while (slot < end) {
+        count += is_available(copy_index, slot++);
+    }
+
+    return count;
+}
+
+int find_available_copy(sqlite3 *db, int book_id) {
+    // Called inside the loan's write transaction, so a synced index is the table's state
+    if (copy_index != NULL && sync_copy_index(db) >= 0) {
+        const TitleRange *title = find_title(copy_index, book_id);
+        if (title == NULL) {
+            return 0;
+        }
+        for (int slot = title->first_slot; slot < title->first_slot + title->slot_count; slot++) {
+            if (is_available(copy_index, slot)) {
+                return copy_index->slots[slot].copy_id;
+            }
+        }
+        return 0;
+    }
+
+    const char *sql = "SELECT copy_id FROM Copies WHERE book_id = ? AND status = ? ORDER BY copy_id LIMIT 1;";
+
+    sqlite3_stmt *stmt;
+    if (sqlite3_prepare_v2(db, sql, -1, &stmt, NULL) != SQLITE_OK) {
+        fprintf(stderr, "Failed to prepare statement: %s\n", sqlite3_errmsg(db));
+        return -1;
+    }
+
+    sqlite3_bind_int(stmt, 1, book_id);
+    sqlite3_bind_int(stmt, 2, COPY_AVAILABLE);
+
+    int rc = sqlite3_step(stmt);
+    int copy_id = rc == SQLITE_ROW ? sqlite3_column_int(stmt, 0) : 0;
+    sqlite3_finalize(stmt);
+
+    if (rc != SQLITE_ROW && rc != SQLITE_DONE) {
+        fprintf(stderr, "Error during query execution: %s\n", sqlite3_errmsg(db));
+        return -1;
+    }
+    return copy_id;
+}
+
+int set_copy_status(sqlite3 *db, int copy_id, int from_status, int to_status) {
+    const char *sql = "UPDATE Copies SET status = ? WHERE copy_id = ? AND status = ?;";
+
+    sqlite3_stmt *stmt;
+    if (sqlite3_prepare_v2(db, sql, -1, &stmt, NULL) != SQLITE_OK) {
+        fprintf(stderr, "Failed to prepare statement: %s\n", sqlite3_errmsg(db));
+        return -1;
+    }
+
+    sqlite3_bind_int(stmt, 1, to_status);
+    sqlite3_bind_int(stmt, 2, copy_id);
+    sqlite3_bind_int(stmt, 3, from_status);
+
+    int rc = sqlite3_step(stmt);
+    sqlite3_finalize(stmt);
+
+    if (rc != SQLITE_DONE) {
+        fprintf(stderr, "Failed to update copy status: %s\n", sqlite3_errmsg(db));
+        return -1;
+    }
+
+    if (sqlite3_changes(db) == 0) {
+        fprintf(stderr, "Copy %d is not in the expected state\n", copy_id);
+        return -1;
+    }
+
+    return 0;
+}
+
+void update_copy_index(int book_id, int copy_id, int status, int loan_id) {
+    if (copy_index == NULL) {
+        return;
+    }
+
+    const TitleRange *title = find_title(copy_index, book_id);
+    if (title == NULL) {
+        return;
+    }
+
+    for (int slot = title->first_slot; slot < title->first_slot + title->slot_count; slot++) {
+        if (copy_index->slots[slot].copy_id == copy_id) {
+            copy_index->slots[slot].active_loan_id = loan_id;
+            set_available(copy_index, slot, status == COPY_AVAILABLE);
+            return;
+        }
+    }
+}
+
+int add_copy(sqlite3 *db, int book_id, const char *barcode) {
+    if (db == NULL) {
+        fprintf(stderr, "Database connection is NULL\n");
+        return -1;
+    }
+
+    if (barcode == NULL || barcode[0] == '\0' || strlen(barcode) >= MAX_BARCODE_LEN) {
+        fprintf(stderr, "Barcode must be 1-%d characters\n", MAX_BARCODE_LEN - 1);
+        return -1;
+    }
+
+    int began = begin_savepoint(db, "add_copy");
+    if (began < 0) {
+        return -1;
+    }
+
+    const char *insert_sql = "INSERT INTO Copies (barcode, book_id, status) VALUES (?, ?, 0);";
+
+    sqlite3_stmt *stmt;
+    if (sqlite3_prepare_v2(db, insert_sql, -1, &stmt, NULL) != SQLITE_OK) {
+        fprintf(stderr, "Failed to prepare statement: %s\n", sqlite3_errmsg(db));
+        rollback_savepoint(db, "add_copy", began);
+        return -1;
+    }
+
+    sqlite3_bind_text(stmt, 1, barcode, -1, SQLITE_STATIC);
+    sqlite3_bind_int(stmt, 2, book_id);
+
+    if (sqlite3_step(stmt) != SQLITE_DONE) {
+        fprintf(stderr, "Failed to insert copy: %s\n", sqlite3_errmsg(db));
+        sqlite3_finalize(stmt);
+        rollback_savepoint(db, "add_copy", began);
+        return -1;
+    }
+
+    int copy_id = (int)sqlite3_last_insert_rowid(db);
+    sqlite3_finalize(stmt);
+
+    // Grow the title's counts only when its copies outnumber its quantity
+    const char *update_sql = "UPDATE Books SET quantity = quantity + 1, available = available + 1 "
+                             "WHERE book_id = ? AND quantity < (SELECT COUNT(*) FROM Copies WHERE book_id = ?);";
+
+    if (sqlite3_prepare_v2(db, update_sql, -1, &stmt, NULL) != SQLITE_OK) {
+        fprintf(stderr, "Failed to prepare statement: %s\n", sqlite3_errmsg(db));
+        rollback_savepoint(db, "add_copy", began);
+        return -1;
+    }
+
+    sqlite3_bind_int(stmt, 1, book_id);
+    sqlite3_bind_int(stmt, 2, book_id);
+
+    if (sqlite3_step(stmt) != SQLITE_DONE) {
+        fprintf(stderr, "Failed to update book quantity: %s\n", sqlite3_errmsg(db));
+        sqlite3_finalize(stmt);
+        rollback_savepoint(db, "add_copy", began);
+        return -1;
+    }
+
+    sqlite3_finalize(stmt);
+    if (release_savepoint(db, "add_copy", began) != 0) {
+        return -1;
+    }
+
+    // Keep the index current; copies of an older title force a reload
+    if (copy_index != NULL) {
+        int rc = append_copy(copy_index, copy_id, book_id, barcode, COPY_AVAILABLE, 0);
+        if (rc != 0 && load_copy_index(db) < 0) {
+            free_copy_index();
+        }
+    }
+
+    return copy_id;
+}
+
+int loan_by_barcode(sqlite3 *db, const char *barcode, int member_id, int loan_period) {
+    if (db == NULL || barcode == NULL) {
+        fprintf(stderr, "Invalid parameters\n");
+        return -1;
+    }
+
+    int loan_id = -1;
+    for (int attempt = 0; attempt < 2; attempt++) {
+        if (sync_copy_index(db) < 0) {
+            return -1;
+        }
+
+        int slot = lookup_slot(copy_index, barcode);
+        if (slot < 0) {
+            fprintf(stderr, "Unknown barcode: %s\n", barcode);
+            return -1;
+        }
+
+        if (!is_available(copy_index, slot)) {
+            fprintf(stderr, "Copy %s is not on the shelf\n", barcode);
+            return -1;
+        }
+
+        const CopySlot *entry = &copy_index->slots[slot];
+        loan_id = process_copy_loan(db, entry->copy_id, entry->book_id, member_id, loan_period);
+
+        // Another process may have lent the copy after the sync: look once more
+        if (loan_id > 0 || copy_index == NULL || sync_copy_index(db) != 1) {
+            break;
+        }
+    }
+    return loan_id;
+}
+
+int return_by_barcode(sqlite3 *db, const char *barcode) {
+    if (db == NULL || barcode == NULL) {
+        fprintf(stderr, "Invalid parameters\n");
+        return -1;
+    }
+
+    if (sync_copy_index(db) < 0) {
+        return -1;
+    }
+
+    int slot = lookup_slot(copy_index, barcode);
+    if (slot < 0) {
+        fprintf(stderr, "Unknown barcode: %s\n", barcode);
+        return -1;
+    }
+
+    int loan_id = copy_index->slots[slot].active_loan_id;
+    if (loan_id == 0) {
+        fprintf(stderr, "Copy %s is not on loan\n", barcode);
+        return -1;
+    }
+
+    return process_return(db, loan_id);
+}
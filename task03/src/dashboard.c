@@ -0,0 +1,196 @@
+#include "dashboard.h"
+#include "database.h"
+#include "date_utils.h"
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+/* Parts of the dashboard query, in output order */
+enum {
+    PART_MEMBER = 0,
+    PART_ACTIVE = 1,
+    PART_HISTORY = 2,
+    PART_TOTAL = 3
+};
+
+/*
+ * Every part returns the same ten columns:
+ *   part, seq, id, name/title, phone/loan_date, address/due_date,
+ *   registration_date/overdue_days, book_id, return_date, is_returned
+ * ?1 = member ID, ?2 = today, ?3 = history limit.
+ */
+static const char *dashboard_sql =
+    "SELECT 0, 0, member_id, name, phone, address, registration_date, NULL, NULL, NULL "
+    "FROM Members WHERE member_id = ?1 "
+    "UNION ALL "
+    "SELECT 1, row_number() OVER (ORDER BY l.due_date, l.loan_id), l.loan_id, COALESCE(b.title, ''), "
+    "l.loan_date, l.due_date, overdue_days(l.due_date, ?2), l.book_id, NULL, 0 "
+    "FROM Loans l LEFT JOIN Books b ON b.book_id = l.book_id "
+    "WHERE l.member_id = ?1 AND l.is_returned = 0 "
+    "UNION ALL "
+    "SELECT * FROM ("
+    "SELECT 2, row_number() OVER (ORDER BY l.loan_date DESC, l.loan_id DESC), l.loan_id, COALESCE(b.title, ''), "
+    "l.loan_date, l.due_date, COALESCE(r.overdue_days, overdue_days(l.due_date, ?2)), l.book_id, "
+    "r.return_date, l.is_returned "
+    "FROM Loans l LEFT JOIN Books b ON b.book_id = l.book_id "
+    "LEFT JOIN Returns r ON r.loan_id = l.loan_id "
+    "WHERE l.member_id = ?1 ORDER BY l.loan_date DESC, l.loan_id DESC LIMIT ?3) "
+    "UNION ALL "
+    "SELECT 3, 0, COUNT(*), NULL, NULL, NULL, NULL, NULL, NULL, NULL FROM Loans WHERE member_id = ?1 "
+    "ORDER BY 1, 2;";
+
+/**
+ * @brief Caller-provided buffer: loans grow from the front, strings from the back.
+ */
+typedef struct {
+    unsigned char *base;
+    size_t front;
+    size_t back;
+} DashboardArena;
+
+/**
+ * @brief Reserve one loan record, keeping records of a part contiguous.
+ * 
+ * @return DashboardLoan* Returns the record, or NULL if the arena is full.
+ */
+static DashboardLoan *arena_alloc_loan(DashboardArena *arena) {
+    uintptr_t address = (uintptr_t)(arena->base + arena->front);
+    size_t padding = (_Alignof(DashboardLoan) - address % _Alignof(DashboardLoan)) % _Alignof(DashboardLoan);
+    
+    if (arena->back - arena->front < padding + sizeof(DashboardLoan)) {
+        return NULL;
+    }
+    
+    DashboardLoan *loan = (DashboardLoan *)(arena->base + arena->front + padding);
+    arena->front += padding + sizeof(DashboardLoan);
+    return loan;
+}
+
+/**
+ * @brief Copy a string into the back of the arena.
+ * 
+ * @return const char* Returns the copy, or NULL if the arena is full.
+ */
+static const char *arena_copy_string(DashboardArena *arena, const char *text) {
+    size_t len = strlen(text) + 1;
+    
+    if (arena->back - arena->front < len) {
+        return NULL;
+    }
+    
+    arena->back -= len;
+    memcpy(arena->base + arena->back, text, len);
+    return (const char *)(arena->base + arena->back);
+}
+
+/**
+ * @brief Copy a text column into a fixed buffer (NULL becomes empty).
+ */
+static void copy_column(sqlite3_stmt *stmt, int column, char *dest, size_t size) {
+    const char *text = (const char *)sqlite3_column_text(stmt, column);
+    snprintf(dest, size, "%s", text ? text : "");
+}
+
+/**
+ * @brief Store the current loan row; the loan arrays must stay contiguous.
+ * 
+ * @return DashboardLoan* Returns the stored loan, or NULL if the arena is full.
+ */
+static DashboardLoan *store_loan(DashboardArena *arena, sqlite3_stmt *stmt) {
+    size_t saved_front = arena->front;
+    DashboardLoan *loan = arena_alloc_loan(arena);
+    if (loan == NULL) {
+        return NULL;
+    }
+    
+    loan->title = arena_copy_string(arena, (const char *)sqlite3_column_text(stmt, 3));
+    if (loan->title == NULL) {
+        arena->front = saved_front;
+        return NULL;
+    }
+    
+    loan->loan_id = sqlite3_column_int(stmt, 2);
+    copy_column(stmt, 4, loan->loan_date, sizeof(loan->loan_date));
+    copy_column(stmt, 5, loan->due_date, sizeof(loan->due_date));
+    loan->overdue_days = sqlite3_column_int(stmt, 6);
+    loan->book_id = sqlite3_column_int(stmt, 7);
+    copy_column(stmt, 8, loan->return_date, sizeof(loan->return_date));
+    loan->is_returned = sqlite3_column_int(stmt, 9);
+    return loan;
+}
+
+int get_member_dashboard(sqlite3 *db, int member_id, int history_limit,
+                         void *arena, size_t arena_size, MemberDashboard *dashboard) {
+    if (db == NULL || arena == NULL || dashboard == NULL) {
+        fprintf(stderr, "Invalid parameters\n");
+        return -1;
+    }
+    
+    memset(dashboard, 0, sizeof(*dashboard));
+    DashboardArena buffer = {(unsigned char *)arena, 0, arena_size};
+    
+    char today[MAX_DATE_LEN];
+    day_to_date(get_today_day(), today, sizeof(today));
+    
+    /* Opened for every member screen, so the statement stays prepared between calls */
+    sqlite3_stmt *stmt = prepare_cached_statement(db, STMT_SLOT_DASHBOARD, dashboard_sql);
+    if (stmt == NULL) {
+        return -1;
+    }
+    
+    sqlite3_bind_int(stmt, 1, member_id);
+    sqlite3_bind_text(stmt, 2, today, -1, SQLITE_STATIC);
+    sqlite3_bind_int(stmt, 3, history_limit > 0 ? history_limit : 0);
+    
+    int found = 0;
+    int rc;
+    while ((rc = sqlite3_step(stmt)) == SQLITE_ROW) {
+        int part = sqlite3_column_int(stmt, 0);
+        
+        if (part == PART_MEMBER) {
+            Member *member = &dashboard->member;
+            member->member_id = sqlite3_column_int(stmt, 2);
+            copy_column(stmt, 3, member->name, sizeof(member->name));
+            copy_column(stmt, 4, member->phone, sizeof(member->phone));
+            copy_column(stmt, 5, member->address, sizeof(member->address));
+            copy_column(stmt, 6, member->registration_date, sizeof(member->registration_date));
+            found = 1;
+        } else if (part == PART_TOTAL) {
+            dashboard->total_loans = sqlite3_column_int(stmt, 2);
+        } else {
+            // The overdue summary counts every active loan, even if the arena is full
+            int overdue_days = sqlite3_column_int(stmt, 6);
+            if (part == PART_ACTIVE && overdue_days > 0) {
+                dashboard->overdue_loans++;
+                if (overdue_days > dashboard->member.overdue_days) {
+                    dashboard->member.overdue_days = overdue_days;
+                }
+            }
+            
+            DashboardLoan *loan = dashboard->truncated ? NULL : store_loan(&buffer, stmt);
+            if (loan == NULL) {
+                dashboard->truncated = 1;
+            } else if (part == PART_ACTIVE) {
+                if (dashboard->active_count++ == 0) {
+                    dashboard->active_loans = loan;
+                }
+            } else if (dashboard->history_count++ == 0) {
+                dashboard->history = loan;
+            }
+        }
+    }
+    
+    // Every path gets here, a full arena included: it only stops storing rows
+    if (rc != SQLITE_DONE) {
+        fprintf(stderr, "Error during query execution: %s\n", sqlite3_errmsg(db));
+    }
+    sqlite3_reset(stmt);
+    sqlite3_clear_bindings(stmt);   // today is a stack buffer
+    
+    if (rc != SQLITE_DONE || !found) {
+        return -1;
+    }
+    
+    dashboard->member.suspension_days = calculate_suspension_days(dashboard->member.overdue_days);
+    return 0;
+}
@@ -1,9 +1,35 @@
 #include "database.h"
+#include "hangul.h"
+#include "isbn.h"
+#include "sql_functions.h"
+#include "member.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <stdint.h>
+#include <stdatomic.h>
+#include <time.h>
 
-static sqlite3 *db = NULL;
+/* Per thread, so each HTTP worker can use its own connection (see set_db_connection()) */
+static _Thread_local sqlite3 *db = NULL;
+
+/* Prepared statements reused across calls, all owned by cache_db */
+static _Thread_local sqlite3 *cache_db = NULL;
+static _Thread_local sqlite3_stmt *cached_statements[STMT_CACHE_SLOTS];
+
+/* Suppresses progress messages on stdout (see set_quiet_mode()) */
+static int quiet_mode = 0;
+
+/* Busy retry layer: deadline, per-thread wait state and process-wide counters */
+static int busy_timeout_ms = DB_BUSY_TIMEOUT_MS;
+static _Thread_local long long busy_wait_started_us;
+static _Thread_local long long call_deadline_us;    /* set while exec_with_retry() runs */
+static _Thread_local int call_waited;
+static _Thread_local uint64_t backoff_seed;
+static atomic_long retry_waits;
+static atomic_long retry_sleeps;
+static atomic_long retry_timeouts;
+static atomic_llong retry_wait_us;
 
 /**
  * @brief Initialize the database connection and create tables if they don't exist.
@@ -20,7 +46,19 @@ int init_database(void) {
         return -1;
     }
     
-    printf("Database connection established successfully\n");
+    if (!quiet_mode) {
+        printf("Database connection established successfully\n");
+    }
+    
+    /* Register overdue_days(), suspension_days() and date_to_day() */
+    if (register_sql_functions(db) != 0) {
+        sqlite3_close(db);
+        db = NULL;
+        return -1;
+    }
+    
+    /* Wait for other processes' locks instead of failing with SQLITE_BUSY */
+    install_busy_handler(db);
     
     /* Enable foreign key constraints */
     if (enable_foreign_keys() != 0) {
@@ -38,6 +76,14 @@ int init_database(void) {
         return -1;
     }
     
+    /* Add columns introduced after the initial schema */
+    if (migrate_schema() != 0) {
+        fprintf(stderr, "Failed to migrate schema\n");
+        sqlite3_close(db);
+        db = NULL;
+        return -1;
+    }
+    
     /* Create indexes */
     if (create_indexes() != 0) {
         fprintf(stderr, "Failed to create indexes\n");
@@ -46,7 +92,9 @@ int init_database(void) {
         return -1;
     }
     
-    printf("Database initialized successfully\n");
+    if (!quiet_mode) {
+        printf("Database initialized successfully\n");
+    }
     return 0;
 }
 
@@ -60,6 +108,10 @@ int close_database(void) {
         return 0;
     }
     
+    if (cache_db == db) {
+        finalize_cached_statements();
+    }
+    
     int rc = sqlite3_close(db);
     if (rc != SQLITE_OK) {
         fprintf(stderr, "Failed to close database: %s\n", sqlite3_errmsg(db));
@@ -67,7 +119,9 @@ int close_database(void) {
     }
     
     db = NULL;
-    printf("Database connection closed successfully\n");
+    if (!quiet_mode) {
+        printf("Database connection closed successfully\n");
+    }
     return 0;
 }
 
@@ -83,10 +137,345 @@ sqlite3* get_db_connection(void) {
 /**
  * @brief Set the database connection pointer (for testing purposes only).
  * 
+ * The library's SQL functions are registered on the new connection.
+ * 
  * @param new_db The new database connection pointer.
  */
 void set_db_connection(sqlite3* new_db) {
+    if (cache_db != NULL && cache_db != new_db) {
+        finalize_cached_statements();
+    }
     db = new_db;
+    if (new_db != NULL) {
+        register_sql_functions(new_db);
+        install_busy_handler(new_db);
+    }
+}
+
+/**
+ * @brief Turn the library's progress messages on stdout on or off.
+ * 
+ * @param quiet 1 to suppress progress messages, 0 to print them.
+ */
+void set_quiet_mode(int quiet) {
+    quiet_mode = quiet;
+}
+
+/**
+ * @brief Check whether progress messages are suppressed.
+ * 
+ * @return int Returns 1 in quiet mode, 0 otherwise.
+ */
+int is_quiet_mode(void) {
+    return quiet_mode;
+}
+
+/**
+ * @brief Look up a cached prepared statement.
+ * 
+ * @param conn SQLite database connection the statement must belong to.
+ * @param slot Cache slot.
+ * @return sqlite3_stmt* Returns the statement, or NULL if the slot is empty.
+ */
+sqlite3_stmt* find_cached_statement(sqlite3 *conn, int slot) {
+    if (slot < 0 || slot >= STMT_CACHE_SLOTS) {
+        return NULL;
+    }
+    
+    if (conn != cache_db) {
+        finalize_cached_statements();
+        cache_db = conn;
+    }
+    
+    return cached_statements[slot];
+}
+
+/**
+ * @brief Prepare a statement once and keep it in the cache.
+ * 
+ * @param conn SQLite database connection.
+ * @param slot Cache slot.
+ * @param sql SQL text, used only if the slot is empty.
+ * @return sqlite3_stmt* Returns the statement, or NULL on failure.
+ */
+sqlite3_stmt* prepare_cached_statement(sqlite3 *conn, int slot, const char *sql) {
+    if (conn == NULL || sql == NULL || slot < 0 || slot >= STMT_CACHE_SLOTS) {
+        fprintf(stderr, "Invalid parameters\n");
+        return NULL;
+    }
+    
+    if (conn != cache_db) {
+        finalize_cached_statements();
+        cache_db = conn;
+    }
+    
+    if (cached_statements[slot] != NULL) {
+        return cached_statements[slot];
+    }
+    
+    sqlite3_stmt *stmt;
+    if (sqlite3_prepare_v3(conn, sql, -1, SQLITE_PREPARE_PERSISTENT, &stmt, NULL) != SQLITE_OK) {
+        fprintf(stderr, "Failed to prepare statement: %s\n", sqlite3_errmsg(conn));
+        return NULL;
+    }
+    
+    cached_statements[slot] = stmt;
+    return stmt;
+}
+
+/**
+ * @brief Finalize every cached statement.
+ */
+void finalize_cached_statements(void) {
+    for (int i = 0; i < STMT_CACHE_SLOTS; i++) {
+        if (cached_statements[i] != NULL) {
+            sqlite3_finalize(cached_statements[i]);
+            cached_statements[i] = NULL;
+        }
+    }
+    cache_db = NULL;
+}
+
+/**
+ * @brief Microseconds on the monotonic clock.
+ */
+static long long monotonic_us(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (long long)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+/**
+ * @brief Sleep before attempt number attempt + 1, never past the deadline.
+ * 
+ * The delay doubles from DB_BACKOFF_MIN_US up to DB_BACKOFF_MAX_US; half
+ * of it is random so that waiting processes do not retry in lockstep.
+ * 
+ * @return int Returns 1 after sleeping, 0 if the deadline has passed.
+ */
+static int backoff_sleep(int attempt, long long deadline_us) {
+    long long now = monotonic_us();
+    if (now >= deadline_us) {
+        atomic_fetch_add(&retry_timeouts, 1);
+        return 0;
+    }
+
+    long long delay = DB_BACKOFF_MAX_US;
+    if (attempt < 16 && ((long long)DB_BACKOFF_MIN_US << attempt) < DB_BACKOFF_MAX_US) {
+        delay = (long long)DB_BACKOFF_MIN_US << attempt;
+    }
+    if (backoff_seed == 0) {
+        backoff_seed = (uint64_t)now ^ (uint64_t)(uintptr_t)&backoff_seed;
+    }
+    backoff_seed ^= backoff_seed << 13;    // xorshift64
+    backoff_seed ^= backoff_seed >> 7;
+    backoff_seed ^= backoff_seed << 17;
+    delay = delay / 2 + (long long)(backoff_seed % (uint64_t)(delay / 2 + 1));
+    if (delay > deadline_us - now) {
+        delay = deadline_us - now;
+    }
+
+    struct timespec ts = {(time_t)(delay / 1000000), (long)(delay % 1000000) * 1000};
+    nanosleep(&ts, NULL);
+    atomic_fetch_add(&retry_sleeps, 1);
+    atomic_fetch_add(&retry_wait_us, monotonic_us() - now);
+    return 1;
+}
+
+/**
+ * @brief SQLite busy handler: back off until the busy timeout has passed.
+ * 
+ * @param count Number of times the handler ran for this lock (0 on the first).
+ * @return int Returns nonzero to try the lock again, 0 to give up with SQLITE_BUSY.
+ */
+static int busy_backoff(void *arg, int count) {
+    (void)arg;
+    if (count == 0 && !call_waited) {
+        busy_wait_started_us = monotonic_us();
+        atomic_fetch_add(&retry_waits, 1);
+        call_waited = call_deadline_us != 0;    /* one wait per exec_with_retry() call */
+    }
+    if (call_deadline_us != 0) {
+        /* Inside exec_with_retry(): share its deadline and let it count the timeout */
+        if (monotonic_us() >= call_deadline_us) {
+            return 0;
+        }
+        return backoff_sleep(count, call_deadline_us);
+    }
+    return backoff_sleep(count, busy_wait_started_us + (long long)busy_timeout_ms * 1000);
+}
+
+/**
+ * @brief Set the deadline of one lock wait or retried call.
+ * 
+ * @param timeout_ms Milliseconds (DB_BUSY_TIMEOUT_MS if <= 0).
+ */
+void set_busy_timeout(int timeout_ms) {
+    busy_timeout_ms = timeout_ms > 0 ? timeout_ms : DB_BUSY_TIMEOUT_MS;
+}
+
+/**
+ * @brief Make a connection wait for other connections' locks.
+ * 
+ * @param conn SQLite database connection.
+ * @return int Returns 0 on success, -1 on failure.
+ */
+int install_busy_handler(sqlite3 *conn) {
+    if (conn == NULL) {
+        fprintf(stderr, "Database connection is NULL\n");
+        return -1;
+    }
+    return sqlite3_busy_handler(conn, busy_backoff, NULL) == SQLITE_OK ? 0 : -1;
+}
+
+/**
+ * @brief Run SQL with sqlite3_exec(), retrying while it reports SQLITE_BUSY or SQLITE_LOCKED.
+ * 
+ * The busy timeout bounds the whole call: the busy handler's waits and
+ * the retries here share one deadline.
+ * 
+ * @param conn SQLite database connection.
+ * @param sql SQL text.
+ * @return int Returns the SQLite result code of the last attempt.
+ */
+int exec_with_retry(sqlite3 *conn, const char *sql) {
+    long long saved_deadline_us = call_deadline_us;
+    long long deadline_us = monotonic_us() + (long long)busy_timeout_ms * 1000;
+    if (saved_deadline_us != 0 && saved_deadline_us < deadline_us) {
+        deadline_us = saved_deadline_us;
+    }
+    int saved_waited = call_waited;
+    call_deadline_us = deadline_us;
+    call_waited = 0;
+
+    int rc;
+    for (int attempt = 0;; attempt++) {
+        rc = sqlite3_exec(conn, sql, NULL, NULL, NULL);
+        if ((rc & 0xff) != SQLITE_BUSY && (rc & 0xff) != SQLITE_LOCKED) {
+            break;
+        }
+        if (!call_waited) {
+            atomic_fetch_add(&retry_waits, 1);
+            call_waited = 1;
+        }
+        if (!backoff_sleep(attempt, deadline_us)) {
+            break;
+        }
+    }
+    call_deadline_us = saved_deadline_us;
+    call_waited = saved_waited;
+    return rc;
+}
+
+/**
+ * @brief Open a savepoint, starting a write transaction if none is open.
+ * 
+ * @param conn SQLite database connection.
+ * @param name Savepoint name.
+ * @return int Returns 1 if a transaction was started, 0 if nested, -1 on failure.
+ */
+int begin_savepoint(sqlite3 *conn, const char *name) {
+    if (conn == NULL || name == NULL) {
+        fprintf(stderr, "Invalid parameters\n");
+        return -1;
+    }
+
+    int began = sqlite3_get_autocommit(conn);
+    if (began && exec_with_retry(conn, "BEGIN IMMEDIATE;") != SQLITE_OK) {
+        fprintf(stderr, "Failed to begin transaction: %s\n", sqlite3_errmsg(conn));
+        return -1;
+    }
+
+    char sql[128];
+    snprintf(sql, sizeof(sql), "SAVEPOINT %s;", name);
+    if (exec_with_retry(conn, sql) != SQLITE_OK) {
+        fprintf(stderr, "Failed to open savepoint %s: %s\n", name, sqlite3_errmsg(conn));
+        if (began) {
+            sqlite3_exec(conn, "ROLLBACK;", NULL, NULL, NULL);
+        }
+        return -1;
+    }
+    return began;
+}
+
+/**
+ * @brief Release a savepoint and commit the transaction begin_savepoint() started.
+ * 
+ * @param conn SQLite database connection.
+ * @param name Savepoint name.
+ * @param began The result of begin_savepoint().
+ * @return int Returns 0 on success, -1 on failure.
+ */
+int release_savepoint(sqlite3 *conn, const char *name, int began) {
+    char sql[128];
+    snprintf(sql, sizeof(sql), "RELEASE %s;", name);
+    if (exec_with_retry(conn, sql) != SQLITE_OK) {
+        fprintf(stderr, "Failed to release savepoint %s: %s\n", name, sqlite3_errmsg(conn));
+        rollback_savepoint(conn, name, began);
+        return -1;
+    }
+
+    /* A COMMIT that fails with SQLITE_BUSY leaves the transaction open, so it can be retried */
+    if (began && exec_with_retry(conn, "COMMIT;") != SQLITE_OK) {
+        fprintf(stderr, "Failed to commit transaction: %s\n", sqlite3_errmsg(conn));
+        if (!sqlite3_get_autocommit(conn)) {
+            sqlite3_exec(conn, "ROLLBACK;", NULL, NULL, NULL);
+        }
+        return -1;
+    }
+    return 0;
+}
+
+/**
+ * @brief Undo and close a savepoint, and the transaction begin_savepoint() started.
+ * 
+ * @param conn SQLite database connection.
+ * @param name Savepoint name.
+ * @param began The result of begin_savepoint().
+ */
+void rollback_savepoint(sqlite3 *conn, const char *name, int began) {
+    char sql[160];
+    snprintf(sql, sizeof(sql), "ROLLBACK TO %s; RELEASE %s;", name, name);
+    sqlite3_exec(conn, sql, NULL, NULL, NULL);
+    if (began && !sqlite3_get_autocommit(conn)) {
+        sqlite3_exec(conn, "ROLLBACK;", NULL, NULL, NULL);
+    }
+}
+
+/**
+ * @brief Copy the busy retry counters.
+ * 
+ * @param stats Pointer to store the counters.
+ */
+void get_retry_stats(DbRetryStats *stats) {
+    if (stats == NULL) {
+        return;
+    }
+    stats->waits = atomic_load(&retry_waits);
+    stats->retries = atomic_load(&retry_sleeps);
+    stats->timeouts = atomic_load(&retry_timeouts);
+    stats->wait_us = atomic_load(&retry_wait_us);
+}
+
+/**
+ * @brief Zero the busy retry counters.
+ */
+void reset_retry_stats(void) {
+    atomic_store(&retry_waits, 0);
+    atomic_store(&retry_sleeps, 0);
+    atomic_store(&retry_timeouts, 0);
+    atomic_store(&retry_wait_us, 0);
+}
+
+/**
+ * @brief Print the busy retry counters.
+ */
+void display_retry_stats(void) {
+    DbRetryStats stats;
+    get_retry_stats(&stats);
+    printf("\n=== Database Lock Waits ===\n");
+    printf("Waits: %ld, Retries: %ld, Timeouts: %ld\n", stats.waits, stats.retries, stats.timeouts);
+    printf("Time waiting: %.1f ms (busy timeout %d ms)\n", stats.wait_us / 1000.0, busy_timeout_ms);
 }
 
 /**
@@ -124,7 +513,15 @@ int execute_query(const char *sql) {
  * @return int Returns 0 on success, -1 on failure.
  */
 int begin_transaction(void) {
-    return execute_query("BEGIN TRANSACTION;");
+    if (db == NULL) {
+        fprintf(stderr, "Database not initialized\n");
+        return -1;
+    }
+    if (exec_with_retry(db, "BEGIN IMMEDIATE;") != SQLITE_OK) {
+        fprintf(stderr, "SQL error: %s\n", sqlite3_errmsg(db));
+        return -1;
+    }
+    return 0;
 }
 
 /**
@@ -133,7 +530,15 @@ int begin_transaction(void) {
  * @return int Returns 0 on success, -1 on failure.
  */
 int commit_transaction(void) {
-    return execute_query("COMMIT;");
+    if (db == NULL) {
+        fprintf(stderr, "Database not initialized\n");
+        return -1;
+    }
+    if (exec_with_retry(db, "COMMIT;") != SQLITE_OK) {
+        fprintf(stderr, "SQL error: %s\n", sqlite3_errmsg(db));
+        return -1;
+    }
+    return 0;
 }
 
 /**
@@ -162,7 +567,12 @@ int create_tables(void) {
         "isbn TEXT UNIQUE,"
         "genre TEXT,"
         "quantity INTEGER DEFAULT 1,"
-        "available INTEGER DEFAULT 1"
+        "available INTEGER DEFAULT 1,"
+        "title_chosung TEXT,"
+        "title_jamo TEXT,"
+        "author_chosung TEXT,"
+        "author_jamo TEXT,"
+        "isbn13 INTEGER"
         ");";
     
     /* Members table */
@@ -173,7 +583,11 @@ int create_tables(void) {
         "phone TEXT,"
         "address TEXT,"
         "registration_date TEXT,"
-        "penalty_days INTEGER DEFAULT 0"
+        "penalty_days INTEGER DEFAULT 0,"
+        "name_chosung TEXT,"
+        "name_jamo TEXT,"
+        "suspended_until INTEGER DEFAULT 0,"
+        "next_due_day INTEGER"
         ");";
     
     /* Loans table */
@@ -185,6 +599,7 @@ int create_tables(void) {
         "loan_date TEXT NOT NULL,"
         "due_date TEXT NOT NULL,"
         "is_returned INTEGER DEFAULT 0,"
+        "copy_id INTEGER,"
         "FOREIGN KEY (book_id) REFERENCES Books(book_id),"
         "FOREIGN KEY (member_id) REFERENCES Members(member_id)"
         ");";
@@ -199,6 +614,51 @@ int create_tables(void) {
         "FOREIGN KEY (loan_id) REFERENCES Loans(loan_id)"
         ");";
     
+    /* Copies table (one row per physical copy) */
+    const char *sql_copies = 
+        "CREATE TABLE IF NOT EXISTS Copies ("
+        "copy_id INTEGER PRIMARY KEY AUTOINCREMENT,"
+        "barcode TEXT NOT NULL UNIQUE,"
+        "book_id INTEGER NOT NULL,"
+        "status INTEGER DEFAULT 0,"
+        "FOREIGN KEY (book_id) REFERENCES Books(book_id)"
+        ");";
+    
+    /* Circulation rollups (loans/returns per day or YYYYMM month and genre) */
+    const char *sql_rollups = 
+        "CREATE TABLE IF NOT EXISTS CirculationDaily ("
+        "day INTEGER NOT NULL,"
+        "genre TEXT NOT NULL,"
+        "loans INTEGER DEFAULT 0,"
+        "returns INTEGER DEFAULT 0,"
+        "PRIMARY KEY (day, genre)"
+        ") WITHOUT ROWID;"
+        "CREATE TABLE IF NOT EXISTS CirculationMonthly ("
+        "month INTEGER NOT NULL,"
+        "genre TEXT NOT NULL,"
+        "loans INTEGER DEFAULT 0,"
+        "returns INTEGER DEFAULT 0,"
+        "PRIMARY KEY (month, genre)"
+        ") WITHOUT ROWID;"
+        "CREATE TABLE IF NOT EXISTS RollupState ("
+        "name TEXT PRIMARY KEY,"
+        "last_id INTEGER NOT NULL"
+        ");";
+    
+    /* Due-date notifications waiting to be sent (kind: 0 due tomorrow, 1 overdue) */
+    const char *sql_outbox = 
+        "CREATE TABLE IF NOT EXISTS ReminderOutbox ("
+        "outbox_id INTEGER PRIMARY KEY AUTOINCREMENT,"
+        "loan_id INTEGER NOT NULL,"
+        "member_id INTEGER NOT NULL,"
+        "book_id INTEGER NOT NULL,"
+        "kind INTEGER NOT NULL,"
+        "overdue_days INTEGER NOT NULL DEFAULT 0,"
+        "notify_date TEXT NOT NULL,"
+        "sent INTEGER NOT NULL DEFAULT 0,"
+        "UNIQUE (loan_id, kind, overdue_days)"
+        ");";
+    
     /* Execute table creation queries */
     if (execute_query(sql_books) != 0) {
         return -1;
@@ -216,7 +676,220 @@ int create_tables(void) {
         return -1;
     }
     
-    printf("All tables created successfully\n");
+    if (execute_query(sql_copies) != 0) {
+        return -1;
+    }
+    
+    if (execute_query(sql_rollups) != 0) {
+        return -1;
+    }
+    
+    if (execute_query(sql_outbox) != 0) {
+        return -1;
+    }
+    
+    if (!quiet_mode) {
+        printf("All tables created successfully\n");
+    }
+    return 0;
+}
+
+/**
+ * @brief Check whether a table already has a given column.
+ * 
+ * @param table The table name.
+ * @param column The column name.
+ * @return int Returns 1 if the column exists, 0 if not, -1 on failure.
+ */
+static int column_exists(const char *table, const char *column) {
+    char sql[128];
+    snprintf(sql, sizeof(sql), "PRAGMA table_info(%s);", table);
+    
+    sqlite3_stmt *stmt;
+    if (sqlite3_prepare_v2(db, sql, -1, &stmt, NULL) != SQLITE_OK) {
+        fprintf(stderr, "Failed to prepare statement: %s\n", sqlite3_errmsg(db));
+        return -1;
+    }
+    
+    int found = 0;
+    while (sqlite3_step(stmt) == SQLITE_ROW) {
+        const char *name = (const char *)sqlite3_column_text(stmt, 1);
+        if (name != NULL && strcmp(name, column) == 0) {
+            found = 1;
+            break;
+        }
+    }
+    
+    sqlite3_finalize(stmt);
+    return found;
+}
+
+/**
+ * @brief Add a column to an existing table unless it is already there.
+ * 
+ * @param table The table name.
+ * @param column The column name.
+ * @param definition The column type and constraints.
+ * @return int Returns 0 on success, -1 on failure.
+ */
+static int add_column_if_missing(const char *table, const char *column, const char *definition) {
+    int exists = column_exists(table, column);
+    if (exists < 0) {
+        return -1;
+    }
+    if (exists) {
+        return 0;
+    }
+    
+    char sql[256];
+    snprintf(sql, sizeof(sql), "ALTER TABLE %s ADD COLUMN %s %s;", table, column, definition);
+    return execute_query(sql);
+}
+
+/**
+ * @brief Fill the chosung/jamo shadow columns of rows that do not have them yet.
+ * 
+ * @param select_sql Query returning the row ID followed by text_columns texts.
+ * @param update_sql Statement taking a chosung and jamo key per text, then the row ID.
+ * @param text_columns Number of text columns to convert.
+ * @return int Returns number of rows updated, -1 on failure.
+ */
+static int backfill_hangul_keys(const char *select_sql, const char *update_sql, int text_columns) {
+    sqlite3_stmt *select_stmt;
+    sqlite3_stmt *update_stmt;
+    
+    if (sqlite3_prepare_v2(db, select_sql, -1, &select_stmt, NULL) != SQLITE_OK) {
+        fprintf(stderr, "Failed to prepare statement: %s\n", sqlite3_errmsg(db));
+        return -1;
+    }
+    if (sqlite3_prepare_v2(db, update_sql, -1, &update_stmt, NULL) != SQLITE_OK) {
+        fprintf(stderr, "Failed to prepare statement: %s\n", sqlite3_errmsg(db));
+        sqlite3_finalize(select_stmt);
+        return -1;
+    }
+    
+    int count = 0;
+    int rc;
+    while ((rc = sqlite3_step(select_stmt)) == SQLITE_ROW) {
+        char chosung[HANGUL_KEY_LEN];
+        char jamo[HANGUL_KEY_LEN];
+        
+        for (int i = 0; i < text_columns; i++) {
+            const char *text = (const char *)sqlite3_column_text(select_stmt, i + 1);
+            hangul_chosung_key(text, chosung, sizeof(chosung));
+            hangul_jamo_key(text, jamo, sizeof(jamo));
+            sqlite3_bind_text(update_stmt, 2 * i + 1, chosung, -1, SQLITE_TRANSIENT);
+            sqlite3_bind_text(update_stmt, 2 * i + 2, jamo, -1, SQLITE_TRANSIENT);
+        }
+        sqlite3_bind_int64(update_stmt, 2 * text_columns + 1, sqlite3_column_int64(select_stmt, 0));
+        
+        if (sqlite3_step(update_stmt) != SQLITE_DONE) {
+            fprintf(stderr, "Failed to backfill search keys: %s\n", sqlite3_errmsg(db));
+            rc = SQLITE_ERROR;
+            break;
+        }
+        sqlite3_reset(update_stmt);
+        count++;
+    }
+    
+    sqlite3_finalize(select_stmt);
+    sqlite3_finalize(update_stmt);
+    return rc == SQLITE_DONE ? count : -1;
+}
+
+/**
+ * @brief Fill the canonical ISBN key of books that do not have it yet.
+ * 
+ * Books whose ISBN does not parse get ISBN_INVALID so they are not revisited.
+ * 
+ * @return int Returns number of rows updated, -1 on failure.
+ */
+static int backfill_isbn_keys(void) {
+    sqlite3_stmt *select_stmt;
+    sqlite3_stmt *update_stmt;
+    
+    if (sqlite3_prepare_v2(db, "SELECT book_id, isbn FROM Books WHERE isbn13 IS NULL;",
+                           -1, &select_stmt, NULL) != SQLITE_OK) {
+        fprintf(stderr, "Failed to prepare statement: %s\n", sqlite3_errmsg(db));
+        return -1;
+    }
+    if (sqlite3_prepare_v2(db, "UPDATE Books SET isbn13 = ? WHERE book_id = ?;",
+                           -1, &update_stmt, NULL) != SQLITE_OK) {
+        fprintf(stderr, "Failed to prepare statement: %s\n", sqlite3_errmsg(db));
+        sqlite3_finalize(select_stmt);
+        return -1;
+    }
+    
+    int count = 0;
+    int rc;
+    while ((rc = sqlite3_step(select_stmt)) == SQLITE_ROW) {
+        sqlite3_bind_int64(update_stmt, 1, isbn_parse((const char *)sqlite3_column_text(select_stmt, 1)));
+        sqlite3_bind_int64(update_stmt, 2, sqlite3_column_int64(select_stmt, 0));
+        
+        if (sqlite3_step(update_stmt) != SQLITE_DONE) {
+            fprintf(stderr, "Failed to backfill ISBN keys: %s\n", sqlite3_errmsg(db));
+            rc = SQLITE_ERROR;
+            break;
+        }
+        sqlite3_reset(update_stmt);
+        count++;
+    }
+    
+    sqlite3_finalize(select_stmt);
+    sqlite3_finalize(update_stmt);
+    return rc == SQLITE_DONE ? count : -1;
+}
+
+/**
+ * @brief Bring tables created by older versions up to the current schema.
+ * 
+ * @return int Returns 0 on success, -1 on failure.
+ */
+int migrate_schema(void) {
+    if (add_column_if_missing("Loans", "copy_id", "INTEGER") != 0) {
+        return -1;
+    }
+    
+    /* Hangul chosung/jamo search keys */
+    if (add_column_if_missing("Books", "title_chosung", "TEXT") != 0 ||
+        add_column_if_missing("Books", "title_jamo", "TEXT") != 0 ||
+        add_column_if_missing("Books", "author_chosung", "TEXT") != 0 ||
+        add_column_if_missing("Books", "author_jamo", "TEXT") != 0 ||
+        add_column_if_missing("Members", "name_chosung", "TEXT") != 0 ||
+        add_column_if_missing("Members", "name_jamo", "TEXT") != 0) {
+        return -1;
+    }
+    
+    /* Canonical ISBN-13 key */
+    if (add_column_if_missing("Books", "isbn13", "INTEGER") != 0) {
+        return -1;
+    }
+    
+    /* Penalty ledger, backfilled from Loans/Returns when first added */
+    int has_ledger = column_exists("Members", "suspended_until");
+    if (has_ledger < 0 ||
+        add_column_if_missing("Members", "suspended_until", "INTEGER DEFAULT 0") != 0 ||
+        add_column_if_missing("Members", "next_due_day", "INTEGER") != 0) {
+        return -1;
+    }
+    
+    if (begin_transaction() != 0) {
+        return -1;
+    }
+    if (backfill_hangul_keys("SELECT book_id, title, author FROM Books WHERE title_jamo IS NULL;",
+                             "UPDATE Books SET title_chosung = ?, title_jamo = ?, "
+                             "author_chosung = ?, author_jamo = ? WHERE book_id = ?;", 2) < 0 ||
+        backfill_hangul_keys("SELECT member_id, name FROM Members WHERE name_jamo IS NULL;",
+                             "UPDATE Members SET name_chosung = ?, name_jamo = ? WHERE member_id = ?;", 1) < 0 ||
+        backfill_isbn_keys() < 0 ||
+        (!has_ledger && rebuild_penalty_ledger(db, 0) < 0)) {
+        rollback_transaction();
+        return -1;
+    }
+    if (commit_transaction() != 0) {
+        return -1;
+    }
+    
     return 0;
 }
 
@@ -234,7 +907,17 @@ int create_indexes(void) {
         "CREATE INDEX IF NOT EXISTS idx_loans_book_id ON Loans(book_id);",
         "CREATE INDEX IF NOT EXISTS idx_loans_member_id ON Loans(member_id);",
         "CREATE INDEX IF NOT EXISTS idx_loans_is_returned ON Loans(is_returned);",
-        "CREATE INDEX IF NOT EXISTS idx_returns_loan_id ON Returns(loan_id);"
+        "CREATE INDEX IF NOT EXISTS idx_returns_loan_id ON Returns(loan_id);",
+        "CREATE INDEX IF NOT EXISTS idx_loans_copy_id ON Loans(copy_id);",
+        "CREATE INDEX IF NOT EXISTS idx_copies_book_id ON Copies(book_id);",
+        "CREATE INDEX IF NOT EXISTS idx_books_title_chosung ON Books(title_chosung);",
+        "CREATE INDEX IF NOT EXISTS idx_books_title_jamo ON Books(title_jamo);",
+        "CREATE INDEX IF NOT EXISTS idx_books_author_chosung ON Books(author_chosung);",
+        "CREATE INDEX IF NOT EXISTS idx_books_author_jamo ON Books(author_jamo);",
+        "CREATE INDEX IF NOT EXISTS idx_members_name_chosung ON Members(name_chosung);",
+        "CREATE INDEX IF NOT EXISTS idx_members_name_jamo ON Members(name_jamo);",
+        "CREATE INDEX IF NOT EXISTS idx_books_isbn13 ON Books(isbn13);",
+        "CREATE INDEX IF NOT EXISTS idx_loans_active_due ON Loans(is_returned, due_date);"
     };
     
     int num_indexes = sizeof(indexes) / sizeof(indexes[0]);
@@ -245,7 +928,9 @@ int create_indexes(void) {
         }
     }
     
-    printf("All indexes created successfully\n");
+    if (!quiet_mode) {
+        printf("All indexes created successfully\n");
+    }
     return 0;
 }
 
@@ -0,0 +1,84 @@
+#include "date_utils.h"
+#include <stdio.h>
+#include <time.h>
+
+/**
+ * @brief Days since 1970-01-01 of a civil date (H. Hinnant's algorithm).
+ */
+static int days_from_civil(int year, int month, int day) {
+    year -= month <= 2;
+    int era = (year >= 0 ? year : year - 399) / 400;
+    int year_of_era = year - era * 400;
+    int day_of_year = (153 * (month + (month > 2 ? -3 : 9)) + 2) / 5 + day - 1;
+    int day_of_era = year_of_era * 365 + year_of_era / 4 - year_of_era / 100 + day_of_year;
+    return era * 146097 + day_of_era - 719468;
+}
+
+/**
+ * @brief Parse a fixed number of decimal digits.
+ * 
+ * @return int Returns the value, -1 if a character is not a digit.
+ */
+static int parse_digits(const char *text, int count) {
+    int value = 0;
+    for (int i = 0; i < count; i++) {
+        if (text[i] < '0' || text[i] > '9') {
+            return -1;
+        }
+        value = value * 10 + (text[i] - '0');
+    }
+    return value;
+}
+
+int date_to_day(const char *date, int *day) {
+    static const int month_days[] = {31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31};
+    
+    if (date == NULL || day == NULL) {
+        return -1;
+    }
+    
+    int year = parse_digits(date, 4);
+    if (year < 0 || date[4] != '-') {
+        return -1;
+    }
+    int month = parse_digits(date + 5, 2);
+    if (month < 1 || month > 12 || date[7] != '-') {
+        return -1;
+    }
+    int mday = parse_digits(date + 8, 2);
+    if (mday < 0) {
+        return -1;   // a short string ends inside the day, before date[10]
+    }
+    if (date[10] != '\0' && date[10] != ' ' && date[10] != 'T') {
+        return -1;
+    }
+    
+    int leap = (year % 4 == 0 && year % 100 != 0) || year % 400 == 0;
+    int last = month_days[month - 1] + (month == 2 && leap);
+    if (mday < 1 || mday > last) {
+        return -1;
+    }
+    
+    *day = days_from_civil(year, month, mday);
+    return 0;
+}
+
+void day_to_date(int day, char *date_str, size_t size) {
+    day += 719468;
+    int era = (day >= 0 ? day : day - 146096) / 146097;
+    int day_of_era = day - era * 146097;
+    int year_of_era = (day_of_era - day_of_era / 1460 + day_of_era / 36524 - day_of_era / 146096) / 365;
+    int day_of_year = day_of_era - (365 * year_of_era + year_of_era / 4 - year_of_era / 100);
+    int mp = (5 * day_of_year + 2) / 153;
+    int mday = day_of_year - (153 * mp + 2) / 5 + 1;
+    int month = mp < 10 ? mp + 3 : mp - 9;
+    int year = year_of_era + era * 400 + (month <= 2);
+    
+    snprintf(date_str, size, "%04d-%02d-%02d", year, month, mday);
+}
+
+int get_today_day(void) {
+    time_t now = time(NULL);
+    struct tm *t = localtime(&now);
+    return days_from_civil(t->tm_year + 1900, t->tm_mon + 1, t->tm_mday);
+}
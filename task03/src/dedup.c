@@ -0,0 +1,561 @@
+#include "dedup.h"
+#include "database.h"
+#include "table.h"
+#include "trigram.h"
+#include "autocomplete.h"
+#include "copy.h"
+#include "recommend.h"
+#include "borrow_index.h"
+#include "analytics.h"
+#include "reminder.h"
+#include "utf8.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <unistd.h>
+
+#define ROWS_PER_BAND (DEDUP_SIGNATURE_SIZE / DEDUP_BANDS)
+#define AUTHOR_SHINGLE (1ULL << 63)    // keeps author shingles apart from title shingles
+
+/**
+ * @brief One book in one LSH band.
+ */
+typedef struct {
+    uint64_t key;       // hash of the band's signature values
+    int32_t index;      // position of the book in the scan
+} BandEntry;
+
+typedef struct {
+    uint64_t multiply;
+    uint64_t add;
+} MinHashFunction;
+
+static uint64_t mix64(uint64_t x) {
+    x ^= x >> 33;
+    x *= 0xff51afd7ed558ccdULL;
+    x ^= x >> 33;
+    x *= 0xc4ceb9fe1a85ec53ULL;
+    x ^= x >> 33;
+    return x;
+}
+
+/**
+ * @brief Derive the signature's hash functions from a fixed seed.
+ * 
+ * Signatures only need to agree within one run, but a fixed seed keeps
+ * the clusters reproducible.
+ */
+static void init_functions(MinHashFunction *functions) {
+    uint64_t state = 0x9e3779b97f4a7c15ULL;
+    for (int i = 0; i < DEDUP_SIGNATURE_SIZE; i++) {
+        state += 0x9e3779b97f4a7c15ULL;
+        functions[i].multiply = mix64(state) | 1;
+        state += 0x9e3779b97f4a7c15ULL;
+        functions[i].add = mix64(state);
+    }
+}
+
+/**
+ * @brief Check whether a non-ASCII code point is punctuation or a space.
+ */
+static int is_separator(uint32_t cp) {
+    return (cp >= 0x00A0 && cp <= 0x00BF) ||    // Latin-1 punctuation, no-break space
+           (cp >= 0x2000 && cp <= 0x206F) ||    // general punctuation
+           (cp >= 0x3000 && cp <= 0x303F) ||    // CJK punctuation, ideographic space
+           (cp >= 0xFF01 && cp <= 0xFF0F);      // full-width punctuation
+}
+
+/**
+ * @brief Normalize text for comparison.
+ * 
+ * ASCII is lower-cased, and spaces, punctuation and anything inside
+ * (), [] or {} (edition and series notes) are dropped, so "The C
+ * Programming Language (2nd ed.)" and "the c-programming language"
+ * become the same text.
+ * 
+ * @return size_t Returns number of code points written.
+ */
+static size_t normalize(const char *text, uint32_t *out, size_t max_count) {
+    size_t count = 0;
+    int depth = 0;
+
+    while (text != NULL && *text && count < max_count) {
+        uint32_t cp;
+        text += utf8_decode(text, &cp);
+
+        if (cp == '(' || cp == '[' || cp == '{') {
+            depth++;
+            continue;
+        }
+        if (cp == ')' || cp == ']' || cp == '}') {
+            depth -= depth > 0;
+            continue;
+        }
+        if (depth > 0) {
+            continue;
+        }
+        if (cp < 0x80) {
+            if (cp >= 'A' && cp <= 'Z') {
+                cp += 'a' - 'A';
+            } else if (!((cp >= 'a' && cp <= 'z') || (cp >= '0' && cp <= '9'))) {
+                continue;
+            }
+        } else if (is_separator(cp)) {
+            continue;
+        }
+        out[count++] = cp;
+    }
+    return count;
+}
+
+/**
+ * @brief Fold the 3-gram shingles of one text into a MinHash signature.
+ * 
+ * A text shorter than three code points is a single shingle.
+ * 
+ * @return int Returns number of shingles added.
+ */
+static int add_shingles(const char *text, uint64_t tag, const MinHashFunction *functions,
+                        uint32_t *signature) {
+    uint32_t cp[DEDUP_MAX_TEXT];
+    size_t length = normalize(text, cp, DEDUP_MAX_TEXT);
+    if (length == 0) {
+        return 0;
+    }
+
+    int shingles = 0;
+    size_t width = length < 3 ? length : 3;
+    for (size_t i = 0; i + width <= length; i++) {
+        uint64_t key = tag;
+        for (size_t j = 0; j < width; j++) {
+            key ^= (uint64_t)cp[i + j] << (21 * (2 - j));
+        }
+        uint64_t hash = mix64(key);
+        for (int k = 0; k < DEDUP_SIGNATURE_SIZE; k++) {
+            uint32_t value = (uint32_t)((hash * functions[k].multiply + functions[k].add) >> 32);
+            if (value < signature[k]) {
+                signature[k] = value;
+            }
+        }
+        shingles++;
+    }
+    return shingles;
+}
+
+static int compare_entries(const void *lhs, const void *rhs) {
+    const BandEntry *a = lhs;
+    const BandEntry *b = rhs;
+    if (a->key != b->key) {
+        return (a->key > b->key) - (a->key < b->key);
+    }
+    return (a->index > b->index) - (a->index < b->index);
+}
+
+static int find_root(int32_t *parent, int32_t i) {
+    while (parent[i] != i) {
+        parent[i] = parent[parent[i]];    // path halving
+        i = parent[i];
+    }
+    return i;
+}
+
+/**
+ * @brief Estimated Jaccard similarity in percent: the share of equal signature values.
+ */
+static int similarity(const uint32_t *a, const uint32_t *b) {
+    int equal = 0;
+    for (int k = 0; k < DEDUP_SIGNATURE_SIZE; k++) {
+        equal += a[k] == b[k];
+    }
+    return equal * 100 / DEDUP_SIGNATURE_SIZE;
+}
+
+/**
+ * @brief Read every book and compute its signature.
+ * 
+ * Books without any shingle get a signature of all 0xFFFFFFFF and are
+ * left out of the buckets.
+ * 
+ * @return int Returns number of books read, -1 on failure.
+ */
+static int load_signatures(sqlite3 *db, int32_t **ids_out, uint32_t **signatures_out, uint8_t **empty_out) {
+    sqlite3_stmt *stmt;
+    if (sqlite3_prepare_v2(db, "SELECT book_id, title, author FROM Books ORDER BY book_id;",
+                           -1, &stmt, NULL) != SQLITE_OK) {
+        fprintf(stderr, "Failed to prepare statement: %s\n", sqlite3_errmsg(db));
+        return -1;
+    }
+
+    MinHashFunction functions[DEDUP_SIGNATURE_SIZE];
+    init_functions(functions);
+
+    int32_t *ids = NULL;
+    uint32_t *signatures = NULL;
+    uint8_t *empty = NULL;
+    int count = 0, capacity = 0, rc;
+    while ((rc = sqlite3_step(stmt)) == SQLITE_ROW) {
+        if (count == capacity) {
+            int grown = capacity ? capacity * 2 : 1024;
+            int32_t *new_ids = realloc(ids, (size_t)grown * sizeof(int32_t));
+            if (new_ids != NULL) {
+                ids = new_ids;
+            }
+            uint32_t *new_signatures = realloc(signatures, (size_t)grown * DEDUP_SIGNATURE_SIZE * sizeof(uint32_t));
+            if (new_signatures != NULL) {
+                signatures = new_signatures;
+            }
+            uint8_t *new_empty = realloc(empty, (size_t)grown);
+            if (new_empty != NULL) {
+                empty = new_empty;
+            }
+            if (new_ids == NULL || new_signatures == NULL || new_empty == NULL) {
+                break;
+            }
+            capacity = grown;
+        }
+
+        uint32_t *signature = &signatures[(size_t)count * DEDUP_SIGNATURE_SIZE];
+        memset(signature, 0xFF, DEDUP_SIGNATURE_SIZE * sizeof(uint32_t));
+        int shingles = add_shingles((const char *)sqlite3_column_text(stmt, 1), 0, functions, signature);
+        shingles += add_shingles((const char *)sqlite3_column_text(stmt, 2), AUTHOR_SHINGLE, functions, signature);
+        ids[count] = sqlite3_column_int(stmt, 0);
+        empty[count] = shingles == 0;
+        count++;
+    }
+
+    if (rc != SQLITE_DONE) {
+        if (rc == SQLITE_ROW) {
+            fprintf(stderr, "Out of memory while reading books\n");
+        } else {
+            fprintf(stderr, "Failed to read books: %s\n", sqlite3_errmsg(db));
+        }
+        sqlite3_finalize(stmt);
+        free(ids);
+        free(signatures);
+        free(empty);
+        return -1;
+    }
+    sqlite3_finalize(stmt);
+
+    *ids_out = ids;
+    *signatures_out = signatures;
+    *empty_out = empty;
+    return count;
+}
+
+/**
+ * @brief Join books that share a bucket in any band and are similar enough.
+ * 
+ * @return int Returns 0 on success, -1 if memory ran out.
+ */
+static int link_candidates(const uint32_t *signatures, const uint8_t *empty, int count,
+                           int threshold, int32_t *parent) {
+    BandEntry *entries = malloc((size_t)(count > 0 ? count : 1) * sizeof(BandEntry));
+    if (entries == NULL) {
+        return -1;
+    }
+
+    for (int band = 0; band < DEDUP_BANDS; band++) {
+        int used = 0;
+        for (int i = 0; i < count; i++) {
+            if (empty[i]) {
+                continue;
+            }
+            const uint32_t *values = &signatures[(size_t)i * DEDUP_SIGNATURE_SIZE + band * ROWS_PER_BAND];
+            uint64_t key = (uint64_t)band;
+            for (int r = 0; r < ROWS_PER_BAND; r++) {
+                key = mix64(key ^ values[r]);
+            }
+            entries[used].key = key;
+            entries[used].index = i;
+            used++;
+        }
+        qsort(entries, (size_t)used, sizeof(BandEntry), compare_entries);
+
+        int start = 0;
+        for (int j = 1; j < used; j++) {
+            if (entries[j].key != entries[start].key) {
+                start = j;
+                continue;
+            }
+            int first = j - DEDUP_BUCKET_PEERS > start ? j - DEDUP_BUCKET_PEERS : start;
+            for (int k = first; k < j; k++) {
+                int32_t a = find_root(parent, entries[k].index);
+                int32_t b = find_root(parent, entries[j].index);
+                if (a == b) {
+                    continue;
+                }
+                if (similarity(&signatures[(size_t)entries[k].index * DEDUP_SIGNATURE_SIZE],
+                               &signatures[(size_t)entries[j].index * DEDUP_SIGNATURE_SIZE]) >= threshold) {
+                    // The lower index (lower book ID) stays the root
+                    if (a < b) {
+                        parent[b] = a;
+                    } else {
+                        parent[a] = b;
+                    }
+                }
+            }
+        }
+    }
+
+    free(entries);
+    return 0;
+}
+
+/**
+ * @brief Find groups of books whose titles and authors are near-duplicates.
+ * 
+ * @param db SQLite database connection.
+ * @param threshold Minimum estimated similarity in percent (1-100).
+ * @param result Pointer to store the clusters; release with free_dedup_result().
+ * @return int Returns number of clusters found, -1 on failure.
+ */
+int find_duplicate_books(sqlite3 *db, int threshold, DedupResult *result) {
+    memset(result, 0, sizeof(*result));
+    if (db == NULL) {
+        fprintf(stderr, "Database connection is NULL\n");
+        return -1;
+    }
+    if (threshold < 1 || threshold > 100) {
+        fprintf(stderr, "Similarity threshold must be between 1 and 100\n");
+        return -1;
+    }
+
+    int32_t *ids;
+    uint32_t *signatures;
+    uint8_t *empty;
+    int count = load_signatures(db, &ids, &signatures, &empty);
+    if (count < 0) {
+        return -1;
+    }
+
+    int32_t *parent = malloc((size_t)(count > 0 ? count : 1) * sizeof(int32_t));
+    int32_t *sizes = calloc((size_t)(count > 0 ? count : 1), sizeof(int32_t));
+    if (parent == NULL || sizes == NULL) {
+        goto out_of_memory;
+    }
+    for (int i = 0; i < count; i++) {
+        parent[i] = i;
+    }
+    if (link_candidates(signatures, empty, count, threshold, parent) != 0) {
+        goto out_of_memory;
+    }
+
+    // Roots are the lowest index of their cluster, so clusters come out in book ID order
+    int clusters = 0, members = 0;
+    for (int i = 0; i < count; i++) {
+        sizes[find_root(parent, i)]++;
+    }
+    for (int i = 0; i < count; i++) {
+        if (parent[i] == i && sizes[i] > 1) {
+            clusters++;
+            members += sizes[i];
+        }
+    }
+
+    result->cluster_start = malloc((size_t)(clusters + 1) * sizeof(int));
+    result->book_ids = malloc((size_t)(members > 0 ? members : 1) * sizeof(int));
+    if (result->cluster_start == NULL || result->book_ids == NULL) {
+        free_dedup_result(result);
+        goto out_of_memory;
+    }
+
+    // sizes[root] becomes the next free slot of the root's cluster
+    int offset = 0;
+    for (int i = 0; i < count; i++) {
+        if (parent[i] == i && sizes[i] > 1) {
+            result->cluster_start[result->cluster_count++] = offset;
+            int size = sizes[i];
+            sizes[i] = offset;
+            offset += size;
+        } else if (parent[i] == i) {
+            sizes[i] = -1;
+        }
+    }
+    result->cluster_start[clusters] = offset;
+    for (int i = 0; i < count; i++) {
+        int32_t root = parent[i];
+        if (sizes[root] >= 0) {
+            result->book_ids[sizes[root]++] = ids[i];
+        }
+    }
+    result->book_count = count;
+
+    free(parent);
+    free(sizes);
+    free(ids);
+    free(signatures);
+    free(empty);
+    return clusters;
+
+out_of_memory:
+    fprintf(stderr, "Out of memory while comparing books\n");
+    free(parent);
+    free(sizes);
+    free(ids);
+    free(signatures);
+    free(empty);
+    return -1;
+}
+
+/**
+ * @brief Release the arrays of a DedupResult.
+ * 
+ * @param result The result.
+ */
+void free_dedup_result(DedupResult *result) {
+    if (result == NULL) {
+        return;
+    }
+    free(result->cluster_start);
+    free(result->book_ids);
+    memset(result, 0, sizeof(*result));
+}
+
+/**
+ * @brief Print the clusters with each book's title, author, ISBN and counts.
+ * 
+ * @param db SQLite database connection.
+ * @param result Clusters from find_duplicate_books().
+ * @return int Returns number of books listed, -1 on failure.
+ */
+int display_duplicate_books(sqlite3 *db, const DedupResult *result) {
+    if (db == NULL) {
+        fprintf(stderr, "Database connection is NULL\n");
+        return -1;
+    }
+
+    sqlite3_stmt *stmt;
+    if (sqlite3_prepare_v2(db, "SELECT title, author, isbn, quantity, available FROM Books WHERE book_id = ?;",
+                           -1, &stmt, NULL) != SQLITE_OK) {
+        fprintf(stderr, "Failed to prepare statement: %s\n", sqlite3_errmsg(db));
+        return -1;
+    }
+
+    static const TableColumn columns[] = {
+        {"Group", 6}, {"Book ID", 8}, {"Title", 36}, {"Author", 20}, {"ISBN", 15}, {"Qty", 5}, {"Avail", 0}
+    };
+    Table table;
+    table_begin(&table, stdout, "\n========== Duplicate Books ==========\n", columns, 7);
+
+    for (int c = 0; c < result->cluster_count; c++) {
+        for (int i = result->cluster_start[c]; i < result->cluster_start[c + 1]; i++) {
+            sqlite3_bind_int(stmt, 1, result->book_ids[i]);
+            if (sqlite3_step(stmt) == SQLITE_ROW) {
+                table_int(&table, c + 1);
+                table_int(&table, result->book_ids[i]);
+                table_text(&table, (const char *)sqlite3_column_text(stmt, 0));
+                table_text(&table, (const char *)sqlite3_column_text(stmt, 1));
+                table_text(&table, (const char *)sqlite3_column_text(stmt, 2));
+                table_int(&table, sqlite3_column_int(stmt, 3));
+                table_int(&table, sqlite3_column_int(stmt, 4));
+            }
+            sqlite3_reset(stmt);
+        }
+    }
+
+    sqlite3_finalize(stmt);
+    return table_end(&table, "--------------------------------------------------------------------------------\n"
+                             "Total: %d books in %d groups\n\n", table.rows, result->cluster_count);
+}
+
+/**
+ * @brief Merge every cluster into its lowest book ID.
+ * 
+ * @param db SQLite database connection.
+ * @param result Clusters from find_duplicate_books().
+ * @return int Returns number of books removed, -1 on failure.
+ */
+int merge_duplicate_books(sqlite3 *db, const DedupResult *result) {
+    if (db == NULL) {
+        fprintf(stderr, "Database connection is NULL\n");
+        return -1;
+    }
+
+    /* ?1 is the kept book, ?2 the duplicate; the counts are added before the row goes */
+    static const char *const sql[] = {
+        "UPDATE Books SET "
+        "quantity = quantity + COALESCE((SELECT quantity FROM Books WHERE book_id = ?2), 0), "
+        "available = available + COALESCE((SELECT available FROM Books WHERE book_id = ?2), 0) "
+        "WHERE book_id = ?1;",
+        "UPDATE Loans SET book_id = ?1 WHERE book_id = ?2;",
+        "UPDATE Copies SET book_id = ?1 WHERE book_id = ?2;",
+        "UPDATE ReminderOutbox SET book_id = ?1 WHERE book_id = ?2;",
+        "DELETE FROM Books WHERE book_id = ?2;",
+    };
+    enum { STATEMENT_COUNT = sizeof(sql) / sizeof(sql[0]) };
+    sqlite3_stmt *stmts[STATEMENT_COUNT] = {NULL};
+
+    for (int s = 0; s < STATEMENT_COUNT; s++) {
+        if (sqlite3_prepare_v2(db, sql[s], -1, &stmts[s], NULL) != SQLITE_OK) {
+            fprintf(stderr, "Failed to prepare statement: %s\n", sqlite3_errmsg(db));
+            for (int t = 0; t < s; t++) {
+                sqlite3_finalize(stmts[t]);
+            }
+            return -1;
+        }
+    }
+
+    int began = begin_savepoint(db, "dedup_merge");
+    if (began < 0) {
+        for (int s = 0; s < STATEMENT_COUNT; s++) {
+            sqlite3_finalize(stmts[s]);
+        }
+        return -1;
+    }
+
+    int removed = 0;
+    for (int c = 0; c < result->cluster_count; c++) {
+        int keep = result->book_ids[result->cluster_start[c]];
+        for (int i = result->cluster_start[c] + 1; i < result->cluster_start[c + 1]; i++) {
+            for (int s = 0; s < STATEMENT_COUNT; s++) {
+                sqlite3_bind_int(stmts[s], 1, keep);
+                sqlite3_bind_int(stmts[s], 2, result->book_ids[i]);
+                int rc = sqlite3_step(stmts[s]);
+                sqlite3_reset(stmts[s]);
+                if (rc != SQLITE_DONE) {
+                    fprintf(stderr, "Failed to merge book %d into %d: %s\n",
+                            result->book_ids[i], keep, sqlite3_errmsg(db));
+                    rollback_savepoint(db, "dedup_merge", began);
+                    for (int t = 0; t < STATEMENT_COUNT; t++) {
+                        sqlite3_finalize(stmts[t]);
+                    }
+                    return -1;
+                }
+            }
+            removed += sqlite3_changes(db);
+        }
+    }
+
+    for (int s = 0; s < STATEMENT_COUNT; s++) {
+        sqlite3_finalize(stmts[s]);
+    }
+    if (release_savepoint(db, "dedup_merge", began) != 0) {
+        return -1;
+    }
+
+    /* Keep the in-memory search indexes and the reminder wheel in step with the deleted rows */
+    for (int c = 0; c < result->cluster_count; c++) {
+        int keep = result->book_ids[result->cluster_start[c]];
+        for (int i = result->cluster_start[c] + 1; i < result->cluster_start[c + 1]; i++) {
+            trigram_remove_book(result->book_ids[i]);
+            autocomplete_remove_book(result->book_ids[i]);
+            reminder_move_book(result->book_ids[i], keep);
+        }
+        autocomplete_refresh_book(db, result->book_ids[result->cluster_start[c]]);
+    }
+
+    /* Copies and loans moved to the kept books: the barcode index and the analytics
+       store reload on next use, and the borrow history files are rebuilt (open or not) */
+    free_copy_index();
+    free_analytics();
+    if (rebuild_recommendations(db, (int)sysconf(_SC_NPROCESSORS_ONLN)) < 0 || rebuild_borrow_index(db) < 0) {
+        fprintf(stderr, "Failed to rebuild the borrow history after merging\n");
+    }
+
+    if (!is_quiet_mode()) {
+        printf("Merged %d duplicate books into %d records\n", removed, result->cluster_count);
+    }
+    return removed;
+}
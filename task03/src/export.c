@@ -0,0 +1,413 @@
+#include "export.h"
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#ifdef HAVE_ZLIB
+#include <zlib.h>
+#endif
+
+/**
+ * @brief An exportable table: its name and the columns written out.
+ */
+typedef struct {
+    const char *name;
+    const char *sql;
+} ExportTable;
+
+/* Search helper columns (chosung/jamo) are derived data and left out */
+static const ExportTable export_tables[] = {
+    {"books", "SELECT book_id, title, author, publisher, publication_year, isbn, genre, quantity, available "
+              "FROM Books ORDER BY book_id;"},
+    {"members", "SELECT member_id, name, phone, address, registration_date, penalty_days, suspended_until "
+                "FROM Members ORDER BY member_id;"},
+    {"loans", "SELECT loan_id, book_id, member_id, loan_date, due_date, is_returned, copy_id "
+              "FROM Loans ORDER BY loan_id;"},
+    {"returns", "SELECT return_id, loan_id, return_date, overdue_days FROM Returns ORDER BY return_id;"},
+};
+
+#define EXPORT_TABLE_COUNT ((int)(sizeof(export_tables) / sizeof(export_tables[0])))
+
+/**
+ * @brief Output of an export: the format buffer and, for gzip, the deflate stream.
+ */
+typedef struct {
+    FILE *out;
+    char *buffer;
+    size_t size;
+    long long bytes;
+    long long written;
+    int failed;
+#ifdef HAVE_ZLIB
+    z_stream *zstream;           // NULL for plain output
+    unsigned char *zbuffer;
+#endif
+} ExportWriter;
+
+int export_parse_format(const char *name) {
+    if (name == NULL) {
+        return -1;
+    }
+    if (strcmp(name, "csv") == 0) {
+        return EXPORT_FORMAT_CSV;
+    }
+    if (strcmp(name, "jsonl") == 0) {
+        return EXPORT_FORMAT_JSONL;
+    }
+    return -1;
+}
+
+int export_gzip_available(void) {
+#ifdef HAVE_ZLIB
+    return 1;
+#else
+    return 0;
+#endif
+}
+
+static double now_seconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+#ifdef HAVE_ZLIB
+/**
+ * @brief Compress data (or finish the stream) and write the compressed blocks.
+ */
+static void deflate_out(ExportWriter *writer, const char *data, size_t length, int flush) {
+    z_stream *zs = writer->zstream;
+    zs->next_in = (Bytef *)data;
+    zs->avail_in = (uInt)length;
+    int rc;
+    do {
+        zs->next_out = writer->zbuffer;
+        zs->avail_out = EXPORT_BUFFER_SIZE;
+        rc = deflate(zs, flush);
+        size_t produced = EXPORT_BUFFER_SIZE - zs->avail_out;
+        if (rc == Z_STREAM_ERROR || fwrite(writer->zbuffer, 1, produced, writer->out) != produced) {
+            writer->failed = 1;
+            return;
+        }
+        writer->written += (long long)produced;
+    } while (zs->avail_out == 0 || (flush == Z_FINISH && rc != Z_STREAM_END));
+}
+#endif
+
+/**
+ * @brief Write out the formatted bytes held in the buffer.
+ */
+static void flush_writer(ExportWriter *writer) {
+    if (writer->size == 0 || writer->failed) {
+        writer->size = 0;
+        return;
+    }
+#ifdef HAVE_ZLIB
+    if (writer->zstream != NULL) {
+        deflate_out(writer, writer->buffer, writer->size, Z_NO_FLUSH);
+        writer->size = 0;
+        return;
+    }
+#endif
+    if (fwrite(writer->buffer, 1, writer->size, writer->out) != writer->size) {
+        writer->failed = 1;
+    }
+    writer->written += (long long)writer->size;
+    writer->size = 0;
+}
+
+static void put(ExportWriter *writer, const char *data, size_t length) {
+    writer->bytes += (long long)length;
+    while (length > 0) {
+        if (writer->size == EXPORT_BUFFER_SIZE) {
+            flush_writer(writer);
+        }
+        size_t room = EXPORT_BUFFER_SIZE - writer->size;
+        size_t chunk = length < room ? length : room;
+        memcpy(writer->buffer + writer->size, data, chunk);
+        writer->size += chunk;
+        data += chunk;
+        length -= chunk;
+    }
+}
+
+static void put_char(ExportWriter *writer, char c) {
+    if (writer->size == EXPORT_BUFFER_SIZE) {
+        flush_writer(writer);
+    }
+    writer->buffer[writer->size++] = c;
+    writer->bytes++;
+}
+
+static void put_int(ExportWriter *writer, long long value) {
+    char digits[24];
+    int n = sizeof(digits);
+    unsigned long long magnitude = value < 0 ? 0ULL - (unsigned long long)value : (unsigned long long)value;
+    do {
+        digits[--n] = (char)('0' + magnitude % 10);
+        magnitude /= 10;
+    } while (magnitude > 0);
+    if (value < 0) {
+        digits[--n] = '-';
+    }
+    put(writer, digits + n, sizeof(digits) - (size_t)n);
+}
+
+static void put_double(ExportWriter *writer, double value) {
+    char number[32];
+    int length = snprintf(number, sizeof(number), "%.17g", value);
+    put(writer, number, (size_t)length);
+}
+
+static void put_csv(ExportWriter *writer, const char *text, size_t length) {
+    if (memchr(text, ',', length) == NULL && memchr(text, '"', length) == NULL &&
+        memchr(text, '\n', length) == NULL && memchr(text, '\r', length) == NULL) {
+        put(writer, text, length);
+        return;
+    }
+
+    // Quote the field and double embedded quotes
+    put_char(writer, '"');
+    const char *end = text + length;
+    const char *quote;
+    while ((quote = memchr(text, '"', (size_t)(end - text))) != NULL) {
+        put(writer, text, (size_t)(quote - text) + 1);
+        put_char(writer, '"');
+        text = quote + 1;
+    }
+    put(writer, text, (size_t)(end - text));
+    put_char(writer, '"');
+}
+
+static void put_json_string(ExportWriter *writer, const char *text, size_t length) {
+    put_char(writer, '"');
+    const char *run = text;
+    const char *end = text + length;
+    for (const char *p = text; p < end; p++) {
+        unsigned char c = (unsigned char)*p;
+        if (c >= 0x20 && c != '"' && c != '\\') {
+            continue;
+        }
+        put(writer, run, (size_t)(p - run));
+        run = p + 1;
+
+        char escape[8];
+        switch (c) {
+            case '"':  put(writer, "\\\"", 2); break;
+            case '\\': put(writer, "\\\\", 2); break;
+            case '\n': put(writer, "\\n", 2); break;
+            case '\r': put(writer, "\\r", 2); break;
+            case '\t': put(writer, "\\t", 2); break;
+            default:
+                snprintf(escape, sizeof(escape), "\\u%04x", c);
+                put(writer, escape, 6);
+        }
+    }
+    put(writer, run, (size_t)(end - run));
+    put_char(writer, '"');
+}
+
+/**
+ * @brief Write one column of the current row.
+ */
+static void put_value(ExportWriter *writer, sqlite3_stmt *stmt, int column, ExportFormat format) {
+    switch (sqlite3_column_type(stmt, column)) {
+        case SQLITE_INTEGER:
+            put_int(writer, sqlite3_column_int64(stmt, column));
+            break;
+        case SQLITE_FLOAT:
+            put_double(writer, sqlite3_column_double(stmt, column));
+            break;
+        case SQLITE_NULL:
+            if (format == EXPORT_FORMAT_JSONL) {
+                put(writer, "null", 4);
+            }
+            break;
+        default: {
+            const char *text = (const char *)sqlite3_column_text(stmt, column);
+            size_t length = (size_t)sqlite3_column_bytes(stmt, column);
+            if (format == EXPORT_FORMAT_JSONL) {
+                put_json_string(writer, text != NULL ? text : "", length);
+            } else {
+                put_csv(writer, text != NULL ? text : "", length);
+            }
+        }
+    }
+}
+
+/**
+ * @brief Stream one table to a file.
+ * 
+ * @param db SQLite database connection.
+ * @param table "books", "members", "loans" or "returns".
+ * @param format The output format.
+ * @param gzip 1 to write a gzip stream.
+ * @param out Destination stream, opened in binary mode.
+ * @param stats Pointer to store the totals, or NULL.
+ * @return long long Returns number of rows exported, -1 on failure.
+ */
+long long export_table(sqlite3 *db, const char *table, ExportFormat format, int gzip, FILE *out,
+                       ExportStats *stats) {
+    const ExportTable *source = NULL;
+    for (int i = 0; table != NULL && i < EXPORT_TABLE_COUNT; i++) {
+        if (strcmp(export_tables[i].name, table) == 0) {
+            source = &export_tables[i];
+        }
+    }
+    if (source == NULL) {
+        fprintf(stderr, "Unknown table: %s\n", table != NULL ? table : "(null)");
+        return -1;
+    }
+    if (gzip && !export_gzip_available()) {
+        fprintf(stderr, "gzip output is not available (built without zlib)\n");
+        return -1;
+    }
+
+    sqlite3_stmt *stmt;
+    if (sqlite3_prepare_v2(db, source->sql, -1, &stmt, NULL) != SQLITE_OK) {
+        fprintf(stderr, "Failed to prepare statement: %s\n", sqlite3_errmsg(db));
+        return -1;
+    }
+
+    ExportWriter writer;
+    memset(&writer, 0, sizeof(writer));
+    writer.out = out;
+    writer.buffer = malloc(EXPORT_BUFFER_SIZE);
+    if (writer.buffer == NULL) {
+        sqlite3_finalize(stmt);
+        return -1;
+    }
+#ifdef HAVE_ZLIB
+    z_stream zs;
+    if (gzip) {
+        memset(&zs, 0, sizeof(zs));
+        writer.zbuffer = malloc(EXPORT_BUFFER_SIZE);
+        // 16 + MAX_WBITS asks for a gzip header and trailer
+        if (writer.zbuffer == NULL ||
+            deflateInit2(&zs, EXPORT_GZIP_LEVEL, Z_DEFLATED, 16 + MAX_WBITS, 8, Z_DEFAULT_STRATEGY) != Z_OK) {
+            free(writer.zbuffer);
+            free(writer.buffer);
+            sqlite3_finalize(stmt);
+            return -1;
+        }
+        writer.zstream = &zs;
+    }
+#endif
+
+    double start = now_seconds();
+    int column_count = sqlite3_column_count(stmt);
+
+    // JSON keys are written once here and copied for every row
+    char **keys = calloc((size_t)column_count, sizeof(char *));
+    size_t *key_lengths = calloc((size_t)column_count, sizeof(size_t));
+    if (keys == NULL || key_lengths == NULL) {
+        writer.failed = 1;
+    }
+    for (int i = 0; !writer.failed && i < column_count; i++) {
+        const char *name = sqlite3_column_name(stmt, i);
+        key_lengths[i] = strlen(name) + 4;
+        keys[i] = malloc(key_lengths[i] + 1);
+        if (keys[i] == NULL) {
+            writer.failed = 1;
+            break;
+        }
+        snprintf(keys[i], key_lengths[i] + 1, "%c\"%s\":", i == 0 ? '{' : ',', name);
+        if (format == EXPORT_FORMAT_CSV) {
+            if (i > 0) {
+                put_char(&writer, ',');
+            }
+            put_csv(&writer, name, strlen(name));
+        }
+    }
+    if (format == EXPORT_FORMAT_CSV) {
+        put(&writer, "\r\n", 2);
+    }
+
+    long long rows = 0;
+    int rc = SQLITE_DONE;
+    while (!writer.failed && (rc = sqlite3_step(stmt)) == SQLITE_ROW) {
+        for (int i = 0; i < column_count; i++) {
+            if (format == EXPORT_FORMAT_JSONL) {
+                put(&writer, keys[i], key_lengths[i]);
+            } else if (i > 0) {
+                put_char(&writer, ',');
+            }
+            put_value(&writer, stmt, i, format);
+        }
+        if (format == EXPORT_FORMAT_JSONL) {
+            put(&writer, "}\n", 2);
+        } else {
+            put(&writer, "\r\n", 2);
+        }
+        rows++;
+    }
+    if (rc != SQLITE_DONE) {
+        fprintf(stderr, "Failed to read %s: %s\n", source->name, sqlite3_errmsg(db));
+        writer.failed = 1;
+    }
+
+    flush_writer(&writer);
+#ifdef HAVE_ZLIB
+    if (writer.zstream != NULL) {
+        if (!writer.failed) {
+            deflate_out(&writer, NULL, 0, Z_FINISH);
+        }
+        deflateEnd(writer.zstream);
+        free(writer.zbuffer);
+    }
+#endif
+    if (!writer.failed && fflush(out) != 0) {
+        writer.failed = 1;
+    }
+
+    for (int i = 0; keys != NULL && i < column_count; i++) {
+        free(keys[i]);
+    }
+    free(keys);
+    free(key_lengths);
+    free(writer.buffer);
+    sqlite3_finalize(stmt);
+
+    if (writer.failed) {
+        if (rc == SQLITE_DONE) {
+            fprintf(stderr, "Failed to write the %s export\n", source->name);
+        }
+        return -1;
+    }
+
+    if (stats != NULL) {
+        stats->rows = rows;
+        stats->bytes = writer.bytes;
+        stats->written = writer.written;
+        stats->seconds = now_seconds() - start;
+        stats->rows_per_second = stats->seconds > 0 ? rows / stats->seconds : 0.0;
+    }
+    return rows;
+}
+
+/**
+ * @brief Stream one table to a file path.
+ * 
+ * @param db SQLite database connection.
+ * @param table "books", "members", "loans" or "returns".
+ * @param format The output format.
+ * @param gzip 1 to write a gzip stream.
+ * @param path Output file, replaced if it exists.
+ * @param stats Pointer to store the totals, or NULL.
+ * @return long long Returns number of rows exported, -1 on failure.
+ */
+long long export_table_to_path(sqlite3 *db, const char *table, ExportFormat format, int gzip,
+                               const char *path, ExportStats *stats) {
+    FILE *out = fopen(path, "wb");
+    if (out == NULL) {
+        fprintf(stderr, "Cannot open output file: %s\n", path);
+        return -1;
+    }
+    // The export does its own buffering
+    setvbuf(out, NULL, _IONBF, 0);
+    long long rows = export_table(db, table, format, gzip, out, stats);
+    if (fclose(out) != 0 && rows >= 0) {
+        fprintf(stderr, "Failed to write %s\n", path);
+        rows = -1;
+    }
+    return rows;
+}
@@ -0,0 +1,173 @@
+#include "hangul.h"
+#include "utf8.h"
+#include <string.h>
+#include <stdint.h>
+
+#define SYLLABLE_FIRST 0xAC00
+#define SYLLABLE_LAST 0xD7A3
+#define JAMO_FIRST 0x3131      // ㄱ (Hangul Compatibility Jamo)
+#define CONSONANT_LAST 0x314E  // ㅎ
+#define JAMO_LAST 0x318E
+
+/* Compatibility jamo for the 19 initials, 21 medials and 27 finals of a syllable */
+static const uint16_t initials[19] = {
+    0x3131, 0x3132, 0x3134, 0x3137, 0x3138, 0x3139, 0x3141, 0x3142, 0x3143, 0x3145,
+    0x3146, 0x3147, 0x3148, 0x3149, 0x314A, 0x314B, 0x314C, 0x314D, 0x314E
+};
+
+static const uint16_t finals[28] = {
+    0, 0x3131, 0x3132, 0x3133, 0x3134, 0x3135, 0x3136, 0x3137, 0x3139, 0x313A,
+    0x313B, 0x313C, 0x313D, 0x313E, 0x313F, 0x3140, 0x3141, 0x3142, 0x3144, 0x3145,
+    0x3146, 0x3147, 0x3148, 0x314A, 0x314B, 0x314C, 0x314D, 0x314E
+};
+
+/* Compound jamo and the two keystrokes that make them */
+static const uint16_t compounds[][3] = {
+    {0x3133, 0x3131, 0x3145},   // ㄳ = ㄱㅅ
+    {0x3135, 0x3134, 0x3148},   // ㄵ = ㄴㅈ
+    {0x3136, 0x3134, 0x314E},   // ㄶ = ㄴㅎ
+    {0x313A, 0x3139, 0x3131},   // ㄺ = ㄹㄱ
+    {0x313B, 0x3139, 0x3141},   // ㄻ = ㄹㅁ
+    {0x313C, 0x3139, 0x3142},   // ㄼ = ㄹㅂ
+    {0x313D, 0x3139, 0x3145},   // ㄽ = ㄹㅅ
+    {0x313E, 0x3139, 0x314C},   // ㄾ = ㄹㅌ
+    {0x313F, 0x3139, 0x314D},   // ㄿ = ㄹㅍ
+    {0x3140, 0x3139, 0x314E},   // ㅀ = ㄹㅎ
+    {0x3144, 0x3142, 0x3145},   // ㅄ = ㅂㅅ
+    {0x3158, 0x3157, 0x314F},   // ㅘ = ㅗㅏ
+    {0x3159, 0x3157, 0x3150},   // ㅙ = ㅗㅐ
+    {0x315A, 0x3157, 0x3163},   // ㅚ = ㅗㅣ
+    {0x315D, 0x315C, 0x3153},   // ㅝ = ㅜㅓ
+    {0x315E, 0x315C, 0x3154},   // ㅞ = ㅜㅔ
+    {0x315F, 0x315C, 0x3163},   // ㅟ = ㅜㅣ
+    {0x3162, 0x3161, 0x3163}    // ㅢ = ㅡㅣ
+};
+
+/**
+ * @brief Output buffer that only ever holds whole UTF-8 characters.
+ */
+typedef struct {
+    char *out;
+    size_t size;
+    size_t used;
+    int full;
+} KeyWriter;
+
+static void put_char(KeyWriter *writer, uint32_t cp) {
+    char bytes[4];
+    int length = utf8_encode(cp, bytes);
+    if (writer->full || writer->used + length + 1 > writer->size) {
+        writer->full = 1;
+        return;
+    }
+    memcpy(writer->out + writer->used, bytes, length);
+    writer->used += length;
+}
+
+/**
+ * @brief Write a jamo, split into its parts if it is a compound.
+ */
+static void put_jamo(KeyWriter *writer, uint32_t jamo) {
+    for (size_t i = 0; i < sizeof(compounds) / sizeof(compounds[0]); i++) {
+        if (compounds[i][0] == jamo) {
+            put_char(writer, compounds[i][1]);
+            put_char(writer, compounds[i][2]);
+            return;
+        }
+    }
+    put_char(writer, jamo);
+}
+
+/**
+ * @brief Lower-case ASCII letters; map spaces and punctuation to 0 (dropped).
+ */
+static uint32_t fold_char(uint32_t cp) {
+    if (cp >= 'A' && cp <= 'Z') {
+        return cp + ('a' - 'A');
+    }
+    if (cp < 0x80 && !((cp >= 'a' && cp <= 'z') || (cp >= '0' && cp <= '9'))) {
+        return 0;
+    }
+    if (cp == 0x3000 || cp == 0x00A0) {   // ideographic / no-break space
+        return 0;
+    }
+    return cp;
+}
+
+static int build_key(const char *text, char *out, size_t out_size, int jamo) {
+    KeyWriter writer = {out, out_size, 0, 0};
+    if (out_size == 0) {
+        return 0;
+    }
+
+    while (text != NULL && *text && !writer.full) {
+        uint32_t cp;
+        text += utf8_decode(text, &cp);
+        cp = fold_char(cp);
+        if (cp == 0) {
+            continue;
+        }
+
+        if (cp >= SYLLABLE_FIRST && cp <= SYLLABLE_LAST) {
+            uint32_t index = cp - SYLLABLE_FIRST;
+            put_char(&writer, initials[index / 588]);
+            if (jamo) {
+                put_jamo(&writer, 0x314F + (index % 588) / 28);
+                if (index % 28 != 0) {
+                    put_jamo(&writer, finals[index % 28]);
+                }
+            }
+        } else if (jamo && cp >= JAMO_FIRST && cp <= JAMO_LAST) {
+            put_jamo(&writer, cp);
+        } else {
+            put_char(&writer, cp);
+        }
+    }
+
+    out[writer.used] = '\0';
+    return (int)writer.used;
+}
+
+int hangul_chosung_key(const char *text, char *out, size_t out_size) {
+    return build_key(text, out, out_size, 0);
+}
+
+int hangul_jamo_key(const char *text, char *out, size_t out_size) {
+    return build_key(text, out, out_size, 1);
+}
+
+int hangul_query_kind(const char *query) {
+    int consonants = 0;
+    int loose_jamo = 0;
+    int others = 0;
+
+    while (query != NULL && *query) {
+        uint32_t cp;
+        query += utf8_decode(query, &cp);
+        if (fold_char(cp) == 0) {
+            continue;
+        }
+        if (cp >= JAMO_FIRST && cp <= CONSONANT_LAST) {
+            consonants++;
+        } else if (cp > CONSONANT_LAST && cp <= JAMO_LAST) {
+            loose_jamo++;
+        } else {
+            others++;
+        }
+    }
+
+    if (consonants > 0 && loose_jamo == 0 && others == 0) {
+        return HANGUL_QUERY_CHOSUNG;
+    }
+    if (consonants + loose_jamo > 0) {
+        return HANGUL_QUERY_JAMO;
+    }
+    return HANGUL_QUERY_PLAIN;
+}
+
+void hangul_prefix_end(const char *prefix, char *end) {
+    size_t length = strlen(prefix);
+    memcpy(end, prefix, length);
+    end[length] = (char)0xFF;   // never occurs in UTF-8, so it sorts after every continuation
+    end[length + 1] = '\0';
+}
@@ -0,0 +1,1103 @@
+#define _GNU_SOURCE   // accept4()
+
+#include "http_server.h"
+#include "database.h"
+#include "date_utils.h"
+#include "isbn.h"
+#include "loan.h"
+#include "result_cache.h"
+#include <arpa/inet.h>
+#include <errno.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <pthread.h>
+#include <stdarg.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#define EVENTS_PER_WAIT 4        // small, so idle workers pick up ready connections
+#define MAX_TARGET_LEN 1024
+#define MAX_PARAM_LEN 256
+
+/* Statement cache slots of the endpoints */
+#define SLOT_SEARCH (STMT_SLOT_HTTP + 0)
+#define SLOT_SEARCH_ISBN (STMT_SLOT_HTTP + 1)
+#define SLOT_BOOK (STMT_SLOT_HTTP + 2)
+#define SLOT_OVERDUE (STMT_SLOT_HTTP + 3)
+#define SLOT_POPULAR (STMT_SLOT_HTTP + 4)
+
+#define BOOK_COLUMNS "book_id, title, author, publisher, publication_year, isbn, genre, quantity, available"
+
+/**
+ * @brief Growable output buffer.
+ */
+typedef struct {
+    char *data;
+    size_t size;
+    size_t capacity;
+    int failed;              // set when an allocation failed
+} HttpBuffer;
+
+/**
+ * @brief One client connection. Only the worker holding its one-shot event touches it.
+ */
+typedef struct HttpConnection {
+    int fd;
+    char request[HTTP_MAX_REQUEST + 1];    // received bytes, NUL-terminated
+    size_t request_size;
+    HttpBuffer response;                   // responses not yet sent
+    size_t response_sent;
+    int close_after_write;
+    struct HttpConnection *prev;
+    struct HttpConnection *next;
+} HttpConnection;
+
+/**
+ * @brief One parsed request.
+ */
+typedef struct {
+    char method[8];
+    char path[MAX_TARGET_LEN];
+    char query[MAX_TARGET_LEN];
+    char body[HTTP_MAX_REQUEST + 1];
+    size_t body_length;
+    int keep_alive;
+} HttpRequest;
+
+/**
+ * @brief Per worker state.
+ */
+typedef struct {
+    pthread_t thread;
+    sqlite3 *db;
+    HttpRequest request;
+    HttpBuffer body;
+    ResultCacheStats cache_stats;    // copy of the thread's cache counters, under the server lock
+} HttpWorker;
+
+typedef struct {
+    int listen_fd;
+    int epoll_fd;
+    int stop_fd;             // eventfd, readable once http_server_stop() is called
+    int port;
+    int worker_count;
+    size_t cache_bytes;      // result cache of each worker, 0 for none
+    int started;             // worker threads running
+    HttpWorker *workers;
+    pthread_mutex_t lock;    // guards the connection list
+    HttpConnection *connections;
+    atomic_long connection_count;
+    atomic_long request_count;
+    atomic_long error_count;
+} HttpServer;
+
+static HttpServer *server = NULL;
+
+/* epoll tags of the two server descriptors (client events carry the connection) */
+static char listen_tag;
+static char stop_tag;
+
+static int buffer_reserve(HttpBuffer *buffer, size_t extra) {
+    if (buffer->failed) {
+        return -1;
+    }
+    if (buffer->size + extra + 1 <= buffer->capacity) {
+        return 0;
+    }
+    size_t capacity = buffer->capacity ? buffer->capacity : 1024;
+    while (capacity < buffer->size + extra + 1) {
+        capacity *= 2;
+    }
+    char *data = realloc(buffer->data, capacity);
+    if (data == NULL) {
+        buffer->failed = 1;
+        return -1;
+    }
+    buffer->data = data;
+    buffer->capacity = capacity;
+    return 0;
+}
+
+static void buffer_append(HttpBuffer *buffer, const char *data, size_t length) {
+    if (buffer_reserve(buffer, length) != 0) {
+        return;
+    }
+    memcpy(buffer->data + buffer->size, data, length);
+    buffer->size += length;
+    buffer->data[buffer->size] = '\0';
+}
+
+static void buffer_puts(HttpBuffer *buffer, const char *text) {
+    buffer_append(buffer, text, strlen(text));
+}
+
+static void buffer_printf(HttpBuffer *buffer, const char *format, ...) {
+    va_list args;
+    va_start(args, format);
+    int length = vsnprintf(NULL, 0, format, args);
+    va_end(args);
+    if (length < 0 || buffer_reserve(buffer, (size_t)length) != 0) {
+        return;
+    }
+    va_start(args, format);
+    vsnprintf(buffer->data + buffer->size, (size_t)length + 1, format, args);
+    va_end(args);
+    buffer->size += (size_t)length;
+}
+
+static void buffer_reset(HttpBuffer *buffer) {
+    buffer->size = 0;
+    buffer->failed = 0;
+}
+
+static void buffer_free(HttpBuffer *buffer) {
+    free(buffer->data);
+    memset(buffer, 0, sizeof(*buffer));
+}
+
+/**
+ * @brief Append text as a JSON string literal (NULL becomes null).
+ */
+static void buffer_json_string(HttpBuffer *buffer, const char *text) {
+    if (text == NULL) {
+        buffer_puts(buffer, "null");
+        return;
+    }
+    buffer_append(buffer, "\"", 1);
+    const char *run = text;
+    for (const unsigned char *p = (const unsigned char *)text; *p != '\0'; p++) {
+        if (*p >= 0x20 && *p != '"' && *p != '\\') {
+            continue;
+        }
+        buffer_append(buffer, run, (size_t)((const char *)p - run));
+        switch (*p) {
+            case '"':  buffer_puts(buffer, "\\\""); break;
+            case '\\': buffer_puts(buffer, "\\\\"); break;
+            case '\n': buffer_puts(buffer, "\\n"); break;
+            case '\r': buffer_puts(buffer, "\\r"); break;
+            case '\t': buffer_puts(buffer, "\\t"); break;
+            default:   buffer_printf(buffer, "\\u%04x", *p);
+        }
+        run = (const char *)p + 1;
+    }
+    buffer_puts(buffer, run);
+    buffer_append(buffer, "\"", 1);
+}
+
+static void json_error(HttpBuffer *body, const char *message) {
+    buffer_reset(body);
+    buffer_puts(body, "{\"error\":");
+    buffer_json_string(body, message);
+    buffer_puts(body, "}");
+}
+
+static const char *status_text(int status) {
+    switch (status) {
+        case 200: return "OK";
+        case 201: return "Created";
+        case 400: return "Bad Request";
+        case 404: return "Not Found";
+        case 405: return "Method Not Allowed";
+        case 409: return "Conflict";
+        case 413: return "Payload Too Large";
+        case 501: return "Not Implemented";
+        default:  return "Internal Server Error";
+    }
+}
+
+static int hex_value(int c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+/**
+ * @brief Decode a URL-encoded value ('+' and %XX) of the given length.
+ */
+static void url_decode(const char *text, size_t length, char *out, size_t size) {
+    size_t n = 0;
+    for (size_t i = 0; i < length && n + 1 < size; i++) {
+        if (text[i] == '+') {
+            out[n++] = ' ';
+        } else if (text[i] == '%' && i + 2 < length &&
+                   hex_value(text[i + 1]) >= 0 && hex_value(text[i + 2]) >= 0) {
+            out[n++] = (char)(hex_value(text[i + 1]) * 16 + hex_value(text[i + 2]));
+            i += 2;
+        } else {
+            out[n++] = text[i];
+        }
+    }
+    out[n] = '\0';
+}
+
+/**
+ * @brief Find a parameter in a query string or form body (name=value&...).
+ * 
+ * @return int Returns 1 if found, 0 otherwise.
+ */
+static int find_form_param(const char *form, const char *name, char *out, size_t size) {
+    size_t name_length = strlen(name);
+    const char *p = form;
+    while (*p != '\0') {
+        const char *end = strchr(p, '&');
+        size_t length = end ? (size_t)(end - p) : strlen(p);
+        if (length > name_length && strncmp(p, name, name_length) == 0 && p[name_length] == '=') {
+            url_decode(p + name_length + 1, length - name_length - 1, out, size);
+            return 1;
+        }
+        if (end == NULL) {
+            break;
+        }
+        p = end + 1;
+    }
+    return 0;
+}
+
+/**
+ * @brief Find a top-level string or number field in a flat JSON object.
+ * 
+ * @return int Returns 1 if found, 0 otherwise.
+ */
+static int find_json_param(const char *json, const char *name, char *out, size_t size) {
+    size_t name_length = strlen(name);
+    for (const char *p = strchr(json, '"'); p != NULL; p = strchr(p + 1, '"')) {
+        if (strncmp(p + 1, name, name_length) != 0 || p[name_length + 1] != '"') {
+            continue;
+        }
+        const char *v = p + name_length + 2;
+        while (*v == ' ' || *v == '\t' || *v == '\r' || *v == '\n') v++;
+        if (*v != ':') {
+            continue;
+        }
+        v++;
+        while (*v == ' ' || *v == '\t' || *v == '\r' || *v == '\n') v++;
+
+        size_t n = 0;
+        if (*v == '"') {
+            for (v++; *v != '\0' && *v != '"' && n + 1 < size; v++) {
+                if (*v == '\\' && v[1] != '\0') {
+                    v++;
+                }
+                out[n++] = *v;
+            }
+        } else {
+            while (*v != '\0' && *v != ',' && *v != '}' && *v != ' ' && *v != '\r' &&
+                   *v != '\n' && n + 1 < size) {
+                out[n++] = *v++;
+            }
+        }
+        out[n] = '\0';
+        return 1;
+    }
+    return 0;
+}
+
+/**
+ * @brief Get a parameter from the query string, then from the body.
+ */
+static int get_param(const HttpRequest *request, const char *name, char *out, size_t size) {
+    if (find_form_param(request->query, name, out, size)) {
+        return 1;
+    }
+    if (request->body_length == 0) {
+        return 0;
+    }
+    if (request->body[0] == '{') {
+        return find_json_param(request->body, name, out, size);
+    }
+    return find_form_param(request->body, name, out, size);
+}
+
+/**
+ * @brief Get a positive integer parameter.
+ * 
+ * @param fallback Value used when the parameter is missing, -1 if it is required.
+ * @return int Returns 0 on success, -1 if the parameter is missing or invalid.
+ */
+static int get_int_param(const HttpRequest *request, const char *name, int fallback, int *value) {
+    char text[MAX_PARAM_LEN];
+    if (!get_param(request, name, text, sizeof(text))) {
+        *value = fallback;
+        return fallback < 0 ? -1 : 0;
+    }
+    char *end;
+    errno = 0;
+    long parsed = strtol(text, &end, 10);
+    if (end == text || *end != '\0' || errno != 0 || parsed <= 0 || parsed > INT32_MAX) {
+        return -1;
+    }
+    *value = (int)parsed;
+    return 0;
+}
+
+/**
+ * @brief Get ?limit= clamped to HTTP_MAX_RESULTS.
+ */
+static int get_limit(const HttpRequest *request, int fallback, int *limit) {
+    if (get_int_param(request, "limit", fallback, limit) != 0) {
+        return -1;
+    }
+    if (*limit > HTTP_MAX_RESULTS) {
+        *limit = HTTP_MAX_RESULTS;
+    }
+    return 0;
+}
+
+/**
+ * @brief Append the current row of a BOOK_COLUMNS query as a JSON object.
+ */
+static void write_book_json(HttpBuffer *body, ResultCursor *cursor) {
+    buffer_printf(body, "{\"book_id\":%d,\"title\":", (int)result_cursor_int(cursor, 0));
+    buffer_json_string(body, result_cursor_text(cursor, 1));
+    buffer_puts(body, ",\"author\":");
+    buffer_json_string(body, result_cursor_text(cursor, 2));
+    buffer_puts(body, ",\"publisher\":");
+    buffer_json_string(body, result_cursor_text(cursor, 3));
+    buffer_printf(body, ",\"publication_year\":%d,\"isbn\":", (int)result_cursor_int(cursor, 4));
+    buffer_json_string(body, result_cursor_text(cursor, 5));
+    buffer_puts(body, ",\"genre\":");
+    buffer_json_string(body, result_cursor_text(cursor, 6));
+    buffer_printf(body, ",\"quantity\":%d,\"available\":%d}",
+                  (int)result_cursor_int(cursor, 7), (int)result_cursor_int(cursor, 8));
+}
+
+/**
+ * @brief Read a statement to the end (through the worker's result cache),
+ *        writing every row as an element of "key".
+ * 
+ * @return int Returns 200, or 500 if a step failed.
+ */
+static int write_rows(HttpBuffer *body, sqlite3_stmt *stmt, const char *key,
+                      void (*write_row)(HttpBuffer *, ResultCursor *)) {
+    buffer_printf(body, "{\"%s\":[", key);
+    int count = 0;
+    int rc;
+    ResultCursor cursor;
+    result_cursor_open(&cursor, stmt);
+    while ((rc = result_cursor_step(&cursor)) == SQLITE_ROW) {
+        if (count++ > 0) {
+            buffer_append(body, ",", 1);
+        }
+        write_row(body, &cursor);
+    }
+    result_cursor_close(&cursor);
+    sqlite3_reset(stmt);
+    if (rc != SQLITE_DONE) {
+        json_error(body, sqlite3_errmsg(get_db_connection()));
+        return 500;
+    }
+    buffer_printf(body, "],\"count\":%d}", count);
+    return 200;
+}
+
+static int handle_search(const HttpRequest *request, HttpBuffer *body) {
+    char text[MAX_PARAM_LEN];
+    int limit;
+    if (!get_param(request, "q", text, sizeof(text)) || text[0] == '\0' ||
+        get_limit(request, HTTP_SEARCH_LIMIT, &limit) != 0) {
+        json_error(body, "q is required and limit must be a positive number");
+        return 400;
+    }
+
+    sqlite3 *db = get_db_connection();
+    sqlite3_stmt *stmt;
+    int64_t isbn = isbn_parse(text);
+    if (isbn != ISBN_INVALID) {
+        stmt = prepare_cached_statement(db, SLOT_SEARCH_ISBN,
+                                        "SELECT " BOOK_COLUMNS " FROM Books WHERE isbn13 = ? "
+                                        "ORDER BY book_id LIMIT ?;");
+        if (stmt != NULL) {
+            sqlite3_bind_int64(stmt, 1, isbn);
+        }
+    } else {
+        stmt = prepare_cached_statement(db, SLOT_SEARCH,
+                                        "SELECT " BOOK_COLUMNS " FROM Books "
+                                        "WHERE title LIKE ?1 OR author LIKE ?1 OR isbn LIKE ?1 "
+                                        "ORDER BY book_id LIMIT ?2;");
+        if (stmt != NULL) {
+            char pattern[MAX_PARAM_LEN + 2];
+            snprintf(pattern, sizeof(pattern), "%%%s%%", text);
+            sqlite3_bind_text(stmt, 1, pattern, -1, SQLITE_TRANSIENT);
+        }
+    }
+    if (stmt == NULL) {
+        json_error(body, sqlite3_errmsg(db));
+        return 500;
+    }
+    sqlite3_bind_int(stmt, 2, limit);
+    return write_rows(body, stmt, "books", write_book_json);
+}
+
+static int handle_book(const char *id_text, HttpBuffer *body) {
+    char *end;
+    long book_id = strtol(id_text, &end, 10);
+    if (end == id_text || *end != '\0' || book_id <= 0 || book_id > INT32_MAX) {
+        json_error(body, "invalid book id");
+        return 400;
+    }
+
+    sqlite3 *db = get_db_connection();
+    sqlite3_stmt *stmt = prepare_cached_statement(db, SLOT_BOOK,
+                                                  "SELECT " BOOK_COLUMNS " FROM Books WHERE book_id = ?;");
+    if (stmt == NULL) {
+        json_error(body, sqlite3_errmsg(db));
+        return 500;
+    }
+    sqlite3_bind_int(stmt, 1, (int)book_id);
+    ResultCursor cursor;
+    result_cursor_open(&cursor, stmt);
+    int rc = result_cursor_step(&cursor);
+    int status = 200;
+    if (rc == SQLITE_ROW) {
+        write_book_json(body, &cursor);
+        result_cursor_step(&cursor);    // reach the end so the row is cached
+    } else if (rc == SQLITE_DONE) {
+        json_error(body, "book not found");
+        status = 404;
+    } else {
+        json_error(body, sqlite3_errmsg(db));
+        status = 500;
+    }
+    result_cursor_close(&cursor);
+    sqlite3_reset(stmt);
+    return status;
+}
+
+static int handle_loan(const HttpRequest *request, HttpBuffer *body) {
+    int book_id, member_id, days;
+    if (get_int_param(request, "book_id", -1, &book_id) != 0 ||
+        get_int_param(request, "member_id", -1, &member_id) != 0 ||
+        get_int_param(request, "days", 14, &days) != 0) {
+        json_error(body, "book_id and member_id are required");
+        return 400;
+    }
+    int loan_id = process_loan(get_db_connection(), book_id, member_id, days);
+    if (loan_id < 0) {
+        json_error(body, "loan refused");
+        return 409;
+    }
+    buffer_printf(body, "{\"loan_id\":%d}", loan_id);
+    return 201;
+}
+
+static int handle_return(const HttpRequest *request, HttpBuffer *body) {
+    int loan_id;
+    if (get_int_param(request, "loan_id", -1, &loan_id) != 0) {
+        json_error(body, "loan_id is required");
+        return 400;
+    }
+    int return_id = process_return(get_db_connection(), loan_id);
+    if (return_id < 0) {
+        json_error(body, "return refused");
+        return 409;
+    }
+    buffer_printf(body, "{\"return_id\":%d}", return_id);
+    return 201;
+}
+
+static void write_overdue_json(HttpBuffer *body, ResultCursor *cursor) {
+    buffer_printf(body, "{\"loan_id\":%d,\"book_id\":%d,\"title\":",
+                  (int)result_cursor_int(cursor, 0), (int)result_cursor_int(cursor, 1));
+    buffer_json_string(body, result_cursor_text(cursor, 2));
+    buffer_printf(body, ",\"member_id\":%d,\"member\":", (int)result_cursor_int(cursor, 3));
+    buffer_json_string(body, result_cursor_text(cursor, 4));
+    buffer_puts(body, ",\"due_date\":");
+    buffer_json_string(body, result_cursor_text(cursor, 5));
+    buffer_printf(body, ",\"overdue_days\":%d}", (int)result_cursor_int(cursor, 6));
+}
+
+static int handle_overdue(const HttpRequest *request, HttpBuffer *body) {
+    int limit;
+    if (get_limit(request, HTTP_MAX_RESULTS, &limit) != 0) {
+        json_error(body, "limit must be a positive number");
+        return 400;
+    }
+
+    sqlite3 *db = get_db_connection();
+    sqlite3_stmt *stmt = prepare_cached_statement(db, SLOT_OVERDUE,
+        "SELECT l.loan_id, b.book_id, b.title, m.member_id, m.name, l.due_date, "
+        "overdue_days(l.due_date, ?1) "
+        "FROM Loans l "
+        "JOIN Books b ON l.book_id = b.book_id "
+        "JOIN Members m ON l.member_id = m.member_id "
+        "WHERE l.is_returned = 0 AND l.due_date < ?1 "
+        "ORDER BY l.due_date ASC, l.loan_id ASC LIMIT ?2;");
+    if (stmt == NULL) {
+        json_error(body, sqlite3_errmsg(db));
+        return 500;
+    }
+    char today[MAX_DATE_LEN];
+    day_to_date(get_today_day(), today, sizeof(today));
+    sqlite3_bind_text(stmt, 1, today, -1, SQLITE_TRANSIENT);
+    sqlite3_bind_int(stmt, 2, limit);
+    return write_rows(body, stmt, "loans", write_overdue_json);
+}
+
+static void write_popular_json(HttpBuffer *body, ResultCursor *cursor) {
+    buffer_printf(body, "{\"book_id\":%d,\"title\":", (int)result_cursor_int(cursor, 0));
+    buffer_json_string(body, result_cursor_text(cursor, 1));
+    buffer_puts(body, ",\"author\":");
+    buffer_json_string(body, result_cursor_text(cursor, 2));
+    buffer_printf(body, ",\"loan_count\":%d}", (int)result_cursor_int(cursor, 3));
+}
+
+static int handle_popular(const HttpRequest *request, HttpBuffer *body) {
+    int limit;
+    if (get_limit(request, 10, &limit) != 0) {
+        json_error(body, "limit must be a positive number");
+        return 400;
+    }
+
+    sqlite3 *db = get_db_connection();
+    sqlite3_stmt *stmt = prepare_cached_statement(db, SLOT_POPULAR,
+        "SELECT b.book_id, b.title, b.author, COUNT(l.loan_id) AS loan_count "
+        "FROM Books b "
+        "LEFT JOIN Loans l ON b.book_id = l.book_id "
+        "GROUP BY b.book_id "
+        "ORDER BY loan_count DESC, b.book_id ASC "
+        "LIMIT ?;");
+    if (stmt == NULL) {
+        json_error(body, sqlite3_errmsg(db));
+        return 500;
+    }
+    sqlite3_bind_int(stmt, 1, limit);
+    return write_rows(body, stmt, "books", write_popular_json);
+}
+
+/**
+ * @brief Dispatch a request to its endpoint.
+ * 
+ * @return int Returns the HTTP status; the JSON response is left in body.
+ */
+static int route_request(const HttpRequest *request, HttpBuffer *body) {
+    int get = strcmp(request->method, "GET") == 0;
+    int post = strcmp(request->method, "POST") == 0;
+    const char *path = request->path;
+
+    int want_post = -1;      // -1 while no route matched
+    int status = 0;
+    if (strcmp(path, "/health") == 0) {
+        want_post = 0;
+        if (get) {
+            buffer_puts(body, "{\"status\":\"ok\"}");
+            status = 200;
+        }
+    } else if (strcmp(path, "/books") == 0) {
+        want_post = 0;
+        if (get) status = handle_search(request, body);
+    } else if (strncmp(path, "/books/", 7) == 0) {
+        want_post = 0;
+        if (get) status = handle_book(path + 7, body);
+    } else if (strcmp(path, "/loans") == 0) {
+        want_post = 1;
+        if (post) status = handle_loan(request, body);
+    } else if (strcmp(path, "/returns") == 0) {
+        want_post = 1;
+        if (post) status = handle_return(request, body);
+    } else if (strcmp(path, "/reports/overdue") == 0) {
+        want_post = 0;
+        if (get) status = handle_overdue(request, body);
+    } else if (strcmp(path, "/reports/popular") == 0) {
+        want_post = 0;
+        if (get) status = handle_popular(request, body);
+    }
+
+    if (want_post < 0) {
+        json_error(body, "no such endpoint");
+        return 404;
+    }
+    if (status == 0) {
+        json_error(body, want_post ? "use POST" : "use GET");
+        return 405;
+    }
+    if (body->failed) {
+        buffer_free(body);
+        json_error(body, "out of memory");
+        return 500;
+    }
+    return status;
+}
+
+/**
+ * @brief Parse the request at the start of the connection buffer.
+ * 
+ * @param consumed Set to the length of the request on success.
+ * @param status Set to the error status on failure.
+ * @return int Returns 1 if a full request was parsed, 0 if more bytes are needed,
+ *         -1 if the request is rejected.
+ */
+static int parse_request(const HttpConnection *conn, HttpRequest *request, size_t *consumed,
+                         int *status) {
+    const char *end = strstr(conn->request, "\r\n\r\n");
+    if (end == NULL) {
+        if (conn->request_size >= HTTP_MAX_REQUEST) {
+            *status = 413;
+            return -1;
+        }
+        return 0;
+    }
+    size_t header_length = (size_t)(end - conn->request) + 4;
+
+    char target[MAX_TARGET_LEN];
+    int minor;
+    if (sscanf(conn->request, "%7s %1023s HTTP/1.%d", request->method, target, &minor) != 3) {
+        *status = 400;
+        return -1;
+    }
+
+    request->keep_alive = minor >= 1;
+    long content_length = 0;
+    for (const char *line = strstr(conn->request, "\r\n") + 2; line < end;
+         line = strstr(line, "\r\n") + 2) {
+        if (strncasecmp(line, "Content-Length:", 15) == 0) {
+            content_length = strtol(line + 15, NULL, 10);
+        } else if (strncasecmp(line, "Transfer-Encoding:", 18) == 0) {
+            *status = 501;
+            return -1;
+        } else if (strncasecmp(line, "Connection:", 11) == 0) {
+            const char *value = line + 11;
+            while (*value == ' ') value++;
+            if (strncasecmp(value, "close", 5) == 0) {
+                request->keep_alive = 0;
+            } else if (strncasecmp(value, "keep-alive", 10) == 0) {
+                request->keep_alive = 1;
+            }
+        }
+    }
+    if (content_length < 0 || (size_t)content_length > HTTP_MAX_REQUEST - header_length) {
+        *status = content_length < 0 ? 400 : 413;
+        return -1;
+    }
+    if (conn->request_size < header_length + (size_t)content_length) {
+        return 0;
+    }
+
+    char *query = strchr(target, '?');
+    if (query != NULL) {
+        *query++ = '\0';
+        strcpy(request->query, query);
+    } else {
+        request->query[0] = '\0';
+    }
+    strcpy(request->path, target);
+    memcpy(request->body, conn->request + header_length, (size_t)content_length);
+    request->body[content_length] = '\0';
+    request->body_length = (size_t)content_length;
+    *consumed = header_length + (size_t)content_length;
+    return 1;
+}
+
+/**
+ * @brief Queue a response with a JSON body on the connection.
+ */
+static void queue_response(HttpConnection *conn, int status, const HttpBuffer *body, int keep_alive) {
+    buffer_printf(&conn->response,
+                  "HTTP/1.1 %d %s\r\n"
+                  "Content-Type: application/json; charset=utf-8\r\n"
+                  "Content-Length: %zu\r\n"
+                  "Connection: %s\r\n\r\n",
+                  status, status_text(status), body->size, keep_alive ? "keep-alive" : "close");
+    buffer_append(&conn->response, body->data, body->size);
+
+    atomic_fetch_add(&server->request_count, 1);
+    if (status >= 400) {
+        atomic_fetch_add(&server->error_count, 1);
+    }
+    if (!keep_alive) {
+        conn->close_after_write = 1;
+    }
+}
+
+/**
+ * @brief Answer every complete request in the connection buffer (pipelining).
+ */
+static void process_requests(HttpConnection *conn, HttpWorker *worker) {
+    HttpRequest *request = &worker->request;
+    while (!conn->close_after_write) {
+        size_t consumed = 0;
+        int status = 0;
+        int rc = parse_request(conn, request, &consumed, &status);
+        if (rc == 0) {
+            break;
+        }
+
+        buffer_reset(&worker->body);
+        if (rc < 0) {
+            json_error(&worker->body, status_text(status));
+            queue_response(conn, status, &worker->body, 0);
+            break;
+        }
+        status = route_request(request, &worker->body);
+        queue_response(conn, status, &worker->body, request->keep_alive);
+
+        conn->request_size -= consumed;
+        memmove(conn->request, conn->request + consumed, conn->request_size);
+        conn->request[conn->request_size] = '\0';
+    }
+}
+
+static void close_connection(HttpConnection *conn) {
+    pthread_mutex_lock(&server->lock);
+    if (conn->prev != NULL) {
+        conn->prev->next = conn->next;
+    } else {
+        server->connections = conn->next;
+    }
+    if (conn->next != NULL) {
+        conn->next->prev = conn->prev;
+    }
+    pthread_mutex_unlock(&server->lock);
+
+    close(conn->fd);
+    buffer_free(&conn->response);
+    free(conn);
+}
+
+/**
+ * @brief Send queued responses until done or the socket is full.
+ * 
+ * @return int Returns 0 on success, -1 if the connection failed.
+ */
+static int flush_responses(HttpConnection *conn) {
+    while (conn->response_sent < conn->response.size) {
+        ssize_t n = send(conn->fd, conn->response.data + conn->response_sent,
+                         conn->response.size - conn->response_sent, MSG_NOSIGNAL);
+        if (n > 0) {
+            conn->response_sent += (size_t)n;
+        } else if (n < 0 && errno == EINTR) {
+            continue;
+        } else if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            return 0;
+        } else {
+            return -1;
+        }
+    }
+    if (conn->response.failed) {
+        return -1;
+    }
+    buffer_reset(&conn->response);
+    conn->response_sent = 0;
+    return 0;
+}
+
+/**
+ * @brief Copy the worker's result cache counters for http_server_stats().
+ */
+static void publish_cache_stats(HttpWorker *worker) {
+    ResultCacheStats stats;
+    if (get_result_cache_stats(&stats) == 0) {
+        pthread_mutex_lock(&server->lock);
+        worker->cache_stats = stats;
+        pthread_mutex_unlock(&server->lock);
+    }
+}
+
+/**
+ * @brief Handle one event of a client connection and re-arm it.
+ */
+static void handle_connection(HttpConnection *conn, uint32_t events, HttpWorker *worker) {
+    if (events & EPOLLERR) {
+        close_connection(conn);
+        return;
+    }
+
+    if (events & (EPOLLIN | EPOLLRDHUP | EPOLLHUP)) {
+        int peer_closed = 0;
+        while (conn->request_size < HTTP_MAX_REQUEST) {
+            ssize_t n = recv(conn->fd, conn->request + conn->request_size,
+                             HTTP_MAX_REQUEST - conn->request_size, 0);
+            if (n > 0) {
+                conn->request_size += (size_t)n;
+            } else if (n == 0) {
+                peer_closed = 1;
+                break;
+            } else if (errno == EINTR) {
+                continue;
+            } else if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                break;
+            } else {
+                close_connection(conn);
+                return;
+            }
+        }
+        conn->request[conn->request_size] = '\0';
+        process_requests(conn, worker);
+        publish_cache_stats(worker);
+        if (peer_closed) {
+            conn->close_after_write = 1;
+        }
+    }
+
+    if (flush_responses(conn) != 0) {
+        close_connection(conn);
+        return;
+    }
+
+    struct epoll_event event = { .data.ptr = conn };
+    if (conn->response.size > 0) {
+        event.events = EPOLLOUT | EPOLLONESHOT;
+    } else if (conn->close_after_write) {
+        close_connection(conn);
+        return;
+    } else {
+        event.events = EPOLLIN | EPOLLRDHUP | EPOLLONESHOT;
+    }
+    if (epoll_ctl(server->epoll_fd, EPOLL_CTL_MOD, conn->fd, &event) != 0) {
+        close_connection(conn);
+    }
+}
+
+/**
+ * @brief Accept every pending connection.
+ */
+static void accept_connections(void) {
+    while (1) {
+        int fd = accept4(server->listen_fd, NULL, NULL, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return;   // EAGAIN, or out of descriptors until a connection closes
+        }
+
+        int one = 1;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+
+        HttpConnection *conn = malloc(sizeof(HttpConnection));
+        if (conn == NULL) {
+            close(fd);
+            continue;
+        }
+        conn->fd = fd;
+        conn->request[0] = '\0';
+        conn->request_size = 0;
+        memset(&conn->response, 0, sizeof(conn->response));
+        conn->response_sent = 0;
+        conn->close_after_write = 0;
+        conn->prev = NULL;
+
+        pthread_mutex_lock(&server->lock);
+        conn->next = server->connections;
+        if (conn->next != NULL) {
+            conn->next->prev = conn;
+        }
+        server->connections = conn;
+        pthread_mutex_unlock(&server->lock);
+        atomic_fetch_add(&server->connection_count, 1);
+
+        struct epoll_event event = { .events = EPOLLIN | EPOLLRDHUP | EPOLLONESHOT, .data.ptr = conn };
+        if (epoll_ctl(server->epoll_fd, EPOLL_CTL_ADD, fd, &event) != 0) {
+            close_connection(conn);
+        }
+    }
+}
+
+static void *worker_main(void *arg) {
+    HttpWorker *worker = arg;
+    set_db_connection(worker->db);
+    if (server->cache_bytes > 0 && load_result_cache(server->cache_bytes) != 0) {
+        fprintf(stderr, "HTTP worker runs without a result cache\n");
+    }
+
+    struct epoll_event events[EVENTS_PER_WAIT];
+    int running = 1;
+    while (running) {
+        int count = epoll_wait(server->epoll_fd, events, EVENTS_PER_WAIT, -1);
+        if (count < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            break;
+        }
+        for (int i = 0; i < count; i++) {
+            if (events[i].data.ptr == &stop_tag) {
+                running = 0;    // level-triggered, so every worker sees it
+            } else if (events[i].data.ptr == &listen_tag) {
+                accept_connections();
+            } else {
+                handle_connection(events[i].data.ptr, events[i].events, worker);
+            }
+        }
+    }
+
+    free_result_cache();
+    set_db_connection(NULL);   // finalizes this thread's cached statements
+    buffer_free(&worker->body);
+    return NULL;
+}
+
+/**
+ * @brief Open the SQLite connection of one worker.
+ */
+static sqlite3 *open_worker_connection(const char *db_path) {
+    sqlite3 *conn;
+    if (sqlite3_open(db_path, &conn) != SQLITE_OK) {
+        fprintf(stderr, "Cannot open database: %s\n", sqlite3_errmsg(conn));
+        sqlite3_close(conn);
+        return NULL;
+    }
+    install_busy_handler(conn);    // wait out another worker's or process's write lock
+    char *err_msg = NULL;
+    if (sqlite3_exec(conn, "PRAGMA journal_mode = WAL; PRAGMA foreign_keys = ON;",
+                     NULL, NULL, &err_msg) != SQLITE_OK) {
+        fprintf(stderr, "SQL error: %s\n", err_msg);
+        sqlite3_free(err_msg);
+        sqlite3_close(conn);
+        return NULL;
+    }
+    return conn;
+}
+
+/**
+ * @brief Create the listening socket and return the bound port.
+ */
+static int open_listen_socket(const HttpServerConfig *config, int *port) {
+    struct sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons((uint16_t)config->port);
+    if (inet_pton(AF_INET, config->address ? config->address : "127.0.0.1", &addr.sin_addr) != 1) {
+        fprintf(stderr, "Invalid listen address: %s\n", config->address);
+        return -1;
+    }
+
+    int fd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (fd < 0) {
+        perror("socket");
+        return -1;
+    }
+    int one = 1;
+    setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+    socklen_t length = sizeof(addr);
+    if (bind(fd, (struct sockaddr *)&addr, sizeof(addr)) != 0 || listen(fd, SOMAXCONN) != 0 ||
+        getsockname(fd, (struct sockaddr *)&addr, &length) != 0) {
+        perror("listen");
+        close(fd);
+        return -1;
+    }
+    *port = ntohs(addr.sin_port);
+    return fd;
+}
+
+int http_server_start(const HttpServerConfig *config) {
+    if (server != NULL || config == NULL || config->db_path == NULL ||
+        config->port < 0 || config->port > 65535) {
+        return -1;
+    }
+
+    server = calloc(1, sizeof(HttpServer));
+    if (server == NULL) {
+        return -1;
+    }
+    server->listen_fd = server->epoll_fd = server->stop_fd = -1;
+    server->connections = NULL;
+    pthread_mutex_init(&server->lock, NULL);
+    server->cache_bytes = config->cache_bytes;
+    server->worker_count = config->workers > 0 ? config->workers : HTTP_DEFAULT_WORKERS;
+    if (server->worker_count > HTTP_MAX_WORKERS) {
+        server->worker_count = HTTP_MAX_WORKERS;
+    }
+    server->workers = calloc((size_t)server->worker_count, sizeof(HttpWorker));
+    if (server->workers == NULL) {
+        http_server_stop();
+        return -1;
+    }
+
+    for (int i = 0; i < server->worker_count; i++) {
+        server->workers[i].db = open_worker_connection(config->db_path);
+        if (server->workers[i].db == NULL) {
+            http_server_stop();
+            return -1;
+        }
+    }
+
+    server->listen_fd = open_listen_socket(config, &server->port);
+    server->epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+    server->stop_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (server->listen_fd < 0 || server->epoll_fd < 0 || server->stop_fd < 0) {
+        http_server_stop();
+        return -1;
+    }
+    struct epoll_event listen_event = { .events = EPOLLIN, .data.ptr = &listen_tag };
+    struct epoll_event stop_event = { .events = EPOLLIN, .data.ptr = &stop_tag };
+    if (epoll_ctl(server->epoll_fd, EPOLL_CTL_ADD, server->listen_fd, &listen_event) != 0 ||
+        epoll_ctl(server->epoll_fd, EPOLL_CTL_ADD, server->stop_fd, &stop_event) != 0) {
+        perror("epoll_ctl");
+        http_server_stop();
+        return -1;
+    }
+
+    for (int i = 0; i < server->worker_count; i++) {
+        if (pthread_create(&server->workers[i].thread, NULL, worker_main, &server->workers[i]) != 0) {
+            fprintf(stderr, "Failed to start HTTP worker %d\n", i);
+            http_server_stop();
+            return -1;
+        }
+        server->started++;
+    }
+    return 0;
+}
+
+int http_server_port(void) {
+    return server != NULL ? server->port : -1;
+}
+
+int http_server_stats(HttpServerStats *stats) {
+    if (server == NULL || stats == NULL) {
+        return -1;
+    }
+    stats->connections = atomic_load(&server->connection_count);
+    stats->requests = atomic_load(&server->request_count);
+    stats->errors = atomic_load(&server->error_count);
+    
+    stats->cache_hits = stats->cache_misses = stats->cache_evictions = 0;
+    pthread_mutex_lock(&server->lock);
+    for (int i = 0; i < server->worker_count; i++) {
+        stats->cache_hits += server->workers[i].cache_stats.hits;
+        stats->cache_misses += server->workers[i].cache_stats.misses;
+        stats->cache_evictions += server->workers[i].cache_stats.evictions;
+    }
+    pthread_mutex_unlock(&server->lock);
+    return 0;
+}
+
+void http_server_stop(void) {
+    if (server == NULL) {
+        return;
+    }
+
+    if (server->stop_fd >= 0) {
+        uint64_t one = 1;
+        if (write(server->stop_fd, &one, sizeof(one)) != sizeof(one)) {
+            perror("write");
+        }
+    }
+    for (int i = 0; i < server->started; i++) {
+        pthread_join(server->workers[i].thread, NULL);
+    }
+
+    while (server->connections != NULL) {
+        close_connection(server->connections);
+    }
+    if (server->workers != NULL) {
+        for (int i = 0; i < server->worker_count; i++) {
+            sqlite3_close(server->workers[i].db);
+        }
+        free(server->workers);
+    }
+    if (server->listen_fd >= 0) close(server->listen_fd);
+    if (server->epoll_fd >= 0) close(server->epoll_fd);
+    if (server->stop_fd >= 0) close(server->stop_fd);
+    pthread_mutex_destroy(&server->lock);
+    free(server);
+    server = NULL;
+}
@@ -0,0 +1,111 @@
+#include "isbn.h"
+#include <stdio.h>
+#include <string.h>
+#include <ctype.h>
+
+/**
+ * @brief Compute the ISBN-13 check digit of the first 12 digits.
+ * 
+ * @param digits Array of at least 12 digit values.
+ * @return int Returns the check digit (0-9).
+ */
+static int isbn13_check_digit(const int *digits) {
+    int sum = 0;
+    for (int i = 0; i < 12; i++) {
+        sum += digits[i] * ((i % 2) ? 3 : 1);
+    }
+    return (10 - sum % 10) % 10;
+}
+
+/**
+ * @brief Skip an optional "ISBN", "ISBN-10" or "ISBN-13" label and separator.
+ * 
+ * @param text The ISBN text.
+ * @return const char* Returns pointer to the first character after the label.
+ */
+static const char *skip_label(const char *text) {
+    while (*text == ' ') {
+        text++;
+    }
+    for (int i = 0; i < 4; i++) {
+        if (toupper((unsigned char)text[i]) != "ISBN"[i]) {
+            return text;
+        }
+    }
+    text += 4;
+    if ((text[0] == '-' || text[0] == ' ') && text[1] == '1' && (text[2] == '0' || text[2] == '3') &&
+        (text[3] == ':' || text[3] == ' ')) {
+        text += 3;
+    }
+    if (*text == ':') {
+        text++;
+    }
+    return text;
+}
+
+int64_t isbn_parse(const char *text) {
+    if (text == NULL) {
+        return ISBN_INVALID;
+    }
+    
+    int digits[13];
+    int count = 0;
+    int has_x = 0;
+    
+    for (const char *p = skip_label(text); *p != '\0'; p++) {
+        if (*p == '-' || *p == ' ') {
+            continue;
+        }
+        if (has_x || count == 13) {
+            return ISBN_INVALID;
+        }
+        if (isdigit((unsigned char)*p)) {
+            digits[count++] = *p - '0';
+        } else if ((*p == 'X' || *p == 'x') && count == 9) {
+            /* X is only allowed as the ISBN-10 check digit */
+            digits[count++] = 10;
+            has_x = 1;
+        } else {
+            return ISBN_INVALID;
+        }
+    }
+    
+    if (count == 10) {
+        int sum = 0;
+        for (int i = 0; i < 10; i++) {
+            sum += digits[i] * (10 - i);
+        }
+        if (sum % 11 != 0) {
+            return ISBN_INVALID;
+        }
+        
+        /* Re-prefix with 978 and recompute the check digit */
+        memmove(digits + 3, digits, 9 * sizeof(int));
+        digits[0] = 9;
+        digits[1] = 7;
+        digits[2] = 8;
+        digits[12] = isbn13_check_digit(digits);
+    } else if (count == 13) {
+        if (has_x || digits[0] != 9 || digits[1] != 7 || (digits[2] != 8 && digits[2] != 9) ||
+            digits[12] != isbn13_check_digit(digits)) {
+            return ISBN_INVALID;
+        }
+    } else {
+        return ISBN_INVALID;
+    }
+    
+    int64_t key = 0;
+    for (int i = 0; i < 13; i++) {
+        key = key * 10 + digits[i];
+    }
+    return key;
+}
+
+int isbn_format(int64_t key, char *out, size_t out_size) {
+    if (out == NULL || out_size < 14 || key < 9780000000000LL || key > 9799999999999LL) {
+        return -1;
+    }
+    
+    snprintf(out, out_size, "%013lld", (long long)key);
+    return isbn_parse(out) == key ? 0 : -1;
+}
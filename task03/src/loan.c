@@ -1,6 +1,16 @@
 #include "loan.h"
+#include "database.h"
 #include "book.h"
 #include "member.h"
+#include "copy.h"
+#include "recommend.h"
+#include "borrow_index.h"
+#include "autocomplete.h"
+#include "rollup.h"
+#include "reminder.h"
+#include "date_utils.h"
+#include "table.h"
+#include "result_cache.h"
 #include <stdio.h>
 #include <string.h>
 #include <time.h>
@@ -92,6 +102,7 @@ int init_loan_tables(sqlite3 *db) {
         "loan_date TEXT NOT NULL,"
         "due_date TEXT NOT NULL,"
         "is_returned INTEGER DEFAULT 0,"
+        "copy_id INTEGER,"
         "FOREIGN KEY (book_id) REFERENCES Books(book_id),"
         "FOREIGN KEY (member_id) REFERENCES Members(member_id)"
         ");";
@@ -130,45 +141,52 @@ int init_loan_tables(sqlite3 *db) {
     return 0;
 }
 
-int process_loan(sqlite3 *db, int book_id, int member_id, int loan_period) {
-    if (db == NULL) {
-        fprintf(stderr, "Database connection is NULL\n");
-        return -1;
-    }
-    
+/**
+ * @brief Insert a loan record and take the book (and copy, if given) off the shelf.
+ * 
+ * @param db SQLite database connection.
+ * @param book_id The ID of the book to loan.
+ * @param copy_id The ID of the physical copy, or 0 to take any copy of the title that is on the shelf.
+ * @param member_id The ID of the member borrowing the book.
+ * @param loan_period The loan period in days.
+ * @return int Returns loan_id on success, -1 on failure.
+ */
+static int insert_loan(sqlite3 *db, int book_id, int copy_id, int member_id, int loan_period) {
     if (loan_period <= 0) {
         loan_period = DEFAULT_LOAN_PERIOD;
     }
     
-    // Check if member can borrow (not suspended)
-    if (!can_member_borrow(db, member_id)) {
-        fprintf(stderr, "Member %d is suspended due to overdue books\n", member_id);
-        return -1;
-    }
-    
-    // Check book availability
-    if (!check_book_availability(book_id)) {
-        fprintf(stderr, "Book %d is not available for loan\n", book_id);
-        return -1;
-    }
-    
     // Get current date and calculate due date
     char loan_date[MAX_DATE_LEN];
     char due_date[MAX_DATE_LEN];
     get_current_date(loan_date, sizeof(loan_date));
     add_days_to_date(loan_date, loan_period, due_date, sizeof(due_date));
     
-    // Begin transaction
-    sqlite3_exec(db, "BEGIN TRANSACTION;", 0, 0, NULL);
+    // Begin transaction (a savepoint, so it nests inside a caller's transaction;
+    // on its own it waits for the write lock up front)
+    int began = begin_savepoint(db, "loan");
+    if (began < 0) {
+        return -1;
+    }
+    
+    // A loan by title takes a registered copy off the shelf when there is one,
+    // so title and barcode loans never lend the same physical copy twice
+    if (copy_id == 0) {
+        copy_id = find_available_copy(db, book_id);
+        if (copy_id < 0) {
+            rollback_savepoint(db, "loan", began);
+            return -1;
+        }
+    }
     
     // Insert loan record
-    const char *sql = "INSERT INTO Loans (book_id, member_id, loan_date, due_date, is_returned) "
-                      "VALUES (?, ?, ?, ?, 0);";
+    const char *sql = "INSERT INTO Loans (book_id, member_id, loan_date, due_date, is_returned, copy_id) "
+                      "VALUES (?, ?, ?, ?, 0, ?);";
     
     sqlite3_stmt *stmt;
     if (sqlite3_prepare_v2(db, sql, -1, &stmt, NULL) != SQLITE_OK) {
         fprintf(stderr, "Failed to prepare statement: %s\n", sqlite3_errmsg(db));
-        sqlite3_exec(db, "ROLLBACK;", 0, 0, NULL);
+        rollback_savepoint(db, "loan", began);
         return -1;
     }
     
@@ -176,33 +194,126 @@ int process_loan(sqlite3 *db, int book_id, int member_id, int loan_period) {
     sqlite3_bind_int(stmt, 2, member_id);
     sqlite3_bind_text(stmt, 3, loan_date, -1, SQLITE_STATIC);
     sqlite3_bind_text(stmt, 4, due_date, -1, SQLITE_STATIC);
+    if (copy_id > 0) {
+        sqlite3_bind_int(stmt, 5, copy_id);
+    } else {
+        sqlite3_bind_null(stmt, 5);
+    }
     
     if (sqlite3_step(stmt) != SQLITE_DONE) {
         fprintf(stderr, "Failed to insert loan record: %s\n", sqlite3_errmsg(db));
         sqlite3_finalize(stmt);
-        sqlite3_exec(db, "ROLLBACK;", 0, 0, NULL);
+        rollback_savepoint(db, "loan", began);
         return -1;
     }
     
     int loan_id = (int)sqlite3_last_insert_rowid(db);
     sqlite3_finalize(stmt);
     
+    // Mark the physical copy as lent out
+    if (copy_id > 0 && set_copy_status(db, copy_id, COPY_AVAILABLE, COPY_ON_LOAN) != 0) {
+        rollback_savepoint(db, "loan", began);
+        return -1;
+    }
+    
     // Update book availability
     if (update_book_availability(book_id, -1) != 0) {
         fprintf(stderr, "Failed to update book availability\n");
-        sqlite3_exec(db, "ROLLBACK;", 0, 0, NULL);
+        rollback_savepoint(db, "loan", began);
         return -1;
     }
     
-    // Commit transaction
-    sqlite3_exec(db, "COMMIT;", 0, 0, NULL);
+    // Track the earliest due date in the member's penalty ledger
+    int due_day;
+    if (date_to_day(due_date, &due_day) != 0 || record_penalty_loan(db, member_id, due_day) != 0) {
+        rollback_savepoint(db, "loan", began);
+        return -1;
+    }
+    
+    // Count the loan in the circulation rollups
+    if (update_circulation_rollups(db) < 0) {
+        rollback_savepoint(db, "loan", began);
+        return -1;
+    }
+    
+    // Commit, or fold into the caller's transaction
+    if (release_savepoint(db, "loan", began) != 0) {
+        return -1;
+    }
     
-    printf("Loan processed successfully (Loan ID: %d)\n", loan_id);
-    printf("Loan Date: %s, Due Date: %s\n", loan_date, due_date);
+    if (copy_id > 0) {
+        update_copy_index(book_id, copy_id, COPY_ON_LOAN, loan_id);
+    }
+    
+    // Fold the new loan into the open co-borrowing matrix, borrow index and autocomplete ranking, if loaded
+    catch_up_recommendations(db);
+    catch_up_borrow_index(db);
+    autocomplete_record_loan(book_id, member_id);
+    
+    // Arm the due-date reminders, if the scheduler is loaded
+    reminder_schedule_loan(loan_id, member_id, book_id, due_day);
+    
+    if (!is_quiet_mode()) {
+        printf("Loan processed successfully (Loan ID: %d)\n", loan_id);
+        printf("Loan Date: %s, Due Date: %s\n", loan_date, due_date);
+    }
     
     return loan_id;
 }
 
+int process_loan(sqlite3 *db, int book_id, int member_id, int loan_period) {
+    if (db == NULL) {
+        fprintf(stderr, "Database connection is NULL\n");
+        return -1;
+    }
+    
+    // Check if member can borrow (not suspended)
+    int eligible = can_member_borrow(db, member_id);
+    if (eligible < 0) {
+        fprintf(stderr, "Member %d not found\n", member_id);
+        return -1;
+    }
+    if (!eligible) {
+        fprintf(stderr, "Member %d is suspended due to overdue books\n", member_id);
+        return -1;
+    }
+    
+    // Check book availability
+    if (!check_book_availability(book_id)) {
+        fprintf(stderr, "Book %d is not available for loan\n", book_id);
+        return -1;
+    }
+    
+    return insert_loan(db, book_id, 0, member_id, loan_period);
+}
+
+int process_copy_loan(sqlite3 *db, int copy_id, int book_id, int member_id, int loan_period) {
+    if (db == NULL) {
+        fprintf(stderr, "Database connection is NULL\n");
+        return -1;
+    }
+    
+    if (copy_id <= 0) {
+        fprintf(stderr, "Invalid copy ID: %d\n", copy_id);
+        return -1;
+    }
+    
+    // Check if member can borrow (not suspended)
+    int eligible = can_member_borrow(db, member_id);
+    if (eligible < 0) {
+        fprintf(stderr, "Member %d not found\n", member_id);
+        return -1;
+    }
+    if (!eligible) {
+        fprintf(stderr, "Member %d is suspended due to overdue books\n", member_id);
+        return -1;
+    }
+    
+    // Copy availability is checked by the caller and enforced by set_copy_status(),
+    // the title's by update_book_availability()
+    return insert_loan(db, book_id, copy_id, member_id, loan_period);
+}
+
 int process_return(sqlite3 *db, int loan_id) {
     if (db == NULL) {
         fprintf(stderr, "Database connection is NULL\n");
@@ -231,8 +342,12 @@ int process_return(sqlite3 *db, int loan_id) {
         overdue_days = 0;
     }
     
-    // Begin transaction
-    sqlite3_exec(db, "BEGIN TRANSACTION;", 0, 0, NULL);
+    // Begin transaction (a savepoint, so it nests inside a caller's transaction;
+    // on its own it waits for the write lock up front)
+    int began = begin_savepoint(db, "loan_return");
+    if (began < 0) {
+        return -1;
+    }
     
     // Insert return record
     const char *insert_sql = "INSERT INTO Returns (loan_id, return_date, overdue_days) "
@@ -241,7 +356,7 @@ int process_return(sqlite3 *db, int loan_id) {
     sqlite3_stmt *stmt;
     if (sqlite3_prepare_v2(db, insert_sql, -1, &stmt, NULL) != SQLITE_OK) {
         fprintf(stderr, "Failed to prepare statement: %s\n", sqlite3_errmsg(db));
-        sqlite3_exec(db, "ROLLBACK;", 0, 0, NULL);
+        rollback_savepoint(db, "loan_return", began);
         return -1;
     }
     
@@ -252,7 +367,7 @@ int process_return(sqlite3 *db, int loan_id) {
     if (sqlite3_step(stmt) != SQLITE_DONE) {
         fprintf(stderr, "Failed to insert return record: %s\n", sqlite3_errmsg(db));
         sqlite3_finalize(stmt);
-        sqlite3_exec(db, "ROLLBACK;", 0, 0, NULL);
+        rollback_savepoint(db, "loan_return", began);
         return -1;
     }
     
@@ -263,7 +378,7 @@ int process_return(sqlite3 *db, int loan_id) {
     const char *update_sql = "UPDATE Loans SET is_returned = 1 WHERE loan_id = ?;";
     if (sqlite3_prepare_v2(db, update_sql, -1, &stmt, NULL) != SQLITE_OK) {
         fprintf(stderr, "Failed to prepare update statement: %s\n", sqlite3_errmsg(db));
-        sqlite3_exec(db, "ROLLBACK;", 0, 0, NULL);
+        rollback_savepoint(db, "loan_return", began);
         return -1;
     }
     
@@ -272,29 +387,58 @@ int process_return(sqlite3 *db, int loan_id) {
     if (sqlite3_step(stmt) != SQLITE_DONE) {
         fprintf(stderr, "Failed to update loan record: %s\n", sqlite3_errmsg(db));
         sqlite3_finalize(stmt);
-        sqlite3_exec(db, "ROLLBACK;", 0, 0, NULL);
+        rollback_savepoint(db, "loan_return", began);
         return -1;
     }
     
     sqlite3_finalize(stmt);
     
+    // Put the physical copy back on the shelf
+    if (loan.copy_id > 0 && set_copy_status(db, loan.copy_id, COPY_ON_LOAN, COPY_AVAILABLE) != 0) {
+        rollback_savepoint(db, "loan_return", began);
+        return -1;
+    }
+    
     // Update book availability
     if (update_book_availability(loan.book_id, 1) != 0) {
         fprintf(stderr, "Failed to update book availability\n");
-        sqlite3_exec(db, "ROLLBACK;", 0, 0, NULL);
+        rollback_savepoint(db, "loan_return", began);
         return -1;
     }
     
-    // Commit transaction
-    sqlite3_exec(db, "COMMIT;", 0, 0, NULL);
+    // Extend the member's suspension for an overdue return
+    int return_day;
+    if (date_to_day(return_date, &return_day) != 0 ||
+        record_penalty_return(db, loan.member_id, return_day, overdue_days) != 0) {
+        rollback_savepoint(db, "loan_return", began);
+        return -1;
+    }
     
-    printf("Return processed successfully (Return ID: %d)\n", return_id);
-    printf("Return Date: %s\n", return_date);
+    // Count the return in the circulation rollups
+    if (update_circulation_rollups(db) < 0) {
+        rollback_savepoint(db, "loan_return", began);
+        return -1;
+    }
+    
+    // Commit, or fold into the caller's transaction
+    if (release_savepoint(db, "loan_return", began) != 0) {
+        return -1;
+    }
+    
+    if (loan.copy_id > 0) {
+        update_copy_index(loan.book_id, loan.copy_id, COPY_AVAILABLE, 0);
+    }
+    reminder_cancel_loan(loan_id);
     
-    if (overdue_days > 0) {
-        int suspension_days = calculate_suspension_days(overdue_days);
-        printf("WARNING: Overdue by %d days. Suspension period: %d days\n", 
-               overdue_days, suspension_days);
+    if (!is_quiet_mode()) {
+        printf("Return processed successfully (Return ID: %d)\n", return_id);
+        printf("Return Date: %s\n", return_date);
+        
+        if (overdue_days > 0) {
+            int suspension_days = calculate_suspension_days(overdue_days);
+            printf("WARNING: Overdue by %d days. Suspension period: %d days\n", 
+                   overdue_days, suspension_days);
+        }
     }
     
     return return_id;
@@ -306,7 +450,7 @@ int get_loan_by_id(sqlite3 *db, int loan_id, Loan *loan) {
         return -1;
     }
     
-    const char *sql = "SELECT loan_id, book_id, member_id, loan_date, due_date, is_returned "
+    const char *sql = "SELECT loan_id, book_id, member_id, loan_date, due_date, is_returned, copy_id "
                       "FROM Loans WHERE loan_id = ?;";
     
     sqlite3_stmt *stmt;
@@ -326,6 +470,7 @@ int get_loan_by_id(sqlite3 *db, int loan_id, Loan *loan) {
         strncpy(loan->due_date, (const char *)sqlite3_column_text(stmt, 4), MAX_DATE_LEN - 1);
         loan->due_date[MAX_DATE_LEN - 1] = '\0';
         loan->is_returned = sqlite3_column_int(stmt, 5);
+        loan->copy_id = sqlite3_column_int(stmt, 6);
         
         sqlite3_finalize(stmt);
         return 0;
@@ -341,7 +486,7 @@ int get_active_loans_by_member(sqlite3 *db, int member_id, Loan *loans, int max_
         return -1;
     }
     
-    const char *sql = "SELECT loan_id, book_id, member_id, loan_date, due_date, is_returned "
+    const char *sql = "SELECT loan_id, book_id, member_id, loan_date, due_date, is_returned, copy_id "
                       "FROM Loans WHERE member_id = ? AND is_returned = 0 "
                       "ORDER BY loan_date DESC LIMIT ?;";
     
@@ -364,6 +509,7 @@ int get_active_loans_by_member(sqlite3 *db, int member_id, Loan *loans, int max_
         strncpy(loans[count].due_date, (const char *)sqlite3_column_text(stmt, 4), MAX_DATE_LEN - 1);
         loans[count].due_date[MAX_DATE_LEN - 1] = '\0';
         loans[count].is_returned = sqlite3_column_int(stmt, 5);
+        loans[count].copy_id = sqlite3_column_int(stmt, 6);
         count++;
     }
     
@@ -377,7 +523,7 @@ int get_active_loans_by_book(sqlite3 *db, int book_id, Loan *loans, int max_coun
         return -1;
     }
     
-    const char *sql = "SELECT loan_id, book_id, member_id, loan_date, due_date, is_returned "
+    const char *sql = "SELECT loan_id, book_id, member_id, loan_date, due_date, is_returned, copy_id "
                       "FROM Loans WHERE book_id = ? AND is_returned = 0 "
                       "ORDER BY loan_date DESC LIMIT ?;";
     
@@ -400,6 +546,7 @@ int get_active_loans_by_book(sqlite3 *db, int book_id, Loan *loans, int max_coun
         strncpy(loans[count].due_date, (const char *)sqlite3_column_text(stmt, 4), MAX_DATE_LEN - 1);
         loans[count].due_date[MAX_DATE_LEN - 1] = '\0';
         loans[count].is_returned = sqlite3_column_int(stmt, 5);
+        loans[count].copy_id = sqlite3_column_int(stmt, 6);
         count++;
     }
     
@@ -446,7 +593,7 @@ int get_overdue_loans(sqlite3 *db, Loan *loans, int max_count) {
     char current_date[MAX_DATE_LEN];
     get_current_date(current_date, sizeof(current_date));
     
-    const char *sql = "SELECT loan_id, book_id, member_id, loan_date, due_date, is_returned "
+    const char *sql = "SELECT loan_id, book_id, member_id, loan_date, due_date, is_returned, copy_id "
                       "FROM Loans WHERE is_returned = 0 AND due_date < ? "
                       "ORDER BY due_date ASC LIMIT ?;";
     
@@ -469,6 +616,7 @@ int get_overdue_loans(sqlite3 *db, Loan *loans, int max_count) {
         strncpy(loans[count].due_date, (const char *)sqlite3_column_text(stmt, 4), MAX_DATE_LEN - 1);
         loans[count].due_date[MAX_DATE_LEN - 1] = '\0';
         loans[count].is_returned = sqlite3_column_int(stmt, 5);
+        loans[count].copy_id = sqlite3_column_int(stmt, 6);
         count++;
     }
     
@@ -482,7 +630,7 @@ int get_loan_history_by_member(sqlite3 *db, int member_id, Loan *loans, int max_
         return -1;
     }
     
-    const char *sql = "SELECT loan_id, book_id, member_id, loan_date, due_date, is_returned "
+    const char *sql = "SELECT loan_id, book_id, member_id, loan_date, due_date, is_returned, copy_id "
                       "FROM Loans WHERE member_id = ? "
                       "ORDER BY loan_date DESC LIMIT ?;";
     
@@ -505,6 +653,7 @@ int get_loan_history_by_member(sqlite3 *db, int member_id, Loan *loans, int max_
         strncpy(loans[count].due_date, (const char *)sqlite3_column_text(stmt, 4), MAX_DATE_LEN - 1);
         loans[count].due_date[MAX_DATE_LEN - 1] = '\0';
         loans[count].is_returned = sqlite3_column_int(stmt, 5);
+        loans[count].copy_id = sqlite3_column_int(stmt, 6);
         count++;
     }
     
@@ -518,7 +667,7 @@ int get_loan_history_by_book(sqlite3 *db, int book_id, Loan *loans, int max_coun
         return -1;
     }
     
-    const char *sql = "SELECT loan_id, book_id, member_id, loan_date, due_date, is_returned "
+    const char *sql = "SELECT loan_id, book_id, member_id, loan_date, due_date, is_returned, copy_id "
                       "FROM Loans WHERE book_id = ? "
                       "ORDER BY loan_date DESC LIMIT ?;";
     
@@ -541,6 +690,7 @@ int get_loan_history_by_book(sqlite3 *db, int book_id, Loan *loans, int max_coun
         strncpy(loans[count].due_date, (const char *)sqlite3_column_text(stmt, 4), MAX_DATE_LEN - 1);
         loans[count].due_date[MAX_DATE_LEN - 1] = '\0';
         loans[count].is_returned = sqlite3_column_int(stmt, 5);
+        loans[count].copy_id = sqlite3_column_int(stmt, 6);
         count++;
     }
     
@@ -571,29 +721,23 @@ int display_active_loans(sqlite3 *db) {
         return -1;
     }
     
-    printf("\n========== Active Loans ==========\n");
-    printf("%-8s %-30s %-20s %-12s %-12s\n", 
-           "Loan ID", "Book Title", "Member", "Loan Date", "Due Date");
-    printf("----------------------------------------------------------\n");
+    static const TableColumn columns[] = {
+        {"Loan ID", 8}, {"Book Title", 30}, {"Member", 20}, {"Loan Date", 12}, {"Due Date", 0}
+    };
+    Table table;
+    table_begin(&table, stdout, "\n========== Active Loans ==========\n", columns, 5);
     
-    int count = 0;
     while (sqlite3_step(stmt) == SQLITE_ROW) {
-        int loan_id = sqlite3_column_int(stmt, 0);
-        const char *title = (const char *)sqlite3_column_text(stmt, 1);
-        const char *name = (const char *)sqlite3_column_text(stmt, 2);
-        const char *loan_date = (const char *)sqlite3_column_text(stmt, 3);
-        const char *due_date = (const char *)sqlite3_column_text(stmt, 4);
-        
-        printf("%-8d %-30s %-20s %-12s %-12s\n", 
-               loan_id, title, name, loan_date, due_date);
-        count++;
+        table_int(&table, sqlite3_column_int(stmt, 0));
+        table_text(&table, (const char *)sqlite3_column_text(stmt, 1));
+        table_text(&table, (const char *)sqlite3_column_text(stmt, 2));
+        table_text(&table, (const char *)sqlite3_column_text(stmt, 3));
+        table_text(&table, (const char *)sqlite3_column_text(stmt, 4));
     }
     
-    printf("----------------------------------------------------------\n");
-    printf("Total: %d active loans\n\n", count);
-    
     sqlite3_finalize(stmt);
-    return count;
+    return table_end(&table, "----------------------------------------------------------\n"
+                             "Total: %d active loans\n\n", table.rows);
 }
 
 int display_overdue_report(sqlite3 *db) {
@@ -605,13 +749,15 @@ int display_overdue_report(sqlite3 *db) {
     char current_date[MAX_DATE_LEN];
     get_current_date(current_date, sizeof(current_date));
     
+    // Earliest due date first is most overdue first, so idx_loans_active_due serves the sort
     const char *sql = "SELECT l.loan_id, b.title, m.name, l.loan_date, l.due_date, "
-                      "julianday(?) - julianday(l.due_date) AS overdue_days "
+                      "overdue_days(l.due_date, ?1) AS overdue_days, "
+                      "suspension_days(overdue_days(l.due_date, ?1)) "
                       "FROM Loans l "
                       "JOIN Books b ON l.book_id = b.book_id "
                       "JOIN Members m ON l.member_id = m.member_id "
-                      "WHERE l.is_returned = 0 AND l.due_date < ? "
-                      "ORDER BY overdue_days DESC;";
+                      "WHERE l.is_returned = 0 AND l.due_date < ?1 "
+                      "ORDER BY l.due_date ASC, l.loan_id ASC;";
     
     sqlite3_stmt *stmt;
     if (sqlite3_prepare_v2(db, sql, -1, &stmt, NULL) != SQLITE_OK) {
@@ -620,33 +766,30 @@ int display_overdue_report(sqlite3 *db) {
     }
     
     sqlite3_bind_text(stmt, 1, current_date, -1, SQLITE_STATIC);
-    sqlite3_bind_text(stmt, 2, current_date, -1, SQLITE_STATIC);
-    
-    printf("\n========== Overdue Loans Report ==========\n");
-    printf("%-8s %-30s %-20s %-12s %-12s %s\n", 
-           "Loan ID", "Book Title", "Member", "Loan Date", "Due Date", "Overdue(Days)");
-    printf("--------------------------------------------------------------------------------\n");
-    
-    int count = 0;
-    while (sqlite3_step(stmt) == SQLITE_ROW) {
-        int loan_id = sqlite3_column_int(stmt, 0);
-        const char *title = (const char *)sqlite3_column_text(stmt, 1);
-        const char *name = (const char *)sqlite3_column_text(stmt, 2);
-        const char *loan_date = (const char *)sqlite3_column_text(stmt, 3);
-        const char *due_date = (const char *)sqlite3_column_text(stmt, 4);
-        int overdue_days = sqlite3_column_int(stmt, 5);
-        
-        printf("%-8d %-30s %-20s %-12s %-12s %d (Susp: %d days)\n", 
-               loan_id, title, name, loan_date, due_date, 
-               overdue_days, calculate_suspension_days(overdue_days));
-        count++;
-    }
-    
-    printf("--------------------------------------------------------------------------------\n");
-    printf("Total: %d overdue loans\n\n", count);
     
+    static const TableColumn columns[] = {
+        {"Loan ID", 8}, {"Book Title", 30}, {"Member", 20}, {"Loan Date", 12}, {"Due Date", 12},
+        {"Overdue(Days)", 13}, {"Suspension(Days)", 0}
+    };
+    Table table;
+    table_begin(&table, stdout, "\n========== Overdue Loans Report ==========\n", columns, 7);
+    
+    ResultCursor cursor;
+    result_cursor_open(&cursor, stmt);
+    while (result_cursor_step(&cursor) == SQLITE_ROW) {
+        table_int(&table, result_cursor_int(&cursor, 0));
+        table_text(&table, result_cursor_text(&cursor, 1));
+        table_text(&table, result_cursor_text(&cursor, 2));
+        table_text(&table, result_cursor_text(&cursor, 3));
+        table_text(&table, result_cursor_text(&cursor, 4));
+        table_int(&table, result_cursor_int(&cursor, 5));
+        table_int(&table, result_cursor_int(&cursor, 6));
+    }
+    
+    result_cursor_close(&cursor);
     sqlite3_finalize(stmt);
-    return count;
+    return table_end(&table, "--------------------------------------------------------------------------------\n"
+                             "Total: %d overdue loans\n\n", table.rows);
 }
 
 int get_popular_books(sqlite3 *db, int limit) {
@@ -670,25 +813,23 @@ int get_popular_books(sqlite3 *db, int limit) {
     
     sqlite3_bind_int(stmt, 1, limit);
     
-    printf("\n========== Popular Books Report ==========\n");
-    printf("%-8s %-40s %-25s %s\n", 
-           "Book ID", "Title", "Author", "Loan Count");
-    printf("-----------------------------------------------------------------------------------\n");
+    static const TableColumn columns[] = {
+        {"Book ID", 8}, {"Title", 40}, {"Author", 25}, {"Loan Count", 0}
+    };
+    Table table;
+    table_begin(&table, stdout, "\n========== Popular Books Report ==========\n", columns, 4);
     
-    int count = 0;
-    while (sqlite3_step(stmt) == SQLITE_ROW) {
-        int book_id = sqlite3_column_int(stmt, 0);
-        const char *title = (const char *)sqlite3_column_text(stmt, 1);
-        const char *author = (const char *)sqlite3_column_text(stmt, 2);
-        int loan_count = sqlite3_column_int(stmt, 3);
-        
-        printf("%-8d %-40s %-25s %d\n", book_id, title, author, loan_count);
-        count++;
+    ResultCursor cursor;
+    result_cursor_open(&cursor, stmt);
+    while (result_cursor_step(&cursor) == SQLITE_ROW) {
+        table_int(&table, result_cursor_int(&cursor, 0));
+        table_text(&table, result_cursor_text(&cursor, 1));
+        table_text(&table, result_cursor_text(&cursor, 2));
+        table_int(&table, result_cursor_int(&cursor, 3));
     }
     
-    printf("-----------------------------------------------------------------------------------\n");
-    printf("Total: %d books\n\n", count);
-    
+    result_cursor_close(&cursor);
     sqlite3_finalize(stmt);
-    return count;
+    return table_end(&table, "-----------------------------------------------------------------------------------\n"
+                             "Total: %d books\n\n", table.rows);
 }
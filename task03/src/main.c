@@ -5,6 +5,22 @@
 #include "book.h"
 #include "member.h"
 #include "loan.h"
+#include "copy.h"
+#include "recommend.h"
+#include "borrow_index.h"
+#include "trigram.h"
+#include "autocomplete.h"
+#include "analytics.h"
+#include "date_utils.h"
+#include "rollup.h"
+#include "dashboard.h"
+#include "reminder.h"
+#include "cli.h"
+#include "table.h"
+#include "result_cache.h"
+#include "marc.h"
+#include "dedup.h"
+#include <unistd.h>
 
 #define MAX_INPUT 256
 
@@ -46,6 +62,10 @@ void display_book_menu(void) {
     printf("5. 전체 도서 목록\n");
     printf("6. 장르별 검색\n");
     printf("7. 저자별 검색\n");
+    printf("8. 복본 등록 (바코드)\n");
+    printf("9. 자동완성 (제목/저자)\n");
+    printf("10. MARC21 파일 가져오기\n");
+    printf("11. 중복 도서 찾기/병합\n");
     printf("0. 메인 메뉴로\n");
     printf("=====================\n");
     printf("선택: ");
@@ -82,6 +102,8 @@ void display_loan_menu(void) {
     printf("5. 연체 도서 목록\n");
     printf("6. 대출 이력 조회 (회원)\n");
     printf("7. 대출 이력 조회 (도서)\n");
+    printf("8. 바코드 대출\n");
+    printf("9. 바코드 반납\n");
     printf("0. 메인 메뉴로\n");
     printf("=========================\n");
     printf("선택: ");
@@ -93,10 +115,16 @@ void display_loan_menu(void) {
 void display_report_menu(void) {
     printf("\n");
     printf("===== 보고서 =====\n");
-    printf("1. 인기 도서 Top 10\n");
+    printf("1. 인기 도서 Top 10 / 대출 통계\n");
     printf("2. 연체 현황 보고서\n");
     printf("3. 도서 재고 현황\n");
     printf("4. 회원 통계\n");
+    printf("5. 함께 대출된 도서 추천\n");
+    printf("6. 추천 데이터 재생성\n");
+    printf("7. 대출/반납 추이 (일별/월별)\n");
+    printf("8. 목록 출력 형식 (표/CSV/TSV/JSON)\n");
+    printf("9. 조회 캐시/DB 잠금 대기 통계\n");
+    printf("10. 도서별 대출 회원 (여러 도서)\n");
     printf("0. 메인 메뉴로\n");
     printf("==================\n");
     printf("선택: ");
@@ -159,7 +187,20 @@ void handle_book_menu(void) {
                 printf("검색어 (제목/저자/ISBN): ");
                 fgets(title, sizeof(title), stdin);
                 title[strcspn(title, "\n")] = 0;
-                search_book(title);
+                if (search_book(title) == 0) {
+                    /* 오타가 있어도 찾을 수 있도록 유사 검색 결과 제시 */
+                    FuzzyMatch matches[10];
+                    int found = fuzzy_search_books(title, matches, 10);
+                    if (found > 0) {
+                        printf("\n혹시 이 도서를 찾으셨나요?\n");
+                        for (int i = 0; i < found; i++) {
+                            Book book;
+                            if (get_book_by_id(matches[i].book_id, &book) == 0) {
+                                printf("  [%d] %s - %s\n", book.book_id, book.title, book.author);
+                            }
+                        }
+                    }
+                }
                 break;
                 
             case 3: /* 도서 수정 */
@@ -234,6 +275,97 @@ void handle_book_menu(void) {
                 search_books_by_author(author);
                 break;
                 
+            case 8: /* 복본 등록 (바코드) */
+                {
+                    char barcode[MAX_BARCODE_LEN];
+                    printf("\n=== 복본 등록 ===\n");
+                    printf("도서 ID: ");
+                    scanf("%d", &book_id);
+                    clear_input_buffer();
+                    
+                    printf("바코드: ");
+                    fgets(barcode, sizeof(barcode), stdin);
+                    barcode[strcspn(barcode, "\n")] = 0;
+                    
+                    int copy_id = add_copy(get_db_connection(), book_id, barcode);
+                    if (copy_id > 0) {
+                        printf("복본 등록 성공 (복본 ID: %d)\n", copy_id);
+                    }
+                }
+                break;
+                
+            case 9: /* 자동완성 (제목/저자) */
+                {
+                    Completion completions[5];
+                    printf("\n=== 자동완성 ===\n");
+                    printf("입력 (초성/자모 가능): ");
+                    fgets(title, sizeof(title), stdin);
+                    title[strcspn(title, "\n")] = 0;
+                    
+                    int count = autocomplete(AUTOCOMPLETE_TITLE, title, completions, 5);
+                    printf("[제목]\n");
+                    for (int i = 0; i < count; i++) {
+                        printf("  %s (ID: %d, 대출 %d회)\n", completions[i].text,
+                               completions[i].id, completions[i].loans);
+                    }
+                    
+                    count = autocomplete(AUTOCOMPLETE_AUTHOR, title, completions, 5);
+                    printf("[저자]\n");
+                    for (int i = 0; i < count; i++) {
+                        printf("  %s (대출 %d회)\n", completions[i].text, completions[i].loans);
+                    }
+                }
+                break;
+                
+            case 10: /* MARC21 파일 가져오기 */
+                {
+                    char path[MAX_INPUT];
+                    printf("\n=== MARC21 파일 가져오기 ===\n");
+                    printf("파일 경로: ");
+                    fgets(path, sizeof(path), stdin);
+                    path[strcspn(path, "\n")] = 0;
+                    
+                    MarcLoadStats stats;
+                    int threads = (int)sysconf(_SC_NPROCESSORS_ONLN);
+                    if (load_marc_file(get_db_connection(), path, threads, &stats) < 0) {
+                        printf("가져오기 실패\n");
+                        break;
+                    }
+                    printf("레코드 %ld건: 등록 %ld, 중복 ISBN %ld, 제외 %ld (%.1f초, 분당 %.0f건)\n",
+                           stats.records, stats.inserted, stats.duplicates, stats.rejected,
+                           stats.seconds, stats.records_per_minute);
+                }
+                break;
+                
+            case 11: /* 중복 도서 찾기/병합 */
+                {
+                    DedupResult clusters;
+                    printf("\n=== 중복 도서 찾기 ===\n");
+                    if (find_duplicate_books(get_db_connection(), DEDUP_DEFAULT_THRESHOLD, &clusters) < 0) {
+                        printf("중복 검사 실패\n");
+                        break;
+                    }
+                    if (clusters.cluster_count == 0) {
+                        printf("중복 후보가 없습니다. (도서 %d권 검사)\n", clusters.book_count);
+                        free_dedup_result(&clusters);
+                        break;
+                    }
+                    display_duplicate_books(get_db_connection(), &clusters);
+                    
+                    printf("각 그룹을 가장 작은 도서 ID로 병합하시겠습니까? (y/n): ");
+                    char confirm;
+                    scanf("%c", &confirm);
+                    clear_input_buffer();
+                    
+                    if (confirm == 'y' || confirm == 'Y') {
+                        merge_duplicate_books(get_db_connection(), &clusters);
+                    } else {
+                        printf("병합이 취소되었습니다.\n");
+                    }
+                    free_dedup_result(&clusters);
+                }
+                break;
+                
             case 0:
                 return;
                 
@@ -313,23 +445,48 @@ void handle_member_menu(void) {
                 scanf("%d", &member_id);
                 clear_input_buffer();
                 
-                Member member;
-                if (search_member_by_id(db, member_id, &member) == 0) {
-                    printf("\n회원 ID: %d\n", member.member_id);
-                    printf("이름: %s\n", member.name);
-                    printf("전화번호: %s\n", member.phone);
-                    printf("주소: %s\n", member.address);
-                    printf("등록일: %s\n", member.registration_date);
-                    printf("연체 일수: %d일\n", member.overdue_days);
-                    printf("대출 정지 일수: %d일\n", member.suspension_days);
+                {
+                    static unsigned char arena[DASHBOARD_ARENA_SIZE];
+                    MemberDashboard dash;
                     
-                    if (member.overdue_days > 0) {
-                        printf("⚠️  연체 중입니다!\n");
+                    if (get_member_dashboard(db, member_id, DASHBOARD_HISTORY_LIMIT,
+                                             arena, sizeof(arena), &dash) == 0) {
+                        printf("\n회원 ID: %d\n", dash.member.member_id);
+                        printf("이름: %s\n", dash.member.name);
+                        printf("전화번호: %s\n", dash.member.phone);
+                        printf("주소: %s\n", dash.member.address);
+                        printf("등록일: %s\n", dash.member.registration_date);
+                        printf("연체 일수: %d일\n", dash.member.overdue_days);
+                        printf("대출 정지 일수: %d일\n", dash.member.suspension_days);
+                        
+                        if (dash.overdue_loans > 0) {
+                            printf("⚠️  연체 중입니다! (연체 도서 %d권)\n", dash.overdue_loans);
+                        } else {
+                            printf("✅ 정상 회원입니다.\n");
+                        }
+                        
+                        printf("\n[대출 중인 도서: %d권]\n", dash.active_count);
+                        for (int i = 0; i < dash.active_count; i++) {
+                            const DashboardLoan *loan = &dash.active_loans[i];
+                            printf("  %-8d %-30s 반납 예정일 %s", loan->loan_id, loan->title, loan->due_date);
+                            if (loan->overdue_days > 0) {
+                                printf(" (연체 %d일)", loan->overdue_days);
+                            }
+                            printf("\n");
+                        }
+                        
+                        printf("\n[최근 대출 이력: %d/%d건]\n", dash.history_count, dash.total_loans);
+                        for (int i = 0; i < dash.history_count; i++) {
+                            const DashboardLoan *loan = &dash.history[i];
+                            printf("  %-8d %-30s %s ~ %s\n", loan->loan_id, loan->title, loan->loan_date,
+                                   loan->is_returned ? loan->return_date : "대출중");
+                        }
+                        if (dash.truncated) {
+                            printf("  ... (일부 항목 생략)\n");
+                        }
                     } else {
-                        printf("✅ 정상 회원입니다.\n");
+                        printf("회원을 찾을 수 없습니다.\n");
                     }
-                } else {
-                    printf("회원을 찾을 수 없습니다.\n");
                 }
                 break;
                 
@@ -551,6 +708,34 @@ void handle_loan_menu(void) {
                 }
                 break;
                 
+            case 8: /* 바코드 대출 */
+                {
+                    char barcode[MAX_BARCODE_LEN];
+                    printf("\n=== 바코드 대출 ===\n");
+                    printf("회원 ID: ");
+                    scanf("%d", &member_id);
+                    clear_input_buffer();
+                    
+                    printf("바코드: ");
+                    fgets(barcode, sizeof(barcode), stdin);
+                    barcode[strcspn(barcode, "\n")] = 0;
+                    
+                    loan_by_barcode(db, barcode, member_id, 0);
+                }
+                break;
+                
+            case 9: /* 바코드 반납 */
+                {
+                    char barcode[MAX_BARCODE_LEN];
+                    printf("\n=== 바코드 반납 ===\n");
+                    printf("바코드: ");
+                    fgets(barcode, sizeof(barcode), stdin);
+                    barcode[strcspn(barcode, "\n")] = 0;
+                    
+                    return_by_barcode(db, barcode);
+                }
+                break;
+                
             case 0:
                 return;
                 
@@ -578,8 +763,16 @@ void handle_report_menu(void) {
         clear_input_buffer();
         
         switch (choice) {
-            case 1: /* 인기 도서 Top 10 */
-                get_popular_books(db, 10);
+            case 1: /* 인기 도서 Top 10 / 대출 통계 (장르별/대출 현황) */
+                {
+                    /* First use loads every loan; later uses only read new rows */
+                    int threads = (int)sysconf(_SC_NPROCESSORS_ONLN);
+                    if (refresh_analytics(db, threads) < 0) {
+                        printf("통계 데이터를 불러오지 못했습니다.\n");
+                        break;
+                    }
+                    display_analytics_report(get_today_day(), 10);
+                }
                 break;
                 
             case 2: /* 연체 현황 보고서 */
@@ -587,28 +780,191 @@ void handle_report_menu(void) {
                 break;
                 
             case 3: /* 도서 재고 현황 */
-                printf("\n=== 도서 재고 현황 ===\n");
-                display_all_books();
+                {
+                    /* Active loans per title from the column store; the full list is in book management */
+                    InventorySummary summary;
+                    int threads = (int)sysconf(_SC_NPROCESSORS_ONLN);
+                    if (refresh_analytics(db, threads) < 0 || analytics_inventory_summary(&summary) != 0) {
+                        printf("통계 데이터를 불러오지 못했습니다.\n");
+                        break;
+                    }
+                    printf("\n=== 도서 재고 현황 ===\n");
+                    printf("도서 종수: %d종\n", summary.titles);
+                    printf("총 보유 권수: %d권\n", summary.copies);
+                    printf("대출 중: %d권\n", summary.on_loan);
+                    printf("대출 가능: %d권\n", summary.copies - summary.on_loan);
+                    printf("재고 없는 도서: %d종\n", summary.out_of_stock);
+                }
                 break;
                 
             case 4: /* 회원 통계 */
                 {
-                    int total = get_member_count(db);
+                    /* Same column store as the loan statistics; members are reloaded, loans read incrementally */
+                    MemberSummary summary;
+                    int threads = (int)sysconf(_SC_NPROCESSORS_ONLN);
+                    if (refresh_analytics(db, threads) < 0 ||
+                        analytics_member_summary(get_today_day(), &summary) != 0) {
+                        printf("통계 데이터를 불러오지 못했습니다.\n");
+                        break;
+                    }
                     printf("\n=== 회원 통계 ===\n");
-                    printf("총 회원 수: %d명\n", total);
+                    printf("총 회원 수: %d명\n", summary.total_members);
+                    printf("신규 회원 수 (최근 %d일): %d명\n", ANALYTICS_NEW_MEMBER_DAYS, summary.new_members);
+                    printf("대출 중인 회원 수: %d명\n", summary.active_members);
+                    printf("연체 회원 수: %d명\n", summary.overdue_members);
+                    printf("대출 정지 회원 수: %d명\n", summary.suspended_members);
+                }
+                break;
+                
+            case 5: /* 함께 대출된 도서 추천 */
+                {
+                    int book_id, member_id;
+                    Recommendation recs[RECOMMEND_MAX_NEIGHBORS];
+                    
+                    printf("도서 ID: ");
+                    if (scanf("%d", &book_id) != 1) {
+                        clear_input_buffer();
+                        printf("잘못된 입력입니다.\n");
+                        break;
+                    }
+                    clear_input_buffer();
+                    printf("회원 ID (이미 빌린 책 제외, 0: 전체): ");
+                    if (scanf("%d", &member_id) != 1) {
+                        member_id = 0;
+                    }
+                    clear_input_buffer();
+                    
+                    int count = get_similar_books(book_id, recs, RECOMMEND_MAX_NEIGHBORS);
+                    if (count < 0) {
+                        printf("추천 데이터가 없습니다. 먼저 추천 데이터를 생성해주세요.\n");
+                        break;
+                    }
+                    
+                    printf("\n=== 함께 대출된 도서 (도서 ID: %d) ===\n", book_id);
+                    int shown = 0;
+                    for (int i = 0; i < count && shown < 10; i++) {
+                        Book book;
+                        if (member_id > 0 && borrow_index_has_borrowed(member_id, recs[i].book_id) == 1) {
+                            continue;
+                        }
+                        if (get_book_by_id(recs[i].book_id, &book) == 0) {
+                            printf("%2d. [%d] %s - %s (%d명)\n", ++shown, book.book_id,
+                                   book.title, book.author, recs[i].score);
+                        }
+                    }
+                    if (shown == 0) {
+                        printf("함께 대출된 도서가 없습니다.\n");
+                    }
+                }
+                break;
+                
+            case 6: /* 추천 데이터 재생성 */
+                {
+                    int threads = (int)sysconf(_SC_NPROCESSORS_ONLN);
+                    int rows = build_recommendations(db, RECOMMEND_PATH, threads);
+                    if (rows >= 0 && open_recommendations(RECOMMEND_PATH) == 0) {
+                        printf("추천 데이터를 생성했습니다. (도서 %d권)\n", rows);
+                    } else {
+                        printf("추천 데이터 생성 실패\n");
+                    }
+                    
+                    /* The borrow history index comes from the same loans */
+                    int pairs = build_borrow_index(db, BORROW_INDEX_PATH);
+                    if (pairs >= 0 && open_borrow_index(BORROW_INDEX_PATH) == 0) {
+                        printf("대출 이력 색인을 생성했습니다. (회원-도서 %d쌍)\n", pairs);
+                    } else {
+                        printf("대출 이력 색인 생성 실패\n");
+                    }
+                }
+                break;
+                
+            case 7: /* 대출/반납 추이 (일별/월별) */
+                {
+                    int unit;
+                    char from_date[MAX_INPUT], to_date[MAX_INPUT], genre[MAX_INPUT];
+                    
+                    printf("단위 (1: 일별, 2: 월별): ");
+                    if (scanf("%d", &unit) != 1 || (unit != 1 && unit != 2)) {
+                        clear_input_buffer();
+                        printf("잘못된 입력입니다.\n");
+                        break;
+                    }
+                    clear_input_buffer();
+                    
+                    printf("시작일 (YYYY-MM-DD): ");
+                    fgets(from_date, sizeof(from_date), stdin);
+                    from_date[strcspn(from_date, "\n")] = 0;
+                    
+                    printf("종료일 (YYYY-MM-DD): ");
+                    fgets(to_date, sizeof(to_date), stdin);
+                    to_date[strcspn(to_date, "\n")] = 0;
+                    
+                    printf("장르 (전체는 Enter): ");
+                    fgets(genre, sizeof(genre), stdin);
+                    genre[strcspn(genre, "\n")] = 0;
+                    
+                    if (display_circulation_report(db, unit == 1 ? ROLLUP_DAILY : ROLLUP_MONTHLY,
+                                                   from_date, to_date, genre[0] ? genre : NULL) < 0) {
+                        printf("추이 보고서를 만들지 못했습니다.\n");
+                    }
+                }
+                break;
+                
+            case 8: /* 목록 출력 형식 */
+                {
+                    char format[MAX_INPUT];
+                    printf("형식 (table, csv, tsv, json): ");
+                    fgets(format, sizeof(format), stdin);
+                    format[strcspn(format, "\n")] = 0;
                     
-                    /* 연체 회원 수 조회 */
-                    const char *sql = "SELECT COUNT(DISTINCT member_id) FROM Loans "
-                                     "WHERE is_returned = 0 AND date('now') > date(due_date);";
+                    int parsed = table_parse_format(format);
+                    if (parsed < 0) {
+                        printf("알 수 없는 형식입니다.\n");
+                        break;
+                    }
+                    table_set_format((TableFormat)parsed);
+                    printf("목록을 %s 형식으로 출력합니다.\n", format);
+                }
+                break;
+                
+            case 9: /* 조회 캐시/DB 잠금 대기 통계 */
+                if (display_result_cache_stats() < 0) {
+                    printf("조회 결과 캐시가 꺼져 있습니다.\n");
+                }
+                display_retry_stats();
+                break;
+                
+            case 10: /* 도서별 대출 회원 (여러 도서) */
+                {
+                    char line[MAX_INPUT];
+                    int book_ids[32], count = 0;
+                    printf("도서 ID (공백으로 구분): ");
+                    fgets(line, sizeof(line), stdin);
+                    for (char *token = strtok(line, " ,\n"); token != NULL && count < 32;
+                         token = strtok(NULL, " ,\n")) {
+                        book_ids[count++] = atoi(token);
+                    }
                     
-                    sqlite3_stmt *stmt;
-                    if (sqlite3_prepare_v2(db, sql, -1, &stmt, NULL) == SQLITE_OK) {
-                        if (sqlite3_step(stmt) == SQLITE_ROW) {
-                            int overdue_count = sqlite3_column_int(stmt, 0);
-                            printf("연체 회원 수: %d명\n", overdue_count);
+                    RoaringBitmap any, all;
+                    roaring_init(&any);
+                    roaring_init(&all);
+                    int any_count = borrow_index_members_of_any(book_ids, count, &any);
+                    int all_count = borrow_index_members_of_all(book_ids, count, &all);
+                    if (any_count < 0 || all_count < 0) {
+                        printf("대출 이력 색인이 없습니다. 먼저 추천 데이터를 생성해주세요.\n");
+                    } else {
+                        printf("하나라도 빌린 회원: %d명, 모두 빌린 회원: %d명\n", any_count, all_count);
+                        uint32_t ids[20];
+                        long listed = roaring_to_array(&all, ids, 20);
+                        for (long i = 0; i < listed; i++) {
+                            printf("%s%u", i == 0 ? "  모두 빌린 회원 ID: " : ", ", ids[i]);
+                        }
+                        if (listed > 0) {
+                            printf("%s\n", all_count > listed ? ", ..." : "");
                         }
-                        sqlite3_finalize(stmt);
                     }
+                    roaring_free(&any);
+                    roaring_free(&all);
                 }
                 break;
                 
@@ -623,8 +979,21 @@ void handle_report_menu(void) {
 
 /**
  * @brief Main function - entry point of the program.
+ * 
+ * With arguments, runs them as a batch command (see cli_main()) instead
+ * of the interactive menus.
  */
-int main(void) {
+int main(int argc, char *argv[]) {
+    if (argc > 1) {
+        return cli_main(argc, argv);
+    }
+    
+    /* Listing format for scripts that capture the interactive output */
+    const char *format = getenv("LIBRARY_TABLE_FORMAT");
+    if (format != NULL && table_parse_format(format) >= 0) {
+        table_set_format((TableFormat)table_parse_format(format));
+    }
+    
     printf("\n");
     printf("########################################\n");
     printf("#                                      #\n");
@@ -654,10 +1023,54 @@ int main(void) {
         return EXIT_FAILURE;
     }
     
+    /* Count loans and returns recorded before the rollup tables existed */
+    if (update_circulation_rollups(db) < 0) {
+        fprintf(stderr, "대출 추이 집계 실패\n");
+    }
+    
+    /* Load barcode index for copy-level loans */
+    if (load_copy_index(db) < 0) {
+        fprintf(stderr, "바코드 색인 로드 실패\n");
+        close_database();
+        return EXIT_FAILURE;
+    }
+    
+    /* Build autocomplete tries for titles, authors and member names */
+    if (load_autocomplete(db) < 0) {
+        fprintf(stderr, "자동완성 색인 로드 실패\n");
+    }
+    
+    /* Map co-borrowing recommendations and fold in loans made since the last build */
+    if (access(RECOMMEND_PATH, R_OK) == 0 && open_recommendations(RECOMMEND_PATH) == 0) {
+        catch_up_recommendations(db);
+    }
+    
+    /* Map the member/book borrow history, building it on first run */
+    if ((access(BORROW_INDEX_PATH, R_OK) == 0 || build_borrow_index(db, BORROW_INDEX_PATH) >= 0) &&
+        open_borrow_index(BORROW_INDEX_PATH) == 0) {
+        catch_up_borrow_index(db);
+    }
+    
+    /* Replay repeated reports and searches until the next write */
+    if (load_result_cache(RESULT_CACHE_DEFAULT_BUDGET) < 0) {
+        fprintf(stderr, "조회 결과 캐시 초기화 실패\n");
+    }
+    
+    /* Schedule due-date reminders and queue the ones due today */
+    if (load_reminder_scheduler(db, get_today_day()) < 0 ||
+        advance_reminders(db, get_today_day(), NULL, NULL) < 0) {
+        fprintf(stderr, "반납 알림 예약 실패\n");
+    }
+    
     int choice;
     
     /* Main loop */
     while (1) {
+        /* Queue reminders for any day that passed while the program was open */
+        if (reminder_pending_count() >= 0) {
+            advance_reminders(db, get_today_day(), NULL, NULL);
+        }
+        
         display_main_menu();
         
         if (scanf("%d", &choice) != 1) {
@@ -686,6 +1099,16 @@ int main(void) {
                 
             case 0:
                 printf("\n프로그램을 종료합니다.\n");
+                free_copy_index();
+                free_trigram_index();
+                free_autocomplete();
+                free_analytics();
+                flush_recommendations();    // keep the loans folded in this session
+                close_recommendations();
+                flush_borrow_index();
+                close_borrow_index();
+                free_reminder_scheduler();
+                free_result_cache();
                 close_database();
                 return EXIT_SUCCESS;
                 
@@ -0,0 +1,629 @@
+#include "marc.h"
+#include "database.h"
+#include "hangul.h"
+#include "isbn.h"
+#include "trigram.h"
+#include "autocomplete.h"
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <pthread.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#define NO_TEXT UINT32_MAX       // offset of an absent field
+
+/**
+ * @brief One parsed book, ready to bind: offsets of NUL-terminated text in MarcBatch.text.
+ */
+typedef struct {
+    uint32_t title;
+    uint32_t author;
+    uint32_t publisher;
+    uint32_t isbn;
+    uint32_t genre;
+    uint32_t title_chosung;
+    uint32_t title_jamo;
+    uint32_t author_chosung;
+    uint32_t author_jamo;
+    int year;
+    int64_t isbn13;
+} MarcRow;
+
+/**
+ * @brief The rows of one chunk; the arrays are reused from chunk to chunk.
+ */
+typedef struct {
+    long chunk;              // chunk held when ready
+    int ready;
+    MarcRow *rows;
+    int count;
+    int capacity;
+    char *text;
+    size_t text_size;
+    size_t text_capacity;
+    long records;
+    long rejected;
+    int failed;              // out of memory
+} MarcBatch;
+
+/**
+ * @brief State shared by the parser threads and the inserting thread.
+ */
+typedef struct {
+    const char *map;
+    size_t size;
+    long chunk_count;
+    long next_chunk;         // next chunk to parse
+    long next_insert;        // next chunk to insert
+    int depth;               // number of batches
+    MarcBatch *batches;      // chunk k is parsed into batches[k % depth]
+    int stop;
+    pthread_mutex_t lock;
+    pthread_cond_t changed;
+} MarcLoader;
+
+static double now_seconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/**
+ * @brief Read a fixed-width decimal number.
+ * 
+ * @return int Returns the number, -1 if a character is not a digit.
+ */
+static int parse_number(const char *p, int digits) {
+    int value = 0;
+    for (int i = 0; i < digits; i++) {
+        if (p[i] < '0' || p[i] > '9') {
+            return -1;
+        }
+        value = value * 10 + (p[i] - '0');
+    }
+    return value;
+}
+
+/**
+ * @brief Find a subfield of a data field (after its two indicators).
+ */
+static MarcSlice find_subfield(const char *field, int length, char code) {
+    MarcSlice slice = {NULL, 0};
+    const char *end = field + length;
+    for (const char *p = field + 2; p + 1 < end; p++) {
+        if (*p != MARC_SUBFIELD_DELIMITER || p[1] != code) {
+            continue;
+        }
+        const char *value = p + 2;
+        const char *next = memchr(value, MARC_SUBFIELD_DELIMITER, (size_t)(end - value));
+        slice.text = value;
+        slice.length = (int)((next != NULL ? next : end) - value);
+        return slice;
+    }
+    return slice;
+}
+
+/**
+ * @brief Drop surrounding spaces and trailing ISBD punctuation.
+ */
+static void trim_slice(MarcSlice *slice) {
+    if (slice->text == NULL) {
+        return;
+    }
+    while (slice->length > 0 && slice->text[0] == ' ') {
+        slice->text++;
+        slice->length--;
+    }
+    while (slice->length > 0 && strchr(" /:;,.=", slice->text[slice->length - 1]) != NULL) {
+        slice->length--;
+    }
+    if (slice->length == 0) {
+        slice->text = NULL;
+    }
+}
+
+/**
+ * @brief Get the first four consecutive digits of a slice as a year.
+ */
+static int slice_year(MarcSlice slice) {
+    for (int i = 0; slice.text != NULL && i + 4 <= slice.length; i++) {
+        int year = parse_number(slice.text + i, 4);
+        if (year > 0) {
+            return year;
+        }
+    }
+    return 0;
+}
+
+/**
+ * @brief Parse one MARC21 record without copying or allocating.
+ * 
+ * @param data Start of the record (its leader).
+ * @param length Bytes available from data; the record may be shorter.
+ * @param record Pointer to store the fields.
+ * @return int Returns the record length in bytes, -1 if the record is malformed.
+ */
+int marc_parse_record(const char *data, size_t length, MarcRecord *record) {
+    memset(record, 0, sizeof(*record));
+    if (length < MARC_LEADER_LEN + 1) {
+        return -1;
+    }
+    int record_length = parse_number(data, 5);
+    int base = parse_number(data + 12, 5);
+    if (record_length <= MARC_LEADER_LEN || (size_t)record_length > length ||
+        data[record_length - 1] != MARC_RECORD_TERMINATOR ||
+        base <= MARC_LEADER_LEN || base >= record_length || data[base - 1] != MARC_FIELD_TERMINATOR) {
+        return -1;
+    }
+    record->utf8 = data[9] == 'a';
+
+    int author_rank = 0;         // 3 for 100, 2 for 110, 1 for 700
+    MarcSlice date = {NULL, 0};
+    int date_from_264 = 0;
+    int publisher_from_264 = 0;
+    int genre_from_655 = 0;
+    int year_008 = 0;
+
+    // Directory: 12-byte entries (tag, length, start) up to the field terminator
+    for (const char *entry = data + MARC_LEADER_LEN; entry + 12 <= data + base - 1; entry += 12) {
+        int field_length = parse_number(entry + 3, 4);
+        int start = parse_number(entry + 7, 5);
+        if (field_length < 1 || start < 0 || base + start + field_length > record_length - 1) {
+            return -1;
+        }
+        const char *field = data + base + start;
+        int content = field[field_length - 1] == MARC_FIELD_TERMINATOR ? field_length - 1 : field_length;
+        int tag = parse_number(entry, 3);
+
+        if (tag == 8) {
+            if (content >= 11) {
+                year_008 = parse_number(field + 7, 4);
+            }
+            continue;
+        }
+        if (tag < 10 || content < 2) {
+            continue;    // other control fields have no subfields
+        }
+        switch (tag) {
+            case 245:
+                if (record->title.text == NULL) {
+                    record->title = find_subfield(field, content, 'a');
+                }
+                break;
+            case 100:
+            case 110:
+            case 700: {
+                int rank = tag == 100 ? 3 : (tag == 110 ? 2 : 1);
+                if (rank > author_rank) {
+                    MarcSlice name = find_subfield(field, content, 'a');
+                    if (name.text != NULL) {
+                        record->author = name;
+                        author_rank = rank;
+                    }
+                }
+                break;
+            }
+            case 260:
+            case 264:
+                if (record->publisher.text == NULL || (tag == 264 && !publisher_from_264)) {
+                    MarcSlice name = find_subfield(field, content, 'b');
+                    if (name.text != NULL) {
+                        record->publisher = name;
+                        publisher_from_264 = tag == 264;
+                    }
+                }
+                if (date.text == NULL || (tag == 264 && !date_from_264)) {
+                    MarcSlice value = find_subfield(field, content, 'c');
+                    if (value.text != NULL) {
+                        date = value;
+                        date_from_264 = tag == 264;
+                    }
+                }
+                break;
+            case 20:
+                if (record->isbn.text == NULL) {
+                    MarcSlice isbn = find_subfield(field, content, 'a');
+                    for (int i = 0; isbn.text != NULL && i < isbn.length; i++) {
+                        if (isbn.text[i] == ' ' || isbn.text[i] == '(') {
+                            isbn.length = i;    // "9780441172719 (pbk.)"
+                        }
+                    }
+                    record->isbn = isbn;
+                }
+                break;
+            case 650:
+            case 655:
+                if (record->genre.text == NULL || (tag == 655 && !genre_from_655)) {
+                    MarcSlice term = find_subfield(field, content, 'a');
+                    if (term.text != NULL) {
+                        record->genre = term;
+                        genre_from_655 = tag == 655;
+                    }
+                }
+                break;
+            default:
+                break;
+        }
+    }
+
+    trim_slice(&record->title);
+    trim_slice(&record->author);
+    trim_slice(&record->publisher);
+    trim_slice(&record->isbn);
+    trim_slice(&record->genre);
+    record->year = year_008 > 0 ? year_008 : slice_year(date);
+    return record_length;
+}
+
+/**
+ * @brief Find where the first record at or after offset starts.
+ */
+static size_t chunk_start(const MarcLoader *loader, size_t offset) {
+    if (offset == 0) {
+        return 0;
+    }
+    if (offset >= loader->size) {
+        return loader->size;
+    }
+    const char *end = memchr(loader->map + offset - 1, MARC_RECORD_TERMINATOR, loader->size - offset + 1);
+    return end != NULL ? (size_t)(end - loader->map) + 1 : loader->size;
+}
+
+static int has_non_ascii(MarcSlice slice) {
+    for (int i = 0; i < slice.length; i++) {
+        if ((unsigned char)slice.text[i] >= 0x80) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+/**
+ * @brief Copy a slice into the batch arena as a NUL-terminated string.
+ * 
+ * @return uint32_t Returns the offset, or NO_TEXT for an absent field.
+ */
+static uint32_t put_text(MarcBatch *batch, MarcSlice slice) {
+    if (slice.text == NULL) {
+        return NO_TEXT;
+    }
+    uint32_t offset = (uint32_t)batch->text_size;
+    memcpy(batch->text + batch->text_size, slice.text, (size_t)slice.length);
+    batch->text[batch->text_size + (size_t)slice.length] = '\0';
+    batch->text_size += (size_t)slice.length + 1;
+    return offset;
+}
+
+/**
+ * @brief Append a Hangul key of arena text to the arena.
+ */
+static uint32_t put_key(MarcBatch *batch, uint32_t source, int (*make_key)(const char *, char *, size_t)) {
+    uint32_t offset = (uint32_t)batch->text_size;
+    int length = make_key(source != NO_TEXT ? batch->text + source : "", batch->text + offset, HANGUL_KEY_LEN);
+    batch->text_size += (size_t)length + 1;
+    return offset;
+}
+
+/**
+ * @brief Parse one chunk of the file into a batch of rows.
+ */
+static void parse_chunk(const MarcLoader *loader, long chunk, MarcBatch *batch) {
+    batch->count = 0;
+    batch->text_size = 0;
+    batch->records = 0;
+    batch->rejected = 0;
+    batch->failed = 0;
+
+    size_t pos = chunk_start(loader, (size_t)chunk * MARC_CHUNK_BYTES);
+    size_t end = chunk_start(loader, (size_t)(chunk + 1) * MARC_CHUNK_BYTES);
+    while (pos < end) {
+        const char *data = loader->map + pos;
+        if (*data == '\n' || *data == '\r') {
+            pos++;    // line breaks some exporters put between records
+            continue;
+        }
+
+        MarcRecord record;
+        int length = marc_parse_record(data, end - pos, &record);
+        batch->records++;
+        if (length < 0) {
+            batch->rejected++;
+            const char *next = memchr(data, MARC_RECORD_TERMINATOR, end - pos);
+            pos = next != NULL ? (size_t)(next - loader->map) + 1 : end;
+            continue;
+        }
+        pos += (size_t)length;
+
+        if (record.title.text == NULL ||
+            (!record.utf8 && (has_non_ascii(record.title) || has_non_ascii(record.author) ||
+                              has_non_ascii(record.publisher) || has_non_ascii(record.genre)))) {
+            batch->rejected++;    // MARC-8 diacritics would need a character set conversion
+            continue;
+        }
+
+        // Room for the five fields and four keys, so nothing below can fail
+        size_t needed = (size_t)(record.title.length + record.author.length + record.publisher.length +
+                                 record.isbn.length + record.genre.length) + 5 + 4 * HANGUL_KEY_LEN;
+        if (batch->text_size + needed > batch->text_capacity) {
+            size_t capacity = batch->text_capacity ? batch->text_capacity * 2 : MARC_CHUNK_BYTES;
+            while (capacity < batch->text_size + needed) {
+                capacity *= 2;
+            }
+            char *text = realloc(batch->text, capacity);
+            if (text == NULL) {
+                batch->failed = 1;
+                return;
+            }
+            batch->text = text;
+            batch->text_capacity = capacity;
+        }
+        if (batch->count == batch->capacity) {
+            int capacity = batch->capacity ? batch->capacity * 2 : 1024;
+            MarcRow *rows = realloc(batch->rows, (size_t)capacity * sizeof(MarcRow));
+            if (rows == NULL) {
+                batch->failed = 1;
+                return;
+            }
+            batch->rows = rows;
+            batch->capacity = capacity;
+        }
+
+        MarcRow *row = &batch->rows[batch->count++];
+        row->title = put_text(batch, record.title);
+        row->author = put_text(batch, record.author);
+        row->publisher = put_text(batch, record.publisher);
+        row->isbn = put_text(batch, record.isbn);
+        row->genre = put_text(batch, record.genre);
+        row->title_chosung = put_key(batch, row->title, hangul_chosung_key);
+        row->title_jamo = put_key(batch, row->title, hangul_jamo_key);
+        row->author_chosung = put_key(batch, row->author, hangul_chosung_key);
+        row->author_jamo = put_key(batch, row->author, hangul_jamo_key);
+        row->year = record.year;
+        row->isbn13 = row->isbn != NO_TEXT ? isbn_parse(batch->text + row->isbn) : ISBN_INVALID;
+    }
+}
+
+static void *parser_main(void *arg) {
+    MarcLoader *loader = arg;
+    pthread_mutex_lock(&loader->lock);
+    for (;;) {
+        // Stay at most depth chunks ahead of the inserter
+        while (!loader->stop && loader->next_chunk < loader->chunk_count &&
+               loader->next_chunk >= loader->next_insert + loader->depth) {
+            pthread_cond_wait(&loader->changed, &loader->lock);
+        }
+        if (loader->stop || loader->next_chunk >= loader->chunk_count) {
+            break;
+        }
+        long chunk = loader->next_chunk++;
+        MarcBatch *batch = &loader->batches[chunk % loader->depth];
+        pthread_mutex_unlock(&loader->lock);
+
+        parse_chunk(loader, chunk, batch);
+
+        pthread_mutex_lock(&loader->lock);
+        batch->chunk = chunk;
+        batch->ready = 1;
+        pthread_cond_broadcast(&loader->changed);
+    }
+    pthread_mutex_unlock(&loader->lock);
+    return NULL;
+}
+
+static void bind_text(sqlite3_stmt *stmt, int index, const MarcBatch *batch, uint32_t offset, const char *fallback) {
+    if (offset == NO_TEXT) {
+        if (fallback != NULL) {
+            sqlite3_bind_text(stmt, index, fallback, -1, SQLITE_STATIC);
+        } else {
+            sqlite3_bind_null(stmt, index);
+        }
+    } else {
+        sqlite3_bind_text(stmt, index, batch->text + offset, -1, SQLITE_STATIC);
+    }
+}
+
+/**
+ * @brief Insert the rows of a batch, skipping ISBNs already in the catalogue.
+ * 
+ * @return int Returns 0 on success, -1 on failure.
+ */
+static int insert_batch(sqlite3 *db, sqlite3_stmt *insert, sqlite3_stmt *exists, const MarcBatch *batch,
+                        MarcLoadStats *totals) {
+    for (int i = 0; i < batch->count; i++) {
+        const MarcRow *row = &batch->rows[i];
+        if (row->isbn13 != ISBN_INVALID) {
+            sqlite3_bind_int64(exists, 1, row->isbn13);
+            int found = sqlite3_step(exists) == SQLITE_ROW;
+            sqlite3_reset(exists);
+            if (found) {
+                totals->duplicates++;
+                continue;
+            }
+        }
+
+        // Same columns and defaults as add_book()
+        bind_text(insert, 1, batch, row->title, "");
+        bind_text(insert, 2, batch, row->author, "");
+        bind_text(insert, 3, batch, row->publisher, "");
+        sqlite3_bind_int(insert, 4, row->year);
+        bind_text(insert, 5, batch, row->isbn, NULL);
+        bind_text(insert, 6, batch, row->genre, "");
+        bind_text(insert, 7, batch, row->title_chosung, "");
+        bind_text(insert, 8, batch, row->title_jamo, "");
+        bind_text(insert, 9, batch, row->author_chosung, "");
+        bind_text(insert, 10, batch, row->author_jamo, "");
+        sqlite3_bind_int64(insert, 11, row->isbn13);
+
+        int rc = sqlite3_step(insert);
+        sqlite3_reset(insert);
+        if (rc == SQLITE_CONSTRAINT) {
+            totals->duplicates++;    // same ISBN text, not a valid ISBN
+            continue;
+        }
+        if (rc != SQLITE_DONE) {
+            fprintf(stderr, "Failed to insert book: %s\n", sqlite3_errmsg(db));
+            return -1;
+        }
+        totals->inserted++;
+
+        int book_id = (int)sqlite3_last_insert_rowid(db);
+        trigram_refresh_book(db, book_id);
+        autocomplete_refresh_book(db, book_id);
+    }
+    return 0;
+}
+
+/**
+ * @brief Load the books of a MARC21 file into the Books table.
+ * 
+ * @param db SQLite database connection.
+ * @param path MARC21 (ISO 2709) file.
+ * @param num_threads Parser threads (1 or more).
+ * @param stats Pointer to store the totals, or NULL.
+ * @return int Returns number of books inserted, -1 on failure.
+ */
+int load_marc_file(sqlite3 *db, const char *path, int num_threads, MarcLoadStats *stats) {
+    if (num_threads < 1) {
+        num_threads = 1;
+    }
+    double start = now_seconds();
+
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        fprintf(stderr, "Cannot open MARC file: %s\n", path);
+        return -1;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        close(fd);
+        return -1;
+    }
+
+    MarcLoader loader;
+    memset(&loader, 0, sizeof(loader));
+    loader.size = (size_t)st.st_size;
+    if (loader.size > 0) {
+        void *map = mmap(NULL, loader.size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (map == MAP_FAILED) {
+            fprintf(stderr, "Cannot map MARC file: %s\n", path);
+            close(fd);
+            return -1;
+        }
+        madvise(map, loader.size, MADV_SEQUENTIAL);
+        loader.map = map;
+    }
+    close(fd);
+
+    loader.chunk_count = (long)((loader.size + MARC_CHUNK_BYTES - 1) / MARC_CHUNK_BYTES);
+    loader.depth = MARC_QUEUE_DEPTH * num_threads;
+    loader.batches = calloc((size_t)loader.depth, sizeof(MarcBatch));
+    pthread_t *threads = calloc((size_t)num_threads, sizeof(pthread_t));
+    pthread_mutex_init(&loader.lock, NULL);
+    pthread_cond_init(&loader.changed, NULL);
+
+    const char *insert_sql = "INSERT INTO Books (title, author, publisher, publication_year, isbn, genre, "
+                             "quantity, available, title_chosung, title_jamo, author_chosung, author_jamo, isbn13) "
+                             "VALUES (?, ?, ?, ?, ?, ?, 1, 1, ?, ?, ?, ?, ?);";
+    sqlite3_stmt *insert = NULL;
+    sqlite3_stmt *exists = NULL;
+    int result = -1;
+    MarcLoadStats totals;
+    memset(&totals, 0, sizeof(totals));
+
+    if (loader.batches == NULL || threads == NULL) {
+        goto cleanup;
+    }
+    if (sqlite3_prepare_v2(db, insert_sql, -1, &insert, NULL) != SQLITE_OK ||
+        sqlite3_prepare_v2(db, "SELECT 1 FROM Books WHERE isbn13 = ?;", -1, &exists, NULL) != SQLITE_OK) {
+        fprintf(stderr, "Failed to prepare statement: %s\n", sqlite3_errmsg(db));
+        goto cleanup;
+    }
+
+    int started = 0;
+    for (; started < num_threads && started < loader.chunk_count; started++) {
+        if (pthread_create(&threads[started], NULL, parser_main, &loader) != 0) {
+            break;
+        }
+    }
+
+    // Commit every few batches (each commit syncs the journal), unless the caller has a transaction open
+    int own_transaction = sqlite3_get_autocommit(db);
+    result = 0;
+    for (long chunk = 0; chunk < loader.chunk_count && result == 0; chunk++) {
+        MarcBatch *batch = &loader.batches[chunk % loader.depth];
+        if (started == 0) {
+            parse_chunk(&loader, chunk, batch);    // no thread could be created: parse inline
+        } else {
+            pthread_mutex_lock(&loader.lock);
+            while (!(batch->ready && batch->chunk == chunk)) {
+                pthread_cond_wait(&loader.changed, &loader.lock);
+            }
+            pthread_mutex_unlock(&loader.lock);
+        }
+
+        totals.records += batch->records;
+        totals.rejected += batch->rejected;
+        if (batch->failed) {
+            fprintf(stderr, "Out of memory while parsing %s\n", path);
+            result = -1;
+        } else if (own_transaction && sqlite3_get_autocommit(db) &&
+                   exec_with_retry(db, "BEGIN IMMEDIATE;") != SQLITE_OK) {
+            fprintf(stderr, "Failed to begin transaction: %s\n", sqlite3_errmsg(db));
+            result = -1;
+        } else {
+            result = insert_batch(db, insert, exists, batch, &totals);
+            int last = chunk + 1 == loader.chunk_count || (chunk + 1) % MARC_COMMIT_CHUNKS == 0;
+            if (own_transaction && result == 0 && last &&
+                exec_with_retry(db, "COMMIT;") != SQLITE_OK) {
+                fprintf(stderr, "Failed to commit: %s\n", sqlite3_errmsg(db));
+                result = -1;
+            }
+        }
+
+        pthread_mutex_lock(&loader.lock);
+        batch->ready = 0;
+        loader.next_insert++;
+        if (result != 0) {
+            loader.stop = 1;
+        }
+        pthread_cond_broadcast(&loader.changed);
+        pthread_mutex_unlock(&loader.lock);
+    }
+
+    for (int t = 0; t < started; t++) {
+        pthread_join(threads[t], NULL);
+    }
+    if (own_transaction && !sqlite3_get_autocommit(db)) {
+        sqlite3_exec(db, "ROLLBACK;", NULL, NULL, NULL);    // failed part way through a transaction
+    }
+
+cleanup:
+    sqlite3_finalize(insert);
+    sqlite3_finalize(exists);
+    for (int i = 0; loader.batches != NULL && i < loader.depth; i++) {
+        free(loader.batches[i].rows);
+        free(loader.batches[i].text);
+    }
+    free(loader.batches);
+    free(threads);
+    pthread_cond_destroy(&loader.changed);
+    pthread_mutex_destroy(&loader.lock);
+    if (loader.map != NULL) {
+        munmap((void *)loader.map, loader.size);
+    }
+
+    if (result != 0) {
+        return -1;
+    }
+    totals.seconds = now_seconds() - start;
+    totals.records_per_minute = totals.seconds > 0 ? totals.records * 60.0 / totals.seconds : 0.0;
+    if (stats != NULL) {
+        *stats = totals;
+    }
+    return (int)totals.inserted;
+}
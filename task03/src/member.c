@@ -1,4 +1,9 @@
 #include "member.h"
+#include "database.h"
+#include "hangul.h"
+#include "autocomplete.h"
+#include "date_utils.h"
+#include "loan.h"
 #include <stdio.h>
 #include <string.h>
 #include <time.h>
@@ -9,7 +14,12 @@ int init_member_table(sqlite3 *db) {
                       "name TEXT NOT NULL,"
                       "phone TEXT,"
                       "address TEXT,"
-                      "registration_date TEXT NOT NULL);";
+                      "registration_date TEXT NOT NULL,"
+                      "name_chosung TEXT,"
+                      "name_jamo TEXT,"
+                      "penalty_days INTEGER DEFAULT 0,"
+                      "suspended_until INTEGER DEFAULT 0,"
+                      "next_due_day INTEGER);";
     
     char *err_msg = NULL;
     int rc = sqlite3_exec(db, sql, 0, 0, &err_msg);
@@ -36,8 +46,8 @@ int add_member(sqlite3 *db, const char *name, const char *phone, const char *add
     snprintf(date, sizeof(date), "%04d-%02d-%02d", 
              t->tm_year + 1900, t->tm_mon + 1, t->tm_mday);
     
-    const char *sql = "INSERT INTO Members (name, phone, address, registration_date) "
-                      "VALUES (?, ?, ?, ?);";
+    const char *sql = "INSERT INTO Members (name, phone, address, registration_date, name_chosung, name_jamo) "
+                      "VALUES (?, ?, ?, ?, ?, ?);";
     
     sqlite3_stmt *stmt;
     int rc = sqlite3_prepare_v2(db, sql, -1, &stmt, NULL);
@@ -52,6 +62,13 @@ int add_member(sqlite3 *db, const char *name, const char *phone, const char *add
     sqlite3_bind_text(stmt, 3, address ? address : "", -1, SQLITE_STATIC);
     sqlite3_bind_text(stmt, 4, date, -1, SQLITE_STATIC);
     
+    // 초성/자모 검색 키
+    char name_chosung[HANGUL_KEY_LEN], name_jamo[HANGUL_KEY_LEN];
+    hangul_chosung_key(name, name_chosung, sizeof(name_chosung));
+    hangul_jamo_key(name, name_jamo, sizeof(name_jamo));
+    sqlite3_bind_text(stmt, 5, name_chosung, -1, SQLITE_STATIC);
+    sqlite3_bind_text(stmt, 6, name_jamo, -1, SQLITE_STATIC);
+    
     rc = sqlite3_step(stmt);
     sqlite3_finalize(stmt);
     
@@ -60,7 +77,10 @@ int add_member(sqlite3 *db, const char *name, const char *phone, const char *add
         return -1;
     }
     
-    return (int)sqlite3_last_insert_rowid(db);
+    int member_id = (int)sqlite3_last_insert_rowid(db);
+    autocomplete_refresh_member(db, member_id);
+    
+    return member_id;
 }
 
 int search_member_by_id(sqlite3 *db, int member_id, Member *member) {
@@ -111,8 +131,19 @@ int search_member_by_name(sqlite3 *db, const char *name, Member *members, int ma
         return -1;
     }
     
-    const char *sql = "SELECT member_id, name, phone, address, registration_date "
-                      "FROM Members WHERE name LIKE ? LIMIT ?;";
+    // 초성("ㅎㄱㄷ")이나 입력 중인 자모("홍ㄱ")는 검색 키 인덱스의 접두사 범위로 조회
+    int kind = hangul_query_kind(name);
+    const char *sql;
+    if (kind == HANGUL_QUERY_CHOSUNG) {
+        sql = "SELECT member_id, name, phone, address, registration_date "
+              "FROM Members WHERE name_chosung >= ? AND name_chosung < ? LIMIT ?;";
+    } else if (kind == HANGUL_QUERY_JAMO) {
+        sql = "SELECT member_id, name, phone, address, registration_date "
+              "FROM Members WHERE name_jamo >= ? AND name_jamo < ? LIMIT ?;";
+    } else {
+        sql = "SELECT member_id, name, phone, address, registration_date "
+              "FROM Members WHERE name LIKE ? LIMIT ?;";
+    }
     
     sqlite3_stmt *stmt;
     int rc = sqlite3_prepare_v2(db, sql, -1, &stmt, NULL);
@@ -123,10 +154,24 @@ int search_member_by_name(sqlite3 *db, const char *name, Member *members, int ma
     }
     
     char search_pattern[MAX_NAME_LEN + 2];
-    snprintf(search_pattern, sizeof(search_pattern), "%%%s%%", name);
+    char key[HANGUL_KEY_LEN];
+    char key_end[HANGUL_KEY_LEN + 1];
     
-    sqlite3_bind_text(stmt, 1, search_pattern, -1, SQLITE_STATIC);
-    sqlite3_bind_int(stmt, 2, max_count);
+    if (kind == HANGUL_QUERY_PLAIN) {
+        snprintf(search_pattern, sizeof(search_pattern), "%%%s%%", name);
+        sqlite3_bind_text(stmt, 1, search_pattern, -1, SQLITE_STATIC);
+        sqlite3_bind_int(stmt, 2, max_count);
+    } else {
+        if (kind == HANGUL_QUERY_CHOSUNG) {
+            hangul_chosung_key(name, key, sizeof(key));
+        } else {
+            hangul_jamo_key(name, key, sizeof(key));
+        }
+        hangul_prefix_end(key, key_end);
+        sqlite3_bind_text(stmt, 1, key, -1, SQLITE_STATIC);
+        sqlite3_bind_text(stmt, 2, key_end, -1, SQLITE_STATIC);
+        sqlite3_bind_int(stmt, 3, max_count);
+    }
     
     int count = 0;
     while (sqlite3_step(stmt) == SQLITE_ROW && count < max_count) {
@@ -146,49 +191,92 @@ int search_member_by_name(sqlite3 *db, const char *name, Member *members, int ma
     return count;
 }
 
-int update_member(sqlite3 *db, int member_id, const char *name, const char *phone, const char *address) {
-    // 동적으로 UPDATE 쿼리 생성
-    char sql[512] = "UPDATE Members SET ";
-    int first = 1;
-    
-    if (name) {
-        strcat(sql, "name = ?");
-        first = 0;
-    }
-    if (phone) {
-        if (!first) strcat(sql, ", ");
-        strcat(sql, "phone = ?");
-        first = 0;
+/* update_member() field mask bits, in SET clause order */
+enum {
+    MEMBER_FIELD_NAME = 1 << 0,
+    MEMBER_FIELD_PHONE = 1 << 1,
+    MEMBER_FIELD_ADDRESS = 1 << 2
+};
+
+#define MEMBER_FIELD_COUNT 3   // 2^3 = 8 cached UPDATE variants
+
+static const char *member_field_assignments[MEMBER_FIELD_COUNT] = {
+    "name = ?, name_chosung = ?, name_jamo = ?",
+    "phone = ?",
+    "address = ?"
+};
+
+/**
+ * @brief Get the UPDATE statement for a field mask, preparing it on first use.
+ * 
+ * @param db SQLite database connection.
+ * @param mask Non-zero combination of MEMBER_FIELD_* bits.
+ * @return sqlite3_stmt* Returns the cached statement, or NULL on failure.
+ */
+static sqlite3_stmt *get_update_member_statement(sqlite3 *db, int mask) {
+    sqlite3_stmt *stmt = find_cached_statement(db, STMT_SLOT_UPDATE_MEMBER + mask);
+    if (stmt != NULL) {
+        return stmt;
     }
-    if (address) {
-        if (!first) strcat(sql, ", ");
-        strcat(sql, "address = ?");
+    
+    char sql[MAX_QUERY_LENGTH];
+    size_t len = (size_t)snprintf(sql, sizeof(sql), "UPDATE Members SET ");
+    const char *separator = "";
+    for (int i = 0; i < MEMBER_FIELD_COUNT; i++) {
+        if (mask & (1 << i)) {
+            len += (size_t)snprintf(sql + len, sizeof(sql) - len, "%s%s", separator, member_field_assignments[i]);
+            separator = ", ";
+        }
     }
+    snprintf(sql + len, sizeof(sql) - len, " WHERE member_id = ?;");
     
-    strcat(sql, " WHERE member_id = ?;");
+    return prepare_cached_statement(db, STMT_SLOT_UPDATE_MEMBER + mask, sql);
+}
+
+int update_member(sqlite3 *db, int member_id, const char *name, const char *phone, const char *address) {
+    int mask = (name ? MEMBER_FIELD_NAME : 0)
+             | (phone ? MEMBER_FIELD_PHONE : 0)
+             | (address ? MEMBER_FIELD_ADDRESS : 0);
     
-    sqlite3_stmt *stmt;
-    int rc = sqlite3_prepare_v2(db, sql, -1, &stmt, NULL);
+    if (mask == 0) {
+        fprintf(stderr, "No fields to update\n");
+        return -1;
+    }
     
-    if (rc != SQLITE_OK) {
-        fprintf(stderr, "Failed to prepare statement: %s\n", sqlite3_errmsg(db));
+    sqlite3_stmt *stmt = get_update_member_statement(db, mask);
+    if (stmt == NULL) {
         return -1;
     }
     
+    char name_chosung[HANGUL_KEY_LEN], name_jamo[HANGUL_KEY_LEN];
+    
     int param = 1;
-    if (name) sqlite3_bind_text(stmt, param++, name, -1, SQLITE_STATIC);
+    if (name) {
+        hangul_chosung_key(name, name_chosung, sizeof(name_chosung));
+        hangul_jamo_key(name, name_jamo, sizeof(name_jamo));
+        sqlite3_bind_text(stmt, param++, name, -1, SQLITE_STATIC);
+        sqlite3_bind_text(stmt, param++, name_chosung, -1, SQLITE_STATIC);
+        sqlite3_bind_text(stmt, param++, name_jamo, -1, SQLITE_STATIC);
+    }
     if (phone) sqlite3_bind_text(stmt, param++, phone, -1, SQLITE_STATIC);
     if (address) sqlite3_bind_text(stmt, param++, address, -1, SQLITE_STATIC);
     sqlite3_bind_int(stmt, param, member_id);
     
-    rc = sqlite3_step(stmt);
-    sqlite3_finalize(stmt);
-    
+    int rc = sqlite3_step(stmt);
     if (rc != SQLITE_DONE) {
         fprintf(stderr, "Failed to update member: %s\n", sqlite3_errmsg(db));
+    }
+    sqlite3_reset(stmt);
+    sqlite3_clear_bindings(stmt);
+    
+    if (rc != SQLITE_DONE) {
         return -1;
     }
     
+    if (name) {
+        autocomplete_refresh_member(db, member_id);
+    }
+    
     return 0;
 }
 
@@ -237,13 +325,19 @@ int delete_member(sqlite3 *db, int member_id) {
         return -1;
     }
     
+    autocomplete_remove_member(member_id);
+    
     return 0;
 }
 
 int check_member_overdue(sqlite3 *db, int member_id, int *overdue_days) {
-    const char *sql = "SELECT MAX(julianday('now') - julianday(due_date)) as overdue "
+    const char *sql = "SELECT MAX(overdue_days(due_date, ?2)) as overdue "
                       "FROM Loans "
-                      "WHERE member_id = ? AND loan_id NOT IN (SELECT loan_id FROM Returns);";
+                      "WHERE member_id = ?1 AND due_date < ?2 "
+                      "AND loan_id NOT IN (SELECT loan_id FROM Returns);";
+    
+    char today[11];  // YYYY-MM-DD
+    day_to_date(get_today_day(), today, sizeof(today));
     
     sqlite3_stmt *stmt;
     int rc = sqlite3_prepare_v2(db, sql, -1, &stmt, NULL);
@@ -254,11 +348,11 @@ int check_member_overdue(sqlite3 *db, int member_id, int *overdue_days) {
     }
     
     sqlite3_bind_int(stmt, 1, member_id);
+    sqlite3_bind_text(stmt, 2, today, -1, SQLITE_STATIC);
     
     if (sqlite3_step(stmt) == SQLITE_ROW) {
         if (sqlite3_column_type(stmt, 0) != SQLITE_NULL) {
-            double days = sqlite3_column_double(stmt, 0);
-            *overdue_days = days > 0 ? (int)days : 0;
+            *overdue_days = sqlite3_column_int(stmt, 0);
             sqlite3_finalize(stmt);
             return *overdue_days > 0 ? 1 : 0;
         }
@@ -270,21 +364,120 @@ int check_member_overdue(sqlite3 *db, int member_id, int *overdue_days) {
 }
 
 int can_member_borrow(sqlite3 *db, int member_id) {
-    int overdue_days = 0;
-    int has_overdue = check_member_overdue(db, member_id, &overdue_days);
+    sqlite3_stmt *stmt = find_cached_statement(db, STMT_SLOT_LEDGER_READ);
+    if (stmt == NULL) {
+        stmt = prepare_cached_statement(db, STMT_SLOT_LEDGER_READ,
+                                        "SELECT suspended_until, next_due_day FROM Members WHERE member_id = ?;");
+        if (stmt == NULL) {
+            return -1;
+        }
+    }
+    
+    sqlite3_bind_int(stmt, 1, member_id);
     
-    if (has_overdue < 0) {
+    int rc = sqlite3_step(stmt);
+    if (rc != SQLITE_ROW) {
+        if (rc != SQLITE_DONE) {
+            fprintf(stderr, "Error during query execution: %s\n", sqlite3_errmsg(db));
+        }
+        sqlite3_reset(stmt);
         return -1;
     }
     
-    // 연체가 있으면 대출 불가
-    if (overdue_days > 0) {
+    // 정지 기간은 저장된 종료일과 오늘을 비교해 자연히 만료된다
+    int today = get_today_day();
+    int suspended_until = sqlite3_column_int(stmt, 0);
+    int overdue = sqlite3_column_type(stmt, 1) != SQLITE_NULL && sqlite3_column_int(stmt, 1) < today;
+    sqlite3_reset(stmt);
+    
+    // 정지 기간 중이거나 연체 중인 도서가 있으면 대출 불가
+    if (today < suspended_until || overdue) {
         return 0;
     }
     
     return 1;
 }
 
+/**
+ * @brief Run a cached ledger statement bound to (member_id, day[, suspension_days]).
+ * 
+ * @return int Returns 0 on success, -1 on failure.
+ */
+static int run_ledger_statement(sqlite3 *db, int slot, const char *sql, int member_id, int day, int suspension_days) {
+    sqlite3_stmt *stmt = find_cached_statement(db, slot);
+    if (stmt == NULL) {
+        stmt = prepare_cached_statement(db, slot, sql);
+        if (stmt == NULL) {
+            return -1;
+        }
+    }
+    
+    sqlite3_bind_int(stmt, 1, member_id);
+    sqlite3_bind_int(stmt, 2, day);
+    if (sqlite3_bind_parameter_count(stmt) >= 3) {
+        sqlite3_bind_int(stmt, 3, suspension_days);
+    }
+    
+    int rc = sqlite3_step(stmt);
+    if (rc != SQLITE_DONE) {
+        fprintf(stderr, "Failed to update penalty ledger: %s\n", sqlite3_errmsg(db));
+    }
+    sqlite3_reset(stmt);
+    return rc == SQLITE_DONE ? 0 : -1;
+}
+
+int record_penalty_loan(sqlite3 *db, int member_id, int due_day) {
+    return run_ledger_statement(db, STMT_SLOT_LEDGER_LOAN,
+                                "UPDATE Members SET next_due_day = MIN(COALESCE(next_due_day, ?2), ?2) "
+                                "WHERE member_id = ?1;",
+                                member_id, due_day, 0);
+}
+
+int record_penalty_return(sqlite3 *db, int member_id, int return_day, int overdue_days) {
+    int suspension_days = overdue_days > 0 ? calculate_suspension_days(overdue_days) : 0;
+    
+    return run_ledger_statement(db, STMT_SLOT_LEDGER_RETURN,
+                                "UPDATE Members SET "
+                                "suspended_until = MAX(COALESCE(suspended_until, 0), ?2), "
+                                "penalty_days = COALESCE(penalty_days, 0) + ?3, "
+                                "next_due_day = (SELECT MIN(date_to_day(due_date)) FROM Loans "
+                                "WHERE member_id = ?1 AND is_returned = 0) "
+                                "WHERE member_id = ?1;",
+                                member_id, suspension_days > 0 ? return_day + suspension_days : 0,
+                                suspension_days);
+}
+
+int rebuild_penalty_ledger(sqlite3 *db, int member_id) {
+    const char *sql = "UPDATE Members SET "
+                      "next_due_day = (SELECT MIN(date_to_day(l.due_date)) FROM Loans l "
+                      "WHERE l.member_id = Members.member_id AND l.is_returned = 0), "
+                      "suspended_until = COALESCE((SELECT MAX(date_to_day(r.return_date) + suspension_days(r.overdue_days)) "
+                      "FROM Loans l JOIN Returns r ON r.loan_id = l.loan_id "
+                      "WHERE l.member_id = Members.member_id AND r.overdue_days > 0), 0), "
+                      "penalty_days = COALESCE((SELECT SUM(suspension_days(r.overdue_days)) "
+                      "FROM Loans l JOIN Returns r ON r.loan_id = l.loan_id "
+                      "WHERE l.member_id = Members.member_id AND r.overdue_days > 0), 0) "
+                      "WHERE ?1 <= 0 OR member_id = ?1;";
+    
+    sqlite3_stmt *stmt;
+    if (sqlite3_prepare_v2(db, sql, -1, &stmt, NULL) != SQLITE_OK) {
+        fprintf(stderr, "Failed to prepare statement: %s\n", sqlite3_errmsg(db));
+        return -1;
+    }
+    
+    sqlite3_bind_int(stmt, 1, member_id);
+    
+    int rc = sqlite3_step(stmt);
+    sqlite3_finalize(stmt);
+    
+    if (rc != SQLITE_DONE) {
+        fprintf(stderr, "Failed to rebuild penalty ledger: %s\n", sqlite3_errmsg(db));
+        return -1;
+    }
+    
+    return sqlite3_changes(db);
+}
+
 int list_all_members(sqlite3 *db, Member *members, int max_count) {
     if (!members) {
         return -1;
@@ -0,0 +1,891 @@
+#include "recommend.h"
+#include "database.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <pthread.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#define RECOMMEND_MAGIC "LIBRCMD1"
+
+/*
+ * File layout (all fields native-endian, 4-byte aligned):
+ *   RecommendHeader
+ *   int32_t  row_book_ids[row_count]      sorted ascending
+ *   uint32_t row_offsets[row_count + 1]   into the two arrays below
+ *   int32_t  neighbor_ids[nnz]            per row, strongest first
+ *   int32_t  scores[nnz]
+ */
+typedef struct {
+    char magic[8];
+    uint32_t row_count;
+    uint32_t nnz;
+    int64_t last_loan_id;   // newest loan reflected in the file
+} RecommendHeader;
+
+/**
+ * @brief Open-addressing table of (book_a, book_b) -> co-borrow count.
+ */
+typedef struct {
+    uint64_t *keys;     // 0 = empty slot
+    uint32_t *counts;
+    uint32_t mask;
+    uint32_t size;
+} PairTable;
+
+/**
+ * @brief Per-thread work description for counting one member partition.
+ */
+typedef struct {
+    const int *member_start;
+    const int *book_ids;
+    int first_member;
+    int last_member;
+    PairTable table;
+    int failed;
+} CountTask;
+
+/**
+ * @brief Co-borrow counts added since the file was written, for one book.
+ */
+typedef struct {
+    int book_id;
+    int count;
+    int capacity;
+    Recommendation *entries;
+} DeltaRow;
+
+/**
+ * @brief Matrix held in memory before it is written to a file.
+ */
+typedef struct {
+    int32_t *row_book_ids;
+    uint32_t *row_offsets;
+    int32_t *neighbor_ids;
+    int32_t *scores;
+    uint32_t row_count;
+    uint32_t nnz;
+} CsrMatrix;
+
+static struct {
+    void *map;
+    size_t map_size;
+    const int32_t *row_book_ids;
+    const uint32_t *row_offsets;
+    const int32_t *neighbor_ids;
+    const int32_t *scores;
+    uint32_t row_count;
+    int64_t last_loan_id;
+    DeltaRow *delta_rows;      // sorted by book_id
+    int delta_count;
+    int delta_capacity;
+    int pending_loans;         // loans in the update table
+    char path[512];            // file the matrix was mapped from
+} recommender = {0};
+
+static uint64_t pair_key(int a, int b) {
+    return ((uint64_t)(uint32_t)a << 32) | (uint32_t)b;
+}
+
+static uint32_t pair_slot(uint64_t key, uint32_t mask) {
+    return (uint32_t)((key * 0x9E3779B97F4A7C15ull) >> 32) & mask;
+}
+
+static int pair_table_init(PairTable *table, uint32_t capacity) {
+    uint32_t size = 1024;
+    while (size < capacity * 2) {
+        size <<= 1;
+    }
+    table->keys = calloc(size, sizeof(uint64_t));
+    table->counts = calloc(size, sizeof(uint32_t));
+    table->mask = size - 1;
+    table->size = 0;
+    if (table->keys == NULL || table->counts == NULL) {
+        free(table->keys);
+        free(table->counts);
+        table->keys = NULL;
+        table->counts = NULL;
+        return -1;
+    }
+    return 0;
+}
+
+static void pair_table_free(PairTable *table) {
+    free(table->keys);
+    free(table->counts);
+    table->keys = NULL;
+    table->counts = NULL;
+}
+
+static int pair_table_add(PairTable *table, uint64_t key, uint32_t count);
+
+static int pair_table_grow(PairTable *table) {
+    PairTable bigger;
+    if (pair_table_init(&bigger, (table->mask + 1)) != 0) {
+        return -1;
+    }
+    for (uint32_t i = 0; i <= table->mask; i++) {
+        if (table->keys[i] != 0) {
+            pair_table_add(&bigger, table->keys[i], table->counts[i]);
+        }
+    }
+    pair_table_free(table);
+    *table = bigger;
+    return 0;
+}
+
+static int pair_table_add(PairTable *table, uint64_t key, uint32_t count) {
+    if ((table->size + 1) * 2 > table->mask + 1 && pair_table_grow(table) != 0) {
+        return -1;
+    }
+    uint32_t pos = pair_slot(key, table->mask);
+    while (table->keys[pos] != 0 && table->keys[pos] != key) {
+        pos = (pos + 1) & table->mask;
+    }
+    if (table->keys[pos] == 0) {
+        table->keys[pos] = key;
+        table->size++;
+    }
+    table->counts[pos] += count;
+    return 0;
+}
+
+/**
+ * @brief Thread entry point: count co-borrowed pairs in one member partition.
+ */
+static void *count_partition(void *arg) {
+    CountTask *task = arg;
+
+    for (int m = task->first_member; m < task->last_member && !task->failed; m++) {
+        int start = task->member_start[m];
+        int end = task->member_start[m + 1];
+        if (end - start > RECOMMEND_MAX_HISTORY) {
+            start = end - RECOMMEND_MAX_HISTORY;   // keep the most recent books
+        }
+        for (int i = start; i < end; i++) {
+            for (int j = i + 1; j < end; j++) {
+                int a = task->book_ids[i];
+                int b = task->book_ids[j];
+                if (pair_table_add(&task->table, pair_key(a, b), 1) != 0 ||
+                    pair_table_add(&task->table, pair_key(b, a), 1) != 0) {
+                    task->failed = 1;
+                    break;
+                }
+            }
+        }
+    }
+
+    return NULL;
+}
+
+static int compare_entries(const void *lhs, const void *rhs) {
+    const uint64_t *a = lhs;
+    const uint64_t *b = rhs;
+    /* Entries are packed as {row << 32 | ~count, neighbour}: row ascending, count descending */
+    if (a[0] != b[0]) {
+        return (a[0] > b[0]) - (a[0] < b[0]);
+    }
+    return (a[1] > b[1]) - (a[1] < b[1]);
+}
+
+static int compare_recommendations(const void *lhs, const void *rhs) {
+    const Recommendation *a = lhs;
+    const Recommendation *b = rhs;
+    if (a->score != b->score) {
+        return b->score - a->score;
+    }
+    return a->book_id - b->book_id;
+}
+
+static void csr_free(CsrMatrix *matrix) {
+    free(matrix->row_book_ids);
+    free(matrix->row_offsets);
+    free(matrix->neighbor_ids);
+    free(matrix->scores);
+    memset(matrix, 0, sizeof(*matrix));
+}
+
+static int csr_alloc(CsrMatrix *matrix, uint32_t max_rows, uint32_t max_nnz) {
+    memset(matrix, 0, sizeof(*matrix));
+    matrix->row_book_ids = malloc((max_rows + 1) * sizeof(int32_t));
+    matrix->row_offsets = malloc((max_rows + 1) * sizeof(uint32_t));
+    matrix->neighbor_ids = malloc((max_nnz + 1) * sizeof(int32_t));
+    matrix->scores = malloc((max_nnz + 1) * sizeof(int32_t));
+    if (!matrix->row_book_ids || !matrix->row_offsets || !matrix->neighbor_ids || !matrix->scores) {
+        csr_free(matrix);
+        return -1;
+    }
+    matrix->row_offsets[0] = 0;
+    return 0;
+}
+
+/**
+ * @brief Append one row; entries must already be sorted strongest first.
+ */
+static void csr_append_row(CsrMatrix *matrix, int book_id, const Recommendation *entries, int count) {
+    if (count > RECOMMEND_MAX_NEIGHBORS) {
+        count = RECOMMEND_MAX_NEIGHBORS;
+    }
+    if (count == 0) {
+        return;
+    }
+    for (int i = 0; i < count; i++) {
+        matrix->neighbor_ids[matrix->nnz + i] = entries[i].book_id;
+        matrix->scores[matrix->nnz + i] = entries[i].score;
+    }
+    matrix->nnz += count;
+    matrix->row_book_ids[matrix->row_count] = book_id;
+    matrix->row_offsets[++matrix->row_count] = matrix->nnz;
+}
+
+/**
+ * @brief Write a matrix atomically (temporary file, then rename).
+ */
+static int write_matrix(const char *path, const CsrMatrix *matrix, int64_t last_loan_id) {
+    char tmp_path[512];
+    snprintf(tmp_path, sizeof(tmp_path), "%s.tmp", path);
+
+    FILE *fp = fopen(tmp_path, "wb");
+    if (fp == NULL) {
+        fprintf(stderr, "Cannot open %s for writing\n", tmp_path);
+        return -1;
+    }
+
+    RecommendHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, RECOMMEND_MAGIC, sizeof(header.magic));
+    header.row_count = matrix->row_count;
+    header.nnz = matrix->nnz;
+    header.last_loan_id = last_loan_id;
+
+    int ok = fwrite(&header, sizeof(header), 1, fp) == 1 &&
+             fwrite(matrix->row_book_ids, sizeof(int32_t), matrix->row_count, fp) == matrix->row_count &&
+             fwrite(matrix->row_offsets, sizeof(uint32_t), matrix->row_count + 1, fp) == matrix->row_count + 1 &&
+             fwrite(matrix->neighbor_ids, sizeof(int32_t), matrix->nnz, fp) == matrix->nnz &&
+             fwrite(matrix->scores, sizeof(int32_t), matrix->nnz, fp) == matrix->nnz;
+
+    if (fclose(fp) != 0 || !ok) {
+        fprintf(stderr, "Failed to write %s\n", tmp_path);
+        remove(tmp_path);
+        return -1;
+    }
+
+    if (rename(tmp_path, path) != 0) {
+        fprintf(stderr, "Failed to replace %s\n", path);
+        remove(tmp_path);
+        return -1;
+    }
+
+    return 0;
+}
+
+/**
+ * @brief Load distinct (member, book) pairs, grouped by member, oldest first.
+ */
+static int load_histories(sqlite3 *db, int64_t last_loan_id, int **member_start,
+                          int **book_ids, int *member_count) {
+    const char *sql = "SELECT member_id, book_id FROM Loans WHERE loan_id <= ? "
+                      "GROUP BY member_id, book_id ORDER BY member_id, MAX(loan_id);";
+
+    sqlite3_stmt *stmt;
+    if (sqlite3_prepare_v2(db, sql, -1, &stmt, NULL) != SQLITE_OK) {
+        fprintf(stderr, "Failed to prepare statement: %s\n", sqlite3_errmsg(db));
+        return -1;
+    }
+    sqlite3_bind_int64(stmt, 1, last_loan_id);
+
+    int capacity = 1024, count = 0;
+    int member_capacity = 256, members = 0;
+    int *books = malloc(capacity * sizeof(int));
+    int *starts = malloc((member_capacity + 1) * sizeof(int));
+    int previous_member = -1;
+    int rc = SQLITE_ERROR;
+
+    while (books != NULL && starts != NULL && (rc = sqlite3_step(stmt)) == SQLITE_ROW) {
+        int member_id = sqlite3_column_int(stmt, 0);
+        if (member_id != previous_member) {
+            if (members == member_capacity) {
+                member_capacity *= 2;
+                int *grown = realloc(starts, (member_capacity + 1) * sizeof(int));
+                if (grown == NULL) {
+                    rc = SQLITE_NOMEM;
+                    break;
+                }
+                starts = grown;
+            }
+            starts[members++] = count;
+            previous_member = member_id;
+        }
+        if (count == capacity) {
+            capacity *= 2;
+            int *grown = realloc(books, capacity * sizeof(int));
+            if (grown == NULL) {
+                rc = SQLITE_NOMEM;
+                break;
+            }
+            books = grown;
+        }
+        books[count++] = sqlite3_column_int(stmt, 1);
+    }
+
+    sqlite3_finalize(stmt);
+
+    if (rc != SQLITE_DONE) {
+        fprintf(stderr, "Failed to load loan histories\n");
+        free(books);
+        free(starts);
+        return -1;
+    }
+
+    starts[members] = count;
+    *member_start = starts;
+    *book_ids = books;
+    *member_count = members;
+    return 0;
+}
+
+int build_recommendations(sqlite3 *db, const char *path, int num_threads) {
+    if (db == NULL || path == NULL) {
+        fprintf(stderr, "Invalid parameters\n");
+        return -1;
+    }
+    if (num_threads < 1) {
+        num_threads = 1;
+    }
+
+    /* Fix the snapshot so later loans are picked up by catch_up_recommendations() */
+    int64_t last_loan_id = 0;
+    sqlite3_stmt *stmt;
+    if (sqlite3_prepare_v2(db, "SELECT IFNULL(MAX(loan_id), 0) FROM Loans;", -1, &stmt, NULL) != SQLITE_OK) {
+        fprintf(stderr, "Failed to prepare statement: %s\n", sqlite3_errmsg(db));
+        return -1;
+    }
+    if (sqlite3_step(stmt) == SQLITE_ROW) {
+        last_loan_id = sqlite3_column_int64(stmt, 0);
+    }
+    sqlite3_finalize(stmt);
+
+    int *member_start = NULL, *book_ids = NULL, member_count = 0;
+    if (load_histories(db, last_loan_id, &member_start, &book_ids, &member_count) != 0) {
+        return -1;
+    }
+
+    /* Balance partitions by pair work (k * (k - 1) per member) */
+    double total_work = 0;
+    for (int m = 0; m < member_count; m++) {
+        double k = member_start[m + 1] - member_start[m];
+        total_work += k * (k - 1);
+    }
+    if (num_threads > member_count) {
+        num_threads = member_count > 0 ? member_count : 1;
+    }
+
+    CountTask *tasks = calloc(num_threads, sizeof(CountTask));
+    pthread_t *threads = calloc(num_threads, sizeof(pthread_t));
+    int result = -1;
+    if (tasks == NULL || threads == NULL) {
+        goto cleanup;
+    }
+
+    double work = 0;
+    int next_member = 0;
+    for (int t = 0; t < num_threads; t++) {
+        tasks[t].member_start = member_start;
+        tasks[t].book_ids = book_ids;
+        tasks[t].first_member = next_member;
+        double target = total_work * (t + 1) / num_threads;
+        while (next_member < member_count && (work < target || t == num_threads - 1)) {
+            double k = member_start[next_member + 1] - member_start[next_member];
+            work += k * (k - 1);
+            next_member++;
+        }
+        tasks[t].last_member = next_member;
+        if (pair_table_init(&tasks[t].table, 1024) != 0) {
+            goto cleanup;
+        }
+    }
+
+    int started = 0;
+    for (; started < num_threads; started++) {
+        if (pthread_create(&threads[started], NULL, count_partition, &tasks[started]) != 0) {
+            break;
+        }
+    }
+    for (int t = 0; t < started; t++) {
+        pthread_join(threads[t], NULL);
+    }
+    for (int t = started; t < num_threads; t++) {
+        count_partition(&tasks[t]);   // thread creation failed: finish inline
+    }
+
+    /* Merge partitions into the first table */
+    for (int t = 1; t < num_threads; t++) {
+        PairTable *part = &tasks[t].table;
+        for (uint32_t i = 0; i <= part->mask && !tasks[0].failed; i++) {
+            if (part->keys[i] != 0 && pair_table_add(&tasks[0].table, part->keys[i], part->counts[i]) != 0) {
+                tasks[0].failed = 1;
+            }
+        }
+        if (tasks[t].failed) {
+            tasks[0].failed = 1;
+        }
+        pair_table_free(part);
+    }
+    if (tasks[0].failed) {
+        fprintf(stderr, "Out of memory while counting co-borrowed books\n");
+        goto cleanup;
+    }
+
+    /* Sort (row asc, count desc, neighbour asc) and cut each row to its strongest neighbours */
+    PairTable *pairs = &tasks[0].table;
+    uint64_t *order = malloc(((size_t)pairs->size + 1) * 2 * sizeof(uint64_t));
+    if (order == NULL) {
+        goto cleanup;
+    }
+    uint32_t n = 0;
+    for (uint32_t i = 0; i <= pairs->mask; i++) {
+        if (pairs->keys[i] != 0) {
+            order[2 * n] = (pairs->keys[i] & 0xffffffff00000000ull) | (uint32_t)~pairs->counts[i];
+            order[2 * n + 1] = (uint32_t)pairs->keys[i];
+            n++;
+        }
+    }
+    qsort(order, n, 2 * sizeof(uint64_t), compare_entries);
+
+    CsrMatrix matrix;
+    if (csr_alloc(&matrix, n, n) != 0) {
+        free(order);
+        goto cleanup;
+    }
+
+    Recommendation row[RECOMMEND_MAX_NEIGHBORS];
+    for (uint32_t i = 0; i < n;) {
+        int book_id = (int)(order[2 * i] >> 32);
+        int kept = 0;
+        for (; i < n && (int)(order[2 * i] >> 32) == book_id; i++) {
+            if (kept < RECOMMEND_MAX_NEIGHBORS) {
+                row[kept].book_id = (int)order[2 * i + 1];
+                row[kept].score = (int)~(uint32_t)order[2 * i];
+                kept++;
+            }
+        }
+        csr_append_row(&matrix, book_id, row, kept);
+    }
+    free(order);
+
+    if (write_matrix(path, &matrix, last_loan_id) == 0) {
+        result = (int)matrix.row_count;
+    }
+    csr_free(&matrix);
+
+cleanup:
+    if (tasks != NULL) {
+        for (int t = 0; t < num_threads; t++) {
+            pair_table_free(&tasks[t].table);
+        }
+    }
+    free(tasks);
+    free(threads);
+    free(member_start);
+    free(book_ids);
+    return result;
+}
+
+static void free_delta(void) {
+    for (int i = 0; i < recommender.delta_count; i++) {
+        free(recommender.delta_rows[i].entries);
+    }
+    free(recommender.delta_rows);
+    recommender.delta_rows = NULL;
+    recommender.delta_count = 0;
+    recommender.delta_capacity = 0;
+}
+
+void close_recommendations(void) {
+    if (recommender.map != NULL) {
+        munmap(recommender.map, recommender.map_size);
+    }
+    free_delta();
+    memset(&recommender, 0, sizeof(recommender));
+}
+
+int open_recommendations(const char *path) {
+    if (path == NULL) {
+        return -1;
+    }
+
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        fprintf(stderr, "Cannot open recommendation file: %s\n", path);
+        return -1;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(RecommendHeader)) {
+        fprintf(stderr, "Invalid recommendation file: %s\n", path);
+        close(fd);
+        return -1;
+    }
+
+    void *map = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED) {
+        fprintf(stderr, "Cannot map recommendation file: %s\n", path);
+        return -1;
+    }
+
+    const RecommendHeader *header = map;
+    size_t expected = sizeof(RecommendHeader) +
+                      (size_t)header->row_count * sizeof(int32_t) +
+                      ((size_t)header->row_count + 1) * sizeof(uint32_t) +
+                      (size_t)header->nnz * 2 * sizeof(int32_t);
+    if (memcmp(header->magic, RECOMMEND_MAGIC, sizeof(header->magic)) != 0 ||
+        (size_t)st.st_size != expected) {
+        fprintf(stderr, "Invalid recommendation file: %s\n", path);
+        munmap(map, (size_t)st.st_size);
+        return -1;
+    }
+
+    close_recommendations();
+
+    const char *base = (const char *)map + sizeof(RecommendHeader);
+    recommender.map = map;
+    recommender.map_size = (size_t)st.st_size;
+    recommender.row_count = header->row_count;
+    recommender.last_loan_id = header->last_loan_id;
+    recommender.row_book_ids = (const int32_t *)base;
+    base += (size_t)header->row_count * sizeof(int32_t);
+    recommender.row_offsets = (const uint32_t *)base;
+    base += ((size_t)header->row_count + 1) * sizeof(uint32_t);
+    recommender.neighbor_ids = (const int32_t *)base;
+    base += (size_t)header->nnz * sizeof(int32_t);
+    recommender.scores = (const int32_t *)base;
+    snprintf(recommender.path, sizeof(recommender.path), "%s", path);
+    return 0;
+}
+
+int rebuild_recommendations(sqlite3 *db, int num_threads) {
+    if (recommender.map == NULL) {
+        // Not open here (e.g. the CLI): the desk app would map a stale file next time
+        return access(RECOMMEND_PATH, F_OK) == 0 ? build_recommendations(db, RECOMMEND_PATH, num_threads) : 0;
+    }
+
+    char path[sizeof(recommender.path)];
+    snprintf(path, sizeof(path), "%s", recommender.path);
+    int rows = build_recommendations(db, path, num_threads);
+    if (rows < 0 || open_recommendations(path) != 0) {
+        return -1;
+    }
+    return rows;
+}
+
+/**
+ * @brief Find the base row of a book in the mapped file.
+ * 
+ * @return int Returns row index, -1 if the book has no row.
+ */
+static int find_row(int book_id) {
+    int lo = 0, hi = (int)recommender.row_count - 1;
+    while (lo <= hi) {
+        int mid = lo + (hi - lo) / 2;
+        if (recommender.row_book_ids[mid] == book_id) {
+            return mid;
+        }
+        if (recommender.row_book_ids[mid] < book_id) {
+            lo = mid + 1;
+        } else {
+            hi = mid - 1;
+        }
+    }
+    return -1;
+}
+
+/**
+ * @brief Find the delta row of a book, or the position to insert it.
+ */
+static int find_delta(int book_id, int *found) {
+    int lo = 0, hi = recommender.delta_count;
+    while (lo < hi) {
+        int mid = lo + (hi - lo) / 2;
+        if (recommender.delta_rows[mid].book_id < book_id) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    *found = lo < recommender.delta_count && recommender.delta_rows[lo].book_id == book_id;
+    return lo;
+}
+
+static int delta_add(int book_id, int neighbor_id) {
+    int found;
+    int pos = find_delta(book_id, &found);
+
+    if (!found) {
+        if (recommender.delta_count == recommender.delta_capacity) {
+            int capacity = recommender.delta_capacity ? recommender.delta_capacity * 2 : 64;
+            DeltaRow *rows = realloc(recommender.delta_rows, capacity * sizeof(DeltaRow));
+            if (rows == NULL) {
+                return -1;
+            }
+            recommender.delta_rows = rows;
+            recommender.delta_capacity = capacity;
+        }
+        memmove(&recommender.delta_rows[pos + 1], &recommender.delta_rows[pos],
+                (recommender.delta_count - pos) * sizeof(DeltaRow));
+        memset(&recommender.delta_rows[pos], 0, sizeof(DeltaRow));
+        recommender.delta_rows[pos].book_id = book_id;
+        recommender.delta_count++;
+    }
+
+    DeltaRow *row = &recommender.delta_rows[pos];
+    for (int i = 0; i < row->count; i++) {
+        if (row->entries[i].book_id == neighbor_id) {
+            row->entries[i].score++;
+            return 0;
+        }
+    }
+
+    if (row->count == row->capacity) {
+        int capacity = row->capacity ? row->capacity * 2 : 8;
+        Recommendation *entries = realloc(row->entries, capacity * sizeof(Recommendation));
+        if (entries == NULL) {
+            return -1;
+        }
+        row->entries = entries;
+        row->capacity = capacity;
+    }
+    row->entries[row->count].book_id = neighbor_id;
+    row->entries[row->count].score = 1;
+    row->count++;
+    return 0;
+}
+
+int catch_up_recommendations(sqlite3 *db) {
+    if (recommender.map == NULL) {
+        return 0;
+    }
+    if (db == NULL) {
+        fprintf(stderr, "Database connection is NULL\n");
+        return -1;
+    }
+
+    /* A loan in an open transaction may roll back, and AUTOINCREMENT then hands its
+       loan_id to the next loan; the first call outside a transaction picks it up */
+    if (!sqlite3_get_autocommit(db)) {
+        return 0;
+    }
+
+    const char *new_loans_sql = "SELECT loan_id, member_id, book_id FROM Loans "
+                                "WHERE loan_id > ? ORDER BY loan_id;";
+    const char *seen_sql = "SELECT 1 FROM Loans WHERE member_id = ? AND book_id = ? AND loan_id < ? LIMIT 1;";
+    const char *history_sql = "SELECT book_id FROM Loans WHERE member_id = ? AND loan_id < ? "
+                              "GROUP BY book_id ORDER BY MAX(loan_id) DESC LIMIT ?;";
+
+    /* Runs after every loan, so the statements stay prepared between calls */
+    sqlite3_stmt *new_loans = prepare_cached_statement(db, STMT_SLOT_RECOMMEND, new_loans_sql);
+    sqlite3_stmt *seen = prepare_cached_statement(db, STMT_SLOT_RECOMMEND + 1, seen_sql);
+    sqlite3_stmt *history = prepare_cached_statement(db, STMT_SLOT_RECOMMEND + 2, history_sql);
+    if (new_loans == NULL || seen == NULL || history == NULL) {
+        return -1;
+    }
+
+    sqlite3_bind_int64(new_loans, 1, recommender.last_loan_id);
+
+    int processed = 0;
+    int failed = 0;
+    while (!failed && sqlite3_step(new_loans) == SQLITE_ROW) {
+        int64_t loan_id = sqlite3_column_int64(new_loans, 0);
+        int member_id = sqlite3_column_int(new_loans, 1);
+        int book_id = sqlite3_column_int(new_loans, 2);
+
+        /* A repeat borrow of the same book adds no new pairs */
+        sqlite3_bind_int(seen, 1, member_id);
+        sqlite3_bind_int(seen, 2, book_id);
+        sqlite3_bind_int64(seen, 3, loan_id);
+        int repeat = sqlite3_step(seen) == SQLITE_ROW;
+        sqlite3_reset(seen);
+
+        if (!repeat) {
+            sqlite3_bind_int(history, 1, member_id);
+            sqlite3_bind_int64(history, 2, loan_id);
+            sqlite3_bind_int(history, 3, RECOMMEND_MAX_HISTORY - 1);
+            while (sqlite3_step(history) == SQLITE_ROW) {
+                int other = sqlite3_column_int(history, 0);
+                if (delta_add(book_id, other) != 0 || delta_add(other, book_id) != 0) {
+                    failed = 1;
+                    break;
+                }
+            }
+            sqlite3_reset(history);
+        }
+
+        recommender.last_loan_id = loan_id;
+        processed++;
+    }
+
+    sqlite3_reset(new_loans);
+    sqlite3_clear_bindings(new_loans);
+    sqlite3_clear_bindings(seen);
+    sqlite3_clear_bindings(history);
+
+    if (failed) {
+        fprintf(stderr, "Out of memory while updating recommendations\n");
+        return -1;
+    }
+
+    /* Keep the update table bounded */
+    recommender.pending_loans += processed;
+    if (recommender.pending_loans >= RECOMMEND_SAVE_LOANS) {
+        flush_recommendations();
+    }
+    return processed;
+}
+
+/**
+ * @brief Merge the mapped row and the delta row of a book into one list.
+ * 
+ * @return int Returns number of entries written to out (unsorted).
+ */
+static int merge_row(int book_id, Recommendation *out) {
+    int count = 0;
+    int row = find_row(book_id);
+    if (row >= 0) {
+        for (uint32_t i = recommender.row_offsets[row]; i < recommender.row_offsets[row + 1]; i++) {
+            out[count].book_id = recommender.neighbor_ids[i];
+            out[count].score = recommender.scores[i];
+            count++;
+        }
+    }
+
+    int found;
+    int pos = find_delta(book_id, &found);
+    if (found) {
+        int base_count = count;
+        const DeltaRow *delta = &recommender.delta_rows[pos];
+        for (int d = 0; d < delta->count; d++) {
+            int i = 0;
+            while (i < base_count && out[i].book_id != delta->entries[d].book_id) {
+                i++;
+            }
+            if (i < base_count) {
+                out[i].score += delta->entries[d].score;
+            } else {
+                out[count++] = delta->entries[d];
+            }
+        }
+    }
+    return count;
+}
+
+static int merged_row_capacity(int book_id) {
+    int found;
+    int pos = find_delta(book_id, &found);
+    return RECOMMEND_MAX_NEIGHBORS + (found ? recommender.delta_rows[pos].count : 0);
+}
+
+int get_similar_books(int book_id, Recommendation *results, int max_count) {
+    if (recommender.map == NULL || results == NULL || max_count <= 0) {
+        return -1;
+    }
+
+    Recommendation local[RECOMMEND_MAX_NEIGHBORS];
+    Recommendation *merged = local;
+    int capacity = merged_row_capacity(book_id);
+    if (capacity > RECOMMEND_MAX_NEIGHBORS) {
+        merged = malloc(capacity * sizeof(Recommendation));
+        if (merged == NULL) {
+            return -1;
+        }
+    }
+
+    int count = merge_row(book_id, merged);
+
+    /* Partial selection sort: only the first max_count positions are needed */
+    int wanted = count < max_count ? count : max_count;
+    for (int i = 0; i < wanted; i++) {
+        int best = i;
+        for (int j = i + 1; j < count; j++) {
+            if (compare_recommendations(&merged[j], &merged[best]) < 0) {
+                best = j;
+            }
+        }
+        Recommendation tmp = merged[i];
+        merged[i] = merged[best];
+        merged[best] = tmp;
+        results[i] = merged[i];
+    }
+
+    if (merged != local) {
+        free(merged);
+    }
+    return wanted;
+}
+
+int save_recommendations(const char *path) {
+    if (recommender.map == NULL || path == NULL) {
+        return -1;
+    }
+
+    uint32_t max_rows = recommender.row_count + (uint32_t)recommender.delta_count;
+    CsrMatrix matrix;
+    if (csr_alloc(&matrix, max_rows, max_rows * RECOMMEND_MAX_NEIGHBORS) != 0) {
+        fprintf(stderr, "Out of memory while saving recommendations\n");
+        return -1;
+    }
+
+    /* Walk mapped rows and delta rows together in book_id order */
+    uint32_t r = 0;
+    int d = 0;
+    int result = 0;
+    while (r < recommender.row_count || d < recommender.delta_count) {
+        int book_id;
+        if (d >= recommender.delta_count ||
+            (r < recommender.row_count && recommender.row_book_ids[r] <= recommender.delta_rows[d].book_id)) {
+            book_id = recommender.row_book_ids[r];
+        } else {
+            book_id = recommender.delta_rows[d].book_id;
+        }
+
+        Recommendation *merged = malloc(merged_row_capacity(book_id) * sizeof(Recommendation));
+        if (merged == NULL) {
+            result = -1;
+            break;
+        }
+        int count = merge_row(book_id, merged);
+        qsort(merged, count, sizeof(Recommendation), compare_recommendations);
+        csr_append_row(&matrix, book_id, merged, count);
+        free(merged);
+
+        if (r < recommender.row_count && recommender.row_book_ids[r] == book_id) {
+            r++;
+        }
+        if (d < recommender.delta_count && recommender.delta_rows[d].book_id == book_id) {
+            d++;
+        }
+    }
+
+    if (result == 0) {
+        result = write_matrix(path, &matrix, recommender.last_loan_id);
+    }
+    csr_free(&matrix);
+
+    if (result == 0) {
+        result = open_recommendations(path);
+    }
+    return result;
+}
+
+int flush_recommendations(void) {
+    if (recommender.map == NULL || recommender.pending_loans == 0) {
+        return 0;
+    }
+
+    char path[sizeof(recommender.path)];
+    snprintf(path, sizeof(path), "%s", recommender.path);
+    return save_recommendations(path) == 0 ? 1 : -1;
+}
@@ -0,0 +1,550 @@
+#include "reminder.h"
+#include "database.h"
+#include "date_utils.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define WHEEL_BITS 6
+#define WHEEL_SIZE (1 << WHEEL_BITS)      // 64 slots per level
+#define WHEEL_MASK (WHEEL_SIZE - 1)
+#define WHEEL_LEVELS 3                    // 64 days, 4096 days, 262144 days
+
+/* Lists an entry can be linked into: the wheel slots, then two special lists */
+#define LIST_EXPIRED (WHEEL_LEVELS * WHEEL_SIZE)   // due on or before the current day
+#define LIST_OVERFLOW (LIST_EXPIRED + 1)           // beyond the top level
+#define LIST_COUNT (LIST_OVERFLOW + 1)
+
+#define NO_ENTRY (-1)
+
+/* Days after the due date that trigger an overdue notification */
+static const int overdue_milestones[] = {1, 7, 14, 30};
+
+#define MILESTONE_COUNT ((int)(sizeof(overdue_milestones) / sizeof(overdue_milestones[0])))
+#define STEP_COUNT (1 + MILESTONE_COUNT)  // step 0 is the day-before reminder
+
+/**
+ * @brief A scheduled loan, waiting for its next notification.
+ */
+typedef struct {
+    int loan_id;
+    int member_id;
+    int book_id;
+    int due_day;
+    int fire_day;
+    int step;        // 0: due tomorrow, k: overdue milestone k - 1
+    int list;        // list the entry is linked into
+    int prev;
+    int next;        // also links the free list
+} TimerEntry;
+
+/**
+ * @brief Hierarchical timing wheel keyed by day number.
+ */
+typedef struct {
+    TimerEntry *entries;
+    int capacity;
+    int free_head;
+    int count;                 // scheduled loans
+    int heads[LIST_COUNT];
+    int *by_loan;              // loan_id -> entry index, NO_ENTRY if not scheduled
+    int by_loan_size;
+    int current_day;
+} TimingWheel;
+
+/**
+ * @brief Notifications waiting to be written to the outbox.
+ */
+typedef struct {
+    sqlite3 *db;
+    sqlite3_stmt *stmt;
+    ReminderCallback callback;
+    void *user_data;
+    Reminder rows[REMINDER_BATCH_SIZE];
+    int entries[REMINDER_BATCH_SIZE];  // wheel entry of each row, off every list until committed
+    int count;
+} OutboxBatch;
+
+static TimingWheel *wheel = NULL;
+
+/**
+ * @brief Day a step of a loan fires on.
+ */
+static int step_fire_day(int due_day, int step) {
+    return step == 0 ? due_day - 1 : due_day + overdue_milestones[step - 1];
+}
+
+/**
+ * @brief Pick the list for a fire day, relative to the wheel's current day.
+ * 
+ * A day goes to the lowest level whose current block contains it, so
+ * each slot only holds days that come up when the slot is next reached.
+ */
+static int list_for_day(int fire_day) {
+    int day = wheel->current_day;
+    
+    if (fire_day <= day) {
+        return LIST_EXPIRED;
+    }
+    for (int level = 0; level < WHEEL_LEVELS; level++) {
+        int shift = WHEEL_BITS * (level + 1);
+        if ((fire_day >> shift) == (day >> shift)) {
+            return level * WHEEL_SIZE + ((fire_day >> (WHEEL_BITS * level)) & WHEEL_MASK);
+        }
+    }
+    return LIST_OVERFLOW;
+}
+
+static void link_entry(int index, int list) {
+    TimerEntry *entry = &wheel->entries[index];
+    entry->list = list;
+    entry->prev = NO_ENTRY;
+    entry->next = wheel->heads[list];
+    if (entry->next != NO_ENTRY) {
+        wheel->entries[entry->next].prev = index;
+    }
+    wheel->heads[list] = index;
+}
+
+static void unlink_entry(int index) {
+    TimerEntry *entry = &wheel->entries[index];
+    if (entry->prev != NO_ENTRY) {
+        wheel->entries[entry->prev].next = entry->next;
+    } else {
+        wheel->heads[entry->list] = entry->next;
+    }
+    if (entry->next != NO_ENTRY) {
+        wheel->entries[entry->next].prev = entry->prev;
+    }
+}
+
+/**
+ * @brief Take every entry off a list.
+ * 
+ * @return int Returns the first entry of the detached chain (linked by next).
+ */
+static int detach_list(int list) {
+    int head = wheel->heads[list];
+    wheel->heads[list] = NO_ENTRY;
+    return head;
+}
+
+/**
+ * @brief Remove a loan from the wheel and return its entry to the free list.
+ */
+static void release_entry(int index) {
+    TimerEntry *entry = &wheel->entries[index];
+    wheel->by_loan[entry->loan_id] = NO_ENTRY;
+    entry->next = wheel->free_head;
+    wheel->free_head = index;
+    wheel->count--;
+}
+
+/**
+ * @brief Make room for a loan ID in the loan -> entry map.
+ * 
+ * @return int Returns 0 on success, -1 on failure.
+ */
+static int reserve_loan_id(int loan_id) {
+    if (loan_id < wheel->by_loan_size) {
+        return 0;
+    }
+    
+    int size = wheel->by_loan_size > 0 ? wheel->by_loan_size : 1024;
+    while (size <= loan_id) {
+        size *= 2;
+    }
+    int *by_loan = realloc(wheel->by_loan, (size_t)size * sizeof(int));
+    if (by_loan == NULL) {
+        return -1;
+    }
+    for (int i = wheel->by_loan_size; i < size; i++) {
+        by_loan[i] = NO_ENTRY;
+    }
+    wheel->by_loan = by_loan;
+    wheel->by_loan_size = size;
+    return 0;
+}
+
+/**
+ * @brief Get a free entry, growing the entry pool if needed.
+ * 
+ * @return int Returns the entry index, -1 on failure.
+ */
+static int alloc_entry(void) {
+    if (wheel->free_head == NO_ENTRY) {
+        int capacity = wheel->capacity > 0 ? wheel->capacity * 2 : 1024;
+        TimerEntry *entries = realloc(wheel->entries, (size_t)capacity * sizeof(TimerEntry));
+        if (entries == NULL) {
+            return -1;
+        }
+        for (int i = capacity - 1; i >= wheel->capacity; i--) {
+            entries[i].next = wheel->free_head;
+            wheel->free_head = i;
+        }
+        wheel->entries = entries;
+        wheel->capacity = capacity;
+    }
+    
+    int index = wheel->free_head;
+    wheel->free_head = wheel->entries[index].next;
+    return index;
+}
+
+/**
+ * @brief Arm a loan at its first step firing on or after from_day.
+ * 
+ * @return int Returns 0 on success (including loans with nothing left to fire), -1 on failure.
+ */
+static int schedule_entry(int loan_id, int member_id, int book_id, int due_day, int from_day) {
+    int step = 0;
+    while (step < STEP_COUNT && step_fire_day(due_day, step) < from_day) {
+        step++;
+    }
+    if (step == STEP_COUNT || loan_id <= 0) {
+        return 0;
+    }
+    
+    if (reserve_loan_id(loan_id) != 0) {
+        return -1;
+    }
+    if (wheel->by_loan[loan_id] != NO_ENTRY) {
+        unlink_entry(wheel->by_loan[loan_id]);
+        release_entry(wheel->by_loan[loan_id]);
+    }
+    
+    int index = alloc_entry();
+    if (index < 0) {
+        return -1;
+    }
+    
+    TimerEntry *entry = &wheel->entries[index];
+    entry->loan_id = loan_id;
+    entry->member_id = member_id;
+    entry->book_id = book_id;
+    entry->due_day = due_day;
+    entry->step = step;
+    entry->fire_day = step_fire_day(due_day, step);
+    link_entry(index, list_for_day(entry->fire_day));
+    wheel->by_loan[loan_id] = index;
+    wheel->count++;
+    return 0;
+}
+
+/**
+ * @brief Write the pending outbox rows in one transaction.
+ * 
+ * @return int Returns 0 on success, -1 on failure.
+ */
+static int flush_outbox(OutboxBatch *batch) {
+    if (batch->count == 0) {
+        return 0;
+    }
+    
+    // Join the caller's transaction if there is one
+    int own_transaction = sqlite3_get_autocommit(batch->db);
+    if (own_transaction && exec_with_retry(batch->db, "BEGIN IMMEDIATE;") != SQLITE_OK) {
+        fprintf(stderr, "Failed to begin transaction: %s\n", sqlite3_errmsg(batch->db));
+        return -1;
+    }
+    
+    for (int i = 0; i < batch->count; i++) {
+        const Reminder *reminder = &batch->rows[i];
+        char notify_date[16];
+        day_to_date(reminder->fire_day, notify_date, sizeof(notify_date));
+        
+        sqlite3_bind_int(batch->stmt, 1, reminder->loan_id);
+        sqlite3_bind_int(batch->stmt, 2, reminder->member_id);
+        sqlite3_bind_int(batch->stmt, 3, reminder->book_id);
+        sqlite3_bind_int(batch->stmt, 4, reminder->kind);
+        sqlite3_bind_int(batch->stmt, 5, reminder->overdue_days);
+        sqlite3_bind_text(batch->stmt, 6, notify_date, -1, SQLITE_TRANSIENT);
+        
+        if (sqlite3_step(batch->stmt) != SQLITE_DONE) {
+            fprintf(stderr, "Failed to write reminder outbox: %s\n", sqlite3_errmsg(batch->db));
+            sqlite3_reset(batch->stmt);
+            if (own_transaction) {
+                sqlite3_exec(batch->db, "ROLLBACK;", NULL, NULL, NULL);
+            }
+            return -1;
+        }
+        sqlite3_reset(batch->stmt);
+    }
+    
+    if (own_transaction && exec_with_retry(batch->db, "COMMIT;") != SQLITE_OK) {
+        fprintf(stderr, "Failed to commit reminder outbox: %s\n", sqlite3_errmsg(batch->db));
+        sqlite3_exec(batch->db, "ROLLBACK;", NULL, NULL, NULL);
+        return -1;
+    }
+    
+    batch->count = 0;
+    return 0;
+}
+
+/**
+ * @brief Write the pending rows and re-arm their loans at the next step.
+ * 
+ * Loans only move on once their outbox rows are committed; the callback
+ * sees the rows after that, so it may schedule or cancel loans freely.
+ * 
+ * @return int Returns 0 on success, -1 on failure (the rows stay pending).
+ */
+static int commit_batch(OutboxBatch *batch) {
+    int count = batch->count;
+    if (flush_outbox(batch) != 0) {
+        return -1;
+    }
+    
+    for (int i = 0; i < count; i++) {
+        int index = batch->entries[i];
+        TimerEntry *entry = &wheel->entries[index];
+        if (++entry->step < STEP_COUNT) {
+            entry->fire_day = step_fire_day(entry->due_day, entry->step);
+            link_entry(index, list_for_day(entry->fire_day));
+        } else {
+            release_entry(index);
+        }
+    }
+    
+    if (batch->callback != NULL) {
+        for (int i = 0; i < count; i++) {
+            batch->callback(&batch->rows[i], batch->user_data);
+        }
+    }
+    return 0;
+}
+
+/**
+ * @brief Put the loans of rows that failed to commit back on the wheel, unchanged.
+ */
+static void requeue_batch(OutboxBatch *batch) {
+    for (int i = 0; i < batch->count; i++) {
+        int index = batch->entries[i];
+        link_entry(index, list_for_day(wheel->entries[index].fire_day));
+    }
+    batch->count = 0;
+}
+
+/**
+ * @brief Fire every entry of a list and re-arm each loan at its next step.
+ * 
+ * Entries are taken off the list one at a time, so on failure the list
+ * still holds everything not yet in the batch.
+ * 
+ * @return int Returns number of notifications fired, -1 on failure.
+ */
+static int fire_list(int list, OutboxBatch *batch) {
+    int fired = 0;
+    
+    // A re-armed step can land on this list again (catching up the expired list)
+    while (wheel->heads[list] != NO_ENTRY) {
+        int index = wheel->heads[list];
+        TimerEntry *entry = &wheel->entries[index];
+        unlink_entry(index);
+        
+        batch->entries[batch->count] = index;
+        Reminder *reminder = &batch->rows[batch->count++];
+        reminder->loan_id = entry->loan_id;
+        reminder->member_id = entry->member_id;
+        reminder->book_id = entry->book_id;
+        reminder->due_day = entry->due_day;
+        reminder->fire_day = entry->fire_day;
+        reminder->kind = entry->step == 0 ? REMINDER_DUE_TOMORROW : REMINDER_OVERDUE;
+        reminder->overdue_days = entry->step == 0 ? 0 : overdue_milestones[entry->step - 1];
+        
+        if (batch->count == REMINDER_BATCH_SIZE || wheel->heads[list] == NO_ENTRY) {
+            int count = batch->count;
+            if (commit_batch(batch) != 0) {
+                return -1;
+            }
+            fired += count;
+        }
+    }
+    
+    return fired;
+}
+
+/**
+ * @brief Move every entry of a higher-level list down to its slot for the current day.
+ */
+static void cascade_list(int list) {
+    int index = detach_list(list);
+    while (index != NO_ENTRY) {
+        int next = wheel->entries[index].next;
+        link_entry(index, list_for_day(wheel->entries[index].fire_day));
+        index = next;
+    }
+}
+
+int load_reminder_scheduler(sqlite3 *db, int today) {
+    if (db == NULL) {
+        fprintf(stderr, "Database connection is NULL\n");
+        return -1;
+    }
+    
+    free_reminder_scheduler();
+    
+    wheel = calloc(1, sizeof(TimingWheel));
+    if (wheel == NULL) {
+        fprintf(stderr, "Out of memory\n");
+        return -1;
+    }
+    wheel->free_head = NO_ENTRY;
+    wheel->current_day = today;
+    for (int i = 0; i < LIST_COUNT; i++) {
+        wheel->heads[i] = NO_ENTRY;
+    }
+    
+    const char *sql = "SELECT loan_id, member_id, book_id, due_date FROM Loans WHERE is_returned = 0;";
+    
+    sqlite3_stmt *stmt;
+    if (sqlite3_prepare_v2(db, sql, -1, &stmt, NULL) != SQLITE_OK) {
+        fprintf(stderr, "Failed to prepare statement: %s\n", sqlite3_errmsg(db));
+        free_reminder_scheduler();
+        return -1;
+    }
+    
+    int rc;
+    while ((rc = sqlite3_step(stmt)) == SQLITE_ROW) {
+        int due_day;
+        if (date_to_day((const char *)sqlite3_column_text(stmt, 3), &due_day) != 0) {
+            continue;
+        }
+        if (schedule_entry(sqlite3_column_int(stmt, 0), sqlite3_column_int(stmt, 1),
+                           sqlite3_column_int(stmt, 2), due_day, today) != 0) {
+            fprintf(stderr, "Out of memory\n");
+            rc = SQLITE_NOMEM;
+            break;
+        }
+    }
+    
+    if (rc != SQLITE_DONE) {
+        if (rc != SQLITE_NOMEM) {
+            fprintf(stderr, "Error during query execution: %s\n", sqlite3_errmsg(db));
+        }
+        sqlite3_finalize(stmt);
+        free_reminder_scheduler();
+        return -1;
+    }
+    
+    sqlite3_finalize(stmt);
+    return wheel->count;
+}
+
+void free_reminder_scheduler(void) {
+    if (wheel == NULL) {
+        return;
+    }
+    
+    free(wheel->entries);
+    free(wheel->by_loan);
+    free(wheel);
+    wheel = NULL;
+}
+
+int reminder_schedule_loan(int loan_id, int member_id, int book_id, int due_day) {
+    if (wheel == NULL) {
+        return 0;
+    }
+    
+    // Arm from the current day so a loan due tomorrow is reminded on the next advance
+    if (schedule_entry(loan_id, member_id, book_id, due_day, wheel->current_day) != 0) {
+        fprintf(stderr, "Out of memory\n");
+        return -1;
+    }
+    return 0;
+}
+
+void reminder_cancel_loan(int loan_id) {
+    if (wheel == NULL || loan_id <= 0 || loan_id >= wheel->by_loan_size) {
+        return;
+    }
+    
+    int index = wheel->by_loan[loan_id];
+    if (index != NO_ENTRY) {
+        unlink_entry(index);
+        release_entry(index);
+    }
+}
+
+void reminder_move_book(int from_book_id, int to_book_id) {
+    if (wheel == NULL) {
+        return;
+    }
+    
+    for (int loan_id = 0; loan_id < wheel->by_loan_size; loan_id++) {
+        int index = wheel->by_loan[loan_id];
+        if (index != NO_ENTRY && wheel->entries[index].book_id == from_book_id) {
+            wheel->entries[index].book_id = to_book_id;
+        }
+    }
+}
+
+int advance_reminders(sqlite3 *db, int today, ReminderCallback callback, void *user_data) {
+    if (db == NULL || wheel == NULL) {
+        fprintf(stderr, "Reminder scheduler is not loaded\n");
+        return -1;
+    }
+    
+    OutboxBatch *batch = malloc(sizeof(OutboxBatch));
+    if (batch == NULL) {
+        fprintf(stderr, "Out of memory\n");
+        return -1;
+    }
+    batch->db = db;
+    batch->callback = callback;
+    batch->user_data = user_data;
+    batch->count = 0;
+    
+    const char *sql = "INSERT OR IGNORE INTO ReminderOutbox "
+                      "(loan_id, member_id, book_id, kind, overdue_days, notify_date) "
+                      "VALUES (?, ?, ?, ?, ?, ?);";
+    if (sqlite3_prepare_v2(db, sql, -1, &batch->stmt, NULL) != SQLITE_OK) {
+        fprintf(stderr, "Failed to prepare statement: %s\n", sqlite3_errmsg(db));
+        free(batch);
+        return -1;
+    }
+    
+    // Loans scheduled for the current day or earlier fire first
+    int total = fire_list(LIST_EXPIRED, batch);
+    
+    while (total >= 0 && wheel->current_day < today) {
+        int day = ++wheel->current_day;
+        
+        // Cascade higher levels when the day starts a new block of theirs
+        if ((day & WHEEL_MASK) == 0) {
+            if (((day >> WHEEL_BITS) & WHEEL_MASK) == 0) {
+                if (((day >> (2 * WHEEL_BITS)) & WHEEL_MASK) == 0) {
+                    cascade_list(LIST_OVERFLOW);
+                }
+                cascade_list(2 * WHEEL_SIZE + ((day >> (2 * WHEEL_BITS)) & WHEEL_MASK));
+            }
+            cascade_list(WHEEL_SIZE + ((day >> WHEEL_BITS) & WHEEL_MASK));
+        }
+        
+        int fired = fire_list(LIST_EXPIRED, batch);
+        if (fired >= 0) {
+            int slot_fired = fire_list(day & WHEEL_MASK, batch);
+            fired = slot_fired < 0 ? -1 : fired + slot_fired;
+        }
+        if (fired < 0) {
+            // Step back so the next advance replays this day; cascading it again is harmless
+            wheel->current_day = day - 1;
+            total = -1;
+        } else {
+            total += fired;
+        }
+    }
+    
+    if (total < 0) {
+        requeue_batch(batch);
+    }
+    
+    sqlite3_finalize(batch->stmt);
+    free(batch);
+    return total;
+}
+
+int reminder_pending_count(void) {
+    return wheel != NULL ? wheel->count : -1;
+}
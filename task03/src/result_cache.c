@@ -0,0 +1,510 @@
+#include "result_cache.h"
+#include "database.h"
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define BUCKET_COUNT 1024        // power of two
+
+/**
+ * @brief One column value of a stored row.
+ */
+typedef struct {
+    int type;                    // SQLITE_INTEGER, SQLITE_FLOAT, SQLITE_TEXT or SQLITE_NULL
+    union {
+        long long i;
+        double d;
+        size_t offset;           // of the NUL-terminated text in CachedResult.text
+    } v;
+} CachedValue;
+
+/**
+ * @brief The rows of one statement, while recording and once stored.
+ */
+typedef struct CachedResult {
+    uint64_t hash;
+    char *key;                   // expanded SQL, from sqlite3_expanded_sql()
+    int column_count;
+    int row_count;
+    CachedValue *values;         // row_count * column_count, row by row
+    size_t value_capacity;
+    char *text;
+    size_t text_size;
+    size_t text_capacity;
+    size_t bytes;                // memory charged to the budget
+    int readers;                 // open cursors replaying this result
+    int dropped;                 // removed while read, freed by the last cursor
+    struct CachedResult *next_in_bucket;
+    struct CachedResult *newer;  // LRU list, most recently used at the head
+    struct CachedResult *older;
+} CachedResult;
+
+typedef struct {
+    sqlite3 *db;
+    sqlite3_stmt *version_stmt;  // PRAGMA data_version
+    long long data_version;
+    long long total_changes;
+    CachedResult *buckets[BUCKET_COUNT];
+    CachedResult *newest;
+    CachedResult *oldest;
+    ResultCacheStats stats;
+} ResultCache;
+
+/* Per thread, like the connection it caches (see get_db_connection()) */
+static _Thread_local ResultCache *cache = NULL;
+
+static uint64_t hash_key(const char *key) {
+    uint64_t hash = 14695981039346656037ULL;    // FNV-1a
+    for (const unsigned char *p = (const unsigned char *)key; *p != '\0'; p++) {
+        hash = (hash ^ *p) * 1099511628211ULL;
+    }
+    return hash;
+}
+
+static void free_result(CachedResult *result) {
+    sqlite3_free(result->key);
+    free(result->values);
+    free(result->text);
+    free(result);
+}
+
+static size_t result_bytes(const CachedResult *result) {
+    return sizeof(CachedResult) + strlen(result->key) + 1 +
+           result->value_capacity * sizeof(CachedValue) + result->text_capacity;
+}
+
+/**
+ * @brief Unlink a stored result from its bucket and the LRU list, and free it.
+ */
+static void remove_result(CachedResult *result) {
+    CachedResult **link = &cache->buckets[result->hash & (BUCKET_COUNT - 1)];
+    while (*link != result) {
+        link = &(*link)->next_in_bucket;
+    }
+    *link = result->next_in_bucket;
+
+    if (result->newer != NULL) {
+        result->newer->older = result->older;
+    } else {
+        cache->newest = result->older;
+    }
+    if (result->older != NULL) {
+        result->older->newer = result->newer;
+    } else {
+        cache->oldest = result->newer;
+    }
+
+    cache->stats.entries--;
+    cache->stats.bytes -= result->bytes;
+    if (result->readers > 0) {
+        result->dropped = 1;
+    } else {
+        free_result(result);
+    }
+}
+
+static void move_to_front(CachedResult *result) {
+    if (cache->newest == result) {
+        return;
+    }
+    result->newer->older = result->older;
+    if (result->older != NULL) {
+        result->older->newer = result->newer;
+    } else {
+        cache->oldest = result->newer;
+    }
+    result->newer = NULL;
+    result->older = cache->newest;
+    cache->newest->newer = result;
+    cache->newest = result;
+}
+
+static void drop_all(void) {
+    while (cache->oldest != NULL) {
+        remove_result(cache->oldest);
+    }
+}
+
+/**
+ * @brief Drop every result if the database changed since the last check.
+ * 
+ * @return int Returns 0 if the cache can be used, -1 inside a transaction
+ *         or if the data version cannot be read.
+ */
+static int check_data_version(void) {
+    if (!sqlite3_get_autocommit(cache->db)) {
+        return -1;    // uncommitted writes may still be rolled back
+    }
+    if (cache->version_stmt == NULL &&
+        sqlite3_prepare_v2(cache->db, "PRAGMA data_version;", -1, &cache->version_stmt, NULL) != SQLITE_OK) {
+        fprintf(stderr, "Failed to prepare statement: %s\n", sqlite3_errmsg(cache->db));
+        return -1;
+    }
+    int rc = sqlite3_step(cache->version_stmt);
+    long long version = sqlite3_column_int64(cache->version_stmt, 0);
+    sqlite3_reset(cache->version_stmt);
+    if (rc != SQLITE_ROW) {
+        return -1;
+    }
+
+    long long changes = sqlite3_total_changes(cache->db);
+    if (version != cache->data_version || changes != cache->total_changes) {
+        if (cache->stats.entries > 0) {
+            drop_all();
+            cache->stats.invalidations++;
+        }
+        cache->data_version = version;
+        cache->total_changes = changes;
+    }
+    return 0;
+}
+
+/**
+ * @brief Copy the current row of the statement into a result being recorded.
+ * 
+ * @return int Returns 0 on success, -1 on failure.
+ */
+static int record_row(CachedResult *result, sqlite3_stmt *stmt) {
+    size_t needed = (size_t)(result->row_count + 1) * (size_t)result->column_count;
+    if (needed > result->value_capacity) {
+        size_t capacity = result->value_capacity ? result->value_capacity * 2 : (size_t)result->column_count * 16;
+        while (capacity < needed) {
+            capacity *= 2;
+        }
+        CachedValue *values = realloc(result->values, capacity * sizeof(CachedValue));
+        if (values == NULL) {
+            return -1;
+        }
+        result->values = values;
+        result->value_capacity = capacity;
+    }
+
+    CachedValue *row = result->values + (size_t)result->row_count * (size_t)result->column_count;
+    for (int i = 0; i < result->column_count; i++) {
+        int type = sqlite3_column_type(stmt, i);
+        row[i].type = type;
+        if (type == SQLITE_INTEGER) {
+            row[i].v.i = sqlite3_column_int64(stmt, i);
+        } else if (type == SQLITE_FLOAT) {
+            row[i].v.d = sqlite3_column_double(stmt, i);
+        } else if (type != SQLITE_NULL) {
+            const char *text = (const char *)sqlite3_column_text(stmt, i);
+            size_t length = (size_t)sqlite3_column_bytes(stmt, i);
+            if (result->text_size + length + 1 > result->text_capacity) {
+                size_t capacity = result->text_capacity ? result->text_capacity * 2 : 4096;
+                while (capacity < result->text_size + length + 1) {
+                    capacity *= 2;
+                }
+                char *grown = realloc(result->text, capacity);
+                if (grown == NULL) {
+                    return -1;
+                }
+                result->text = grown;
+                result->text_capacity = capacity;
+            }
+            memcpy(result->text + result->text_size, text, length);
+            result->text[result->text_size + length] = '\0';
+            row[i].type = SQLITE_TEXT;
+            row[i].v.offset = result->text_size;
+            result->text_size += length + 1;
+        }
+    }
+    result->row_count++;
+    return 0;
+}
+
+/**
+ * @brief Store a fully read result, evicting the least recently used ones.
+ */
+static void store_result(CachedResult *result) {
+    // Trim the growth slack so the charge matches what is kept
+    size_t values = (size_t)result->row_count * (size_t)result->column_count;
+    if (values < result->value_capacity) {
+        CachedValue *trimmed = realloc(result->values, (values ? values : 1) * sizeof(CachedValue));
+        if (trimmed != NULL) {
+            result->values = trimmed;
+            result->value_capacity = values ? values : 1;
+        }
+    }
+    if (result->text_size < result->text_capacity && result->text_size > 0) {
+        char *trimmed = realloc(result->text, result->text_size);
+        if (trimmed != NULL) {
+            result->text = trimmed;
+            result->text_capacity = result->text_size;
+        }
+    }
+    result->bytes = result_bytes(result);
+    if (result->bytes > cache->stats.budget / RESULT_CACHE_ENTRY_SHARE) {
+        cache->stats.uncached++;
+        free_result(result);
+        return;
+    }
+
+    while (cache->oldest != NULL && cache->stats.bytes + result->bytes > cache->stats.budget) {
+        remove_result(cache->oldest);
+        cache->stats.evictions++;
+    }
+
+    CachedResult **bucket = &cache->buckets[result->hash & (BUCKET_COUNT - 1)];
+    result->next_in_bucket = *bucket;
+    *bucket = result;
+    result->newer = NULL;
+    result->older = cache->newest;
+    if (cache->newest != NULL) {
+        cache->newest->newer = result;
+    } else {
+        cache->oldest = result;
+    }
+    cache->newest = result;
+    cache->stats.entries++;
+    cache->stats.bytes += result->bytes;
+}
+
+/**
+ * @brief Load result cache for the current thread's connection.
+ * 
+ * @param budget Memory budget in bytes (RESULT_CACHE_DEFAULT_BUDGET if 0).
+ * @return int Returns 0 on success, -1 on failure.
+ */
+int load_result_cache(size_t budget) {
+    sqlite3 *db = get_db_connection();
+    if (db == NULL) {
+        fprintf(stderr, "Database not initialized\n");
+        return -1;
+    }
+
+    free_result_cache();
+    cache = calloc(1, sizeof(ResultCache));
+    if (cache == NULL) {
+        return -1;
+    }
+    cache->db = db;
+    cache->data_version = -1;
+    cache->total_changes = -1;
+    cache->stats.budget = budget > 0 ? budget : RESULT_CACHE_DEFAULT_BUDGET;
+    return 0;
+}
+
+/**
+ * @brief Drop every result and stop caching on the current thread.
+ */
+void free_result_cache(void) {
+    if (cache == NULL) {
+        return;
+    }
+    drop_all();
+    sqlite3_finalize(cache->version_stmt);
+    free(cache);
+    cache = NULL;
+}
+
+/**
+ * @brief Drop every cached result.
+ */
+void invalidate_result_cache(void) {
+    if (cache != NULL && cache->stats.entries > 0) {
+        drop_all();
+        cache->stats.invalidations++;
+    }
+}
+
+/**
+ * @brief Copy the counters of the current thread's cache.
+ * 
+ * @param stats Pointer to store the counters.
+ * @return int Returns 0 on success, -1 if the cache is not loaded.
+ */
+int get_result_cache_stats(ResultCacheStats *stats) {
+    if (cache == NULL || stats == NULL) {
+        return -1;
+    }
+    *stats = cache->stats;
+    return 0;
+}
+
+/**
+ * @brief Print the cache counters and hit rate.
+ * 
+ * @return int Returns 0 on success, -1 if the cache is not loaded.
+ */
+int display_result_cache_stats(void) {
+    if (cache == NULL) {
+        return -1;
+    }
+    const ResultCacheStats *s = &cache->stats;
+    long lookups = s->hits + s->misses;
+    printf("\n=== Query Result Cache ===\n");
+    printf("Hits: %ld, Misses: %ld (hit rate %.1f%%)\n", s->hits, s->misses,
+           lookups > 0 ? 100.0 * s->hits / lookups : 0.0);
+    printf("Evictions: %ld, Invalidations: %ld, Not cached: %ld\n",
+           s->evictions, s->invalidations, s->uncached);
+    printf("Results: %zu, Memory: %zu / %zu KiB\n", s->entries, s->bytes / 1024, s->budget / 1024);
+    return 0;
+}
+
+/**
+ * @brief Open a cursor on a prepared and bound read-only statement.
+ * 
+ * @param cursor Cursor to open.
+ * @param stmt The prepared and bound statement.
+ */
+void result_cursor_open(ResultCursor *cursor, sqlite3_stmt *stmt) {
+    memset(cursor, 0, sizeof(*cursor));
+    cursor->stmt = stmt;
+    cursor->row = -1;
+
+    if (cache == NULL || sqlite3_db_handle(stmt) != cache->db || !sqlite3_stmt_readonly(stmt)) {
+        return;
+    }
+    if (check_data_version() != 0) {
+        cache->stats.uncached++;
+        return;
+    }
+
+    char *key = sqlite3_expanded_sql(stmt);
+    if (key == NULL) {
+        return;
+    }
+    uint64_t hash = hash_key(key);
+    for (CachedResult *result = cache->buckets[hash & (BUCKET_COUNT - 1)]; result != NULL;
+         result = result->next_in_bucket) {
+        if (result->hash == hash && strcmp(result->key, key) == 0) {
+            sqlite3_free(key);
+            move_to_front(result);
+            cache->stats.hits++;
+            result->readers++;
+            cursor->result = result;
+            return;
+        }
+    }
+
+    cache->stats.misses++;
+    CachedResult *recording = calloc(1, sizeof(CachedResult));
+    if (recording == NULL) {
+        sqlite3_free(key);
+        return;
+    }
+    recording->hash = hash;
+    recording->key = key;
+    recording->column_count = sqlite3_column_count(stmt);
+    cursor->recording = recording;
+}
+
+/**
+ * @brief Move to the next row.
+ * 
+ * @param cursor The cursor.
+ * @return int Returns SQLITE_ROW, SQLITE_DONE or the SQLite error code.
+ */
+int result_cursor_step(ResultCursor *cursor) {
+    if (cursor->result != NULL) {
+        if (cursor->row + 1 < cursor->result->row_count) {
+            cursor->row++;
+            return SQLITE_ROW;
+        }
+        cursor->row = cursor->result->row_count;
+        return SQLITE_DONE;
+    }
+
+    int rc = sqlite3_step(cursor->stmt);
+    CachedResult *recording = cursor->recording;
+    if (recording == NULL) {
+        return rc;
+    }
+    if (rc == SQLITE_ROW) {
+        if (record_row(recording, cursor->stmt) == 0 &&
+            recording->value_capacity * sizeof(CachedValue) + recording->text_capacity <=
+            cache->stats.budget / RESULT_CACHE_ENTRY_SHARE) {
+            return rc;
+        }
+        cache->stats.uncached++;    // too large: stop recording, keep reading
+    } else if (rc == SQLITE_DONE) {
+        cursor->recording = NULL;
+        store_result(recording);
+        return rc;
+    }
+    cursor->recording = NULL;
+    free_result(recording);
+    return rc;
+}
+
+/**
+ * @brief Get the stored value of a column of the current row.
+ */
+static const CachedValue *cached_value(const ResultCursor *cursor, int column) {
+    const CachedResult *result = cursor->result;
+    if (cursor->row < 0 || cursor->row >= result->row_count || column < 0 || column >= result->column_count) {
+        return NULL;
+    }
+    return &result->values[(size_t)cursor->row * (size_t)result->column_count + (size_t)column];
+}
+
+/**
+ * @brief Get a column of the current row as an integer.
+ * 
+ * @param cursor The cursor.
+ * @param column Column index.
+ * @return long long Returns the value (0 for NULL).
+ */
+long long result_cursor_int(ResultCursor *cursor, int column) {
+    if (cursor->result == NULL) {
+        return sqlite3_column_int64(cursor->stmt, column);
+    }
+    const CachedValue *value = cached_value(cursor, column);
+    if (value == NULL) {
+        return 0;
+    }
+    switch (value->type) {
+        case SQLITE_INTEGER: return value->v.i;
+        case SQLITE_FLOAT:   return (long long)value->v.d;
+        case SQLITE_TEXT:    return strtoll(cursor->result->text + value->v.offset, NULL, 10);
+        default:             return 0;
+    }
+}
+
+/**
+ * @brief Get a column of the current row as text.
+ * 
+ * @param cursor The cursor.
+ * @param column Column index.
+ * @return const char* Returns the text, valid until the next step, or NULL for NULL.
+ */
+const char *result_cursor_text(ResultCursor *cursor, int column) {
+    if (cursor->result == NULL) {
+        return (const char *)sqlite3_column_text(cursor->stmt, column);
+    }
+    const CachedValue *value = cached_value(cursor, column);
+    if (value == NULL) {
+        return NULL;
+    }
+    switch (value->type) {
+        case SQLITE_INTEGER:
+            snprintf(cursor->number, sizeof(cursor->number), "%lld", value->v.i);
+            return cursor->number;
+        case SQLITE_FLOAT:
+            snprintf(cursor->number, sizeof(cursor->number), "%.15g", value->v.d);
+            return cursor->number;
+        case SQLITE_TEXT:
+            return cursor->result->text + value->v.offset;
+        default:
+            return NULL;
+    }
+}
+
+/**
+ * @brief Close a cursor; a result not read to the end is not stored.
+ * 
+ * @param cursor The cursor.
+ */
+void result_cursor_close(ResultCursor *cursor) {
+    if (cursor->recording != NULL) {
+        free_result(cursor->recording);
+        cursor->recording = NULL;
+    }
+    CachedResult *result = cursor->result;
+    if (result != NULL && --result->readers == 0 && result->dropped) {
+        free_result(result);
+    }
+    cursor->result = NULL;
+}
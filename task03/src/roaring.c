@@ -0,0 +1,517 @@
+#include "roaring.h"
+#include <stdlib.h>
+#include <string.h>
+
+/**
+ * @brief A container of either a RoaringBitmap or a RoaringView, read-only.
+ */
+typedef struct {
+    uint16_t key;
+    uint16_t kind;
+    uint32_t cardinality;
+    const void *data;
+} ContainerRef;
+
+typedef ContainerRef (*ContainerAt)(const void *source, int index);
+
+static ContainerRef memory_container(const void *source, int index) {
+    const RoaringContainer *c = &((const RoaringBitmap *)source)->containers[index];
+    ContainerRef ref = {c->key, c->kind, c->cardinality, c->data};
+    return ref;
+}
+
+static ContainerRef file_container(const void *source, int index) {
+    const RoaringView *view = source;
+    const RoaringFileContainer *c = &view->containers[index];
+    ContainerRef ref = {c->key, c->kind, c->cardinality, view->data + c->offset};
+    return ref;
+}
+
+/**
+ * @brief Position of the first array value not less than value.
+ */
+static uint32_t lower_bound(const uint16_t *values, uint32_t count, uint16_t value) {
+    uint32_t lo = 0, hi = count;
+    while (lo < hi) {
+        uint32_t mid = lo + (hi - lo) / 2;
+        if (values[mid] < value) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return lo;
+}
+
+static int ref_contains(ContainerRef ref, uint16_t low) {
+    if (ref.kind == ROARING_BITMAP) {
+        return (int)((((const uint64_t *)ref.data)[low >> 6] >> (low & 63)) & 1);
+    }
+    const uint16_t *values = ref.data;
+    uint32_t pos = lower_bound(values, ref.cardinality, low);
+    return pos < ref.cardinality && values[pos] == low;
+}
+
+static uint32_t count_bits(const uint64_t *words) {
+    uint32_t count = 0;
+    for (int i = 0; i < ROARING_BITMAP_WORDS; i++) {
+        count += (uint32_t)__builtin_popcountll(words[i]);
+    }
+    return count;
+}
+
+static int to_bitmap(RoaringContainer *c) {
+    uint64_t *words = calloc(ROARING_BITMAP_WORDS, sizeof(uint64_t));
+    if (words == NULL) {
+        return -1;
+    }
+    const uint16_t *values = c->data;
+    for (uint32_t i = 0; i < c->cardinality; i++) {
+        words[values[i] >> 6] |= 1ULL << (values[i] & 63);
+    }
+    free(c->data);
+    c->data = words;
+    c->kind = ROARING_BITMAP;
+    c->capacity = 0;
+    return 0;
+}
+
+/**
+ * @brief Turn a bitmap back into an array once it is small enough.
+ * 
+ * Best effort: without memory the bitmap is kept, which is still valid.
+ */
+static void shrink_to_array(RoaringContainer *c) {
+    if (c->kind != ROARING_BITMAP || c->cardinality > ROARING_ARRAY_MAX) {
+        return;
+    }
+    uint16_t *values = malloc((c->cardinality ? c->cardinality : 1) * sizeof(uint16_t));
+    if (values == NULL) {
+        return;
+    }
+    const uint64_t *words = c->data;
+    uint32_t count = 0;
+    for (int i = 0; i < ROARING_BITMAP_WORDS; i++) {
+        for (uint64_t word = words[i]; word != 0; word &= word - 1) {
+            values[count++] = (uint16_t)(i * 64 + __builtin_ctzll(word));
+        }
+    }
+    free(c->data);
+    c->data = values;
+    c->kind = ROARING_ARRAY;
+    c->capacity = c->cardinality ? c->cardinality : 1;
+}
+
+static int copy_container(ContainerRef src, RoaringContainer *out) {
+    size_t bytes = src.kind == ROARING_BITMAP ? ROARING_BITMAP_WORDS * sizeof(uint64_t)
+                                              : src.cardinality * sizeof(uint16_t);
+    out->data = malloc(bytes);
+    if (out->data == NULL) {
+        return -1;
+    }
+    memcpy(out->data, src.data, bytes);
+    out->key = src.key;
+    out->kind = src.kind;
+    out->cardinality = src.cardinality;
+    out->capacity = src.kind == ROARING_ARRAY ? src.cardinality : 0;
+    return 0;
+}
+
+static int container_add(RoaringContainer *c, uint16_t low) {
+    if (c->kind == ROARING_BITMAP) {
+        uint64_t *word = &((uint64_t *)c->data)[low >> 6];
+        uint64_t bit = 1ULL << (low & 63);
+        c->cardinality += (*word & bit) == 0;
+        *word |= bit;
+        return 0;
+    }
+
+    uint16_t *values = c->data;
+    uint32_t pos = c->cardinality == 0 || values[c->cardinality - 1] < low
+                   ? c->cardinality : lower_bound(values, c->cardinality, low);
+    if (pos < c->cardinality && values[pos] == low) {
+        return 0;
+    }
+    if (c->cardinality == ROARING_ARRAY_MAX) {
+        return to_bitmap(c) != 0 ? -1 : container_add(c, low);
+    }
+    if (c->cardinality == c->capacity) {
+        uint32_t capacity = c->capacity ? c->capacity * 2 : 4;
+        if (capacity > ROARING_ARRAY_MAX) {
+            capacity = ROARING_ARRAY_MAX;
+        }
+        values = realloc(c->data, capacity * sizeof(uint16_t));
+        if (values == NULL) {
+            return -1;
+        }
+        c->data = values;
+        c->capacity = capacity;
+    }
+    memmove(&values[pos + 1], &values[pos], (c->cardinality - pos) * sizeof(uint16_t));
+    values[pos] = low;
+    c->cardinality++;
+    return 0;
+}
+
+static int container_or(RoaringContainer *dst, ContainerRef src) {
+    if (dst->kind == ROARING_ARRAY && src.kind == ROARING_ARRAY &&
+        dst->cardinality + src.cardinality <= ROARING_ARRAY_MAX) {
+        const uint16_t *a = dst->data;
+        const uint16_t *b = src.data;
+        uint32_t capacity = dst->cardinality + src.cardinality;
+        uint16_t *merged = malloc(capacity * sizeof(uint16_t));
+        if (merged == NULL) {
+            return -1;
+        }
+        uint32_t i = 0, j = 0, k = 0;
+        while (i < dst->cardinality && j < src.cardinality) {
+            if (a[i] < b[j]) {
+                merged[k++] = a[i++];
+            } else if (a[i] > b[j]) {
+                merged[k++] = b[j++];
+            } else {
+                merged[k++] = a[i++];
+                j++;
+            }
+        }
+        while (i < dst->cardinality) {
+            merged[k++] = a[i++];
+        }
+        while (j < src.cardinality) {
+            merged[k++] = b[j++];
+        }
+        free(dst->data);
+        dst->data = merged;
+        dst->cardinality = k;
+        dst->capacity = capacity;
+        return 0;
+    }
+
+    if (dst->kind == ROARING_ARRAY && to_bitmap(dst) != 0) {
+        return -1;
+    }
+    uint64_t *words = dst->data;
+    if (src.kind == ROARING_BITMAP) {
+        const uint64_t *other = src.data;
+        for (int i = 0; i < ROARING_BITMAP_WORDS; i++) {
+            words[i] |= other[i];
+        }
+    } else {
+        const uint16_t *values = src.data;
+        for (uint32_t i = 0; i < src.cardinality; i++) {
+            words[values[i] >> 6] |= 1ULL << (values[i] & 63);
+        }
+    }
+    dst->cardinality = count_bits(words);
+    shrink_to_array(dst);
+    return 0;
+}
+
+static int container_and(RoaringContainer *dst, ContainerRef src) {
+    if (dst->kind == ROARING_ARRAY) {
+        /* Filter in place */
+        uint16_t *values = dst->data;
+        uint32_t k = 0;
+        if (src.kind == ROARING_ARRAY) {
+            const uint16_t *other = src.data;
+            uint32_t j = 0;
+            for (uint32_t i = 0; i < dst->cardinality && j < src.cardinality; i++) {
+                while (j < src.cardinality && other[j] < values[i]) {
+                    j++;
+                }
+                if (j < src.cardinality && other[j] == values[i]) {
+                    values[k++] = values[i];
+                }
+            }
+        } else {
+            for (uint32_t i = 0; i < dst->cardinality; i++) {
+                if (ref_contains(src, values[i])) {
+                    values[k++] = values[i];
+                }
+            }
+        }
+        dst->cardinality = k;
+        return 0;
+    }
+
+    uint64_t *words = dst->data;
+    if (src.kind == ROARING_BITMAP) {
+        const uint64_t *other = src.data;
+        for (int i = 0; i < ROARING_BITMAP_WORDS; i++) {
+            words[i] &= other[i];
+        }
+        dst->cardinality = count_bits(words);
+        shrink_to_array(dst);
+        return 0;
+    }
+
+    /* The result is no larger than the array */
+    uint16_t *values = malloc((src.cardinality ? src.cardinality : 1) * sizeof(uint16_t));
+    if (values == NULL) {
+        return -1;
+    }
+    const uint16_t *other = src.data;
+    uint32_t k = 0;
+    for (uint32_t i = 0; i < src.cardinality; i++) {
+        if ((words[other[i] >> 6] >> (other[i] & 63)) & 1) {
+            values[k++] = other[i];
+        }
+    }
+    free(words);
+    dst->data = values;
+    dst->kind = ROARING_ARRAY;
+    dst->cardinality = k;
+    dst->capacity = src.cardinality ? src.cardinality : 1;
+    return 0;
+}
+
+void roaring_init(RoaringBitmap *bitmap) {
+    bitmap->containers = NULL;
+    bitmap->count = 0;
+    bitmap->capacity = 0;
+}
+
+void roaring_free(RoaringBitmap *bitmap) {
+    for (int i = 0; i < bitmap->count; i++) {
+        free(bitmap->containers[i].data);
+    }
+    free(bitmap->containers);
+    roaring_init(bitmap);
+}
+
+static int find_key(const RoaringBitmap *bitmap, uint16_t key, int *found) {
+    int lo = 0, hi = bitmap->count;
+    while (lo < hi) {
+        int mid = lo + (hi - lo) / 2;
+        if (bitmap->containers[mid].key < key) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    *found = lo < bitmap->count && bitmap->containers[lo].key == key;
+    return lo;
+}
+
+int roaring_add(RoaringBitmap *bitmap, uint32_t value) {
+    uint16_t key = (uint16_t)(value >> 16);
+    int found, pos;
+    if (bitmap->count > 0 && bitmap->containers[bitmap->count - 1].key == key) {
+        pos = bitmap->count - 1;
+        found = 1;
+    } else if (bitmap->count == 0 || bitmap->containers[bitmap->count - 1].key < key) {
+        pos = bitmap->count;
+        found = 0;
+    } else {
+        pos = find_key(bitmap, key, &found);
+    }
+
+    if (!found) {
+        if (bitmap->count == bitmap->capacity) {
+            int capacity = bitmap->capacity ? bitmap->capacity * 2 : 4;
+            RoaringContainer *grown = realloc(bitmap->containers, capacity * sizeof(RoaringContainer));
+            if (grown == NULL) {
+                return -1;
+            }
+            bitmap->containers = grown;
+            bitmap->capacity = capacity;
+        }
+        memmove(&bitmap->containers[pos + 1], &bitmap->containers[pos],
+                (bitmap->count - pos) * sizeof(RoaringContainer));
+        memset(&bitmap->containers[pos], 0, sizeof(RoaringContainer));
+        bitmap->containers[pos].key = key;
+        bitmap->count++;
+    }
+
+    if (container_add(&bitmap->containers[pos], (uint16_t)value) != 0) {
+        if (bitmap->containers[pos].cardinality == 0) {
+            /* Do not leave an empty container behind */
+            free(bitmap->containers[pos].data);
+            memmove(&bitmap->containers[pos], &bitmap->containers[pos + 1],
+                    (bitmap->count - pos - 1) * sizeof(RoaringContainer));
+            bitmap->count--;
+        }
+        return -1;
+    }
+    return 0;
+}
+
+void roaring_remove(RoaringBitmap *bitmap, uint32_t value) {
+    int found;
+    int pos = find_key(bitmap, (uint16_t)(value >> 16), &found);
+    if (!found) {
+        return;
+    }
+
+    RoaringContainer *c = &bitmap->containers[pos];
+    uint16_t low = (uint16_t)value;
+    if (c->kind == ROARING_BITMAP) {
+        uint64_t *word = &((uint64_t *)c->data)[low >> 6];
+        uint64_t bit = 1ULL << (low & 63);
+        if ((*word & bit) == 0) {
+            return;
+        }
+        *word &= ~bit;
+        c->cardinality--;
+        shrink_to_array(c);
+    } else {
+        uint16_t *values = c->data;
+        uint32_t at = lower_bound(values, c->cardinality, low);
+        if (at == c->cardinality || values[at] != low) {
+            return;
+        }
+        memmove(&values[at], &values[at + 1], (c->cardinality - at - 1) * sizeof(uint16_t));
+        c->cardinality--;
+    }
+
+    if (c->cardinality == 0) {
+        free(c->data);
+        memmove(&bitmap->containers[pos], &bitmap->containers[pos + 1],
+                (bitmap->count - pos - 1) * sizeof(RoaringContainer));
+        bitmap->count--;
+    }
+}
+
+int roaring_contains(const RoaringBitmap *bitmap, uint32_t value) {
+    int found;
+    int pos = find_key(bitmap, (uint16_t)(value >> 16), &found);
+    return found && ref_contains(memory_container(bitmap, pos), (uint16_t)value);
+}
+
+int roaring_view_contains(const RoaringView *view, uint32_t value) {
+    uint16_t key = (uint16_t)(value >> 16);
+    int lo = 0, hi = view->count - 1;
+    while (lo <= hi) {
+        int mid = lo + (hi - lo) / 2;
+        if (view->containers[mid].key == key) {
+            return ref_contains(file_container(view, mid), (uint16_t)value);
+        }
+        if (view->containers[mid].key < key) {
+            lo = mid + 1;
+        } else {
+            hi = mid - 1;
+        }
+    }
+    return 0;
+}
+
+long roaring_cardinality(const RoaringBitmap *bitmap) {
+    long total = 0;
+    for (int i = 0; i < bitmap->count; i++) {
+        total += bitmap->containers[i].cardinality;
+    }
+    return total;
+}
+
+/**
+ * @brief Merge the containers of a source into dst, key by key.
+ */
+static int or_containers(RoaringBitmap *dst, const void *source, int source_count, ContainerAt at) {
+    if (source_count == 0) {
+        return 0;
+    }
+    int capacity = dst->count + source_count;
+    RoaringContainer *merged = malloc(capacity * sizeof(RoaringContainer));
+    if (merged == NULL) {
+        return -1;
+    }
+
+    int i = 0, j = 0, k = 0, failed = 0;
+    while (i < dst->count || (!failed && j < source_count)) {
+        if (failed || j >= source_count) {
+            merged[k++] = dst->containers[i++];
+            continue;
+        }
+        ContainerRef src = at(source, j);
+        if (i < dst->count && dst->containers[i].key < src.key) {
+            merged[k++] = dst->containers[i++];
+        } else if (i >= dst->count || src.key < dst->containers[i].key) {
+            if (copy_container(src, &merged[k]) != 0) {
+                failed = 1;
+            } else {
+                k++;
+            }
+            j++;
+        } else {
+            failed = container_or(&dst->containers[i], src) != 0;
+            merged[k++] = dst->containers[i++];
+            j++;
+        }
+    }
+
+    free(dst->containers);
+    dst->containers = merged;
+    dst->count = k;
+    dst->capacity = capacity;
+    return failed ? -1 : 0;
+}
+
+/**
+ * @brief Intersect the containers of dst with those of a source, dropping emptied ones.
+ */
+static int and_containers(RoaringBitmap *dst, const void *source, int source_count, ContainerAt at) {
+    int j = 0, k = 0, failed = 0;
+    for (int i = 0; i < dst->count; i++) {
+        RoaringContainer *c = &dst->containers[i];
+        while (j < source_count && at(source, j).key < c->key) {
+            j++;
+        }
+        if (!failed && j < source_count && at(source, j).key == c->key) {
+            failed = container_and(c, at(source, j)) != 0;
+        } else if (!failed) {
+            c->cardinality = 0;
+        }
+        if (c->cardinality == 0) {
+            free(c->data);
+        } else {
+            dst->containers[k++] = *c;
+        }
+    }
+    dst->count = k;
+    return failed ? -1 : 0;
+}
+
+int roaring_or(RoaringBitmap *dst, const RoaringBitmap *src) {
+    return or_containers(dst, src, src->count, memory_container);
+}
+
+int roaring_or_view(RoaringBitmap *dst, const RoaringView *src) {
+    return or_containers(dst, src, src->count, file_container);
+}
+
+int roaring_and(RoaringBitmap *dst, const RoaringBitmap *src) {
+    return and_containers(dst, src, src->count, memory_container);
+}
+
+int roaring_and_view(RoaringBitmap *dst, const RoaringView *src) {
+    return and_containers(dst, src, src->count, file_container);
+}
+
+long roaring_to_array(const RoaringBitmap *bitmap, uint32_t *out, long max_count) {
+    long count = 0;
+    for (int i = 0; i < bitmap->count && count < max_count; i++) {
+        const RoaringContainer *c = &bitmap->containers[i];
+        uint32_t high = (uint32_t)c->key << 16;
+        if (c->kind == ROARING_ARRAY) {
+            const uint16_t *values = c->data;
+            for (uint32_t v = 0; v < c->cardinality && count < max_count; v++) {
+                out[count++] = high | values[v];
+            }
+        } else {
+            const uint64_t *words = c->data;
+            for (int w = 0; w < ROARING_BITMAP_WORDS && count < max_count; w++) {
+                for (uint64_t word = words[w]; word != 0 && count < max_count; word &= word - 1) {
+                    out[count++] = high | (uint32_t)(w * 64 + __builtin_ctzll(word));
+                }
+            }
+        }
+    }
+    return count;
+}
+
+size_t roaring_container_bytes(int kind, uint32_t cardinality) {
+    if (kind == ROARING_BITMAP) {
+        return ROARING_BITMAP_WORDS * sizeof(uint64_t);
+    }
+    return (cardinality * sizeof(uint16_t) + 7) & ~(size_t)7;
+}
@@ -0,0 +1,359 @@
+#include "rollup.h"
+#include "database.h"
+#include "date_utils.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define BAR_WIDTH 40   // width of the longest bar in the report
+
+/* Offsets into the STMT_SLOT_ROLLUP slots; each source has its own pending/daily/monthly triple */
+#define ROLLUP_SLOT_READ_STATE 0
+#define ROLLUP_SLOT_SAVE_STATE 1
+#define ROLLUP_SLOT_LOANS 2
+#define ROLLUP_SLOT_RETURNS 5
+#define ROLLUP_SLOT_PENDING 0
+#define ROLLUP_SLOT_DAILY 1
+#define ROLLUP_SLOT_MONTHLY 2
+
+/* Day numbers (date_to_day() SQL function) and YYYYMM month keys are computed in SQL so each batch is one statement */
+static const char *fold_loans_daily_sql =
+    "INSERT INTO CirculationDaily (day, genre, loans, returns) "
+    "SELECT date_to_day(l.loan_date), COALESCE(b.genre, ''), COUNT(*), 0 "
+    "FROM Loans l LEFT JOIN Books b ON b.book_id = l.book_id "
+    "WHERE l.loan_id > ?1 AND l.loan_id <= ?2 AND date_to_day(l.loan_date) IS NOT NULL "
+    "GROUP BY 1, 2 "
+    "ON CONFLICT(day, genre) DO UPDATE SET loans = loans + excluded.loans;";
+
+static const char *fold_loans_monthly_sql =
+    "INSERT INTO CirculationMonthly (month, genre, loans, returns) "
+    "SELECT CAST(strftime('%Y%m', l.loan_date) AS INTEGER), COALESCE(b.genre, ''), COUNT(*), 0 "
+    "FROM Loans l LEFT JOIN Books b ON b.book_id = l.book_id "
+    "WHERE l.loan_id > ?1 AND l.loan_id <= ?2 AND date_to_day(l.loan_date) IS NOT NULL "
+    "GROUP BY 1, 2 "
+    "ON CONFLICT(month, genre) DO UPDATE SET loans = loans + excluded.loans;";
+
+static const char *fold_returns_daily_sql =
+    "INSERT INTO CirculationDaily (day, genre, loans, returns) "
+    "SELECT date_to_day(r.return_date), COALESCE(b.genre, ''), 0, COUNT(*) "
+    "FROM Returns r JOIN Loans l ON l.loan_id = r.loan_id LEFT JOIN Books b ON b.book_id = l.book_id "
+    "WHERE r.return_id > ?1 AND r.return_id <= ?2 AND date_to_day(r.return_date) IS NOT NULL "
+    "GROUP BY 1, 2 "
+    "ON CONFLICT(day, genre) DO UPDATE SET returns = returns + excluded.returns;";
+
+static const char *fold_returns_monthly_sql =
+    "INSERT INTO CirculationMonthly (month, genre, loans, returns) "
+    "SELECT CAST(strftime('%Y%m', r.return_date) AS INTEGER), COALESCE(b.genre, ''), 0, COUNT(*) "
+    "FROM Returns r JOIN Loans l ON l.loan_id = r.loan_id LEFT JOIN Books b ON b.book_id = l.book_id "
+    "WHERE r.return_id > ?1 AND r.return_id <= ?2 AND date_to_day(r.return_date) IS NOT NULL "
+    "GROUP BY 1, 2 "
+    "ON CONFLICT(month, genre) DO UPDATE SET returns = returns + excluded.returns;";
+
+/**
+ * @brief Run a rollup upsert over the rowid range (low, high].
+ * 
+ * @return int Returns 0 on success, -1 on failure.
+ */
+static int run_range(sqlite3 *db, int slot, const char *sql, sqlite3_int64 low, sqlite3_int64 high) {
+    sqlite3_stmt *stmt = prepare_cached_statement(db, STMT_SLOT_ROLLUP + slot, sql);
+    if (stmt == NULL) {
+        return -1;
+    }
+
+    sqlite3_bind_int64(stmt, 1, low);
+    sqlite3_bind_int64(stmt, 2, high);
+
+    int rc = sqlite3_step(stmt);
+    if (rc != SQLITE_DONE) {
+        fprintf(stderr, "Failed to update rollups: %s\n", sqlite3_errmsg(db));
+    }
+    sqlite3_reset(stmt);
+    sqlite3_clear_bindings(stmt);
+    return rc == SQLITE_DONE ? 0 : -1;
+}
+
+/**
+ * @brief Fold the rows of one source table above its saved position.
+ * 
+ * Runs inside every process_loan/process_return, so the statements stay
+ * prepared between calls.
+ * 
+ * @param db SQLite database connection.
+ * @param name RollupState key of the source.
+ * @param slot First of the source's three cache slots (offset from STMT_SLOT_ROLLUP).
+ * @param pending_sql Query taking the saved position and returning the new maximum rowid and row count.
+ * @param daily_sql Upsert into CirculationDaily for a rowid range.
+ * @param monthly_sql Upsert into CirculationMonthly for a rowid range.
+ * @return int Returns number of rows folded, -1 on failure.
+ */
+static int fold_source(sqlite3 *db, const char *name, int slot, const char *pending_sql,
+                       const char *daily_sql, const char *monthly_sql) {
+    sqlite3_int64 last_id = 0;
+
+    sqlite3_stmt *stmt = prepare_cached_statement(db, STMT_SLOT_ROLLUP + ROLLUP_SLOT_READ_STATE,
+                                                  "SELECT last_id FROM RollupState WHERE name = ?;");
+    if (stmt == NULL) {
+        return -1;
+    }
+    sqlite3_bind_text(stmt, 1, name, -1, SQLITE_STATIC);
+    if (sqlite3_step(stmt) == SQLITE_ROW) {
+        last_id = sqlite3_column_int64(stmt, 0);
+    }
+    sqlite3_reset(stmt);
+    sqlite3_clear_bindings(stmt);
+
+    stmt = prepare_cached_statement(db, STMT_SLOT_ROLLUP + slot + ROLLUP_SLOT_PENDING, pending_sql);
+    if (stmt == NULL) {
+        return -1;
+    }
+    sqlite3_bind_int64(stmt, 1, last_id);
+
+    sqlite3_int64 max_id = last_id;
+    int pending = 0;
+    if (sqlite3_step(stmt) == SQLITE_ROW) {
+        max_id = sqlite3_column_int64(stmt, 0);
+        pending = sqlite3_column_int(stmt, 1);
+    }
+    sqlite3_reset(stmt);
+    sqlite3_clear_bindings(stmt);
+
+    if (pending == 0) {
+        return 0;
+    }
+
+    if (run_range(db, slot + ROLLUP_SLOT_DAILY, daily_sql, last_id, max_id) != 0 ||
+        run_range(db, slot + ROLLUP_SLOT_MONTHLY, monthly_sql, last_id, max_id) != 0) {
+        return -1;
+    }
+
+    stmt = prepare_cached_statement(db, STMT_SLOT_ROLLUP + ROLLUP_SLOT_SAVE_STATE,
+                                    "INSERT INTO RollupState (name, last_id) VALUES (?, ?) "
+                                    "ON CONFLICT(name) DO UPDATE SET last_id = excluded.last_id;");
+    if (stmt == NULL) {
+        return -1;
+    }
+    sqlite3_bind_text(stmt, 1, name, -1, SQLITE_STATIC);
+    sqlite3_bind_int64(stmt, 2, max_id);
+    int rc = sqlite3_step(stmt);
+    if (rc != SQLITE_DONE) {
+        fprintf(stderr, "Failed to save rollup position: %s\n", sqlite3_errmsg(db));
+    }
+    sqlite3_reset(stmt);
+    sqlite3_clear_bindings(stmt);
+    if (rc != SQLITE_DONE) {
+        return -1;
+    }
+
+    return pending;
+}
+
+int update_circulation_rollups(sqlite3 *db) {
+    if (db == NULL) {
+        fprintf(stderr, "Database connection is NULL\n");
+        return -1;
+    }
+
+    /* Join the caller's transaction (process_loan/process_return) when there is one */
+    int own_transaction = sqlite3_get_autocommit(db);
+    if (own_transaction && exec_with_retry(db, "BEGIN IMMEDIATE;") != SQLITE_OK) {
+        fprintf(stderr, "Failed to begin transaction: %s\n", sqlite3_errmsg(db));
+        return -1;
+    }
+
+    int loans = fold_source(db, "loans", ROLLUP_SLOT_LOANS,
+                            "SELECT MAX(loan_id), COUNT(*) FROM Loans WHERE loan_id > ?;",
+                            fold_loans_daily_sql, fold_loans_monthly_sql);
+    int returns = loans < 0 ? -1 : fold_source(db, "returns", ROLLUP_SLOT_RETURNS,
+                                               "SELECT MAX(return_id), COUNT(*) FROM Returns WHERE return_id > ?;",
+                                               fold_returns_daily_sql, fold_returns_monthly_sql);
+
+    if (returns < 0) {
+        if (own_transaction) {
+            sqlite3_exec(db, "ROLLBACK;", 0, 0, NULL);
+        }
+        return -1;
+    }
+    if (own_transaction && exec_with_retry(db, "COMMIT;") != SQLITE_OK) {
+        fprintf(stderr, "Failed to commit rollups: %s\n", sqlite3_errmsg(db));
+        sqlite3_exec(db, "ROLLBACK;", 0, 0, NULL);
+        return -1;
+    }
+
+    return loans + returns;
+}
+
+/**
+ * @brief Convert a YYYY-MM-DD date to the key used by a rollup table.
+ * 
+ * @return int Returns 0 on success, -1 if the date is invalid.
+ */
+static int period_key(RollupGranularity granularity, const char *date, int *key) {
+    int day;
+    if (date_to_day(date, &day) != 0) {
+        fprintf(stderr, "Invalid date: %s\n", date ? date : "(null)");
+        return -1;
+    }
+
+    if (granularity == ROLLUP_DAILY) {
+        *key = day;
+    } else {
+        int year, month;
+        sscanf(date, "%4d-%2d", &year, &month);
+        *key = year * 100 + month;
+    }
+    return 0;
+}
+
+/**
+ * @brief Format a rollup key as YYYY-MM-DD or YYYY-MM.
+ */
+static void format_period(RollupGranularity granularity, int key, char *period, size_t size) {
+    if (granularity == ROLLUP_DAILY) {
+        day_to_date(key, period, size);
+    } else {
+        snprintf(period, size, "%04d-%02d", key / 100 % 10000, key % 100);
+    }
+}
+
+int get_circulation_series(sqlite3 *db, RollupGranularity granularity, const char *from_date,
+                           const char *to_date, const char *genre, CirculationPoint *points, int max_count) {
+    if (db == NULL) {
+        fprintf(stderr, "Database connection is NULL\n");
+        return -1;
+    }
+
+    int from_key, to_key;
+    if (period_key(granularity, from_date, &from_key) != 0 ||
+        period_key(granularity, to_date, &to_key) != 0) {
+        return -1;
+    }
+
+    const char *sql = granularity == ROLLUP_DAILY
+        ? "SELECT day, SUM(loans), SUM(returns) FROM CirculationDaily "
+          "WHERE day BETWEEN ?1 AND ?2 AND (?3 IS NULL OR genre = ?3) "
+          "GROUP BY day ORDER BY day;"
+        : "SELECT month, SUM(loans), SUM(returns) FROM CirculationMonthly "
+          "WHERE month BETWEEN ?1 AND ?2 AND (?3 IS NULL OR genre = ?3) "
+          "GROUP BY month ORDER BY month;";
+
+    sqlite3_stmt *stmt;
+    if (sqlite3_prepare_v2(db, sql, -1, &stmt, NULL) != SQLITE_OK) {
+        fprintf(stderr, "Failed to prepare statement: %s\n", sqlite3_errmsg(db));
+        return -1;
+    }
+
+    sqlite3_bind_int(stmt, 1, from_key);
+    sqlite3_bind_int(stmt, 2, to_key);
+    if (genre != NULL) {
+        sqlite3_bind_text(stmt, 3, genre, -1, SQLITE_STATIC);
+    }
+
+    int count = 0;
+    int rc = SQLITE_DONE;
+    while (count < max_count && (rc = sqlite3_step(stmt)) == SQLITE_ROW) {
+        format_period(granularity, sqlite3_column_int(stmt, 0), points[count].period, sizeof(points[count].period));
+        points[count].loans = sqlite3_column_int(stmt, 1);
+        points[count].returns = sqlite3_column_int(stmt, 2);
+        count++;
+    }
+
+    if (count < max_count && rc != SQLITE_DONE) {
+        fprintf(stderr, "Error during query execution: %s\n", sqlite3_errmsg(db));
+        count = -1;
+    }
+    sqlite3_finalize(stmt);
+    return count;
+}
+
+/**
+ * @brief Print loans and returns per genre for a key range of one rollup table.
+ */
+static void display_genre_totals(sqlite3 *db, RollupGranularity granularity, int from_key, int to_key) {
+    const char *sql = granularity == ROLLUP_DAILY
+        ? "SELECT genre, SUM(loans) AS total, SUM(returns) FROM CirculationDaily "
+          "WHERE day BETWEEN ? AND ? GROUP BY genre ORDER BY total DESC;"
+        : "SELECT genre, SUM(loans) AS total, SUM(returns) FROM CirculationMonthly "
+          "WHERE month BETWEEN ? AND ? GROUP BY genre ORDER BY total DESC;";
+
+    sqlite3_stmt *stmt;
+    if (sqlite3_prepare_v2(db, sql, -1, &stmt, NULL) != SQLITE_OK) {
+        fprintf(stderr, "Failed to prepare statement: %s\n", sqlite3_errmsg(db));
+        return;
+    }
+
+    sqlite3_bind_int(stmt, 1, from_key);
+    sqlite3_bind_int(stmt, 2, to_key);
+
+    printf("\n%-20s %8s %8s\n", "Genre", "Loans", "Returns");
+    printf("--------------------------------------\n");
+    while (sqlite3_step(stmt) == SQLITE_ROW) {
+        const char *genre = (const char *)sqlite3_column_text(stmt, 0);
+        printf("%-20s %8d %8d\n", genre && *genre ? genre : "(none)",
+               sqlite3_column_int(stmt, 1), sqlite3_column_int(stmt, 2));
+    }
+    sqlite3_finalize(stmt);
+}
+
+int display_circulation_report(sqlite3 *db, RollupGranularity granularity, const char *from_date,
+                               const char *to_date, const char *genre) {
+    int from_key, to_key;
+    if (period_key(granularity, from_date, &from_key) != 0 ||
+        period_key(granularity, to_date, &to_key) != 0) {
+        return -1;
+    }
+
+    /* Upper bound on the number of periods in the range */
+    int max_count = granularity == ROLLUP_DAILY
+        ? to_key - from_key + 1
+        : (to_key / 100 - from_key / 100) * 12 + to_key % 100 - from_key % 100 + 1;
+    if (max_count <= 0) {
+        fprintf(stderr, "Empty date range\n");
+        return -1;
+    }
+
+    CirculationPoint *points = malloc(max_count * sizeof(CirculationPoint));
+    if (points == NULL) {
+        fprintf(stderr, "Out of memory\n");
+        return -1;
+    }
+
+    int count = get_circulation_series(db, granularity, from_date, to_date, genre, points, max_count);
+    if (count < 0) {
+        free(points);
+        return -1;
+    }
+
+    int peak = 1;
+    int total_loans = 0;
+    int total_returns = 0;
+    for (int i = 0; i < count; i++) {
+        if (points[i].loans > peak) {
+            peak = points[i].loans;
+        }
+        total_loans += points[i].loans;
+        total_returns += points[i].returns;
+    }
+
+    printf("\n========== Circulation (%s, %s ~ %s%s%s) ==========\n",
+           granularity == ROLLUP_DAILY ? "daily" : "monthly", from_date, to_date,
+           genre ? ", " : "", genre ? genre : "");
+    printf("%-10s %8s %8s  %s\n", "Period", "Loans", "Returns", "Loans");
+    printf("--------------------------------------------------------------------------\n");
+    for (int i = 0; i < count; i++) {
+        char bar[BAR_WIDTH + 1];
+        int width = (int)((long long)points[i].loans * BAR_WIDTH / peak);
+        memset(bar, '#', width);
+        bar[width] = '\0';
+        printf("%-10s %8d %8d  %s\n", points[i].period, points[i].loans, points[i].returns, bar);
+    }
+    printf("--------------------------------------------------------------------------\n");
+    printf("Total: %d loans, %d returns in %d periods\n", total_loans, total_returns, count);
+
+    if (genre == NULL) {
+        display_genre_totals(db, granularity, from_key, to_key);
+    }
+    printf("\n");
+
+    free(points);
+    return count;
+}
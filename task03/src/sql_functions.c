@@ -0,0 +1,84 @@
+#include "sql_functions.h"
+#include "date_utils.h"
+#include "loan.h"
+#include <stdio.h>
+
+#define SQL_FUNCTION_FLAGS (SQLITE_UTF8 | SQLITE_DETERMINISTIC | SQLITE_INNOCUOUS)
+
+/**
+ * @brief Read a date argument as a day number.
+ * 
+ * @return int Returns 0 on success, -1 if the argument is NULL or not a date.
+ */
+static int value_to_day(sqlite3_value *value, int *day) {
+    if (sqlite3_value_type(value) == SQLITE_NULL) {
+        return -1;
+    }
+    return date_to_day((const char *)sqlite3_value_text(value), day);
+}
+
+/**
+ * @brief SQL date_to_day(date).
+ */
+static void sql_date_to_day(sqlite3_context *ctx, int argc, sqlite3_value **argv) {
+    (void)argc;
+    int day;
+    if (value_to_day(argv[0], &day) != 0) {
+        sqlite3_result_null(ctx);
+        return;
+    }
+    sqlite3_result_int(ctx, day);
+}
+
+/**
+ * @brief SQL overdue_days(due_date, as_of).
+ */
+static void sql_overdue_days(sqlite3_context *ctx, int argc, sqlite3_value **argv) {
+    (void)argc;
+    int due_day, as_of_day;
+    if (value_to_day(argv[0], &due_day) != 0 || value_to_day(argv[1], &as_of_day) != 0) {
+        sqlite3_result_null(ctx);
+        return;
+    }
+    sqlite3_result_int(ctx, as_of_day > due_day ? as_of_day - due_day : 0);
+}
+
+/**
+ * @brief SQL suspension_days(overdue_days).
+ */
+static void sql_suspension_days(sqlite3_context *ctx, int argc, sqlite3_value **argv) {
+    (void)argc;
+    if (sqlite3_value_type(argv[0]) == SQLITE_NULL) {
+        sqlite3_result_null(ctx);
+        return;
+    }
+    int overdue_days = sqlite3_value_int(argv[0]);
+    sqlite3_result_int(ctx, calculate_suspension_days(overdue_days > 0 ? overdue_days : 0));
+}
+
+int register_sql_functions(sqlite3 *db) {
+    static const struct {
+        const char *name;
+        int argc;
+        void (*func)(sqlite3_context *, int, sqlite3_value **);
+    } functions[] = {
+        {"date_to_day", 1, sql_date_to_day},
+        {"overdue_days", 2, sql_overdue_days},
+        {"suspension_days", 1, sql_suspension_days}
+    };
+    
+    if (db == NULL) {
+        return -1;
+    }
+    
+    for (size_t i = 0; i < sizeof(functions) / sizeof(functions[0]); i++) {
+        int rc = sqlite3_create_function_v2(db, functions[i].name, functions[i].argc, SQL_FUNCTION_FLAGS,
+                                            NULL, functions[i].func, NULL, NULL, NULL);
+        if (rc != SQLITE_OK) {
+            fprintf(stderr, "Failed to register SQL function %s: %s\n", functions[i].name, sqlite3_errmsg(db));
+            return -1;
+        }
+    }
+    
+    return 0;
+}
@@ -0,0 +1,366 @@
+#include "table.h"
+#include "utf8.h"
+#include <stdarg.h>
+#include <stdlib.h>
+#include <string.h>
+#ifndef _WIN32
+#include <signal.h>
+#include <unistd.h>
+#endif
+
+static TableFormat current_format = TABLE_FORMAT_ALIGNED;
+static int pager_enabled = 1;
+
+#ifndef _WIN32
+/* SIGPIPE handler to restore once the pager is closed */
+static void (*saved_sigpipe)(int) = SIG_DFL;
+#endif
+
+static const char spaces[] = "                                                                ";
+
+void table_set_format(TableFormat format) {
+    current_format = format;
+}
+
+TableFormat table_get_format(void) {
+    return current_format;
+}
+
+int table_parse_format(const char *name) {
+    if (name == NULL) {
+        return -1;
+    }
+    if (strcmp(name, "table") == 0) {
+        return TABLE_FORMAT_ALIGNED;
+    }
+    if (strcmp(name, "csv") == 0) {
+        return TABLE_FORMAT_CSV;
+    }
+    if (strcmp(name, "tsv") == 0) {
+        return TABLE_FORMAT_TSV;
+    }
+    if (strcmp(name, "json") == 0) {
+        return TABLE_FORMAT_JSON;
+    }
+    return -1;
+}
+
+void table_set_pager(int enabled) {
+    pager_enabled = enabled;
+}
+
+/**
+ * @brief Pick where output goes the first time anything is written out.
+ * 
+ * Output longer than a page by then goes through the pager.
+ */
+static FILE *destination(Table *table) {
+    if (!table->destination_chosen) {
+        table->destination_chosen = 1;
+#ifndef _WIN32
+        if (table->page_lines > 0 && table->lines > table->page_lines) {
+            const char *command = getenv("PAGER");
+            if (command == NULL || command[0] == '\0') {
+                command = TABLE_DEFAULT_PAGER;
+            }
+            
+            // Quitting the pager early must not kill the program
+            fflush(table->out);
+            saved_sigpipe = signal(SIGPIPE, SIG_IGN);
+            table->pager = popen(command, "w");
+            if (table->pager == NULL) {
+                signal(SIGPIPE, saved_sigpipe);
+            }
+        }
+#endif
+    }
+    return table->pager != NULL ? table->pager : table->out;
+}
+
+static void flush_buffer(Table *table) {
+    if (table->size > 0) {
+        fwrite(table->buffer, 1, table->size, destination(table));
+        table->size = 0;
+    }
+}
+
+static void put(Table *table, const char *data, size_t length) {
+    if (table->buffer == NULL) {
+        fwrite(data, 1, length, destination(table));
+        return;
+    }
+    if (table->size + length > TABLE_BUFFER_SIZE) {
+        flush_buffer(table);
+        if (length > TABLE_BUFFER_SIZE) {
+            fwrite(data, 1, length, destination(table));
+            return;
+        }
+    }
+    memcpy(table->buffer + table->size, data, length);
+    table->size += length;
+}
+
+static void put_str(Table *table, const char *text) {
+    put(table, text, strlen(text));
+}
+
+static void put_spaces(Table *table, size_t count) {
+    while (count > 0) {
+        size_t n = count < sizeof(spaces) - 1 ? count : sizeof(spaces) - 1;
+        put(table, spaces, n);
+        count -= n;
+    }
+}
+
+/**
+ * @brief Write text padded or cut to a display width.
+ */
+static void put_aligned(Table *table, const char *text, int width, int pad) {
+    size_t total = utf8_display_width(text);
+    if (width <= 0) {
+        put_str(table, text);
+        return;
+    }
+    
+    size_t used = total;
+    if (total <= (size_t)width) {
+        put_str(table, text);
+    } else {
+        // Keep whole characters that fit, leaving room for ".."
+        size_t limit = width >= 3 ? (size_t)width - 2 : (size_t)width;
+        const char *p = text;
+        used = 0;
+        while (*p) {
+            uint32_t cp;
+            int length = utf8_decode(p, &cp);
+            size_t char_width = (size_t)utf8_char_width(cp);
+            if (used + char_width > limit) {
+                break;
+            }
+            used += char_width;
+            p += length;
+        }
+        put(table, text, (size_t)(p - text));
+        if (width >= 3) {
+            put(table, "..", 2);
+            used += 2;
+        }
+    }
+    
+    if (pad && used < (size_t)width) {
+        put_spaces(table, (size_t)width - used);
+    }
+}
+
+static void put_json_string(Table *table, const char *text) {
+    put(table, "\"", 1);
+    const char *run = text;
+    for (const char *p = text; *p != '\0'; p++) {
+        unsigned char c = (unsigned char)*p;
+        if (c >= 0x20 && c != '"' && c != '\\') {
+            continue;
+        }
+        put(table, run, (size_t)(p - run));
+        run = p + 1;
+        
+        char escape[8];
+        switch (c) {
+            case '"':  put(table, "\\\"", 2); break;
+            case '\\': put(table, "\\\\", 2); break;
+            case '\n': put(table, "\\n", 2); break;
+            case '\r': put(table, "\\r", 2); break;
+            case '\t': put(table, "\\t", 2); break;
+            default:
+                snprintf(escape, sizeof(escape), "\\u%04x", c);
+                put_str(table, escape);
+        }
+    }
+    put_str(table, run);
+    put(table, "\"", 1);
+}
+
+static void put_csv(Table *table, const char *text) {
+    if (strpbrk(text, ",\"\r\n") == NULL) {
+        put_str(table, text);
+        return;
+    }
+    
+    // Quote the field and double embedded quotes
+    put(table, "\"", 1);
+    const char *run = text;
+    const char *quote;
+    while ((quote = strchr(run, '"')) != NULL) {
+        put(table, run, (size_t)(quote - run) + 1);
+        put(table, "\"", 1);
+        run = quote + 1;
+    }
+    put_str(table, run);
+    put(table, "\"", 1);
+}
+
+static void put_tsv(Table *table, const char *text) {
+    const char *run = text;
+    for (const char *p = text; *p != '\0'; p++) {
+        if (*p == '\t' || *p == '\r' || *p == '\n') {
+            put(table, run, (size_t)(p - run));
+            put(table, " ", 1);
+            run = p + 1;
+        }
+    }
+    put_str(table, run);
+}
+
+/**
+ * @brief Write a cell; quoted marks text (as opposed to a number) for JSON.
+ */
+static void put_cell(Table *table, const char *text, int quoted) {
+    const TableColumn *column = &table->columns[table->column];
+    int last = table->column == table->column_count - 1;
+    
+    if (table->column == 0) {
+        if (table->format == TABLE_FORMAT_JSON) {
+            put_str(table, table->rows > 0 ? ",\n{" : "\n{");
+        }
+    } else {
+        static const char separators[] = {' ', ',', '\t', ','};
+        put(table, &separators[table->format], 1);
+    }
+    
+    switch (table->format) {
+        case TABLE_FORMAT_ALIGNED:
+            put_aligned(table, text != NULL ? text : "", column->width, !last);
+            break;
+        case TABLE_FORMAT_CSV:
+            put_csv(table, text != NULL ? text : "");
+            break;
+        case TABLE_FORMAT_TSV:
+            put_tsv(table, text != NULL ? text : "");
+            break;
+        case TABLE_FORMAT_JSON:
+            put_json_string(table, column->name);
+            put(table, ":", 1);
+            if (text == NULL) {
+                put_str(table, "null");
+            } else if (quoted) {
+                put_json_string(table, text);
+            } else {
+                put_str(table, text);
+            }
+            break;
+    }
+    
+    if (last) {
+        put_str(table, table->format == TABLE_FORMAT_JSON ? "}" : "\n");
+        table->column = 0;
+        table->rows++;
+        table->lines++;
+    } else {
+        table->column++;
+    }
+}
+
+void table_begin(Table *table, FILE *out, const char *title, const TableColumn *columns, int column_count) {
+    memset(table, 0, sizeof(*table));
+    table->out = out;
+    table->format = current_format;
+    table->columns = columns;
+    table->column_count = column_count;
+    table->buffer = malloc(TABLE_BUFFER_SIZE);
+    
+#ifndef _WIN32
+    if (pager_enabled && out == stdout && isatty(fileno(stdout))) {
+        const char *lines = getenv("LINES");
+        table->page_lines = lines != NULL && atoi(lines) > 0 ? atoi(lines) : TABLE_PAGE_LINES;
+    }
+#endif
+    
+    switch (table->format) {
+        case TABLE_FORMAT_ALIGNED: {
+            if (title != NULL) {
+                put_str(table, title);
+                for (const char *p = title; *p != '\0'; p++) {
+                    table->lines += *p == '\n';
+                }
+            }
+            
+            size_t rule = 0;
+            for (int i = 0; i < column_count; i++) {
+                if (i > 0) {
+                    put(table, " ", 1);
+                }
+                put_aligned(table, columns[i].name, columns[i].width, i < column_count - 1);
+                rule += (i > 0) + (columns[i].width > 0 ? (size_t)columns[i].width
+                                                        : utf8_display_width(columns[i].name));
+            }
+            put(table, "\n", 1);
+            for (size_t i = 0; i < rule; i++) {
+                put(table, "-", 1);
+            }
+            put(table, "\n", 1);
+            table->lines += 2;
+            break;
+        }
+        case TABLE_FORMAT_CSV:
+        case TABLE_FORMAT_TSV:
+            for (int i = 0; i < column_count; i++) {
+                if (i > 0) {
+                    put(table, table->format == TABLE_FORMAT_CSV ? "," : "\t", 1);
+                }
+                if (table->format == TABLE_FORMAT_CSV) {
+                    put_csv(table, columns[i].name);
+                } else {
+                    put_tsv(table, columns[i].name);
+                }
+            }
+            put(table, "\n", 1);
+            table->lines++;
+            break;
+        case TABLE_FORMAT_JSON:
+            put(table, "[", 1);
+            break;
+    }
+}
+
+void table_text(Table *table, const char *text) {
+    put_cell(table, text, 1);
+}
+
+void table_int(Table *table, long long value) {
+    char text[24];
+    snprintf(text, sizeof(text), "%lld", value);
+    put_cell(table, text, 0);
+}
+
+int table_end(Table *table, const char *footer, ...) {
+    // Close a row left incomplete by the caller
+    while (table->column != 0) {
+        put_cell(table, NULL, 1);
+    }
+    
+    if (table->format == TABLE_FORMAT_JSON) {
+        put_str(table, table->rows > 0 ? "\n]\n" : "]\n");
+    } else if (table->format == TABLE_FORMAT_ALIGNED && footer != NULL) {
+        char text[256];
+        va_list args;
+        va_start(args, footer);
+        vsnprintf(text, sizeof(text), footer, args);
+        va_end(args);
+        put_str(table, text);
+    }
+    
+    flush_buffer(table);
+    destination(table);
+    if (table->pager != NULL) {
+        pclose(table->pager);
+#ifndef _WIN32
+        signal(SIGPIPE, saved_sigpipe);
+#endif
+        table->pager = NULL;
+    } else {
+        fflush(table->out);
+    }
+    
+    free(table->buffer);
+    table->buffer = NULL;
+    return table->rows;
+}
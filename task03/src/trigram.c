@@ -0,0 +1,574 @@
+#include "trigram.h"
+#include "database.h"
+#include "utf8.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+#define MAX_DOC_TRIGRAMS (2 * TRIGRAM_MAX_TEXT)
+#define MIN_CANDIDATES 64        // candidates re-ranked by edit distance
+
+/**
+ * @brief Sorted list of book IDs containing one trigram.
+ */
+typedef struct {
+    uint64_t key;       // three 21-bit code points, 0 = empty slot
+    int32_t *ids;
+    int32_t count;
+    int32_t capacity;
+} Posting;
+
+typedef struct {
+    Posting *postings;      // open addressing on key
+    uint32_t posting_mask;
+    uint32_t posting_count;
+    char **docs;            // by book_id: "title\0author\0", normalized; NULL if absent
+    int doc_capacity;
+    int doc_count;
+    uint8_t *scores;        // search scratch, by book_id (overlap <= TRIGRAM_MAX_TEXT)
+    int32_t *touched;       // search scratch, book IDs with a non-zero score
+} TrigramIndex;
+
+static TrigramIndex *trigram_index = NULL;
+
+/**
+ * @brief Normalize text: lower-case ASCII, collapse punctuation and spaces.
+ * 
+ * The result is padded with one space on each side so that word starts
+ * and ends produce their own trigrams.
+ * 
+ * @return size_t Returns number of code points written (at least 1).
+ */
+static size_t normalize(const char *text, uint32_t *out, size_t max_count) {
+    size_t count = 0;
+    out[count++] = ' ';
+
+    while (text != NULL && *text && count < max_count - 1) {
+        uint32_t cp;
+        text += utf8_decode(text, &cp);
+
+        if (cp < 0x80) {
+            if (cp >= 'A' && cp <= 'Z') {
+                cp += 'a' - 'A';
+            } else if (!((cp >= 'a' && cp <= 'z') || (cp >= '0' && cp <= '9'))) {
+                cp = ' ';
+            }
+        } else if (cp == 0x3000 || cp == 0x00A0) {   // ideographic / no-break space
+            cp = ' ';
+        }
+
+        if (cp == ' ' && out[count - 1] == ' ') {
+            continue;
+        }
+        out[count++] = cp;
+    }
+
+    if (out[count - 1] != ' ') {
+        out[count++] = ' ';
+    }
+    return count;
+}
+
+static uint64_t trigram_key(const uint32_t *cp) {
+    return ((uint64_t)cp[0] << 42) | ((uint64_t)cp[1] << 21) | cp[2];
+}
+
+static int compare_keys(const void *lhs, const void *rhs) {
+    uint64_t a = *(const uint64_t *)lhs;
+    uint64_t b = *(const uint64_t *)rhs;
+    return (a > b) - (a < b);
+}
+
+/**
+ * @brief Append the trigrams of one normalized text to keys.
+ */
+static size_t add_trigrams(const uint32_t *cp, size_t length, uint64_t *keys, size_t count) {
+    for (size_t i = 0; i + 3 <= length; i++) {
+        keys[count++] = trigram_key(&cp[i]);
+    }
+    return count;
+}
+
+/**
+ * @brief Sort keys and drop duplicates.
+ * 
+ * @return size_t Returns number of distinct keys.
+ */
+static size_t unique_keys(uint64_t *keys, size_t count) {
+    if (count == 0) {
+        return 0;
+    }
+    qsort(keys, count, sizeof(uint64_t), compare_keys);
+    size_t unique = 1;
+    for (size_t i = 1; i < count; i++) {
+        if (keys[i] != keys[unique - 1]) {
+            keys[unique++] = keys[i];
+        }
+    }
+    return unique;
+}
+
+/**
+ * @brief Collect the distinct trigrams of a book's title and author.
+ * 
+ * @return size_t Returns number of distinct keys.
+ */
+static size_t book_trigrams(const char *title, const char *author, uint64_t *keys) {
+    uint32_t cp[TRIGRAM_MAX_TEXT + 2];
+    size_t count = 0;
+
+    size_t length = normalize(title, cp, TRIGRAM_MAX_TEXT + 2);
+    count = add_trigrams(cp, length, keys, count);
+    length = normalize(author, cp, TRIGRAM_MAX_TEXT + 2);
+    count = add_trigrams(cp, length, keys, count);
+
+    return unique_keys(keys, count);
+}
+
+/**
+ * @brief Encode normalized code points without the padding spaces.
+ */
+static size_t encode_normalized(const uint32_t *cp, size_t length, char *out) {
+    size_t used = 0;
+    for (size_t i = 1; i + 1 < length; i++) {
+        used += utf8_encode(cp[i], out + used);
+    }
+    out[used++] = '\0';
+    return used;
+}
+
+static uint32_t posting_slot(uint64_t key, uint32_t mask) {
+    return (uint32_t)((key * 0x9E3779B97F4A7C15ull) >> 32) & mask;
+}
+
+static Posting *find_posting(const TrigramIndex *index, uint64_t key) {
+    uint32_t pos = posting_slot(key, index->posting_mask);
+    while (index->postings[pos].key != 0) {
+        if (index->postings[pos].key == key) {
+            return &index->postings[pos];
+        }
+        pos = (pos + 1) & index->posting_mask;
+    }
+    return NULL;
+}
+
+static int grow_postings(TrigramIndex *index) {
+    uint32_t size = (index->posting_mask + 1) * 2;
+    Posting *postings = calloc(size, sizeof(Posting));
+    if (postings == NULL) {
+        return -1;
+    }
+
+    for (uint32_t i = 0; i <= index->posting_mask; i++) {
+        if (index->postings[i].key != 0) {
+            uint32_t pos = posting_slot(index->postings[i].key, size - 1);
+            while (postings[pos].key != 0) {
+                pos = (pos + 1) & (size - 1);
+            }
+            postings[pos] = index->postings[i];
+        }
+    }
+
+    free(index->postings);
+    index->postings = postings;
+    index->posting_mask = size - 1;
+    return 0;
+}
+
+/**
+ * @brief Insert book_id into the posting list of key, keeping it sorted.
+ */
+static int posting_add(TrigramIndex *index, uint64_t key, int book_id) {
+    Posting *posting = find_posting(index, key);
+
+    if (posting == NULL) {
+        if ((index->posting_count + 1) * 2 > index->posting_mask + 1 && grow_postings(index) != 0) {
+            return -1;
+        }
+        uint32_t pos = posting_slot(key, index->posting_mask);
+        while (index->postings[pos].key != 0) {
+            pos = (pos + 1) & index->posting_mask;
+        }
+        posting = &index->postings[pos];
+        posting->key = key;
+        index->posting_count++;
+    }
+
+    if (posting->count == posting->capacity) {
+        int capacity = posting->capacity ? posting->capacity * 2 : 4;
+        int32_t *ids = realloc(posting->ids, capacity * sizeof(int32_t));
+        if (ids == NULL) {
+            return -1;
+        }
+        posting->ids = ids;
+        posting->capacity = capacity;
+    }
+
+    /* Books are mostly added in ID order, so this is usually an append */
+    int pos = posting->count;
+    while (pos > 0 && posting->ids[pos - 1] > book_id) {
+        pos--;
+    }
+    memmove(&posting->ids[pos + 1], &posting->ids[pos], (posting->count - pos) * sizeof(int32_t));
+    posting->ids[pos] = book_id;
+    posting->count++;
+    return 0;
+}
+
+static void posting_remove(TrigramIndex *index, uint64_t key, int book_id) {
+    Posting *posting = find_posting(index, key);
+    if (posting == NULL) {
+        return;
+    }
+
+    int lo = 0, hi = posting->count;
+    while (lo < hi) {
+        int mid = lo + (hi - lo) / 2;
+        if (posting->ids[mid] < book_id) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    if (lo < posting->count && posting->ids[lo] == book_id) {
+        memmove(&posting->ids[lo], &posting->ids[lo + 1], (posting->count - lo - 1) * sizeof(int32_t));
+        posting->count--;
+    }
+}
+
+static int grow_docs(TrigramIndex *index, int book_id) {
+    int capacity = index->doc_capacity ? index->doc_capacity : 1024;
+    while (capacity <= book_id) {
+        capacity *= 2;
+    }
+
+    char **docs = realloc(index->docs, capacity * sizeof(char *));
+    if (docs == NULL) {
+        return -1;
+    }
+    index->docs = docs;
+    memset(&docs[index->doc_capacity], 0, (capacity - index->doc_capacity) * sizeof(char *));
+
+    uint8_t *scores = realloc(index->scores, capacity * sizeof(uint8_t));
+    if (scores == NULL) {
+        return -1;
+    }
+    index->scores = scores;
+    memset(&scores[index->doc_capacity], 0, (capacity - index->doc_capacity) * sizeof(uint8_t));
+
+    int32_t *touched = realloc(index->touched, capacity * sizeof(int32_t));
+    if (touched == NULL) {
+        return -1;
+    }
+    index->touched = touched;
+    index->doc_capacity = capacity;
+    return 0;
+}
+
+static void remove_doc(TrigramIndex *index, int book_id) {
+    if (book_id < 0 || book_id >= index->doc_capacity || index->docs[book_id] == NULL) {
+        return;
+    }
+
+    const char *title = index->docs[book_id];
+    const char *author = title + strlen(title) + 1;
+    uint64_t keys[MAX_DOC_TRIGRAMS];
+    size_t count = book_trigrams(title, author, keys);
+    for (size_t i = 0; i < count; i++) {
+        posting_remove(index, keys[i], book_id);
+    }
+
+    free(index->docs[book_id]);
+    index->docs[book_id] = NULL;
+    index->doc_count--;
+}
+
+static int add_doc(TrigramIndex *index, int book_id, const char *title, const char *author) {
+    if (book_id <= 0) {
+        return -1;
+    }
+    if (book_id >= index->doc_capacity && grow_docs(index, book_id) != 0) {
+        return -1;
+    }
+    remove_doc(index, book_id);
+
+    /* Keep the normalized text for removal and edit distance */
+    uint32_t cp[TRIGRAM_MAX_TEXT + 2];
+    char text[2 * 4 * (TRIGRAM_MAX_TEXT + 2)];
+    size_t used = encode_normalized(cp, normalize(title, cp, TRIGRAM_MAX_TEXT + 2), text);
+    used += encode_normalized(cp, normalize(author, cp, TRIGRAM_MAX_TEXT + 2), text + used);
+
+    char *doc = malloc(used);
+    if (doc == NULL) {
+        return -1;
+    }
+    memcpy(doc, text, used);
+    index->docs[book_id] = doc;
+    index->doc_count++;
+
+    uint64_t keys[MAX_DOC_TRIGRAMS];
+    size_t count = book_trigrams(title, author, keys);
+    for (size_t i = 0; i < count; i++) {
+        if (posting_add(index, keys[i], book_id) != 0) {
+            return -1;
+        }
+    }
+    return 0;
+}
+
+static void destroy_index(TrigramIndex *index) {
+    if (index == NULL) {
+        return;
+    }
+    for (uint32_t i = 0; i <= index->posting_mask && index->postings != NULL; i++) {
+        free(index->postings[i].ids);
+    }
+    for (int i = 0; i < index->doc_capacity; i++) {
+        free(index->docs[i]);
+    }
+    free(index->postings);
+    free(index->docs);
+    free(index->scores);
+    free(index->touched);
+    free(index);
+}
+
+int load_trigram_index(sqlite3 *db) {
+    if (db == NULL) {
+        fprintf(stderr, "Database connection is NULL\n");
+        return -1;
+    }
+
+    TrigramIndex *index = calloc(1, sizeof(TrigramIndex));
+    if (index == NULL) {
+        return -1;
+    }
+    index->posting_mask = 4096 - 1;
+    index->postings = calloc(index->posting_mask + 1, sizeof(Posting));
+    if (index->postings == NULL) {
+        destroy_index(index);
+        return -1;
+    }
+
+    const char *sql = "SELECT book_id, title, author FROM Books ORDER BY book_id;";
+    sqlite3_stmt *stmt;
+    if (sqlite3_prepare_v2(db, sql, -1, &stmt, NULL) != SQLITE_OK) {
+        fprintf(stderr, "Failed to prepare statement: %s\n", sqlite3_errmsg(db));
+        destroy_index(index);
+        return -1;
+    }
+
+    int rc;
+    int failed = 0;
+    while ((rc = sqlite3_step(stmt)) == SQLITE_ROW) {
+        if (add_doc(index, sqlite3_column_int(stmt, 0),
+                    (const char *)sqlite3_column_text(stmt, 1),
+                    (const char *)sqlite3_column_text(stmt, 2)) != 0) {
+            failed = 1;
+            break;
+        }
+    }
+    sqlite3_finalize(stmt);
+
+    if (failed || rc != SQLITE_DONE) {
+        fprintf(stderr, "Failed to build trigram index\n");
+        destroy_index(index);
+        return -1;
+    }
+
+    destroy_index(trigram_index);
+    trigram_index = index;
+    return index->doc_count;
+}
+
+void free_trigram_index(void) {
+    destroy_index(trigram_index);
+    trigram_index = NULL;
+}
+
+int trigram_refresh_book(sqlite3 *db, int book_id) {
+    if (trigram_index == NULL) {
+        return 0;
+    }
+
+    const char *sql = "SELECT title, author FROM Books WHERE book_id = ?;";
+    sqlite3_stmt *stmt;
+    if (sqlite3_prepare_v2(db, sql, -1, &stmt, NULL) != SQLITE_OK) {
+        fprintf(stderr, "Failed to prepare statement: %s\n", sqlite3_errmsg(db));
+        return -1;
+    }
+    sqlite3_bind_int(stmt, 1, book_id);
+
+    int result = 0;
+    int rc = sqlite3_step(stmt);
+    if (rc == SQLITE_ROW) {
+        result = add_doc(trigram_index, book_id,
+                         (const char *)sqlite3_column_text(stmt, 0),
+                         (const char *)sqlite3_column_text(stmt, 1));
+    } else if (rc == SQLITE_DONE) {
+        remove_doc(trigram_index, book_id);
+    } else {
+        result = -1;
+    }
+    sqlite3_finalize(stmt);
+
+    if (result != 0) {
+        /* A half-updated index would return wrong hits; rebuild on next search */
+        free_trigram_index();
+    }
+    return result;
+}
+
+void trigram_remove_book(int book_id) {
+    if (trigram_index != NULL) {
+        remove_doc(trigram_index, book_id);
+    }
+}
+
+/**
+ * @brief Levenshtein distance between two code point strings.
+ */
+static int edit_distance(const uint32_t *a, size_t a_len, const uint32_t *b, size_t b_len) {
+    int row[TRIGRAM_MAX_TEXT + 1];
+    for (size_t j = 0; j <= b_len; j++) {
+        row[j] = (int)j;
+    }
+    for (size_t i = 1; i <= a_len; i++) {
+        int diagonal = row[0];
+        row[0] = (int)i;
+        for (size_t j = 1; j <= b_len; j++) {
+            int above = row[j];
+            int cost = a[i - 1] == b[j - 1] ? 0 : 1;
+            int best = diagonal + cost;
+            if (above + 1 < best) {
+                best = above + 1;
+            }
+            if (row[j - 1] + 1 < best) {
+                best = row[j - 1] + 1;
+            }
+            row[j] = best;
+            diagonal = above;
+        }
+    }
+    return row[b_len];
+}
+
+/**
+ * @brief Edit distance from the query to the closer of a book's title and author.
+ */
+static int doc_distance(const char *doc, const uint32_t *query, size_t query_len) {
+    uint32_t cp[TRIGRAM_MAX_TEXT];
+    size_t length = utf8_to_codepoints(doc, cp, TRIGRAM_MAX_TEXT);
+    int best = edit_distance(query, query_len, cp, length);
+
+    const char *author = doc + strlen(doc) + 1;
+    if (*author) {
+        length = utf8_to_codepoints(author, cp, TRIGRAM_MAX_TEXT);
+        int distance = edit_distance(query, query_len, cp, length);
+        if (distance < best) {
+            best = distance;
+        }
+    }
+    return best;
+}
+
+static int compare_matches(const void *lhs, const void *rhs) {
+    const FuzzyMatch *a = lhs;
+    const FuzzyMatch *b = rhs;
+    if (a->overlap != b->overlap) {
+        return b->overlap - a->overlap;
+    }
+    if (a->distance != b->distance) {
+        return a->distance - b->distance;
+    }
+    return a->book_id - b->book_id;
+}
+
+int fuzzy_search_books(const char *query, FuzzyMatch *results, int max_count) {
+    if (query == NULL || results == NULL || max_count <= 0) {
+        fprintf(stderr, "Invalid parameters\n");
+        return -1;
+    }
+    if (trigram_index == NULL && load_trigram_index(get_db_connection()) < 0) {
+        return -1;
+    }
+    TrigramIndex *index = trigram_index;
+
+    uint32_t cp[TRIGRAM_MAX_TEXT + 2];
+    size_t length = normalize(query, cp, TRIGRAM_MAX_TEXT + 2);
+    uint64_t keys[TRIGRAM_MAX_TEXT];
+    size_t key_count = unique_keys(keys, add_trigrams(cp, length, keys, 0));
+    if (key_count == 0) {
+        return 0;
+    }
+
+    /* Count shared trigrams per book by walking the query's posting lists */
+    int touched = 0;
+    int histogram[TRIGRAM_MAX_TEXT + 1] = {0};
+    for (size_t k = 0; k < key_count; k++) {
+        const Posting *posting = find_posting(index, keys[k]);
+        if (posting == NULL) {
+            continue;
+        }
+        for (int i = 0; i < posting->count; i++) {
+            int book_id = posting->ids[i];
+            if (index->scores[book_id]++ == 0) {
+                index->touched[touched++] = book_id;
+            }
+        }
+    }
+
+    /* Require a third of the query's trigrams, so one typo per word still matches */
+    int min_overlap = (int)key_count / 3;
+    if (min_overlap < 1) {
+        min_overlap = 1;
+    }
+    for (int i = 0; i < touched; i++) {
+        histogram[index->scores[index->touched[i]]]++;
+    }
+
+    /* Only the strongest candidates are re-ranked by edit distance */
+    int limit = max_count * 4 > MIN_CANDIDATES ? max_count * 4 : MIN_CANDIDATES;
+    int cutoff = (int)key_count;
+    int kept = histogram[cutoff];
+    while (cutoff > min_overlap && kept + histogram[cutoff - 1] <= limit) {
+        cutoff--;
+        kept += histogram[cutoff];
+    }
+    /* Fill the remaining room from the next level down instead of dropping it */
+    int partial_level = cutoff - 1;
+    int partial_left = partial_level >= min_overlap && kept < limit ? limit - kept : 0;
+
+    FuzzyMatch *candidates = malloc((limit + histogram[cutoff] + 1) * sizeof(FuzzyMatch));
+    int candidate_count = 0;
+    for (int i = 0; i < touched; i++) {
+        int book_id = index->touched[i];
+        int overlap = index->scores[book_id];
+        index->scores[book_id] = 0;
+        if (candidates == NULL || overlap < partial_level) {
+            continue;
+        }
+        if (overlap >= cutoff || (overlap == partial_level && partial_left-- > 0)) {
+            candidates[candidate_count].book_id = book_id;
+            candidates[candidate_count].overlap = overlap;
+            candidate_count++;
+        }
+    }
+    if (candidates == NULL) {
+        return -1;
+    }
+
+    /* Distance is measured against the query without its padding spaces */
+    const uint32_t *query_cp = cp + 1;
+    size_t query_len = length >= 2 ? length - 2 : 0;
+    for (int i = 0; i < candidate_count; i++) {
+        candidates[i].distance = doc_distance(index->docs[candidates[i].book_id], query_cp, query_len);
+    }
+    qsort(candidates, candidate_count, sizeof(FuzzyMatch), compare_matches);
+
+    int count = candidate_count < max_count ? candidate_count : max_count;
+    memcpy(results, candidates, count * sizeof(FuzzyMatch));
+    free(candidates);
+    return count;
+}
@@ -0,0 +1,112 @@
+#include "utf8.h"
+
+int utf8_decode(const char *s, uint32_t *cp) {
+    const unsigned char *p = (const unsigned char *)s;
+    uint32_t c = p[0];
+    int length;
+    uint32_t min;
+
+    if (c < 0x80) {
+        *cp = c;
+        return 1;
+    } else if ((c & 0xE0) == 0xC0) {
+        length = 2;
+        min = 0x80;
+        c &= 0x1F;
+    } else if ((c & 0xF0) == 0xE0) {
+        length = 3;
+        min = 0x800;
+        c &= 0x0F;
+    } else if ((c & 0xF8) == 0xF0) {
+        length = 4;
+        min = 0x10000;
+        c &= 0x07;
+    } else {
+        *cp = UTF8_REPLACEMENT;
+        return 1;
+    }
+
+    for (int i = 1; i < length; i++) {
+        if ((p[i] & 0xC0) != 0x80) {   // also stops at the terminating NUL
+            *cp = UTF8_REPLACEMENT;
+            return 1;
+        }
+        c = (c << 6) | (p[i] & 0x3F);
+    }
+
+    /* Reject overlong forms, surrogates and values past U+10FFFF */
+    if (c < min || c > 0x10FFFF || (c >= 0xD800 && c <= 0xDFFF)) {
+        *cp = UTF8_REPLACEMENT;
+        return 1;
+    }
+
+    *cp = c;
+    return length;
+}
+
+int utf8_encode(uint32_t cp, char *out) {
+    if (cp < 0x80) {
+        out[0] = (char)cp;
+        return 1;
+    }
+    if (cp < 0x800) {
+        out[0] = (char)(0xC0 | (cp >> 6));
+        out[1] = (char)(0x80 | (cp & 0x3F));
+        return 2;
+    }
+    if (cp < 0x10000) {
+        out[0] = (char)(0xE0 | (cp >> 12));
+        out[1] = (char)(0x80 | ((cp >> 6) & 0x3F));
+        out[2] = (char)(0x80 | (cp & 0x3F));
+        return 3;
+    }
+    out[0] = (char)(0xF0 | (cp >> 18));
+    out[1] = (char)(0x80 | ((cp >> 12) & 0x3F));
+    out[2] = (char)(0x80 | ((cp >> 6) & 0x3F));
+    out[3] = (char)(0x80 | (cp & 0x3F));
+    return 4;
+}
+
+size_t utf8_to_codepoints(const char *s, uint32_t *out, size_t max_count) {
+    size_t count = 0;
+    while (*s && count < max_count) {
+        s += utf8_decode(s, &out[count++]);
+    }
+    return count;
+}
+
+int utf8_char_width(uint32_t cp) {
+    /* Zero width: combining marks, Hangul medial/final jamo, zero-width spaces and joiners, variation selectors */
+    if ((cp >= 0x0300 && cp <= 0x036F) || (cp >= 0x1160 && cp <= 0x11FF) ||
+        (cp >= 0x200B && cp <= 0x200F) || (cp >= 0xFE00 && cp <= 0xFE0F)) {
+        return 0;
+    }
+    if (cp < 0x1100) {
+        return 1;
+    }
+
+    /* East Asian Wide and Fullwidth ranges */
+    if (cp <= 0x115F ||                                   // Hangul initial jamo
+        (cp >= 0x2E80 && cp <= 0xA4CF && cp != 0x303F) || // CJK radicals through Yi
+        (cp >= 0xAC00 && cp <= 0xD7A3) ||                 // Hangul syllables
+        (cp >= 0xF900 && cp <= 0xFAFF) ||                 // CJK compatibility ideographs
+        (cp >= 0xFE30 && cp <= 0xFE4F) ||                 // CJK compatibility forms
+        (cp >= 0xFF00 && cp <= 0xFF60) ||                 // fullwidth forms
+        (cp >= 0xFFE0 && cp <= 0xFFE6) ||
+        (cp >= 0x1F300 && cp <= 0x1F64F) ||               // pictographs and emoticons
+        (cp >= 0x1F900 && cp <= 0x1F9FF) ||
+        (cp >= 0x20000 && cp <= 0x3FFFD)) {               // CJK extension planes
+        return 2;
+    }
+    return 1;
+}
+
+size_t utf8_display_width(const char *s) {
+    size_t width = 0;
+    uint32_t cp;
+    while (*s) {
+        s += utf8_decode(s, &cp);
+        width += (size_t)utf8_char_width(cp);
+    }
+    return width;
+}
@@ -0,0 +1,141 @@
+/**
+ * @file template_db.hpp
+ * @brief Test databases cloned from a template built once per process
+ * 
+ * Building the schema (and any seed data) for every test costs far more
+ * than the test itself once datasets grow. A TemplateDatabase runs its
+ * builder once on a scratch in-memory connection and keeps the
+ * serialized image; each test then gets its own in-memory connection
+ * deserialized from a copy of that image, so tests stay isolated and
+ * setup is a memcpy.
+ * 
+ * Usage:
+ * 
+ *     static int seed_books(sqlite3* db) { ... return 0; }
+ *     class MyTest : public ClonedDatabaseTest<seed_books> {};
+ */
+
+#ifndef TEMPLATE_DB_HPP
+#define TEMPLATE_DB_HPP
+
+#include <gtest/gtest.h>
+#include <sqlite3.h>
+#include <cstdio>
+#include <cstring>
+
+extern "C" {
+    #include "../include/database.h"
+}
+
+class TemplateDatabase {
+public:
+    // Fills the template; the library's global connection points at db meanwhile
+    using Builder = int (*)(sqlite3* db);
+
+    explicit TemplateDatabase(Builder build) {
+        sqlite3* db = nullptr;
+        if (sqlite3_open(":memory:", &db) != SQLITE_OK) {
+            fprintf(stderr, "Cannot open template database\n");
+            sqlite3_close(db);
+            return;
+        }
+
+        sqlite3* saved_db = get_db_connection();
+        int saved_quiet = is_quiet_mode();
+        set_db_connection(db);
+        set_quiet_mode(1);
+        int rc = build(db);
+        set_quiet_mode(saved_quiet);
+        set_db_connection(saved_db);
+
+        if (rc != 0) {
+            fprintf(stderr, "Failed to build template database\n");
+        } else {
+            image_ = sqlite3_serialize(db, "main", &size_, 0);
+        }
+        sqlite3_close(db);
+    }
+
+    ~TemplateDatabase() {
+        sqlite3_free(image_);
+    }
+
+    TemplateDatabase(const TemplateDatabase&) = delete;
+    TemplateDatabase& operator=(const TemplateDatabase&) = delete;
+
+    // Open a new in-memory connection holding a private copy of the template
+    sqlite3* clone() const {
+        if (image_ == nullptr) {
+            return nullptr;
+        }
+
+        sqlite3* db = nullptr;
+        if (sqlite3_open(":memory:", &db) != SQLITE_OK) {
+            sqlite3_close(db);
+            return nullptr;
+        }
+        unsigned char* copy = static_cast<unsigned char*>(sqlite3_malloc64(size_));
+        if (copy == nullptr) {
+            sqlite3_close(db);
+            return nullptr;
+        }
+        memcpy(copy, image_, size_);
+        // FREEONCLOSE hands the copy to SQLite, even if deserializing fails
+        if (sqlite3_deserialize(db, "main", copy, size_, size_,
+                                SQLITE_DESERIALIZE_FREEONCLOSE | SQLITE_DESERIALIZE_RESIZEABLE) != SQLITE_OK) {
+            sqlite3_close(db);
+            return nullptr;
+        }
+        return db;
+    }
+
+    sqlite3_int64 size() const {
+        return size_;
+    }
+
+    // Default builder: the full library schema, no rows
+    static int library_schema(sqlite3*) {
+        if (create_tables() != 0 || migrate_schema() != 0 || create_indexes() != 0) {
+            return -1;
+        }
+        return 0;
+    }
+
+private:
+    unsigned char* image_ = nullptr;
+    sqlite3_int64 size_ = 0;
+};
+
+// Test fixture giving every test its own clone of a per-builder template
+template <TemplateDatabase::Builder Build = TemplateDatabase::library_schema>
+class ClonedDatabaseTest : public ::testing::Test {
+protected:
+    sqlite3* test_db = nullptr;
+    sqlite3* saved_db = nullptr;
+
+    // Built on first use, once per process for each builder
+    static const TemplateDatabase& template_database() {
+        static const TemplateDatabase database(Build);
+        return database;
+    }
+
+    // Setup: Clone the template and make it the library's connection
+    void SetUp() override {
+        saved_db = get_db_connection();
+        test_db = template_database().clone();
+        ASSERT_NE(test_db, nullptr) << "Failed to clone the template database";
+        set_db_connection(test_db);
+    }
+
+    // Teardown: Restore the previous connection and drop the clone
+    void TearDown() override {
+        set_db_connection(saved_db);
+
+        if (test_db) {
+            sqlite3_close(test_db);
+            test_db = nullptr;
+        }
+    }
+};
+
+#endif // TEMPLATE_DB_HPP
@@ -0,0 +1,359 @@
+/**
+ * @file test_analytics_gtest.cpp
+ * @brief Google Test based unit tests for the analytics column store
+ * 
+ * Covers day-number date conversion, the group-by/top-K aggregates
+ * checked against SQL, member statistics, incremental refresh and
+ * multi-threaded runs.
+ */
+
+#include <gtest/gtest.h>
+#include <sqlite3.h>
+#include <string>
+
+extern "C" {
+    #include "../include/database.h"
+    #include "../include/book.h"
+    #include "../include/member.h"
+    #include "../include/loan.h"
+    #include "../include/analytics.h"
+    #include "../include/date_utils.h"
+    #include "../include/copy.h"
+    #include "../include/book_table.h"
+}
+
+// Helper function to convert a date, failing the test if it is invalid
+static int day_of(const char* date) {
+    int day = 0;
+    EXPECT_EQ(date_to_day(date, &day), 0) << date;
+    return day;
+}
+
+// ============================================================================
+// Test Suite 1: day numbers
+// ============================================================================
+
+TEST(DateUtilsTest, KnownDays) {
+    EXPECT_EQ(day_of("1970-01-01"), 0);
+    EXPECT_EQ(day_of("1969-12-31"), -1);
+    EXPECT_EQ(day_of("2000-03-01"), 11017);
+    EXPECT_EQ(day_of("2024-03-01") - day_of("2024-02-28"), 2) << "Leap year";
+    EXPECT_EQ(day_of("2023-03-01") - day_of("2023-02-28"), 1);
+    EXPECT_EQ(day_of("2024-05-10 13:45:00"), day_of("2024-05-10")) << "Time part is ignored";
+}
+
+TEST(DateUtilsTest, RejectsInvalidDates) {
+    int day;
+    EXPECT_EQ(date_to_day("2023-02-29", &day), -1);
+    EXPECT_EQ(date_to_day("2024-13-01", &day), -1);
+    EXPECT_EQ(date_to_day("2024-04-31", &day), -1);
+    EXPECT_EQ(date_to_day("2024-1-01", &day), -1);
+    EXPECT_EQ(date_to_day("20240101", &day), -1);
+    EXPECT_EQ(date_to_day("2024-01-01x", &day), -1);
+    EXPECT_EQ(date_to_day(nullptr, &day), -1);
+}
+
+TEST(DateUtilsTest, RoundTrip) {
+    char date[16];
+    for (int day = -800; day < 40000; day += 37) {
+        day_to_date(day, date, sizeof(date));
+        EXPECT_EQ(day_of(date), day) << date;
+    }
+    day_to_date(day_of("2024-02-29"), date, sizeof(date));
+    EXPECT_STREQ(date, "2024-02-29");
+}
+
+// ============================================================================
+// Test Suite 2: aggregates
+// ============================================================================
+
+// Test fixture class for the column store
+class AnalyticsTest : public ::testing::Test {
+protected:
+    sqlite3* test_db;
+    sqlite3* saved_db;
+
+    // Setup: Create in-memory database with the full schema before each test
+    void SetUp() override {
+        test_db = nullptr;
+        saved_db = get_db_connection();
+
+        int rc = sqlite3_open(":memory:", &test_db);
+        ASSERT_EQ(rc, SQLITE_OK) << "Failed to open in-memory database";
+
+        set_db_connection(test_db);
+        ASSERT_EQ(create_tables(), 0);
+        ASSERT_EQ(migrate_schema(), 0);
+        ASSERT_EQ(create_indexes(), 0);
+
+        ASSERT_EQ(add_book("Dune", "Herbert", "", 1965, "B1", "SF", 10), 0);
+        ASSERT_EQ(add_book("Foundation", "Asimov", "", 1951, "B2", "SF", 10), 0);
+        ASSERT_EQ(add_book("토지", "박경리", "", 1994, "B3", "소설", 10), 0);
+        ASSERT_EQ(add_book("Emma", "Austen", "", 1815, "B4", "Classic", 10), 0);
+        for (int i = 0; i < 4; i++) {
+            ASSERT_GT(add_member(test_db, ("Member " + std::to_string(i)).c_str(), "", ""), 0);
+        }
+
+        /* book, member, loan date, due date, returned */
+        insert_loan(1, 1, "2024-01-01", "2024-01-15", 1);
+        insert_loan(1, 2, "2024-01-10", "2024-01-24", 0);
+        insert_loan(1, 3, "2024-02-01", "2024-02-15", 0);
+        insert_loan(2, 1, "2024-02-01", "2024-02-15", 0);
+        insert_loan(2, 2, "2024-02-20", "2024-03-05", 1);
+        insert_loan(3, 1, "2024-02-25", "2024-03-10", 0);
+    }
+
+    // Teardown: Close database after each test
+    void TearDown() override {
+        free_analytics();
+        set_db_connection(saved_db);
+
+        if (test_db) {
+            sqlite3_close(test_db);
+            test_db = nullptr;
+        }
+    }
+
+    void insert_loan(int book_id, int member_id, const char* loan_date, const char* due_date, int returned) {
+        sqlite3_stmt* stmt;
+        ASSERT_EQ(sqlite3_prepare_v2(test_db, "INSERT INTO Loans (book_id, member_id, loan_date, due_date, "
+                                     "is_returned) VALUES (?, ?, ?, ?, ?);", -1, &stmt, nullptr), SQLITE_OK);
+        sqlite3_bind_int(stmt, 1, book_id);
+        sqlite3_bind_int(stmt, 2, member_id);
+        sqlite3_bind_text(stmt, 3, loan_date, -1, SQLITE_STATIC);
+        sqlite3_bind_text(stmt, 4, due_date, -1, SQLITE_STATIC);
+        sqlite3_bind_int(stmt, 5, returned);
+        ASSERT_EQ(sqlite3_step(stmt), SQLITE_DONE);
+        sqlite3_finalize(stmt);
+    }
+};
+
+TEST_F(AnalyticsTest, TopBooks) {
+    ASSERT_EQ(refresh_analytics(test_db, 1), 6);
+
+    AnalyticsCount top[10];
+    ASSERT_EQ(analytics_top_books(top, 10), 3) << "Books without loans are left out";
+    EXPECT_EQ(top[0].id, 1);
+    EXPECT_EQ(top[0].count, 3);
+    EXPECT_EQ(top[1].id, 2);
+    EXPECT_EQ(top[2].id, 3);
+    EXPECT_STREQ(analytics_book_title(3), "토지");
+
+    ASSERT_EQ(analytics_top_books(top, 1), 1);
+    EXPECT_EQ(top[0].id, 1);
+}
+
+TEST_F(AnalyticsTest, GenreCounts) {
+    ASSERT_EQ(refresh_analytics(test_db, 1), 6);
+
+    AnalyticsCount genres[10];
+    ASSERT_EQ(analytics_genre_counts(genres, 10), 2);
+    EXPECT_STREQ(analytics_genre_name(genres[0].id), "SF");
+    EXPECT_EQ(genres[0].count, 5);
+    EXPECT_STREQ(analytics_genre_name(genres[1].id), "소설");
+    EXPECT_EQ(genres[1].count, 1);
+}
+
+TEST_F(AnalyticsTest, LoanSummary) {
+    ASSERT_EQ(refresh_analytics(test_db, 1), 6);
+
+    LoanSummary summary;
+    ASSERT_EQ(analytics_loan_summary(day_of("2024-03-01"), &summary), 0);
+    EXPECT_EQ(summary.total_loans, 6);
+    EXPECT_EQ(summary.active_loans, 4);
+    EXPECT_EQ(summary.active_members, 3);
+    EXPECT_EQ(summary.overdue_loans, 3) << "Due 01-24, 02-15, 02-15";
+    EXPECT_EQ(summary.overdue_members, 3);
+    EXPECT_EQ(summary.overdue_days, 37 + 15 + 15);
+    EXPECT_EQ(summary.max_overdue_days, 37);
+}
+
+TEST_F(AnalyticsTest, NotLoaded) {
+    AnalyticsCount top[1];
+    LoanSummary summary;
+    EXPECT_EQ(analytics_top_books(top, 1), -1);
+    EXPECT_EQ(analytics_loan_summary(0, &summary), -1);
+    EXPECT_EQ(analytics_genre_name(0), nullptr);
+}
+
+TEST_F(AnalyticsTest, IncrementalRefresh) {
+    ASSERT_EQ(refresh_analytics(test_db, 1), 6);
+    EXPECT_EQ(refresh_analytics(test_db, 1), 0);
+
+    ASSERT_EQ(add_book("Persuasion", "Austen", "", 1817, "B5", "Classic", 10), 0);
+    insert_loan(5, 4, "2024-02-28", "2024-03-13", 0);
+    insert_loan(5, 3, "2024-02-28", "2024-03-13", 0);
+    ASSERT_GT(process_return(test_db, 2), 0);
+
+    ASSERT_EQ(refresh_analytics(test_db, 1), 2);
+
+    AnalyticsCount genres[10];
+    ASSERT_EQ(analytics_genre_counts(genres, 10), 3);
+    EXPECT_STREQ(analytics_genre_name(genres[1].id), "Classic") << "Genre of a book added after the first load";
+    EXPECT_EQ(genres[1].count, 2);
+
+    LoanSummary summary;
+    ASSERT_EQ(analytics_loan_summary(day_of("2024-03-01"), &summary), 0);
+    EXPECT_EQ(summary.total_loans, 8);
+    EXPECT_EQ(summary.active_loans, 5) << "Loan 2 was returned";
+    EXPECT_EQ(summary.overdue_loans, 2);
+    EXPECT_EQ(summary.active_members, 3) << "Member 2 has nothing left on loan";
+}
+
+TEST_F(AnalyticsTest, MemberSummary) {
+    ASSERT_EQ(sqlite3_exec(test_db,
+                           "UPDATE Members SET registration_date = '2023-06-01';"
+                           "UPDATE Members SET registration_date = '2024-02-20' WHERE member_id <= 2;"
+                           "UPDATE Members SET suspended_until = date_to_day('2024-03-05') WHERE member_id = 4;",
+                           nullptr, nullptr, nullptr), SQLITE_OK);
+    ASSERT_EQ(refresh_analytics(test_db, 1), 6);
+
+    MemberSummary summary;
+    ASSERT_EQ(analytics_member_summary(day_of("2024-03-01"), &summary), 0);
+    EXPECT_EQ(summary.total_members, 4);
+    EXPECT_EQ(summary.new_members, 2);
+    EXPECT_EQ(summary.suspended_members, 1);
+    EXPECT_EQ(summary.active_members, 3);
+    EXPECT_EQ(summary.overdue_members, 3);
+
+    // A new member and an overdue return are folded in without a reload
+    ASSERT_EQ(add_member(test_db, "Member 4", "", ""), 5);
+    ASSERT_GT(process_return(test_db, 2), 0);
+    ASSERT_EQ(refresh_analytics(test_db, 1), 0);
+
+    ASSERT_EQ(analytics_member_summary(day_of("2024-03-01"), &summary), 0);
+    EXPECT_EQ(summary.total_members, 5);
+    EXPECT_EQ(summary.suspended_members, 2) << "Member 2 returned loan 2 long past its due date";
+    EXPECT_EQ(summary.active_members, 2);
+
+    // The suspensions match the penalty ledger
+    int today = get_today_day();
+    sqlite3_stmt* stmt;
+    ASSERT_EQ(sqlite3_prepare_v2(test_db, "SELECT COUNT(*) FROM Members WHERE suspended_until > ?;",
+                                 -1, &stmt, nullptr), SQLITE_OK);
+    sqlite3_bind_int(stmt, 1, today);
+    ASSERT_EQ(sqlite3_step(stmt), SQLITE_ROW);
+    ASSERT_EQ(analytics_member_summary(today, &summary), 0);
+    EXPECT_EQ(summary.suspended_members, sqlite3_column_int(stmt, 0));
+    EXPECT_EQ(summary.new_members, 1) << "Member 5 registered today";
+    sqlite3_finalize(stmt);
+}
+
+TEST_F(AnalyticsTest, InventorySummary) {
+    ASSERT_EQ(sqlite3_exec(test_db, "UPDATE Books SET quantity = 2 WHERE book_id = 1;", nullptr, nullptr, nullptr),
+              SQLITE_OK);
+    ASSERT_EQ(refresh_analytics(test_db, 1), 6);
+
+    InventorySummary summary;
+    ASSERT_EQ(analytics_inventory_summary(&summary), 0);
+    EXPECT_EQ(summary.titles, 4);
+    EXPECT_EQ(summary.copies, 32);
+    EXPECT_EQ(summary.on_loan, 4);
+    EXPECT_EQ(summary.out_of_stock, 1) << "Both copies of book 1 are lent";
+
+    ASSERT_GT(process_return(test_db, 2), 0);
+    ASSERT_EQ(refresh_analytics(test_db, 1), 0);
+    ASSERT_EQ(analytics_inventory_summary(&summary), 0);
+    EXPECT_EQ(summary.on_loan, 3);
+    EXPECT_EQ(summary.out_of_stock, 0);
+}
+
+TEST_F(AnalyticsTest, RefreshPicksUpEditsAndDeletions) {
+    ASSERT_EQ(refresh_analytics(test_db, 1), 6);
+
+    ASSERT_EQ(delete_book(4), 0);
+    ASSERT_EQ(delete_member(test_db, 4), 0);
+    ASSERT_EQ(update_book(3, NULL, NULL, NULL, 0, "SF"), 0);
+    ASSERT_EQ(sqlite3_exec(test_db, "UPDATE Books SET quantity = 2 WHERE book_id = 1;", nullptr, nullptr, nullptr),
+              SQLITE_OK);
+    ASSERT_EQ(refresh_analytics(test_db, 1), 0);
+
+    InventorySummary inventory;
+    ASSERT_EQ(analytics_inventory_summary(&inventory), 0);
+    EXPECT_EQ(inventory.titles, 3);
+    EXPECT_EQ(inventory.copies, 22);
+    EXPECT_EQ(inventory.out_of_stock, 1);
+    EXPECT_EQ(analytics_book_title(4), nullptr);
+
+    AnalyticsCount genres[10];
+    ASSERT_EQ(analytics_genre_counts(genres, 10), 1) << "Book 3 moved to SF";
+    EXPECT_STREQ(analytics_genre_name(genres[0].id), "SF");
+    EXPECT_EQ(genres[0].count, 6);
+
+    MemberSummary members;
+    ASSERT_EQ(analytics_member_summary(day_of("2024-03-01"), &members), 0);
+    EXPECT_EQ(members.total_members, 3);
+}
+
+TEST_F(AnalyticsTest, SurvivesBarcodeAndTitleLoansOfOneBook) {
+    ASSERT_EQ(add_book("Persuasion", "Austen", "", 1817, "B5", "Classic", 1), 0);
+    ASSERT_GT(add_copy(test_db, 5, "BC5"), 0);
+    ASSERT_GT(process_loan(test_db, 5, 4, 14), 0);
+    EXPECT_EQ(loan_by_barcode(test_db, "BC5", 3, 14), -1) << "The only copy is already lent";
+    free_copy_index();
+
+    // No book ends up with a negative available count, which the column store rejects
+    BookTable table;
+    ASSERT_EQ(book_table_init(&table), 0);
+    EXPECT_EQ(load_book_table(test_db, &table), 5);
+    book_table_free(&table);
+    ASSERT_EQ(refresh_analytics(test_db, 1), 7);
+
+    AnalyticsCount top[10];
+    ASSERT_EQ(analytics_top_books(top, 10), 4);
+}
+
+TEST_F(AnalyticsTest, ThreadsMatchSql) {
+    ASSERT_EQ(sqlite3_exec(test_db,
+                           "WITH RECURSIVE n(i) AS (SELECT 1 UNION ALL SELECT i + 1 FROM n WHERE i < 300000) "
+                           "INSERT INTO Loans (book_id, member_id, loan_date, due_date, is_returned) "
+                           "SELECT 1 + (i * 7919) % 4, 1 + (i * 104729) % 4, '2024-01-01', "
+                           "date('2024-01-01', '+' || (i % 90) || ' days'), i % 3 = 0 FROM n;",
+                           nullptr, nullptr, nullptr), SQLITE_OK);
+
+    ASSERT_EQ(refresh_analytics(test_db, 1), 300006);
+    AnalyticsCount single[4];
+    LoanSummary single_summary;
+    ASSERT_EQ(analytics_top_books(single, 4), 4);
+    ASSERT_EQ(analytics_loan_summary(day_of("2024-02-15"), &single_summary), 0);
+    free_analytics();
+
+    ASSERT_EQ(refresh_analytics(test_db, 4), 300006);
+    AnalyticsCount parallel[4];
+    LoanSummary parallel_summary;
+    ASSERT_EQ(analytics_top_books(parallel, 4), 4);
+    ASSERT_EQ(analytics_loan_summary(day_of("2024-02-15"), &parallel_summary), 0);
+
+    sqlite3_stmt* stmt;
+    ASSERT_EQ(sqlite3_prepare_v2(test_db, "SELECT book_id, COUNT(*) AS c FROM Loans "
+                                 "GROUP BY book_id ORDER BY c DESC, book_id;", -1, &stmt, nullptr), SQLITE_OK);
+    for (int i = 0; i < 4; i++) {
+        ASSERT_EQ(sqlite3_step(stmt), SQLITE_ROW);
+        EXPECT_EQ(parallel[i].id, sqlite3_column_int(stmt, 0));
+        EXPECT_EQ(parallel[i].count, sqlite3_column_int(stmt, 1));
+        EXPECT_EQ(single[i].id, parallel[i].id);
+        EXPECT_EQ(single[i].count, parallel[i].count);
+    }
+    sqlite3_finalize(stmt);
+
+    ASSERT_EQ(sqlite3_prepare_v2(test_db, "SELECT COUNT(*), SUM(julianday('2024-02-15') - julianday(due_date)) "
+                                 "FROM Loans WHERE is_returned = 0 AND due_date < '2024-02-15';",
+                                 -1, &stmt, nullptr), SQLITE_OK);
+    ASSERT_EQ(sqlite3_step(stmt), SQLITE_ROW);
+    EXPECT_EQ(parallel_summary.overdue_loans, sqlite3_column_int(stmt, 0));
+    EXPECT_EQ(parallel_summary.overdue_days, sqlite3_column_int64(stmt, 1));
+    sqlite3_finalize(stmt);
+
+    EXPECT_EQ(single_summary.active_loans, parallel_summary.active_loans);
+    EXPECT_EQ(single_summary.overdue_members, parallel_summary.overdue_members);
+    EXPECT_EQ(single_summary.max_overdue_days, parallel_summary.max_overdue_days);
+}
+
+// ============================================================================
+// Main function
+// ============================================================================
+
+int main(int argc, char** argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,175 @@
+/**
+ * @file test_autocomplete_gtest.cpp
+ * @brief Google Test based unit tests for the Autocomplete module
+ * 
+ * Covers prefix completion over titles, authors and member names,
+ * popularity ranking and incremental maintenance of the tries.
+ */
+
+#include <gtest/gtest.h>
+#include <sqlite3.h>
+#include <string>
+
+extern "C" {
+    #include "../include/database.h"
+    #include "../include/book.h"
+    #include "../include/member.h"
+    #include "../include/loan.h"
+    #include "../include/autocomplete.h"
+}
+
+// Test fixture class for Autocomplete module tests
+class AutocompleteTest : public ::testing::Test {
+protected:
+    sqlite3* test_db;
+    sqlite3* saved_db;
+    int member_id;
+
+    // Setup: Create in-memory database with a small catalogue and loan history
+    void SetUp() override {
+        test_db = nullptr;
+        saved_db = get_db_connection();
+
+        int rc = sqlite3_open(":memory:", &test_db);
+        ASSERT_EQ(rc, SQLITE_OK) << "Failed to open in-memory database";
+
+        set_db_connection(test_db);
+        ASSERT_EQ(create_tables(), 0);
+        ASSERT_EQ(migrate_schema(), 0);
+        ASSERT_EQ(create_indexes(), 0);
+
+        ASSERT_EQ(add_book("Harry Potter 1", "J.K. Rowling", "", 1997, "0001", "Fantasy", 10), 0);
+        ASSERT_EQ(add_book("Harry Potter 2", "J.K. Rowling", "", 1998, "0002", "Fantasy", 10), 0);
+        ASSERT_EQ(add_book("Hamlet", "Shakespeare", "", 1603, "0003", "Drama", 10), 0);
+        ASSERT_EQ(add_book("한국사 이야기", "이이화", "", 1998, "0004", "역사", 10), 0);
+
+        member_id = add_member(test_db, "홍길동", "010-1111-1111", "서울");
+        ASSERT_GT(member_id, 0);
+        ASSERT_GT(add_member(test_db, "홍길순", "010-2222-2222", "부산"), 0);
+
+        // Book 2 borrowed twice, book 1 once
+        ASSERT_GT(process_loan(test_db, 2, member_id, 14), 0);
+        ASSERT_GT(process_loan(test_db, 2, member_id, 14), 0);
+        ASSERT_GT(process_loan(test_db, 1, member_id, 14), 0);
+    }
+
+    // Teardown: Drop the tries and close database after each test
+    void TearDown() override {
+        free_autocomplete();
+        set_db_connection(saved_db);
+
+        if (test_db) {
+            sqlite3_close(test_db);
+            test_db = nullptr;
+        }
+    }
+
+    // Helper function to return the completion texts joined by '|'
+    std::string complete(int field, const char* prefix, int max_count = 10) {
+        Completion results[10];
+        int count = autocomplete(field, prefix, results, max_count);
+        std::string joined;
+        for (int i = 0; i < count; i++) {
+            if (i > 0) joined += "|";
+            joined += results[i].text;
+        }
+        return joined;
+    }
+};
+
+// ============================================================================
+// Test Suite 1: autocomplete() tests
+// ============================================================================
+
+TEST_F(AutocompleteTest, LoadCountsKeys) {
+    // 4 titles, 3 distinct authors, 2 member names
+    EXPECT_EQ(load_autocomplete(test_db), 9);
+}
+
+TEST_F(AutocompleteTest, TitlesRankedByLoans) {
+    EXPECT_EQ(complete(AUTOCOMPLETE_TITLE, "ha"), "Harry Potter 2|Harry Potter 1|Hamlet");
+    EXPECT_EQ(complete(AUTOCOMPLETE_TITLE, "HARRY"), "Harry Potter 2|Harry Potter 1");
+    EXPECT_EQ(complete(AUTOCOMPLETE_TITLE, "ha", 1), "Harry Potter 2");
+    EXPECT_EQ(complete(AUTOCOMPLETE_TITLE, "xyz"), "");
+}
+
+TEST_F(AutocompleteTest, EmptyPrefixReturnsMostBorrowed) {
+    EXPECT_EQ(complete(AUTOCOMPLETE_TITLE, "", 2), "Harry Potter 2|Harry Potter 1");
+}
+
+TEST_F(AutocompleteTest, AuthorsAggregateLoans) {
+    Completion results[5];
+    ASSERT_EQ(autocomplete(AUTOCOMPLETE_AUTHOR, "j", results, 5), 1);
+    EXPECT_STREQ(results[0].text, "J.K. Rowling");
+    EXPECT_EQ(results[0].loans, 3);
+}
+
+TEST_F(AutocompleteTest, HangulPartialSyllable) {
+    EXPECT_EQ(complete(AUTOCOMPLETE_TITLE, "한ㄱ"), "한국사 이야기");
+    EXPECT_EQ(complete(AUTOCOMPLETE_TITLE, "한국사이"), "한국사 이야기") << "Spaces are ignored";
+}
+
+TEST_F(AutocompleteTest, MemberNames) {
+    EXPECT_EQ(complete(AUTOCOMPLETE_MEMBER, "홍길"), "홍길동|홍길순");
+    EXPECT_EQ(complete(AUTOCOMPLETE_MEMBER, "홍길ㅅ"), "홍길순");
+}
+
+// ============================================================================
+// Test Suite 2: incremental maintenance
+// ============================================================================
+
+TEST_F(AutocompleteTest, NewLoanChangesRanking) {
+    ASSERT_GE(load_autocomplete(test_db), 0);
+
+    ASSERT_GT(process_loan(test_db, 3, member_id, 14), 0);
+    ASSERT_GT(process_loan(test_db, 3, member_id, 14), 0);
+    ASSERT_GT(process_loan(test_db, 3, member_id, 14), 0);
+
+    EXPECT_EQ(complete(AUTOCOMPLETE_TITLE, "ha", 1), "Hamlet");
+}
+
+TEST_F(AutocompleteTest, AddUpdateDeleteBook) {
+    ASSERT_GE(load_autocomplete(test_db), 0);
+
+    ASSERT_EQ(add_book("Hard Times", "Charles Dickens", "", 1854, "0005", "Novel", 1), 0);
+    EXPECT_EQ(complete(AUTOCOMPLETE_TITLE, "hard"), "Hard Times");
+    EXPECT_EQ(complete(AUTOCOMPLETE_AUTHOR, "charles"), "Charles Dickens");
+
+    ASSERT_EQ(update_book(5, "Great Expectations", NULL, NULL, 0, NULL), 0);
+    EXPECT_EQ(complete(AUTOCOMPLETE_TITLE, "hard"), "");
+    EXPECT_EQ(complete(AUTOCOMPLETE_TITLE, "great"), "Great Expectations");
+
+    ASSERT_EQ(delete_book(5), 0);
+    EXPECT_EQ(complete(AUTOCOMPLETE_TITLE, "great"), "");
+    EXPECT_EQ(complete(AUTOCOMPLETE_AUTHOR, "charles"), "") << "Author without books is dropped";
+}
+
+TEST_F(AutocompleteTest, SharedPrefixesSplitAndMerge) {
+    ASSERT_GE(load_autocomplete(test_db), 0);
+
+    ASSERT_EQ(add_book("Harr", "", "", 2000, "0006", "", 1), 0);
+    ASSERT_EQ(add_book("Harp", "", "", 2000, "0007", "", 1), 0);
+    EXPECT_EQ(complete(AUTOCOMPLETE_TITLE, "harr"), "Harry Potter 2|Harry Potter 1|Harr");
+
+    ASSERT_EQ(delete_book(5), 0);
+    EXPECT_EQ(complete(AUTOCOMPLETE_TITLE, "harr"), "Harry Potter 2|Harry Potter 1");
+    EXPECT_EQ(complete(AUTOCOMPLETE_TITLE, "harp"), "Harp");
+}
+
+TEST_F(AutocompleteTest, UpdateMemberName) {
+    ASSERT_GE(load_autocomplete(test_db), 0);
+
+    ASSERT_EQ(update_member(test_db, member_id, "김철수", NULL, NULL), 0);
+    EXPECT_EQ(complete(AUTOCOMPLETE_MEMBER, "홍길"), "홍길순");
+    EXPECT_EQ(complete(AUTOCOMPLETE_MEMBER, "ㄱ"), "김철수");
+    EXPECT_EQ(complete(AUTOCOMPLETE_MEMBER, "ㅊ"), "") << "Only prefixes of the whole name";
+}
+
+// ============================================================================
+// Main function
+// ============================================================================
+
+int main(int argc, char** argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -9,6 +9,9 @@
 #include <gtest/gtest.h>
 #include <sqlite3.h>
 #include <cstring>
+#include <string>
+
+#include "template_db.hpp"
 
 extern "C" {
     #include "../include/database.h"
@@ -22,57 +25,40 @@ extern "C" {
     extern void set_db_connection(sqlite3* new_db);
 }
 
+// Template schema for Book module tests: the Books table only
+static int build_books_schema(sqlite3* db) {
+    const char* create_books_sql = 
+        "CREATE TABLE IF NOT EXISTS Books ("
+        "book_id INTEGER PRIMARY KEY AUTOINCREMENT,"
+        "title TEXT NOT NULL,"
+        "author TEXT,"
+        "isbn TEXT UNIQUE,"
+        "genre TEXT,"
+        "publisher TEXT,"
+        "publication_year INTEGER,"
+        "quantity INTEGER DEFAULT 0,"
+        "available INTEGER DEFAULT 0,"
+        "title_chosung TEXT,"
+        "title_jamo TEXT,"
+        "author_chosung TEXT,"
+        "author_jamo TEXT,"
+        "isbn13 INTEGER"
+        ");";
+
+    return sqlite3_exec(db, create_books_sql, nullptr, nullptr, nullptr) == SQLITE_OK ? 0 : -1;
+}
+
 // Test fixture class for Book module tests
-class BookTest : public ::testing::Test {
+class BookTest : public ClonedDatabaseTest<build_books_schema> {
 protected:
-    sqlite3* test_db;
-    sqlite3* saved_db;
-    
-    // Setup: Create in-memory database before each test
+    // Setup: Clone the in-memory template database before each test
     void SetUp() override {
-        test_db = nullptr;
-        
-        // Save current database connection
-        saved_db = get_db_connection();
+        ClonedDatabaseTest::SetUp();
+        ASSERT_NE(test_db, nullptr);
         
-        // Open in-memory database
-        int rc = sqlite3_open(":memory:", &test_db);
-        ASSERT_EQ(rc, SQLITE_OK) << "Failed to open in-memory database";
-        
-        // Set the global database connection to our test database
-        set_db_connection(test_db);
-        
-        // Enable foreign keys
+        // Enable foreign keys (a per-connection setting, not part of the template)
         const char* fk_sql = "PRAGMA foreign_keys = ON;";
         sqlite3_exec(test_db, fk_sql, nullptr, nullptr, nullptr);
-        
-        // Create tables manually for testing
-        const char* create_books_sql = 
-            "CREATE TABLE IF NOT EXISTS Books ("
-            "book_id INTEGER PRIMARY KEY AUTOINCREMENT,"
-            "title TEXT NOT NULL,"
-            "author TEXT,"
-            "isbn TEXT UNIQUE,"
-            "genre TEXT,"
-            "publisher TEXT,"
-            "publication_year INTEGER,"
-            "quantity INTEGER DEFAULT 0,"
-            "available INTEGER DEFAULT 0"
-            ");";
-        
-        rc = sqlite3_exec(test_db, create_books_sql, nullptr, nullptr, nullptr);
-        ASSERT_EQ(rc, SQLITE_OK) << "Failed to create Books table";
-    }
-
-    // Teardown: Close database after each test
-    void TearDown() override {
-        // Restore original database connection
-        set_db_connection(saved_db);
-        
-        if (test_db) {
-            sqlite3_close(test_db);
-            test_db = nullptr;
-        }
     }
 
     // Helper function to count books in database
@@ -293,6 +279,59 @@ TEST_F(BookTest, UpdateBookPartialUpdate) {
     EXPECT_STREQ(book.author, "Original Author"); // Should remain unchanged
 }
 
+TEST_F(BookTest, UpdateBookEveryFieldMask) {
+    add_book("Original Title", "Original Author", "Original Publisher", 
+             2020, "1111111111", "Fiction", 3);
+    
+    int book_id = get_book_id_by_isbn("1111111111");
+    ASSERT_GT(book_id, 0);
+    
+    // All 31 non-empty field combinations, each twice to hit the cached statement
+    for (int round = 0; round < 2; round++) {
+        for (int mask = 1; mask < 32; mask++) {
+            std::string suffix = std::to_string(round) + "-" + std::to_string(mask);
+            std::string title = "Title " + suffix, author = "Author " + suffix;
+            std::string publisher = "Publisher " + suffix, genre = "Genre " + suffix;
+            
+            Book before;
+            ASSERT_EQ(get_book_by_id(book_id, &before), 0);
+            ASSERT_EQ(update_book(book_id,
+                                  (mask & 1) ? title.c_str() : nullptr,
+                                  (mask & 2) ? author.c_str() : nullptr,
+                                  (mask & 4) ? publisher.c_str() : nullptr,
+                                  (mask & 8) ? 1900 + mask : 0,
+                                  (mask & 16) ? genre.c_str() : nullptr), 0) << "mask " << mask;
+            
+            Book after;
+            ASSERT_EQ(get_book_by_id(book_id, &after), 0);
+            EXPECT_STREQ(after.title, (mask & 1) ? title.c_str() : before.title);
+            EXPECT_STREQ(after.author, (mask & 2) ? author.c_str() : before.author);
+            EXPECT_STREQ(after.publisher, (mask & 4) ? publisher.c_str() : before.publisher);
+            EXPECT_EQ(after.publication_year, (mask & 8) ? 1900 + mask : before.publication_year);
+            EXPECT_STREQ(after.genre, (mask & 16) ? genre.c_str() : before.genre);
+        }
+    }
+    
+    EXPECT_EQ(update_book(book_id, nullptr, nullptr, nullptr, 0, nullptr), -1) << "Nothing to update";
+}
+
+TEST_F(BookTest, UpdateBookReusesCachedStatement) {
+    add_book("Original Title", "Original Author", "Original Publisher", 
+             2020, "1111111111", "Fiction", 3);
+    
+    int book_id = get_book_id_by_isbn("1111111111");
+    ASSERT_GT(book_id, 0);
+    ASSERT_EQ(update_book(book_id, nullptr, nullptr, nullptr, 2001, "Drama"), 0);
+    
+    sqlite3_stmt* cached = find_cached_statement(test_db, STMT_SLOT_UPDATE_BOOK + 8 + 16);
+    ASSERT_NE(cached, nullptr);
+    EXPECT_EQ(find_cached_statement(test_db, STMT_SLOT_UPDATE_BOOK + 1), nullptr) << "Prepared lazily";
+    
+    ASSERT_EQ(update_book(book_id, nullptr, nullptr, nullptr, 2002, "Comedy"), 0);
+    EXPECT_EQ(find_cached_statement(test_db, STMT_SLOT_UPDATE_BOOK + 8 + 16), cached);
+    EXPECT_EQ(sqlite3_stmt_busy(cached), 0) << "Statement is reset after use";
+}
+
 TEST_F(BookTest, UpdateBookNullDatabase) {
     // Save current connection and set to NULL
     set_db_connection(nullptr);
@@ -0,0 +1,194 @@
+/**
+ * @file test_book_table_gtest.cpp
+ * @brief Google Test based unit tests for the compact book table
+ * 
+ * Covers string interning, the column-oriented BookTable, its conversion
+ * from Books rows and its memory use compared to the Book struct.
+ */
+
+#include <gtest/gtest.h>
+#include <sqlite3.h>
+#include <string>
+
+extern "C" {
+    #include "../include/database.h"
+    #include "../include/book.h"
+    #include "../include/book_table.h"
+}
+
+// ============================================================================
+// Test Suite 1: string pool
+// ============================================================================
+
+TEST(StringPoolTest, InternReturnsStableIds) {
+    StringPool pool;
+    ASSERT_EQ(string_pool_init(&pool), 0);
+
+    EXPECT_EQ(string_pool_intern(&pool, nullptr), BOOK_TABLE_NO_STRING);
+    EXPECT_EQ(string_pool_intern(&pool, ""), BOOK_TABLE_NO_STRING);
+
+    int64_t tolkien = string_pool_intern(&pool, "J.R.R. Tolkien");
+    int64_t park = string_pool_intern(&pool, "박경리");
+    EXPECT_EQ(tolkien, 1);
+    EXPECT_EQ(park, 2);
+    EXPECT_EQ(string_pool_intern(&pool, "J.R.R. Tolkien"), tolkien);
+    EXPECT_STREQ(string_pool_get(&pool, (uint32_t)park), "박경리");
+    EXPECT_EQ(string_pool_find(&pool, "박경리"), park);
+    EXPECT_EQ(string_pool_find(&pool, "Unknown"), -1);
+    EXPECT_EQ(string_pool_get(&pool, 99), nullptr);
+
+    string_pool_free(&pool);
+}
+
+TEST(StringPoolTest, SurvivesGrowth) {
+    StringPool pool;
+    ASSERT_EQ(string_pool_init(&pool), 0);
+
+    for (int i = 0; i < 5000; i++) {
+        ASSERT_EQ(string_pool_intern(&pool, ("author " + std::to_string(i)).c_str()), i + 1);
+    }
+    for (int i = 0; i < 5000; i += 7) {
+        EXPECT_EQ(string_pool_find(&pool, ("author " + std::to_string(i)).c_str()), i + 1);
+        EXPECT_EQ(std::string(string_pool_get(&pool, i + 1)), "author " + std::to_string(i));
+    }
+
+    string_pool_free(&pool);
+}
+
+// ============================================================================
+// Test Suite 2: book table
+// ============================================================================
+
+TEST(BookTableTest, AppendAndFind) {
+    BookTable table;
+    ASSERT_EQ(book_table_init(&table), 0);
+
+    std::string long_title(300, 'a');
+    EXPECT_EQ(book_table_append(&table, 3, "Hobbit", "Tolkien", "Allen", 1937, 9780306406157LL, "Fantasy", 2, 1), 0);
+    EXPECT_EQ(book_table_append(&table, 8, long_title.c_str(), "Tolkien", nullptr, 1954, 0, "Fantasy", 1, 1), 1);
+    EXPECT_EQ(book_table_append(&table, 5, "Out of order", "", "", 2000, 0, "", 1, 1), -1);
+    EXPECT_EQ(book_table_append(&table, 9, "Too many", "", "", 2000, 0, "", 70000, 1), -1);
+
+    EXPECT_EQ(table.count, 2);
+    EXPECT_EQ(table.author_ids[0], table.author_ids[1]) << "Authors are interned";
+    EXPECT_EQ(table.genre_ids[0], table.genre_ids[1]);
+    EXPECT_EQ(table.publisher_ids[1], (uint32_t)BOOK_TABLE_NO_STRING);
+    EXPECT_EQ(std::string(book_table_title(&table, 1)), long_title) << "Titles are not truncated";
+
+    EXPECT_EQ(book_table_find(&table, 3), 0);
+    EXPECT_EQ(book_table_find(&table, 8), 1);
+    EXPECT_EQ(book_table_find(&table, 4), -1);
+
+    Book book;
+    ASSERT_EQ(book_table_get(&table, 0, &book), 0);
+    EXPECT_EQ(book.book_id, 3);
+    EXPECT_STREQ(book.title, "Hobbit");
+    EXPECT_STREQ(book.author, "Tolkien");
+    EXPECT_STREQ(book.publisher, "Allen");
+    EXPECT_STREQ(book.isbn, "9780306406157");
+    EXPECT_EQ(book.publication_year, 1937);
+    EXPECT_EQ(book.available, 1);
+    ASSERT_EQ(book_table_get(&table, 1, &book), 0);
+    EXPECT_EQ(strlen(book.title), sizeof(book.title) - 1);
+    EXPECT_STREQ(book.isbn, "");
+    EXPECT_EQ(book_table_get(&table, 2, &book), -1);
+
+    book_table_free(&table);
+}
+
+// Test fixture class for loading the table from the database
+class BookTableLoadTest : public ::testing::Test {
+protected:
+    sqlite3* test_db;
+    sqlite3* saved_db;
+
+    // Setup: Create in-memory database with the full schema before each test
+    void SetUp() override {
+        test_db = nullptr;
+        saved_db = get_db_connection();
+
+        int rc = sqlite3_open(":memory:", &test_db);
+        ASSERT_EQ(rc, SQLITE_OK) << "Failed to open in-memory database";
+
+        set_db_connection(test_db);
+        ASSERT_EQ(create_tables(), 0);
+        ASSERT_EQ(migrate_schema(), 0);
+        ASSERT_EQ(create_indexes(), 0);
+    }
+
+    // Teardown: Close database after each test
+    void TearDown() override {
+        set_db_connection(saved_db);
+
+        if (test_db) {
+            sqlite3_close(test_db);
+            test_db = nullptr;
+        }
+    }
+};
+
+TEST_F(BookTableLoadTest, LoadMatchesBooks) {
+    ASSERT_EQ(add_book("토지", "박경리", "마로니에북스", 2012, "978-89-374-6044-9", "소설", 3), 0);
+    ASSERT_EQ(add_book("Hobbit", "Tolkien", "Allen", 1937, "0-306-40615-2", "Fantasy", 1), 0);
+
+    BookTable table;
+    ASSERT_EQ(book_table_init(&table), 0);
+    ASSERT_EQ(load_book_table(test_db, &table), 2);
+
+    for (int row = 0; row < table.count; row++) {
+        Book expected;
+        Book actual;
+        ASSERT_EQ(get_book_by_id(table.book_ids[row], &expected), 0);
+        ASSERT_EQ(book_table_get(&table, row, &actual), 0);
+        EXPECT_STREQ(actual.title, expected.title);
+        EXPECT_STREQ(actual.author, expected.author);
+        EXPECT_STREQ(actual.publisher, expected.publisher);
+        EXPECT_STREQ(actual.genre, expected.genre);
+        EXPECT_EQ(actual.quantity, expected.quantity);
+    }
+    EXPECT_EQ(table.isbn13[1], 9780306406157LL);
+
+    book_table_free(&table);
+}
+
+TEST_F(BookTableLoadTest, UsesAboutAFifthOfTheMemory) {
+    const char* authors[] = {"박경리", "Tolkien", "Austen", "김영하", "Murakami"};
+    const char* genres[] = {"소설", "Fantasy", "Classic", "SF"};
+
+    ASSERT_EQ(sqlite3_exec(test_db, "BEGIN;", nullptr, nullptr, nullptr), SQLITE_OK);
+    sqlite3_stmt* stmt;
+    ASSERT_EQ(sqlite3_prepare_v2(test_db,
+                                 "INSERT INTO Books (title, author, publisher, publication_year, isbn, genre, "
+                                 "quantity, available, isbn13) VALUES (?, ?, 'Publisher', 2000, ?, ?, 1, 1, 0);",
+                                 -1, &stmt, nullptr), SQLITE_OK);
+    for (int i = 0; i < 10000; i++) {
+        std::string title = "Collected Stories " + std::to_string(i);
+        std::string isbn = std::to_string(i);
+        sqlite3_bind_text(stmt, 1, title.c_str(), -1, SQLITE_TRANSIENT);
+        sqlite3_bind_text(stmt, 2, authors[i % 5], -1, SQLITE_STATIC);
+        sqlite3_bind_text(stmt, 3, isbn.c_str(), -1, SQLITE_TRANSIENT);
+        sqlite3_bind_text(stmt, 4, genres[i % 4], -1, SQLITE_STATIC);
+        ASSERT_EQ(sqlite3_step(stmt), SQLITE_DONE);
+        sqlite3_reset(stmt);
+    }
+    sqlite3_finalize(stmt);
+    ASSERT_EQ(sqlite3_exec(test_db, "COMMIT;", nullptr, nullptr, nullptr), SQLITE_OK);
+
+    BookTable table;
+    ASSERT_EQ(book_table_init(&table), 0);
+    ASSERT_EQ(load_book_table(test_db, &table), 10000);
+
+    size_t per_book = book_table_memory(&table) / table.count;
+    EXPECT_GE(sizeof(Book) * 10 / per_book, 45u) << per_book << " bytes per book";
+
+    book_table_free(&table);
+}
+
+// ============================================================================
+// Main function
+// ============================================================================
+
+int main(int argc, char** argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
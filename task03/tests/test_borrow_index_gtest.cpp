@@ -0,0 +1,238 @@
+/**
+ * @file test_borrow_index_gtest.cpp
+ * @brief Google Test based unit tests for the borrow history index
+ * 
+ * Covers building and mapping the index, member and book lookups,
+ * any/all queries over several books, loans folded in by process_loan(),
+ * catch-up errors and saving or flushing the merged index.
+ */
+
+#include <gtest/gtest.h>
+#include <sqlite3.h>
+#include <cstdio>
+#include <vector>
+
+extern "C" {
+    #include "../include/database.h"
+    #include "../include/book.h"
+    #include "../include/member.h"
+    #include "../include/loan.h"
+    #include "../include/borrow_index.h"
+}
+
+static const char *TEST_INDEX_PATH = "borrow_index_test.bin";
+
+// Test fixture class for the borrow history index
+class BorrowIndexTest : public ::testing::Test {
+protected:
+    sqlite3* test_db;
+    sqlite3* saved_db;
+    RoaringBitmap result;
+
+    // Setup: Create in-memory database with books, members and a loan history
+    void SetUp() override {
+        test_db = nullptr;
+        saved_db = get_db_connection();
+        roaring_init(&result);
+
+        int rc = sqlite3_open(":memory:", &test_db);
+        ASSERT_EQ(rc, SQLITE_OK) << "Failed to open in-memory database";
+
+        set_db_connection(test_db);
+        ASSERT_EQ(create_tables(), 0);
+        ASSERT_EQ(migrate_schema(), 0);
+        ASSERT_EQ(create_indexes(), 0);
+        set_quiet_mode(1);
+
+        const char *isbns[4] = {"1000000001", "1000000002", "1000000003", "1000000004"};
+        for (int i = 0; i < 4; i++) {
+            ASSERT_EQ(add_book("Book", "Author", "Publisher", 2024, isbns[i], "Fiction", 5), 0);
+        }
+        for (int i = 0; i < 3; i++) {
+            ASSERT_GT(add_member(test_db, "Reader", "010-0000-0000", "Seoul"), 0);
+        }
+
+        // Member 1: books 1, 2, 3   Member 2: books 1, 2 (book 1 twice)   Member 3: books 1, 4
+        loan(1, 1);
+        loan(2, 1);
+        loan(3, 1);
+        loan(1, 2);
+        loan(2, 2);
+        loan(1, 2);
+        loan(1, 3);
+        loan(4, 3);
+    }
+
+    // Teardown: Unmap the index, remove its file and close database
+    void TearDown() override {
+        roaring_free(&result);
+        close_borrow_index();
+        std::remove(TEST_INDEX_PATH);
+        set_quiet_mode(0);
+        set_db_connection(saved_db);
+
+        if (test_db) {
+            sqlite3_close(test_db);
+            test_db = nullptr;
+        }
+    }
+
+    void loan(int book_id, int member_id) {
+        ASSERT_GT(process_loan(test_db, book_id, member_id, 14), 0);
+    }
+
+    void build_and_open() {
+        ASSERT_EQ(build_borrow_index(test_db, TEST_INDEX_PATH), 7);
+        ASSERT_EQ(open_borrow_index(TEST_INDEX_PATH), 0);
+    }
+
+    std::vector<uint32_t> values() {
+        std::vector<uint32_t> out(roaring_cardinality(&result));
+        out.resize(roaring_to_array(&result, out.data(), (long)out.size()));
+        return out;
+    }
+};
+
+// Test: members map to their books and books to their borrowers
+TEST_F(BorrowIndexTest, LooksUpBothDirections) {
+    EXPECT_EQ(borrow_index_has_borrowed(1, 1), -1);    // not open yet
+    EXPECT_EQ(borrow_index_member_books(1, &result), -1);
+    build_and_open();
+
+    EXPECT_EQ(borrow_index_has_borrowed(1, 3), 1);
+    EXPECT_EQ(borrow_index_has_borrowed(2, 3), 0);
+    EXPECT_EQ(borrow_index_has_borrowed(9, 1), 0);
+
+    EXPECT_EQ(borrow_index_member_books(1, &result), 3);
+    EXPECT_EQ(values(), std::vector<uint32_t>({1, 2, 3}));
+    EXPECT_EQ(borrow_index_book_members(1, &result), 3);
+    EXPECT_EQ(values(), std::vector<uint32_t>({1, 2, 3}));
+    EXPECT_EQ(borrow_index_book_members(4, &result), 1);
+    EXPECT_EQ(values(), std::vector<uint32_t>({3}));
+    EXPECT_EQ(borrow_index_book_members(99, &result), 0);
+}
+
+// Test: unions and intersections over the borrowers of several books
+TEST_F(BorrowIndexTest, AnyAndAllOfSeveralBooks) {
+    build_and_open();
+
+    int some[] = {3, 4};
+    EXPECT_EQ(borrow_index_members_of_any(some, 2, &result), 2);
+    EXPECT_EQ(values(), std::vector<uint32_t>({1, 3}));
+
+    int pair[] = {1, 2};
+    EXPECT_EQ(borrow_index_members_of_all(pair, 2, &result), 2);
+    EXPECT_EQ(values(), std::vector<uint32_t>({1, 2}));
+
+    int none[] = {1, 2, 4};
+    EXPECT_EQ(borrow_index_members_of_all(none, 3, &result), 0);
+    int missing[] = {1, 99};
+    EXPECT_EQ(borrow_index_members_of_all(missing, 2, &result), 0);
+    EXPECT_EQ(borrow_index_members_of_all(missing, 0, &result), 0);
+}
+
+// Test: loans after the build are folded in by process_loan and kept by a save
+TEST_F(BorrowIndexTest, NewLoansUpdateAndSave) {
+    build_and_open();
+
+    loan(4, 2);    // member 2 borrows book 4
+    EXPECT_EQ(borrow_index_has_borrowed(2, 4), 1);
+    int both[] = {1, 4};
+    EXPECT_EQ(borrow_index_members_of_all(both, 2, &result), 2);
+    EXPECT_EQ(values(), std::vector<uint32_t>({2, 3}));
+
+    ASSERT_EQ(save_borrow_index(TEST_INDEX_PATH), 0);
+    EXPECT_EQ(borrow_index_has_borrowed(2, 4), 1);
+    EXPECT_EQ(borrow_index_book_members(4, &result), 2);
+    EXPECT_EQ(catch_up_borrow_index(test_db), 0);    // nothing newer than the saved file
+
+    // Reopening drops nothing: the file holds every loan
+    close_borrow_index();
+    ASSERT_EQ(open_borrow_index(TEST_INDEX_PATH), 0);
+    EXPECT_EQ(borrow_index_member_books(2, &result), 3);
+    EXPECT_EQ(values(), std::vector<uint32_t>({1, 2, 4}));
+
+    EXPECT_EQ(open_borrow_index("/nonexistent/borrow_index.bin"), -1);
+}
+
+// Test: a failed query is reported and its loans are picked up by the next call
+TEST_F(BorrowIndexTest, QueryErrorIsReported) {
+    build_and_open();
+    ASSERT_EQ(sqlite3_exec(test_db, "INSERT INTO Loans (book_id, member_id, loan_date, due_date) "
+                                    "VALUES (4, 2, '2024-01-01', '2024-01-15');", nullptr, nullptr, nullptr),
+              SQLITE_OK);
+
+    // Interrupt the catch-up query
+    sqlite3_progress_handler(test_db, 1, [](void*) { return 1; }, nullptr);
+    EXPECT_EQ(catch_up_borrow_index(test_db), -1);
+    sqlite3_progress_handler(test_db, 0, nullptr, nullptr);
+    EXPECT_EQ(borrow_index_has_borrowed(2, 4), 0);
+
+    EXPECT_EQ(catch_up_borrow_index(test_db), 1);
+    EXPECT_EQ(borrow_index_has_borrowed(2, 4), 1);
+    EXPECT_EQ(borrow_index_book_members(4, &result), 2);
+}
+
+// Test: removing values from array and bitmap containers
+TEST_F(BorrowIndexTest, RoaringRemove) {
+    for (uint32_t v = 0; v < 5000; v++) {
+        ASSERT_EQ(roaring_add(&result, v), 0);    // one bitmap container
+    }
+    ASSERT_EQ(roaring_add(&result, 70000), 0);   // one array container
+
+    roaring_remove(&result, 42);
+    roaring_remove(&result, 42);
+    roaring_remove(&result, 123456);             // no container for it
+    EXPECT_EQ(roaring_contains(&result, 42), 0);
+    EXPECT_EQ(roaring_cardinality(&result), 5000);
+
+    for (uint32_t v = 0; v < 1000; v++) {
+        roaring_remove(&result, v);              // shrinks back to an array
+    }
+    EXPECT_EQ(roaring_cardinality(&result), 4001);
+    EXPECT_EQ(result.containers[0].kind, ROARING_ARRAY);
+    EXPECT_EQ(roaring_contains(&result, 1000), 1);
+
+    roaring_remove(&result, 70000);
+    EXPECT_EQ(result.count, 1) << "The emptied container is dropped";
+    EXPECT_EQ(roaring_contains(&result, 70000), 0);
+}
+
+// Test: flushing writes pending loans back to the mapped file
+TEST_F(BorrowIndexTest, SkipsLoansThatRollBack) {
+    build_and_open();
+
+    // The rolled back loan's ID goes to the next loan, which must not be skipped
+    ASSERT_EQ(begin_transaction(), 0);
+    loan(4, 1);
+    EXPECT_EQ(borrow_index_has_borrowed(1, 4), 0) << "Not folded in before the commit";
+    ASSERT_EQ(rollback_transaction(), 0);
+    loan(2, 3);
+    EXPECT_EQ(borrow_index_has_borrowed(1, 4), 0);
+    EXPECT_EQ(borrow_index_has_borrowed(3, 2), 1);
+
+    // A committed transaction is picked up by the next call outside it
+    ASSERT_EQ(begin_transaction(), 0);
+    loan(3, 2);
+    ASSERT_EQ(commit_transaction(), 0);
+    EXPECT_EQ(catch_up_borrow_index(test_db), 1);
+    EXPECT_EQ(borrow_index_has_borrowed(2, 3), 1);
+}
+
+TEST_F(BorrowIndexTest, FlushWritesPendingLoans) {
+    build_and_open();
+    EXPECT_EQ(flush_borrow_index(), 0) << "Nothing pending yet";
+
+    loan(4, 2);
+    ASSERT_EQ(flush_borrow_index(), 1);
+    EXPECT_EQ(flush_borrow_index(), 0);
+
+    // The next start finds the loan in the file instead of catching up on it
+    close_borrow_index();
+    ASSERT_EQ(open_borrow_index(TEST_INDEX_PATH), 0);
+    EXPECT_EQ(catch_up_borrow_index(test_db), 0);
+    EXPECT_EQ(borrow_index_has_borrowed(2, 4), 1);
+
+    close_borrow_index();
+    EXPECT_EQ(flush_borrow_index(), 0) << "No index open";
+}
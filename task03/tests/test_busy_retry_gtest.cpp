@@ -0,0 +1,164 @@
+/**
+ * @file test_busy_retry_gtest.cpp
+ * @brief Google Test based unit tests for the busy retry layer
+ * 
+ * Uses a database file and a second connection standing in for another
+ * process: giving up at the busy timeout, waiting out a lock that is
+ * released, the wait counters, and savepoints nesting inside a caller's
+ * transaction.
+ */
+
+#include <gtest/gtest.h>
+#include <sqlite3.h>
+#include <unistd.h>
+#include <chrono>
+#include <cstring>
+#include <string>
+#include <thread>
+
+extern "C" {
+    #include "../include/database.h"
+    #include "../include/book.h"
+    #include "../include/member.h"
+    #include "../include/loan.h"
+}
+
+// Test fixture class for the busy retry layer
+class BusyRetryTest : public ::testing::Test {
+protected:
+    sqlite3* test_db;
+    sqlite3* other_db;
+    sqlite3* saved_db;
+    char db_path[64];
+
+    // Setup: Create a database file with a book and a member, and open a second connection
+    void SetUp() override {
+        test_db = nullptr;
+        other_db = nullptr;
+        saved_db = get_db_connection();
+
+        strcpy(db_path, "/tmp/test_busy_retryXXXXXX");
+        int fd = mkstemp(db_path);
+        ASSERT_GE(fd, 0);
+        close(fd);
+
+        int rc = sqlite3_open(db_path, &test_db);
+        ASSERT_EQ(rc, SQLITE_OK) << "Failed to open database file";
+
+        set_db_connection(test_db);
+        ASSERT_EQ(create_tables(), 0);
+        ASSERT_EQ(migrate_schema(), 0);
+        set_quiet_mode(1);
+
+        ASSERT_EQ(add_book("Dune", "Frank Herbert", "Chilton", 1965, "9780306406157", "SF", 3), 0);
+        ASSERT_EQ(add_member(test_db, "Reader", "", ""), 1);
+
+        ASSERT_EQ(sqlite3_open(db_path, &other_db), SQLITE_OK);
+        sqlite3_busy_timeout(other_db, 5000);
+        reset_retry_stats();
+    }
+
+    // Teardown: Close both connections and remove the database file
+    void TearDown() override {
+        set_busy_timeout(0);
+        set_quiet_mode(0);
+        set_db_connection(saved_db);
+
+        if (other_db) {
+            sqlite3_close(other_db);
+            other_db = nullptr;
+        }
+        if (test_db) {
+            sqlite3_close(test_db);
+            test_db = nullptr;
+        }
+        unlink(db_path);
+        unlink((std::string(db_path) + "-journal").c_str());
+    }
+
+    static int query_int(sqlite3* db, const char* sql) {
+        sqlite3_stmt* stmt;
+        int value = -1;
+        if (sqlite3_prepare_v2(db, sql, -1, &stmt, nullptr) == SQLITE_OK) {
+            if (sqlite3_step(stmt) == SQLITE_ROW) {
+                value = sqlite3_column_int(stmt, 0);
+            }
+            sqlite3_finalize(stmt);
+        }
+        return value;
+    }
+};
+
+// Test: a write lock held past the busy timeout fails the call cleanly
+TEST_F(BusyRetryTest, GivesUpAtTheBusyTimeout) {
+    set_busy_timeout(50);
+    ASSERT_EQ(sqlite3_exec(other_db, "BEGIN IMMEDIATE;", nullptr, nullptr, nullptr), SQLITE_OK);
+
+    auto start = std::chrono::steady_clock::now();
+    EXPECT_EQ(begin_savepoint(test_db, "busy"), -1);
+    EXPECT_LT(process_loan(test_db, 1, 1, 14), 0);
+    double elapsed_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    EXPECT_NE(sqlite3_get_autocommit(test_db), 0);    // nothing left open
+
+    DbRetryStats stats;
+    get_retry_stats(&stats);
+    EXPECT_EQ(stats.timeouts, 2);
+    EXPECT_GE(stats.waits, 2);
+    EXPECT_GE(stats.wait_us, 80000);
+    EXPECT_LT(elapsed_ms, 1000);    // the handler and the retries share one deadline per call
+
+    ASSERT_EQ(sqlite3_exec(other_db, "COMMIT;", nullptr, nullptr, nullptr), SQLITE_OK);
+    EXPECT_EQ(query_int(test_db, "SELECT COUNT(*) FROM Loans"), 0);
+    EXPECT_EQ(query_int(test_db, "SELECT available FROM Books WHERE book_id = 1"), 3);
+}
+
+// Test: a loan waits for another writer to commit, then goes through
+TEST_F(BusyRetryTest, WaitsForTheLockToBeReleased) {
+    set_busy_timeout(5000);
+    ASSERT_EQ(sqlite3_exec(other_db, "BEGIN IMMEDIATE; UPDATE Members SET phone = '010' WHERE member_id = 1;",
+                           nullptr, nullptr, nullptr), SQLITE_OK);
+    std::thread writer([this] {
+        std::this_thread::sleep_for(std::chrono::milliseconds(30));
+        sqlite3_exec(other_db, "COMMIT;", nullptr, nullptr, nullptr);
+    });
+
+    int loan_id = process_loan(test_db, 1, 1, 14);
+    writer.join();
+    EXPECT_GT(loan_id, 0);
+
+    DbRetryStats stats;
+    get_retry_stats(&stats);
+    EXPECT_GE(stats.waits, 1);
+    EXPECT_GE(stats.retries, 1);
+    EXPECT_EQ(stats.timeouts, 0);
+    EXPECT_GE(stats.wait_us, 10000);
+
+    EXPECT_EQ(query_int(test_db, "SELECT COUNT(*) FROM Loans"), 1);
+    EXPECT_EQ(query_int(test_db, "SELECT available FROM Books WHERE book_id = 1"), 2);
+    EXPECT_EQ(query_int(other_db, "SELECT COUNT(*) FROM Members WHERE phone = '010'"), 1);
+}
+
+// Test: savepoints inside a caller's transaction leave the commit to the caller
+TEST_F(BusyRetryTest, SavepointsNestInCallerTransaction) {
+    int began = begin_savepoint(test_db, "outer");
+    ASSERT_EQ(began, 1);
+    EXPECT_EQ(sqlite3_get_autocommit(test_db), 0);
+    EXPECT_EQ(begin_savepoint(test_db, "inner"), 0);
+    rollback_savepoint(test_db, "inner", 0);
+    EXPECT_EQ(sqlite3_get_autocommit(test_db), 0);    // the outer transaction survives
+
+    EXPECT_GT(process_loan(test_db, 1, 1, 14), 0);
+    EXPECT_EQ(sqlite3_get_autocommit(test_db), 0);
+    EXPECT_EQ(query_int(other_db, "SELECT COUNT(*) FROM Loans"), 0);    // not committed yet
+
+    EXPECT_EQ(release_savepoint(test_db, "outer", began), 0);
+    EXPECT_NE(sqlite3_get_autocommit(test_db), 0);
+    EXPECT_EQ(query_int(other_db, "SELECT COUNT(*) FROM Loans"), 1);
+
+    // A caller's rollback undoes the loan made inside it
+    ASSERT_EQ(begin_transaction(), 0);
+    EXPECT_GT(process_loan(test_db, 1, 1, 14), 0);
+    ASSERT_EQ(rollback_transaction(), 0);
+    EXPECT_EQ(query_int(test_db, "SELECT COUNT(*) FROM Loans"), 1);
+    EXPECT_EQ(query_int(test_db, "SELECT available FROM Books WHERE book_id = 1"), 2);
+}
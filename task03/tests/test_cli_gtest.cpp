@@ -0,0 +1,251 @@
+/**
+ * @file test_cli_gtest.cpp
+ * @brief Google Test based unit tests for the batch command mode
+ * 
+ * Covers script line splitting, option parsing and errors, the JSON
+ * result lines and the per-command and shared transaction modes.
+ */
+
+#include <gtest/gtest.h>
+#include <sqlite3.h>
+#include <unistd.h>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+extern "C" {
+    #include "../include/database.h"
+    #include "../include/cli.h"
+}
+
+// Test fixture class for the command mode
+class CliTest : public ::testing::Test {
+protected:
+    sqlite3* test_db;
+    sqlite3* saved_db;
+
+    // Setup: Create in-memory database in quiet mode
+    void SetUp() override {
+        test_db = nullptr;
+        saved_db = get_db_connection();
+
+        int rc = sqlite3_open(":memory:", &test_db);
+        ASSERT_EQ(rc, SQLITE_OK) << "Failed to open in-memory database";
+
+        set_db_connection(test_db);
+        ASSERT_EQ(create_tables(), 0);
+        ASSERT_EQ(migrate_schema(), 0);
+        ASSERT_EQ(create_indexes(), 0);
+        set_quiet_mode(1);
+    }
+
+    // Teardown: Close database after each test
+    void TearDown() override {
+        set_quiet_mode(0);
+        set_db_connection(saved_db);
+
+        if (test_db) {
+            sqlite3_close(test_db);
+            test_db = nullptr;
+        }
+    }
+
+    static std::string read_all(FILE* file) {
+        std::string text;
+        char buffer[512];
+        rewind(file);
+        size_t n;
+        while ((n = fread(buffer, 1, sizeof(buffer), file)) > 0) {
+            text.append(buffer, n);
+        }
+        fclose(file);
+        return text;
+    }
+
+    // Run one command line and return its result line
+    std::string run(const std::string& command_line, int* rc = nullptr) {
+        std::vector<char> line(command_line.begin(), command_line.end());
+        line.push_back('\0');
+        char* argv[CLI_MAX_ARGS];
+        int argc = cli_split_line(line.data(), argv, CLI_MAX_ARGS);
+
+        FILE* out = tmpfile();
+        int result = cli_run_command(test_db, argc, argv, 0, out);
+        if (rc != nullptr) {
+            *rc = result;
+        }
+        return read_all(out);
+    }
+
+    // Run a script and return every output line
+    std::string run_script(const std::string& script, int shared_transaction, CliStats* stats) {
+        FILE* in = tmpfile();
+        fputs(script.c_str(), in);
+        rewind(in);
+        FILE* out = tmpfile();
+        cli_run_script(test_db, in, shared_transaction, out, stats);
+        fclose(in);
+        return read_all(out);
+    }
+
+    int query_int(const std::string& sql) {
+        sqlite3_stmt* stmt;
+        EXPECT_EQ(sqlite3_prepare_v2(test_db, sql.c_str(), -1, &stmt, nullptr), SQLITE_OK) << sql;
+        int value = sqlite3_step(stmt) == SQLITE_ROW ? sqlite3_column_int(stmt, 0) : -1;
+        sqlite3_finalize(stmt);
+        return value;
+    }
+};
+
+TEST_F(CliTest, SplitLineHandlesQuotesAndComments) {
+    char line[] = "add-book --title \"The Left Hand\" --author Le\" \"Guin  # trailing comment\n";
+    char* argv[CLI_MAX_ARGS];
+    ASSERT_EQ(cli_split_line(line, argv, CLI_MAX_ARGS), 5);
+    EXPECT_STREQ(argv[0], "add-book");
+    EXPECT_STREQ(argv[2], "The Left Hand");
+    EXPECT_STREQ(argv[4], "Le Guin");
+
+    char blank[] = "   # only a comment\n";
+    EXPECT_EQ(cli_split_line(blank, argv, CLI_MAX_ARGS), 0);
+
+    char open_quote[] = "add-member --name \"Kim\n";
+    EXPECT_EQ(cli_split_line(open_quote, argv, CLI_MAX_ARGS), -1);
+
+    char too_many[] = "a b c d";
+    EXPECT_EQ(cli_split_line(too_many, argv, 3), -1);
+}
+
+TEST_F(CliTest, CommandsWriteJsonResults) {
+    EXPECT_EQ(run("add-book --title Dune --author Herbert --isbn 9780441172719 --quantity 2"),
+              "{\"command\":\"add-book\",\"status\":\"ok\",\"book_id\":1}\n");
+    EXPECT_EQ(run("add-member --name \"Kim Reader\""),
+              "{\"command\":\"add-member\",\"status\":\"ok\",\"member_id\":1}\n");
+    EXPECT_EQ(run("loan --book 1 --member 1 --days 7"),
+              "{\"command\":\"loan\",\"status\":\"ok\",\"loan_id\":1}\n");
+    EXPECT_EQ(run("can-borrow --member 1"),
+              "{\"command\":\"can-borrow\",\"status\":\"ok\",\"can_borrow\":1}\n");
+    EXPECT_EQ(run("return --loan 1"),
+              "{\"command\":\"return\",\"status\":\"ok\",\"return_id\":1}\n");
+    EXPECT_EQ(query_int("SELECT available FROM Books WHERE book_id = 1;"), 2);
+
+    EXPECT_EQ(run("add-copy --book 1 --barcode B-001"),
+              "{\"command\":\"add-copy\",\"status\":\"ok\",\"copy_id\":1}\n");
+    EXPECT_EQ(run("loan --barcode B-001 --member 1"),
+              "{\"command\":\"loan\",\"status\":\"ok\",\"loan_id\":2}\n");
+    EXPECT_EQ(run("return --barcode B-001"),
+              "{\"command\":\"return\",\"status\":\"ok\",\"return_id\":2}\n");
+}
+
+TEST_F(CliTest, BadCommandsReportErrors) {
+    int rc = 0;
+    EXPECT_EQ(run("renew --loan 1", &rc),
+              "{\"command\":\"renew\",\"status\":\"error\",\"error\":\"unknown command\"}\n");
+    EXPECT_EQ(rc, -1);
+
+    EXPECT_EQ(run("loan --member 1"),
+              "{\"command\":\"loan\",\"status\":\"error\",\"error\":\"missing --book\"}\n");
+    EXPECT_EQ(run("loan --book x --member 1"),
+              "{\"command\":\"loan\",\"status\":\"error\",\"error\":\"--book must be a non-negative integer\"}\n");
+    EXPECT_EQ(run("return --loan"),
+              "{\"command\":\"return\",\"status\":\"error\",\"error\":\"missing value for --loan\"}\n");
+    EXPECT_NE(run("return --book 1").find("unknown option --book"), std::string::npos);
+
+    // Failures inside the library are reported without their stderr details
+    EXPECT_EQ(run("return --loan 99", &rc),
+              "{\"command\":\"return\",\"status\":\"error\",\"error\":\"return failed\"}\n");
+    EXPECT_EQ(rc, -1);
+}
+
+TEST_F(CliTest, ExportWritesFileAndRate) {
+    run("add-book --title Dune --author Herbert --isbn 9780441172719");
+    std::string path = "/tmp/test_cli_export_" + std::to_string(getpid()) + ".csv";
+
+    std::string result = run("export --table books --output " + path);
+    EXPECT_EQ(result.find("{\"command\":\"export\",\"status\":\"ok\",\"rows\":1,\"rows_per_sec\":"), 0u);
+    FILE* file = fopen(path.c_str(), "rb");
+    ASSERT_NE(file, nullptr);
+    EXPECT_EQ(read_all(file).substr(0, 8), "book_id,");
+    unlink(path.c_str());
+
+    EXPECT_EQ(run("export --table books --output " + path + " --format xml"),
+              "{\"command\":\"export\",\"status\":\"error\",\"error\":\"--format must be csv or jsonl\"}\n");
+    EXPECT_EQ(run("export --table authors --output " + path),
+              "{\"command\":\"export\",\"status\":\"error\",\"error\":\"export of authors failed\"}\n");
+    unlink(path.c_str());
+}
+
+TEST_F(CliTest, DedupReportsAndMerges) {
+    run("add-book --title \"Dune\" --author \"Frank Herbert\" --isbn 9780441172719 --quantity 2");
+    run("add-book --title \"DUNE (Ace ed.)\" --author \"Frank Herbert.\" --isbn 9780441013593");
+
+    EXPECT_EQ(run("dedup"), "{\"command\":\"dedup\",\"status\":\"ok\",\"clusters\":1,\"merged\":0}\n");
+    EXPECT_EQ(run("dedup --merge 1"), "{\"command\":\"dedup\",\"status\":\"ok\",\"clusters\":1,\"merged\":1}\n");
+    EXPECT_EQ(run("dedup"), "{\"command\":\"dedup\",\"status\":\"ok\",\"clusters\":0,\"merged\":0}\n");
+    EXPECT_EQ(run("dedup --threshold 101"),
+              "{\"command\":\"dedup\",\"status\":\"error\",\"error\":\"duplicate search failed\"}\n");
+}
+
+TEST_F(CliTest, ScriptContinuesPastFailures) {
+    CliStats stats;
+    std::string output = run_script(
+        "# nightly load\n"
+        "add-book --title Dune --isbn 9780441172719\n"
+        "\n"
+        "add-member --name Reader\n"
+        "loan --book 1 --member 9\n"
+        "loan --book 1 --member 1\n", 0, &stats);
+
+    EXPECT_EQ(stats.commands, 4);
+    EXPECT_EQ(stats.succeeded, 3);
+    EXPECT_EQ(stats.failed, 1);
+    EXPECT_EQ(stats.rolled_back, 0);
+    EXPECT_NE(output.find("{\"line\":5,\"command\":\"loan\",\"status\":\"error\""), std::string::npos);
+    EXPECT_NE(output.find("{\"line\":6,\"command\":\"loan\",\"status\":\"ok\",\"loan_id\":1}"), std::string::npos);
+    EXPECT_NE(output.find("{\"status\":\"done\",\"commands\":4,\"succeeded\":3,\"failed\":1}\n"), std::string::npos);
+    EXPECT_EQ(query_int("SELECT COUNT(*) FROM Loans;"), 1);
+}
+
+TEST_F(CliTest, SharedTransactionCommitsAllCommands) {
+    CliStats stats;
+    std::string output = run_script(
+        "add-book --title Dune --isbn 9780441172719 --quantity 3\n"
+        "add-member --name Reader\n"
+        "loan --book 1 --member 1\n"
+        "loan --book 1 --member 1\n"
+        "return --loan 1\n", 1, &stats);
+
+    EXPECT_EQ(stats.succeeded, 5);
+    EXPECT_EQ(stats.rolled_back, 0);
+    EXPECT_NE(output.find("\"transaction\":\"committed\""), std::string::npos);
+    EXPECT_EQ(sqlite3_get_autocommit(test_db), 1);
+    EXPECT_EQ(query_int("SELECT COUNT(*) FROM Loans;"), 2);
+    EXPECT_EQ(query_int("SELECT available FROM Books WHERE book_id = 1;"), 2);
+}
+
+TEST_F(CliTest, SharedTransactionRollsBackOnFailure) {
+    CliStats stats;
+    std::string output = run_script(
+        "add-book --title Dune --isbn 9780441172719\n"
+        "add-member --name Reader\n"
+        "loan --book 1 --member 1\n"
+        "return --loan 42\n"
+        "add-member --name Never\n", 1, &stats);
+
+    EXPECT_EQ(stats.commands, 4) << "Stops at the first failure";
+    EXPECT_EQ(stats.failed, 1);
+    EXPECT_EQ(stats.rolled_back, 1);
+    EXPECT_NE(output.find("\"transaction\":\"rolled_back\""), std::string::npos);
+    EXPECT_EQ(sqlite3_get_autocommit(test_db), 1);
+    EXPECT_EQ(query_int("SELECT COUNT(*) FROM Books;"), 0);
+    EXPECT_EQ(query_int("SELECT COUNT(*) FROM Members;"), 0);
+    EXPECT_EQ(query_int("SELECT COUNT(*) FROM Loans;"), 0);
+}
+
+// ============================================================================
+// Main function
+// ============================================================================
+
+int main(int argc, char** argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,338 @@
+/**
+ * @file test_copy_gtest.cpp
+ * @brief Google Test based unit tests for the Copy module
+ * 
+ * Covers copy registration, the in-memory barcode index and
+ * loan/return by barcode against an in-memory database, and the index
+ * following copies changed through a second connection to a file.
+ */
+
+#include <gtest/gtest.h>
+#include <sqlite3.h>
+#include <unistd.h>
+#include <cstring>
+#include <string>
+
+extern "C" {
+    #include "../include/database.h"
+    #include "../include/book.h"
+    #include "../include/member.h"
+    #include "../include/loan.h"
+    #include "../include/copy.h"
+    #include "../include/sql_functions.h"
+}
+
+// Test fixture class for Copy module tests
+class CopyTest : public ::testing::Test {
+protected:
+    sqlite3* test_db;
+    sqlite3* saved_db;
+    int book_id;
+    int member_id;
+
+    // Setup: Create in-memory database with the full schema before each test
+    void SetUp() override {
+        test_db = nullptr;
+        saved_db = get_db_connection();
+
+        int rc = sqlite3_open(":memory:", &test_db);
+        ASSERT_EQ(rc, SQLITE_OK) << "Failed to open in-memory database";
+
+        set_db_connection(test_db);
+        ASSERT_EQ(enable_foreign_keys(), 0);
+        ASSERT_EQ(create_tables(), 0);
+        ASSERT_EQ(migrate_schema(), 0);
+        ASSERT_EQ(create_indexes(), 0);
+
+        ASSERT_EQ(add_book("Copy Test Book", "Author", "Publisher", 2024, "1111111111", "Fiction", 2), 0);
+        book_id = (int)sqlite3_last_insert_rowid(test_db);
+        member_id = add_member(test_db, "Reader", "010-0000-0000", "Seoul");
+        ASSERT_GT(member_id, 0);
+    }
+
+    // Teardown: Drop the index and close database after each test
+    void TearDown() override {
+        free_copy_index();
+        set_db_connection(saved_db);
+
+        if (test_db) {
+            sqlite3_close(test_db);
+            test_db = nullptr;
+        }
+    }
+
+    // Helper function to read a single integer from the database
+    int query_int(const char* sql, int param) {
+        sqlite3_stmt* stmt;
+        int value = -1;
+
+        if (sqlite3_prepare_v2(test_db, sql, -1, &stmt, nullptr) == SQLITE_OK) {
+            sqlite3_bind_int(stmt, 1, param);
+            if (sqlite3_step(stmt) == SQLITE_ROW) {
+                value = sqlite3_column_int(stmt, 0);
+            }
+            sqlite3_finalize(stmt);
+        }
+        return value;
+    }
+};
+
+// ============================================================================
+// Test Suite 1: add_copy() tests
+// ============================================================================
+
+TEST_F(CopyTest, AddCopyWithinQuantityKeepsCounts) {
+    EXPECT_GT(add_copy(test_db, book_id, "BC-0001"), 0);
+    EXPECT_GT(add_copy(test_db, book_id, "BC-0002"), 0);
+
+    EXPECT_EQ(query_int("SELECT quantity FROM Books WHERE book_id = ?;", book_id), 2);
+    EXPECT_EQ(query_int("SELECT available FROM Books WHERE book_id = ?;", book_id), 2);
+}
+
+TEST_F(CopyTest, AddCopyBeyondQuantityGrowsCounts) {
+    add_copy(test_db, book_id, "BC-0001");
+    add_copy(test_db, book_id, "BC-0002");
+    EXPECT_GT(add_copy(test_db, book_id, "BC-0003"), 0);
+
+    EXPECT_EQ(query_int("SELECT quantity FROM Books WHERE book_id = ?;", book_id), 3);
+    EXPECT_EQ(query_int("SELECT available FROM Books WHERE book_id = ?;", book_id), 3);
+}
+
+TEST_F(CopyTest, AddCopyDuplicateBarcode) {
+    ASSERT_GT(add_copy(test_db, book_id, "BC-0001"), 0);
+
+    EXPECT_EQ(add_copy(test_db, book_id, "BC-0001"), -1) << "Barcodes must be unique";
+}
+
+// ============================================================================
+// Test Suite 2: barcode index tests
+// ============================================================================
+
+TEST_F(CopyTest, LoadIndexAndLookup) {
+    int copy_id = add_copy(test_db, book_id, "BC-0001");
+    add_copy(test_db, book_id, "BC-0002");
+
+    ASSERT_EQ(load_copy_index(test_db), 2);
+
+    Copy copy;
+    ASSERT_EQ(find_copy_by_barcode("BC-0001", &copy), 0);
+    EXPECT_EQ(copy.copy_id, copy_id);
+    EXPECT_EQ(copy.book_id, book_id);
+    EXPECT_EQ(copy.status, COPY_AVAILABLE);
+    EXPECT_EQ(find_copy_by_barcode("BC-9999", &copy), -1);
+    EXPECT_EQ(count_available_copies(book_id), 2);
+}
+
+TEST_F(CopyTest, IndexFollowsCopiesAddedAfterLoad) {
+    ASSERT_EQ(load_copy_index(test_db), 0);
+
+    add_copy(test_db, book_id, "BC-0001");
+
+    Copy copy;
+    EXPECT_EQ(find_copy_by_barcode("BC-0001", &copy), 0);
+    EXPECT_EQ(count_available_copies(book_id), 1);
+}
+
+// ============================================================================
+// Test Suite 3: loan and return by barcode
+// ============================================================================
+
+TEST_F(CopyTest, LoanAndReturnByBarcode) {
+    int copy_id = add_copy(test_db, book_id, "BC-0001");
+    add_copy(test_db, book_id, "BC-0002");
+    ASSERT_EQ(load_copy_index(test_db), 2);
+
+    int loan_id = loan_by_barcode(test_db, "BC-0001", member_id, 14);
+    ASSERT_GT(loan_id, 0);
+    EXPECT_EQ(count_available_copies(book_id), 1);
+    EXPECT_EQ(query_int("SELECT available FROM Books WHERE book_id = ?;", book_id), 1);
+    EXPECT_EQ(query_int("SELECT status FROM Copies WHERE copy_id = ?;", copy_id), COPY_ON_LOAN);
+    EXPECT_EQ(query_int("SELECT copy_id FROM Loans WHERE loan_id = ?;", loan_id), copy_id);
+
+    EXPECT_EQ(loan_by_barcode(test_db, "BC-0001", member_id, 14), -1) << "Copy is already lent out";
+
+    ASSERT_GT(return_by_barcode(test_db, "BC-0001"), 0);
+    EXPECT_EQ(count_available_copies(book_id), 2);
+    EXPECT_EQ(query_int("SELECT available FROM Books WHERE book_id = ?;", book_id), 2);
+    EXPECT_EQ(query_int("SELECT status FROM Copies WHERE copy_id = ?;", copy_id), COPY_AVAILABLE);
+}
+
+TEST_F(CopyTest, ReturnByLoanIdUpdatesIndex) {
+    add_copy(test_db, book_id, "BC-0001");
+    ASSERT_EQ(load_copy_index(test_db), 1);
+
+    int loan_id = loan_by_barcode(test_db, "BC-0001", member_id, 14);
+    ASSERT_GT(loan_id, 0);
+    ASSERT_GT(process_return(test_db, loan_id), 0);
+
+    EXPECT_EQ(count_available_copies(book_id), 1);
+}
+
+TEST_F(CopyTest, ReturnCopyNotOnLoan) {
+    add_copy(test_db, book_id, "BC-0001");
+
+    EXPECT_EQ(return_by_barcode(test_db, "BC-0001"), -1);
+    EXPECT_EQ(return_by_barcode(test_db, "UNKNOWN"), -1);
+}
+
+TEST_F(CopyTest, TitleAndBarcodeLoansShareCopies) {
+    ASSERT_EQ(add_book("Single Copy", "Author", "Publisher", 2024, "2222222222", "Fiction", 1), 0);
+    int single_id = (int)sqlite3_last_insert_rowid(test_db);
+    int copy_id = add_copy(test_db, single_id, "BC1");
+    ASSERT_GT(copy_id, 0);
+
+    // A loan by book ID takes the copy, so its barcode cannot be lent again
+    int loan_id = process_loan(test_db, single_id, member_id, 14);
+    ASSERT_GT(loan_id, 0);
+    EXPECT_EQ(query_int("SELECT copy_id FROM Loans WHERE loan_id = ?;", loan_id), copy_id);
+    EXPECT_EQ(query_int("SELECT status FROM Copies WHERE copy_id = ?;", copy_id), COPY_ON_LOAN);
+    EXPECT_EQ(loan_by_barcode(test_db, "BC1", member_id, 14), -1);
+    EXPECT_EQ(process_loan(test_db, single_id, member_id, 14), -1);
+    EXPECT_EQ(query_int("SELECT available FROM Books WHERE book_id = ?;", single_id), 0);
+
+    // And the other way round, with the index loaded
+    ASSERT_GT(return_by_barcode(test_db, "BC1"), 0);
+    EXPECT_EQ(count_available_copies(single_id), 1);
+    ASSERT_GT(loan_by_barcode(test_db, "BC1", member_id, 14), 0);
+    EXPECT_EQ(process_loan(test_db, single_id, member_id, 14), -1);
+    EXPECT_EQ(query_int("SELECT available FROM Books WHERE book_id = ?;", single_id), 0);
+    EXPECT_EQ(query_int("SELECT COUNT(*) FROM Loans WHERE book_id = ? AND is_returned = 0;", single_id), 1);
+}
+
+TEST_F(CopyTest, TitleLoanWithoutShelfCopyUsesQuantity) {
+    int copy_id = add_copy(test_db, book_id, "BC-0001");    // the title has 2, one registered
+    ASSERT_EQ(load_copy_index(test_db), 1);
+
+    int first = process_loan(test_db, book_id, member_id, 14);
+    ASSERT_GT(first, 0);
+    EXPECT_EQ(query_int("SELECT copy_id FROM Loans WHERE loan_id = ?;", first), copy_id);
+    EXPECT_EQ(count_available_copies(book_id), 0);
+
+    int second = process_loan(test_db, book_id, member_id, 14);
+    ASSERT_GT(second, 0);
+    EXPECT_EQ(query_int("SELECT copy_id IS NULL FROM Loans WHERE loan_id = ?;", second), 1);
+    EXPECT_EQ(query_int("SELECT available FROM Books WHERE book_id = ?;", book_id), 0);
+    EXPECT_EQ(process_loan(test_db, book_id, member_id, 14), -1);
+
+    // Returning the untracked loan frees quantity, not the registered copy
+    ASSERT_GT(process_return(test_db, second), 0);
+    EXPECT_EQ(loan_by_barcode(test_db, "BC-0001", member_id, 14), -1);
+    EXPECT_EQ(query_int("SELECT available FROM Books WHERE book_id = ?;", book_id), 1);
+}
+
+// ============================================================================
+// Test Suite 3: copies changed by another connection
+// ============================================================================
+
+// Test fixture class for a database file shared with a second connection
+class SharedCopyTest : public ::testing::Test {
+protected:
+    sqlite3* test_db;
+    sqlite3* other_db;
+    sqlite3* saved_db;
+    char db_path[64];
+    int book_id;
+    int member_id;
+
+    // Setup: Create a database file with two copies and open a second connection
+    void SetUp() override {
+        test_db = nullptr;
+        other_db = nullptr;
+        saved_db = get_db_connection();
+
+        strcpy(db_path, "/tmp/test_copy_sharedXXXXXX");
+        int fd = mkstemp(db_path);
+        ASSERT_GE(fd, 0);
+        close(fd);
+
+        ASSERT_EQ(sqlite3_open(db_path, &test_db), SQLITE_OK);
+        set_db_connection(test_db);
+        ASSERT_EQ(create_tables(), 0);
+        ASSERT_EQ(migrate_schema(), 0);
+        ASSERT_EQ(create_indexes(), 0);
+
+        ASSERT_EQ(add_book("Copy Test Book", "Author", "Publisher", 2024, "1111111111", "Fiction", 2), 0);
+        book_id = (int)sqlite3_last_insert_rowid(test_db);
+        member_id = add_member(test_db, "Reader", "", "");
+        ASSERT_GT(member_id, 0);
+        ASSERT_GT(add_copy(test_db, book_id, "BC-0001"), 0);
+        ASSERT_GT(add_copy(test_db, book_id, "BC-0002"), 0);
+        ASSERT_EQ(load_copy_index(test_db), 2);
+
+        ASSERT_EQ(sqlite3_open(db_path, &other_db), SQLITE_OK);
+        ASSERT_EQ(register_sql_functions(other_db), 0);
+    }
+
+    // Teardown: Close both connections and remove the database file
+    void TearDown() override {
+        free_copy_index();
+        set_db_connection(saved_db);
+
+        if (other_db) {
+            sqlite3_close(other_db);
+            other_db = nullptr;
+        }
+        if (test_db) {
+            sqlite3_close(test_db);
+            test_db = nullptr;
+        }
+        unlink(db_path);
+    }
+
+    // Lend a copy the way another process would, bypassing this process's index
+    void lend_elsewhere(const char* barcode) {
+        std::string sql = std::string("INSERT INTO Loans (book_id, member_id, loan_date, due_date, is_returned, copy_id) "
+                                      "SELECT book_id, 1, '2024-01-01', '2024-01-15', 0, copy_id "
+                                      "FROM Copies WHERE barcode = '") + barcode + "';"
+                          "UPDATE Copies SET status = 1 WHERE barcode = '" + barcode + "';"
+                          "UPDATE Books SET available = available - 1;";
+        ASSERT_EQ(sqlite3_exec(other_db, sql.c_str(), nullptr, nullptr, nullptr), SQLITE_OK);
+    }
+
+    int query_int(const char* sql) {
+        sqlite3_stmt* stmt;
+        int value = -1;
+        if (sqlite3_prepare_v2(test_db, sql, -1, &stmt, nullptr) == SQLITE_OK) {
+            if (sqlite3_step(stmt) == SQLITE_ROW) {
+                value = sqlite3_column_int(stmt, 0);
+            }
+            sqlite3_finalize(stmt);
+        }
+        return value;
+    }
+};
+
+TEST_F(SharedCopyTest, SeesCopyAddedElsewhere) {
+    // Raw SQL: add_copy() would also update this process's index
+    ASSERT_EQ(sqlite3_exec(other_db, "INSERT INTO Copies (barcode, book_id, status) VALUES ('BC-0003', 1, 0);"
+                           "UPDATE Books SET quantity = 3, available = 3;", nullptr, nullptr, nullptr), SQLITE_OK);
+    EXPECT_GT(loan_by_barcode(test_db, "BC-0003", member_id, 14), 0);
+    EXPECT_EQ(count_available_copies(book_id), 2);
+}
+
+TEST_F(SharedCopyTest, ReturnsCopyLentElsewhere) {
+    lend_elsewhere("BC-0001");
+    EXPECT_GT(return_by_barcode(test_db, "BC-0001"), 0);
+    EXPECT_EQ(query_int("SELECT status FROM Copies WHERE barcode = 'BC-0001';"), 0);
+    EXPECT_EQ(count_available_copies(book_id), 2);
+}
+
+TEST_F(SharedCopyTest, TitleLoanSkipsCopyLentElsewhere) {
+    lend_elsewhere("BC-0001");
+    EXPECT_EQ(loan_by_barcode(test_db, "BC-0001", member_id, 14), -1) << "Not on the shelf any more";
+
+    int loan_id = process_loan(test_db, book_id, member_id, 14);
+    ASSERT_GT(loan_id, 0);
+    EXPECT_EQ(query_int("SELECT c.barcode = 'BC-0002' FROM Loans l JOIN Copies c ON c.copy_id = l.copy_id "
+                        "ORDER BY l.loan_id DESC LIMIT 1;"), 1);
+    EXPECT_EQ(query_int("SELECT available FROM Books;"), 0);
+}
+
+// ============================================================================
+// Main function
+// ============================================================================
+
+int main(int argc, char** argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,167 @@
+/**
+ * @file test_dashboard_gtest.cpp
+ * @brief Google Test based unit tests for the member dashboard query
+ * 
+ * Checks that get_member_dashboard() agrees with the separate member,
+ * overdue and loan queries, and that a small arena truncates the loan
+ * lists without breaking the overdue summary.
+ */
+
+#include <gtest/gtest.h>
+#include <sqlite3.h>
+#include <string>
+
+extern "C" {
+    #include "../include/database.h"
+    #include "../include/book.h"
+    #include "../include/member.h"
+    #include "../include/loan.h"
+    #include "../include/date_utils.h"
+    #include "../include/dashboard.h"
+}
+
+// Test fixture class for the member dashboard
+class DashboardTest : public ::testing::Test {
+protected:
+    sqlite3* test_db;
+    sqlite3* saved_db;
+    alignas(16) unsigned char arena[DASHBOARD_ARENA_SIZE];
+
+    // Setup: Create in-memory database with two members and their loans
+    void SetUp() override {
+        test_db = nullptr;
+        saved_db = get_db_connection();
+
+        int rc = sqlite3_open(":memory:", &test_db);
+        ASSERT_EQ(rc, SQLITE_OK) << "Failed to open in-memory database";
+
+        set_db_connection(test_db);
+        ASSERT_EQ(create_tables(), 0);
+        ASSERT_EQ(migrate_schema(), 0);
+        ASSERT_EQ(create_indexes(), 0);
+
+        ASSERT_EQ(add_book("Dune", "Herbert", "", 1965, "B1", "SF", 5), 0);
+        ASSERT_EQ(add_book("토지", "박경리", "", 1994, "B2", "소설", 5), 0);
+        ASSERT_EQ(add_book("Emma", "Austen", "", 1815, "B3", "Classic", 5), 0);
+        ASSERT_EQ(add_member(test_db, "Reader", "010-1111-2222", "Seoul"), 1);
+        ASSERT_EQ(add_member(test_db, "Other", "010-3333-4444", "Busan"), 2);
+
+        // Member 1: one returned loan, one active overdue by 4 days, one active not yet due
+        insert_loan(1, 1, "2024-01-01", "2024-01-15", 1);
+        insert_loan(2, 1, date_from_today(-20).c_str(), date_from_today(-4).c_str(), 0);
+        insert_loan(3, 1, date_from_today(-2).c_str(), date_from_today(12).c_str(), 0);
+        exec("INSERT INTO Returns (loan_id, return_date, overdue_days) VALUES (1, '2024-01-18', 3);");
+        // Member 2: one active loan that must not leak into member 1's dashboard
+        insert_loan(1, 2, "2024-02-01", "2024-02-15", 0);
+    }
+
+    // Teardown: Close database after each test
+    void TearDown() override {
+        set_db_connection(saved_db);
+
+        if (test_db) {
+            sqlite3_close(test_db);
+            test_db = nullptr;
+        }
+    }
+
+    void exec(const std::string& sql) {
+        ASSERT_EQ(sqlite3_exec(test_db, sql.c_str(), nullptr, nullptr, nullptr), SQLITE_OK) << sql;
+    }
+
+    void insert_loan(int book_id, int member_id, const char* loan_date, const char* due_date, int is_returned) {
+        exec("INSERT INTO Loans (book_id, member_id, loan_date, due_date, is_returned) VALUES (" +
+             std::to_string(book_id) + ", " + std::to_string(member_id) + ", '" + loan_date + "', '" +
+             due_date + "', " + std::to_string(is_returned) + ");");
+    }
+
+    static std::string date_from_today(int days) {
+        char date[MAX_DATE_LEN];
+        day_to_date(get_today_day() + days, date, sizeof(date));
+        return date;
+    }
+};
+
+TEST_F(DashboardTest, MatchesSeparateQueries) {
+    MemberDashboard dash;
+    ASSERT_EQ(get_member_dashboard(test_db, 1, DASHBOARD_HISTORY_LIMIT, arena, sizeof(arena), &dash), 0);
+
+    Member member;
+    ASSERT_EQ(search_member_by_id(test_db, 1, &member), 0);
+    EXPECT_STREQ(dash.member.name, member.name);
+    EXPECT_STREQ(dash.member.phone, member.phone);
+    EXPECT_STREQ(dash.member.address, member.address);
+    EXPECT_STREQ(dash.member.registration_date, member.registration_date);
+    EXPECT_EQ(dash.member.overdue_days, member.overdue_days);
+    EXPECT_EQ(dash.member.overdue_days, 4);
+    EXPECT_EQ(dash.member.suspension_days, calculate_suspension_days(4));
+    EXPECT_EQ(dash.overdue_loans, 1);
+    EXPECT_EQ(dash.total_loans, 3);
+    EXPECT_EQ(dash.truncated, 0);
+
+    Loan active[10];
+    ASSERT_EQ(get_active_loans_by_member(test_db, 1, active, 10), 2);
+    ASSERT_EQ(dash.active_count, 2);
+    EXPECT_EQ(dash.active_loans[0].loan_id, 2) << "Earliest due date first";
+    EXPECT_STREQ(dash.active_loans[0].title, "토지");
+    EXPECT_EQ(dash.active_loans[0].overdue_days, 4);
+    EXPECT_EQ(dash.active_loans[1].loan_id, 3);
+    EXPECT_STREQ(dash.active_loans[1].title, "Emma");
+    EXPECT_EQ(dash.active_loans[1].overdue_days, 0);
+    EXPECT_STREQ(dash.active_loans[1].return_date, "");
+
+    Loan history[10];
+    ASSERT_EQ(get_loan_history_by_member(test_db, 1, history, 10), 3);
+    ASSERT_EQ(dash.history_count, 3);
+    for (int i = 0; i < 3; i++) {
+        EXPECT_EQ(dash.history[i].loan_id, history[i].loan_id);
+        EXPECT_STREQ(dash.history[i].loan_date, history[i].loan_date);
+        EXPECT_EQ(dash.history[i].is_returned, history[i].is_returned);
+    }
+    EXPECT_STREQ(dash.history[2].title, "Dune");
+    EXPECT_STREQ(dash.history[2].return_date, "2024-01-18");
+    EXPECT_EQ(dash.history[2].overdue_days, 3) << "Returned loans keep the recorded overdue days";
+}
+
+TEST_F(DashboardTest, HistoryLimitAndUnknownMember) {
+    MemberDashboard dash;
+    ASSERT_EQ(get_member_dashboard(test_db, 1, 1, arena, sizeof(arena), &dash), 0);
+    EXPECT_EQ(dash.history_count, 1);
+    EXPECT_EQ(dash.total_loans, 3);
+    EXPECT_EQ(dash.active_count, 2);
+
+    ASSERT_EQ(get_member_dashboard(test_db, 2, DASHBOARD_HISTORY_LIMIT, arena, sizeof(arena), &dash), 0);
+    EXPECT_EQ(dash.active_count, 1);
+    EXPECT_EQ(dash.total_loans, 1);
+    EXPECT_EQ(dash.overdue_loans, 1);
+
+    EXPECT_EQ(get_member_dashboard(test_db, 99, DASHBOARD_HISTORY_LIMIT, arena, sizeof(arena), &dash), -1);
+}
+
+TEST_F(DashboardTest, SmallArenaTruncatesListsOnly) {
+    MemberDashboard dash;
+    ASSERT_EQ(get_member_dashboard(test_db, 1, DASHBOARD_HISTORY_LIMIT, arena,
+                                   sizeof(DashboardLoan) + 32, &dash), 0);
+    EXPECT_EQ(dash.truncated, 1);
+    EXPECT_LE(dash.active_count + dash.history_count, 1);
+    EXPECT_EQ(dash.overdue_loans, 1) << "Summary covers loans that did not fit";
+    EXPECT_EQ(dash.member.overdue_days, 4);
+    EXPECT_STREQ(dash.member.name, "Reader");
+
+    // The cached query is reset even when the arena filled up, and reused next time
+    sqlite3_stmt* stmt = find_cached_statement(test_db, STMT_SLOT_DASHBOARD);
+    ASSERT_NE(stmt, nullptr);
+    EXPECT_FALSE(sqlite3_stmt_busy(stmt));
+    ASSERT_EQ(get_member_dashboard(test_db, 1, DASHBOARD_HISTORY_LIMIT, arena, sizeof(arena), &dash), 0);
+    EXPECT_EQ(dash.truncated, 0);
+    EXPECT_EQ(find_cached_statement(test_db, STMT_SLOT_DASHBOARD), stmt);
+}
+
+// ============================================================================
+// Main function
+// ============================================================================
+
+int main(int argc, char** argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,244 @@
+/**
+ * @file test_dedup_gtest.cpp
+ * @brief Google Test based unit tests for the duplicate finder
+ * 
+ * Covers clustering of titles that differ in punctuation, spacing, case
+ * and edition notes, keeping distinct books apart, the threshold,
+ * merging counts, loans and copies into the lowest book ID, and the
+ * barcode and borrow history indexes following the merge, also when
+ * their files are not open in the merging process.
+ */
+
+#include <gtest/gtest.h>
+#include <sqlite3.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <cstring>
+#include <string>
+#include <vector>
+
+extern "C" {
+    #include "../include/database.h"
+    #include "../include/book.h"
+    #include "../include/member.h"
+    #include "../include/loan.h"
+    #include "../include/copy.h"
+    #include "../include/dedup.h"
+    #include "../include/borrow_index.h"
+    #include "../include/recommend.h"
+    #include "../include/analytics.h"
+    #include "../include/reminder.h"
+    #include "../include/date_utils.h"
+}
+
+// Test fixture class for the duplicate finder
+class DedupTest : public ::testing::Test {
+protected:
+    sqlite3* test_db;
+    sqlite3* saved_db;
+    DedupResult result;
+
+    // Setup: Create in-memory database
+    void SetUp() override {
+        test_db = nullptr;
+        saved_db = get_db_connection();
+        memset(&result, 0, sizeof(result));
+
+        int rc = sqlite3_open(":memory:", &test_db);
+        ASSERT_EQ(rc, SQLITE_OK) << "Failed to open in-memory database";
+
+        set_db_connection(test_db);
+        ASSERT_EQ(create_tables(), 0);
+        ASSERT_EQ(migrate_schema(), 0);
+        ASSERT_EQ(create_indexes(), 0);
+        set_quiet_mode(1);
+    }
+
+    // Teardown: Close database
+    void TearDown() override {
+        free_dedup_result(&result);
+        set_quiet_mode(0);
+        set_db_connection(saved_db);
+
+        if (test_db) {
+            sqlite3_close(test_db);
+            test_db = nullptr;
+        }
+    }
+
+    int query_int(const char* sql) {
+        int value = -1;
+        sqlite3_stmt* stmt;
+        if (sqlite3_prepare_v2(test_db, sql, -1, &stmt, nullptr) == SQLITE_OK) {
+            if (sqlite3_step(stmt) == SQLITE_ROW) {
+                value = sqlite3_column_int(stmt, 0);
+            }
+            sqlite3_finalize(stmt);
+        }
+        return value;
+    }
+
+    std::vector<int> cluster(int index) {
+        return std::vector<int>(result.book_ids + result.cluster_start[index],
+                                result.book_ids + result.cluster_start[index + 1]);
+    }
+};
+
+// Test: punctuation, spacing, case and edition notes do not hide a duplicate
+TEST_F(DedupTest, ClustersNearDuplicates) {
+    ASSERT_EQ(add_book("The C Programming Language", "Brian W. Kernighan", "Prentice Hall", 1978, "0131101633", "CS", 2), 0);
+    ASSERT_EQ(add_book("Dune", "Frank Herbert", "Chilton", 1965, "0441172717", "SF", 1), 0);
+    ASSERT_EQ(add_book("The C-Programming Language (2nd ed.)", "Kernighan, Brian W", "Prentice Hall", 1988, "0131103628", "CS", 3), 0);
+    ASSERT_EQ(add_book("토지", "박경리", "마로니에북스", 2012, "9788960531834", "소설", 1), 0);
+    ASSERT_EQ(add_book("Dune Messiah", "Frank Herbert", "Putnam", 1969, "0399101233", "SF", 1), 0);
+    ASSERT_EQ(add_book("the c programming  language", "brian w kernighan", NULL, 0, "0201633612", "CS", 1), 0);
+    ASSERT_EQ(add_book("토 지 [양장본]", "박경리", "솔출판사", 1994, "8985541054", "소설", 1), 0);
+
+    ASSERT_EQ(find_duplicate_books(test_db, DEDUP_DEFAULT_THRESHOLD, &result), 2);
+    EXPECT_EQ(result.book_count, 7);
+    EXPECT_EQ(cluster(0), std::vector<int>({1, 3, 6}));    // author word order differs in book 3
+    EXPECT_EQ(cluster(1), std::vector<int>({4, 7}));
+    EXPECT_EQ(display_duplicate_books(test_db, &result), 5);
+
+    // A threshold of 100 needs identical shingle sets
+    free_dedup_result(&result);
+    ASSERT_EQ(find_duplicate_books(test_db, 100, &result), 2);
+    EXPECT_EQ(cluster(0), std::vector<int>({1, 6}));
+    EXPECT_EQ(cluster(1), std::vector<int>({4, 7}));
+
+    EXPECT_EQ(find_duplicate_books(test_db, 0, &result), -1);
+    EXPECT_EQ(result.cluster_count, 0);
+}
+
+// Test: a large catalogue of distinct titles yields only the planted duplicates
+TEST_F(DedupTest, KeepsDistinctBooksApart) {
+    ASSERT_EQ(sqlite3_exec(test_db,
+        "WITH RECURSIVE n(i) AS (SELECT 1 UNION ALL SELECT i + 1 FROM n WHERE i < 3000) "
+        "INSERT INTO Books (title, author) SELECT "
+        "'Volume ' || printf('%08x', i * 2654435761 % 4294967296) || ' of ' || (i * 7919 % 3001), 'Author ' || (i % 50) FROM n;",
+        nullptr, nullptr, nullptr), SQLITE_OK);
+    ASSERT_EQ(sqlite3_exec(test_db,
+        "INSERT INTO Books (title, author) SELECT upper(title) || ' (reprint)', author || '.' "
+        "FROM Books WHERE book_id IN (10, 2000);"
+        "INSERT INTO Books (title, author) VALUES ('', NULL), ('...', '');",
+        nullptr, nullptr, nullptr), SQLITE_OK);
+
+    ASSERT_EQ(find_duplicate_books(test_db, DEDUP_DEFAULT_THRESHOLD, &result), 2);
+    EXPECT_EQ(result.book_count, 3004);
+    EXPECT_EQ(cluster(0), std::vector<int>({10, 3001}));
+    EXPECT_EQ(cluster(1), std::vector<int>({2000, 3002}));
+}
+
+// Test: merging adds the counts and moves loans and copies to the kept book
+TEST_F(DedupTest, MergesIntoLowestBookId) {
+    ASSERT_EQ(add_book("Dune", "Frank Herbert", "Chilton", 1965, "0441172717", "SF", 2), 0);
+    ASSERT_EQ(add_book("Neuromancer", "William Gibson", "Ace", 1984, "0441569595", "SF", 1), 0);
+    ASSERT_EQ(add_book("DUNE.", "Frank  Herbert", "Ace", 1990, "0441172695", "SF", 3), 0);
+    ASSERT_GT(add_member(test_db, "Reader", "010-0000-0000", "Seoul"), 0);
+    ASSERT_GT(add_copy(test_db, 3, "B-003"), 0);
+    ASSERT_GT(process_loan(test_db, 3, 1, 14), 0);
+
+    ASSERT_EQ(find_duplicate_books(test_db, DEDUP_DEFAULT_THRESHOLD, &result), 1);
+    EXPECT_EQ(cluster(0), std::vector<int>({1, 3}));
+    EXPECT_EQ(merge_duplicate_books(test_db, &result), 1);
+
+    EXPECT_EQ(query_int("SELECT COUNT(*) FROM Books;"), 2);
+    EXPECT_EQ(query_int("SELECT quantity FROM Books WHERE book_id = 1;"), 5);
+    EXPECT_EQ(query_int("SELECT available FROM Books WHERE book_id = 1;"), 4);
+    EXPECT_EQ(query_int("SELECT COUNT(*) FROM Loans WHERE book_id = 1;"), 1);
+    EXPECT_EQ(query_int("SELECT book_id FROM Copies WHERE barcode = 'B-003';"), 1);
+
+    // Nothing left to merge
+    free_dedup_result(&result);
+    ASSERT_EQ(find_duplicate_books(test_db, DEDUP_DEFAULT_THRESHOLD, &result), 0);
+    EXPECT_EQ(merge_duplicate_books(test_db, &result), 0);
+}
+
+// Test: merged copies can be lent by barcode and the borrow history moves with them
+TEST_F(DedupTest, IndexesFollowTheMerge) {
+    ASSERT_EQ(add_book("The C Programming Language", "Brian W. Kernighan", "Prentice Hall", 1978, "0131101633", "CS", 1), 0);
+    ASSERT_EQ(add_book("The C Programming Language (2nd ed.)", "Brian W. Kernighan", "Prentice Hall", 1988,
+                       "0131103628", "CS", 1), 0);
+    ASSERT_GT(add_member(test_db, "Reader", "010-0000-0000", "Seoul"), 0);
+    ASSERT_GT(add_copy(test_db, 1, "DUP1"), 0);
+    ASSERT_GT(add_copy(test_db, 2, "DUP2"), 0);
+    int loan_id = loan_by_barcode(test_db, "DUP2", 1, 14);
+    ASSERT_GT(loan_id, 0);
+    ASSERT_GT(process_return(test_db, loan_id), 0);
+
+    char index_path[] = "/tmp/test_dedup_borrowXXXXXX";
+    int fd = mkstemp(index_path);
+    ASSERT_GE(fd, 0);
+    close(fd);
+    ASSERT_EQ(build_borrow_index(test_db, index_path), 1);
+    ASSERT_EQ(open_borrow_index(index_path), 0);
+    EXPECT_EQ(borrow_index_has_borrowed(1, 2), 1);
+
+    ASSERT_EQ(find_duplicate_books(test_db, DEDUP_DEFAULT_THRESHOLD, &result), 1);
+    ASSERT_EQ(merge_duplicate_books(test_db, &result), 1);
+
+    EXPECT_EQ(borrow_index_has_borrowed(1, 1), 1);
+    EXPECT_EQ(borrow_index_has_borrowed(1, 2), 0);
+    close_borrow_index();
+    unlink(index_path);
+
+    ASSERT_GT(loan_by_barcode(test_db, "DUP2", 1, 14), 0);
+    EXPECT_EQ(count_available_copies(1), 1) << "DUP1 is still on the shelf";
+    EXPECT_EQ(query_int("SELECT available FROM Books WHERE book_id = 1;"), 1);
+    free_copy_index();
+}
+
+// Records the book of every reminder fired
+static void collect_book(const Reminder* reminder, void* user_data) {
+    static_cast<std::vector<int>*>(user_data)->push_back(reminder->book_id);
+}
+
+TEST_F(DedupTest, RebuildsFilesAndStateNotOpenHere) {
+    ASSERT_EQ(add_book("The C Programming Language", "Brian W. Kernighan", "Prentice Hall", 1978, "0131101633", "CS", 1), 0);
+    ASSERT_EQ(add_book("The C Programming Language (2nd ed.)", "Brian W. Kernighan", "Prentice Hall", 1988,
+                       "0131103628", "CS", 1), 0);
+    ASSERT_EQ(add_book("Dune", "Frank Herbert", "Chilton", 1965, "9780441013593", "SF", 1), 0);
+    ASSERT_GT(add_member(test_db, "Reader", "010-0000-0000", "Seoul"), 0);
+    ASSERT_GT(process_return(test_db, process_loan(test_db, 3, 1, 14)), 0);
+    ASSERT_GT(process_loan(test_db, 2, 1, 14), 0);
+
+    // Files at the default paths, as the desk app leaves them; the nightly CLI never opens them
+    char dir[] = "/tmp/test_dedup_filesXXXXXX";
+    ASSERT_NE(mkdtemp(dir), nullptr);
+    char cwd[512];
+    ASSERT_NE(getcwd(cwd, sizeof(cwd)), nullptr);
+    ASSERT_EQ(chdir(dir), 0);
+    ASSERT_EQ(mkdir("database", 0755), 0);
+    ASSERT_EQ(build_borrow_index(test_db, BORROW_INDEX_PATH), 2);
+    ASSERT_GE(build_recommendations(test_db, RECOMMEND_PATH, 1), 0);
+
+    int today = get_today_day();
+    ASSERT_EQ(load_reminder_scheduler(test_db, today), 1);
+    ASSERT_GE(refresh_analytics(test_db, 1), 0);
+
+    ASSERT_EQ(find_duplicate_books(test_db, DEDUP_DEFAULT_THRESHOLD, &result), 1);
+    ASSERT_EQ(merge_duplicate_books(test_db, &result), 1);
+
+    AnalyticsCount top[4];
+    EXPECT_EQ(analytics_top_books(top, 4), -1) << "The store reloads on next use";
+    std::vector<int> books;
+    ASSERT_EQ(advance_reminders(test_db, today + 13, collect_book, &books), 1);
+    EXPECT_EQ(books, std::vector<int>{1});
+
+    ASSERT_EQ(open_borrow_index(BORROW_INDEX_PATH), 0);
+    EXPECT_EQ(borrow_index_has_borrowed(1, 1), 1);
+    EXPECT_EQ(borrow_index_has_borrowed(1, 2), 0);
+    ASSERT_EQ(open_recommendations(RECOMMEND_PATH), 0);
+    Recommendation recs[RECOMMEND_MAX_NEIGHBORS];
+    ASSERT_EQ(get_similar_books(3, recs, RECOMMEND_MAX_NEIGHBORS), 1);
+    EXPECT_EQ(recs[0].book_id, 1);
+
+    close_borrow_index();
+    close_recommendations();
+    free_reminder_scheduler();
+    unlink(BORROW_INDEX_PATH);
+    unlink(RECOMMEND_PATH);
+    rmdir("database");
+    ASSERT_EQ(chdir(cwd), 0);
+    rmdir(dir);
+}
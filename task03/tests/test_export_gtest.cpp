@@ -0,0 +1,185 @@
+/**
+ * @file test_export_gtest.cpp
+ * @brief Google Test based unit tests for the table export
+ * 
+ * Covers CSV quoting and NULLs, JSON Lines escaping, gzip output, tables
+ * larger than the write buffer and unknown tables or formats.
+ */
+
+#include <gtest/gtest.h>
+#include <sqlite3.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cstdio>
+#include <string>
+
+extern "C" {
+    #include "../include/database.h"
+    #include "../include/book.h"
+    #include "../include/export.h"
+}
+
+#ifdef HAVE_ZLIB
+#include <zlib.h>
+#endif
+
+// Test fixture class for the export
+class ExportTest : public ::testing::Test {
+protected:
+    sqlite3* test_db;
+    sqlite3* saved_db;
+
+    // Setup: Create in-memory database with two books and two loans
+    void SetUp() override {
+        test_db = nullptr;
+        saved_db = get_db_connection();
+
+        int rc = sqlite3_open(":memory:", &test_db);
+        ASSERT_EQ(rc, SQLITE_OK) << "Failed to open in-memory database";
+
+        set_db_connection(test_db);
+        ASSERT_EQ(create_tables(), 0);
+        ASSERT_EQ(migrate_schema(), 0);
+        ASSERT_EQ(create_indexes(), 0);
+        set_quiet_mode(1);
+
+        ASSERT_EQ(add_book("Dune, Part \"One\"", "Herbert", "Chilton", 1965, "B1", "SF", 2), 0);
+        ASSERT_EQ(add_book("토지", "박경리\n(전집)", "Maroniebooks", 1994, "B2", "소설", 1), 0);
+        ASSERT_EQ(sqlite3_exec(test_db,
+                               "INSERT INTO Loans (book_id, member_id, loan_date, due_date, is_returned, copy_id) "
+                               "VALUES (1, 1, '2024-03-01', '2024-03-15', 1, NULL), "
+                               "(2, 1, '2024-03-02', '2024-03-16', 0, 7);",
+                               nullptr, nullptr, nullptr), SQLITE_OK);
+    }
+
+    // Teardown: Close database after each test
+    void TearDown() override {
+        set_quiet_mode(0);
+        set_db_connection(saved_db);
+
+        if (test_db) {
+            sqlite3_close(test_db);
+            test_db = nullptr;
+        }
+    }
+
+    // Export a table into memory
+    std::string export_text(const char* table, ExportFormat format, long long* rows = nullptr,
+                            ExportStats* stats = nullptr) {
+        FILE* out = tmpfile();
+        long long result = export_table(test_db, table, format, 0, out, stats);
+        if (rows != nullptr) {
+            *rows = result;
+        }
+
+        std::string text;
+        char buffer[4096];
+        rewind(out);
+        size_t n;
+        while ((n = fread(buffer, 1, sizeof(buffer), out)) > 0) {
+            text.append(buffer, n);
+        }
+        fclose(out);
+        return text;
+    }
+};
+
+// Test: CSV has a header, quotes fields with commas, quotes or newlines and leaves NULL empty
+TEST_F(ExportTest, CsvQuotingAndNulls) {
+    long long rows;
+    std::string books = export_text("books", EXPORT_FORMAT_CSV, &rows);
+    EXPECT_EQ(rows, 2);
+    EXPECT_EQ(books,
+              "book_id,title,author,publisher,publication_year,isbn,genre,quantity,available\r\n"
+              "1,\"Dune, Part \"\"One\"\"\",Herbert,Chilton,1965,B1,SF,2,2\r\n"
+              "2,토지,\"박경리\n(전집)\",Maroniebooks,1994,B2,소설,1,1\r\n");
+
+    std::string loans = export_text("loans", EXPORT_FORMAT_CSV, &rows);
+    EXPECT_EQ(rows, 2);
+    EXPECT_NE(loans.find("\r\n1,1,1,2024-03-01,2024-03-15,1,\r\n"), std::string::npos);
+    EXPECT_NE(loans.find("\r\n2,2,1,2024-03-02,2024-03-16,0,7\r\n"), std::string::npos);
+}
+
+// Test: JSON Lines escape strings, keep numbers unquoted and write NULL as null
+TEST_F(ExportTest, JsonLines) {
+    long long rows;
+    std::string books = export_text("books", EXPORT_FORMAT_JSONL, &rows);
+    EXPECT_EQ(rows, 2);
+    EXPECT_EQ(books,
+              "{\"book_id\":1,\"title\":\"Dune, Part \\\"One\\\"\",\"author\":\"Herbert\",\"publisher\":\"Chilton\","
+              "\"publication_year\":1965,\"isbn\":\"B1\",\"genre\":\"SF\",\"quantity\":2,\"available\":2}\n"
+              "{\"book_id\":2,\"title\":\"토지\",\"author\":\"박경리\\n(전집)\",\"publisher\":\"Maroniebooks\","
+              "\"publication_year\":1994,\"isbn\":\"B2\",\"genre\":\"소설\",\"quantity\":1,\"available\":1}\n");
+
+    std::string loans = export_text("loans", EXPORT_FORMAT_JSONL);
+    EXPECT_NE(loans.find("\"is_returned\":1,\"copy_id\":null}\n"), std::string::npos);
+}
+
+// Test: a table larger than the write buffer streams through it completely
+TEST_F(ExportTest, LargerThanBuffer) {
+    ASSERT_EQ(sqlite3_exec(test_db,
+                           "WITH RECURSIVE n(i) AS (SELECT 1 UNION ALL SELECT i + 1 FROM n WHERE i < 50000) "
+                           "INSERT INTO Loans (book_id, member_id, loan_date, due_date, is_returned) "
+                           "SELECT 1 + i % 2, 1, '2024-03-01', '2024-03-15', 1 FROM n;",
+                           nullptr, nullptr, nullptr), SQLITE_OK);
+
+    long long rows;
+    ExportStats stats;
+    std::string loans = export_text("loans", EXPORT_FORMAT_JSONL, &rows, &stats);
+    EXPECT_EQ(rows, 50002);
+    EXPECT_EQ(stats.rows, 50002);
+    EXPECT_GT(stats.bytes, (long long)EXPORT_BUFFER_SIZE);
+    EXPECT_EQ(stats.written, stats.bytes);
+    EXPECT_EQ((long long)loans.size(), stats.bytes);
+    EXPECT_EQ(std::count(loans.begin(), loans.end(), '\n'), 50002);
+    EXPECT_NE(loans.find("{\"loan_id\":50002,"), std::string::npos);
+}
+
+// Test: unknown tables and formats are rejected
+TEST_F(ExportTest, UnknownTableAndFormat) {
+    FILE* out = tmpfile();
+    EXPECT_EQ(export_table(test_db, "Books; DROP TABLE Books", EXPORT_FORMAT_CSV, 0, out, nullptr), -1);
+    EXPECT_EQ(export_table(test_db, "copies", EXPORT_FORMAT_CSV, 0, out, nullptr), -1);
+    fclose(out);
+
+    EXPECT_EQ(export_parse_format("csv"), EXPORT_FORMAT_CSV);
+    EXPECT_EQ(export_parse_format("jsonl"), EXPORT_FORMAT_JSONL);
+    EXPECT_EQ(export_parse_format("xml"), -1);
+    EXPECT_EQ(export_table_to_path(test_db, "books", EXPORT_FORMAT_CSV, 0, "/nonexistent/dir/books.csv", nullptr), -1);
+}
+
+#ifdef HAVE_ZLIB
+// Test: gzip output decompresses to the plain export
+TEST_F(ExportTest, GzipMatchesPlain) {
+    ASSERT_EQ(sqlite3_exec(test_db,
+                           "WITH RECURSIVE n(i) AS (SELECT 1 UNION ALL SELECT i + 1 FROM n WHERE i < 30000) "
+                           "INSERT INTO Loans (book_id, member_id, loan_date, due_date, is_returned) "
+                           "SELECT 1 + i % 2, i % 97, date('2024-01-01', '+' || (i % 300) || ' days'), "
+                           "'2024-12-31', i % 3 = 0 FROM n;",
+                           nullptr, nullptr, nullptr), SQLITE_OK);
+    std::string plain = export_text("loans", EXPORT_FORMAT_CSV);
+
+    char path[] = "/tmp/test_exportXXXXXX";
+    int fd = mkstemp(path);
+    ASSERT_GE(fd, 0);
+    close(fd);
+
+    ExportStats stats;
+    ASSERT_EQ(export_table_to_path(test_db, "loans", EXPORT_FORMAT_CSV, 1, path, &stats), 30002);
+    EXPECT_EQ(stats.bytes, (long long)plain.size());
+    EXPECT_LT(stats.written, stats.bytes / 4);
+
+    gzFile gz = gzopen(path, "rb");
+    ASSERT_NE(gz, nullptr);
+    std::string unpacked;
+    char buffer[8192];
+    int n;
+    while ((n = gzread(gz, buffer, sizeof(buffer))) > 0) {
+        unpacked.append(buffer, (size_t)n);
+    }
+    gzclose(gz);
+    unlink(path);
+
+    EXPECT_EQ(unpacked, plain);
+}
+#endif
@@ -0,0 +1,200 @@
+/**
+ * @file test_hangul_gtest.cpp
+ * @brief Google Test based unit tests for the Hangul search key module
+ * 
+ * Covers chosung/jamo key generation, query classification and the
+ * indexed chosung/jamo searches in search_book and search_member_by_name.
+ */
+
+#include <gtest/gtest.h>
+#include <sqlite3.h>
+#include <string>
+
+extern "C" {
+    #include "../include/database.h"
+    #include "../include/book.h"
+    #include "../include/member.h"
+    #include "../include/hangul.h"
+}
+
+// Helper function to build a key as std::string
+static std::string chosung(const char* text) {
+    char key[HANGUL_KEY_LEN];
+    hangul_chosung_key(text, key, sizeof(key));
+    return key;
+}
+
+static std::string jamo(const char* text) {
+    char key[HANGUL_KEY_LEN];
+    hangul_jamo_key(text, key, sizeof(key));
+    return key;
+}
+
+// ============================================================================
+// Test Suite 1: key generation
+// ============================================================================
+
+TEST(HangulKeyTest, ChosungOfSyllables) {
+    EXPECT_EQ(chosung("한국사"), "ㅎㄱㅅ");
+    EXPECT_EQ(chosung("한국사 이야기"), "ㅎㄱㅅㅇㅇㄱ") << "Spaces are dropped";
+    EXPECT_EQ(chosung("까치"), "ㄲㅊ");
+}
+
+TEST(HangulKeyTest, ChosungKeepsOtherText) {
+    EXPECT_EQ(chosung("C언어 Programming"), "cㅇㅇprogramming");
+    EXPECT_EQ(chosung(nullptr), "");
+}
+
+TEST(HangulKeyTest, JamoSplitsCompounds) {
+    EXPECT_EQ(jamo("한"), "ㅎㅏㄴ");
+    EXPECT_EQ(jamo("닭"), "ㄷㅏㄹㄱ") << "Compound final consonant";
+    EXPECT_EQ(jamo("과"), "ㄱㅗㅏ") << "Compound vowel";
+}
+
+TEST(HangulKeyTest, PartialSyllableIsPrefix) {
+    std::string full = jamo("한국사");
+    EXPECT_EQ(full.rfind(jamo("한ㄱ"), 0), 0u);
+    EXPECT_EQ(full.rfind(jamo("한구"), 0), 0u);
+    EXPECT_EQ(jamo("달").compare(0, std::string::npos, jamo("닭"), 0, jamo("달").size()), 0);
+}
+
+TEST(HangulKeyTest, TruncatesAtCharacterBoundary) {
+    char key[8];
+    EXPECT_EQ(hangul_chosung_key("한국사", key, sizeof(key)), 6) << "Only two 3-byte jamo fit";
+    EXPECT_STREQ(key, "ㅎㄱ");
+}
+
+TEST(HangulKeyTest, QueryKind) {
+    EXPECT_EQ(hangul_query_kind("ㅎㄱㅅ"), HANGUL_QUERY_CHOSUNG);
+    EXPECT_EQ(hangul_query_kind("ㅎㄱ ㅅ"), HANGUL_QUERY_CHOSUNG);
+    EXPECT_EQ(hangul_query_kind("한ㄱ"), HANGUL_QUERY_JAMO);
+    EXPECT_EQ(hangul_query_kind("한국사"), HANGUL_QUERY_PLAIN);
+    EXPECT_EQ(hangul_query_kind("Hobbit"), HANGUL_QUERY_PLAIN);
+}
+
+// ============================================================================
+// Test Suite 2: indexed search
+// ============================================================================
+
+// Test fixture class for chosung/jamo search against the database
+class HangulSearchTest : public ::testing::Test {
+protected:
+    sqlite3* test_db;
+    sqlite3* saved_db;
+
+    // Setup: Create in-memory database with the full schema before each test
+    void SetUp() override {
+        test_db = nullptr;
+        saved_db = get_db_connection();
+
+        int rc = sqlite3_open(":memory:", &test_db);
+        ASSERT_EQ(rc, SQLITE_OK) << "Failed to open in-memory database";
+
+        set_db_connection(test_db);
+        ASSERT_EQ(create_tables(), 0);
+        ASSERT_EQ(migrate_schema(), 0);
+        ASSERT_EQ(create_indexes(), 0);
+
+        ASSERT_EQ(add_book("한국사 이야기", "이이화", "한길사", 1998, "0001", "역사", 1), 0);
+        ASSERT_EQ(add_book("한국 현대사", "서중석", "웅진", 2007, "0002", "역사", 1), 0);
+        ASSERT_EQ(add_book("토지", "박경리", "마로니에북스", 2012, "0003", "소설", 1), 0);
+
+        ASSERT_GT(add_member(test_db, "홍길동", "010-1111-1111", "서울"), 0);
+        ASSERT_GT(add_member(test_db, "홍길순", "010-2222-2222", "부산"), 0);
+        ASSERT_GT(add_member(test_db, "김철수", "010-3333-3333", "대구"), 0);
+    }
+
+    // Teardown: Close database after each test
+    void TearDown() override {
+        set_db_connection(saved_db);
+
+        if (test_db) {
+            sqlite3_close(test_db);
+            test_db = nullptr;
+        }
+    }
+
+    // Helper function to check that a query is answered from an index
+    bool uses_index(const char* sql, const char* index_name) {
+        std::string explain = std::string("EXPLAIN QUERY PLAN ") + sql;
+        sqlite3_stmt* stmt;
+        bool found = false;
+
+        if (sqlite3_prepare_v2(test_db, explain.c_str(), -1, &stmt, nullptr) == SQLITE_OK) {
+            sqlite3_bind_text(stmt, 1, "ㅎ", -1, SQLITE_STATIC);
+            sqlite3_bind_text(stmt, 2, "ㅎ\xFF", -1, SQLITE_STATIC);
+            while (sqlite3_step(stmt) == SQLITE_ROW) {
+                const char* detail = (const char*)sqlite3_column_text(stmt, 3);
+                if (detail && std::string(detail).find(index_name) != std::string::npos) {
+                    found = true;
+                }
+            }
+            sqlite3_finalize(stmt);
+        }
+        return found;
+    }
+};
+
+TEST_F(HangulSearchTest, SearchBookByChosung) {
+    EXPECT_EQ(search_book("ㅎㄱㅅ"), 1);
+    EXPECT_EQ(search_book("ㅎㄱ"), 2);
+    EXPECT_EQ(search_book("ㅂㄱㄹ"), 1) << "Author chosung";
+}
+
+TEST_F(HangulSearchTest, SearchBookByPartialJamo) {
+    EXPECT_EQ(search_book("한ㄱ"), 2);
+    EXPECT_EQ(search_book("토ㅈ"), 1);
+}
+
+TEST_F(HangulSearchTest, SearchBookPlainStillUsesLike) {
+    EXPECT_EQ(search_book("현대"), 1);
+}
+
+TEST_F(HangulSearchTest, SearchMemberByChosungAndJamo) {
+    Member members[10];
+    EXPECT_EQ(search_member_by_name(test_db, "ㅎㄱㄷ", members, 10), 1);
+    EXPECT_STREQ(members[0].name, "홍길동");
+
+    EXPECT_EQ(search_member_by_name(test_db, "ㅎㄱ", members, 10), 2);
+    EXPECT_EQ(search_member_by_name(test_db, "홍길", members, 10), 2) << "Plain text still uses LIKE";
+    EXPECT_EQ(search_member_by_name(test_db, "홍길ㅅ", members, 10), 1);
+    EXPECT_STREQ(members[0].name, "홍길순");
+}
+
+TEST_F(HangulSearchTest, UpdateRefreshesKeys) {
+    ASSERT_EQ(update_book(3, "태백산맥", NULL, NULL, 0, NULL), 0);
+    EXPECT_EQ(search_book("ㅌㅂㅅㅁ"), 1);
+    EXPECT_EQ(search_book("ㅌㅈ"), 0);
+
+    ASSERT_EQ(update_member(test_db, 3, "김영희", NULL, NULL), 0);
+    Member members[10];
+    EXPECT_EQ(search_member_by_name(test_db, "ㄱㅇㅎ", members, 10), 1);
+}
+
+TEST_F(HangulSearchTest, MigrationBackfillsExistingRows) {
+    ASSERT_EQ(sqlite3_exec(test_db, "INSERT INTO Members (name, phone, address, registration_date) "
+                           "VALUES ('이순신', '', '', '2024-01-01');",
+                           nullptr, nullptr, nullptr), SQLITE_OK);
+
+    ASSERT_EQ(migrate_schema(), 0);
+
+    Member members[10];
+    EXPECT_EQ(search_member_by_name(test_db, "ㅇㅅㅅ", members, 10), 1);
+}
+
+TEST_F(HangulSearchTest, ChosungQueriesUseIndexes) {
+    EXPECT_TRUE(uses_index("SELECT member_id FROM Members WHERE name_chosung >= ? AND name_chosung < ?;",
+                           "idx_members_name_chosung"));
+    EXPECT_TRUE(uses_index("SELECT book_id FROM Books WHERE (title_chosung >= ?1 AND title_chosung < ?2) "
+                           "OR (author_chosung >= ?1 AND author_chosung < ?2);",
+                           "idx_books_title_chosung"));
+}
+
+// ============================================================================
+// Main function
+// ============================================================================
+
+int main(int argc, char** argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,322 @@
+/**
+ * @file test_http_server_gtest.cpp
+ * @brief Google Test based unit tests for the embedded HTTP server
+ * 
+ * Starts the server on a temporary database file and talks to it over
+ * loopback sockets: the endpoints, keep-alive and pipelined requests,
+ * and the error responses.
+ */
+
+#include <gtest/gtest.h>
+#include <sqlite3.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+extern "C" {
+    #include "../include/database.h"
+    #include "../include/book.h"
+    #include "../include/member.h"
+    #include "../include/loan.h"
+    #include "../include/http_server.h"
+    #include "../include/result_cache.h"
+}
+
+// One parsed response
+struct HttpResponse {
+    int status;
+    std::string headers;
+    std::string body;
+};
+
+// Test fixture class for the HTTP server
+class HttpServerTest : public ::testing::Test {
+protected:
+    sqlite3* test_db;
+    sqlite3* saved_db;
+    char db_path[64];
+
+    // Setup: Create a database file with two books and a member, then start the server
+    void SetUp() override {
+        test_db = nullptr;
+        saved_db = get_db_connection();
+
+        strcpy(db_path, "/tmp/test_http_serverXXXXXX");
+        int fd = mkstemp(db_path);
+        ASSERT_GE(fd, 0);
+        close(fd);
+
+        int rc = sqlite3_open(db_path, &test_db);
+        ASSERT_EQ(rc, SQLITE_OK) << "Failed to open database file";
+
+        set_db_connection(test_db);
+        ASSERT_EQ(create_tables(), 0);
+        ASSERT_EQ(migrate_schema(), 0);
+        ASSERT_EQ(create_indexes(), 0);
+        set_quiet_mode(1);
+
+        ASSERT_EQ(add_book("Dune", "Frank Herbert", "Chilton", 1965, "9780306406157", "SF", 1), 0);
+        ASSERT_EQ(add_book("Emma \"Classic\"", "Jane Austen", "Murray", 1815, "B2", "Novel", 3), 0);
+        ASSERT_EQ(add_member(test_db, "Reader", "", ""), 1);
+
+        HttpServerConfig config = {db_path, nullptr, 0, 2, RESULT_CACHE_DEFAULT_BUDGET};
+        ASSERT_EQ(http_server_start(&config), 0);
+        ASSERT_GT(http_server_port(), 0);
+    }
+
+    // Teardown: Stop the server and remove the database files
+    void TearDown() override {
+        http_server_stop();
+        set_quiet_mode(0);
+        set_db_connection(saved_db);
+
+        if (test_db) {
+            sqlite3_close(test_db);
+            test_db = nullptr;
+        }
+        unlink(db_path);
+        unlink((std::string(db_path) + "-wal").c_str());
+        unlink((std::string(db_path) + "-shm").c_str());
+    }
+
+    static int connect_client() {
+        int fd = socket(AF_INET, SOCK_STREAM, 0);
+        struct sockaddr_in addr;
+        memset(&addr, 0, sizeof(addr));
+        addr.sin_family = AF_INET;
+        addr.sin_port = htons((uint16_t)http_server_port());
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        if (connect(fd, (struct sockaddr*)&addr, sizeof(addr)) != 0) {
+            close(fd);
+            return -1;
+        }
+        return fd;
+    }
+
+    static void send_all(int fd, const std::string& data) {
+        size_t sent = 0;
+        while (sent < data.size()) {
+            ssize_t n = send(fd, data.data() + sent, data.size() - sent, MSG_NOSIGNAL);
+            if (n <= 0) {
+                return;
+            }
+            sent += (size_t)n;
+        }
+    }
+
+    // Read one response; pending holds bytes already received after it
+    static HttpResponse read_response(int fd, std::string& pending) {
+        HttpResponse response = {-1, "", ""};
+        char buffer[4096];
+        size_t header_end;
+        while ((header_end = pending.find("\r\n\r\n")) == std::string::npos) {
+            ssize_t n = recv(fd, buffer, sizeof(buffer), 0);
+            if (n <= 0) {
+                return response;
+            }
+            pending.append(buffer, (size_t)n);
+        }
+        response.headers = pending.substr(0, header_end + 4);
+        sscanf(response.headers.c_str(), "HTTP/1.1 %d", &response.status);
+
+        size_t length = 0;
+        size_t field = response.headers.find("Content-Length: ");
+        if (field != std::string::npos) {
+            length = strtoul(response.headers.c_str() + field + 16, nullptr, 10);
+        }
+        while (pending.size() < header_end + 4 + length) {
+            ssize_t n = recv(fd, buffer, sizeof(buffer), 0);
+            if (n <= 0) {
+                break;
+            }
+            pending.append(buffer, (size_t)n);
+        }
+        response.body = pending.substr(header_end + 4, length);
+        pending.erase(0, header_end + 4 + length);
+        return response;
+    }
+
+    // Send one request on a new connection
+    static HttpResponse request(const std::string& method, const std::string& target,
+                                const std::string& body = "") {
+        int fd = connect_client();
+        std::string raw = method + " " + target + " HTTP/1.1\r\nHost: test\r\n";
+        if (!body.empty()) {
+            raw += "Content-Type: application/json\r\nContent-Length: " + std::to_string(body.size()) + "\r\n";
+        }
+        raw += "\r\n" + body;
+        send_all(fd, raw);
+        std::string pending;
+        HttpResponse response = read_response(fd, pending);
+        close(fd);
+        return response;
+    }
+};
+
+// Test: health check and book lookup
+TEST_F(HttpServerTest, HealthAndLookup) {
+    HttpResponse health = request("GET", "/health");
+    EXPECT_EQ(health.status, 200);
+    EXPECT_EQ(health.body, "{\"status\":\"ok\"}");
+    EXPECT_NE(health.headers.find("Content-Type: application/json"), std::string::npos);
+
+    HttpResponse book = request("GET", "/books/2");
+    EXPECT_EQ(book.status, 200);
+    EXPECT_NE(book.body.find("\"title\":\"Emma \\\"Classic\\\"\""), std::string::npos) << book.body;
+    EXPECT_NE(book.body.find("\"available\":3"), std::string::npos);
+
+    EXPECT_EQ(request("GET", "/books/99").status, 404);
+    EXPECT_EQ(request("GET", "/books/abc").status, 400);
+}
+
+// Test: search by text, URL-encoded text and ISBN
+TEST_F(HttpServerTest, Search) {
+    HttpResponse by_author = request("GET", "/books?q=jane+austen");
+    EXPECT_EQ(by_author.status, 200);
+    EXPECT_NE(by_author.body.find("\"book_id\":2"), std::string::npos);
+    EXPECT_NE(by_author.body.find("\"count\":1"), std::string::npos);
+
+    HttpResponse by_isbn = request("GET", "/books?q=978-0-306-40615-7");
+    EXPECT_NE(by_isbn.body.find("\"title\":\"Dune\""), std::string::npos) << by_isbn.body;
+
+    HttpResponse limited = request("GET", "/books?q=%25&limit=1");
+    EXPECT_NE(limited.body.find("\"count\":1"), std::string::npos) << limited.body;
+
+    EXPECT_EQ(request("GET", "/books").status, 400);
+    EXPECT_EQ(request("GET", "/books?q=a&limit=-3").status, 400);
+}
+
+// Test: loan and return through JSON and query string parameters
+TEST_F(HttpServerTest, LoanAndReturn) {
+    // Cached by whichever worker answers; the loan must invalidate it
+    EXPECT_NE(request("GET", "/books/1").body.find("\"available\":1"), std::string::npos);
+    EXPECT_NE(request("GET", "/books/1").body.find("\"available\":1"), std::string::npos);
+
+    HttpResponse loan = request("POST", "/loans", "{\"book_id\": 1, \"member_id\": 1, \"days\": 7}");
+    EXPECT_EQ(loan.status, 201);
+    EXPECT_EQ(loan.body, "{\"loan_id\":1}");
+
+    // The only copy is out
+    EXPECT_EQ(request("POST", "/loans?book_id=1&member_id=1").status, 409);
+    EXPECT_NE(request("GET", "/books/1").body.find("\"available\":0"), std::string::npos);
+
+    HttpResponse popular = request("GET", "/reports/popular?limit=1");
+    EXPECT_NE(popular.body.find("\"loan_count\":1"), std::string::npos) << popular.body;
+
+    HttpResponse returned = request("POST", "/returns?loan_id=1");
+    EXPECT_EQ(returned.status, 201);
+    EXPECT_EQ(request("POST", "/returns?loan_id=1").status, 409);
+
+    EXPECT_EQ(request("POST", "/loans", "{\"book_id\":1}").status, 400);
+    EXPECT_EQ(request("GET", "/loans").status, 405);
+}
+
+// Test: repeated reads are served from the workers' result caches
+TEST_F(HttpServerTest, ResultCache) {
+    for (int i = 0; i < 6; i++) {
+        EXPECT_EQ(request("GET", "/books?q=Austen").status, 200);
+    }
+
+    HttpServerStats stats;
+    ASSERT_EQ(http_server_stats(&stats), 0);
+    EXPECT_GE(stats.cache_misses, 1);
+    EXPECT_LE(stats.cache_misses, 2);      // at most once per worker
+    EXPECT_EQ(stats.cache_hits + stats.cache_misses, 6);
+
+    // A write through another connection is seen on the next read
+    ASSERT_EQ(sqlite3_exec(test_db, "UPDATE Books SET author = 'J. Austen' WHERE book_id = 2;",
+                           nullptr, nullptr, nullptr), SQLITE_OK);
+    EXPECT_NE(request("GET", "/books?q=Austen").body.find("\"author\":\"J. Austen\""), std::string::npos);
+}
+
+// Test: overdue report lists loans past their due date
+TEST_F(HttpServerTest, OverdueReport) {
+    ASSERT_EQ(sqlite3_exec(test_db,
+                           "INSERT INTO Loans (book_id, member_id, loan_date, due_date, is_returned) "
+                           "VALUES (2, 1, '2020-01-01', '2020-01-15', 0);",
+                           nullptr, nullptr, nullptr), SQLITE_OK);
+
+    HttpResponse report = request("GET", "/reports/overdue");
+    EXPECT_EQ(report.status, 200);
+    EXPECT_NE(report.body.find("\"due_date\":\"2020-01-15\""), std::string::npos) << report.body;
+    EXPECT_NE(report.body.find("\"member\":\"Reader\""), std::string::npos);
+    EXPECT_NE(report.body.find("\"count\":1"), std::string::npos);
+}
+
+// Test: several requests on one kept-alive connection, two of them pipelined
+TEST_F(HttpServerTest, KeepAliveAndPipelining) {
+    int fd = connect_client();
+    ASSERT_GE(fd, 0);
+    std::string pending;
+
+    send_all(fd, "GET /health HTTP/1.1\r\n\r\n");
+    HttpResponse first = read_response(fd, pending);
+    EXPECT_EQ(first.status, 200);
+    EXPECT_NE(first.headers.find("Connection: keep-alive"), std::string::npos);
+
+    send_all(fd, "GET /books/1 HTTP/1.1\r\n\r\nPOST /loans HTTP/1.1\r\nContent-Length: 24\r\n\r\n"
+                 "book_id=2&member_id=1&x=");
+    HttpResponse second = read_response(fd, pending);
+    HttpResponse third = read_response(fd, pending);
+    EXPECT_EQ(second.status, 200);
+    EXPECT_NE(second.body.find("\"book_id\":1"), std::string::npos);
+    EXPECT_EQ(third.status, 201) << third.body;
+
+    send_all(fd, "GET /health HTTP/1.1\r\nConnection: close\r\n\r\n");
+    HttpResponse last = read_response(fd, pending);
+    EXPECT_EQ(last.status, 200);
+    EXPECT_NE(last.headers.find("Connection: close"), std::string::npos);
+
+    char byte;
+    EXPECT_EQ(recv(fd, &byte, 1, 0), 0);    // server closed the connection
+    close(fd);
+
+    HttpServerStats stats;
+    ASSERT_EQ(http_server_stats(&stats), 0);
+    EXPECT_EQ(stats.connections, 1);
+    EXPECT_EQ(stats.requests, 4);
+    EXPECT_EQ(stats.errors, 0);
+}
+
+// Test: malformed, oversized and unknown requests
+TEST_F(HttpServerTest, ErrorResponses) {
+    EXPECT_EQ(request("GET", "/nowhere").status, 404);
+
+    int fd = connect_client();
+    std::string pending;
+    send_all(fd, "garbage\r\n\r\n");
+    EXPECT_EQ(read_response(fd, pending).status, 400);
+    close(fd);
+
+    fd = connect_client();
+    pending.clear();
+    send_all(fd, "POST /loans HTTP/1.1\r\nTransfer-Encoding: chunked\r\n\r\n");
+    EXPECT_EQ(read_response(fd, pending).status, 501);
+    close(fd);
+
+    fd = connect_client();
+    pending.clear();
+    // Exactly fills the request buffer, so the server reads everything before closing
+    std::string start = "GET /health HTTP/1.1\r\nX-Filler: ";
+    send_all(fd, start + std::string(HTTP_MAX_REQUEST - start.size(), 'x'));
+    HttpResponse too_large = read_response(fd, pending);
+    EXPECT_EQ(too_large.status, 413);
+    EXPECT_NE(too_large.headers.find("Connection: close"), std::string::npos);
+    close(fd);
+
+    HttpServerStats stats;
+    ASSERT_EQ(http_server_stats(&stats), 0);
+    EXPECT_EQ(stats.errors, 4);
+}
+
+// Test: a second server cannot start while one is running
+TEST_F(HttpServerTest, SingleInstance) {
+    HttpServerConfig config = {db_path, nullptr, 0, 1, 0};
+    EXPECT_EQ(http_server_start(&config), -1);
+    EXPECT_EQ(request("GET", "/health").status, 200);
+}
@@ -0,0 +1,165 @@
+/**
+ * @file test_isbn_gtest.cpp
+ * @brief Google Test based unit tests for the ISBN module
+ * 
+ * Covers ISBN-10/13 parsing and check digits, the canonical key used by
+ * the isbn13 column and the exact ISBN lookups in book.c.
+ */
+
+#include <gtest/gtest.h>
+#include <sqlite3.h>
+#include <string>
+
+extern "C" {
+    #include "../include/database.h"
+    #include "../include/book.h"
+    #include "../include/isbn.h"
+}
+
+// ============================================================================
+// Test Suite 1: parsing
+// ============================================================================
+
+TEST(IsbnParseTest, Isbn13) {
+    EXPECT_EQ(isbn_parse("9788937460449"), 9788937460449LL);
+    EXPECT_EQ(isbn_parse("978-89-374-6044-9"), 9788937460449LL);
+    EXPECT_EQ(isbn_parse("  978 89 374 6044 9"), 9788937460449LL);
+    EXPECT_EQ(isbn_parse("9791191000009"), 9791191000009LL) << "979 prefix";
+}
+
+TEST(IsbnParseTest, Isbn10IsConvertedTo13) {
+    EXPECT_EQ(isbn_parse("0-306-40615-2"), 9780306406157LL);
+    EXPECT_EQ(isbn_parse("0306406152"), isbn_parse("978-0-306-40615-7"));
+    EXPECT_EQ(isbn_parse("0-8044-2957-X"), 9780804429573LL);
+    EXPECT_EQ(isbn_parse("080442957x"), 9780804429573LL) << "Lower-case check digit";
+}
+
+TEST(IsbnParseTest, Labels) {
+    EXPECT_EQ(isbn_parse("ISBN 978-0-306-40615-7"), 9780306406157LL);
+    EXPECT_EQ(isbn_parse("ISBN-13: 978-0-306-40615-7"), 9780306406157LL);
+    EXPECT_EQ(isbn_parse("isbn-10 0-306-40615-2"), 9780306406157LL);
+    EXPECT_EQ(isbn_parse("ISBN:0306406152"), 9780306406157LL);
+}
+
+TEST(IsbnParseTest, RejectsBadInput) {
+    EXPECT_EQ(isbn_parse(nullptr), ISBN_INVALID);
+    EXPECT_EQ(isbn_parse(""), ISBN_INVALID);
+    EXPECT_EQ(isbn_parse("978-0-306-40615-8"), ISBN_INVALID) << "Wrong ISBN-13 check digit";
+    EXPECT_EQ(isbn_parse("0-306-40615-3"), ISBN_INVALID) << "Wrong ISBN-10 check digit";
+    EXPECT_EQ(isbn_parse("1234567890"), ISBN_INVALID);
+    EXPECT_EQ(isbn_parse("0001"), ISBN_INVALID);
+    EXPECT_EQ(isbn_parse("123456789012X"), ISBN_INVALID) << "X only ends an ISBN-10";
+    EXPECT_EQ(isbn_parse("X306406152"), ISBN_INVALID);
+    EXPECT_EQ(isbn_parse("1230000000002"), ISBN_INVALID) << "Not a 978/979 prefix";
+    EXPECT_EQ(isbn_parse("97803064061570"), ISBN_INVALID) << "Too many digits";
+    EXPECT_EQ(isbn_parse("978-0-306-4061a-7"), ISBN_INVALID);
+}
+
+TEST(IsbnParseTest, FormatRoundTrip) {
+    char text[20];
+    ASSERT_EQ(isbn_format(isbn_parse("0-306-40615-2"), text, sizeof(text)), 0);
+    EXPECT_STREQ(text, "9780306406157");
+    EXPECT_EQ(isbn_format(9780306406158LL, text, sizeof(text)), -1);
+    EXPECT_EQ(isbn_format(ISBN_INVALID, text, sizeof(text)), -1);
+    EXPECT_EQ(isbn_format(9780306406157LL, text, 13), -1) << "No room for the terminator";
+}
+
+// ============================================================================
+// Test Suite 2: indexed lookup
+// ============================================================================
+
+// Test fixture class for ISBN lookups against the database
+class IsbnLookupTest : public ::testing::Test {
+protected:
+    sqlite3* test_db;
+    sqlite3* saved_db;
+
+    // Setup: Create in-memory database with the full schema before each test
+    void SetUp() override {
+        test_db = nullptr;
+        saved_db = get_db_connection();
+
+        int rc = sqlite3_open(":memory:", &test_db);
+        ASSERT_EQ(rc, SQLITE_OK) << "Failed to open in-memory database";
+
+        set_db_connection(test_db);
+        ASSERT_EQ(create_tables(), 0);
+        ASSERT_EQ(migrate_schema(), 0);
+        ASSERT_EQ(create_indexes(), 0);
+
+        ASSERT_EQ(add_book("The Art of Computer Programming", "Knuth", "", 1968,
+                           "0-306-40615-2", "CS", 1), 0);
+        ASSERT_EQ(add_book("데미안", "헤르만 헤세", "민음사", 2000, "978-89-374-6044-9", "소설", 1), 0);
+        ASSERT_EQ(add_book("Local Catalogue", "", "", 2000, "LOCAL-0001", "", 1), 0);
+    }
+
+    // Teardown: Close database after each test
+    void TearDown() override {
+        set_db_connection(saved_db);
+
+        if (test_db) {
+            sqlite3_close(test_db);
+            test_db = nullptr;
+        }
+    }
+};
+
+TEST_F(IsbnLookupTest, FindAcceptsAnySpelling) {
+    EXPECT_EQ(find_book_by_isbn("0306406152"), 1);
+    EXPECT_EQ(find_book_by_isbn("978-0-306-40615-7"), 1) << "ISBN-13 of a book stored as ISBN-10";
+    EXPECT_EQ(find_book_by_isbn("8937460440"), 2) << "ISBN-10 of a book stored as ISBN-13";
+    EXPECT_EQ(find_book_by_isbn("9780804429573"), 0);
+    EXPECT_EQ(find_book_by_isbn("LOCAL-0001"), -1);
+}
+
+TEST_F(IsbnLookupTest, SearchUsesExactKey) {
+    EXPECT_EQ(search_book("9780306406157"), 1);
+    EXPECT_EQ(search_book("ISBN 89-374-6044-0"), 1);
+    EXPECT_EQ(search_book("LOCAL"), 1) << "Non-ISBN text still matches with LIKE";
+}
+
+TEST_F(IsbnLookupTest, DuplicateSpellingIsRejected) {
+    EXPECT_EQ(add_book("Duplicate", "", "", 2000, "978-0-306-40615-7", "", 1), -1);
+    EXPECT_EQ(add_book("Other", "", "", 2000, "0-8044-2957-X", "", 1), 0);
+}
+
+TEST_F(IsbnLookupTest, MigrationBackfillsExistingRows) {
+    ASSERT_EQ(sqlite3_exec(test_db, "INSERT INTO Books (title, isbn) VALUES ('Old Row', '0-8044-2957-X');",
+                           nullptr, nullptr, nullptr), SQLITE_OK);
+    EXPECT_EQ(find_book_by_isbn("9780804429573"), 0) << "Raw insert has no key yet";
+
+    ASSERT_EQ(migrate_schema(), 0);
+
+    EXPECT_EQ(find_book_by_isbn("9780804429573"), 4);
+
+    sqlite3_stmt* stmt;
+    ASSERT_EQ(sqlite3_prepare_v2(test_db, "SELECT COUNT(*) FROM Books WHERE isbn13 IS NULL;",
+                                 -1, &stmt, nullptr), SQLITE_OK);
+    ASSERT_EQ(sqlite3_step(stmt), SQLITE_ROW);
+    EXPECT_EQ(sqlite3_column_int(stmt, 0), 0) << "Invalid ISBNs are marked, not left for the next run";
+    sqlite3_finalize(stmt);
+}
+
+TEST_F(IsbnLookupTest, LookupUsesIndex) {
+    sqlite3_stmt* stmt;
+    ASSERT_EQ(sqlite3_prepare_v2(test_db, "EXPLAIN QUERY PLAN SELECT book_id FROM Books WHERE isbn13 = ?;",
+                                 -1, &stmt, nullptr), SQLITE_OK);
+    bool found = false;
+    while (sqlite3_step(stmt) == SQLITE_ROW) {
+        const char* detail = (const char*)sqlite3_column_text(stmt, 3);
+        if (detail && std::string(detail).find("idx_books_isbn13") != std::string::npos) {
+            found = true;
+        }
+    }
+    sqlite3_finalize(stmt);
+    EXPECT_TRUE(found);
+}
+
+// ============================================================================
+// Main function
+// ============================================================================
+
+int main(int argc, char** argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,238 @@
+/**
+ * @file test_marc_gtest.cpp
+ * @brief Google Test based unit tests for the MARC21 loader
+ * 
+ * Covers field extraction and fallbacks, malformed records, loading a
+ * multi-chunk file with parser threads (duplicates, rejected records,
+ * file order) and loading inside the caller's transaction.
+ */
+
+#include <gtest/gtest.h>
+#include <sqlite3.h>
+#include <unistd.h>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+extern "C" {
+    #include "../include/database.h"
+    #include "../include/book.h"
+    #include "../include/marc.h"
+}
+
+// Test fixture class for the MARC21 loader
+class MarcTest : public ::testing::Test {
+protected:
+    sqlite3* test_db;
+    sqlite3* saved_db;
+    char path[32];
+
+    // Setup: Create in-memory database and a temporary file name
+    void SetUp() override {
+        test_db = nullptr;
+        saved_db = get_db_connection();
+
+        int rc = sqlite3_open(":memory:", &test_db);
+        ASSERT_EQ(rc, SQLITE_OK) << "Failed to open in-memory database";
+
+        set_db_connection(test_db);
+        ASSERT_EQ(create_tables(), 0);
+        ASSERT_EQ(migrate_schema(), 0);
+        ASSERT_EQ(create_indexes(), 0);
+        set_quiet_mode(1);
+
+        snprintf(path, sizeof(path), "/tmp/test_marcXXXXXX");
+        int fd = mkstemp(path);
+        ASSERT_GE(fd, 0);
+        close(fd);
+    }
+
+    // Teardown: Close database and remove the file
+    void TearDown() override {
+        unlink(path);
+        set_quiet_mode(0);
+        set_db_connection(saved_db);
+
+        if (test_db) {
+            sqlite3_close(test_db);
+            test_db = nullptr;
+        }
+    }
+
+    struct Field {
+        std::string tag;
+        std::string data;    // control field text, or indicators and "$a..." subfields
+    };
+
+    // Build an ISO 2709 record; '$' in data fields stands for the subfield delimiter
+    static std::string record(const std::vector<Field>& fields, char coding = 'a') {
+        std::string directory, data;
+        for (const Field& field : fields) {
+            std::string content = field.data;
+            for (char& c : content) {
+                if (c == '$') {
+                    c = MARC_SUBFIELD_DELIMITER;
+                }
+            }
+            content += (char)MARC_FIELD_TERMINATOR;
+            char entry[16];
+            snprintf(entry, sizeof(entry), "%s%04zu%05zu", field.tag.c_str(), content.size(), data.size());
+            directory += entry;
+            data += content;
+        }
+        directory += (char)MARC_FIELD_TERMINATOR;
+        size_t base = MARC_LEADER_LEN + directory.size();
+        size_t length = base + data.size() + 1;
+        char leader[32];
+        snprintf(leader, sizeof(leader), "%05zunam %c22%05zu   4500", length, coding, base);
+        return std::string(leader) + directory + data + (char)MARC_RECORD_TERMINATOR;
+    }
+
+    // ISBN-13 with a valid check digit from a 978 prefix and nine digits
+    static std::string isbn13(long number) {
+        char digits[16];
+        snprintf(digits, sizeof(digits), "978%09ld", number);
+        int sum = 0;
+        for (int i = 0; i < 12; i++) {
+            sum += (digits[i] - '0') * (i % 2 ? 3 : 1);
+        }
+        digits[12] = (char)('0' + (10 - sum % 10) % 10);
+        digits[13] = '\0';
+        return digits;
+    }
+
+    void write_file(const std::string& contents) {
+        FILE* file = fopen(path, "wb");
+        ASSERT_NE(file, nullptr);
+        fwrite(contents.data(), 1, contents.size(), file);
+        fclose(file);
+    }
+
+    std::string query_text(const char* sql) {
+        std::string text;
+        sqlite3_stmt* stmt;
+        if (sqlite3_prepare_v2(test_db, sql, -1, &stmt, nullptr) == SQLITE_OK) {
+            if (sqlite3_step(stmt) == SQLITE_ROW && sqlite3_column_text(stmt, 0) != nullptr) {
+                text = (const char*)sqlite3_column_text(stmt, 0);
+            }
+            sqlite3_finalize(stmt);
+        }
+        return text;
+    }
+
+    static std::string text(MarcSlice slice) {
+        return slice.text != nullptr ? std::string(slice.text, slice.length) : "(none)";
+    }
+};
+
+// Test: the book fields come from their MARC tags, with ISBD punctuation trimmed
+TEST_F(MarcTest, ParsesBookFields) {
+    std::string data = record({
+        {"001", "ocm00123456"},
+        {"008", "650101s1965    pau           000 1 eng d"},
+        {"020", "  $a9780441172719 (pbk.)$c$7.99"},
+        {"100", "1 $aHerbert, Frank,$d1920-1986."},
+        {"245", "10$aDune /$cFrank Herbert."},
+        {"264", " 1$aPhiladelphia :$bChilton Books,$c1966."},
+        {"650", " 0$aSpace warfare$vFiction."},
+        {"655", " 7$aScience fiction.$2lcgft"},
+    });
+
+    MarcRecord parsed;
+    ASSERT_EQ(marc_parse_record(data.data(), data.size(), &parsed), (int)data.size());
+    EXPECT_EQ(text(parsed.title), "Dune");
+    EXPECT_EQ(text(parsed.author), "Herbert, Frank");
+    EXPECT_EQ(text(parsed.publisher), "Chilton Books");
+    EXPECT_EQ(text(parsed.isbn), "9780441172719");
+    EXPECT_EQ(text(parsed.genre), "Science fiction");
+    EXPECT_EQ(parsed.year, 1965);    // 008 wins over 264 $c
+    EXPECT_TRUE(parsed.utf8);
+
+    // The slices point into the record itself
+    EXPECT_GE(parsed.title.text, data.data());
+    EXPECT_LT(parsed.title.text, data.data() + data.size());
+}
+
+// Test: secondary tags fill in missing fields and malformed records are refused
+TEST_F(MarcTest, FallbacksAndMalformedRecords) {
+    std::string data = record({
+        {"245", "00$a토지 :$b제1부"},
+        {"260", "  $a서울 :$b마로니에북스,$cc2012."},
+        {"650", " 0$a한국 소설."},
+        {"700", "1 $a박경리."},
+    });
+    MarcRecord parsed;
+    ASSERT_GT(marc_parse_record(data.data(), data.size(), &parsed), 0);
+    EXPECT_EQ(text(parsed.title), "토지");
+    EXPECT_EQ(text(parsed.author), "박경리");
+    EXPECT_EQ(text(parsed.publisher), "마로니에북스");
+    EXPECT_EQ(text(parsed.genre), "한국 소설");
+    EXPECT_EQ(text(parsed.isbn), "(none)");
+    EXPECT_EQ(parsed.year, 2012);
+
+    EXPECT_EQ(marc_parse_record(data.data(), data.size() - 1, &parsed), -1);    // cut short
+    std::string bad = data;
+    bad[0] = 'x';
+    EXPECT_EQ(marc_parse_record(bad.data(), bad.size(), &parsed), -1);          // length not a number
+    bad = data;
+    bad[bad.size() - 1] = ' ';
+    EXPECT_EQ(marc_parse_record(bad.data(), bad.size(), &parsed), -1);          // no record terminator
+    EXPECT_EQ(marc_parse_record("00010", 5, &parsed), -1);
+}
+
+// Test: a file of several chunks loads in file order, skipping duplicates and bad records
+TEST_F(MarcTest, LoadsFileWithParserThreads) {
+    std::string contents;
+    const int count = 9000;    // about 1.5 chunks
+    for (int i = 0; i < count; i++) {
+        if (i == 4000) {
+            contents += "00050nam a2200025   4500garbage";    // malformed, no terminator until the next record
+            contents += (char)MARC_RECORD_TERMINATOR;
+        }
+        char title[64], year[64];
+        snprintf(title, sizeof(title), "10$aCollected Stories %d /", i);
+        snprintf(year, sizeof(year), "  $aSeoul :$bPublisher %d,$c%d.", i % 7, 1950 + i % 70);
+        contents += record({
+            {"020", "  $a" + isbn13(i % 8990)},    // the last ten repeat earlier ISBNs
+            {"100", "1 $aAuthor " + std::to_string(i % 100) + "."},
+            {"245", title},
+            {"260", year},
+        });
+    }
+    contents += record({{"245", "10$a토지."}, {"100", "1 $a박경리"}});
+    contents += record({{"245", "10$aCaf\xc3\xa9 society"}}, ' ');    // MARC-8 with non-ASCII bytes
+    contents += record({{"100", "1 $aNo Title"}});
+    write_file(contents);
+
+    MarcLoadStats stats;
+    ASSERT_EQ(load_marc_file(test_db, path, 3, &stats), 8991);
+    EXPECT_EQ(stats.records, count + 4);
+    EXPECT_EQ(stats.inserted, 8991);
+    EXPECT_EQ(stats.duplicates, 10);
+    EXPECT_EQ(stats.rejected, 3);
+    EXPECT_GT(stats.records_per_minute, 0.0);
+
+    EXPECT_EQ(query_text("SELECT title FROM Books WHERE book_id = 1;"), "Collected Stories 0");
+    EXPECT_EQ(query_text("SELECT title FROM Books WHERE book_id = 8990;"), "Collected Stories 8989");
+    EXPECT_EQ(query_text("SELECT publisher || '|' || publication_year || '|' || quantity || '|' || available "
+                         "FROM Books WHERE book_id = 8;"), "Publisher 0|1957|1|1");
+    EXPECT_EQ(query_text("SELECT title_chosung FROM Books WHERE title = '토지';"), "ㅌㅈ");
+    EXPECT_EQ(query_text("SELECT author_chosung FROM Books WHERE title = '토지';"), "ㅂㄱㄹ");
+    EXPECT_EQ(find_book_by_isbn(isbn13(1234).c_str()), 1235);
+}
+
+// Test: inside an open transaction the load commits or rolls back with the caller
+TEST_F(MarcTest, JoinsCallerTransaction) {
+    write_file(record({{"245", "10$aDune"}, {"020", "  $a0441172717"}}));
+
+    ASSERT_EQ(sqlite3_exec(test_db, "BEGIN;", nullptr, nullptr, nullptr), SQLITE_OK);
+    EXPECT_EQ(load_marc_file(test_db, path, 2, nullptr), 1);
+    ASSERT_EQ(sqlite3_exec(test_db, "ROLLBACK;", nullptr, nullptr, nullptr), SQLITE_OK);
+    EXPECT_EQ(query_text("SELECT COUNT(*) FROM Books;"), "0");
+
+    EXPECT_EQ(load_marc_file(test_db, path, 1, nullptr), 1);
+    EXPECT_EQ(load_marc_file(test_db, path, 1, nullptr), 0);    // same ISBN again
+    EXPECT_EQ(find_book_by_isbn("978-0-441-17271-9"), 1);
+
+    EXPECT_EQ(load_marc_file(test_db, "/nonexistent/file.mrc", 1, nullptr), -1);
+}
@@ -0,0 +1,169 @@
+/**
+ * @file test_penalty_gtest.cpp
+ * @brief Google Test based unit tests for the member penalty ledger
+ * 
+ * Covers the ledger updates made by process_loan/process_return, the
+ * O(1) can_member_borrow() check, lazy expiry against today and the
+ * backfill run when the ledger columns are first added.
+ */
+
+#include <gtest/gtest.h>
+#include <sqlite3.h>
+#include <string>
+
+extern "C" {
+    #include "../include/database.h"
+    #include "../include/book.h"
+    #include "../include/member.h"
+    #include "../include/loan.h"
+    #include "../include/date_utils.h"
+}
+
+// Test fixture class for the penalty ledger
+class PenaltyTest : public ::testing::Test {
+protected:
+    sqlite3* test_db;
+    sqlite3* saved_db;
+    int today;
+
+    // Setup: Create in-memory database with one book and one member
+    void SetUp() override {
+        test_db = nullptr;
+        saved_db = get_db_connection();
+        today = get_today_day();
+
+        int rc = sqlite3_open(":memory:", &test_db);
+        ASSERT_EQ(rc, SQLITE_OK) << "Failed to open in-memory database";
+
+        set_db_connection(test_db);
+        ASSERT_EQ(create_tables(), 0);
+        ASSERT_EQ(migrate_schema(), 0);
+        ASSERT_EQ(create_indexes(), 0);
+
+        ASSERT_EQ(add_book("Dune", "Herbert", "", 1965, "B1", "SF", 5), 0);
+        ASSERT_EQ(add_member(test_db, "Reader", "", ""), 1);
+    }
+
+    // Teardown: Close database after each test
+    void TearDown() override {
+        set_db_connection(saved_db);
+
+        if (test_db) {
+            sqlite3_close(test_db);
+            test_db = nullptr;
+        }
+    }
+
+    void exec(const std::string& sql) {
+        ASSERT_EQ(sqlite3_exec(test_db, sql.c_str(), nullptr, nullptr, nullptr), SQLITE_OK) << sql;
+    }
+
+    int query_int(const std::string& sql) {
+        sqlite3_stmt* stmt;
+        EXPECT_EQ(sqlite3_prepare_v2(test_db, sql.c_str(), -1, &stmt, nullptr), SQLITE_OK) << sql;
+        int value = sqlite3_step(stmt) == SQLITE_ROW && sqlite3_column_type(stmt, 0) != SQLITE_NULL
+                    ? sqlite3_column_int(stmt, 0) : -1;
+        sqlite3_finalize(stmt);
+        return value;
+    }
+
+    static std::string date_from_today(int days) {
+        char date[MAX_DATE_LEN];
+        day_to_date(get_today_day() + days, date, sizeof(date));
+        return date;
+    }
+};
+
+TEST_F(PenaltyTest, LoanTracksEarliestDueDay) {
+    EXPECT_EQ(can_member_borrow(test_db, 1), 1);
+    EXPECT_EQ(query_int("SELECT next_due_day FROM Members WHERE member_id = 1;"), -1) << "No active loans";
+
+    ASSERT_GT(process_loan(test_db, 1, 1, 14), 0);
+    ASSERT_GT(process_loan(test_db, 1, 1, 7), 0);
+    EXPECT_EQ(query_int("SELECT next_due_day FROM Members WHERE member_id = 1;"), today + 7);
+    EXPECT_EQ(can_member_borrow(test_db, 1), 1);
+}
+
+TEST_F(PenaltyTest, ActiveOverdueLoanBlocksBorrowing) {
+    int loan_id = process_loan(test_db, 1, 1, 14);
+    ASSERT_GT(loan_id, 0);
+
+    // Simulate the due date passing, then let the ledger catch up
+    exec("UPDATE Loans SET due_date = '" + date_from_today(-3) + "';");
+    ASSERT_EQ(rebuild_penalty_ledger(test_db, 1), 1);
+    EXPECT_EQ(can_member_borrow(test_db, 1), 0);
+    EXPECT_EQ(process_loan(test_db, 1, 1, 14), -1);
+
+    // Returning 3 days late suspends the member for 6 days
+    ASSERT_GT(process_return(test_db, loan_id), 0);
+    EXPECT_EQ(query_int("SELECT suspended_until FROM Members WHERE member_id = 1;"),
+              today + calculate_suspension_days(3));
+    EXPECT_EQ(query_int("SELECT penalty_days FROM Members WHERE member_id = 1;"), 6);
+    EXPECT_EQ(query_int("SELECT next_due_day FROM Members WHERE member_id = 1;"), -1);
+    EXPECT_EQ(can_member_borrow(test_db, 1), 0);
+}
+
+TEST_F(PenaltyTest, SuspensionExpiresWithoutWrites) {
+    exec("UPDATE Members SET suspended_until = " + std::to_string(today + 1) + " WHERE member_id = 1;");
+    EXPECT_EQ(can_member_borrow(test_db, 1), 0);
+
+    // The stored end day is simply compared with today; reaching it lifts the suspension
+    exec("UPDATE Members SET suspended_until = " + std::to_string(today) + " WHERE member_id = 1;");
+    EXPECT_EQ(can_member_borrow(test_db, 1), 1);
+}
+
+TEST_F(PenaltyTest, OnTimeReturnKeepsLedgerClear) {
+    int first = process_loan(test_db, 1, 1, 3);
+    ASSERT_GT(first, 0);
+    ASSERT_GT(process_loan(test_db, 1, 1, 10), 0);
+
+    ASSERT_GT(process_return(test_db, first), 0);
+    EXPECT_EQ(query_int("SELECT suspended_until FROM Members WHERE member_id = 1;"), 0);
+    EXPECT_EQ(query_int("SELECT next_due_day FROM Members WHERE member_id = 1;"), today + 10)
+        << "Earliest due day moves to the remaining loan";
+    EXPECT_EQ(can_member_borrow(test_db, 1), 1);
+}
+
+TEST_F(PenaltyTest, UnknownMemberCannotBorrow) {
+    EXPECT_EQ(can_member_borrow(test_db, 42), -1);
+    EXPECT_EQ(process_loan(test_db, 1, 42, 14), -1);
+}
+
+TEST_F(PenaltyTest, MigrationBackfillsLedger) {
+    // A database created before the ledger existed
+    exec("DROP TABLE Members;");
+    exec("CREATE TABLE Members (member_id INTEGER PRIMARY KEY AUTOINCREMENT, name TEXT NOT NULL, "
+         "phone TEXT, address TEXT, registration_date TEXT, penalty_days INTEGER DEFAULT 0, "
+         "name_chosung TEXT, name_jamo TEXT);");
+    exec("INSERT INTO Members (name) VALUES ('Late'), ('Active'), ('Clean');");
+    exec("INSERT INTO Loans (book_id, member_id, loan_date, due_date, is_returned) VALUES "
+         "(1, 1, '2024-01-01', '" + date_from_today(-10) + "', 1), "
+         "(1, 2, '2024-01-01', '" + date_from_today(5) + "', 0), "
+         "(1, 3, '2024-01-01', '2024-01-15', 1);");
+    exec("INSERT INTO Returns (loan_id, return_date, overdue_days) VALUES "
+         "(1, '" + date_from_today(-2) + "', 8), (3, '2024-01-10', 0);");
+
+    ASSERT_EQ(migrate_schema(), 0);
+
+    EXPECT_EQ(query_int("SELECT suspended_until FROM Members WHERE member_id = 1;"), today - 2 + 16);
+    EXPECT_EQ(query_int("SELECT penalty_days FROM Members WHERE member_id = 1;"), 16);
+    EXPECT_EQ(query_int("SELECT next_due_day FROM Members WHERE member_id = 2;"), today + 5);
+    EXPECT_EQ(query_int("SELECT suspended_until FROM Members WHERE member_id = 3;"), 0);
+    EXPECT_EQ(can_member_borrow(test_db, 1), 0);
+    EXPECT_EQ(can_member_borrow(test_db, 2), 1);
+    EXPECT_EQ(can_member_borrow(test_db, 3), 1);
+
+    // Running the migration again does not rebuild the ledger
+    exec("UPDATE Members SET suspended_until = 0 WHERE member_id = 1;");
+    ASSERT_EQ(migrate_schema(), 0);
+    EXPECT_EQ(query_int("SELECT suspended_until FROM Members WHERE member_id = 1;"), 0);
+}
+
+// ============================================================================
+// Main function
+// ============================================================================
+
+int main(int argc, char** argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
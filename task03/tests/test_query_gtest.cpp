@@ -0,0 +1,174 @@
+/**
+ * @file test_query_gtest.cpp
+ * @brief Google Test based unit tests for the C++ query wrapper
+ * 
+ * Covers typed binding and row mapping to tuples and structs, string_view
+ * columns pointing into SQLite's row, NULL columns, statement reuse from
+ * the cache (including nested leases of one query) and errors.
+ */
+
+#include <gtest/gtest.h>
+#include <sqlite3.h>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "../include/query.hpp"
+
+extern "C" {
+    #include "../include/database.h"
+    #include "../include/book.h"
+}
+
+// Test fixture class for the C++ query wrapper
+class QueryTest : public ::testing::Test {
+protected:
+    sqlite3* test_db;
+    sqlite3* saved_db;
+
+    // Setup: Create in-memory database with three books
+    void SetUp() override {
+        test_db = nullptr;
+        saved_db = get_db_connection();
+
+        int rc = sqlite3_open(":memory:", &test_db);
+        ASSERT_EQ(rc, SQLITE_OK) << "Failed to open in-memory database";
+
+        set_db_connection(test_db);
+        ASSERT_EQ(create_tables(), 0);
+        ASSERT_EQ(migrate_schema(), 0);
+        set_quiet_mode(1);
+
+        ASSERT_EQ(add_book("C Programming", "Kernighan", "Prentice Hall", 1988, "0131103628", "Computer", 3), 0);
+        ASSERT_EQ(add_book("Design Patterns", "Gamma", "Addison-Wesley", 1994, "0201633612", "Computer", 2), 0);
+        ASSERT_EQ(add_book("토지", "박경리", "마로니에북스", 2012, "8985541054", "Fiction", 1), 0);
+    }
+
+    // Teardown: Close database
+    void TearDown() override {
+        set_quiet_mode(0);
+        set_db_connection(saved_db);
+
+        if (test_db) {
+            sqlite3_close(test_db);
+            test_db = nullptr;
+        }
+    }
+};
+
+struct BookRow {
+    int book_id;
+    std::string_view title;
+    std::optional<int> quantity;
+};
+
+// Test: parameters bind by type and rows map to tuples and structs
+TEST_F(QueryTest, TypedBindAndRows) {
+    library::StatementCache cache(test_db);
+
+    std::vector<std::string> titles;
+    auto stmt = cache.prepare("SELECT book_id, title, quantity FROM Books WHERE genre = ? AND quantity >= ? "
+                              "ORDER BY book_id");
+    for (auto [id, title, quantity] : stmt.bind("Computer", 2L).rows<int, std::string_view, int>()) {
+        EXPECT_GT(id, 0);
+        EXPECT_GE(quantity, 2);
+        titles.emplace_back(title);
+    }
+    EXPECT_EQ(titles, std::vector<std::string>({"C Programming", "Design Patterns"}));
+
+    // The same lease re-binds; std::string temporaries are copied by SQLite
+    std::vector<int> ids;
+    for (const BookRow& row : stmt.bind(std::string("Fiction"), 1).rows_as<BookRow, int, std::string_view,
+                                                                            std::optional<int>>()) {
+        EXPECT_EQ(row.title, "토지");
+        EXPECT_EQ(row.quantity, std::optional<int>(1));
+        ids.push_back(row.book_id);
+    }
+    EXPECT_EQ(ids, std::vector<int>({3}));
+
+    auto update = cache.prepare("UPDATE Books SET publication_year = ? WHERE genre = ?");
+    EXPECT_EQ(update.bind(nullptr, "Fiction").exec(), 1);
+    EXPECT_FALSE(std::get<0>(*cache.prepare("SELECT publication_year FROM Books WHERE book_id = 3")
+                                   .first<std::optional<int>>()).has_value());
+
+    // A null C string binds NULL, as in the C API
+    const char* publisher = nullptr;
+    char title[] = "C Programming";
+    auto set_publisher = cache.prepare("UPDATE Books SET publisher = ? WHERE title = ?");
+    EXPECT_EQ(set_publisher.bind(publisher, title).exec(), 1);
+    EXPECT_FALSE(std::get<0>(*cache.prepare("SELECT publisher FROM Books WHERE book_id = 1")
+                                   .first<std::optional<std::string_view>>()).has_value());
+}
+
+// Test: text columns are views of SQLite's row, NULLs map to nullopt
+TEST_F(QueryTest, ColumnsAreViewsIntoTheRow) {
+    library::StatementCache cache(test_db);
+    ASSERT_EQ(cache.prepare("UPDATE Books SET publisher = NULL WHERE book_id = 2").exec(), 1);
+
+    auto stmt = cache.prepare("SELECT title, publisher, isbn FROM Books WHERE book_id = ?");
+    auto row = stmt.bind(1).first<std::string_view, std::optional<std::string_view>, std::string>();
+    ASSERT_TRUE(row.has_value());
+    auto [title, publisher, isbn] = *row;
+    EXPECT_EQ(title, "C Programming");
+    EXPECT_EQ(title.data(), reinterpret_cast<const char*>(sqlite3_column_text(stmt.get(), 0)));    // no copy
+    EXPECT_EQ(publisher, std::optional<std::string_view>("Prentice Hall"));
+    EXPECT_EQ(isbn, "0131103628");
+
+    row = stmt.bind(2).first<std::string_view, std::optional<std::string_view>, std::string>();
+    ASSERT_TRUE(row.has_value());
+    EXPECT_FALSE(std::get<1>(*row).has_value());
+
+    EXPECT_FALSE(stmt.bind(99).first<int>().has_value());
+    EXPECT_EQ(std::get<0>(*cache.prepare("SELECT COUNT(*) FROM Books").first<long long>()), 3);
+}
+
+// Test: statements are prepared once per SQL text and reset between leases
+TEST_F(QueryTest, CacheReusesStatements) {
+    library::StatementCache cache(test_db);
+    const char* sql = "SELECT book_id FROM Books WHERE book_id > ? ORDER BY book_id";
+
+    sqlite3_stmt* first;
+    {
+        auto stmt = cache.prepare(sql);
+        first = stmt.get();
+        EXPECT_TRUE(stmt.bind(0).first<int>().has_value());
+    }
+    EXPECT_FALSE(sqlite3_stmt_busy(first));    // the lease reset it
+
+    auto stmt = cache.prepare(std::string(sql));
+    EXPECT_EQ(stmt.get(), first);
+    EXPECT_EQ(cache.size(), 1u);
+
+    // Nesting the same query gets its own statement while the outer one runs
+    int pairs = 0;
+    for (auto [outer] : stmt.bind(0).rows<int>()) {
+        auto inner = cache.prepare(sql);
+        EXPECT_NE(inner.get(), first);
+        for (auto [id] : inner.bind(outer).rows<int>()) {
+            EXPECT_GT(id, outer);
+            pairs++;
+        }
+    }
+    EXPECT_EQ(pairs, 3);
+    EXPECT_EQ(cache.size(), 1u);
+}
+
+// Test: bad SQL, wrong parameter counts and constraint failures throw
+TEST_F(QueryTest, ErrorsThrow) {
+    library::StatementCache cache(test_db);
+
+    EXPECT_THROW(cache.prepare("SELECT nope FROM Books"), library::QueryError);
+    EXPECT_EQ(cache.size(), 0u);
+
+    auto stmt = cache.prepare("SELECT title FROM Books WHERE book_id = ?");
+    EXPECT_THROW(stmt.bind(1, 2), library::QueryError);
+
+    auto insert = cache.prepare("INSERT INTO Books (book_id, title, author) VALUES (?, ?, ?)");
+    try {
+        insert.bind(1, "Duplicate", "Nobody").exec();
+        FAIL() << "Inserting an existing book_id should throw";
+    } catch (const library::QueryError& e) {
+        EXPECT_EQ(e.code() & 0xff, SQLITE_CONSTRAINT);
+    }
+}
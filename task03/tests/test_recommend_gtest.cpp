@@ -0,0 +1,213 @@
+/**
+ * @file test_recommend_gtest.cpp
+ * @brief Google Test based unit tests for the Recommend module
+ * 
+ * Covers building the co-borrowing matrix, mapped lookups, incremental
+ * updates from new loans and saving or flushing the merged matrix.
+ */
+
+#include <gtest/gtest.h>
+#include <sqlite3.h>
+#include <cstdio>
+
+extern "C" {
+    #include "../include/database.h"
+    #include "../include/book.h"
+    #include "../include/member.h"
+    #include "../include/loan.h"
+    #include "../include/recommend.h"
+}
+
+static const char *TEST_MATRIX_PATH = "recommend_test.bin";
+
+// Test fixture class for Recommend module tests
+class RecommendTest : public ::testing::Test {
+protected:
+    sqlite3* test_db;
+    sqlite3* saved_db;
+    int books[4];
+    int members[3];
+
+    // Setup: Create in-memory database with books, members and a loan history
+    void SetUp() override {
+        test_db = nullptr;
+        saved_db = get_db_connection();
+
+        int rc = sqlite3_open(":memory:", &test_db);
+        ASSERT_EQ(rc, SQLITE_OK) << "Failed to open in-memory database";
+
+        set_db_connection(test_db);
+        ASSERT_EQ(enable_foreign_keys(), 0);
+        ASSERT_EQ(create_tables(), 0);
+        ASSERT_EQ(migrate_schema(), 0);
+        ASSERT_EQ(create_indexes(), 0);
+
+        const char *titles[4] = {"Book A", "Book B", "Book C", "Book D"};
+        const char *isbns[4] = {"1000000001", "1000000002", "1000000003", "1000000004"};
+        for (int i = 0; i < 4; i++) {
+            ASSERT_EQ(add_book(titles[i], "Author", "Publisher", 2024, isbns[i], "Fiction", 5), 0);
+            books[i] = (int)sqlite3_last_insert_rowid(test_db);
+        }
+        for (int i = 0; i < 3; i++) {
+            members[i] = add_member(test_db, "Reader", "010-0000-0000", "Seoul");
+            ASSERT_GT(members[i], 0);
+        }
+
+        // Member 0: A, B, C   Member 1: A, B   Member 2: A, D
+        ASSERT_GT(process_loan(test_db, books[0], members[0], 14), 0);
+        ASSERT_GT(process_loan(test_db, books[1], members[0], 14), 0);
+        ASSERT_GT(process_loan(test_db, books[2], members[0], 14), 0);
+        ASSERT_GT(process_loan(test_db, books[0], members[1], 14), 0);
+        ASSERT_GT(process_loan(test_db, books[1], members[1], 14), 0);
+        ASSERT_GT(process_loan(test_db, books[0], members[2], 14), 0);
+        ASSERT_GT(process_loan(test_db, books[3], members[2], 14), 0);
+    }
+
+    // Teardown: Unmap the matrix, remove its file and close database after each test
+    void TearDown() override {
+        close_recommendations();
+        std::remove(TEST_MATRIX_PATH);
+        set_db_connection(saved_db);
+
+        if (test_db) {
+            sqlite3_close(test_db);
+            test_db = nullptr;
+        }
+    }
+
+    // Helper function to build and map the matrix
+    void build_and_open(int num_threads) {
+        ASSERT_EQ(build_recommendations(test_db, TEST_MATRIX_PATH, num_threads), 4);
+        ASSERT_EQ(open_recommendations(TEST_MATRIX_PATH), 0);
+    }
+};
+
+// ============================================================================
+// Test Suite 1: build_recommendations() / get_similar_books() tests
+// ============================================================================
+
+TEST_F(RecommendTest, SimilarBooksRankedByCoBorrowCount) {
+    build_and_open(1);
+
+    Recommendation recs[10];
+    ASSERT_EQ(get_similar_books(books[0], recs, 10), 3);
+    EXPECT_EQ(recs[0].book_id, books[1]);
+    EXPECT_EQ(recs[0].score, 2);
+    EXPECT_EQ(recs[1].book_id, books[2]);
+    EXPECT_EQ(recs[1].score, 1);
+    EXPECT_EQ(recs[2].book_id, books[3]);
+    EXPECT_EQ(recs[2].score, 1);
+
+    ASSERT_EQ(get_similar_books(books[3], recs, 10), 1);
+    EXPECT_EQ(recs[0].book_id, books[0]);
+}
+
+TEST_F(RecommendTest, ParallelBuildMatchesSingleThread) {
+    build_and_open(3);
+
+    Recommendation recs[10];
+    ASSERT_EQ(get_similar_books(books[1], recs, 10), 2);
+    EXPECT_EQ(recs[0].book_id, books[0]);
+    EXPECT_EQ(recs[0].score, 2);
+    EXPECT_EQ(recs[1].book_id, books[2]);
+    EXPECT_EQ(recs[1].score, 1);
+}
+
+TEST_F(RecommendTest, MaxCountLimitsResults) {
+    build_and_open(2);
+
+    Recommendation recs[1];
+    ASSERT_EQ(get_similar_books(books[0], recs, 1), 1);
+    EXPECT_EQ(recs[0].book_id, books[1]);
+}
+
+TEST_F(RecommendTest, NoMatrixOpen) {
+    Recommendation recs[10];
+    EXPECT_EQ(get_similar_books(books[0], recs, 10), -1);
+    EXPECT_EQ(open_recommendations("does_not_exist.bin"), -1);
+}
+
+// ============================================================================
+// Test Suite 2: incremental updates
+// ============================================================================
+
+TEST_F(RecommendTest, NewLoanUpdatesOpenMatrix) {
+    build_and_open(2);
+
+    // Member 2 already has A and D: borrowing B adds A-B and D-B
+    ASSERT_GT(process_loan(test_db, books[1], members[2], 14), 0);
+
+    Recommendation recs[10];
+    ASSERT_EQ(get_similar_books(books[0], recs, 10), 3);
+    EXPECT_EQ(recs[0].book_id, books[1]);
+    EXPECT_EQ(recs[0].score, 3);
+
+    ASSERT_EQ(get_similar_books(books[3], recs, 10), 2);
+    EXPECT_EQ(recs[0].book_id, books[0]);
+    EXPECT_EQ(recs[1].book_id, books[1]);
+}
+
+TEST_F(RecommendTest, RepeatBorrowDoesNotCountTwice) {
+    build_and_open(1);
+
+    // Member 1 borrows A a second time
+    ASSERT_GT(process_loan(test_db, books[0], members[1], 14), 0);
+
+    Recommendation recs[10];
+    ASSERT_EQ(get_similar_books(books[0], recs, 10), 3);
+    EXPECT_EQ(recs[0].score, 2);
+}
+
+TEST_F(RecommendTest, SaveFoldsPendingUpdates) {
+    build_and_open(1);
+    ASSERT_GT(process_loan(test_db, books[1], members[2], 14), 0);
+
+    ASSERT_EQ(save_recommendations(TEST_MATRIX_PATH), 0);
+    EXPECT_EQ(catch_up_recommendations(test_db), 0) << "Saved file must carry the new watermark";
+
+    Recommendation recs[10];
+    ASSERT_EQ(get_similar_books(books[0], recs, 10), 3);
+    EXPECT_EQ(recs[0].book_id, books[1]);
+    EXPECT_EQ(recs[0].score, 3);
+}
+
+TEST_F(RecommendTest, SkipsLoansThatRollBack) {
+    build_and_open(1);
+
+    // Member 3 borrowed books 1 and 4; the rolled back book 3 loan leaves no pair behind
+    ASSERT_EQ(begin_transaction(), 0);
+    ASSERT_GT(process_loan(test_db, books[2], members[2], 14), 0);
+    ASSERT_EQ(rollback_transaction(), 0);
+    ASSERT_GT(process_loan(test_db, books[1], members[2], 14), 0);
+
+    Recommendation recs[10];
+    ASSERT_EQ(get_similar_books(books[3], recs, 10), 2);
+    EXPECT_EQ(recs[0].book_id, books[0]);
+    EXPECT_EQ(recs[1].book_id, books[1]) << "The loan that reused the rolled back ID";
+}
+
+TEST_F(RecommendTest, FlushWritesPendingLoans) {
+    build_and_open(1);
+    EXPECT_EQ(flush_recommendations(), 0) << "Nothing pending yet";
+    ASSERT_GT(process_loan(test_db, books[1], members[2], 14), 0);
+
+    ASSERT_EQ(flush_recommendations(), 1);
+    EXPECT_EQ(flush_recommendations(), 0);
+
+    close_recommendations();
+    ASSERT_EQ(open_recommendations(TEST_MATRIX_PATH), 0);
+    EXPECT_EQ(catch_up_recommendations(test_db), 0) << "The file holds the loan";
+
+    Recommendation recs[10];
+    ASSERT_EQ(get_similar_books(books[0], recs, 10), 3);
+    EXPECT_EQ(recs[0].score, 3);
+}
+
+// ============================================================================
+// Main function
+// ============================================================================
+
+int main(int argc, char** argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
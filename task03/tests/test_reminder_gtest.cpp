@@ -0,0 +1,232 @@
+/**
+ * @file test_reminder_gtest.cpp
+ * @brief Google Test based unit tests for the due-date reminder scheduler
+ * 
+ * Covers the day-before and overdue milestone notifications, incremental
+ * updates from process_loan/process_return, cascading across wheel levels
+ * on long jumps and the batched, deduplicated outbox writes, including
+ * a failed write leaving its reminders pending.
+ */
+
+#include <gtest/gtest.h>
+#include <sqlite3.h>
+#include <string>
+#include <vector>
+
+extern "C" {
+    #include "../include/database.h"
+    #include "../include/book.h"
+    #include "../include/member.h"
+    #include "../include/loan.h"
+    #include "../include/reminder.h"
+    #include "../include/date_utils.h"
+}
+
+// Collects fired reminders
+static void collect_reminder(const Reminder* reminder, void* user_data) {
+    static_cast<std::vector<Reminder>*>(user_data)->push_back(*reminder);
+}
+
+// Test fixture class for the reminder scheduler
+class ReminderTest : public ::testing::Test {
+protected:
+    sqlite3* test_db;
+    sqlite3* saved_db;
+    std::vector<Reminder> fired;
+
+    // Setup: Create in-memory database with one book and one member
+    void SetUp() override {
+        test_db = nullptr;
+        saved_db = get_db_connection();
+
+        int rc = sqlite3_open(":memory:", &test_db);
+        ASSERT_EQ(rc, SQLITE_OK) << "Failed to open in-memory database";
+
+        set_db_connection(test_db);
+        ASSERT_EQ(create_tables(), 0);
+        ASSERT_EQ(migrate_schema(), 0);
+        ASSERT_EQ(create_indexes(), 0);
+
+        ASSERT_EQ(add_book("Dune", "Herbert", "", 1965, "B1", "SF", 5), 0);
+        ASSERT_EQ(add_member(test_db, "Reader", "", ""), 1);
+    }
+
+    // Teardown: Free the wheel and close database after each test
+    void TearDown() override {
+        free_reminder_scheduler();
+        set_db_connection(saved_db);
+
+        if (test_db) {
+            sqlite3_close(test_db);
+            test_db = nullptr;
+        }
+    }
+
+    int advance(int day) {
+        fired.clear();
+        return advance_reminders(test_db, day, collect_reminder, &fired);
+    }
+
+    int query_int(const std::string& sql) {
+        sqlite3_stmt* stmt;
+        EXPECT_EQ(sqlite3_prepare_v2(test_db, sql.c_str(), -1, &stmt, nullptr), SQLITE_OK) << sql;
+        int value = sqlite3_step(stmt) == SQLITE_ROW ? sqlite3_column_int(stmt, 0) : -1;
+        sqlite3_finalize(stmt);
+        return value;
+    }
+};
+
+TEST_F(ReminderTest, DueTomorrowFiresDayBefore) {
+    ASSERT_EQ(load_reminder_scheduler(test_db, 1000), 0);
+    ASSERT_EQ(reminder_schedule_loan(1, 1, 1, 1010), 0);
+    EXPECT_EQ(reminder_pending_count(), 1);
+
+    EXPECT_EQ(advance(1008), 0);
+    EXPECT_EQ(advance(1009), 1);
+    ASSERT_EQ(fired.size(), 1u);
+    EXPECT_EQ(fired[0].kind, REMINDER_DUE_TOMORROW);
+    EXPECT_EQ(fired[0].fire_day, 1009);
+    EXPECT_EQ(fired[0].due_day, 1010);
+
+    char date[MAX_DATE_LEN];
+    day_to_date(1009, date, sizeof(date));
+    EXPECT_EQ(query_int("SELECT COUNT(*) FROM ReminderOutbox WHERE kind = 0 AND notify_date = '" +
+                        std::string(date) + "';"), 1);
+}
+
+TEST_F(ReminderTest, OverdueMilestonesFireInOrder) {
+    ASSERT_EQ(load_reminder_scheduler(test_db, 1000), 0);
+    ASSERT_EQ(reminder_schedule_loan(1, 1, 1, 1010), 0);
+
+    // Skipping ahead fires every missed notification in day order
+    EXPECT_EQ(advance(1024), 4);
+    ASSERT_EQ(fired.size(), 4u);
+    EXPECT_EQ(fired[0].kind, REMINDER_DUE_TOMORROW);
+    EXPECT_EQ(fired[1].overdue_days, 1);
+    EXPECT_EQ(fired[2].overdue_days, 7);
+    EXPECT_EQ(fired[3].overdue_days, 14);
+    EXPECT_EQ(fired[3].fire_day, 1024);
+    EXPECT_EQ(reminder_pending_count(), 1);
+
+    EXPECT_EQ(advance(1040), 1);
+    EXPECT_EQ(fired[0].kind, REMINDER_OVERDUE);
+    EXPECT_EQ(fired[0].overdue_days, 30);
+    EXPECT_EQ(reminder_pending_count(), 0) << "Last milestone drops the loan";
+    EXPECT_EQ(query_int("SELECT COUNT(*) FROM ReminderOutbox;"), 5);
+}
+
+TEST_F(ReminderTest, LoanAndReturnUpdateWheel) {
+    int today = get_today_day();
+    ASSERT_EQ(load_reminder_scheduler(test_db, today), 0);
+
+    int loan_id = process_loan(test_db, 1, 1, 3);
+    ASSERT_GT(loan_id, 0);
+    int other_id = process_loan(test_db, 1, 1, 3);
+    ASSERT_GT(other_id, 0);
+    EXPECT_EQ(reminder_pending_count(), 2);
+
+    ASSERT_GT(process_return(test_db, loan_id), 0);
+    EXPECT_EQ(reminder_pending_count(), 1);
+
+    EXPECT_EQ(advance(today + 2), 1);
+    ASSERT_EQ(fired.size(), 1u);
+    EXPECT_EQ(fired[0].loan_id, other_id);
+    EXPECT_EQ(fired[0].member_id, 1);
+    EXPECT_EQ(fired[0].book_id, 1);
+}
+
+TEST_F(ReminderTest, LongJumpCascadesAcrossLevels) {
+    // Start just before a 4096-day boundary so due days land on every level
+    int start = 4096 * 5 - 3;
+    ASSERT_EQ(load_reminder_scheduler(test_db, start), 0);
+    std::vector<int> due_days = {start + 5, start + 70, start + 4100, start + 300000};
+    for (size_t i = 0; i < due_days.size(); i++) {
+        ASSERT_EQ(reminder_schedule_loan((int)i + 1, 1, 1, due_days[i]), 0);
+    }
+
+    for (size_t i = 0; i < due_days.size(); i++) {
+        EXPECT_EQ(advance(due_days[i] - 2), 0) << "Nothing fires early for loan " << i + 1;
+        EXPECT_EQ(advance(due_days[i] - 1), 1);
+        ASSERT_EQ(fired.size(), 1u);
+        EXPECT_EQ(fired[0].loan_id, (int)i + 1);
+        EXPECT_EQ(fired[0].fire_day, due_days[i] - 1);
+        reminder_cancel_loan((int)i + 1);
+    }
+    EXPECT_EQ(reminder_pending_count(), 0);
+}
+
+TEST_F(ReminderTest, ReloadDoesNotDuplicateOutbox) {
+    sqlite3_exec(test_db, "INSERT INTO Loans (book_id, member_id, loan_date, due_date, is_returned) "
+                          "VALUES (1, 1, '2024-01-01', '2024-01-15', 0), "
+                          "(1, 1, '2024-01-01', '2024-01-20', 1);", nullptr, nullptr, nullptr);
+    int due_day;
+    ASSERT_EQ(date_to_day("2024-01-15", &due_day), 0);
+
+    // Loaded on the due date: only the overdue milestones remain
+    ASSERT_EQ(load_reminder_scheduler(test_db, due_day), 1);
+    EXPECT_EQ(advance(due_day + 1), 1);
+    EXPECT_EQ(fired[0].overdue_days, 1);
+
+    // A restart on the same day fires again but the outbox keeps one row
+    ASSERT_EQ(load_reminder_scheduler(test_db, due_day + 1), 1);
+    EXPECT_EQ(advance(due_day + 1), 1);
+    EXPECT_EQ(query_int("SELECT COUNT(*) FROM ReminderOutbox;"), 1);
+}
+
+TEST_F(ReminderTest, OutboxWritesInBatches) {
+    const int loans = REMINDER_BATCH_SIZE * 2 + 10;
+    ASSERT_EQ(load_reminder_scheduler(test_db, 100), 0);
+    for (int i = 1; i <= loans; i++) {
+        ASSERT_EQ(reminder_schedule_loan(i, 1, 1, 110), 0);
+    }
+
+    EXPECT_EQ(advance(109), loans);
+    EXPECT_EQ(query_int("SELECT COUNT(*) FROM ReminderOutbox WHERE kind = 0;"), loans);
+    EXPECT_EQ(query_int("SELECT COUNT(DISTINCT loan_id) FROM ReminderOutbox;"), loans);
+
+    // Inside a caller's transaction the outbox rows roll back with it
+    ASSERT_EQ(sqlite3_exec(test_db, "BEGIN;", nullptr, nullptr, nullptr), SQLITE_OK);
+    EXPECT_EQ(advance(111), loans);
+    ASSERT_EQ(sqlite3_exec(test_db, "ROLLBACK;", nullptr, nullptr, nullptr), SQLITE_OK);
+    EXPECT_EQ(query_int("SELECT COUNT(*) FROM ReminderOutbox WHERE kind = 1;"), 0);
+}
+
+TEST_F(ReminderTest, FailedOutboxWriteKeepsRemindersPending) {
+    const int loans = REMINDER_BATCH_SIZE * 2 + 88;
+    ASSERT_EQ(load_reminder_scheduler(test_db, 100), 0);
+    for (int i = 1; i <= loans; i++) {
+        ASSERT_EQ(reminder_schedule_loan(i, 1, 1, 110), 0);
+    }
+
+    // Fail the outbox insert partway through the second batch
+    std::string trigger = "CREATE TRIGGER fail_outbox BEFORE INSERT ON ReminderOutbox "
+                          "WHEN (SELECT COUNT(*) FROM ReminderOutbox) >= " +
+                          std::to_string(REMINDER_BATCH_SIZE + 10) +
+                          " BEGIN SELECT RAISE(ABORT, 'outbox unavailable'); END;";
+    ASSERT_EQ(sqlite3_exec(test_db, trigger.c_str(), nullptr, nullptr, nullptr), SQLITE_OK);
+    EXPECT_EQ(advance(109), -1);
+    EXPECT_EQ((int)fired.size(), REMINDER_BATCH_SIZE) << "Only the written batch is reported";
+    EXPECT_EQ(query_int("SELECT COUNT(*) FROM ReminderOutbox;"), REMINDER_BATCH_SIZE);
+    EXPECT_EQ(reminder_pending_count(), loans);
+
+    // Unwritten loans are back on the wheel, so cancelling one is safe
+    reminder_cancel_loan(1);
+    EXPECT_EQ(reminder_pending_count(), loans - 1);
+
+    ASSERT_EQ(sqlite3_exec(test_db, "DROP TRIGGER fail_outbox;", nullptr, nullptr, nullptr), SQLITE_OK);
+    EXPECT_EQ(advance(109), loans - 1 - REMINDER_BATCH_SIZE) << "The failed day is replayed";
+    EXPECT_EQ(query_int("SELECT COUNT(*) FROM ReminderOutbox WHERE kind = 0;"), loans - 1);
+
+    // Written loans moved on to their overdue milestone, the rest follow
+    EXPECT_EQ(advance(111), loans - 1);
+    EXPECT_EQ(query_int("SELECT COUNT(*) FROM ReminderOutbox WHERE kind = 1;"), loans - 1);
+}
+
+// ============================================================================
+// Main function
+// ============================================================================
+
+int main(int argc, char** argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,203 @@
+/**
+ * @file test_result_cache_gtest.cpp
+ * @brief Google Test based unit tests for the query result cache
+ * 
+ * Covers hits and misses by bound parameters, invalidation by the
+ * connection's own writes and by other connections (PRAGMA data_version),
+ * transactions, the memory budget and partially read results.
+ */
+
+#include <gtest/gtest.h>
+#include <sqlite3.h>
+#include <unistd.h>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+extern "C" {
+    #include "../include/database.h"
+    #include "../include/book.h"
+    #include "../include/result_cache.h"
+}
+
+// Test fixture class for the result cache
+class ResultCacheTest : public ::testing::Test {
+protected:
+    sqlite3* test_db;
+    sqlite3* saved_db;
+
+    // Setup: Create in-memory database with three books and load the cache
+    void SetUp() override {
+        test_db = nullptr;
+        saved_db = get_db_connection();
+
+        int rc = sqlite3_open(":memory:", &test_db);
+        ASSERT_EQ(rc, SQLITE_OK) << "Failed to open in-memory database";
+
+        set_db_connection(test_db);
+        ASSERT_EQ(create_tables(), 0);
+        ASSERT_EQ(migrate_schema(), 0);
+        ASSERT_EQ(create_indexes(), 0);
+        set_quiet_mode(1);
+
+        ASSERT_EQ(add_book("Dune", "Herbert", "Chilton", 1965, "B1", "SF", 2), 0);
+        ASSERT_EQ(add_book("Emma", "Austen", "Murray", 1815, "B2", "Novel", 1), 0);
+        ASSERT_EQ(add_book("Persuasion", "Austen", "Murray", 1817, "B3", "Novel", 1), 0);
+        ASSERT_EQ(load_result_cache(0), 0);
+    }
+
+    // Teardown: Free the cache and close the database
+    void TearDown() override {
+        free_result_cache();
+        set_quiet_mode(0);
+        set_db_connection(saved_db);
+
+        if (test_db) {
+            sqlite3_close(test_db);
+            test_db = nullptr;
+        }
+    }
+
+    // Read the titles of one author through a cursor
+    static std::vector<std::string> titles_by(sqlite3* db, const char* author) {
+        std::vector<std::string> titles;
+        sqlite3_stmt* stmt;
+        if (sqlite3_prepare_v2(db, "SELECT title, book_id, NULL, 1.5 FROM Books WHERE author = ? ORDER BY book_id;",
+                               -1, &stmt, nullptr) != SQLITE_OK) {
+            return titles;
+        }
+        sqlite3_bind_text(stmt, 1, author, -1, SQLITE_TRANSIENT);
+
+        ResultCursor cursor;
+        result_cursor_open(&cursor, stmt);
+        while (result_cursor_step(&cursor) == SQLITE_ROW) {
+            titles.push_back(result_cursor_text(&cursor, 0));
+            EXPECT_GT(result_cursor_int(&cursor, 1), 0);
+            EXPECT_EQ(result_cursor_text(&cursor, 2), nullptr);
+            EXPECT_STREQ(result_cursor_text(&cursor, 3), "1.5");
+        }
+        result_cursor_close(&cursor);
+        sqlite3_finalize(stmt);
+        return titles;
+    }
+
+    static ResultCacheStats stats() {
+        ResultCacheStats s;
+        memset(&s, 0, sizeof(s));
+        get_result_cache_stats(&s);
+        return s;
+    }
+};
+
+// Test: the same statement and parameters hit, other parameters miss
+TEST_F(ResultCacheTest, HitsByStatementAndParameters) {
+    std::vector<std::string> expected = {"Emma", "Persuasion"};
+    EXPECT_EQ(titles_by(test_db, "Austen"), expected);
+    EXPECT_EQ(titles_by(test_db, "Austen"), expected);    // replayed
+    EXPECT_EQ(titles_by(test_db, "Herbert"), std::vector<std::string>{"Dune"});
+
+    ResultCacheStats s = stats();
+    EXPECT_EQ(s.hits, 1);
+    EXPECT_EQ(s.misses, 2);
+    EXPECT_EQ(s.entries, 2u);
+    EXPECT_GT(s.bytes, 0u);
+    EXPECT_EQ(s.budget, (size_t)RESULT_CACHE_DEFAULT_BUDGET);
+}
+
+// Test: a write on the same connection drops every result
+TEST_F(ResultCacheTest, OwnWriteInvalidates) {
+    EXPECT_EQ(titles_by(test_db, "Austen").size(), 2u);
+    ASSERT_EQ(add_book("Sanditon", "Austen", "Murray", 1925, "B4", "Novel", 1), 0);
+
+    EXPECT_EQ(titles_by(test_db, "Austen").size(), 3u);
+    ResultCacheStats s = stats();
+    EXPECT_EQ(s.hits, 0);
+    EXPECT_EQ(s.invalidations, 1);
+    EXPECT_EQ(s.entries, 1u);
+}
+
+// Test: a commit by another connection changes PRAGMA data_version
+TEST_F(ResultCacheTest, OtherConnectionInvalidates) {
+    char path[] = "/tmp/test_result_cacheXXXXXX";
+    int fd = mkstemp(path);
+    ASSERT_GE(fd, 0);
+    close(fd);
+
+    sqlite3* file_db;
+    sqlite3* other_db;
+    ASSERT_EQ(sqlite3_open(path, &file_db), SQLITE_OK);
+    ASSERT_EQ(sqlite3_open(path, &other_db), SQLITE_OK);
+    ASSERT_EQ(sqlite3_exec(file_db, "CREATE TABLE Books (book_id INTEGER PRIMARY KEY, title TEXT, author TEXT);"
+                                    "INSERT INTO Books VALUES (1, 'Emma', 'Austen');",
+                           nullptr, nullptr, nullptr), SQLITE_OK);
+
+    set_db_connection(file_db);
+    ASSERT_EQ(load_result_cache(0), 0);
+    EXPECT_EQ(titles_by(file_db, "Austen").size(), 1u);
+    EXPECT_EQ(titles_by(file_db, "Austen").size(), 1u);
+    EXPECT_EQ(stats().hits, 1);
+
+    ASSERT_EQ(sqlite3_exec(other_db, "INSERT INTO Books VALUES (2, 'Persuasion', 'Austen');",
+                           nullptr, nullptr, nullptr), SQLITE_OK);
+    EXPECT_EQ(titles_by(file_db, "Austen").size(), 2u);
+    EXPECT_EQ(stats().invalidations, 1);
+
+    free_result_cache();
+    set_db_connection(test_db);
+    sqlite3_close(other_db);
+    sqlite3_close(file_db);
+    unlink(path);
+}
+
+// Test: nothing is cached or replayed inside a transaction
+TEST_F(ResultCacheTest, TransactionsBypassCache) {
+    EXPECT_EQ(titles_by(test_db, "Austen").size(), 2u);
+
+    ASSERT_EQ(sqlite3_exec(test_db, "BEGIN;", nullptr, nullptr, nullptr), SQLITE_OK);
+    ASSERT_EQ(add_book("Sanditon", "Austen", "Murray", 1925, "B4", "Novel", 1), 0);
+    EXPECT_EQ(titles_by(test_db, "Austen").size(), 3u);
+    ASSERT_EQ(sqlite3_exec(test_db, "ROLLBACK;", nullptr, nullptr, nullptr), SQLITE_OK);
+
+    // The rolled back row must not come back from the cache
+    EXPECT_EQ(titles_by(test_db, "Austen").size(), 2u);
+    EXPECT_EQ(stats().uncached, 1);
+}
+
+// Test: the least recently used results are evicted to stay within the budget
+TEST_F(ResultCacheTest, BudgetEvictsLeastRecentlyUsed) {
+    ASSERT_EQ(load_result_cache(1024), 0);
+    for (int i = 0; i < 10; i++) {
+        std::string author = "Nobody " + std::to_string(i);
+        EXPECT_TRUE(titles_by(test_db, author.c_str()).empty());
+    }
+
+    ResultCacheStats s = stats();
+    EXPECT_GT(s.evictions, 0);
+    EXPECT_LE(s.bytes, (size_t)1024);
+    EXPECT_EQ(s.entries, (size_t)(10 - s.evictions));
+    EXPECT_EQ(titles_by(test_db, "Nobody 9").size(), 0u);    // most recent one kept
+    EXPECT_EQ(stats().hits, 1);
+
+    // A result larger than a quarter of the budget is read but not stored
+    EXPECT_EQ(titles_by(test_db, "Austen").size(), 2u);
+    EXPECT_EQ(titles_by(test_db, "Austen").size(), 2u);
+    EXPECT_EQ(stats().hits, 1);
+    EXPECT_EQ(stats().uncached, 2);
+}
+
+// Test: a result read only partly is not stored, and book listings use the cache
+TEST_F(ResultCacheTest, PartialReadAndListings) {
+    sqlite3_stmt* stmt;
+    ASSERT_EQ(sqlite3_prepare_v2(test_db, "SELECT title FROM Books ORDER BY book_id;", -1, &stmt, nullptr), SQLITE_OK);
+    ResultCursor cursor;
+    result_cursor_open(&cursor, stmt);
+    EXPECT_EQ(result_cursor_step(&cursor), SQLITE_ROW);
+    result_cursor_close(&cursor);
+    sqlite3_finalize(stmt);
+    EXPECT_EQ(stats().entries, 0u);
+
+    EXPECT_EQ(search_books_by_author("Austen"), 2);
+    EXPECT_EQ(search_books_by_author("Austen"), 2);
+    EXPECT_EQ(stats().hits, 1);
+}
@@ -0,0 +1,171 @@
+/**
+ * @file test_roaring_gtest.cpp
+ * @brief Google Test based unit tests for the Roaring bitmaps
+ * 
+ * Covers adding values across containers, array/bitmap conversion in
+ * both directions, unions and intersections of every container pairing,
+ * and the same operations on a bitmap laid out as in a file.
+ */
+
+#include <gtest/gtest.h>
+#include <cstring>
+#include <set>
+#include <vector>
+
+extern "C" {
+    #include "../include/roaring.h"
+}
+
+// Test fixture class for the Roaring bitmaps
+class RoaringTest : public ::testing::Test {
+protected:
+    RoaringBitmap a, b;
+
+    void SetUp() override {
+        roaring_init(&a);
+        roaring_init(&b);
+    }
+
+    void TearDown() override {
+        roaring_free(&a);
+        roaring_free(&b);
+    }
+
+    static void fill(RoaringBitmap* bitmap, const std::set<uint32_t>& values) {
+        for (uint32_t value : values) {
+            ASSERT_EQ(roaring_add(bitmap, value), 0);
+        }
+    }
+
+    static std::vector<uint32_t> values(const RoaringBitmap* bitmap) {
+        std::vector<uint32_t> out(roaring_cardinality(bitmap));
+        out.resize(roaring_to_array(bitmap, out.data(), (long)out.size()));
+        return out;
+    }
+
+    // Lay a bitmap out as in a file: directory plus 8-byte aligned data
+    struct FileImage {
+        std::vector<RoaringFileContainer> directory;
+        std::vector<uint64_t> data;
+        RoaringView view;
+    };
+
+    static void image(const RoaringBitmap* bitmap, FileImage* out) {
+        size_t offset = 0;
+        for (int i = 0; i < bitmap->count; i++) {
+            const RoaringContainer& c = bitmap->containers[i];
+            out->directory.push_back({c.key, c.kind, c.cardinality, offset});
+            offset += roaring_container_bytes(c.kind, c.cardinality);
+        }
+        out->data.assign(offset / 8 + 1, 0);
+        for (int i = 0; i < bitmap->count; i++) {
+            const RoaringContainer& c = bitmap->containers[i];
+            size_t bytes = c.kind == ROARING_BITMAP ? ROARING_BITMAP_WORDS * 8 : c.cardinality * 2;
+            memcpy((char*)out->data.data() + out->directory[i].offset, c.data, bytes);
+        }
+        out->view.containers = out->directory.data();
+        out->view.count = (int)out->directory.size();
+        out->view.data = (const char*)out->data.data();
+    }
+};
+
+// Test: values land in per-key containers that switch to bitmaps past ROARING_ARRAY_MAX
+TEST_F(RoaringTest, AddsAcrossContainers) {
+    std::set<uint32_t> expected = {7, 3, 65535, 65536, 70000, 4000000000u, 3};
+    for (uint32_t v = 200000; v < 200000 + 3 * (ROARING_ARRAY_MAX + 1); v += 3) {
+        expected.insert(v);
+    }
+    for (uint32_t value : expected) {
+        ASSERT_EQ(roaring_add(&a, value), 0);
+    }
+    ASSERT_EQ(roaring_add(&a, 70000), 0);    // already present
+
+    EXPECT_EQ(roaring_cardinality(&a), (long)expected.size());
+    EXPECT_EQ(values(&a), std::vector<uint32_t>(expected.begin(), expected.end()));
+    ASSERT_EQ(a.count, 4);
+    EXPECT_EQ(a.containers[0].kind, ROARING_ARRAY);
+    EXPECT_EQ(a.containers[2].kind, ROARING_BITMAP);    // key 3: one value too many for an array
+    EXPECT_EQ(a.containers[2].cardinality, (uint32_t)ROARING_ARRAY_MAX + 1);
+    EXPECT_EQ(a.containers[3].key, 4000000000u >> 16);
+
+    EXPECT_TRUE(roaring_contains(&a, 65535));
+    EXPECT_TRUE(roaring_contains(&a, 200003));
+    EXPECT_FALSE(roaring_contains(&a, 200004));
+    EXPECT_FALSE(roaring_contains(&a, 8));
+    EXPECT_FALSE(roaring_contains(&b, 8));
+}
+
+// Test: unions and intersections match std::set for array/bitmap pairings
+TEST_F(RoaringTest, UnionAndIntersection) {
+    std::set<uint32_t> left, right;
+    for (uint32_t v = 0; v < 10000; v += 2) {
+        left.insert(v);                 // bitmap in key 0
+    }
+    for (uint32_t v = 0; v < 300; v += 3) {
+        right.insert(v);                // array in key 0
+    }
+    for (uint32_t v = 65536; v < 65536 + 6000; v++) {
+        left.insert(v);                 // bitmap in key 1
+        right.insert(v + 3000);         // bitmap in key 1
+    }
+    left.insert(131072 + 5);            // arrays in key 2
+    right.insert(131072 + 5);
+    right.insert(131072 + 9);
+    right.insert(500000);               // only on the right
+
+    fill(&a, left);
+    fill(&b, right);
+    ASSERT_EQ(roaring_or(&a, &b), 0);
+    std::set<uint32_t> both = left;
+    both.insert(right.begin(), right.end());
+    EXPECT_EQ(values(&a), std::vector<uint32_t>(both.begin(), both.end()));
+
+    roaring_free(&a);
+    fill(&a, left);
+    ASSERT_EQ(roaring_and(&a, &b), 0);
+    std::vector<uint32_t> common;
+    for (uint32_t v : left) {
+        if (right.count(v)) {
+            common.push_back(v);
+        }
+    }
+    EXPECT_EQ(values(&a), common);
+    ASSERT_EQ(a.count, 3);
+    EXPECT_EQ(a.containers[0].kind, ROARING_ARRAY);     // bitmap AND array
+    EXPECT_EQ(a.containers[1].kind, ROARING_ARRAY);     // 3000 values left, back to an array
+    EXPECT_EQ(a.containers[2].cardinality, 1u);
+
+    // Intersecting with an empty bitmap empties the result
+    RoaringBitmap empty;
+    roaring_init(&empty);
+    ASSERT_EQ(roaring_and(&a, &empty), 0);
+    EXPECT_EQ(a.count, 0);
+    EXPECT_EQ(roaring_cardinality(&a), 0);
+}
+
+// Test: a bitmap laid out as in a file answers the same queries
+TEST_F(RoaringTest, ViewsOperateOnFileLayout) {
+    std::set<uint32_t> left = {1, 2, 3, 65536 + 1}, right;
+    for (uint32_t v = 0; v < 8000; v++) {
+        right.insert(v * 2);
+    }
+    right.insert(65536 + 1);
+    fill(&a, left);
+    fill(&b, right);
+
+    FileImage file;
+    image(&b, &file);
+    EXPECT_TRUE(roaring_view_contains(&file.view, 4));
+    EXPECT_TRUE(roaring_view_contains(&file.view, 65537));
+    EXPECT_FALSE(roaring_view_contains(&file.view, 3));
+    EXPECT_FALSE(roaring_view_contains(&file.view, 1u << 30));
+
+    ASSERT_EQ(roaring_and_view(&a, &file.view), 0);
+    EXPECT_EQ(values(&a), std::vector<uint32_t>({2, 65537}));
+
+    RoaringBitmap copy;
+    roaring_init(&copy);
+    ASSERT_EQ(roaring_or_view(&copy, &file.view), 0);
+    EXPECT_EQ(values(&copy), std::vector<uint32_t>(right.begin(), right.end()));
+    roaring_free(&copy);
+}
@@ -0,0 +1,158 @@
+/**
+ * @file test_rollup_gtest.cpp
+ * @brief Google Test based unit tests for the circulation rollups
+ * 
+ * Covers the rowid-keyed catch-up job, the rollup updates made inside
+ * process_loan/process_return and the time series read from the rollups.
+ */
+
+#include <gtest/gtest.h>
+#include <sqlite3.h>
+#include <string>
+
+extern "C" {
+    #include "../include/database.h"
+    #include "../include/book.h"
+    #include "../include/member.h"
+    #include "../include/loan.h"
+    #include "../include/rollup.h"
+}
+
+// Test fixture class for the rollup tables
+class RollupTest : public ::testing::Test {
+protected:
+    sqlite3* test_db;
+    sqlite3* saved_db;
+
+    // Setup: Create in-memory database with the full schema before each test
+    void SetUp() override {
+        test_db = nullptr;
+        saved_db = get_db_connection();
+
+        int rc = sqlite3_open(":memory:", &test_db);
+        ASSERT_EQ(rc, SQLITE_OK) << "Failed to open in-memory database";
+
+        set_db_connection(test_db);
+        ASSERT_EQ(create_tables(), 0);
+        ASSERT_EQ(migrate_schema(), 0);
+        ASSERT_EQ(create_indexes(), 0);
+
+        ASSERT_EQ(add_book("Dune", "Herbert", "", 1965, "B1", "SF", 10), 0);
+        ASSERT_EQ(add_book("토지", "박경리", "", 1994, "B2", "소설", 10), 0);
+        ASSERT_GT(add_member(test_db, "Reader", "", ""), 0);
+    }
+
+    // Teardown: Close database after each test
+    void TearDown() override {
+        set_db_connection(saved_db);
+
+        if (test_db) {
+            sqlite3_close(test_db);
+            test_db = nullptr;
+        }
+    }
+
+    void exec(const std::string& sql) {
+        ASSERT_EQ(sqlite3_exec(test_db, sql.c_str(), nullptr, nullptr, nullptr), SQLITE_OK) << sql;
+    }
+
+    void insert_loan(int book_id, const char* loan_date) {
+        exec(std::string("INSERT INTO Loans (book_id, member_id, loan_date, due_date) VALUES (") +
+             std::to_string(book_id) + ", 1, '" + loan_date + "', '" + loan_date + "');");
+    }
+
+    void insert_return(int loan_id, const char* return_date) {
+        exec(std::string("INSERT INTO Returns (loan_id, return_date) VALUES (") +
+             std::to_string(loan_id) + ", '" + return_date + "');");
+    }
+};
+
+TEST_F(RollupTest, CatchUpFoldsNewRowsOnce) {
+    insert_loan(1, "2024-01-30");
+    insert_loan(1, "2024-01-30");
+    insert_loan(2, "2024-01-31");
+    insert_loan(1, "2024-02-01");
+    insert_return(1, "2024-02-01");
+
+    EXPECT_EQ(update_circulation_rollups(test_db), 5);
+    EXPECT_EQ(update_circulation_rollups(test_db), 0) << "Rows are counted only once";
+
+    CirculationPoint points[10];
+    ASSERT_EQ(get_circulation_series(test_db, ROLLUP_DAILY, "2024-01-01", "2024-12-31", nullptr, points, 10), 3);
+    EXPECT_STREQ(points[0].period, "2024-01-30");
+    EXPECT_EQ(points[0].loans, 2);
+    EXPECT_STREQ(points[1].period, "2024-01-31");
+    EXPECT_EQ(points[1].loans, 1);
+    EXPECT_STREQ(points[2].period, "2024-02-01");
+    EXPECT_EQ(points[2].loans, 1);
+    EXPECT_EQ(points[2].returns, 1);
+
+    insert_loan(2, "2024-02-01");
+    EXPECT_EQ(update_circulation_rollups(test_db), 1);
+    ASSERT_EQ(get_circulation_series(test_db, ROLLUP_DAILY, "2024-02-01", "2024-02-01", nullptr, points, 10), 1);
+    EXPECT_EQ(points[0].loans, 2) << "Existing bucket is incremented";
+}
+
+TEST_F(RollupTest, MonthlyBucketsAndGenreFilter) {
+    insert_loan(1, "2023-12-31");
+    insert_loan(1, "2024-01-01");
+    insert_loan(2, "2024-01-15");
+    insert_loan(2, "2024-03-10");
+    insert_return(2, "2024-03-01");
+    ASSERT_EQ(update_circulation_rollups(test_db), 5);
+
+    CirculationPoint points[10];
+    ASSERT_EQ(get_circulation_series(test_db, ROLLUP_MONTHLY, "2023-12-01", "2024-03-31", nullptr, points, 10), 3);
+    EXPECT_STREQ(points[0].period, "2023-12");
+    EXPECT_EQ(points[0].loans, 1);
+    EXPECT_STREQ(points[1].period, "2024-01");
+    EXPECT_EQ(points[1].loans, 2);
+    EXPECT_STREQ(points[2].period, "2024-03");
+    EXPECT_EQ(points[2].loans, 1);
+    EXPECT_EQ(points[2].returns, 1);
+
+    ASSERT_EQ(get_circulation_series(test_db, ROLLUP_MONTHLY, "2024-01-01", "2024-12-31", "소설", points, 10), 2);
+    EXPECT_STREQ(points[0].period, "2024-01");
+    EXPECT_EQ(points[0].loans, 1);
+
+    EXPECT_EQ(get_circulation_series(test_db, ROLLUP_MONTHLY, "2024-13-01", "2024-12-31", nullptr, points, 10), -1);
+}
+
+TEST_F(RollupTest, LoanAndReturnUpdateRollups) {
+    int loan_id = process_loan(test_db, 1, 1, 14);
+    ASSERT_GT(loan_id, 0);
+    ASSERT_GT(process_return(test_db, loan_id), 0);
+
+    sqlite3_stmt* stmt;
+    ASSERT_EQ(sqlite3_prepare_v2(test_db, "SELECT genre, loans, returns FROM CirculationMonthly;",
+                                 -1, &stmt, nullptr), SQLITE_OK);
+    ASSERT_EQ(sqlite3_step(stmt), SQLITE_ROW);
+    EXPECT_STREQ((const char*)sqlite3_column_text(stmt, 0), "SF");
+    EXPECT_EQ(sqlite3_column_int(stmt, 1), 1);
+    EXPECT_EQ(sqlite3_column_int(stmt, 2), 1);
+    EXPECT_EQ(sqlite3_step(stmt), SQLITE_DONE);
+    sqlite3_finalize(stmt);
+
+    EXPECT_EQ(update_circulation_rollups(test_db), 0) << "Already counted inside the transactions";
+}
+
+TEST_F(RollupTest, SeriesReadsOnlyRollups) {
+    insert_loan(1, "2024-05-05");
+    ASSERT_EQ(update_circulation_rollups(test_db), 1);
+
+    exec("DELETE FROM Loans;");
+
+    CirculationPoint points[4];
+    ASSERT_EQ(get_circulation_series(test_db, ROLLUP_DAILY, "2024-05-01", "2024-05-31", nullptr, points, 4), 1);
+    EXPECT_EQ(points[0].loans, 1);
+    EXPECT_EQ(display_circulation_report(test_db, ROLLUP_MONTHLY, "2024-01-01", "2024-12-31", nullptr), 1);
+}
+
+// ============================================================================
+// Main function
+// ============================================================================
+
+int main(int argc, char** argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,137 @@
+/**
+ * @file test_sql_functions_gtest.cpp
+ * @brief Google Test based unit tests for the custom SQL functions
+ * 
+ * Checks date_to_day(), overdue_days() and suspension_days() against the
+ * C date helpers and the overdue queries that use them.
+ */
+
+#include <gtest/gtest.h>
+#include <sqlite3.h>
+#include <string>
+
+extern "C" {
+    #include "../include/database.h"
+    #include "../include/book.h"
+    #include "../include/member.h"
+    #include "../include/loan.h"
+    #include "../include/date_utils.h"
+    #include "../include/sql_functions.h"
+}
+
+// Test fixture class for the SQL functions
+class SqlFunctionsTest : public ::testing::Test {
+protected:
+    sqlite3* test_db;
+    sqlite3* saved_db;
+
+    // Setup: Create in-memory database with the full schema before each test
+    void SetUp() override {
+        test_db = nullptr;
+        saved_db = get_db_connection();
+
+        int rc = sqlite3_open(":memory:", &test_db);
+        ASSERT_EQ(rc, SQLITE_OK) << "Failed to open in-memory database";
+
+        set_db_connection(test_db);
+        ASSERT_EQ(create_tables(), 0);
+        ASSERT_EQ(migrate_schema(), 0);
+        ASSERT_EQ(create_indexes(), 0);
+    }
+
+    // Teardown: Close database after each test
+    void TearDown() override {
+        set_db_connection(saved_db);
+
+        if (test_db) {
+            sqlite3_close(test_db);
+            test_db = nullptr;
+        }
+    }
+
+    // Evaluate a scalar expression; returns the column type and stores the integer value
+    int eval(const std::string& expr, int* value) {
+        sqlite3_stmt* stmt;
+        std::string sql = "SELECT " + expr + ";";
+        if (sqlite3_prepare_v2(test_db, sql.c_str(), -1, &stmt, nullptr) != SQLITE_OK) {
+            return -1;
+        }
+        int type = -1;
+        if (sqlite3_step(stmt) == SQLITE_ROW) {
+            type = sqlite3_column_type(stmt, 0);
+            *value = sqlite3_column_int(stmt, 0);
+        }
+        sqlite3_finalize(stmt);
+        return type;
+    }
+};
+
+TEST_F(SqlFunctionsTest, DateToDayMatchesCHelper) {
+    const char* dates[] = {"1970-01-01", "2000-02-29", "2024-03-01", "1899-12-31", "2099-12-31"};
+    for (const char* date : dates) {
+        int expected;
+        ASSERT_EQ(date_to_day(date, &expected), 0);
+        int value;
+        ASSERT_EQ(eval(std::string("date_to_day('") + date + "')", &value), SQLITE_INTEGER) << date;
+        EXPECT_EQ(value, expected) << date;
+    }
+
+    int value;
+    ASSERT_EQ(eval("date_to_day('2024-05-05 13:45:00')", &value), SQLITE_INTEGER);
+    EXPECT_EQ(eval("date_to_day('2023-02-29')", &value), SQLITE_NULL);
+    EXPECT_EQ(eval("date_to_day('garbage')", &value), SQLITE_NULL);
+    EXPECT_EQ(eval("date_to_day('2024-01-')", &value), SQLITE_NULL);
+    EXPECT_EQ(eval("date_to_day('2024-01-1')", &value), SQLITE_NULL);
+    EXPECT_EQ(eval("date_to_day(NULL)", &value), SQLITE_NULL);
+}
+
+TEST_F(SqlFunctionsTest, OverdueAndSuspensionDays) {
+    int value;
+    ASSERT_EQ(eval("overdue_days('2024-02-27', '2024-03-01')", &value), SQLITE_INTEGER);
+    EXPECT_EQ(value, 3) << "Leap day counts";
+    ASSERT_EQ(eval("overdue_days('2024-03-01', '2024-02-27')", &value), SQLITE_INTEGER);
+    EXPECT_EQ(value, 0) << "Not yet due";
+    ASSERT_EQ(eval("overdue_days('2023-12-31', '2024-01-01')", &value), SQLITE_INTEGER);
+    EXPECT_EQ(value, 1);
+    EXPECT_EQ(eval("overdue_days(NULL, '2024-01-01')", &value), SQLITE_NULL);
+    EXPECT_EQ(eval("overdue_days('2024-01-01', 'x')", &value), SQLITE_NULL);
+
+    ASSERT_EQ(eval("suspension_days(3)", &value), SQLITE_INTEGER);
+    EXPECT_EQ(value, calculate_suspension_days(3));
+    ASSERT_EQ(eval("suspension_days(overdue_days('2024-01-01', '2024-01-11'))", &value), SQLITE_INTEGER);
+    EXPECT_EQ(value, 20);
+    ASSERT_EQ(eval("suspension_days(-4)", &value), SQLITE_INTEGER);
+    EXPECT_EQ(value, 0);
+    EXPECT_EQ(eval("suspension_days(NULL)", &value), SQLITE_NULL);
+}
+
+TEST_F(SqlFunctionsTest, FunctionsAreDeterministic) {
+    // Only deterministic functions are allowed in index expressions
+    EXPECT_EQ(sqlite3_exec(test_db, "CREATE INDEX idx_test_due_day ON Loans(date_to_day(due_date));",
+                           nullptr, nullptr, nullptr), SQLITE_OK) << sqlite3_errmsg(test_db);
+}
+
+TEST_F(SqlFunctionsTest, MemberOverdueUsesCalendarDays) {
+    ASSERT_EQ(add_book("Dune", "Herbert", "", 1965, "B1", "SF", 3), 0);
+    ASSERT_GT(add_member(test_db, "Reader", "", ""), 0);
+
+    char due[16];
+    day_to_date(get_today_day() - 5, due, sizeof(due));
+    std::string sql = std::string("INSERT INTO Loans (book_id, member_id, loan_date, due_date) "
+                                  "VALUES (1, 1, '2020-01-01', '") + due + "');";
+    ASSERT_EQ(sqlite3_exec(test_db, sql.c_str(), nullptr, nullptr, nullptr), SQLITE_OK);
+
+    int overdue_days = -1;
+    EXPECT_EQ(check_member_overdue(test_db, 1, &overdue_days), 1);
+    EXPECT_EQ(overdue_days, 5);
+    EXPECT_EQ(display_overdue_report(test_db), 1);
+}
+
+// ============================================================================
+// Main function
+// ============================================================================
+
+int main(int argc, char** argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,173 @@
+/**
+ * @file test_table_gtest.cpp
+ * @brief Google Test based unit tests for the table renderer
+ * 
+ * Covers display widths of Hangul and CJK text, aligned padding and
+ * cutting, the CSV/TSV/JSON encodings and output larger than the buffer.
+ */
+
+#include <gtest/gtest.h>
+#include <cstdio>
+#include <string>
+
+extern "C" {
+    #include "../include/table.h"
+    #include "../include/utf8.h"
+}
+
+static const TableColumn test_columns[] = {
+    {"ID", 4}, {"Title", 10}, {"Note", 0}
+};
+
+// Test fixture class for the table renderer
+class TableTest : public ::testing::Test {
+protected:
+    FILE* out;
+    Table table;
+
+    void SetUp() override {
+        out = tmpfile();
+        ASSERT_NE(out, nullptr);
+    }
+
+    // Teardown: Restore the default format
+    void TearDown() override {
+        table_set_format(TABLE_FORMAT_ALIGNED);
+        if (out) {
+            fclose(out);
+        }
+    }
+
+    void begin(TableFormat format, const char* title = nullptr) {
+        table_set_format(format);
+        table_begin(&table, out, title, test_columns, 3);
+    }
+
+    void row(long long id, const char* title, const char* note) {
+        table_int(&table, id);
+        table_text(&table, title);
+        table_text(&table, note);
+    }
+
+    std::string output() {
+        std::string text;
+        char buffer[4096];
+        rewind(out);
+        size_t n;
+        while ((n = fread(buffer, 1, sizeof(buffer), out)) > 0) {
+            text.append(buffer, n);
+        }
+        return text;
+    }
+};
+
+TEST_F(TableTest, DisplayWidthCountsWideCharacters) {
+    EXPECT_EQ(utf8_display_width("Dune"), 4u);
+    EXPECT_EQ(utf8_display_width("한국어"), 6u);
+    EXPECT_EQ(utf8_display_width("漢字 ok"), 7u);
+    EXPECT_EQ(utf8_display_width("ＡＢ"), 4u) << "Fullwidth forms";
+    EXPECT_EQ(utf8_display_width("e\xCC\x81"), 1u) << "Combining accent";
+    EXPECT_EQ(utf8_char_width(0x1161), 0) << "Medial jamo joins the previous syllable";
+}
+
+TEST_F(TableTest, AlignedPadsByDisplayWidth) {
+    begin(TABLE_FORMAT_ALIGNED, "== Books ==\n");
+    row(1, "한국어", "x");
+    row(22, "Dune", "y");
+    EXPECT_EQ(table_end(&table, "Total: %d\n", table.rows), 2);
+
+    EXPECT_EQ(output(),
+              "== Books ==\n"
+              "ID   Title      Note\n"
+              "--------------------\n"
+              "1    한국어     x\n"
+              "22   Dune       y\n"
+              "Total: 2\n");
+}
+
+TEST_F(TableTest, AlignedCutsLongCells) {
+    begin(TABLE_FORMAT_ALIGNED);
+    row(1, "The Left Hand of Darkness", "");
+    row(2, "토지 제1부 어둠의 발소리", "");
+    table_end(&table, nullptr);
+
+    std::string text = output();
+    EXPECT_NE(text.find("1    The Left.. \n"), std::string::npos) << text;
+    EXPECT_NE(text.find("2    토지 제1.. \n"), std::string::npos) << "Wide characters are never split: " << text;
+}
+
+TEST_F(TableTest, CsvQuotesSpecialCharacters) {
+    begin(TABLE_FORMAT_CSV, "ignored title\n");
+    row(1, "Hello, World", "say \"hi\"");
+    row(2, "Plain", nullptr);
+    table_end(&table, "ignored footer %d\n", 2);
+
+    EXPECT_EQ(output(),
+              "ID,Title,Note\n"
+              "1,\"Hello, World\",\"say \"\"hi\"\"\"\n"
+              "2,Plain,\n");
+}
+
+TEST_F(TableTest, TsvFlattensTabsAndNewlines) {
+    begin(TABLE_FORMAT_TSV);
+    row(1, "a\tb", "line1\nline2");
+    table_end(&table, nullptr);
+
+    EXPECT_EQ(output(), "ID\tTitle\tNote\n1\ta b\tline1 line2\n");
+}
+
+TEST_F(TableTest, JsonWritesObjectsPerRow) {
+    begin(TABLE_FORMAT_JSON);
+    row(7, "한국어 \"quoted\"", nullptr);
+    row(8, "back\\slash", "tab\t");
+    EXPECT_EQ(table_end(&table, nullptr), 2);
+
+    EXPECT_EQ(output(),
+              "[\n"
+              "{\"ID\":7,\"Title\":\"한국어 \\\"quoted\\\"\",\"Note\":null},\n"
+              "{\"ID\":8,\"Title\":\"back\\\\slash\",\"Note\":\"tab\\t\"}\n"
+              "]\n");
+
+    // An empty listing is still valid JSON
+    fclose(out);
+    out = tmpfile();
+    begin(TABLE_FORMAT_JSON);
+    EXPECT_EQ(table_end(&table, nullptr), 0);
+    EXPECT_EQ(output(), "[]\n");
+}
+
+TEST_F(TableTest, StreamsOutputLargerThanBuffer) {
+    begin(TABLE_FORMAT_CSV);
+    const int rows = 20000;
+    for (int i = 0; i < rows; i++) {
+        row(i, "A fairly long title to fill the buffer quickly", "note");
+    }
+    EXPECT_EQ(table_end(&table, nullptr), rows);
+
+    std::string text = output();
+    EXPECT_GT(text.size(), (size_t)TABLE_BUFFER_SIZE);
+    size_t lines = 0;
+    for (char c : text) {
+        lines += c == '\n';
+    }
+    EXPECT_EQ(lines, (size_t)rows + 1);
+    EXPECT_EQ(text.substr(text.size() - 13), "quickly,note\n");
+}
+
+TEST_F(TableTest, ParsesFormatNames) {
+    EXPECT_EQ(table_parse_format("table"), TABLE_FORMAT_ALIGNED);
+    EXPECT_EQ(table_parse_format("csv"), TABLE_FORMAT_CSV);
+    EXPECT_EQ(table_parse_format("tsv"), TABLE_FORMAT_TSV);
+    EXPECT_EQ(table_parse_format("json"), TABLE_FORMAT_JSON);
+    EXPECT_EQ(table_parse_format("xml"), -1);
+    EXPECT_EQ(table_parse_format(nullptr), -1);
+}
+
+// ============================================================================
+// Main function
+// ============================================================================
+
+int main(int argc, char** argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
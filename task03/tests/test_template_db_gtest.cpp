@@ -0,0 +1,116 @@
+/**
+ * @file test_template_db_gtest.cpp
+ * @brief Google Test based unit tests for the cloned test databases
+ * 
+ * Covers the clone holding the template's schema and seed rows, clones
+ * staying isolated from each other and from the template, the library
+ * working on a clone, and per-test setup cost.
+ */
+
+#include <gtest/gtest.h>
+#include <sqlite3.h>
+#include <chrono>
+
+#include "template_db.hpp"
+
+extern "C" {
+    #include "../include/database.h"
+    #include "../include/book.h"
+    #include "../include/member.h"
+    #include "../include/loan.h"
+}
+
+static const int SEED_BOOKS = 5000;
+static const int SEED_MEMBERS = 500;
+
+// Template: the library schema with books, members and returned loans
+static int build_seeded_library(sqlite3* db) {
+    if (TemplateDatabase::library_schema(db) != 0) {
+        return -1;
+    }
+    char sql[1024];
+    snprintf(sql, sizeof(sql),
+             "WITH RECURSIVE n(i) AS (SELECT 1 UNION ALL SELECT i + 1 FROM n WHERE i < %d) "
+             "INSERT INTO Books (title, author, publisher, publication_year, isbn, genre, quantity, available) "
+             "SELECT printf('Seed book %%d', i), printf('Author %%d', i %% 97), 'Publisher', 2000 + i %% 20, "
+             "printf('%%010d', i), 'Fiction', 2, 2 FROM n;"
+             "WITH RECURSIVE n(i) AS (SELECT 1 UNION ALL SELECT i + 1 FROM n WHERE i < %d) "
+             "INSERT INTO Members (name, phone, address) SELECT printf('Member %%d', i), '010-0000-0000', 'Seoul' "
+             "FROM n;"
+             "INSERT INTO Loans (book_id, member_id, loan_date, due_date, is_returned) "
+             "SELECT book_id, 1 + book_id %% %d, '2024-01-01', '2024-01-15', 1 FROM Books;",
+             SEED_BOOKS, SEED_MEMBERS, SEED_MEMBERS);
+    return sqlite3_exec(db, sql, nullptr, nullptr, nullptr) == SQLITE_OK ? 0 : -1;
+}
+
+// Test fixture class for the seeded template
+class TemplateDbTest : public ClonedDatabaseTest<build_seeded_library> {
+protected:
+    static int query_int(sqlite3* db, const char* sql) {
+        sqlite3_stmt* stmt;
+        int value = -1;
+        if (sqlite3_prepare_v2(db, sql, -1, &stmt, nullptr) == SQLITE_OK) {
+            if (sqlite3_step(stmt) == SQLITE_ROW) {
+                value = sqlite3_column_int(stmt, 0);
+            }
+            sqlite3_finalize(stmt);
+        }
+        return value;
+    }
+};
+
+// Test: a clone starts with the schema and every seed row
+TEST_F(TemplateDbTest, CloneHoldsSeedData) {
+    EXPECT_EQ(query_int(test_db, "SELECT COUNT(*) FROM Books"), SEED_BOOKS);
+    EXPECT_EQ(query_int(test_db, "SELECT COUNT(*) FROM Members"), SEED_MEMBERS);
+    EXPECT_EQ(query_int(test_db, "SELECT COUNT(*) FROM Loans"), SEED_BOOKS);
+    EXPECT_GT(query_int(test_db, "SELECT COUNT(*) FROM sqlite_master WHERE type = 'index'"), 0);
+    EXPECT_GT(template_database().size(), 0);
+
+    // The library works on the clone, including its SQL functions
+    Book book;
+    ASSERT_EQ(get_book_by_id(42, &book), 0);
+    EXPECT_STREQ(book.title, "Seed book 42");
+    EXPECT_GT(process_loan(test_db, 42, 7, 14), 0);
+    EXPECT_EQ(query_int(test_db, "SELECT available FROM Books WHERE book_id = 42"), 1);
+}
+
+// Test: changes stay in their own clone
+TEST_F(TemplateDbTest, ClonesAreIsolated) {
+    ASSERT_EQ(sqlite3_exec(test_db, "DELETE FROM Loans; DELETE FROM Books WHERE book_id > 10;",
+                           nullptr, nullptr, nullptr), SQLITE_OK);
+    ASSERT_EQ(add_book("New Book", "Author", "Publisher", 2024, "0131103628", "Fiction", 1), 0);
+    EXPECT_EQ(query_int(test_db, "SELECT COUNT(*) FROM Books"), 11);
+
+    sqlite3* other = template_database().clone();
+    ASSERT_NE(other, nullptr);
+    EXPECT_EQ(query_int(other, "SELECT COUNT(*) FROM Books"), SEED_BOOKS);
+    EXPECT_EQ(query_int(other, "SELECT COUNT(*) FROM Loans"), SEED_BOOKS);
+    sqlite3_close(other);
+}
+
+// Test: cloning costs a small fraction of building the schema and seed
+TEST_F(TemplateDbTest, CloneIsCheap) {
+    using clock = std::chrono::steady_clock;
+    const int rounds = 50;
+
+    auto start = clock::now();
+    for (int i = 0; i < rounds; i++) {
+        sqlite3* db = template_database().clone();
+        ASSERT_NE(db, nullptr);
+        sqlite3_close(db);
+    }
+    double clone_us = std::chrono::duration<double, std::micro>(clock::now() - start).count() / rounds;
+
+    start = clock::now();
+    TemplateDatabase rebuilt(build_seeded_library);
+    double build_us = std::chrono::duration<double, std::micro>(clock::now() - start).count();
+    sqlite3* db = rebuilt.clone();
+    ASSERT_NE(db, nullptr);
+    EXPECT_EQ(query_int(db, "SELECT COUNT(*) FROM Books"), SEED_BOOKS);
+    sqlite3_close(db);
+
+    RecordProperty("clone_us", (int)clone_us);
+    RecordProperty("build_us", (int)build_us);
+    EXPECT_LT(clone_us * 5, build_us) << "clone " << clone_us << " us, build " << build_us << " us";
+}
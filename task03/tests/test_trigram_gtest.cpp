@@ -0,0 +1,135 @@
+/**
+ * @file test_trigram_gtest.cpp
+ * @brief Google Test based unit tests for the Trigram search module
+ * 
+ * Covers typo-tolerant search over titles and authors, Hangul text,
+ * ranking and incremental index maintenance from add/update/delete_book.
+ */
+
+#include <gtest/gtest.h>
+#include <sqlite3.h>
+
+extern "C" {
+    #include "../include/database.h"
+    #include "../include/book.h"
+    #include "../include/trigram.h"
+}
+
+// Test fixture class for Trigram module tests
+class TrigramTest : public ::testing::Test {
+protected:
+    sqlite3* test_db;
+    sqlite3* saved_db;
+
+    // Setup: Create in-memory database with a small catalogue before each test
+    void SetUp() override {
+        test_db = nullptr;
+        saved_db = get_db_connection();
+
+        int rc = sqlite3_open(":memory:", &test_db);
+        ASSERT_EQ(rc, SQLITE_OK) << "Failed to open in-memory database";
+
+        set_db_connection(test_db);
+        ASSERT_EQ(create_tables(), 0);
+        ASSERT_EQ(migrate_schema(), 0);
+        ASSERT_EQ(create_indexes(), 0);
+
+        ASSERT_EQ(add_book("Harry Potter and the Philosopher's Stone", "J.K. Rowling", "Bloomsbury", 1997, "0001", "Fantasy", 1), 0);
+        ASSERT_EQ(add_book("The Hobbit", "J.R.R. Tolkien", "Allen & Unwin", 1937, "0002", "Fantasy", 1), 0);
+        ASSERT_EQ(add_book("한국사 이야기", "이이화", "한길사", 1998, "0003", "역사", 1), 0);
+        ASSERT_EQ(add_book("한국 현대사", "서중석", "웅진", 2007, "0004", "역사", 1), 0);
+    }
+
+    // Teardown: Drop the index and close database after each test
+    void TearDown() override {
+        free_trigram_index();
+        set_db_connection(saved_db);
+
+        if (test_db) {
+            sqlite3_close(test_db);
+            test_db = nullptr;
+        }
+    }
+
+    // Helper function to return the best match for a query, or -1
+    int best_match(const char* query) {
+        FuzzyMatch matches[5];
+        int count = fuzzy_search_books(query, matches, 5);
+        return count > 0 ? matches[0].book_id : -1;
+    }
+};
+
+// ============================================================================
+// Test Suite 1: fuzzy_search_books() tests
+// ============================================================================
+
+TEST_F(TrigramTest, LoadIndexesAllBooks) {
+    EXPECT_EQ(load_trigram_index(test_db), 4);
+}
+
+TEST_F(TrigramTest, FindsTitleWithTypo) {
+    EXPECT_EQ(best_match("hary poter"), 1);
+    EXPECT_EQ(best_match("The Hobit"), 2);
+}
+
+TEST_F(TrigramTest, FindsAuthorWithTypo) {
+    EXPECT_EQ(best_match("Tolkein"), 2);
+}
+
+TEST_F(TrigramTest, FindsHangulWithTypo) {
+    EXPECT_EQ(best_match("한국사 이야가"), 3);
+    EXPECT_EQ(best_match("한국 현대서"), 4);
+}
+
+TEST_F(TrigramTest, RanksByOverlapThenDistance) {
+    FuzzyMatch matches[5];
+    int count = fuzzy_search_books("한국사", matches, 5);
+    ASSERT_GE(count, 2);
+    EXPECT_EQ(matches[0].book_id, 3);
+    EXPECT_GE(matches[0].overlap, matches[1].overlap);
+}
+
+TEST_F(TrigramTest, NoMatch) {
+    FuzzyMatch matches[5];
+    EXPECT_EQ(fuzzy_search_books("zzzzqqqq", matches, 5), 0);
+    EXPECT_EQ(fuzzy_search_books("", matches, 5), 0);
+}
+
+// ============================================================================
+// Test Suite 2: incremental maintenance
+// ============================================================================
+
+TEST_F(TrigramTest, AddBookIsSearchableImmediately) {
+    ASSERT_EQ(load_trigram_index(test_db), 4);
+
+    ASSERT_EQ(add_book("Dune", "Frank Herbert", "Chilton", 1965, "0005", "SF", 1), 0);
+
+    EXPECT_EQ(best_match("Frank Herbet"), 5);
+}
+
+TEST_F(TrigramTest, UpdateBookReplacesPostings) {
+    ASSERT_EQ(load_trigram_index(test_db), 4);
+
+    ASSERT_EQ(update_book(2, "The Silmarillion", NULL, NULL, 0, NULL), 0);
+
+    EXPECT_EQ(best_match("Silmarilion"), 2);
+    EXPECT_NE(best_match("The Hobbit"), 2) << "Old title must no longer match";
+    EXPECT_EQ(best_match("Tolkien"), 2) << "Unchanged author must still match";
+}
+
+TEST_F(TrigramTest, DeleteBookRemovesPostings) {
+    ASSERT_EQ(load_trigram_index(test_db), 4);
+
+    ASSERT_EQ(delete_book(1), 0);
+
+    EXPECT_NE(best_match("Harry Potter"), 1);
+}
+
+// ============================================================================
+// Main function
+// ============================================================================
+
+int main(int argc, char** argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}